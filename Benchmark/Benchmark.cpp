@@ -0,0 +1,422 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif // _WIN32
+
+using namespace wiGraphics;
+using namespace wiScene;
+using namespace wiECS;
+
+namespace Benchmark
+{
+	void Result::Finalize()
+	{
+		if (samples.empty())
+		{
+			return;
+		}
+		std::vector<double> sorted = samples;
+		std::sort(sorted.begin(), sorted.end());
+
+		// nearest rank percentile:
+		auto percentile = [&](double p) {
+			size_t rank = (size_t)std::ceil(p * sorted.size());
+			return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+		};
+
+		double sum = 0;
+		for (double x : sorted)
+		{
+			sum += x;
+		}
+		mean = sum / sorted.size();
+		min = sorted.front();
+		max = sorted.back();
+		p50 = percentile(0.5);
+		p90 = percentile(0.9);
+		p99 = percentile(0.99);
+	}
+
+
+	// Measures func() once per frame into the result with the given name
+	class Recorder
+	{
+		const std::string& scene;
+		std::vector<Result>& results;
+		bool measure = false;
+	public:
+		Recorder(const std::string& scene, std::vector<Result>& results) : scene(scene), results(results) {}
+
+		void SetMeasuring(bool value) { measure = value; }
+
+		void Time(const char* name, const std::function<void()>& func)
+		{
+			wiTimer timer;
+			func();
+			const double elapsed = timer.elapsed();
+			if (!measure)
+			{
+				return;
+			}
+			for (auto& result : results)
+			{
+				if (result.scene == scene && result.name == name)
+				{
+					result.samples.push_back(elapsed);
+					return;
+				}
+			}
+			Result result;
+			result.scene = scene;
+			result.name = name;
+			result.samples.reserve(256);
+			result.samples.push_back(elapsed);
+			results.push_back(std::move(result));
+		}
+	};
+
+	// Places the main camera so that it sees the whole scene from the side
+	void SetupCamera(const Scene& scene)
+	{
+		CameraComponent& camera = wiRenderer::GetCamera();
+		const AABB& bounds = scene.bounds;
+		XMFLOAT3 center = bounds.getCenter();
+		XMFLOAT3 halfwidth = bounds.getHalfWidth();
+		float radius = std::max(1.0f, std::sqrt(halfwidth.x * halfwidth.x + halfwidth.y * halfwidth.y + halfwidth.z * halfwidth.z));
+		if (bounds.getArea() <= 0 || !std::isfinite(radius))
+		{
+			center = XMFLOAT3(0, 0, 0);
+			radius = 10;
+		}
+		camera.CreatePerspective((float)wiRenderer::GetInternalResolution().x, (float)wiRenderer::GetInternalResolution().y, 0.1f, radius * 4);
+		camera.Eye = XMFLOAT3(center.x, center.y + radius * 0.25f, center.z - radius * 1.5f);
+		XMStoreFloat3(&camera.At, XMVector3Normalize(XMLoadFloat3(&center) - XMLoadFloat3(&camera.Eye)));
+		camera.Up = XMFLOAT3(0, 1, 0);
+		camera.UpdateCamera();
+	}
+
+	void RunScene(const Options& options, const std::string& fileName, std::vector<Result>& results)
+	{
+		const std::string name = wiHelper::GetFileNameFromPath(fileName);
+		Recorder recorder(name, results);
+		recorder.SetMeasuring(true);
+
+		Scene& scene = GetScene();
+		scene.Clear();
+		wiRenderer::ClearWorld();
+
+		recorder.Time("Load", [&] {
+			LoadModel(fileName);
+		});
+
+		// Serialization to memory and back:
+		for (uint32_t i = 0; i < 10; ++i)
+		{
+			wiArchive archive;
+			recorder.Time("Serialize.Write", [&] {
+				scene.Serialize(archive);
+			});
+			archive.SetReadModeAndResetPos(true);
+			Scene copy;
+			recorder.Time("Serialize.Read", [&] {
+				copy.Serialize(archive);
+			});
+		}
+
+		// Scene and renderer update with the same frame rate on every machine:
+		const float dt = 1.0f / 60.0f;
+		scene.Update(0);
+		SetupCamera(scene);
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> distribution(-1, 1);
+
+		Scene renderScene;
+
+		for (uint32_t frame = 0; frame < options.warmup + options.frames; ++frame)
+		{
+			recorder.SetMeasuring(frame >= options.warmup);
+
+			// Every system of Scene::Update() separately, with the same dependencies:
+			recorder.Time("Scene::Update (systems)", [&] {
+				wiJobSystem::context ctx;
+				scene.time += dt;
+				recorder.Time("RunPreviousFrameTransformUpdateSystem", [&] { scene.RunPreviousFrameTransformUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunAnimationUpdateSystem", [&] { scene.RunAnimationUpdateSystem(ctx, dt); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunTransformUpdateSystem", [&] { scene.RunTransformUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunHierarchyUpdateSystem", [&] { scene.RunHierarchyUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunSpringUpdateSystem", [&] { scene.RunSpringUpdateSystem(ctx, dt); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunInverseKinematicsUpdateSystem", [&] { scene.RunInverseKinematicsUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunArmatureUpdateSystem", [&] { scene.RunArmatureUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunMaterialUpdateSystem", [&] { scene.RunMaterialUpdateSystem(ctx, dt); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunImpostorUpdateSystem", [&] { scene.RunImpostorUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunWeatherUpdateSystem", [&] { scene.RunWeatherUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunPhysicsUpdateSystem", [&] { wiPhysicsEngine::RunPhysicsUpdateSystem(ctx, scene, dt); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunObjectUpdateSystem", [&] { scene.RunObjectUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunCameraUpdateSystem", [&] { scene.RunCameraUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunDecalUpdateSystem", [&] { scene.RunDecalUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunProbeUpdateSystem", [&] { scene.RunProbeUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunForceUpdateSystem", [&] { scene.RunForceUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunLightUpdateSystem", [&] { scene.RunLightUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunParticleUpdateSystem", [&] { scene.RunParticleUpdateSystem(ctx, dt); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunSoundUpdateSystem", [&] { scene.RunSoundUpdateSystem(ctx); wiJobSystem::Wait(ctx); });
+				recorder.Time("RunParticleSimulationSystem", [&] { scene.RunParticleSimulationSystem(ctx, dt); wiJobSystem::Wait(ctx); });
+			});
+
+			// The whole update, as the engine runs it:
+			recorder.Time("Scene::Update", [&] {
+				scene.Update(dt);
+			});
+
+			// Includes an other Scene::Update(), so the culling is reported as the difference:
+			recorder.Time("wiRenderer::UpdatePerFrameData", [&] {
+				wiRenderer::UpdatePerFrameData(dt);
+			});
+
+			// The copy that the pipelined rendering makes every frame (see wiRenderer::SetPipelinedRenderingEnabled()):
+			recorder.Time("Scene::CopyForRendering", [&] {
+				renderScene.CopyForRendering(scene);
+			});
+
+			recorder.Time("Pick", [&] {
+				const CameraComponent& camera = wiRenderer::GetCamera();
+				XMVECTOR eye = camera.GetEye();
+				XMVECTOR at = camera.GetAt();
+				XMVECTOR up = camera.GetUp();
+				XMVECTOR right = camera.GetRight();
+				for (uint32_t i = 0; i < options.picks; ++i)
+				{
+					XMVECTOR direction = XMVector3Normalize(at + right * distribution(random) * 0.5f + up * distribution(random) * 0.3f);
+					RAY ray(eye, direction);
+					Pick(ray, RENDERTYPE_ALL, ~0u, scene);
+				}
+			});
+
+			wiRenderer::GetDevice()->PresentEnd(0);
+		}
+
+		// Culling = UpdatePerFrameData - Scene::Update of the same frame:
+		Result* perframe = nullptr;
+		Result* update = nullptr;
+		for (auto& result : results)
+		{
+			if (result.scene == name && result.name == "wiRenderer::UpdatePerFrameData")
+				perframe = &result;
+			if (result.scene == name && result.name == "Scene::Update")
+				update = &result;
+		}
+		if (perframe != nullptr && update != nullptr && perframe->samples.size() == update->samples.size())
+		{
+			Result culling;
+			culling.scene = name;
+			culling.name = "wiRenderer::UpdatePerFrameData (without Scene::Update)";
+			for (size_t i = 0; i < perframe->samples.size(); ++i)
+			{
+				culling.samples.push_back(std::max(0.0, perframe->samples[i] - update->samples[i]));
+			}
+			results.push_back(std::move(culling));
+		}
+
+		std::stringstream ss;
+		ss << "[Benchmark] " << name << ": " << scene.objects.GetCount() << " objects, " << scene.meshes.GetCount() << " meshes, "
+			<< scene.lights.GetCount() << " lights, " << scene.armatures.GetCount() << " armatures, " << scene.rigidbodies.GetCount() << " rigid bodies";
+		std::fprintf(stderr, "%s\n", ss.str().c_str());
+	}
+
+	std::vector<Result> Run(const Options& options)
+	{
+		std::vector<Result> results;
+
+		if (options.threads > 0)
+		{
+			wiJobSystem::SetActiveThreadCount(options.threads);
+		}
+
+		for (auto& fileName : options.scenes)
+		{
+			RunScene(options, fileName, results);
+		}
+
+		for (auto& result : results)
+		{
+			result.Finalize();
+		}
+		return results;
+	}
+
+	void AppendEscaped(std::string& json, const std::string& text)
+	{
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				json += '\\';
+			}
+			json += c;
+		}
+	}
+
+	std::string ToJSON(const Options& options, const std::vector<Result>& results)
+	{
+		std::string json;
+		char buffer[512];
+
+		json += "{\n";
+		snprintf(buffer, sizeof(buffer), "\t\"version\": \"%s\",\n\t\"frames\": %u,\n\t\"warmup\": %u,\n\t\"threads\": %u,\n\t\"results\": [\n",
+			wiVersion::GetVersionString().c_str(), options.frames, options.warmup, wiJobSystem::GetActiveThreadCount());
+		json += buffer;
+
+		// One result per line, FromJSON() depends on it:
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const Result& result = results[i];
+			json += "\t\t{\"scene\": \"";
+			AppendEscaped(json, result.scene);
+			json += "\", \"name\": \"";
+			AppendEscaped(json, result.name);
+			snprintf(buffer, sizeof(buffer), "\", \"samples\": %u, \"mean\": %.6f, \"min\": %.6f, \"p50\": %.6f, \"p90\": %.6f, \"p99\": %.6f, \"max\": %.6f}%s\n",
+				(uint32_t)result.samples.size(), result.mean, result.min, result.p50, result.p90, result.p99, result.max, i + 1 < results.size() ? "," : "");
+			json += buffer;
+		}
+
+		json += "\t]\n}\n";
+		return json;
+	}
+
+	// Returns the string value of "key" in line
+	bool ReadString(const std::string& line, const char* key, std::string& value)
+	{
+		const std::string pattern = std::string("\"") + key + "\": \"";
+		size_t pos = line.find(pattern);
+		if (pos == std::string::npos)
+		{
+			return false;
+		}
+		value.clear();
+		for (pos += pattern.length(); pos < line.length() && line[pos] != '"'; ++pos)
+		{
+			if (line[pos] == '\\' && pos + 1 < line.length())
+			{
+				pos++;
+			}
+			value += line[pos];
+		}
+		return true;
+	}
+	// Returns the number value of "key" in line
+	bool ReadNumber(const std::string& line, const char* key, double& value)
+	{
+		const std::string pattern = std::string("\"") + key + "\": ";
+		size_t pos = line.find(pattern);
+		if (pos == std::string::npos)
+		{
+			return false;
+		}
+		value = std::atof(line.c_str() + pos + pattern.length());
+		return true;
+	}
+
+	bool FromJSON(const std::string& json, std::vector<Result>& results)
+	{
+		std::stringstream ss(json);
+		std::string line;
+		while (std::getline(ss, line))
+		{
+			Result result;
+			if (!ReadString(line, "scene", result.scene) || !ReadString(line, "name", result.name))
+			{
+				continue;
+			}
+			bool valid = true;
+			valid &= ReadNumber(line, "mean", result.mean);
+			valid &= ReadNumber(line, "min", result.min);
+			valid &= ReadNumber(line, "p50", result.p50);
+			valid &= ReadNumber(line, "p90", result.p90);
+			valid &= ReadNumber(line, "p99", result.p99);
+			valid &= ReadNumber(line, "max", result.max);
+			if (!valid)
+			{
+				return false;
+			}
+			results.push_back(std::move(result));
+		}
+		return !results.empty();
+	}
+
+	int Compare(const std::vector<Result>& baseline, const std::vector<Result>& results, const Options& options)
+	{
+		// The JSON results can be on the standard output:
+		FILE* out = options.output.empty() ? stderr : stdout;
+
+		int regressions = 0;
+		std::fprintf(out, "%-24s %-56s %12s %12s %9s\n", "scene", "name", "base p50", "p50", "change");
+		for (auto& result : results)
+		{
+			auto it = std::find_if(baseline.begin(), baseline.end(), [&](const Result& x) {
+				return x.scene == result.scene && x.name == result.name;
+			});
+			if (it == baseline.end())
+			{
+				std::fprintf(out, "%-24s %-56s %12s %12.4f %9s\n", result.scene.c_str(), result.name.c_str(), "-", result.p50, "new");
+				continue;
+			}
+			const double difference = result.p50 - it->p50;
+			const double change = it->p50 > 0 ? difference / it->p50 : 0;
+			const bool regression = difference > options.noise && change > options.threshold;
+			const bool improvement = -difference > options.noise && -change > options.threshold;
+			if (regression)
+			{
+				regressions++;
+			}
+			std::fprintf(out, "%-24s %-56s %12.4f %12.4f %+8.1f%%%s\n", result.scene.c_str(), result.name.c_str(), it->p50, result.p50, change * 100,
+				regression ? "  REGRESSION" : (improvement ? "  improved" : ""));
+		}
+		std::fprintf(out, "%d regression(s) over %.0f%% (ignoring differences under %.3f ms)\n", regressions, options.threshold * 100, options.noise);
+		return regressions;
+	}
+
+	std::vector<std::string> FindScenes(const std::string& directory)
+	{
+		std::vector<std::string> scenes;
+#ifdef _WIN32
+		WIN32_FIND_DATAA data;
+		HANDLE handle = FindFirstFileA((directory + "/*.wiscene").c_str(), &data);
+		if (handle != INVALID_HANDLE_VALUE)
+		{
+			do
+			{
+				scenes.push_back(directory + "/" + data.cFileName);
+			} while (FindNextFileA(handle, &data));
+			FindClose(handle);
+		}
+#else
+		DIR* dir = opendir(directory.c_str());
+		if (dir != nullptr)
+		{
+			while (dirent* entry = readdir(dir))
+			{
+				const std::string fileName = entry->d_name;
+				if (wiHelper::toUpper(wiHelper::GetExtensionFromFileName(fileName)) == "WISCENE")
+				{
+					scenes.push_back(directory + "/" + fileName);
+				}
+			}
+			closedir(dir);
+		}
+#endif // _WIN32
+		std::sort(scenes.begin(), scenes.end());
+		return scenes;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "WickedEngine.h"
+
+#include <string>
+#include <vector>
+
+// Headless benchmark of the engine CPU subsystems
+//	The scenes are loaded without a GPU, using wiGraphics::GraphicsDevice_Null without command recording
+namespace Benchmark
+{
+	// Timing samples of one measured section, in milliseconds
+	struct Result
+	{
+		std::string scene;
+		std::string name;
+		std::vector<double> samples;
+
+		// Statistics, filled by Finalize():
+		double mean = 0;
+		double min = 0;
+		double max = 0;
+		double p50 = 0;
+		double p90 = 0;
+		double p99 = 0;
+
+		void Finalize();
+	};
+
+	struct Options
+	{
+		uint32_t frames = 200;			// measured frames per scene
+		uint32_t warmup = 10;			// frames that are run but not measured
+		uint32_t picks = 256;			// rays per frame for the picking benchmark
+		uint32_t threads = 0;			// active wiJobSystem worker threads, 0 = all
+		float threshold = 0.1f;			// relative slowdown of p50 that is reported as regression
+		float noise = 0.01f;			// absolute difference in milliseconds below which changes are ignored
+		std::vector<std::string> scenes;
+		std::string output;				// JSON results are written here (and to stdout if empty)
+		std::string compare;			// baseline JSON to compare the results against
+	};
+
+	// Runs every benchmark on every scene of the options and returns the finalized results
+	std::vector<Result> Run(const Options& options);
+
+	// Writes the results as JSON
+	std::string ToJSON(const Options& options, const std::vector<Result>& results);
+
+	// Reads results that were written by ToJSON(), only the statistics are read back
+	bool FromJSON(const std::string& json, std::vector<Result>& results);
+
+	// Prints the comparison of results against the baseline, returns the number of regressions
+	int Compare(const std::vector<Result>& baseline, const std::vector<Result>& results, const Options& options);
+
+	// Lists the .wiscene files of a directory
+	std::vector<std::string> FindScenes(const std::string& directory);
+}
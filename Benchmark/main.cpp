@@ -0,0 +1,132 @@
+// Headless benchmark of the engine CPU subsystems
+//
+//	Usage: Benchmark [options] [scene.wiscene ...]
+//		--frames N			measured frames per scene (default: 200)
+//		--warmup N			frames that are run before measuring (default: 10)
+//		--picks N			rays per frame in the picking benchmark (default: 256)
+//		--threads N			active wiJobSystem worker threads (default: all)
+//		--models DIR		benchmark every .wiscene in DIR, when no scene is given (default: ../models)
+//		--output FILE		write the JSON results to FILE instead of the standard output
+//		--compare FILE		compare the results with the baseline JSON FILE, returns 1 if there is a regression
+//		--threshold X		relative p50 slowdown that is a regression (default: 0.1)
+//		--noise MS			differences below this many milliseconds are ignored (default: 0.01)
+
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+int main(int argc, char* argv[])
+{
+	Benchmark::Options options;
+	std::string models = "../models";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		auto option = [&](const char* name) {
+			if (std::strcmp(arg, name) != 0)
+				return false;
+			if (value == nullptr)
+			{
+				std::fprintf(stderr, "Missing value for %s\n", name);
+				std::exit(2);
+			}
+			i++;
+			return true;
+		};
+
+		if (option("--frames"))
+			options.frames = (uint32_t)std::atoi(value);
+		else if (option("--warmup"))
+			options.warmup = (uint32_t)std::atoi(value);
+		else if (option("--picks"))
+			options.picks = (uint32_t)std::atoi(value);
+		else if (option("--threads"))
+			options.threads = (uint32_t)std::atoi(value);
+		else if (option("--models"))
+			models = value;
+		else if (option("--output"))
+			options.output = value;
+		else if (option("--compare"))
+			options.compare = value;
+		else if (option("--threshold"))
+			options.threshold = (float)std::atof(value);
+		else if (option("--noise"))
+			options.noise = (float)std::atof(value);
+		else if (arg[0] == '-')
+		{
+			std::fprintf(stderr, "Unknown option: %s\n", arg);
+			return 2;
+		}
+		else
+			options.scenes.push_back(arg);
+	}
+
+	std::vector<Benchmark::Result> baseline;
+	if (!options.compare.empty())
+	{
+		std::vector<uint8_t> data;
+		if (!wiHelper::FileRead(options.compare, data) || !Benchmark::FromJSON(std::string(data.begin(), data.end()), baseline))
+		{
+			std::fprintf(stderr, "Failed to read baseline: %s\n", options.compare.c_str());
+			return 2;
+		}
+	}
+
+	if (options.scenes.empty())
+	{
+		options.scenes = Benchmark::FindScenes(models);
+		if (options.scenes.empty())
+		{
+			std::fprintf(stderr, "No .wiscene files found in %s\n", models.c_str());
+			return 2;
+		}
+	}
+
+	// Only the CPU side of the engine is initialized, with a graphics device that doesn't need a GPU:
+	wiBackLog::setStdOutput(false);
+	// Textures don't need shadow storage and commands are only counted, to keep the device overhead out of the measurements:
+	auto device = std::make_shared<wiGraphics::GraphicsDevice_Null>(1920, 1080, false);
+	device->SetCommandRecording(false);
+	wiRenderer::SetDevice(device);
+	wiJobSystem::Initialize();
+	wiRenderer::Initialize();
+	wiTextureHelper::Initialize();
+	wiScene::wiHairParticle::Initialize();
+	wiScene::wiEmittedParticle::Initialize();
+	wiPhysicsEngine::Initialize();
+
+	// Shaders are not available without a GPU, their error messages are irrelevant:
+	wiPlatform::GetWindowState().messagemutex.lock();
+	wiPlatform::GetWindowState().messages.clear();
+	wiPlatform::GetWindowState().messagemutex.unlock();
+
+	std::vector<Benchmark::Result> results = Benchmark::Run(options);
+
+	const std::string json = Benchmark::ToJSON(options, results);
+	if (options.output.empty())
+	{
+		std::fwrite(json.data(), 1, json.size(), stdout);
+	}
+	else if (!wiHelper::FileWrite(options.output, (const uint8_t*)json.data(), json.size()))
+	{
+		std::fprintf(stderr, "Failed to write results: %s\n", options.output.c_str());
+		return 2;
+	}
+
+	int regressions = 0;
+	if (!baseline.empty())
+	{
+		regressions = Benchmark::Compare(baseline, results, options);
+	}
+
+	std::fflush(stdout);
+	wiBackLog::flush();
+
+	// Worker threads are not joined, skip the static destructors:
+	std::_Exit(regressions > 0 ? 1 : 0);
+}
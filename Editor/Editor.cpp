@@ -149,6 +149,7 @@ void EditorComponent::ChangeRenderPath(RENDERPATH path)
 	renderPath->Initialize();
 	renderPath->Load();
 	renderPath->Update(0);
+	renderPath->PreRender();
 
 	materialWnd = std::make_unique<MaterialWindow>(this);
 	postprocessWnd = std::make_unique<PostprocessWindow>(this);
@@ -1761,7 +1762,7 @@ void EditorComponent::Update(float dt)
 
 	renderPath->Update(dt);
 }
-void EditorComponent::Render() const
+void EditorComponent::PreRender()
 {
 	Scene& scene = wiScene::GetScene();
 
@@ -1887,6 +1888,13 @@ void EditorComponent::Render() const
 
 	paintToolWnd->DrawBrush();
 
+	// The render path is prepared first, because the editor render targets depend on its depth buffer and sample count:
+	renderPath->PreRender();
+
+	__super::PreRender();
+}
+void EditorComponent::Render() const
+{
 	renderPath->Render();
 
 	// Selection outline:
@@ -1945,9 +1953,12 @@ void EditorComponent::Render() const
 
 		device->EventEnd(cmd);
 	}
+}
+void EditorComponent::PostRender() const
+{
+	renderPath->PostRender();
 
-	__super::Render();
-
+	__super::PostRender();
 }
 void EditorComponent::Compose(CommandList cmd) const
 {
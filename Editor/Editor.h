@@ -126,7 +126,9 @@ public:
 	void Start() override;
 	void FixedUpdate() override;
 	void Update(float dt) override;
+	void PreRender() override;
 	void Render() const override;
+	void PostRender() const override;
 	void Compose(wiGraphics::CommandList cmd) const override;
 	void Unload() override;
 
@@ -13,7 +13,7 @@ EmitterWindow::EmitterWindow(EditorComponent* editor) : GUI(&editor->GetGUI())
 	assert(GUI && "Invalid GUI!");
 
 	emitterWindow = new wiWindow(GUI, "Emitter Window");
-	emitterWindow->SetSize(XMFLOAT2(680, 700));
+	emitterWindow->SetSize(XMFLOAT2(680, 722));
 	GUI->AddWidget(emitterWindow);
 
 	float x = 200;
@@ -206,6 +206,21 @@ EmitterWindow::EmitterWindow(EditorComponent* editor) : GUI(&editor->GetGUI())
 	emitterWindow->AddWidget(frameBlendingCheckBox);
 
 
+	cpuSimulationCheckBox = new wiCheckBox("CPU Simulation: ");
+	cpuSimulationCheckBox->SetPos(XMFLOAT2(x, y += step));
+	cpuSimulationCheckBox->SetSize(XMFLOAT2(itemheight, itemheight));
+	cpuSimulationCheckBox->OnClick([&](wiEventArgs args) {
+		auto emitter = GetEmitter();
+		if (emitter != nullptr)
+		{
+			emitter->SetCPUSimulationEnabled(args.bValue);
+		}
+		});
+	cpuSimulationCheckBox->SetCheck(false);
+	cpuSimulationCheckBox->SetTooltip("Simulate the particles on the CPU with SIMD instead of compute shaders. The results are uploaded to the GPU every frame. Toggling restarts the emitter.");
+	emitterWindow->AddWidget(cpuSimulationCheckBox);
+
+
 
 	infoLabel = new wiLabel("EmitterInfo");
 	infoLabel->SetSize(XMFLOAT2(380, 120));
@@ -561,6 +576,7 @@ void EmitterWindow::SetEntity(Entity entity)
 		debugCheckBox->SetEnabled(true);
 		volumeCheckBox->SetEnabled(true);
 		frameBlendingCheckBox->SetEnabled(true);
+		cpuSimulationCheckBox->SetEnabled(true);
 		sortCheckBox->SetEnabled(true);
 		depthCollisionsCheckBox->SetEnabled(true);
 		sphCheckBox->SetEnabled(true);
@@ -590,6 +606,7 @@ void EmitterWindow::SetEntity(Entity entity)
 		pauseCheckBox->SetCheck(emitter->IsPaused());
 		volumeCheckBox->SetCheck(emitter->IsVolumeEnabled());
 		frameBlendingCheckBox->SetCheck(emitter->IsFrameBlendingEnabled());
+		cpuSimulationCheckBox->SetCheck(emitter->IsCPUSimulationEnabled());
 		maxParticlesSlider->SetValue((float)emitter->GetMaxParticleCount());
 
 		frameRateInput->SetValue(emitter->frameRate);
@@ -626,6 +643,7 @@ void EmitterWindow::SetEntity(Entity entity)
 		debugCheckBox->SetEnabled(false);
 		volumeCheckBox->SetEnabled(false);
 		frameBlendingCheckBox->SetEnabled(false);
+		cpuSimulationCheckBox->SetEnabled(false);
 		sortCheckBox->SetEnabled(false);
 		depthCollisionsCheckBox->SetEnabled(false);
 		sphCheckBox->SetEnabled(false);
@@ -44,6 +44,7 @@ public:
 	wiCheckBox* debugCheckBox;
 	wiCheckBox* volumeCheckBox;
 	wiCheckBox* frameBlendingCheckBox;
+	wiCheckBox* cpuSimulationCheckBox;
 	wiSlider* emitCountSlider;
 	wiSlider* emitSizeSlider;
 	wiSlider* emitRotationSlider;
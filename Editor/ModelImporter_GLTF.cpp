@@ -94,48 +94,37 @@ namespace tinygltf
 		std::string *warn, int req_width, int req_height,
 		const unsigned char *bytes, int size, void *)
 	{
-		(void)warn;
+		// The image is only stored while parsing, it will be decoded later in parallel with the geometry (see DecodeImage()):
+		image->as_is = true;
+		image->image.assign(bytes, bytes + size);
+		return true;
+	}
+
+	// Decodes an image that was stored as-is by LoadImageData() into RGBA8 pixels
+	bool DecodeImage(Image *image, std::string *err)
+	{
+		if (!image->as_is)
+		{
+			return true;
+		}
+		image->as_is = false;
 
 		const int requiredComponents = 4;
 
 		int w, h, comp;
-		unsigned char *data = stbi_load_from_memory(bytes, size, &w, &h, &comp, requiredComponents);
+		unsigned char *data = stbi_load_from_memory(image->image.data(), static_cast<int>(image->image.size()), &w, &h, &comp, requiredComponents);
+		image->image.clear();
 		if (!data) {
-			// NOTE: you can use `warn` instead of `err`
-			if (err) {
-				(*err) += "Unknown image format.\n";
-			}
+			(*err) += "Unknown image format.\n";
 			return false;
 		}
 
 		if (w < 1 || h < 1) {
 			free(data);
-			if (err) {
-				(*err) += "Invalid image data.\n";
-			}
+			(*err) += "Invalid image data.\n";
 			return false;
 		}
 
-		if (req_width > 0) {
-			if (req_width != w) {
-				free(data);
-				if (err) {
-					(*err) += "Image width mismatch.\n";
-				}
-				return false;
-			}
-		}
-
-		if (req_height > 0) {
-			if (req_height != h) {
-				free(data);
-				if (err) {
-					(*err) += "Image height mismatch.\n";
-				}
-				return false;
-			}
-		}
-
 		image->width = w;
 		image->height = h;
 		image->component = requiredComponents;
@@ -350,6 +339,259 @@ void LoadNode(int nodeIndex, Entity parent, LoaderState& state)
 	}
 }
 
+// Copies the elements of an accessor to a tightly packed array
+//	Tightly packed accessors are copied at once, interleaved ones element by element
+void CopyAccessor(const tinygltf::Model& model, const tinygltf::Accessor& accessor, size_t elementSize, void* dest)
+{
+	const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+	const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+
+	const size_t stride = (size_t)accessor.ByteStride(bufferView);
+	const size_t count = accessor.count;
+	const unsigned char* data = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
+
+	if (stride == elementSize)
+	{
+		memcpy(dest, data, count * elementSize);
+	}
+	else
+	{
+		assert(stride > elementSize);
+		unsigned char* dest_data = (unsigned char*)dest;
+		for (size_t i = 0; i < count; ++i)
+		{
+			memcpy(dest_data + i * elementSize, data + i * stride, elementSize);
+		}
+	}
+}
+
+// Fills the vertex and index arrays of a mesh, this can run on any thread
+//	Only the mesh component is written, the material entities must already exist in the scene
+void LoadMesh(const tinygltf::Mesh& x, const LoaderState& state, MeshComponent& mesh)
+{
+	const tinygltf::Model& model = state.gltfModel;
+	const Scene& scene = *state.scene;
+
+	for (auto& prim : x.primitives)
+	{
+		assert(prim.indices >= 0);
+
+		// Fill indices:
+		const tinygltf::Accessor& accessor = model.accessors[prim.indices];
+		const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+		const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+
+		int stride = accessor.ByteStride(bufferView);
+		size_t indexCount = accessor.count;
+		size_t indexOffset = mesh.indices.size();
+		mesh.indices.resize(indexOffset + indexCount);
+
+		mesh.subsets.push_back(MeshComponent::MeshSubset());
+		mesh.subsets.back().indexOffset = (uint32_t)indexOffset;
+		mesh.subsets.back().indexCount = (uint32_t)indexCount;
+
+		mesh.subsets.back().materialID = scene.materials.GetEntity(max(0, prim.material));
+
+		uint32_t vertexOffset = (uint32_t)mesh.vertex_positions.size();
+
+		const unsigned char* data = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
+
+		int index_remap[3];
+		if (transform_to_LH)
+		{
+			index_remap[0] = 0;
+			index_remap[1] = 1;
+			index_remap[2] = 2;
+		}
+		else
+		{
+			index_remap[0] = 0;
+			index_remap[1] = 2;
+			index_remap[2] = 1;
+		}
+
+		if (stride == 1)
+		{
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				mesh.indices[indexOffset + i + 0] = vertexOffset + data[i + index_remap[0]];
+				mesh.indices[indexOffset + i + 1] = vertexOffset + data[i + index_remap[1]];
+				mesh.indices[indexOffset + i + 2] = vertexOffset + data[i + index_remap[2]];
+			}
+		}
+		else if (stride == 2)
+		{
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				mesh.indices[indexOffset + i + 0] = vertexOffset + ((uint16_t*)data)[i + index_remap[0]];
+				mesh.indices[indexOffset + i + 1] = vertexOffset + ((uint16_t*)data)[i + index_remap[1]];
+				mesh.indices[indexOffset + i + 2] = vertexOffset + ((uint16_t*)data)[i + index_remap[2]];
+			}
+		}
+		else if (stride == 4)
+		{
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				mesh.indices[indexOffset + i + 0] = vertexOffset + ((uint32_t*)data)[i + index_remap[0]];
+				mesh.indices[indexOffset + i + 1] = vertexOffset + ((uint32_t*)data)[i + index_remap[1]];
+				mesh.indices[indexOffset + i + 2] = vertexOffset + ((uint32_t*)data)[i + index_remap[2]];
+			}
+		}
+		else
+		{
+			assert(0 && "unsupported index stride!");
+		}
+
+		for (auto& attr : prim.attributes)
+		{
+			const string& attr_name = attr.first;
+			int attr_data = attr.second;
+
+			const tinygltf::Accessor& accessor = model.accessors[attr_data];
+			const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+			const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+
+			int stride = accessor.ByteStride(bufferView);
+			size_t vertexCount = accessor.count;
+
+			const unsigned char* data = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
+
+			if (!attr_name.compare("POSITION"))
+			{
+				mesh.vertex_positions.resize(vertexOffset + vertexCount);
+				assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+				CopyAccessor(model, accessor, sizeof(XMFLOAT3), mesh.vertex_positions.data() + vertexOffset);
+			}
+			else if (!attr_name.compare("NORMAL"))
+			{
+				mesh.vertex_normals.resize(vertexOffset + vertexCount);
+				assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+				CopyAccessor(model, accessor, sizeof(XMFLOAT3), mesh.vertex_normals.data() + vertexOffset);
+			}
+			else if (!attr_name.compare("TEXCOORD_0"))
+			{
+				mesh.vertex_uvset_0.resize(vertexOffset + vertexCount);
+				assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+				CopyAccessor(model, accessor, sizeof(XMFLOAT2), mesh.vertex_uvset_0.data() + vertexOffset);
+			}
+			else if (!attr_name.compare("TEXCOORD_1"))
+			{
+				mesh.vertex_uvset_1.resize(vertexOffset + vertexCount);
+				assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+				CopyAccessor(model, accessor, sizeof(XMFLOAT2), mesh.vertex_uvset_1.data() + vertexOffset);
+			}
+			else if (!attr_name.compare("JOINTS_0"))
+			{
+				mesh.vertex_boneindices.resize(vertexOffset + vertexCount);
+				if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
+				{
+					for (size_t i = 0; i < vertexCount; ++i)
+					{
+						const uint8_t* joint = (const uint8_t*)(data + i * stride);
+
+						mesh.vertex_boneindices[vertexOffset + i].x = joint[0];
+						mesh.vertex_boneindices[vertexOffset + i].y = joint[1];
+						mesh.vertex_boneindices[vertexOffset + i].z = joint[2];
+						mesh.vertex_boneindices[vertexOffset + i].w = joint[3];
+					}
+				}
+				else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+				{
+					for (size_t i = 0; i < vertexCount; ++i)
+					{
+						const uint16_t* joint = (const uint16_t*)(data + i * stride);
+
+						mesh.vertex_boneindices[vertexOffset + i].x = joint[0];
+						mesh.vertex_boneindices[vertexOffset + i].y = joint[1];
+						mesh.vertex_boneindices[vertexOffset + i].z = joint[2];
+						mesh.vertex_boneindices[vertexOffset + i].w = joint[3];
+					}
+				}
+				else
+				{
+					assert(0);
+				}
+			}
+			else if (!attr_name.compare("WEIGHTS_0"))
+			{
+				mesh.vertex_boneweights.resize(vertexOffset + vertexCount);
+				assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+				CopyAccessor(model, accessor, sizeof(XMFLOAT4), mesh.vertex_boneweights.data() + vertexOffset);
+			}
+			else if (!attr_name.compare("COLOR_0"))
+			{
+				mesh.vertex_colors.resize(vertexOffset + vertexCount);
+				assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+				assert(accessor.type == TINYGLTF_TYPE_VEC4);
+				for (size_t i = 0; i < vertexCount; ++i)
+				{
+					const XMFLOAT4& color = *(const XMFLOAT4*)(data + i * stride);
+					uint32_t rgba = wiMath::CompressColor(color);
+
+					mesh.vertex_colors[vertexOffset + i] = rgba;
+				}
+			}
+
+		}
+
+	}
+
+	mesh.CreateRenderData();
+}
+
+// Keyframes of an animation sampler that were read on a worker thread
+struct AnimationSamplerData
+{
+	AnimationDataComponent animationdata;
+	float start = 0;
+	float end = 0;
+};
+
+// Reads the keyframe times and data of an animation sampler, this can run on any thread
+void LoadAnimationSampler(const tinygltf::AnimationSampler& sam, const tinygltf::Model& model, AnimationSamplerData& sampler)
+{
+	AnimationDataComponent& animationdata = sampler.animationdata;
+
+	// AnimationSampler input = keyframe times
+	{
+		const tinygltf::Accessor& accessor = model.accessors[sam.input];
+
+		assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+
+		animationdata.keyframe_times.resize(accessor.count);
+		CopyAccessor(model, accessor, sizeof(float), animationdata.keyframe_times.data());
+
+		for (float time : animationdata.keyframe_times)
+		{
+			sampler.start = min(sampler.start, time);
+			sampler.end = max(sampler.end, time);
+		}
+	}
+
+	// AnimationSampler output = keyframe data
+	{
+		const tinygltf::Accessor& accessor = model.accessors[sam.output];
+
+		switch (accessor.type)
+		{
+		case TINYGLTF_TYPE_VEC3:
+		{
+			animationdata.keyframe_data.resize(accessor.count * 3);
+			CopyAccessor(model, accessor, sizeof(XMFLOAT3), animationdata.keyframe_data.data());
+		}
+		break;
+		case TINYGLTF_TYPE_VEC4:
+		{
+			animationdata.keyframe_data.resize(accessor.count * 4);
+			CopyAccessor(model, accessor, sizeof(XMFLOAT4), animationdata.keyframe_data.data());
+		}
+		break;
+		default: assert(0); break;
+
+		}
+	}
+}
+
 void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 {
 	string directory, name;
@@ -408,10 +650,23 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 	Entity rootEntity = CreateEntity();
 	scene.transforms.Create(rootEntity);
 
-	// Create materials:
+	// The images are decoded in parallel while the geometry and animations are processed:
+	wiJobSystem::context ctx;
+	vector<string> imageErrors(state.gltfModel.images.size());
+	for (size_t i = 0; i < state.gltfModel.images.size(); ++i)
+	{
+		wiJobSystem::Execute(ctx, [&state, &imageErrors, i](wiJobArgs args) {
+			tinygltf::DecodeImage(&state.gltfModel.images[i], &imageErrors[i]);
+		});
+	}
+
+	// Create materials, the textures are assigned after the images are decoded:
+	vector<Entity> materialEntities;
+	materialEntities.reserve(state.gltfModel.materials.size());
 	for (auto& x : state.gltfModel.materials)
 	{
 		Entity materialEntity = scene.Entity_CreateMaterial(x.name);
+		materialEntities.push_back(materialEntity);
 
 		MaterialComponent& material = *scene.materials.GetComponent(materialEntity);
 
@@ -421,64 +676,15 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 		material.reflectance = 0.02f;
 
 		// metallic-roughness workflow:
-		auto baseColorTexture = x.values.find("baseColorTexture");
-		auto metallicRoughnessTexture = x.values.find("metallicRoughnessTexture");
 		auto baseColorFactor = x.values.find("baseColorFactor");
 		auto roughnessFactor = x.values.find("roughnessFactor");
 		auto metallicFactor = x.values.find("metallicFactor");
 
 		// common workflow:
-		auto normalTexture = x.additionalValues.find("normalTexture");
-		auto emissiveTexture = x.additionalValues.find("emissiveTexture");
-		auto occlusionTexture = x.additionalValues.find("occlusionTexture");
 		auto emissiveFactor = x.additionalValues.find("emissiveFactor");
 		auto alphaCutoff = x.additionalValues.find("alphaCutoff");
 		auto alphaMode = x.additionalValues.find("alphaMode");
 
-
-		if (baseColorTexture != x.values.end())
-		{
-			auto& tex = state.gltfModel.textures[baseColorTexture->second.TextureIndex()];
-			auto& img = state.gltfModel.images[tex.source];
-			material.baseColorMap = RegisterTexture(&img, "basecolor");
-			material.baseColorMapName = img.uri;
-			material.uvset_baseColorMap = baseColorTexture->second.TextureTexCoord();
-		}
-		if (normalTexture != x.additionalValues.end())
-		{
-			auto& tex = state.gltfModel.textures[normalTexture->second.TextureIndex()];
-			auto& img = state.gltfModel.images[tex.source];
-			material.normalMap = RegisterTexture(&img, "normal");
-			material.normalMapName = img.uri;
-			material.SetFlipNormalMap(true); // gltf import will always flip normal map by default
-			material.uvset_normalMap = normalTexture->second.TextureTexCoord();
-		}
-		if (metallicRoughnessTexture != x.values.end())
-		{
-			auto& tex = state.gltfModel.textures[metallicRoughnessTexture->second.TextureIndex()];
-			auto& img = state.gltfModel.images[tex.source];
-			material.surfaceMap = RegisterTexture(&img, "roughness_metallic");
-			material.surfaceMapName = img.uri;
-			material.uvset_surfaceMap = metallicRoughnessTexture->second.TextureTexCoord();
-		}
-		if (emissiveTexture != x.additionalValues.end())
-		{
-			auto& tex = state.gltfModel.textures[emissiveTexture->second.TextureIndex()];
-			auto& img = state.gltfModel.images[tex.source];
-			material.emissiveMap = RegisterTexture(&img, "emissive");
-			material.emissiveMapName = img.uri;
-			material.uvset_emissiveMap = emissiveTexture->second.TextureTexCoord();
-		}
-		if (occlusionTexture != x.additionalValues.end())
-		{
-			auto& tex = state.gltfModel.textures[occlusionTexture->second.TextureIndex()];
-			auto& img = state.gltfModel.images[tex.source];
-			material.occlusionMap = RegisterTexture(&img, "occlusion");
-			material.occlusionMapName = img.uri;
-			material.uvset_occlusionMap = occlusionTexture->second.TextureTexCoord();
-			material.SetOcclusionEnabled_Secondary(true);
-		}
-
 		if (baseColorFactor != x.values.end())
 		{
 			material.baseColor.x = float(baseColorFactor->second.ColorFactor()[0]);
@@ -519,25 +725,6 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 		{
 			material.SetUseSpecularGlossinessWorkflow(true);
 
-			if (specularGlossinessWorkflow->second.Has("diffuseTexture"))
-			{
-				int index = specularGlossinessWorkflow->second.Get("diffuseTexture").Get("index").Get<int>();
-				auto& tex = state.gltfModel.textures[index];
-				auto& img = state.gltfModel.images[tex.source];
-				material.baseColorMap = RegisterTexture(&img, "diffuse");
-				material.baseColorMapName = img.uri;
-				material.uvset_baseColorMap = (uint32_t)specularGlossinessWorkflow->second.Get("diffuseTexture").Get("texCoord").Get<int>();
-			}
-			if (specularGlossinessWorkflow->second.Has("specularGlossinessTexture"))
-			{
-				int index = specularGlossinessWorkflow->second.Get("specularGlossinessTexture").Get("index").Get<int>();
-				auto& tex = state.gltfModel.textures[index];
-				auto& img = state.gltfModel.images[tex.source];
-				material.surfaceMap = RegisterTexture(&img, "specular_glossiness");
-				material.surfaceMapName = img.uri;
-				material.uvset_surfaceMap = (uint32_t)specularGlossinessWorkflow->second.Get("specularGlossinessTexture").Get("texCoord").Get<int>();
-			}
-
 			if (specularGlossinessWorkflow->second.Has("diffuseFactor"))
 			{
 				auto& factor = specularGlossinessWorkflow->second.Get("diffuseFactor");
@@ -571,207 +758,29 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 		scene.Entity_CreateMaterial("gltfimport_defaultMaterial");
 	}
 
-	// Create meshes:
+
+	// Create meshes, their data is filled in parallel:
+	//	The component pointers stay valid while the jobs are running, because no other meshes are created until the Wait()
+	vector<MeshComponent*> meshComponents;
+	meshComponents.reserve(state.gltfModel.meshes.size());
 	for (auto& x : state.gltfModel.meshes)
 	{
 		Entity meshEntity = scene.Entity_CreateMesh(x.name);
-		MeshComponent& mesh = *scene.meshes.GetComponent(meshEntity);
-
-		for (auto& prim : x.primitives)
-		{
-			assert(prim.indices >= 0);
-
-			// Fill indices:
-			const tinygltf::Accessor& accessor = state.gltfModel.accessors[prim.indices];
-			const tinygltf::BufferView& bufferView = state.gltfModel.bufferViews[accessor.bufferView];
-			const tinygltf::Buffer& buffer = state.gltfModel.buffers[bufferView.buffer];
-
-			int stride = accessor.ByteStride(bufferView);
-			size_t indexCount = accessor.count;
-			size_t indexOffset = mesh.indices.size();
-			mesh.indices.resize(indexOffset + indexCount);
-
-			mesh.subsets.push_back(MeshComponent::MeshSubset());
-			mesh.subsets.back().indexOffset = (uint32_t)indexOffset;
-			mesh.subsets.back().indexCount = (uint32_t)indexCount;
-
-			mesh.subsets.back().materialID = scene.materials.GetEntity(max(0, prim.material));
-
-			uint32_t vertexOffset = (uint32_t)mesh.vertex_positions.size();
-
-			const unsigned char* data = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
-
-			int index_remap[3];
-			if (transform_to_LH)
-			{
-				index_remap[0] = 0;
-				index_remap[1] = 1;
-				index_remap[2] = 2;
-			}
-			else
-			{
-				index_remap[0] = 0;
-				index_remap[1] = 2;
-				index_remap[2] = 1;
-			}
-
-			if (stride == 1)
-			{
-				for (size_t i = 0; i < indexCount; i += 3)
-				{
-					mesh.indices[indexOffset + i + 0] = vertexOffset + data[i + index_remap[0]];
-					mesh.indices[indexOffset + i + 1] = vertexOffset + data[i + index_remap[1]];
-					mesh.indices[indexOffset + i + 2] = vertexOffset + data[i + index_remap[2]];
-				}
-			}
-			else if (stride == 2)
-			{
-				for (size_t i = 0; i < indexCount; i += 3)
-				{
-					mesh.indices[indexOffset + i + 0] = vertexOffset + ((uint16_t*)data)[i + index_remap[0]];
-					mesh.indices[indexOffset + i + 1] = vertexOffset + ((uint16_t*)data)[i + index_remap[1]];
-					mesh.indices[indexOffset + i + 2] = vertexOffset + ((uint16_t*)data)[i + index_remap[2]];
-				}
-			}
-			else if (stride == 4)
-			{
-				for (size_t i = 0; i < indexCount; i += 3)
-				{
-					mesh.indices[indexOffset + i + 0] = vertexOffset + ((uint32_t*)data)[i + index_remap[0]];
-					mesh.indices[indexOffset + i + 1] = vertexOffset + ((uint32_t*)data)[i + index_remap[1]];
-					mesh.indices[indexOffset + i + 2] = vertexOffset + ((uint32_t*)data)[i + index_remap[2]];
-				}
-			}
-			else
-			{
-				assert(0 && "unsupported index stride!");
-			}
-
-			for (auto& attr : prim.attributes)
-			{
-				const string& attr_name = attr.first;
-				int attr_data = attr.second;
-
-				const tinygltf::Accessor& accessor = state.gltfModel.accessors[attr_data];
-				const tinygltf::BufferView& bufferView = state.gltfModel.bufferViews[accessor.bufferView];
-				const tinygltf::Buffer& buffer = state.gltfModel.buffers[bufferView.buffer];
-
-				int stride = accessor.ByteStride(bufferView);
-				size_t vertexCount = accessor.count;
-
-				const unsigned char* data = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
-
-				if (!attr_name.compare("POSITION"))
-				{
-					mesh.vertex_positions.resize(vertexOffset + vertexCount);
-					assert(stride == 12);
-					for (size_t i = 0; i < vertexCount; ++i)
-					{
-						mesh.vertex_positions[vertexOffset + i] = ((XMFLOAT3*)data)[i];
-					}
-				}
-				else if (!attr_name.compare("NORMAL"))
-				{
-					mesh.vertex_normals.resize(vertexOffset + vertexCount);
-					assert(stride == 12);
-					for (size_t i = 0; i < vertexCount; ++i)
-					{
-						mesh.vertex_normals[vertexOffset + i] = ((XMFLOAT3*)data)[i];
-					}
-				}
-				else if (!attr_name.compare("TEXCOORD_0"))
-				{
-					mesh.vertex_uvset_0.resize(vertexOffset + vertexCount);
-					assert(stride == 8);
-					for (size_t i = 0; i < vertexCount; ++i)
-					{
-						const XMFLOAT2& tex = ((XMFLOAT2*)data)[i];
-
-						mesh.vertex_uvset_0[vertexOffset + i].x = tex.x;
-						mesh.vertex_uvset_0[vertexOffset + i].y = tex.y;
-					}
-				}
-				else if (!attr_name.compare("TEXCOORD_1"))
-				{
-					mesh.vertex_uvset_1.resize(vertexOffset + vertexCount);
-					assert(stride == 8);
-					for (size_t i = 0; i < vertexCount; ++i)
-					{
-						const XMFLOAT2& tex = ((XMFLOAT2*)data)[i];
-
-						mesh.vertex_uvset_1[vertexOffset + i].x = tex.x;
-						mesh.vertex_uvset_1[vertexOffset + i].y = tex.y;
-					}
-				}
-				else if (!attr_name.compare("JOINTS_0"))
-				{
-					mesh.vertex_boneindices.resize(vertexOffset + vertexCount);
-					if (stride == 4)
-					{
-						struct JointTmp
-						{
-							uint8_t ind[4];
-						};
-
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							const JointTmp& joint = ((JointTmp*)data)[i];
-
-							mesh.vertex_boneindices[vertexOffset + i].x = joint.ind[0];
-							mesh.vertex_boneindices[vertexOffset + i].y = joint.ind[1];
-							mesh.vertex_boneindices[vertexOffset + i].z = joint.ind[2];
-							mesh.vertex_boneindices[vertexOffset + i].w = joint.ind[3];
-						}
-					}
-					else if (stride == 8)
-					{
-						struct JointTmp
-						{
-							uint16_t ind[4];
-						};
-
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							const JointTmp& joint = ((JointTmp*)data)[i];
-
-							mesh.vertex_boneindices[vertexOffset + i].x = joint.ind[0];
-							mesh.vertex_boneindices[vertexOffset + i].y = joint.ind[1];
-							mesh.vertex_boneindices[vertexOffset + i].z = joint.ind[2];
-							mesh.vertex_boneindices[vertexOffset + i].w = joint.ind[3];
-						}
-					}
-					else
-					{
-						assert(0);
-					}
-				}
-				else if (!attr_name.compare("WEIGHTS_0"))
-				{
-					mesh.vertex_boneweights.resize(vertexOffset + vertexCount);
-					assert(stride == 16);
-					for (size_t i = 0; i < vertexCount; ++i)
-					{
-						mesh.vertex_boneweights[vertexOffset + i] = ((XMFLOAT4*)data)[i];
-					}
-				}
-				else if (!attr_name.compare("COLOR_0"))
-				{
-					mesh.vertex_colors.resize(vertexOffset + vertexCount);
-					assert(stride == 16);
-					for (size_t i = 0; i < vertexCount; ++i)
-					{
-						const XMFLOAT4& color = ((XMFLOAT4*)data)[i];
-						uint32_t rgba = wiMath::CompressColor(color);
-
-						mesh.vertex_colors[vertexOffset + i] = rgba;
-					}
-				}
-
-			}
-
-		}
+		meshComponents.push_back(scene.meshes.GetComponent(meshEntity));
+	}
+	wiJobSystem::Dispatch(ctx, (uint32_t)meshComponents.size(), 1, [&](wiJobArgs args) {
+		LoadMesh(state.gltfModel.meshes[args.jobIndex], state, *meshComponents[args.jobIndex]);
+	});
 
-		mesh.CreateRenderData();
+	// Read the animation keyframes in parallel, the animation entities are created after the nodes:
+	vector<vector<AnimationSamplerData>> animationSamplers(state.gltfModel.animations.size());
+	for (size_t i = 0; i < state.gltfModel.animations.size(); ++i)
+	{
+		const tinygltf::Animation& anim = state.gltfModel.animations[i];
+		animationSamplers[i].resize(anim.samplers.size());
+		wiJobSystem::Dispatch(ctx, (uint32_t)anim.samplers.size(), 1, [&anim, &state, &animationSamplers, i](wiJobArgs args) {
+			LoadAnimationSampler(anim.samplers[args.jobIndex], state.gltfModel, animationSamplers[i][args.jobIndex]);
+		});
 	}
 
 	// Create armatures:
@@ -797,6 +806,95 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 		}
 	}
 
+	wiJobSystem::Wait(ctx);
+
+	for (size_t i = 0; i < imageErrors.size(); ++i)
+	{
+		if (!imageErrors[i].empty())
+		{
+			wiBackLog::postf(wiBackLog::LEVEL_ERROR, "GLTF image %d could not be decoded: %s", (int)i, imageErrors[i].c_str());
+		}
+	}
+
+	// Assign the material textures in the original order, so the embedded images are exported with the same names:
+	for (size_t materialIndex = 0; materialIndex < materialEntities.size(); ++materialIndex)
+	{
+		auto& x = state.gltfModel.materials[materialIndex];
+		MaterialComponent& material = *scene.materials.GetComponent(materialEntities[materialIndex]);
+
+		auto baseColorTexture = x.values.find("baseColorTexture");
+		auto metallicRoughnessTexture = x.values.find("metallicRoughnessTexture");
+		auto normalTexture = x.additionalValues.find("normalTexture");
+		auto emissiveTexture = x.additionalValues.find("emissiveTexture");
+		auto occlusionTexture = x.additionalValues.find("occlusionTexture");
+
+		if (baseColorTexture != x.values.end())
+		{
+			auto& tex = state.gltfModel.textures[baseColorTexture->second.TextureIndex()];
+			auto& img = state.gltfModel.images[tex.source];
+			material.baseColorMap = RegisterTexture(&img, "basecolor");
+			material.baseColorMapName = img.uri;
+			material.uvset_baseColorMap = baseColorTexture->second.TextureTexCoord();
+		}
+		if (normalTexture != x.additionalValues.end())
+		{
+			auto& tex = state.gltfModel.textures[normalTexture->second.TextureIndex()];
+			auto& img = state.gltfModel.images[tex.source];
+			material.normalMap = RegisterTexture(&img, "normal");
+			material.normalMapName = img.uri;
+			material.SetFlipNormalMap(true); // gltf import will always flip normal map by default
+			material.uvset_normalMap = normalTexture->second.TextureTexCoord();
+		}
+		if (metallicRoughnessTexture != x.values.end())
+		{
+			auto& tex = state.gltfModel.textures[metallicRoughnessTexture->second.TextureIndex()];
+			auto& img = state.gltfModel.images[tex.source];
+			material.surfaceMap = RegisterTexture(&img, "roughness_metallic");
+			material.surfaceMapName = img.uri;
+			material.uvset_surfaceMap = metallicRoughnessTexture->second.TextureTexCoord();
+		}
+		if (emissiveTexture != x.additionalValues.end())
+		{
+			auto& tex = state.gltfModel.textures[emissiveTexture->second.TextureIndex()];
+			auto& img = state.gltfModel.images[tex.source];
+			material.emissiveMap = RegisterTexture(&img, "emissive");
+			material.emissiveMapName = img.uri;
+			material.uvset_emissiveMap = emissiveTexture->second.TextureTexCoord();
+		}
+		if (occlusionTexture != x.additionalValues.end())
+		{
+			auto& tex = state.gltfModel.textures[occlusionTexture->second.TextureIndex()];
+			auto& img = state.gltfModel.images[tex.source];
+			material.occlusionMap = RegisterTexture(&img, "occlusion");
+			material.occlusionMapName = img.uri;
+			material.uvset_occlusionMap = occlusionTexture->second.TextureTexCoord();
+			material.SetOcclusionEnabled_Secondary(true);
+		}
+
+		auto specularGlossinessWorkflow = x.extensions.find("KHR_materials_pbrSpecularGlossiness");
+		if (specularGlossinessWorkflow != x.extensions.end())
+		{
+			if (specularGlossinessWorkflow->second.Has("diffuseTexture"))
+			{
+				int index = specularGlossinessWorkflow->second.Get("diffuseTexture").Get("index").Get<int>();
+				auto& tex = state.gltfModel.textures[index];
+				auto& img = state.gltfModel.images[tex.source];
+				material.baseColorMap = RegisterTexture(&img, "diffuse");
+				material.baseColorMapName = img.uri;
+				material.uvset_baseColorMap = (uint32_t)specularGlossinessWorkflow->second.Get("diffuseTexture").Get("texCoord").Get<int>();
+			}
+			if (specularGlossinessWorkflow->second.Has("specularGlossinessTexture"))
+			{
+				int index = specularGlossinessWorkflow->second.Get("specularGlossinessTexture").Get("index").Get<int>();
+				auto& tex = state.gltfModel.textures[index];
+				auto& img = state.gltfModel.images[tex.source];
+				material.surfaceMap = RegisterTexture(&img, "specular_glossiness");
+				material.surfaceMapName = img.uri;
+				material.uvset_surfaceMap = (uint32_t)specularGlossinessWorkflow->second.Get("specularGlossinessTexture").Get("texCoord").Get<int>();
+			}
+		}
+	}
+
 	// Create transform hierarchy, assign objects, meshes, armatures, cameras:
 	const tinygltf::Scene &gltfScene = state.gltfModel.scenes[max(0, state.gltfModel.defaultScene)];
 	for (size_t i = 0; i < gltfScene.nodes.size(); i++)
@@ -825,8 +923,9 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 	}
 
 	// Create animations:
-	for (auto& anim : state.gltfModel.animations)
+	for (size_t animationIndex = 0; animationIndex < state.gltfModel.animations.size(); ++animationIndex)
 	{
+		auto& anim = state.gltfModel.animations[animationIndex];
 		Entity entity = CreateEntity();
 		scene.names.Create(entity) = anim.name;
 		AnimationComponent& animationcomponent = scene.animations.Create(entity);
@@ -846,75 +945,11 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 				animationcomponent.samplers[i].mode = AnimationComponent::AnimationSampler::Mode::STEP;
 			}
 
+			AnimationSamplerData& sampler = animationSamplers[animationIndex][i];
 			animationcomponent.samplers[i].data = CreateEntity();
-			AnimationDataComponent& animationdata = scene.animation_datas.Create(animationcomponent.samplers[i].data);
-
-			// AnimationSampler input = keyframe times
-			{
-				const tinygltf::Accessor& accessor = state.gltfModel.accessors[sam.input];
-				const tinygltf::BufferView& bufferView = state.gltfModel.bufferViews[accessor.bufferView];
-				const tinygltf::Buffer& buffer = state.gltfModel.buffers[bufferView.buffer];
-
-				assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-
-				int stride = accessor.ByteStride(bufferView);
-				size_t count = accessor.count;
-
-				animationdata.keyframe_times.resize(count);
-
-				const unsigned char* data = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
-
-				assert(stride == 4);
-
-				for (size_t j = 0; j < count; ++j)
-				{
-					float time = ((float*)data)[j];
-					animationdata.keyframe_times[j] = time;
-					animationcomponent.start = min(animationcomponent.start, time);
-					animationcomponent.end = max(animationcomponent.end, time);
-				}
-
-			}
-
-			// AnimationSampler output = keyframe data
-			{
-				const tinygltf::Accessor& accessor = state.gltfModel.accessors[sam.output];
-				const tinygltf::BufferView& bufferView = state.gltfModel.bufferViews[accessor.bufferView];
-				const tinygltf::Buffer& buffer = state.gltfModel.buffers[bufferView.buffer];
-
-				int stride = accessor.ByteStride(bufferView);
-				size_t count = accessor.count;
-
-				const unsigned char* data = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
-
-				switch (accessor.type)
-				{
-				case TINYGLTF_TYPE_VEC3:
-				{
-					assert(stride == sizeof(XMFLOAT3));
-					animationdata.keyframe_data.resize(count * 3);
-					for (size_t j = 0; j < count; ++j)
-					{
-						((XMFLOAT3*)animationdata.keyframe_data.data())[j] = ((XMFLOAT3*)data)[j];
-					}
-				}
-				break;
-				case TINYGLTF_TYPE_VEC4:
-				{
-					assert(stride == sizeof(XMFLOAT4));
-					animationdata.keyframe_data.resize(count * 4);
-					for (size_t j = 0; j < count; ++j)
-					{
-						((XMFLOAT4*)animationdata.keyframe_data.data())[j] = ((XMFLOAT4*)data)[j];
-					}
-				}
-				break;
-				default: assert(0); break;
-
-				}
-
-			}
-
+			scene.animation_datas.Create(animationcomponent.samplers[i].data) = std::move(sampler.animationdata);
+			animationcomponent.start = min(animationcomponent.start, sampler.start);
+			animationcomponent.end = max(animationcomponent.end, sampler.end);
 		}
 
 		for (size_t i = 0; i < anim.channels.size(); ++i)
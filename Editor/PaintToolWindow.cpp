@@ -972,6 +972,8 @@ void PaintToolWindow::RecordHistory(bool start, CommandList cmd)
 			Texture* newTex = new Texture;
 			TextureDesc desc = resource->texture->GetDesc();
 			desc.Format = FORMAT_R8G8B8A8_UNORM; // force format to one that is writable by GPU
+			desc.BindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS; // the source can be an immutable texture, such as a cooked one
+			desc.Usage = USAGE_DEFAULT;
 			device->CreateTexture(&desc, nullptr, newTex);
 			for (uint32_t i = 0; i < newTex->GetDesc().MipLevels; ++i)
 			{
@@ -325,7 +325,7 @@ RendererWindow::RendererWindow(EditorComponent* editor) : GUI(&editor->GetGUI())
 		default:
 			break;
 		}
-		editor->ResizeBuffers();
+		editor->RequestResizeBuffers();
 	});
 	MSAAComboBox->SetSelected(0);
 	MSAAComboBox->SetEnabled(true);
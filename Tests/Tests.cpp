@@ -1,12 +1,35 @@
 #include "stdafx.h"
 #include "Tests.h"
 
+#include "Utility/stb_image.h"
+
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <deque>
+#include <thread>
 
 using namespace wiECS;
 using namespace wiScene;
+using namespace wiGraphics;
+
+// Writes the results of named checks to the output of a test
+struct TestChecks
+{
+	std::stringstream& ss;
+	bool passed = true;
+
+	TestChecks(std::stringstream& ss) : ss(ss) {}
+	void operator()(const char* name, bool value)
+	{
+		ss << name << ": " << (value ? "PASSED" : "FAILED") << std::endl;
+		passed &= value;
+	}
+	void Summary()
+	{
+		ss << std::endl << (passed ? "All checks PASSED" : "Some checks FAILED") << std::endl;
+	}
+};
 
 void Tests::Initialize()
 {
@@ -116,6 +139,24 @@ void TestsRenderer::Load()
 	testSelector->AddItem("Controller Test");
 	testSelector->AddItem("Inverse Kinematics");
 	testSelector->AddItem("65k Instances");
+	testSelector->AddItem("Physics Benchmark");
+	testSelector->AddItem("Physics Replay Test");
+	testSelector->AddItem("Particle Benchmark");
+	testSelector->AddItem("SPH Benchmark");
+	testSelector->AddItem("Spring Benchmark");
+	testSelector->AddItem("Font Atlas Benchmark");
+	testSelector->AddItem("Text Batching Benchmark");
+	testSelector->AddItem("Texture Cooking Benchmark");
+	testSelector->AddItem("Network Benchmark");
+	testSelector->AddItem("Replication Benchmark");
+	testSelector->AddItem("BackLog Benchmark");
+	testSelector->AddItem("Render Graph Test");
+	testSelector->AddItem("GUI Batching Benchmark");
+	testSelector->AddItem("Sprite Batching Benchmark");
+	testSelector->AddItem("Null Device Test");
+	testSelector->AddItem("Scene Streaming Benchmark");
+	testSelector->AddItem("Ocean Simulation Benchmark");
+	testSelector->AddItem("Audio Mixer Benchmark");
 	testSelector->SetMaxVisibleItemCount(10);
 	testSelector->OnSelect([=](wiEventArgs args) {
 
@@ -285,6 +326,78 @@ void TestsRenderer::Load()
 		}
 		break;
 
+		case 19:
+			RunPhysicsBenchmark();
+			break;
+
+		case 20:
+			RunPhysicsReplayTest();
+			break;
+
+		case 21:
+			RunParticleBenchmark();
+			break;
+
+		case 22:
+			RunSPHBenchmark();
+			break;
+
+		case 23:
+			RunSpringBenchmark();
+			break;
+
+		case 24:
+			RunFontAtlasBenchmark();
+			break;
+
+		case 25:
+			RunTextBatchingBenchmark();
+			break;
+
+		case 26:
+			RunTextureCookingBenchmark();
+			break;
+
+		case 27:
+			RunNetworkBenchmark();
+			break;
+
+		case 28:
+			RunReplicationBenchmark();
+			break;
+
+		case 29:
+			RunBackLogBenchmark();
+			break;
+
+		case 30:
+			RunRenderGraphTest();
+			break;
+
+		case 31:
+			RunGUIBatchingBenchmark();
+			break;
+
+		case 32:
+			RunSpriteBatchingBenchmark();
+			break;
+
+		case 33:
+			RunNullDeviceTest();
+			break;
+
+		case 34:
+			RunSceneStreamingBenchmark();
+			break;
+
+		case 35:
+			RunOceanSimulationBenchmark();
+			break;
+
+		case 36:
+			RunAudioMixerBenchmark();
+			break;
+
 		default:
 			assert(0);
 			break;
@@ -870,3 +983,2008 @@ void TestsRenderer::RunNetworkTest()
 	font.params.size = 24;
 	AddFont(&font);
 }
+void TestsRenderer::RunPhysicsBenchmark()
+{
+	wiTimer timer;
+
+	const float dt = 1.0f / 60.0f;
+	const int frameCount = 120;
+
+	std::stringstream ss("");
+	ss << "Physics performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunPhysicsBenchmark() function." << std::endl << std::endl;
+	ss << "Simulating " << frameCount << " frames with fixed timestep on " << wiJobSystem::GetThreadCount() << " worker threads." << std::endl << std::endl;
+
+	// Every simulated frame is timed separately, including registration of the bodies in the first frame:
+	auto simulate = [&](Scene& scene) {
+		wiJobSystem::context ctx;
+		double total = 0;
+		double worst = 0;
+		for (int frame = 0; frame < frameCount; ++frame)
+		{
+			timer.record();
+			wiPhysicsEngine::RunPhysicsUpdateSystem(ctx, scene, dt);
+			wiJobSystem::Wait(ctx);
+			double time = timer.elapsed();
+			total += time;
+			worst = std::max(worst, time);
+		}
+		ss << "Rigid bodies: " << scene.rigidbodies.GetCount() << ", soft bodies: " << scene.softbodies.GetCount() << std::endl;
+		ss << "Average frame: " << total / frameCount << " milliseconds, worst frame: " << worst << " milliseconds" << std::endl << std::endl;
+
+		// The physics world is global, the bodies of the benchmark scene are removed from it by updating the emptied scene:
+		scene.Clear();
+		wiPhysicsEngine::RunPhysicsUpdateSystem(ctx, scene, dt);
+		wiJobSystem::Wait(ctx);
+	};
+
+	// 1) The physics test scene that is also used in the "Physics Test" demo:
+	{
+		ss << "1) physics_test.wiscene:" << std::endl;
+		Scene scene;
+		LoadModel(scene, "../models/physics_test.wiscene");
+		simulate(scene);
+	}
+
+	// 2) Synthetic stack of 10k boxes on a static ground box:
+	{
+		ss << "2) Synthetic 10k body stack:" << std::endl;
+		Scene scene;
+		Entity mesh = scene.Entity_CreateMesh("benchmark_box");
+
+		Entity ground = scene.Entity_CreateObject("benchmark_ground");
+		scene.objects.GetComponent(ground)->meshID = mesh;
+		TransformComponent& ground_transform = *scene.transforms.GetComponent(ground);
+		ground_transform.Scale(XMFLOAT3(100, 1, 100));
+		ground_transform.Translate(XMFLOAT3(0, -1, 0));
+		ground_transform.UpdateTransform();
+		RigidBodyPhysicsComponent& ground_rigidbody = scene.rigidbodies.Create(ground);
+		ground_rigidbody.shape = RigidBodyPhysicsComponent::CollisionShape::BOX;
+		ground_rigidbody.mass = 0;
+
+		const int width = 20;
+		const int height = 25;
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				for (int z = 0; z < width; ++z)
+				{
+					Entity entity = scene.Entity_CreateObject("benchmark_body");
+					scene.objects.GetComponent(entity)->meshID = mesh;
+					TransformComponent& transform = *scene.transforms.GetComponent(entity);
+					transform.Scale(XMFLOAT3(0.5f, 0.5f, 0.5f));
+					transform.Translate(XMFLOAT3(x * 1.1f - width * 0.55f, y * 1.05f + 0.5f, z * 1.1f - width * 0.55f));
+					transform.UpdateTransform();
+					RigidBodyPhysicsComponent& rigidbody = scene.rigidbodies.Create(entity);
+					rigidbody.shape = RigidBodyPhysicsComponent::CollisionShape::BOX;
+					rigidbody.mass = 1;
+				}
+			}
+		}
+		simulate(scene);
+	}
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunPhysicsReplayTest()
+{
+	std::stringstream ss("");
+	ss << "Physics replay test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunPhysicsReplayTest() function." << std::endl << std::endl;
+
+	const bool deterministic = wiPhysicsEngine::IsDeterministic();
+	wiPhysicsEngine::SetDeterministic(true);
+
+	// Uneven frame times, to also exercise the fixed timestep accumulator:
+	const float frametimes[] = { 1.0f / 60.0f, 1.0f / 30.0f, 1.0f / 144.0f, 1.0f / 45.0f, 0.25f };
+	const int frameCount = 300;
+
+	// Simulates the same scene from scratch and returns the final transforms of every body:
+	auto replay = [&]() {
+		wiJobSystem::context ctx;
+		Scene scene;
+
+		// Removes bodies of previous simulations, which also resets the simulation state once the world is empty:
+		wiPhysicsEngine::RunPhysicsUpdateSystem(ctx, scene, frametimes[0]);
+
+		Entity mesh = scene.Entity_CreateMesh("replay_box");
+
+		Entity ground = scene.Entity_CreateObject("replay_ground");
+		scene.objects.GetComponent(ground)->meshID = mesh;
+		TransformComponent& ground_transform = *scene.transforms.GetComponent(ground);
+		ground_transform.Scale(XMFLOAT3(20, 1, 20));
+		ground_transform.Translate(XMFLOAT3(0, -1, 0));
+		ground_transform.UpdateTransform();
+		RigidBodyPhysicsComponent& ground_rigidbody = scene.rigidbodies.Create(ground);
+		ground_rigidbody.shape = RigidBodyPhysicsComponent::CollisionShape::BOX;
+		ground_rigidbody.mass = 0;
+
+		const int width = 8;
+		for (int y = 0; y < width; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				for (int z = 0; z < width; ++z)
+				{
+					Entity entity = scene.Entity_CreateObject("replay_body");
+					scene.objects.GetComponent(entity)->meshID = mesh;
+					TransformComponent& transform = *scene.transforms.GetComponent(entity);
+					transform.Scale(XMFLOAT3(0.5f, 0.5f, 0.5f));
+					transform.RotateRollPitchYaw(XMFLOAT3(0, 0.1f * x, 0.05f * z)); // tilted boxes will topple
+					transform.Translate(XMFLOAT3(x * 1.2f - width * 0.6f, y * 1.5f + 0.5f, z * 1.2f - width * 0.6f));
+					transform.UpdateTransform();
+					RigidBodyPhysicsComponent& rigidbody = scene.rigidbodies.Create(entity);
+					rigidbody.shape = RigidBodyPhysicsComponent::CollisionShape::BOX;
+					rigidbody.mass = 1;
+				}
+			}
+		}
+
+		for (int frame = 0; frame < frameCount; ++frame)
+		{
+			wiPhysicsEngine::RunPhysicsUpdateSystem(ctx, scene, frametimes[frame % arraysize(frametimes)]);
+		}
+
+		std::vector<XMFLOAT3> result;
+		for (size_t i = 0; i < scene.rigidbodies.GetCount(); ++i)
+		{
+			const TransformComponent& transform = *scene.transforms.GetComponent(scene.rigidbodies.GetEntity(i));
+			result.push_back(transform.translation_local);
+			result.push_back(XMFLOAT3(transform.rotation_local.x, transform.rotation_local.y, transform.rotation_local.z));
+		}
+
+		scene.Clear();
+		wiPhysicsEngine::RunPhysicsUpdateSystem(ctx, scene, frametimes[0]);
+
+		return result;
+	};
+
+	std::vector<XMFLOAT3> run0 = replay();
+	std::vector<XMFLOAT3> run1 = replay();
+
+	const bool identical = run0.size() == run1.size() && std::memcmp(run0.data(), run1.data(), run0.size() * sizeof(XMFLOAT3)) == 0;
+	ss << "Simulated " << frameCount << " frames twice with deterministic mode." << std::endl;
+	ss << "Transforms of the two runs are " << (identical ? "bitwise identical: PASSED" : "different: FAILED") << std::endl;
+
+	wiPhysicsEngine::SetDeterministic(deterministic);
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	font.params.color = identical ? wiColor::Green() : wiColor::Red();
+	this->AddFont(&font);
+}
+void TestsRenderer::RunParticleBenchmark()
+{
+	wiTimer timer;
+
+	const float dt = 1.0f / 60.0f;
+	const int frameCount = 60;
+
+	std::stringstream ss("");
+	ss << "CPU particle simulation performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunParticleBenchmark() function." << std::endl << std::endl;
+	ss << "Simulating " << frameCount << " frames on " << wiJobSystem::GetThreadCount() << " worker threads." << std::endl << std::endl;
+
+	// The emitter doesn't need to be part of a scene, it only needs a transform and a material:
+	TransformComponent transform;
+	transform.UpdateTransform();
+	MaterialComponent material;
+	wiECS::ComponentManager<ForceFieldComponent> forces;
+
+	const uint32_t particleCounts[] = { 100000, 500000, 1000000 };
+	for (uint32_t particleCount : particleCounts)
+	{
+		wiEmittedParticle emitter;
+		emitter.SetCPUSimulationEnabled(true);
+		emitter.SetMaxParticleCount(particleCount);
+		emitter.SetVolumeEnabled(true);
+		emitter.life = 1000;
+		emitter.random_life = 0;
+
+		// Fill the whole pool in the first frame, then keep simulating the full pool:
+		emitter.Burst((int)particleCount);
+
+		double total = 0;
+		for (int frame = 0; frame < frameCount; ++frame)
+		{
+			timer.record();
+			emitter.UpdateCPU(transform, dt);
+			emitter.SimulateCPU(transform, material, nullptr, forces, dt);
+			double time = timer.elapsed();
+			if (frame > 0) // first frame includes the emission
+			{
+				total += time;
+			}
+		}
+		const double average = total / (frameCount - 1);
+
+		ss << emitter.GetCPUParticleData().aliveCount << " particles: " << average << " milliseconds per frame, ";
+		ss << (uint64_t)(particleCount / average) << " particles per millisecond" << std::endl;
+	}
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+// Computes the SPH forces of the CPU particle pool with a naive O(n^2) loop, and returns the largest difference to the forces of SolveSPH_CPU(),
+//	relative to the largest reference force. Forces of the pool must contain only the result of SolveSPH_CPU()
+static float SPH_ReferenceError(const wiEmittedParticle& emitter)
+{
+	const wiEmittedParticle::CPUParticleData& cpu = emitter.GetCPUParticleData();
+	const uint32_t count = cpu.aliveCount;
+
+	const double h = emitter.SPH_h;
+	const double h2 = h * h;
+	const double h3 = h2 * h;
+	const double h6 = h3 * h3;
+	const double h9 = h6 * h3;
+	const double poly6_constant = 315.0 / (64.0 * XM_PI * h9);
+	const double spiky_constant = -45.0 / (XM_PI * h6);
+	const double K = emitter.SPH_K;
+	const double p0 = emitter.SPH_p0;
+	const double e = emitter.SPH_e;
+
+	std::vector<double> density(count);
+	for (uint32_t a = 0; a < count; ++a)
+	{
+		double sum = 0;
+		for (uint32_t b = 0; b < count; ++b)
+		{
+			const double dx = cpu.position_x[a] - cpu.position_x[b];
+			const double dy = cpu.position_y[a] - cpu.position_y[b];
+			const double dz = cpu.position_z[a] - cpu.position_z[b];
+			const double r2 = dx * dx + dy * dy + dz * dz;
+			if (r2 < h2)
+			{
+				const double t = h2 - r2;
+				sum += cpu.mass[b] * poly6_constant * t * t * t;
+			}
+		}
+		density[a] = std::max(p0, sum);
+	}
+
+	double maxError = 0;
+	double maxForce = 0;
+	for (uint32_t a = 0; a < count; ++a)
+	{
+		const double pressureA = K * (density[a] - p0);
+		double fa[3] = {};
+		double fav[3] = {};
+		for (uint32_t b = 0; b < count; ++b)
+		{
+			const double d[3] = {
+				cpu.position_x[a] - cpu.position_x[b],
+				cpu.position_y[a] - cpu.position_y[b],
+				cpu.position_z[a] - cpu.position_z[b],
+			};
+			const double r2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+			const double r = std::sqrt(r2);
+			if (r <= 0 || r >= h)
+				continue;
+
+			const double mass = (double)cpu.mass[b] / cpu.mass[a];
+			const double pressureB = K * (density[b] - p0);
+			const double pressure_term = mass * ((pressureA + pressureB) / (2 * density[a] * density[b])) * spiky_constant * (h - r) * (h - r);
+			const double viscosity_term = mass * (-(r2 * r) / (2 * h3) + r2 / h2 + h / (2 * r) - 1) / density[b];
+			const double dv[3] = {
+				(double)cpu.velocity_x[b] - cpu.velocity_x[a],
+				(double)cpu.velocity_y[b] - cpu.velocity_y[a],
+				(double)cpu.velocity_z[b] - cpu.velocity_z[a],
+			};
+			for (int i = 0; i < 3; ++i)
+			{
+				fa[i] += pressure_term * d[i] / r;
+				fav[i] += viscosity_term * dv[i] * d[i] / r;
+			}
+		}
+
+		const double G[3] = { 0, -9.8 * 2, 0 };
+		const float* force[3] = { cpu.force_x.data(), cpu.force_y.data(), cpu.force_z.data() };
+		for (int i = 0; i < 3; ++i)
+		{
+			const double reference = (-fa[i] + e * fav[i]) / density[a] + G[i];
+			const double error = std::abs(reference - force[i][a]);
+			maxError = std::isnan(error) || std::isnan(maxError) ? NAN : std::max(maxError, error);
+			maxForce = std::max(maxForce, std::abs(reference));
+		}
+	}
+
+	return float(maxError / std::max(1.0, maxForce));
+}
+
+void TestsRenderer::RunSPHBenchmark()
+{
+	wiTimer timer;
+
+	const float dt = 1.0f / 60.0f;
+	const int frameCount = 10;
+
+	std::stringstream ss("");
+	ss << "CPU SPH fluid simulation performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunSPHBenchmark() function." << std::endl << std::endl;
+
+	MaterialComponent material;
+	wiECS::ComponentManager<ForceFieldComponent> forces;
+
+	// The accelerated solver (hashed grid and SIMD) is verified against the naive O(n^2) solution first:
+	{
+		wiEmittedParticle emitter;
+		emitter.SetCPUSimulationEnabled(true);
+		emitter.SetSPHEnabled(true);
+		emitter.SetVolumeEnabled(true);
+		emitter.SetMaxParticleCount(4000);
+		emitter.life = 1000;
+		emitter.random_life = 0;
+		emitter.FIXED_TIMESTEP = dt;
+
+		const float extent = std::cbrt(4000 / 8.0f) * emitter.SPH_h * 0.5f;
+		TransformComponent transform;
+		transform.Scale(XMFLOAT3(extent, extent, extent));
+		transform.Translate(XMFLOAT3(0, extent, 0));
+		transform.UpdateTransform();
+
+		emitter.Burst(4000);
+		emitter.UpdateCPU(transform, dt);
+		emitter.SimulateCPU(transform, material, nullptr, forces, dt); // forces are reset at the end of the simulation
+		emitter.SolveSPH_CPU();
+
+		const float error = SPH_ReferenceError(emitter);
+		const bool passed = error < 1e-3f; // NaN fails too
+		ss << "Relative error of " << emitter.GetCPUParticleData().aliveCount << " particles compared to the O(n^2) reference: " << error << (passed ? " PASSED" : " FAILED") << std::endl << std::endl;
+	}
+
+	ss << "Average SPH solver time of " << frameCount << " frames with different thread counts:" << std::endl << std::endl;
+
+	// Thread counts to measure, the thread which waits for the jobs also works, so it is counted too:
+	std::vector<uint32_t> threadCounts;
+	for (uint32_t threadCount = 1; threadCount <= wiJobSystem::GetThreadCount(); threadCount *= 2)
+	{
+		threadCounts.push_back(threadCount);
+	}
+	if (threadCounts.back() != wiJobSystem::GetThreadCount() + 1)
+	{
+		threadCounts.push_back(wiJobSystem::GetThreadCount() + 1);
+	}
+
+	const uint32_t particleCounts[] = { 10000, 50000, 200000 };
+	for (uint32_t particleCount : particleCounts)
+	{
+		wiEmittedParticle emitter;
+		emitter.SetCPUSimulationEnabled(true);
+		emitter.SetSPHEnabled(true);
+		emitter.SetVolumeEnabled(true);
+		emitter.SetMaxParticleCount(particleCount);
+		emitter.life = 1000;
+		emitter.random_life = 0;
+		emitter.FIXED_TIMESTEP = dt;
+
+		// Emission volume is sized so that there are about 8 particles in every grid cell (of smoothing radius size):
+		const float extent = std::cbrt(particleCount / 8.0f) * emitter.SPH_h * 0.5f;
+		TransformComponent transform;
+		transform.Scale(XMFLOAT3(extent, extent, extent));
+		transform.Translate(XMFLOAT3(0, extent, 0));
+		transform.UpdateTransform();
+
+		// Fill the whole pool:
+		emitter.Burst((int)particleCount);
+		emitter.UpdateCPU(transform, dt);
+		emitter.SimulateCPU(transform, material, nullptr, forces, dt);
+
+		ss << particleCount << " particles:";
+		double singleThreaded = 0;
+		for (uint32_t threadCount : threadCounts)
+		{
+			wiJobSystem::SetActiveThreadCount(threadCount - 1);
+
+			timer.record();
+			for (int frame = 0; frame < frameCount; ++frame)
+			{
+				emitter.SolveSPH_CPU();
+			}
+			const double average = timer.elapsed() / frameCount;
+			if (threadCount == 1)
+			{
+				singleThreaded = average;
+			}
+
+			ss << "  [" << threadCount << " threads: " << average << " ms, " << singleThreaded / average << "x]";
+		}
+		ss << std::endl;
+	}
+
+	wiJobSystem::SetActiveThreadCount(wiJobSystem::GetThreadCount());
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+void TestsRenderer::RunSpringBenchmark()
+{
+	wiTimer timer;
+
+	const float dt = 1.0f / 60.0f;
+	const int frameCount = 120;
+	const int characterCount = 1000;
+	const int strandCount = 3;
+	const int strandLength = 10;
+
+	std::stringstream ss("");
+	ss << "Spring performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunSpringBenchmark() function." << std::endl << std::endl;
+	ss << characterCount << " characters with " << strandCount * strandLength << " springs each, " << frameCount << " frames" << std::endl << std::endl;
+
+	// Every character has a moving root with a head, and hair strands of springs attached to the head.
+	//	The hierarchy is created directly in parent-child order instead of Component_Attach(), to keep setup fast
+	Scene scene;
+	std::vector<Entity> roots;
+	for (int character = 0; character < characterCount; ++character)
+	{
+		Entity root = CreateEntity();
+		scene.transforms.Create(root).Translate(XMFLOAT3(float(character % 40) * 2, 0, float(character / 40) * 2));
+		roots.push_back(root);
+
+		Entity head = CreateEntity();
+		scene.transforms.Create(head).Translate(XMFLOAT3(0, 1.8f, 0));
+		scene.hierarchy.Create(head).parentID = root;
+
+		for (int strand = 0; strand < strandCount; ++strand)
+		{
+			Entity parent = head;
+			for (int link = 0; link < strandLength; ++link)
+			{
+				Entity entity = CreateEntity();
+				scene.transforms.Create(entity).Translate(link == 0 ? XMFLOAT3(0.1f * (strand - 1), 0.1f, 0) : XMFLOAT3(0, -0.05f, 0));
+				scene.hierarchy.Create(entity).parentID = parent;
+				scene.springs.Create(entity).SetGravityEnabled(true);
+				parent = entity;
+			}
+		}
+	}
+
+	auto simulate = [&](uint32_t threadCount) {
+		wiJobSystem::SetActiveThreadCount(threadCount - 1);
+		for (size_t i = 0; i < scene.springs.GetCount(); ++i)
+		{
+			scene.springs[i].Reset();
+		}
+
+		wiJobSystem::context ctx;
+		double total = 0;
+		for (int frame = 0; frame < frameCount; ++frame)
+		{
+			// Shake the characters so that springs have work to do:
+			for (Entity root : roots)
+			{
+				scene.transforms.GetComponent(root)->Translate(XMFLOAT3(std::sin(frame * 0.2f) * 0.05f, 0, 0));
+			}
+			scene.RunTransformUpdateSystem(ctx);
+			wiJobSystem::Wait(ctx);
+			scene.RunHierarchyUpdateSystem(ctx);
+
+			timer.record();
+			scene.RunSpringUpdateSystem(ctx, dt);
+			total += timer.elapsed();
+		}
+
+		const double average = total / frameCount;
+		ss << threadCount << " threads: " << average << " milliseconds per frame" << std::endl;
+		return average;
+	};
+
+	const double singleThreaded = simulate(1);
+	const double multiThreaded = simulate(wiJobSystem::GetThreadCount() + 1);
+	ss << std::endl << "Speedup: " << singleThreaded / multiThreaded << "x" << std::endl;
+
+	wiJobSystem::SetActiveThreadCount(wiJobSystem::GetThreadCount());
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunFontAtlasBenchmark()
+{
+	wiTimer timer;
+
+	// 250 distinct characters at 40 different sizes make 10k unique glyphs:
+	std::wstring characters;
+	for (wchar_t code = 0x21; characters.length() < 250; ++code)
+	{
+		if (code < 0x7F || code > 0xA0)
+		{
+			characters += code;
+		}
+	}
+	const int sizeCount = 40;
+	const int glyphCount = int(characters.length()) * sizeCount;
+
+	std::stringstream ss("");
+	ss << "Font atlas performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunFontAtlasBenchmark() function." << std::endl << std::endl;
+
+	// The Draw() calls only request the glyphs that are not in the atlas yet, UpdateAtlas() will place, rasterize and upload them:
+	CommandList cmd = wiRenderer::GetDevice()->BeginCommandList();
+	timer.record();
+	for (int size = 10; size < 10 + sizeCount; ++size)
+	{
+		wiFont::Draw(characters, wiFontParams(0, 0, size), cmd);
+	}
+	const double requestTime = timer.elapsed();
+
+	timer.record();
+	wiFont::UpdateAtlas(cmd);
+	const double insertTime = timer.elapsed();
+
+	ss << "Requesting " << glyphCount << " glyphs: " << requestTime << " milliseconds" << std::endl;
+	ss << "Inserting " << glyphCount << " glyphs: " << insertTime << " milliseconds" << std::endl;
+	ss << "Atlas pages in use: " << wiFont::GetAtlasPageCount() << std::endl;
+	ss << std::endl << "(Running the test again measures glyphs that are already in the atlas)" << std::endl;
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunTextBatchingBenchmark()
+{
+	wiTimer timer;
+
+	const int stringCount = 2000;
+
+	std::stringstream ss("");
+	ss << "Text batching performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunTextBatchingBenchmark() function." << std::endl << std::endl;
+
+	// Strings similar to a debug HUD, every one with shadow:
+	std::vector<std::string> strings(stringCount);
+	std::vector<wiFontParams> params(stringCount);
+	for (int i = 0; i < stringCount; ++i)
+	{
+		strings[i] = "Debug value " + std::to_string(i) + ": " + std::to_string(i * 0.37f);
+		params[i] = wiFontParams(float(i % 8) * 200, float(i / 8 % 64) * 16, WIFONTSIZE_DEFAULT, WIFALIGN_LEFT, WIFALIGN_TOP, wiColor(255, 255, 255, 255), wiColor(0, 0, 0, 255));
+	}
+
+	// The text is rendered into an offscreen target:
+	GraphicsDevice* device = wiRenderer::GetDevice();
+	static Texture rendertarget;
+	static RenderPass renderpass;
+	if (!rendertarget.IsValid())
+	{
+		TextureDesc desc;
+		desc.Width = 1600;
+		desc.Height = 1024;
+		desc.Format = FORMAT_R8G8B8A8_UNORM;
+		desc.BindFlags = BIND_RENDER_TARGET;
+		device->CreateTexture(&desc, nullptr, &rendertarget);
+
+		RenderPassDesc renderpassdesc;
+		renderpassdesc.numAttachments = 1;
+		renderpassdesc.attachments[0] = { RenderPassAttachment::RENDERTARGET,RenderPassAttachment::LOADOP_CLEAR,&rendertarget,-1 };
+		device->CreateRenderPass(&renderpassdesc, &renderpass);
+	}
+
+	CommandList cmd = device->BeginCommandList();
+
+	// Request all glyphs first and place them in the atlas, so that every text is complete in the measured passes:
+	device->RenderPassBegin(&renderpass, cmd);
+	for (int i = 0; i < stringCount; ++i)
+	{
+		wiFont::Draw(strings[i], params[i], cmd);
+	}
+	device->RenderPassEnd(cmd);
+	wiFont::UpdateAtlas(cmd);
+
+	auto measure = [&](const char* name, bool batched) {
+		wiFont::ResetStatistics();
+		device->RenderPassBegin(&renderpass, cmd);
+		timer.record();
+		if (batched)
+		{
+			wiFont::BeginBatch(cmd);
+		}
+		for (int i = 0; i < stringCount; ++i)
+		{
+			wiFont::Draw(strings[i], params[i], cmd);
+		}
+		if (batched)
+		{
+			wiFont::EndBatch(cmd);
+		}
+		const double time = timer.elapsed();
+		device->RenderPassEnd(cmd);
+
+		const wiFontStatistics stats = wiFont::GetStatistics();
+		ss << name << ": " << time << " milliseconds, " << stats.drawCalls << " draw calls, ";
+		ss << stats.layoutCacheHits << " layout cache hits" << std::endl;
+		return time;
+	};
+
+	// The first pass fills the layout cache, so it measures the cost of laying out every text:
+	const double unbatched = measure("Draw() one by one, layout every text", false);
+	const double batched = measure("Draw() in batch, cached layouts", true);
+	ss << std::endl << "CPU time saved: " << unbatched - batched << " milliseconds (" << unbatched / batched << "x)" << std::endl;
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = device->GetScreenWidth() / 2;
+	font.params.posY = device->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunTextureCookingBenchmark()
+{
+	wiTimer timer;
+
+	std::stringstream ss("");
+	ss << "Texture cooking performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunTextureCookingBenchmark() function." << std::endl << std::endl;
+
+	int width, height, bpp;
+	uint8_t* rgba = stbi_load("images/earth_001.png", &width, &height, &bpp, 4);
+	if (rgba == nullptr)
+	{
+		ss << "Failed to load images/earth_001.png" << std::endl;
+	}
+	else
+	{
+		ss << "Source image: " << width << "x" << height << std::endl << std::endl;
+
+		const double megaPixels = double(width) * double(height) / 1000000.0;
+		std::vector<uint8_t> decompressed(size_t(width) * size_t(height) * 4);
+
+		static const char* names[] = { "BC1", "BC3", "BC4", "BC5", "BC7" };
+		for (int i = 0; i <= wiTextureCooker::COMPRESSION_BC7; ++i)
+		{
+			const wiTextureCooker::COMPRESSION compression = (wiTextureCooker::COMPRESSION)i;
+			std::vector<uint8_t> blocks(size_t((width + 3) / 4) * size_t((height + 3) / 4) * wiTextureCooker::GetBlockSize(compression));
+
+			timer.record();
+			wiTextureCooker::Compress(rgba, width, height, compression, blocks.data());
+			const double time = timer.elapsed();
+
+			wiTextureCooker::Decompress(blocks.data(), width, height, compression, decompressed.data());
+			const float psnr = wiTextureCooker::ComputePSNR(rgba, decompressed.data(), width, height, compression);
+
+			ss << names[i] << ": " << time << " milliseconds, " << megaPixels / (time / 1000.0) << " MPixels/s, PSNR: " << psnr << " dB" << std::endl;
+		}
+
+		// Full cooking includes the mip chain and the .dds container:
+		wiTextureCooker::CookParams params;
+		std::vector<uint8_t> dds;
+		timer.record();
+		const bool success = wiTextureCooker::Cook(rgba, width, height, params, dds);
+		const double time = timer.elapsed();
+		ss << std::endl;
+		if (success)
+		{
+			ss << "Cooking BC7 with mipmaps: " << time << " milliseconds, " << dds.size() / 1024 << " KB" << std::endl;
+		}
+		else
+		{
+			ss << "Cooking failed, the image dimensions must be multiples of 4" << std::endl;
+		}
+
+		stbi_image_free(rgba);
+	}
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunNetworkBenchmark()
+{
+	wiTimer timer;
+
+	const uint32_t packetCount = 200000;
+	const size_t packetSize = 64;
+	const uint16_t port = 12346;
+
+	// The receiving port is shared between multiple sockets, each one serviced by its own job:
+	const uint32_t shardCount = std::max(1u, std::min(8u, wiJobSystem::GetActiveThreadCount()));
+
+	std::stringstream ss("");
+	ss << "Network performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunNetworkBenchmark() function." << std::endl << std::endl;
+	ss << "Loopback throughput with " << packetCount << " packets of " << packetSize << " bytes, " << shardCount << " receiving sockets:" << std::endl;
+
+	auto measure = [&](const char* name, bool batched, uint16_t listenPort) {
+		// The operating system distributes packets between the receiving sockets by sender address, so every receiver gets a sender:
+		std::vector<wiNetwork::Socket> receivers(shardCount);
+		std::vector<wiNetwork::Socket> senders(shardCount);
+		for (uint32_t i = 0; i < shardCount; ++i)
+		{
+			wiNetwork::CreateSocket(&receivers[i]);
+			wiNetwork::CreateSocket(&senders[i]);
+		}
+		if (!wiNetwork::ListenPortShared(receivers.data(), shardCount, listenPort))
+		{
+			ss << name << ": failed to listen on port " << listenPort << std::endl;
+			return;
+		}
+
+		std::atomic_bool sendFinished;
+		sendFinished.store(false);
+		std::atomic<uint32_t> receivedCount;
+		receivedCount.store(0);
+
+		timer.record();
+
+		std::thread sender([&] {
+			uint8_t payload[packetSize] = {};
+			wiNetwork::Connection connection;
+			connection.port = listenPort;
+			wiNetwork::Message messages[64];
+			for (auto& message : messages)
+			{
+				message.connection = connection;
+				message.data = payload;
+				message.dataSize = sizeof(payload);
+			}
+			for (uint32_t i = 0; i < shardCount; ++i)
+			{
+				const uint32_t count = packetCount / shardCount;
+				for (uint32_t sent = 0; sent < count;)
+				{
+					if (batched)
+					{
+						sent += wiNetwork::SendBatch(&senders[i], messages, std::min(count - sent, (uint32_t)arraysize(messages)));
+					}
+					else
+					{
+						wiNetwork::Send(&senders[i], &connection, payload, sizeof(payload));
+						sent++;
+					}
+				}
+			}
+			sendFinished.store(true);
+		});
+
+		wiJobSystem::context ctx;
+		wiJobSystem::Dispatch(ctx, shardCount, 1, [&](wiJobArgs args) {
+			const wiNetwork::Socket* sock = &receivers[args.jobIndex];
+			wiNetwork::Packet packets[256];
+			uint8_t buffer[wiNetwork::MAX_PACKET_SIZE];
+			wiNetwork::Connection sender_connection;
+			while (true)
+			{
+				uint32_t count = 0;
+				if (batched)
+				{
+					count = wiNetwork::ReceiveBatch(sock, packets, arraysize(packets));
+					wiNetwork::ReleasePackets(sock, packets, count);
+				}
+				else if (wiNetwork::CanReceive(sock, 0))
+				{
+					wiNetwork::Receive(sock, &sender_connection, buffer, sizeof(buffer));
+					count = 1;
+				}
+				if (count == 0)
+				{
+					// Finish when nothing arrives for a while after the sender is done:
+					if (sendFinished.load() && !wiNetwork::CanReceive(sock, 50000))
+					{
+						break;
+					}
+					continue;
+				}
+				receivedCount.fetch_add(count);
+			}
+		});
+		wiJobSystem::Wait(ctx);
+		sender.join();
+
+		const double time = timer.elapsed() - 50; // without the final idle wait
+		const uint32_t received = receivedCount.load();
+		ss << name << ": " << uint64_t(received / (time / 1000.0)) << " packets/s, received " << received << " / " << packetCount << std::endl;
+	};
+	measure("Send() and Receive() one by one", false, port);
+	measure("SendBatch() and ReceiveBatch()", true, port + 1);
+
+	// Latency is measured by round trips to an echo thread:
+	{
+		const int roundTripCount = 10000;
+		const uint16_t echoPort = port + 2;
+
+		wiNetwork::Socket echo;
+		wiNetwork::CreateSocket(&echo);
+		wiNetwork::ListenPort(&echo, echoPort);
+		wiNetwork::Socket client;
+		wiNetwork::CreateSocket(&client);
+
+		std::atomic_bool finished;
+		finished.store(false);
+		std::thread echoThread([&] {
+			uint8_t buffer[packetSize];
+			wiNetwork::Connection sender_connection;
+			while (!finished.load())
+			{
+				if (wiNetwork::CanReceive(&echo, 10000))
+				{
+					wiNetwork::Receive(&echo, &sender_connection, buffer, sizeof(buffer));
+					wiNetwork::Send(&echo, &sender_connection, buffer, sizeof(buffer));
+				}
+			}
+		});
+
+		wiNetwork::Connection connection;
+		connection.port = echoPort;
+		uint8_t buffer[packetSize] = {};
+		std::vector<double> roundTrips;
+		roundTrips.reserve(roundTripCount);
+		for (int i = 0; i < roundTripCount; ++i)
+		{
+			timer.record();
+			wiNetwork::Send(&client, &connection, buffer, sizeof(buffer));
+			if (!wiNetwork::CanReceive(&client, 1000000))
+			{
+				break;
+			}
+			wiNetwork::Connection sender_connection;
+			wiNetwork::Receive(&client, &sender_connection, buffer, sizeof(buffer));
+			roundTrips.push_back(timer.elapsed() * 1000.0);
+		}
+		finished.store(true);
+		echoThread.join();
+
+		ss << std::endl;
+		if (roundTrips.empty())
+		{
+			ss << "Round trip latency: no answer from the echo socket" << std::endl;
+		}
+		else
+		{
+			std::sort(roundTrips.begin(), roundTrips.end());
+			ss << "Round trip latency (" << roundTrips.size() << " packets): ";
+			ss << "median " << roundTrips[roundTrips.size() / 2] << " microseconds, ";
+			ss << "p99 " << roundTrips[roundTrips.size() * 99 / 100] << " microseconds" << std::endl;
+		}
+	}
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunReplicationBenchmark()
+{
+	wiTimer timer;
+
+	const uint32_t entityCount = 10000;
+	const int tickCount = 120;
+
+	std::stringstream ss("");
+	ss << "Replication performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunReplicationBenchmark() function." << std::endl << std::endl;
+
+	// The server and client scenes are separate from the global scene, they communicate over loopback:
+	std::unique_ptr<wiScene::Scene> serverScene = std::make_unique<wiScene::Scene>();
+	std::unique_ptr<wiScene::Scene> clientScene = std::make_unique<wiScene::Scene>();
+	for (uint32_t i = 0; i < entityCount; ++i)
+	{
+		Entity entity = CreateEntity();
+		serverScene->names.Create(entity) = "entity" + std::to_string(i);
+		TransformComponent& transform = serverScene->transforms.Create(entity);
+		transform.Translate(XMFLOAT3(float(i % 100) * 2, 0, float(i / 100) * 2));
+		transform.UpdateTransform();
+	}
+
+	wiNetwork::Connection serverConnection;
+	serverConnection.port = 12349;
+	wiNetwork::Socket serverSocket;
+	wiNetwork::CreateSocket(&serverSocket);
+	wiNetwork::ListenPort(&serverSocket, serverConnection.port);
+	wiNetwork::Socket clientSocket;
+	wiNetwork::CreateSocket(&clientSocket);
+	wiNetwork::ListenPort(&clientSocket, serverConnection.port + 1);
+
+	wiReplication::Server server;
+	wiReplication::Client client;
+
+	auto simulate = [&](int tickBegin, int tickEnd, const char* name) {
+		double serverTime = 0;
+		double clientTime = 0;
+		size_t byteCount = 0;
+		uint32_t packetCount = 0;
+		for (int tick = tickBegin; tick < tickEnd; ++tick)
+		{
+			// Every entity moves and rotates every tick:
+			for (size_t i = 0; i < serverScene->transforms.GetCount(); ++i)
+			{
+				TransformComponent& transform = serverScene->transforms[i];
+				const float angle = float(tick) * 0.05f + float(i);
+				transform.translation_local.x += std::cos(angle) * 0.02f;
+				transform.translation_local.y = std::sin(angle);
+				XMStoreFloat4(&transform.rotation_local, XMQuaternionRotationRollPitchYaw(0, angle, 0));
+				transform.SetDirty();
+				transform.UpdateTransform();
+			}
+
+			timer.record();
+			client.Update(*clientScene, &clientSocket, serverConnection);
+			clientTime += timer.elapsed();
+
+			timer.record();
+			server.Update(*serverScene, &serverSocket);
+			serverTime += timer.elapsed();
+
+			byteCount += server.GetStatistics().byteCount;
+			packetCount += server.GetStatistics().packetCount;
+		}
+		const int ticks = tickEnd - tickBegin;
+		ss << name << ":" << std::endl;
+		ss << "    " << double(byteCount) / double(entityCount) / double(ticks) << " bytes/entity/tick, " << packetCount / ticks << " packets/tick" << std::endl;
+		ss << "    server: " << serverTime / ticks << " ms/tick, client: " << clientTime / ticks << " ms/tick" << std::endl;
+	};
+
+	// The first ticks connect the client and create every entity, then only the deltas are sent:
+	simulate(0, 2, "Connecting, full state");
+	simulate(2, tickCount / 2, "Every entity moving");
+
+	// The client is only interested in the entities near the origin for the rest of the test:
+	client.interest.position = XMFLOAT3(0, 0, 0);
+	client.interest.radius = 40;
+	simulate(tickCount / 2, tickCount, "Every entity moving, interest radius 40");
+
+	// Let the client receive the last update, then compare the scenes:
+	client.Update(*clientScene, &clientSocket, serverConnection);
+	float maxError = 0;
+	uint32_t mismatchCount = 0;
+	for (size_t i = 0; i < serverScene->transforms.GetCount(); ++i)
+	{
+		const Entity entity = serverScene->transforms.GetEntity(i);
+		const TransformComponent& transform = serverScene->transforms[i];
+		const TransformComponent* replicated = clientScene->transforms.GetComponent(entity);
+		const bool interesting = wiMath::Length(transform.GetPosition()) <= client.interest.radius;
+		if (interesting != (replicated != nullptr))
+		{
+			mismatchCount++;
+		}
+		else if (replicated != nullptr)
+		{
+			maxError = std::max(maxError, wiMath::Distance(transform.translation_local, replicated->translation_local));
+		}
+	}
+	ss << std::endl << "Replicated entities: " << clientScene->transforms.GetCount() << ", wrong interest: " << mismatchCount << ", largest position error: " << maxError << std::endl;
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunBackLogBenchmark()
+{
+	const uint32_t threadCount = 16;
+	const uint32_t messageCount = 20000; // per thread
+	const char* message = "[BackLog Benchmark] Loaded texture: images/logo_small.png";
+
+	std::stringstream ss("");
+	ss << "BackLog performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunBackLogBenchmark() function." << std::endl << std::endl;
+	ss << threadCount << " threads posting " << messageCount << " messages each:" << std::endl;
+
+	auto measure = [&](const char* name, const std::function<void(uint32_t, uint32_t)>& post) {
+		wiTimer timer;
+		timer.record();
+		std::vector<std::thread> threads;
+		for (uint32_t t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([=] {
+				for (uint32_t i = 0; i < messageCount; ++i)
+				{
+					post(t, i);
+				}
+			});
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		const double postTime = timer.elapsed();
+		wiBackLog::flush();
+		const double totalTime = timer.elapsed();
+		ss << name << ": " << uint64_t(threadCount * messageCount / postTime * 1000) << " messages/sec posted, " <<
+			uint64_t(threadCount * messageCount / totalTime * 1000) << " messages/sec processed" << std::endl;
+	};
+
+	// The previous implementation formatted every message with a stringstream and appended it under a lock:
+	std::deque<std::string> legacyStream;
+	wiSpinLock legacyLock;
+	measure("Locked stringstream (previous)", [&](uint32_t t, uint32_t i) {
+		std::stringstream line("");
+		line << message << std::endl;
+		legacyLock.lock();
+		legacyStream.push_back(line.str().c_str());
+		if (legacyStream.size() > 100)
+		{
+			legacyStream.pop_front();
+		}
+		legacyLock.unlock();
+	});
+
+	measure("Lock-free rings, post()", [&](uint32_t t, uint32_t i) {
+		wiBackLog::post(message);
+	});
+
+	measure("Lock-free rings, postf()", [&](uint32_t t, uint32_t i) {
+		wiBackLog::postf(wiBackLog::LEVEL_INFO, "[BackLog Benchmark] thread %u message %u", t, i);
+	});
+
+	wiBackLog::clear();
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunRenderGraphTest()
+{
+	std::stringstream ss("");
+	ss << "Render graph test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunRenderGraphTest() function." << std::endl << std::endl;
+
+	TestChecks check(ss);
+
+	TextureDesc desc;
+	desc.Width = 1920;
+	desc.Height = 1080;
+	desc.Format = FORMAT_R11G11B10_FLOAT;
+	desc.BindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
+
+	TextureDesc desc_uav = desc;
+	desc_uav.BindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+
+	TextureDesc desc_ldr = desc;
+	desc_ldr.Format = FORMAT_R8G8B8A8_UNORM;
+
+	// The output is owned outside of the graph:
+	Texture output;
+	output.desc = desc_ldr;
+
+	// Only the compile is tested, no texture is created and nothing is executed:
+	wiRenderGraph graph;
+	auto scene = graph.CreateTexture("scene", desc);
+	auto bloom = graph.CreateTexture("bloom", desc_uav);
+	auto blur = graph.CreateTexture("blur", desc_uav);
+	auto ldr = graph.CreateTexture("ldr", desc_ldr);
+	auto debug = graph.CreateTexture("debug", desc);
+	auto target = graph.ImportTexture("output", &output, IMAGE_LAYOUT_GENERAL, IMAGE_LAYOUT_SHADER_RESOURCE);
+
+	graph.AddPass("Scene") // 0
+		.Write(scene, IMAGE_LAYOUT_RENDERTARGET);
+	graph.AddPass("Bloom") // 1
+		.Read(scene, IMAGE_LAYOUT_SHADER_RESOURCE)
+		.Write(bloom, IMAGE_LAYOUT_UNORDERED_ACCESS);
+	graph.AddPass("Debug") // 2, nothing reads its output
+		.Read(scene, IMAGE_LAYOUT_SHADER_RESOURCE)
+		.Write(debug, IMAGE_LAYOUT_RENDERTARGET);
+	graph.AddPass("Tonemap") // 3
+		.Read(bloom, IMAGE_LAYOUT_SHADER_RESOURCE)
+		.Write(ldr, IMAGE_LAYOUT_RENDERTARGET);
+	graph.AddPass("Blur") // 4
+		.Read(ldr, IMAGE_LAYOUT_SHADER_RESOURCE)
+		.Write(blur, IMAGE_LAYOUT_UNORDERED_ACCESS);
+	graph.AddPass("Blur (second)") // 5
+		.Write(blur, IMAGE_LAYOUT_UNORDERED_ACCESS);
+	graph.AddPass("Output") // 6
+		.Read(blur, IMAGE_LAYOUT_SHADER_RESOURCE)
+		.Write(target, IMAGE_LAYOUT_RENDERTARGET);
+
+	check("Compile", graph.Compile());
+
+	check("Unused pass is culled", graph.IsPassCulled(2) && !graph.IsPassCulled(1) && graph.GetPhysicalIndex(debug) == wiRenderGraph::INVALID_RESOURCE);
+	check("Overlapping lifetimes are not aliased", graph.GetPhysicalIndex(scene) != graph.GetPhysicalIndex(bloom));
+	check("Different formats are not aliased", graph.GetPhysicalIndex(ldr) != graph.GetPhysicalIndex(scene));
+	check("Disjoint lifetimes are aliased", graph.GetPhysicalIndex(blur) == graph.GetPhysicalIndex(scene));
+	check("Aliased bind flags are merged", graph.GetTexture(blur).desc.BindFlags == (BIND_RENDER_TARGET | BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS));
+	check("Physical texture count", graph.GetPhysicalCount() == 3);
+	check("Imported texture", &graph.GetTexture(target) == &output && graph.GetPhysicalIndex(target) == wiRenderGraph::INVALID_RESOURCE);
+
+	auto has_barrier = [&](uint32_t pass, wiRenderGraph::ResourceHandle resource, IMAGE_LAYOUT before, IMAGE_LAYOUT after) {
+		for (auto& barrier : graph.GetBarriers(pass))
+		{
+			if (barrier.type == GPUBarrier::IMAGE_BARRIER && barrier.image.texture == &graph.GetTexture(resource) &&
+				barrier.image.layout_before == before && barrier.image.layout_after == after)
+				return true;
+		}
+		return false;
+	};
+	check("Write -> read barrier", has_barrier(1, scene, IMAGE_LAYOUT_RENDERTARGET, IMAGE_LAYOUT_SHADER_RESOURCE));
+	check("Initial layout barrier", has_barrier(0, scene, IMAGE_LAYOUT_GENERAL, IMAGE_LAYOUT_RENDERTARGET));
+	check("Aliased texture continues from the previous layout", has_barrier(4, blur, IMAGE_LAYOUT_SHADER_RESOURCE, IMAGE_LAYOUT_UNORDERED_ACCESS));
+	check("Unordered access -> unordered access barrier", graph.GetBarriers(5).size() == 1 && graph.GetBarriers(5)[0].type == GPUBarrier::MEMORY_BARRIER);
+	check("Imported texture barrier", has_barrier(6, target, IMAGE_LAYOUT_GENERAL, IMAGE_LAYOUT_RENDERTARGET));
+	check("No barrier in culled pass", graph.GetBarriers(2).empty());
+
+	bool final_barriers = graph.GetFinalBarriers().size() == 4;
+	for (auto& barrier : graph.GetFinalBarriers())
+	{
+		final_barriers &= barrier.type == GPUBarrier::IMAGE_BARRIER;
+		final_barriers &= barrier.image.texture == &output ?
+			barrier.image.layout_after == IMAGE_LAYOUT_SHADER_RESOURCE :
+			barrier.image.layout_after == IMAGE_LAYOUT_GENERAL;
+	}
+	check("Final barriers return to the resting layouts", final_barriers);
+
+	const GraphicsDevice* device = wiRenderer::GetDevice();
+	ss << "Transient memory: " << graph.GetTransientMemory(device, false) / 1024 << " KB without aliasing, "
+		<< graph.GetTransientMemory(device, true) / 1024 << " KB with aliasing" << std::endl;
+
+	// Reading a transient texture before anything writes it is an error:
+	wiRenderGraph invalid;
+	auto undefined = invalid.CreateTexture("undefined", desc);
+	invalid.AddPass("Read").Read(undefined).SideEffect();
+	check("Read before write is rejected", !invalid.Compile());
+
+	check.Summary();
+	ss << std::endl;
+	ss << graph.GetStatistics();
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = 20;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.size = 16;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunGUIBatchingBenchmark()
+{
+	wiTimer timer;
+
+	std::stringstream ss("");
+	ss << "GUI batching performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunGUIBatchingBenchmark() function." << std::endl << std::endl;
+
+	TestChecks check(ss);
+
+	// Windows full of widgets, similar to the editor:
+	wiGUI gui;
+	std::vector<wiWindow*> windows;
+	wiLabel* changingLabel = nullptr;
+	const int windowCount = 4;
+	const int rowCount = 24;
+	for (int w = 0; w < windowCount; ++w)
+	{
+		wiWindow* window = new wiWindow(&gui, "Window " + std::to_string(w));
+		window->SetSize(XMFLOAT2(380, 30 + rowCount * 30.0f));
+		window->SetPos(XMFLOAT2(10 + w * 390.0f, 10));
+		gui.AddWidget(window);
+		windows.push_back(window);
+
+		for (int i = 0; i < rowCount; ++i)
+		{
+			const float y = 30 + i * 30.0f;
+			const std::string name = std::to_string(w) + "_" + std::to_string(i);
+			switch (i % 4)
+			{
+			case 0:
+			{
+				wiButton* button = new wiButton("Button " + name);
+				button->SetPos(XMFLOAT2(10, y));
+				button->SetSize(XMFLOAT2(160, 25));
+				window->AddWidget(button);
+			}
+			break;
+			case 1:
+			{
+				wiLabel* label = new wiLabel("Label " + name);
+				label->SetText("Label " + name);
+				label->SetPos(XMFLOAT2(10, y));
+				label->SetSize(XMFLOAT2(160, 25));
+				window->AddWidget(label);
+				changingLabel = label;
+			}
+			break;
+			case 2:
+			{
+				wiSlider* slider = new wiSlider(0, 100, float(i), 100, "Slider " + name);
+				slider->SetPos(XMFLOAT2(80, y));
+				slider->SetSize(XMFLOAT2(200, 25));
+				window->AddWidget(slider);
+			}
+			break;
+			default:
+			{
+				wiComboBox* combo = new wiComboBox("Combo " + name);
+				combo->SetPos(XMFLOAT2(80, y));
+				combo->SetSize(XMFLOAT2(200, 25));
+				combo->AddItem("First");
+				combo->AddItem("Second");
+				window->AddWidget(combo);
+			}
+			break;
+			}
+		}
+	}
+
+	// The GUI is rendered into an offscreen target:
+	GraphicsDevice* device = wiRenderer::GetDevice();
+	static Texture rendertarget;
+	static RenderPass renderpass;
+	if (!rendertarget.IsValid())
+	{
+		TextureDesc desc;
+		desc.Width = device->GetResolutionWidth();
+		desc.Height = device->GetResolutionHeight();
+		desc.Format = FORMAT_R8G8B8A8_UNORM;
+		desc.BindFlags = BIND_RENDER_TARGET;
+		device->CreateTexture(&desc, nullptr, &rendertarget);
+
+		RenderPassDesc renderpassdesc;
+		renderpassdesc.numAttachments = 1;
+		renderpassdesc.attachments[0] = { RenderPassAttachment::RENDERTARGET,RenderPassAttachment::LOADOP_CLEAR,&rendertarget,-1 };
+		device->CreateRenderPass(&renderpassdesc, &renderpass);
+	}
+
+	CommandList cmd = device->BeginCommandList();
+
+	auto render = [&](bool batching) {
+		gui.SetBatchingEnabled(batching);
+		gui.Update(0);
+		device->RenderPassBegin(&renderpass, cmd);
+		timer.record();
+		gui.Render(cmd);
+		const double time = timer.elapsed();
+		device->RenderPassEnd(cmd);
+		return time;
+	};
+
+	// Request all glyphs first, so that every text is complete in the measured frames:
+	render(false);
+	wiFont::UpdateAtlas(cmd);
+
+	const double unbatched = render(false);
+	const double tessellated = render(true);
+	const wiGUIBatch::Statistics first = gui.GetBatch().GetStatistics();
+	const double retained = render(true);
+	const wiGUIBatch::Statistics second = gui.GetBatch().GetStatistics();
+
+	ss << "Draw one by one: " << unbatched << " milliseconds, " << second.commands << " draw calls" << std::endl;
+	ss << "Batched, every widget tessellated: " << tessellated << " milliseconds, " << first.drawCalls << " draw calls" << std::endl;
+	ss << "Batched, retained: " << retained << " milliseconds, " << second.drawCalls << " draw calls, ";
+	ss << second.chunksReused << " of " << second.chunks << " chunks reused" << std::endl;
+	ss << "Quads: " << second.quads << " (" << second.quadsClipped << " clipped, " << second.quadsCulled << " culled on the CPU)" << std::endl << std::endl;
+
+	check("First frame tessellates every chunk", first.chunksTessellated == first.chunks && first.chunksReused == 0);
+	check("Unchanged frame reuses every chunk", second.chunksTessellated == 0 && second.chunksReused == second.chunks);
+	check("Fewer draw calls than draws", second.drawCalls > 0 && second.drawCalls * 10 < second.commands);
+
+	// Only the widget that changed is tessellated again:
+	changingLabel->SetText("Changed text");
+	render(true);
+	const wiGUIBatch::Statistics changed = gui.GetBatch().GetStatistics();
+	check("Changed widget is tessellated again", changed.chunksTessellated == 1 && changed.chunksReused == changed.chunks - 1);
+
+	// The batch contents are on the CPU:
+	const wiGUIBatch& batch = gui.GetBatch();
+	uint32_t drawnQuads = 0;
+	bool contiguous = true;
+	bool inside = true;
+	for (const wiGUIBatch::DrawCall& drawcall : batch.GetDrawCalls())
+	{
+		contiguous &= drawcall.quadOffset == drawnQuads;
+		drawnQuads += drawcall.quadCount;
+		for (uint32_t i = drawcall.quadOffset * 4; i < (drawcall.quadOffset + drawcall.quadCount) * 4 && !drawcall.scissor; ++i)
+		{
+			const XMFLOAT2& pos = batch.GetVertices()[i].pos;
+			inside &= pos.x >= 0 && pos.y >= 0 && pos.x <= device->GetScreenWidth() && pos.y <= device->GetScreenHeight();
+		}
+	}
+	check("Draw calls cover the vertex stream in order", contiguous && drawnQuads * 4 == batch.GetVertices().size());
+	check("Clipped quads are inside the screen", inside);
+
+	check.Summary();
+
+	// The windows delete their child widgets:
+	for (wiWindow* window : windows)
+	{
+		gui.RemoveWidget(window);
+		delete window;
+	}
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = device->GetScreenWidth() / 2;
+	font.params.posY = device->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunSpriteBatchingBenchmark()
+{
+	wiTimer timer;
+
+	std::stringstream ss("");
+	ss << "Sprite batching performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunSpriteBatchingBenchmark() function." << std::endl << std::endl;
+
+	TestChecks check(ss);
+
+	GraphicsDevice* device = wiRenderer::GetDevice();
+	const float canvasWidth = (float)device->GetScreenWidth();
+	const float canvasHeight = (float)device->GetScreenHeight();
+
+	// Sprite layers similar to a HUD heavy 2D scene. Consecutive sprites mostly share the same texture,
+	//	and every fourth sprite is outside of the canvas:
+	const int spriteCount = 10000;
+	const int runLength = 250;
+	const wiGraphics::Texture* textures[] = {
+		wiTextureHelper::getColor(wiColor::Red()),
+		wiTextureHelper::getColor(wiColor::Green()),
+		wiTextureHelper::getColor(wiColor::Blue()),
+		wiTextureHelper::getWhite(),
+	};
+	static std::vector<wiSprite> sprites;
+	sprites.clear();
+	sprites.resize(spriteCount);
+	RenderPath2D path;
+	path.AddLayer("background");
+	path.AddLayer("hud");
+	int visibleCount = 0;
+	for (int i = 0; i < spriteCount; ++i)
+	{
+		wiSprite& sprite = sprites[i];
+		sprite.setTexture(textures[i / runLength % arraysize(textures)]);
+		sprite.params.siz = XMFLOAT2(16, 16);
+		if (i % 4 == 3)
+		{
+			sprite.params.pos = XMFLOAT3(-100 - float(i % 50), float(i % 100) * 8, 0);
+		}
+		else
+		{
+			sprite.params.pos = XMFLOAT3(float(i * 7 % 1000) / 1000.0f * (canvasWidth - 16), float(i * 13 % 1000) / 1000.0f * (canvasHeight - 16), 0);
+			visibleCount++;
+		}
+		path.AddSprite(&sprite, i < spriteCount / 2 ? "background" : "hud");
+	}
+
+	// Items with the same order keep the order they were added in:
+	path.SetLayerOrder("background", 1);
+	path.SetLayerOrder("hud", 2);
+	bool stable = path.layers.size() == 3 && path.layers[1].name == "background" && path.layers[2].name == "hud";
+	for (const RenderLayer2D& layer : path.layers)
+	{
+		for (size_t i = 1; i < layer.items.size(); ++i)
+		{
+			stable &= layer.items[i - 1].sprite < layer.items[i].sprite;
+		}
+	}
+
+	// The sprites are rendered into an offscreen target:
+	static Texture rendertarget;
+	static RenderPass renderpass;
+	if (!rendertarget.IsValid())
+	{
+		TextureDesc desc;
+		desc.Width = device->GetResolutionWidth();
+		desc.Height = device->GetResolutionHeight();
+		desc.Format = FORMAT_R8G8B8A8_UNORM;
+		desc.BindFlags = BIND_RENDER_TARGET;
+		device->CreateTexture(&desc, nullptr, &rendertarget);
+
+		RenderPassDesc renderpassdesc;
+		renderpassdesc.numAttachments = 1;
+		renderpassdesc.attachments[0] = { RenderPassAttachment::RENDERTARGET,RenderPassAttachment::LOADOP_CLEAR,&rendertarget,-1 };
+		device->CreateRenderPass(&renderpassdesc, &renderpass);
+	}
+
+	CommandList cmd = device->BeginCommandList();
+
+	auto measure = [&](const char* name, bool batched) {
+		wiImage::ResetStatistics();
+		device->RenderPassBegin(&renderpass, cmd);
+		timer.record();
+		if (batched)
+		{
+			wiImage::BeginBatch(cmd);
+		}
+		for (const RenderLayer2D& layer : path.layers)
+		{
+			for (const RenderItem2D& item : layer.items)
+			{
+				item.sprite->Draw(cmd);
+			}
+		}
+		if (batched)
+		{
+			wiImage::EndBatch(cmd);
+		}
+		const double time = timer.elapsed();
+		device->RenderPassEnd(cmd);
+
+		const wiImageStatistics stats = wiImage::GetStatistics();
+		ss << name << ": " << time << " milliseconds, " << stats.drawCalls << " draw calls, ";
+		ss << stats.images << " sprites drawn, " << stats.imagesCulled << " culled" << std::endl;
+		return stats;
+	};
+
+	// The first pass allocates the memory of the batch, it is not counted:
+	measure("Warm up", true);
+	const wiImageStatistics unbatched = measure("Draw() one by one", false);
+	const wiImageStatistics batched = measure("Draw() in batch", true);
+	ss << std::endl;
+
+	check("Layers and items are sorted stable", stable);
+	check("Sprites outside of the canvas are culled", batched.imagesCulled == spriteCount - visibleCount && batched.images == visibleCount);
+	check("Unbatched draws every visible sprite", unbatched.drawCalls == visibleCount);
+	check("One instanced draw for every run of the same texture", batched.drawCalls == spriteCount / runLength);
+
+	check.Summary();
+
+	path.ClearSprites();
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = device->GetScreenWidth() / 2;
+	font.params.posY = device->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunNullDeviceTest()
+{
+	std::stringstream ss("");
+	ss << "Null graphics device test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunNullDeviceTest() function." << std::endl << std::endl;
+
+	TestChecks check(ss);
+
+	// A separate device records the commands, the device of the application is not affected:
+	GraphicsDevice_Null device(640, 480);
+
+	// Invalid descriptions are rejected and reported:
+	GPUBuffer invalid;
+	GPUBufferDesc bd;
+	bd.ByteWidth = 20;
+	bd.BindFlags = BIND_CONSTANT_BUFFER;
+	check("Constant buffer size is validated", !device.CreateBuffer(&bd, nullptr, &invalid) && device.GetValidationErrorCount() == 1);
+
+	// Buffers have shadow storage that is written by the initial data and UpdateBuffer():
+	const uint32_t initialData[4] = { 1,2,3,4 };
+	const uint32_t updateData[4] = { 5,6,7,8 };
+	SubresourceData data;
+	data.pSysMem = initialData;
+	bd.ByteWidth = sizeof(initialData);
+	GPUBuffer constantbuffer;
+	device.CreateBuffer(&bd, &data, &constantbuffer);
+	check("Initial data is stored", device.GetShadowSize(&constantbuffer) == sizeof(initialData) && memcmp(device.GetShadowData(&constantbuffer), initialData, sizeof(initialData)) == 0);
+
+	TextureDesc td;
+	td.Width = 64;
+	td.Height = 64;
+	td.MipLevels = 0;
+	td.Format = FORMAT_R8G8B8A8_UNORM;
+	td.BindFlags = BIND_RENDER_TARGET;
+	Texture rendertarget;
+	device.CreateTexture(&td, nullptr, &rendertarget);
+	check("Texture storage has the full mip chain", rendertarget.desc.MipLevels == 7 && device.GetShadowSize(&rendertarget) == 21844);
+
+	RenderPassDesc rpd;
+	rpd.numAttachments = 1;
+	rpd.attachments[0] = { RenderPassAttachment::RENDERTARGET,RenderPassAttachment::LOADOP_CLEAR,&rendertarget,-1 };
+	RenderPass renderpass;
+	device.CreateRenderPass(&rpd, &renderpass);
+
+	PipelineStateDesc psd;
+	PipelineState pso[2];
+	device.CreatePipelineState(&psd, &pso[0]);
+	device.CreatePipelineState(&psd, &pso[1]);
+
+	// One frame with two draws for every pipeline state:
+	CommandList cmd = device.BeginCommandList();
+	device.UpdateBuffer(&constantbuffer, updateData, cmd);
+	device.RenderPassBegin(&renderpass, cmd);
+	device.BindConstantBuffer(VS, &constantbuffer, 0, cmd);
+	for (int i = 0; i < 4; ++i)
+	{
+		device.BindPipelineState(&pso[i / 2], cmd);
+		GraphicsDevice::GPUAllocation allocation = device.AllocateGPU(100, cmd);
+		const GPUBuffer* vbs[] = { allocation.buffer };
+		const uint32_t strides[] = { 4 };
+		const uint32_t offsets[] = { allocation.offset };
+		device.BindVertexBuffers(vbs, 0, 1, strides, offsets, cmd);
+		device.Draw(3, 0, cmd);
+	}
+	device.RenderPassEnd(cmd);
+	// Binding a render target as constant buffer is an error:
+	device.BindConstantBuffer(PS, (const GPUBuffer*)&rendertarget, 0, cmd);
+	device.PresentBegin(cmd);
+	device.PresentEnd(cmd);
+
+	const GraphicsDevice_Null::Statistics& stats = device.GetFrameStatistics();
+	ss << std::endl << stats.commands << " commands, " << stats.drawCalls << " draw calls, " << stats.pipelineStateChanges << " pipeline state changes, ";
+	ss << stats.resourceBindings << " bindings, " << stats.uploadBytes << " bytes uploaded" << std::endl << std::endl;
+
+	check("Draw calls are counted", stats.drawCalls == 4 && stats.renderPasses == 1);
+	check("Only different pipeline states are counted", stats.pipelineStateChanges == 2);
+	check("Uploads are counted", stats.uploadBytes == sizeof(updateData) + 4 * 100);
+	check("Bindings are validated", device.GetValidationErrorCount() == 2);
+
+	uint32_t downloaded[4] = {};
+	check("UpdateBuffer() writes the shadow storage", device.DownloadResource(&constantbuffer, nullptr, downloaded) && memcmp(downloaded, updateData, sizeof(updateData)) == 0);
+
+	const std::vector<GraphicsDevice_Null::Command>& commands = device.GetCommands(cmd);
+	int draws = 0;
+	for (const GraphicsDevice_Null::Command& command : commands)
+	{
+		if (command.type == GraphicsDevice_Null::COMMAND_DRAW && command.args[0] == 3)
+		{
+			draws++;
+		}
+	}
+	check("Commands are recorded in order", commands.size() == stats.commands && commands.front().type == GraphicsDevice_Null::COMMAND_UPDATE_BUFFER &&
+		commands[1].type == GraphicsDevice_Null::COMMAND_RENDERPASS_BEGIN && draws == 4);
+
+	check.Summary();
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunSceneStreamingBenchmark()
+{
+	wiTimer timer;
+
+	const int gridSize = 32;
+	const float spacing = 8;
+	const int frameCount = 240;
+
+	std::stringstream ss("");
+	ss << "Scene streaming performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunSceneStreamingBenchmark() function." << std::endl << std::endl;
+
+	// The world is a grid of objects that share the teapot mesh, every fourth of them has a light attached:
+	std::unique_ptr<Scene> world = std::make_unique<Scene>();
+	LoadModel(*world, "../models/teapot.wiscene");
+	const Entity meshEntity = world->meshes.GetCount() > 0 ? world->meshes.GetEntity(0) : INVALID_ENTITY;
+	for (size_t i = 0; i < world->objects.GetCount(); ++i)
+	{
+		world->transforms.GetComponent(world->objects.GetEntity(i))->Translate(XMFLOAT3(-1000, 0, 0)); // the original teapot is moved out of the way
+	}
+	for (int x = 0; x < gridSize; ++x)
+	{
+		for (int z = 0; z < gridSize; ++z)
+		{
+			const Entity entity = world->Entity_CreateObject("teapot");
+			world->objects.GetComponent(entity)->meshID = meshEntity;
+			world->transforms.GetComponent(entity)->Translate(XMFLOAT3(x * spacing, 0, z * spacing));
+			if ((x + z) % 4 == 0)
+			{
+				const Entity light = world->Entity_CreateLight("light", XMFLOAT3(x * spacing, 2, z * spacing));
+				world->Component_Attach(light, entity);
+			}
+		}
+	}
+	world->Update(0);
+
+	timer.record();
+	const uint32_t archiveCount = wiSceneStreaming::Partition(*world, "streaming_test/", 64);
+	ss << "Partitioned " << world->objects.GetCount() << " objects to " << archiveCount << " archives in " << timer.elapsed() << " ms" << std::endl;
+
+	// The streamed scene is separate from the global scene:
+	std::unique_ptr<Scene> scene = std::make_unique<Scene>();
+	wiSceneStreaming::World streaming;
+	streaming.settings.loadDistance = 64;
+	streaming.settings.unloadDistance = 96;
+	streaming.Open("streaming_test/");
+	streaming.observers.push_back(XMFLOAT3(-64, 0, -64));
+	streaming.Flush(*scene);
+
+	// The observer travels through the world diagonally:
+	double updateTime = 0;
+	double maxUpdateTime = 0;
+	double maxMergeTime = 0;
+	double maxRemoveTime = 0;
+	uint32_t mergedCells = 0;
+	uint32_t removedEntities = 0;
+	const float travel = gridSize * spacing + 128;
+	for (int frame = 0; frame < frameCount; ++frame)
+	{
+		const float t = float(frame) / float(frameCount - 1);
+		streaming.observers[0] = XMFLOAT3(-64 + travel * t, 0, -64 + travel * t);
+
+		timer.record();
+		streaming.Update(*scene);
+		const double elapsed = timer.elapsed();
+		updateTime += elapsed;
+		maxUpdateTime = std::max(maxUpdateTime, elapsed);
+
+		const wiSceneStreaming::Statistics& stats = streaming.GetStatistics();
+		maxMergeTime = std::max(maxMergeTime, stats.mergeTime);
+		maxRemoveTime = std::max(maxRemoveTime, stats.removeTime);
+		mergedCells += stats.mergedCellCount;
+		removedEntities += stats.removedEntityCount;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(4)); // the rest of the frame, so that the streaming thread can keep up
+	}
+	ss << "Update: " << updateTime / frameCount << " ms average, " << maxUpdateTime << " ms max" << std::endl;
+	ss << "Merged " << mergedCells << " cells (" << maxMergeTime << " ms max per frame), removed " << removedEntities << " entities (" << maxRemoveTime << " ms max per frame)" << std::endl;
+
+	// After jumping to the center of the world, every object near the observer must be streamed in, at the same place as in the world:
+	const XMFLOAT3 observer = XMFLOAT3(gridSize * spacing / 2, 0, gridSize * spacing / 2);
+	streaming.observers[0] = observer;
+	timer.record();
+	streaming.Flush(*scene);
+	ss << "Flush after jumping: " << timer.elapsed() << " ms" << std::endl;
+	auto countNear = [&](const Scene& scene) {
+		uint32_t count = 0;
+		for (size_t i = 0; i < scene.aabb_objects.GetCount(); ++i)
+		{
+			const AABB& aabb = scene.aabb_objects[i];
+			const XMFLOAT3 center = aabb.getCenter();
+			if (wiMath::Distance(center, observer) <= streaming.settings.loadDistance)
+			{
+				count++;
+			}
+		}
+		return count;
+	};
+	const uint32_t expected = countNear(*world);
+	const uint32_t streamed = countNear(*scene);
+	ss << std::endl << "Objects near the observer: " << streamed << " streamed, " << expected << " expected, " << scene->objects.GetCount() << " resident in total" << std::endl;
+
+	streaming.Close(*scene);
+	ss << "Entities left after closing: " << scene->transforms.GetCount() + scene->meshes.GetCount() + scene->materials.GetCount() << std::endl;
+	wiHelper::DirectoryDelete("streaming_test/");
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunOceanSimulationBenchmark()
+{
+	wiTimer timer;
+
+	std::stringstream ss("");
+	ss << "Ocean CPU simulation performance test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunOceanSimulationBenchmark() function." << std::endl << std::endl;
+
+	WeatherComponent weather;
+	const auto& params = weather.oceanParameters;
+	const float time = 12.5f;
+
+	// Simulations at different resolutions are compared, so they all use the same spectrum:
+	std::vector<uint32_t> resolutions = { 64, 128, 256, 512 };
+	std::vector<wiOceanSimulation> simulations(resolutions.size());
+	for (size_t i = 0; i < resolutions.size(); ++i)
+	{
+		srand(0);
+		simulations[i].Create(weather, resolutions[i]);
+		simulations[i].Update(weather, 0);
+
+		const int iterations = 10;
+		timer.record();
+		for (int j = 0; j < iterations; ++j)
+		{
+			simulations[i].Update(weather, time + j / 60.0f);
+		}
+		ss << "Update at " << resolutions[i] << "x" << resolutions[i] << ": " << timer.elapsed() / iterations << " ms" << std::endl;
+		simulations[i].Update(weather, time);
+	}
+
+	// The reference is the math of the GPU simulation with a direct DFT, evaluated at a few texels of the displacement map:
+	const uint32_t N = (uint32_t)params.dmap_dim;
+	const std::vector<XMFLOAT2>& h0 = simulations.back().GetSpectrum();
+	const std::vector<float>& omega = simulations.back().GetOmega();
+	const double t = time * params.time_scale;
+	std::vector<double> ht_re(N * N), ht_im(N * N), k_x(N * N), k_y(N * N);
+	for (uint32_t y = 0; y < N; ++y)
+	{
+		for (uint32_t x = 0; x < N; ++x)
+		{
+			const XMFLOAT2 h0_k = h0[y * (N + 4) + x];
+			const XMFLOAT2 h0_mk = h0[(N - y) * (N + 4) + (N - x)];
+			const double sin_v = sin(omega[y * (N + 4) + x] * t);
+			const double cos_v = cos(omega[y * (N + 4) + x] * t);
+			ht_re[y * N + x] = (h0_k.x + h0_mk.x) * cos_v - (h0_k.y + h0_mk.y) * sin_v;
+			ht_im[y * N + x] = (h0_k.x - h0_mk.x) * sin_v + (h0_k.y - h0_mk.y) * cos_v;
+			const double kx = x - N * 0.5;
+			const double ky = y - N * 0.5;
+			const double length = sqrt(kx * kx + ky * ky);
+			k_x[y * N + x] = length > 0 ? kx / length : 0;
+			k_y[y * N + x] = length > 0 ? ky / length : 0;
+		}
+	}
+	double rms = 0;
+	std::vector<double> errors(resolutions.size());
+	const uint32_t samples = 16;
+	for (uint32_t i = 0; i < samples; ++i)
+	{
+		const uint32_t X = (i * 97 + 13) % N;
+		const uint32_t Y = (i * 211 + 7) % N;
+		double h = 0, dx = 0, dy = 0;
+		for (uint32_t v = 0; v < N; ++v)
+		{
+			for (uint32_t u = 0; u < N; ++u)
+			{
+				const double phase = -6.283185307179586 * (double)((u * X + v * Y) % N) / N;
+				const uint32_t k = v * N + u;
+				// real parts of H * e^(i*phase), Dx = -i * kx * H and Dy = -i * ky * H:
+				const double real = ht_re[k] * cos(phase) - ht_im[k] * sin(phase);
+				const double imag = ht_re[k] * sin(phase) + ht_im[k] * cos(phase);
+				h += real;
+				dx += imag * k_x[k];
+				dy += imag * k_y[k];
+			}
+		}
+		const double sign_correction = ((X + Y) & 1) ? -1 : 1;
+		const XMFLOAT3 reference = XMFLOAT3(float(dx * sign_correction * params.choppy_scale), float(h * sign_correction), float(dy * sign_correction * params.choppy_scale));
+		const XMFLOAT3 position = XMFLOAT3(X * params.patch_length / N, 0, Y * params.patch_length / N);
+		for (size_t j = 0; j < simulations.size(); ++j)
+		{
+			const XMFLOAT3 displacement = simulations[j].GetDisplacement(position);
+			errors[j] = std::max(errors[j], (double)wiMath::Distance(displacement, reference));
+		}
+		rms += reference.y * reference.y;
+	}
+	// The simulation at the resolution of the GPU displacement map must match it up to float precision,
+	//	the lower resolutions leave out the high frequencies of the spectrum, so they are only expected to be close:
+	rms = sqrt(rms / samples);
+	ss << std::endl << "Height RMS: " << rms << ", largest difference from the GPU math:" << std::endl;
+	for (size_t i = 0; i < resolutions.size(); ++i)
+	{
+		const double tolerance = (resolutions[i] == N ? 1e-4 : 5e-2) * rms;
+		ss << resolutions[i] << "x" << resolutions[i] << ": " << errors[i] << " (tolerance: " << tolerance << ") " << (errors[i] < tolerance ? "PASSED" : "FAILED") << std::endl;
+	}
+
+	// Gameplay queries:
+	wiOceanSimulation& simulation = simulations[1];
+	const int queries = 100000;
+	float sum = 0;
+	timer.record();
+	for (int i = 0; i < queries; ++i)
+	{
+		sum += simulation.GetHeight(XMFLOAT3(i * 0.37f, 0, i * 0.11f));
+	}
+	ss << std::endl << "GetHeight(): " << timer.elapsed() * 1000000.0 / queries << " ns" << std::endl;
+	timer.record();
+	for (int i = 0; i < queries; ++i)
+	{
+		sum += simulation.GetNormal(XMFLOAT3(i * 0.37f, 0, i * 0.11f)).y;
+	}
+	ss << "GetNormal(): " << timer.elapsed() * 1000000.0 / queries << " ns" << std::endl;
+	simulation.Update(weather, time + 1.0f / 60.0f);
+	const XMFLOAT3 velocity = simulation.GetVelocity(XMFLOAT3(0, 0, 0));
+	ss << "Surface velocity at the origin: " << velocity.x << ", " << velocity.y << ", " << velocity.z << " (" << sum << ")" << std::endl;
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+
+void TestsRenderer::RunAudioMixerBenchmark()
+{
+	wiTimer timer;
+
+	std::stringstream ss("");
+	ss << "Audio software mixer test:" << std::endl;
+	ss << "You can find out more in Tests.cpp, RunAudioMixerBenchmark() function." << std::endl << std::endl;
+
+	// A 16-bit mono .wav file with a sine wave, at a sample rate that must be resampled to the 48 kHz output:
+	const uint32_t sourceRate = 44100;
+	const float frequency = 440;
+	std::vector<uint8_t> wav(44 + sourceRate * 2);
+	{
+		uint8_t* dst = wav.data();
+		auto write = [&](const void* src, size_t size) { memcpy(dst, src, size); dst += size; };
+		auto write32 = [&](uint32_t value) { write(&value, sizeof(value)); };
+		auto write16 = [&](uint16_t value) { write(&value, sizeof(value)); };
+		write("RIFF", 4); write32(uint32_t(wav.size() - 8)); write("WAVE", 4);
+		write("fmt ", 4); write32(16); write16(1); write16(1); write32(sourceRate); write32(sourceRate * 2); write16(2); write16(16);
+		write("data", 4); write32(sourceRate * 2);
+		for (uint32_t i = 0; i < sourceRate; ++i)
+		{
+			write16(uint16_t(int16_t(std::sin(6.283185307179586 * frequency * i / sourceRate) * 32767)));
+		}
+	}
+	wiAudio::Sound sound;
+	wiAudio::SoftwareMixer::CreateSound(wav, &sound);
+
+	// Keeps the mixed output in memory, so that it can be checked:
+	struct CaptureDevice : public wiAudio::AudioDevice
+	{
+		std::vector<float> samples;
+		uint32_t GetSampleRate() const override { return 48000; }
+		void Submit(const float* data, uint32_t frames) override { samples.insert(samples.end(), data, data + frames * 2); }
+	};
+	const double outputRate = 48000;
+	auto largest_error = [&](const std::vector<float>& samples, size_t first, double amplitude) {
+		double error = 0;
+		for (size_t i = first; i < samples.size() / 2; ++i)
+		{
+			const double expected = std::sin(6.283185307179586 * frequency * i / outputRate) * amplitude;
+			error = std::max(error, std::abs(samples[i * 2] - expected));
+		}
+		return error;
+	};
+	auto rms = [](const std::vector<float>& samples, int channel) {
+		double sum = 0;
+		for (size_t i = channel; i < samples.size(); i += 2)
+		{
+			sum += samples[i] * samples[i];
+		}
+		return std::sqrt(sum / (samples.size() / 2));
+	};
+
+	// Resampling:
+	{
+		auto device = std::make_shared<CaptureDevice>();
+		wiAudio::SoftwareMixer mixer(device);
+		wiAudio::SoundInstance instance;
+		mixer.CreateSoundInstance(&sound, &instance);
+		mixer.Play(&instance);
+		mixer.Render(24000);
+		ss << "Resampling 44.1 kHz to 48 kHz, largest difference from the exact sine: " << largest_error(device->samples, 0, 1) << std::endl;
+	}
+
+	// Instance and submix volumes, after the volume ramp of the first block:
+	{
+		auto device = std::make_shared<CaptureDevice>();
+		wiAudio::SoftwareMixer mixer(device);
+		wiAudio::SoundInstance instance;
+		mixer.CreateSoundInstance(&sound, &instance);
+		mixer.SetVolume(0.5f, &instance);
+		mixer.SetSubmixVolume(wiAudio::SUBMIX_TYPE_SOUNDEFFECT, 0.25f);
+		mixer.Play(&instance);
+		mixer.Render(24000);
+		ss << "Instance volume 0.5 and submix volume 0.25, largest difference: " << largest_error(device->samples, 256, 0.125) << std::endl;
+	}
+
+	// Panning, attenuation and doppler:
+	{
+		auto device = std::make_shared<CaptureDevice>();
+		wiAudio::SoftwareMixer mixer(device);
+		wiAudio::SoundInstance instance;
+		mixer.CreateSoundInstance(&sound, &instance);
+		wiAudio::SoundInstance3D instance3D;
+		instance3D.emitterPos = XMFLOAT3(4, 0, 0);
+		mixer.Update3D(&instance, instance3D);
+		mixer.Play(&instance);
+		mixer.Render(24000);
+		ss << "Emitter 4 units to the right, RMS left: " << rms(device->samples, 0) << ", right: " << rms(device->samples, 1) << " (expected 0, " << 0.25 / std::sqrt(2.0) << ")" << std::endl;
+
+		instance3D.emitterPos = XMFLOAT3(0, 0, 1);
+		instance3D.emitterVelocity = XMFLOAT3(0, 0, -34.35f);
+		mixer.Update3D(&instance, instance3D);
+		device->samples.clear();
+		mixer.Render(24000);
+		int crossings = 0;
+		for (size_t i = 2; i < device->samples.size(); i += 2)
+		{
+			crossings += (device->samples[i - 2] < 0) != (device->samples[i] < 0);
+		}
+		ss << "Emitter approaching at 10% of the speed of sound, frequency: " << crossings << " Hz (expected " << frequency / 0.9f << ")" << std::endl;
+	}
+
+	// Throughput, with many sounds played at different positions:
+	{
+		auto device = std::make_shared<wiAudio::AudioDevice_Null>();
+		wiAudio::SoftwareMixer mixer(device);
+		const uint32_t voiceCount = 256;
+		std::vector<wiAudio::SoundInstance> instances(voiceCount);
+		for (uint32_t i = 0; i < voiceCount; ++i)
+		{
+			instances[i].type = wiAudio::SUBMIX_TYPE(i % wiAudio::SUBMIX_TYPE_COUNT);
+			mixer.CreateSoundInstance(&sound, &instances[i]);
+			wiAudio::SoundInstance3D instance3D;
+			instance3D.emitterPos = XMFLOAT3(std::cos(i * 0.1f) * i * 0.1f, 0, std::sin(i * 0.1f) * i * 0.1f);
+			instance3D.emitterVelocity = XMFLOAT3(0, 0, float(i % 16));
+			mixer.Update3D(&instances[i], instance3D);
+			mixer.SetVolume(1.0f / voiceCount, &instances[i]);
+			mixer.Play(&instances[i]);
+		}
+		const uint32_t seconds = 10;
+		timer.record();
+		mixer.Render(48000 * seconds);
+		const double elapsed = timer.elapsed();
+		ss << std::endl << "Mixing " << voiceCount << " sounds for " << seconds << " seconds: " << elapsed << " ms, " << seconds * 1000.0 / elapsed << "x realtime" << std::endl;
+		ss << "Cost per sound: " << elapsed * 1000000.0 / (double(voiceCount) * 48000 * seconds) << " ns per frame, peak: " << device->GetPeak() << std::endl;
+	}
+
+	// The file sink records a sound flying around the listener:
+	{
+		auto device = std::make_shared<wiAudio::AudioDevice_File>("audio_mixer_test.wav");
+		wiAudio::SoftwareMixer mixer(device);
+		wiAudio::SoundInstance instance;
+		mixer.CreateSoundInstance(&sound, &instance);
+		mixer.Play(&instance);
+		for (int i = 0; i < 200; ++i)
+		{
+			wiAudio::SoundInstance3D instance3D;
+			instance3D.emitterPos = XMFLOAT3(std::sin(i * 0.05f) * 3, 0, std::cos(i * 0.05f) * 3);
+			instance3D.emitterVelocity = XMFLOAT3(std::cos(i * 0.05f) * 3 / 0.01f * 0.05f, 0, -std::sin(i * 0.05f) * 3 / 0.01f * 0.05f);
+			mixer.Update3D(&instance, instance3D);
+			mixer.Render(480);
+		}
+		ss << std::endl << "Written: audio_mixer_test.wav (" << (device->Flush() ? "success" : "failed") << ")" << std::endl;
+	}
+
+	static wiSpriteFont font;
+	font = wiSpriteFont(ss.str());
+	font.params.posX = wiRenderer::GetDevice()->GetScreenWidth() / 2;
+	font.params.posY = wiRenderer::GetDevice()->GetScreenHeight() / 2;
+	font.params.h_align = WIFALIGN_CENTER;
+	font.params.v_align = WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
@@ -16,6 +16,24 @@ public:
 	void RunFontTest();
 	void RunSpriteTest();
 	void RunNetworkTest();
+	void RunPhysicsBenchmark();
+	void RunPhysicsReplayTest();
+	void RunParticleBenchmark();
+	void RunSPHBenchmark();
+	void RunSpringBenchmark();
+	void RunFontAtlasBenchmark();
+	void RunTextBatchingBenchmark();
+	void RunTextureCookingBenchmark();
+	void RunNetworkBenchmark();
+	void RunReplicationBenchmark();
+	void RunBackLogBenchmark();
+	void RunRenderGraphTest();
+	void RunGUIBatchingBenchmark();
+	void RunSpriteBatchingBenchmark();
+	void RunNullDeviceTest();
+	void RunSceneStreamingBenchmark();
+	void RunOceanSimulationBenchmark();
+	void RunAudioMixerBenchmark();
 };
 
 class Tests : public MainComponent
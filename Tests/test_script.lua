@@ -3,6 +3,45 @@
 debugout("Begin script: test_script.lua");
 
 
+-- Benchmark the math bindings: every operation returns a new Vector or Matrix object
+--	Reports the operations per second and the longest garbage collection pause while the garbage is collected incrementally
+local function MathBenchmark()
+	local count = 200000;
+	local v = Vector(0, 0, 0);
+	local step = Vector(0.1, 0.2, 0.3);
+	local rotation = matrix.RotationY(0.01);
+
+	collectgarbage("collect");
+	local memory = collectgarbage("count");
+	local longest_pause = 0;
+	local gc_time = 0;
+	local start = os.clock();
+	for i = 1, count do
+		v = vector.Add(v, step);
+		v = vector.Multiply(v, 0.5);
+		v = vector.Transform(v, rotation);
+		if i % 1000 == 0 then
+			local pause = os.clock();
+			collectgarbage("step");
+			pause = os.clock() - pause;
+			gc_time = gc_time + pause;
+			longest_pause = math.max(longest_pause, pause);
+		end
+	end
+	local elapsed = os.clock() - start;
+	local garbage = collectgarbage("count") - memory;
+
+	local pause = os.clock();
+	collectgarbage("collect");
+	pause = os.clock() - pause;
+
+	debugout("Vector operations: " .. math.floor(count * 3 / elapsed) .. " ops/sec");
+	debugout("Longest incremental GC step: " .. string.format("%.3f", longest_pause * 1000) .. " ms, total: " .. string.format("%.3f", gc_time * 1000) .. " ms");
+	debugout("Full GC after benchmark: " .. string.format("%.3f", pause * 1000) .. " ms, uncollected garbage: " .. math.floor(garbage) .. " KB");
+end
+MathBenchmark();
+
+
 -- Load a model:
 local parent = LoadModel("../models/teapot.wiscene");
 LoadModel("../models/cameras.wiscene");
@@ -18,6 +18,7 @@
 #include "wiGraphicsDevice_DX11.h"
 #include "wiGraphicsDevice_DX12.h"
 #include "wiGraphicsDevice_Vulkan.h"
+#include "wiGraphicsDevice_Null.h"
 
 #include "Utility/replace_new.h"
 
@@ -44,7 +45,12 @@ void MainComponent::Initialize()
 
 		bool debugdevice = wiStartupArguments::HasArgument("debugdevice");
 
-		if (wiStartupArguments::HasArgument("vulkan"))
+		if (wiStartupArguments::HasArgument("null"))
+		{
+			// headless, nothing is rendered:
+			wiRenderer::SetDevice(std::make_shared<GraphicsDevice_Null>());
+		}
+		else if (wiStartupArguments::HasArgument("vulkan"))
 		{
 #ifdef WICKEDENGINE_BUILD_VULKAN
 			wiRenderer::SetShaderPath(wiRenderer::GetShaderPath() + "spirv/");
@@ -88,6 +94,9 @@ void MainComponent::ActivatePath(RenderPath* component, float fadeSeconds, wiCol
 	fadeManager.Clear();
 	fadeManager.Start(fadeSeconds, fadeColor, [this, component]() {
 
+		// The previous path can still be rendered in pipelined mode:
+		WaitRender();
+
 		if (GetActivePath() != nullptr)
 		{
 			GetActivePath()->Stop();
@@ -115,12 +124,20 @@ void MainComponent::Run()
 	{
 		// Until engine is not loaded, present initialization screen...
 		CommandList cmd = wiRenderer::GetDevice()->BeginCommandList();
+		wiFont::UpdateAtlas(cmd);
 		wiRenderer::GetDevice()->PresentBegin(cmd);
 		wiFont::Draw(wiBackLog::getText(), wiFontParams(4, 4, infoDisplay.size), cmd);
 		wiRenderer::GetDevice()->PresentEnd(cmd);
 		return;
 	}
 
+	static bool pipeline_warmup = false;
+	if (!pipeline_warmup)
+	{
+		pipeline_warmup = true;
+		wiInitializer::WarmUpPipelineStates();
+	}
+
 	static bool startup_script = false;
 	if (!startup_script)
 	{
@@ -136,13 +153,27 @@ void MainComponent::Run()
 	deltaTime = float(std::max(0.0, timer.elapsed() / 1000.0));
 	timer.record();
 
-	if (wiPlatform::IsWindowActive())
+	const bool active = wiPlatform::IsWindowActive();
+	const bool pipelined = frameLatency > 0;
+	const float dt = framerate_lock ? (1.0f / targetFrameRate) : deltaTime;
+	bool rendered = false;
+
+	if (pipelined && framePrepared && preparedPath == GetActivePath())
 	{
-		// If the application is active, run Update loops:
+		// Handoff point: the frame that was prepared by the previous Run() is rendered while this frame is updated
+		rendered = true;
+		KickRender();
+	}
+	framePrepared = false;
 
-		const float dt = framerate_lock ? (1.0f / targetFrameRate) : deltaTime;
+	if (active)
+	{
+		// If the application is active, run Update loops:
 
-		fadeManager.Update(dt);
+		if (!pipelined)
+		{
+			fadeManager.Update(dt);
+		}
 
 		// Fixed time update:
 		auto range = wiProfiler::BeginRangeCPU("Fixed Update");
@@ -172,10 +203,17 @@ void MainComponent::Run()
 
 		// Variable-timed update:
 		Update(dt);
+		frameCounters.updated++;
 
 		wiInput::Update();
 
-		Render();
+		if (!pipelined)
+		{
+			PrepareFrame();
+			framePrepared = false;
+			rendered = true;
+			RenderFrame();
+		}
 	}
 	else
 	{
@@ -184,7 +222,116 @@ void MainComponent::Run()
 		wiInput::Update(); // still flush the input events so they don't just accumulate
 	}
 
+	// Handoff point: the previous frame must be rendered before it is presented and before the next frame is prepared
+	WaitRender();
+
+	PresentFrame(rendered);
+
+	if (pipelined && active)
+	{
+		// The path switch of the fade manager happens here, when nothing is rendered:
+		fadeManager.Update(dt);
+
+		PrepareFrame();
+	}
+
+	if (requestedFrameLatency != frameLatency)
+	{
+		// Nothing is rendered between Run() calls, so the rendering mode can be switched here.
+		//	A frame that was prepared in pipelined mode is dropped, the next Run() prepares a new one
+		frameLatency = requestedFrameLatency;
+		framePrepared = false;
+		wiRenderer::SetPipelinedRenderingEnabled(frameLatency > 0);
+		if (frameLatency > 0)
+		{
+			StartRenderThread();
+		}
+		else
+		{
+			StopRenderThread();
+		}
+	}
+}
+
+void MainComponent::StartRenderThread()
+{
+	if (renderThreadRunning)
+	{
+		return;
+	}
+	renderThreadRunning = true;
+	renderThread = std::thread([this] {
+		wiProfiler::SetThreadName("Render Thread");
+
+		std::unique_lock<std::mutex> lck(renderLock);
+		while (true)
+		{
+			renderCondition.wait(lck, [this] { return renderRequested || !renderThreadRunning; });
+			if (!renderRequested)
+			{
+				break;
+			}
+			lck.unlock();
+			RenderFrame();
+			lck.lock();
+			renderRequested = false;
+			renderCondition.notify_all();
+		}
+	});
+}
+
+void MainComponent::StopRenderThread()
+{
+	if (!renderThread.joinable())
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lck(renderLock);
+		renderThreadRunning = false;
+	}
+	renderCondition.notify_all();
+	renderThread.join();
+}
+
+void MainComponent::KickRender()
+{
+	{
+		std::lock_guard<std::mutex> lck(renderLock);
+		renderRequested = true;
+	}
+	renderCondition.notify_all();
+}
+
+void MainComponent::WaitRender()
+{
+	std::unique_lock<std::mutex> lck(renderLock);
+	renderCondition.wait(lck, [this] { return !renderRequested; });
+}
+
+void MainComponent::PrepareFrame()
+{
+	PreRender();
+	frameCounters.prepared++;
+	framePrepared = true;
+	preparedPath = GetActivePath();
+}
+
+void MainComponent::RenderFrame()
+{
+	Render();
+	frameCounters.rendered++;
+}
+
+void MainComponent::PresentFrame(bool rendered)
+{
+	if (rendered && preparedPath == GetActivePath())
+	{
+		PostRender();
+	}
+
 	CommandList cmd = wiRenderer::GetDevice()->BeginCommandList();
+	wiFont::UpdateAtlas(cmd);
 	wiRenderer::GetDevice()->PresentBegin(cmd);
 	{
 		Compose(cmd);
@@ -193,6 +340,8 @@ void MainComponent::Run()
 	wiRenderer::GetDevice()->PresentEnd(cmd);
 
 	wiRenderer::EndFrame();
+
+	frameCounters.presented++;
 }
 
 void MainComponent::Update(float dt)
@@ -221,12 +370,24 @@ void MainComponent::FixedUpdate()
 	}
 }
 
-void MainComponent::Render()
+void MainComponent::PreRender()
 {
-	auto range = wiProfiler::BeginRangeCPU("Render");
+	auto range = wiProfiler::BeginRangeCPU("PreRender");
 
 	wiLua::GetGlobal()->Render();
 
+	if (GetActivePath() != nullptr)
+	{
+		GetActivePath()->PreRender();
+	}
+
+	wiProfiler::EndRange(range); // PreRender
+}
+
+void MainComponent::Render()
+{
+	auto range = wiProfiler::BeginRangeCPU("Render");
+
 	if (GetActivePath() != nullptr)
 	{
 		GetActivePath()->Render();
@@ -235,6 +396,18 @@ void MainComponent::Render()
 	wiProfiler::EndRange(range); // Render
 }
 
+void MainComponent::PostRender()
+{
+	auto range = wiProfiler::BeginRangeCPU("PostRender");
+
+	if (GetActivePath() != nullptr)
+	{
+		GetActivePath()->PostRender();
+	}
+
+	wiProfiler::EndRange(range); // PostRender
+}
+
 void MainComponent::Compose(CommandList cmd)
 {
 	auto range = wiProfiler::BeginRangeCPU("Compose");
@@ -293,6 +466,11 @@ void MainComponent::Compose(CommandList cmd)
 			}
 #endif
 
+			if (dynamic_cast<GraphicsDevice_Null*>(wiRenderer::GetDevice()))
+			{
+				ss << "[Null]";
+			}
+
 #ifdef _DEBUG
 			ss << "[DEBUG]";
 #endif
@@ -5,6 +5,10 @@
 #include "wiColor.h"
 #include "wiFadeManager.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 class RenderPath;
 
 class MainComponent
@@ -25,7 +29,36 @@ protected:
 	float deltatimes[20] = {};
 	int fps_avg_counter = 0;
 
+	uint32_t frameLatency = 0;
+	uint32_t requestedFrameLatency = 0;
+	bool framePrepared = false;				// PreRender() was called, the frame can be rendered
+	RenderPath* preparedPath = nullptr;		// the active path when the frame was prepared
+
+	// The pipelined mode renders on a dedicated thread instead of a job, because a job could be picked up by the main thread
+	//	while it waits for its own jobs in Update(), and then the frame would be rendered in the middle of the update
+	std::thread renderThread;
+	std::mutex renderLock;
+	std::condition_variable renderCondition;
+	bool renderRequested = false;
+	bool renderThreadRunning = false;
+	void StartRenderThread();
+	void StopRenderThread();
+	// Starts rendering the prepared frame on the render thread
+	void KickRender();
+	// Waits until the render thread finished the frame, if it is rendering one
+	void WaitRender();
+
+	// Prepares the updated frame for rendering
+	void PrepareFrame();
+	// Renders the prepared frame, the pipelined mode runs this on an other thread
+	void RenderFrame();
+	// Renders the elements after Render(), composes and presents the frame
+	//	rendered : Render() was called for the active path since the last presented frame
+	void PresentFrame(bool rendered);
+
 public:
+	virtual ~MainComponent() { StopRenderThread(); }
+
 	bool fullscreen = false;
 
 	// Runs the main engine loop
@@ -45,6 +78,26 @@ public:
 	//	disabled	: the FixedUpdate() loop will run every frame only once.
 	void	setFrameSkip(bool enabled) { frameskip = enabled; }
 	void	setFrameRateLock(bool enabled) { framerate_lock = enabled; }
+	// Set the number of frames that the rendering can be behind the update (default = 0)
+	//	0	: immediate mode, Update(), PreRender(), Render(), PostRender() and Compose() run one after the other on the main thread
+	//	1	: pipelined mode, Render() of the previous frame runs on an other thread while the current frame is updated.
+	//			Render() uses a copy of the scene and camera that was made by PreRender() (see wiRenderer::SetPipelinedRenderingEnabled()), the presented frame is one frame behind the update
+	//	Larger values are clamped to 1. The change is applied at the end of the next Run()
+	void	setFrameLatency(uint32_t value) { requestedFrameLatency = value > 1 ? 1 : value; }
+	uint32_t getFrameLatency() const { return frameLatency; }
+
+	// Number of frames that went through each stage of Run(), the difference between prepared and rendered is the current frame latency
+	//	Frames are handed over at fixed points of Run(), which makes these deterministic after each Run():
+	//	immediate mode	: Update() -> PreRender() -> Render() -> PostRender() -> Compose()
+	//	pipelined mode	: Render() of the previous frame is started -> Update() -> Render() is waited -> PostRender() -> Compose() -> PreRender()
+	struct FrameCounters
+	{
+		uint64_t updated = 0;	// Update() calls
+		uint64_t prepared = 0;	// PreRender() calls
+		uint64_t rendered = 0;	// Render() calls, the frame that was prepared by the same PreRender() call is rendered
+		uint64_t presented = 0;	// presented frames
+	};
+	const FrameCounters& getFrameCounters() const { return frameCounters; }
 
 	// This is where the critical initializations happen (before any rendering or anything else)
 	virtual void Initialize();
@@ -54,9 +107,15 @@ public:
 	// This is where application-wide updates get executed in a fixed timestep based manner. 
 	//  RenderPath::FixedUpdate is also called from here for the active component
 	virtual void FixedUpdate();
-	// This is where application-wide rendering happens to offscreen buffers. 
+	// This is where the frame is prepared for rendering, after Update(). The rendering state must only be changed from here when the frame latency is not zero
+	//  RenderPath::PreRender is also called from here for the active component
+	virtual void PreRender();
+	// This is where application-wide rendering happens to offscreen buffers. This can run on an other thread, see setFrameLatency()
 	//  RenderPath::Render is also called from here for the active component
 	virtual void Render();
+	// This is where the rendering of elements that are updated by Update() happens to offscreen buffers, on the main thread
+	//  RenderPath::PostRender is also called from here for the active component
+	virtual void PostRender();
 	// This is where the application will render to the screen (backbuffer). It must render to the provided command list.
 	virtual void Compose(wiGraphics::CommandList cmd);
 
@@ -81,5 +140,8 @@ public:
 	};
 	// display all-time engine information text
 	InfoDisplayer infoDisplay;
+
+protected:
+	FrameCounters frameCounters;
 };
 
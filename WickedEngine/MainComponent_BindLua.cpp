@@ -17,6 +17,7 @@ Luna<MainComponent_BindLua>::FunctionType MainComponent_BindLua::methods[] = {
 	lunamethod(MainComponent_BindLua, SetFrameSkip),
 	lunamethod(MainComponent_BindLua, SetTargetFrameRate),
 	lunamethod(MainComponent_BindLua, SetFrameRateLock),
+	lunamethod(MainComponent_BindLua, SetFrameLatency),
 	lunamethod(MainComponent_BindLua, SetInfoDisplay),
 	lunamethod(MainComponent_BindLua, SetWatermarkDisplay),
 	lunamethod(MainComponent_BindLua, SetFPSDisplay),
@@ -48,7 +49,7 @@ int MainComponent_BindLua::GetActivePath(lua_State *L)
 	RenderPath3D_Deferred* compDef3D = dynamic_cast<RenderPath3D_Deferred*>(component->GetActivePath());
 	if (compDef3D != nullptr)
 	{
-		Luna<RenderPath3D_Deferred_BindLua>::push(L, new RenderPath3D_Deferred_BindLua(compDef3D));
+		Luna<RenderPath3D_Deferred_BindLua>::create(L, compDef3D);
 		return 1;
 	}
 
@@ -56,7 +57,7 @@ int MainComponent_BindLua::GetActivePath(lua_State *L)
 	RenderPath3D_TiledDeferred* compTDef3D = dynamic_cast<RenderPath3D_TiledDeferred*>(component->GetActivePath());
 	if (compTDef3D != nullptr)
 	{
-		Luna<RenderPath3D_TiledDeferred_BindLua>::push(L, new RenderPath3D_TiledDeferred_BindLua(compTDef3D));
+		Luna<RenderPath3D_TiledDeferred_BindLua>::create(L, compTDef3D);
 		return 1;
 	}
 
@@ -64,7 +65,7 @@ int MainComponent_BindLua::GetActivePath(lua_State *L)
 	RenderPath3D_TiledForward* compTFwd3D = dynamic_cast<RenderPath3D_TiledForward*>(component->GetActivePath());
 	if (compTFwd3D != nullptr)
 	{
-		Luna<RenderPath3D_TiledForward_BindLua>::push(L, new RenderPath3D_TiledForward_BindLua(compTFwd3D));
+		Luna<RenderPath3D_TiledForward_BindLua>::create(L, compTFwd3D);
 		return 1;
 	}
 
@@ -72,7 +73,7 @@ int MainComponent_BindLua::GetActivePath(lua_State *L)
 	RenderPath3D_Forward* compFwd3D = dynamic_cast<RenderPath3D_Forward*>(component->GetActivePath());
 	if (compFwd3D != nullptr)
 	{
-		Luna<RenderPath3D_Forward_BindLua>::push(L, new RenderPath3D_Forward_BindLua(compFwd3D));
+		Luna<RenderPath3D_Forward_BindLua>::create(L, compFwd3D);
 		return 1;
 	}
 
@@ -80,7 +81,7 @@ int MainComponent_BindLua::GetActivePath(lua_State *L)
 	RenderPath3D* comp3D = dynamic_cast<RenderPath3D*>(component->GetActivePath());
 	if (comp3D != nullptr)
 	{
-		Luna<RenderPath3D_BindLua>::push(L, new RenderPath3D_BindLua(comp3D));
+		Luna<RenderPath3D_BindLua>::create(L, comp3D);
 		return 1;
 	}
 
@@ -88,7 +89,7 @@ int MainComponent_BindLua::GetActivePath(lua_State *L)
 	LoadingScreen* compLoad = dynamic_cast<LoadingScreen*>(component->GetActivePath());
 	if (compLoad != nullptr)
 	{
-		Luna<LoadingScreen_BindLua>::push(L, new LoadingScreen_BindLua(compLoad));
+		Luna<LoadingScreen_BindLua>::create(L, compLoad);
 		return 1;
 	}
 
@@ -96,7 +97,7 @@ int MainComponent_BindLua::GetActivePath(lua_State *L)
 	RenderPath2D* comp2D = dynamic_cast<RenderPath2D*>(component->GetActivePath());
 	if (comp2D != nullptr)
 	{
-		Luna<RenderPath2D_BindLua>::push(L, new RenderPath2D_BindLua(comp2D));
+		Luna<RenderPath2D_BindLua>::create(L, comp2D);
 		return 1;
 	}
 
@@ -104,7 +105,7 @@ int MainComponent_BindLua::GetActivePath(lua_State *L)
 	RenderPath* comp = dynamic_cast<RenderPath*>(component->GetActivePath());
 	if (comp != nullptr)
 	{
-		Luna<RenderPath_BindLua>::push(L, new RenderPath_BindLua(comp));
+		Luna<RenderPath_BindLua>::create(L, comp);
 		return 1;
 	}
 
@@ -255,6 +256,24 @@ int MainComponent_BindLua::SetFrameRateLock(lua_State *L)
 		wiLua::SError(L, "SetFrameRateLock(bool enabled) not enought arguments!");
 	return 0;
 }
+int MainComponent_BindLua::SetFrameLatency(lua_State *L)
+{
+	if (component == nullptr)
+	{
+		wiLua::SError(L, "SetFrameLatency(int value) component is empty!");
+		return 0;
+	}
+
+	int argc = wiLua::SGetArgCount(L);
+	if (argc > 0)
+	{
+		const int value = wiLua::SGetInt(L, 1);
+		component->setFrameLatency(value > 0 ? (uint32_t)value : 0);
+	}
+	else
+		wiLua::SError(L, "SetFrameLatency(int value) not enought arguments!");
+	return 0;
+}
 int MainComponent_BindLua::SetInfoDisplay(lua_State *L)
 {
 	if (component == nullptr)
@@ -334,6 +353,19 @@ int SetProfilerEnabled(lua_State* L)
 	return 0;
 }
 
+int CaptureProfiler(lua_State* L)
+{
+	int argc = wiLua::SGetArgCount(L);
+	if (argc > 1)
+	{
+		wiProfiler::Capture((uint32_t)wiLua::SGetInt(L, 1), wiLua::SGetString(L, 2));
+	}
+	else
+		wiLua::SError(L, "CaptureProfiler(int frameCount, string filename) not enough arguments!");
+
+	return 0;
+}
+
 void MainComponent_BindLua::Bind()
 {
 	static bool initialized = false;
@@ -343,5 +375,6 @@ void MainComponent_BindLua::Bind()
 		Luna<MainComponent_BindLua>::Register(wiLua::GetGlobal()->GetLuaState()); 
 		
 		wiLua::GetGlobal()->RegisterFunc("SetProfilerEnabled", SetProfilerEnabled);
+		wiLua::GetGlobal()->RegisterFunc("CaptureProfiler", CaptureProfiler);
 	}
 }
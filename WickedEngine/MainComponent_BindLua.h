@@ -20,6 +20,7 @@ public:
 	int SetFrameSkip(lua_State *L);
 	int SetTargetFrameRate(lua_State *L);
 	int SetFrameRateLock(lua_State *L);
+	int SetFrameLatency(lua_State *L);
 	int SetInfoDisplay(lua_State *L);
 	int SetWatermarkDisplay(lua_State *L);
 	int SetFPSDisplay(lua_State *L);
@@ -73,7 +73,7 @@ int Matrix_BindLua::GetRow(lua_State* L)
 		if (row < 0 || row > 3)
 			row = 0;
 	}
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(matrix.r[row]));
+	Luna<Vector_BindLua>::create(L, matrix.r[row]);
 	return 1;
 }
 
@@ -91,7 +91,7 @@ int Matrix_BindLua::Translation(lua_State* L)
 			mat = XMMatrixTranslationFromVector(vector->vector);
 		}
 	}
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(mat));
+	Luna<Matrix_BindLua>::create(L, mat);
 	return 1;
 }
 
@@ -107,7 +107,7 @@ int Matrix_BindLua::Rotation(lua_State* L)
 			mat = XMMatrixRotationRollPitchYawFromVector(vector->vector);
 		}
 	}
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(mat));
+	Luna<Matrix_BindLua>::create(L, mat);
 	return 1;
 }
 
@@ -119,7 +119,7 @@ int Matrix_BindLua::RotationX(lua_State* L)
 	{
 		mat = XMMatrixRotationX(wiLua::SGetFloat(L, 1));
 	}
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(mat));
+	Luna<Matrix_BindLua>::create(L, mat);
 	return 1;
 }
 
@@ -131,7 +131,7 @@ int Matrix_BindLua::RotationY(lua_State* L)
 	{
 		mat = XMMatrixRotationY(wiLua::SGetFloat(L, 1));
 	}
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(mat));
+	Luna<Matrix_BindLua>::create(L, mat);
 	return 1;
 }
 
@@ -143,7 +143,7 @@ int Matrix_BindLua::RotationZ(lua_State* L)
 	{
 		mat = XMMatrixRotationZ(wiLua::SGetFloat(L, 1));
 	}
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(mat));
+	Luna<Matrix_BindLua>::create(L, mat);
 	return 1;
 }
 
@@ -159,7 +159,7 @@ int Matrix_BindLua::RotationQuaternion(lua_State* L)
 			mat = XMMatrixRotationQuaternion(vector->vector);
 		}
 	}
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(mat));
+	Luna<Matrix_BindLua>::create(L, mat);
 	return 1;
 }
 
@@ -175,7 +175,7 @@ int Matrix_BindLua::Scale(lua_State* L)
 			mat = XMMatrixScalingFromVector(vector->vector);
 		}
 	}
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(mat));
+	Luna<Matrix_BindLua>::create(L, mat);
 	return 1;
 }
 
@@ -196,7 +196,7 @@ int Matrix_BindLua::LookTo(lua_State* L)
 			}
 			else
 				Up = XMVectorSet(0, 1, 0, 0);
-			Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(XMMatrixLookToLH(pos->vector, dir->vector, Up)));
+			Luna<Matrix_BindLua>::create(L, XMMatrixLookToLH(pos->vector, dir->vector, Up));
 		}
 		else
 			wiLua::SError(L, "LookTo(Vector eye, Vector direction, opt Vector up) argument is not a Vector!");
@@ -223,7 +223,7 @@ int Matrix_BindLua::LookAt(lua_State* L)
 			}
 			else
 				Up = XMVectorSet(0, 1, 0, 0);
-			Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(XMMatrixLookAtLH(pos->vector, dir->vector, Up)));
+			Luna<Matrix_BindLua>::create(L, XMMatrixLookAtLH(pos->vector, dir->vector, Up));
 		}
 		else
 			wiLua::SError(L, "LookAt(Vector eye, Vector focusPos, opt Vector up) argument is not a Vector!");
@@ -242,7 +242,7 @@ int Matrix_BindLua::Multiply(lua_State* L)
 		Matrix_BindLua* m2 = Luna<Matrix_BindLua>::lightcheck(L, 2);
 		if (m1 && m2)
 		{
-			Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(XMMatrixMultiply(m1->matrix, m2->matrix)));
+			Luna<Matrix_BindLua>::create(L, XMMatrixMultiply(m1->matrix, m2->matrix));
 			return 1;
 		}
 	}
@@ -258,7 +258,7 @@ int Matrix_BindLua::Add(lua_State* L)
 		Matrix_BindLua* m2 = Luna<Matrix_BindLua>::lightcheck(L, 2);
 		if (m1 && m2)
 		{
-			Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(m1->matrix + m2->matrix));
+			Luna<Matrix_BindLua>::create(L, m1->matrix + m2->matrix);
 			return 1;
 		}
 	}
@@ -273,7 +273,7 @@ int Matrix_BindLua::Transpose(lua_State* L)
 		Matrix_BindLua* m1 = Luna<Matrix_BindLua>::lightcheck(L, 1);
 		if (m1)
 		{
-			Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(XMMatrixTranspose(m1->matrix)));
+			Luna<Matrix_BindLua>::create(L, XMMatrixTranspose(m1->matrix));
 			return 1;
 		}
 	}
@@ -289,7 +289,7 @@ int Matrix_BindLua::Inverse(lua_State* L)
 		if (m1)
 		{
 			XMVECTOR det;
-			Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(XMMatrixInverse(&det, m1->matrix)));
+			Luna<Matrix_BindLua>::create(L, XMMatrixInverse(&det, m1->matrix));
 			wiLua::SSetFloat(L, XMVectorGetX(det));
 			return 2;
 		}
@@ -7,13 +7,14 @@ void RenderPath::ResizeLayout()
 	dpi = wiPlatform::GetDPI();
 }
 
-void RenderPath::Update(float dt)
+void RenderPath::PreRender()
 {
-	if (wiRenderer::ResolutionChanged() || !initial_resizebuffer)
+	if (wiRenderer::ResolutionChanged() || !initial_resizebuffer || resizebuffer_requested)
 	{
 		ResizeBuffers();
 		ResizeLayout();
 		initial_resizebuffer = true;
+		resizebuffer_requested = false;
 	}
 	if (dpi != wiPlatform::GetDPI())
 	{
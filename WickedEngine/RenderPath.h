@@ -9,6 +9,7 @@ class RenderPath
 private:
 	uint32_t layerMask = 0xFFFFFFFF;
 	bool initial_resizebuffer = false;
+	bool resizebuffer_requested = false;
 	int dpi = 0;
 
 protected:
@@ -22,6 +23,9 @@ public:
 
 	virtual ~RenderPath() { Unload(); }
 
+	// Request ResizeBuffers() from the next PreRender(), the render targets must not be recreated while the previous frame can be rendering
+	void RequestResizeBuffers() { resizebuffer_requested = true; }
+
 	// initialize component
 	virtual void Initialize() {}
 	// load resources
@@ -36,10 +40,17 @@ public:
 	virtual void FixedUpdate() {}
 	// update once per frame
 	//	dt : elapsed time since last call in seconds
-	virtual void Update(float dt);
+	virtual void Update(float dt) {}
+	// prepare the frame that will be rendered after Update(), resolution dependent resources are created here
+	//	With pipelined rendering (see MainComponent::setFrameLatency()), this is the only place between Update() and Render()
+	//	where the rendering state can be changed, because Render() can run on an other thread while the next Update() is running
+	virtual void PreRender();
 	// Render to layers, rendertargets, etc
 	// This will be rendered offscreen
 	virtual void Render() const {}
+	// Render the elements that are updated by Update() after Render(), such as the GUI and sprite layers
+	// This will be rendered offscreen, always on the main thread
+	virtual void PostRender() const {}
 	// Compose the rendered layers (for example blend the layers together as Images)
 	// This will be rendered to the backbuffer
 	virtual void Compose(wiGraphics::CommandList cmd) const {}
@@ -4,6 +4,8 @@
 #include "wiSpriteFont.h"
 #include "wiRenderer.h"
 
+#include <algorithm>
+
 using namespace wiGraphics;
 
 void RenderPath2D::ResizeBuffers()
@@ -132,7 +134,7 @@ void RenderPath2D::FixedUpdate()
 
 	RenderPath::FixedUpdate();
 }
-void RenderPath2D::Render() const
+void RenderPath2D::PostRender() const
 {
 	GraphicsDevice* device = wiRenderer::GetDevice();
 	CommandList cmd = device->BeginCommandList();
@@ -151,6 +153,7 @@ void RenderPath2D::Render() const
 		device->BindViewports(1, &vp, cmd);
 
 		wiRenderer::GetDevice()->EventBegin("STENCIL Sprite Layers", cmd);
+		wiImage::BeginBatch(cmd);
 		for (auto& x : layers)
 		{
 			for (auto& y : x.items)
@@ -161,6 +164,7 @@ void RenderPath2D::Render() const
 				}
 			}
 		}
+		wiImage::EndBatch(cmd);
 		wiRenderer::GetDevice()->EventEnd(cmd);
 
 		device->RenderPassEnd(cmd);
@@ -198,6 +202,7 @@ void RenderPath2D::Render() const
 		else
 		{
 			wiRenderer::GetDevice()->EventBegin("STENCIL Sprite Layers", cmd);
+			wiImage::BeginBatch(cmd);
 			for (auto& x : layers)
 			{
 				for (auto& y : x.items)
@@ -208,32 +213,41 @@ void RenderPath2D::Render() const
 					}
 				}
 			}
+			wiImage::EndBatch(cmd);
 			wiRenderer::GetDevice()->EventEnd(cmd);
 		}
 	}
 
 	wiRenderer::GetDevice()->EventBegin("Sprite Layers", cmd);
+	// Consecutive sprites and consecutive fonts are drawn together, one batch is flushed when an item of the other kind comes inbetween to keep the order.
+	//	Consecutive sprites with the same texture, sampler and blend mode are one instanced draw call, sprites outside of the canvas are culled by wiImage
+	wiImage::BeginBatch(cmd);
+	wiFont::BeginBatch(cmd);
 	for (auto& x : layers)
 	{
 		for (auto& y : x.items)
 		{
 			if (y.sprite != nullptr && y.sprite->params.stencilComp == STENCILMODE_DISABLED)
 			{
+				wiFont::Flush(cmd);
 				y.sprite->Draw(cmd);
 			}
 			if (y.font != nullptr)
 			{
+				wiImage::Flush(cmd);
 				y.font->Draw(cmd);
 			}
 		}
 	}
+	wiFont::EndBatch(cmd);
+	wiImage::EndBatch(cmd);
 	wiRenderer::GetDevice()->EventEnd(cmd);
 
 	GetGUI().Render(cmd);
 
 	device->RenderPassEnd(cmd);
 
-	RenderPath::Render();
+	RenderPath::PostRender();
 }
 void RenderPath2D::Compose(CommandList cmd) const
 {
@@ -409,40 +423,23 @@ void RenderPath2D::SetFontOrder(wiSpriteFont* font, int order)
 }
 void RenderPath2D::SortLayers()
 {
-	if (layers.empty())
-	{
-		return;
-	}
-
-	for (size_t i = 0; i < layers.size() - 1; ++i)
+	// Stable sort, so layers and items with the same order keep the order they were added in.
+	//	Items are mostly added in order, the sort is skipped if nothing is out of order:
+	auto compare_layers = [](const RenderLayer2D& a, const RenderLayer2D& b) {
+		return a.order < b.order;
+	};
+	auto compare_items = [](const RenderItem2D& a, const RenderItem2D& b) {
+		return a.order < b.order;
+	};
+	if (!std::is_sorted(layers.begin(), layers.end(), compare_layers))
 	{
-		for (size_t j = i + 1; j < layers.size(); ++j)
-		{
-			if (layers[i].order > layers[j].order)
-			{
-				RenderLayer2D swap = layers[i];
-				layers[i] = layers[j];
-				layers[j] = swap;
-			}
-		}
+		std::stable_sort(layers.begin(), layers.end(), compare_layers);
 	}
 	for (auto& x : layers)
 	{
-		if (x.items.empty())
-		{
-			continue;
-		}
-		for (size_t i = 0; i < x.items.size() - 1; ++i)
+		if (!std::is_sorted(x.items.begin(), x.items.end(), compare_items))
 		{
-			for (size_t j = i + 1; j < x.items.size(); ++j)
-			{
-				if (x.items[i].order > x.items[j].order)
-				{
-					RenderItem2D swap = x.items[i];
-					x.items[i] = x.items[j];
-					x.items[j] = swap;
-				}
-			}
+			std::stable_sort(x.items.begin(), x.items.end(), compare_items);
 		}
 	}
 }
@@ -48,7 +48,7 @@ public:
 	void Start() override;
 	void Update(float dt) override;
 	void FixedUpdate() override;
-	void Render() const override;
+	void PostRender() const override;
 	void Compose(wiGraphics::CommandList cmd) const override;
 
 	const wiGraphics::Texture& GetRenderResult() const { return rtFinal; }
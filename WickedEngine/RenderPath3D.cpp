@@ -15,6 +15,22 @@ void RenderPath3D::ResizeBuffers()
 
 	FORMAT defaultTextureFormat = device->GetBackBufferFormat();
 
+	// Render targets that are only used within the frame are declared to the render graph, which creates them later:
+	rendergraph.Reset();
+	rg_sun[0] = wiRenderGraph::INVALID_RESOURCE;
+	rg_sun[1] = wiRenderGraph::INVALID_RESOURCE;
+	rg_sun_resolved = wiRenderGraph::INVALID_RESOURCE;
+	rg_volumetriclights = wiRenderGraph::INVALID_RESOURCE;
+	rg_waterripple = wiRenderGraph::INVALID_RESOURCE;
+	rg_particledistortion = wiRenderGraph::INVALID_RESOURCE;
+	rg_particledistortion_resolved = wiRenderGraph::INVALID_RESOURCE;
+	rg_postprocess_hdr = wiRenderGraph::INVALID_RESOURCE;
+	rg_postprocess_ldr[0] = wiRenderGraph::INVALID_RESOURCE;
+	rg_postprocess_ldr[1] = wiRenderGraph::INVALID_RESOURCE;
+	rg_scenecopy = wiRenderGraph::INVALID_RESOURCE;
+	rg_scenecopy_tmp = wiRenderGraph::INVALID_RESOURCE;
+	rg_bloom = wiRenderGraph::INVALID_RESOURCE;
+	rg_bloom_tmp = wiRenderGraph::INVALID_RESOURCE;
 
 	// Render targets:
 	{
@@ -33,13 +49,11 @@ void RenderPath3D::ResizeBuffers()
 		desc.Width = wiRenderer::GetInternalResolution().x;
 		desc.Height = wiRenderer::GetInternalResolution().y;
 		desc.SampleCount = getMSAASampleCount();
-		device->CreateTexture(&desc, nullptr, &rtParticleDistortion);
-		device->SetName(&rtParticleDistortion, "rtParticleDistortion");
+		rg_particledistortion = rendergraph.CreateTexture("rtParticleDistortion", desc);
 		if (getMSAASampleCount() > 1)
 		{
 			desc.SampleCount = 1;
-			device->CreateTexture(&desc, nullptr, &rtParticleDistortion_Resolved);
-			device->SetName(&rtParticleDistortion_Resolved, "rtParticleDistortion_Resolved");
+			rg_particledistortion_resolved = rendergraph.CreateTexture("rtParticleDistortion_Resolved", desc);
 		}
 	}
 	{
@@ -48,8 +62,7 @@ void RenderPath3D::ResizeBuffers()
 		desc.BindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
 		desc.Width = wiRenderer::GetInternalResolution().x / 4;
 		desc.Height = wiRenderer::GetInternalResolution().y / 4;
-		device->CreateTexture(&desc, nullptr, &rtVolumetricLights);
-		device->SetName(&rtVolumetricLights, "rtVolumetricLights");
+		rg_volumetriclights = rendergraph.CreateTexture("rtVolumetricLights", desc);
 	}
 	{
 		TextureDesc desc;
@@ -57,8 +70,7 @@ void RenderPath3D::ResizeBuffers()
 		desc.Format = FORMAT_R8G8B8A8_SNORM;
 		desc.Width = wiRenderer::GetInternalResolution().x;
 		desc.Height = wiRenderer::GetInternalResolution().y;
-		device->CreateTexture(&desc, nullptr, &rtWaterRipple);
-		device->SetName(&rtWaterRipple, "rtWaterRipple");
+		rg_waterripple = rendergraph.CreateTexture("rtWaterRipple", desc);
 	}
 	{
 		TextureDesc desc;
@@ -67,24 +79,9 @@ void RenderPath3D::ResizeBuffers()
 		desc.Width = wiRenderer::GetInternalResolution().x / 2;
 		desc.Height = wiRenderer::GetInternalResolution().y / 2;
 		desc.MipLevels = std::min(8u, (uint32_t)std::log2(std::max(desc.Width, desc.Height)));
-		device->CreateTexture(&desc, nullptr, &rtSceneCopy);
-		device->SetName(&rtSceneCopy, "rtSceneCopy");
+		rg_scenecopy = rendergraph.CreateTexture("rtSceneCopy", desc);
 		desc.BindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
-		device->CreateTexture(&desc, nullptr, &rtSceneCopy_tmp);
-		device->SetName(&rtSceneCopy_tmp, "rtSceneCopy_tmp");
-
-		for (uint32_t i = 0; i < rtSceneCopy.GetDesc().MipLevels; ++i)
-		{
-			int subresource_index;
-			subresource_index = device->CreateSubresource(&rtSceneCopy, SRV, 0, 1, i, 1);
-			assert(subresource_index == i);
-			subresource_index = device->CreateSubresource(&rtSceneCopy_tmp, SRV, 0, 1, i, 1);
-			assert(subresource_index == i);
-			subresource_index = device->CreateSubresource(&rtSceneCopy, UAV, 0, 1, i, 1);
-			assert(subresource_index == i);
-			subresource_index = device->CreateSubresource(&rtSceneCopy_tmp, UAV, 0, 1, i, 1);
-			assert(subresource_index == i);
-		}
+		rg_scenecopy_tmp = rendergraph.CreateTexture("rtSceneCopy_tmp", desc);
 	}
 	{
 		TextureDesc desc;
@@ -112,23 +109,20 @@ void RenderPath3D::ResizeBuffers()
 		desc.Width = wiRenderer::GetInternalResolution().x;
 		desc.Height = wiRenderer::GetInternalResolution().y;
 		desc.SampleCount = getMSAASampleCount();
-		device->CreateTexture(&desc, nullptr, &rtSun[0]);
-		device->SetName(&rtSun[0], "rtSun[0]");
+		rg_sun[0] = rendergraph.CreateTexture("rtSun[0]", desc);
 
 		desc.BindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
 		desc.SampleCount = 1;
 		desc.Width = wiRenderer::GetInternalResolution().x / 2;
 		desc.Height = wiRenderer::GetInternalResolution().y / 2;
-		device->CreateTexture(&desc, nullptr, &rtSun[1]);
-		device->SetName(&rtSun[1], "rtSun[1]");
+		rg_sun[1] = rendergraph.CreateTexture("rtSun[1]", desc);
 
 		if (getMSAASampleCount() > 1)
 		{
 			desc.Width = wiRenderer::GetInternalResolution().x;
 			desc.Height = wiRenderer::GetInternalResolution().y;
 			desc.SampleCount = 1;
-			device->CreateTexture(&desc, nullptr, &rtSun_resolved);
-			device->SetName(&rtSun_resolved, "rtSun_resolved");
+			rg_sun_resolved = rendergraph.CreateTexture("rtSun_resolved", desc);
 		}
 	}
 	{
@@ -138,23 +132,8 @@ void RenderPath3D::ResizeBuffers()
 		desc.Width = wiRenderer::GetInternalResolution().x / 4;
 		desc.Height = wiRenderer::GetInternalResolution().y / 4;
 		desc.MipLevels = std::min(5u, (uint32_t)std::log2(std::max(desc.Width, desc.Height)));
-		device->CreateTexture(&desc, nullptr, &rtBloom);
-		device->SetName(&rtBloom, "rtBloom");
-		device->CreateTexture(&desc, nullptr, &rtBloom_tmp);
-		device->SetName(&rtBloom_tmp, "rtBloom_tmp");
-
-		for (uint32_t i = 0; i < rtBloom.GetDesc().MipLevels; ++i)
-		{
-			int subresource_index;
-			subresource_index = device->CreateSubresource(&rtBloom, SRV, 0, 1, i, 1);
-			assert(subresource_index == i);
-			subresource_index = device->CreateSubresource(&rtBloom_tmp, SRV, 0, 1, i, 1);
-			assert(subresource_index == i);
-			subresource_index = device->CreateSubresource(&rtBloom, UAV, 0, 1, i, 1);
-			assert(subresource_index == i);
-			subresource_index = device->CreateSubresource(&rtBloom_tmp, UAV, 0, 1, i, 1);
-			assert(subresource_index == i);
-		}
+		rg_bloom = rendergraph.CreateTexture("rtBloom", desc);
+		rg_bloom_tmp = rendergraph.CreateTexture("rtBloom_tmp", desc);
 	}
 	{
 		TextureDesc desc;
@@ -173,8 +152,7 @@ void RenderPath3D::ResizeBuffers()
 		desc.Format = FORMAT_R11G11B10_FLOAT;
 		desc.Width = wiRenderer::GetInternalResolution().x;
 		desc.Height = wiRenderer::GetInternalResolution().y;
-		device->CreateTexture(&desc, nullptr, &rtPostprocess_HDR);
-		device->SetName(&rtPostprocess_HDR, "rtPostprocess_HDR");
+		rg_postprocess_hdr = rendergraph.CreateTexture("rtPostprocess_HDR", desc);
 	}
 	{
 		TextureDesc desc;
@@ -182,10 +160,8 @@ void RenderPath3D::ResizeBuffers()
 		desc.Format = defaultTextureFormat;
 		desc.Width = wiRenderer::GetInternalResolution().x;
 		desc.Height = wiRenderer::GetInternalResolution().y;
-		device->CreateTexture(&desc, nullptr, &rtPostprocess_LDR[0]);
-		device->SetName(&rtPostprocess_LDR[0], "rtPostprocess_LDR[0]");
-		device->CreateTexture(&desc, nullptr, &rtPostprocess_LDR[1]);
-		device->SetName(&rtPostprocess_LDR[1], "rtPostprocess_LDR[1]");
+		rg_postprocess_ldr[0] = rendergraph.CreateTexture("rtPostprocess_LDR[0]", desc);
+		rg_postprocess_ldr[1] = rendergraph.CreateTexture("rtPostprocess_LDR[1]", desc);
 
 		desc.Width /= 4;
 		desc.Height /= 4;
@@ -266,6 +242,74 @@ void RenderPath3D::ResizeBuffers()
 		device->SetName(&smallDepth, "smallDepth");
 	}
 
+	// Transient render targets:
+	//	The passes mirror the usage in the last command list of the render paths (RenderLightShafts() .. RenderPostprocessChain()), which assert that every access is declared here
+	//	The textures stay in their resting layout between the passes, like everywhere else in the render paths
+	//	The other render targets are not transient in this scope, so they stay dedicated textures:
+	//		rtTemporalAA is the TAA history, rtSSR is read by the lighting of the next frame
+	//		rtLinearDepth and rtAO are written in earlier command lists and read across the command lists of the frame
+	{
+		const bool msaa = getMSAASampleCount() > 1;
+
+		rendergraph.AddPass("Light Shafts")
+			.Write(rg_sun[0], IMAGE_LAYOUT_GENERAL)
+			.Write(msaa ? rg_sun_resolved : rg_sun[0], IMAGE_LAYOUT_GENERAL)
+			.Write(rg_sun[1], IMAGE_LAYOUT_GENERAL);
+
+		rendergraph.AddPass("Volumetric Lights")
+			.Write(rg_volumetriclights, IMAGE_LAYOUT_GENERAL);
+
+		rendergraph.AddPass("Scene MIP Chain")
+			.Write(rg_scenecopy, IMAGE_LAYOUT_GENERAL)
+			.Write(rg_scenecopy_tmp, IMAGE_LAYOUT_GENERAL);
+
+		// Writes rtSSR, which is not part of the graph
+		rendergraph.AddPass("SSR")
+			.Read(rg_scenecopy, IMAGE_LAYOUT_GENERAL)
+			.SideEffect();
+
+		rendergraph.AddPass("Transparents")
+			.Write(rg_waterripple, IMAGE_LAYOUT_GENERAL)
+			.Read(rg_volumetriclights, IMAGE_LAYOUT_GENERAL)
+			.Read(rg_sun[1], IMAGE_LAYOUT_GENERAL)
+			.Read(rg_scenecopy, IMAGE_LAYOUT_GENERAL)
+			.Write(rg_particledistortion, IMAGE_LAYOUT_GENERAL)
+			.Write(msaa ? rg_particledistortion_resolved : rg_particledistortion, IMAGE_LAYOUT_GENERAL);
+
+		rendergraph.AddPass("Post Process Chain")
+			.Read(msaa ? rg_particledistortion_resolved : rg_particledistortion, IMAGE_LAYOUT_GENERAL)
+			.Write(rg_postprocess_hdr, IMAGE_LAYOUT_GENERAL)
+			.Write(rg_postprocess_ldr[0], IMAGE_LAYOUT_GENERAL)
+			.Write(rg_postprocess_ldr[1], IMAGE_LAYOUT_GENERAL)
+			.Write(rg_bloom, IMAGE_LAYOUT_GENERAL)
+			.Write(rg_bloom_tmp, IMAGE_LAYOUT_GENERAL);
+
+		assert(rendergraph.GetPassCount() == RENDERGRAPH_PASS_COUNT);
+
+		// Read by Compose():
+		rendergraph.ExportTexture(rg_postprocess_ldr[0]);
+		rendergraph.ExportTexture(rg_postprocess_ldr[1]);
+
+		bool success = rendergraph.Compile();
+		assert(success);
+		rendergraph.Allocate(device);
+
+		rtSun[0] = rendergraph.GetTexture(rg_sun[0]);
+		rtSun[1] = rendergraph.GetTexture(rg_sun[1]);
+		rtSun_resolved = rendergraph.GetTexture(rg_sun_resolved);
+		rtVolumetricLights = rendergraph.GetTexture(rg_volumetriclights);
+		rtWaterRipple = rendergraph.GetTexture(rg_waterripple);
+		rtParticleDistortion = rendergraph.GetTexture(rg_particledistortion);
+		rtParticleDistortion_Resolved = rendergraph.GetTexture(rg_particledistortion_resolved);
+		rtPostprocess_HDR = rendergraph.GetTexture(rg_postprocess_hdr);
+		rtPostprocess_LDR[0] = rendergraph.GetTexture(rg_postprocess_ldr[0]);
+		rtPostprocess_LDR[1] = rendergraph.GetTexture(rg_postprocess_ldr[1]);
+		rtSceneCopy = rendergraph.GetTexture(rg_scenecopy);
+		rtSceneCopy_tmp = rendergraph.GetTexture(rg_scenecopy_tmp);
+		rtBloom = rendergraph.GetTexture(rg_bloom);
+		rtBloom_tmp = rendergraph.GetTexture(rg_bloom_tmp);
+	}
+
 	// Render passes:
 	{
 		RenderPassDesc desc;
@@ -334,7 +378,19 @@ void RenderPath3D::Update(float dt)
 {
 	RenderPath2D::Update(dt);
 
-	wiRenderer::UpdatePerFrameData(dt, getLayerMask());
+	wiRenderer::UpdateScene(dt);
+}
+void RenderPath3D::PreRender()
+{
+	if (msaaSampleCount != msaaSampleCount_requested)
+	{
+		msaaSampleCount = msaaSampleCount_requested;
+		RequestResizeBuffers();
+	}
+
+	RenderPath2D::PreRender();
+
+	wiRenderer::PrepareFrameData(getLayerMask());
 }
 
 void RenderPath3D::Compose(CommandList cmd) const
@@ -398,7 +454,7 @@ void RenderPath3D::RenderReflections(CommandList cmd) const
 
 		// reverse clipping if underwater
 		XMFLOAT4 water = wiRenderer::GetWaterPlane();
-		float d = XMVectorGetX(XMPlaneDotCoord(XMLoadFloat4(&water), wiRenderer::GetCamera().GetEye()));
+		float d = XMVectorGetX(XMPlaneDotCoord(XMLoadFloat4(&water), wiRenderer::GetRenderCamera().GetEye()));
 		if (d < 0)
 		{
 			water.x *= -1;
@@ -429,7 +485,7 @@ void RenderPath3D::RenderShadows(CommandList cmd) const
 {
 	if (getShadowsEnabled())
 	{
-		wiRenderer::DrawShadowmaps(wiRenderer::GetCamera(), cmd, getLayerMask());
+		wiRenderer::DrawShadowmaps(wiRenderer::GetRenderCamera(), cmd, getLayerMask());
 	}
 
 	wiRenderer::VoxelRadiance(cmd);
@@ -492,6 +548,7 @@ void RenderPath3D::RenderSSR(const Texture& gbuffer1, const Texture& gbuffer2, C
 {
 	if (getSSREnabled())
 	{
+		assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_SSR, rg_scenecopy, false));
 		wiRenderer::Postprocess_SSR(rtSceneCopy, depthBuffer_Copy, rtLinearDepth, gbuffer1, gbuffer2, rtSSR, cmd);
 	}
 }
@@ -519,11 +576,14 @@ void RenderPath3D::RenderOutline(CommandList cmd) const
 }
 void RenderPath3D::RenderLightShafts(CommandList cmd) const
 {
-	XMVECTOR sunDirection = XMLoadFloat3(&wiScene::GetScene().weather.sunDirection);
-	if (getLightShaftsEnabled() && XMVectorGetX(XMVector3Dot(sunDirection, wiRenderer::GetCamera().GetAt())) > 0)
+	XMVECTOR sunDirection = XMLoadFloat3(&wiRenderer::GetRenderScene().weather.sunDirection);
+	if (getLightShaftsEnabled() && XMVectorGetX(XMVector3Dot(sunDirection, wiRenderer::GetRenderCamera().GetAt())) > 0)
 	{
 		GraphicsDevice* device = wiRenderer::GetDevice();
 
+		assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_LIGHTSHAFTS, rg_sun[0], true));
+		assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_LIGHTSHAFTS, rg_sun[1], true));
+
 		device->EventBegin("Light Shafts", cmd);
 		device->UnbindResources(TEXSLOT_ONDEMAND0, TEXSLOT_ONDEMAND_COUNT, cmd);
 
@@ -544,6 +604,7 @@ void RenderPath3D::RenderLightShafts(CommandList cmd) const
 		const Texture* sunSource = &rtSun[0];
 		if (getMSAASampleCount() > 1)
 		{
+			assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_LIGHTSHAFTS, rg_sun_resolved, true));
 			device->MSAAResolve(&rtSun_resolved, sunSource, cmd);
 			sunSource = &rtSun_resolved;
 		}
@@ -552,7 +613,7 @@ void RenderPath3D::RenderLightShafts(CommandList cmd) const
 		{
 			XMVECTOR sunPos = XMVector3Project(sunDirection * 100000, 0, 0,
 				1.0f, 1.0f, 0.1f, 1.0f,
-				wiRenderer::GetCamera().GetProjection(), wiRenderer::GetCamera().GetView(), XMMatrixIdentity());
+				wiRenderer::GetRenderCamera().GetProjection(), wiRenderer::GetRenderCamera().GetView(), XMMatrixIdentity());
 			{
 				XMFLOAT2 sun;
 				XMStoreFloat2(&sun, sunPos);
@@ -568,6 +629,8 @@ void RenderPath3D::RenderVolumetrics(CommandList cmd) const
 	{
 		GraphicsDevice* device = wiRenderer::GetDevice();
 
+		assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_VOLUMETRICLIGHTS, rg_volumetriclights, true));
+
 		device->RenderPassBegin(&renderpass_volumetriclight, cmd);
 
 		Viewport vp;
@@ -575,7 +638,7 @@ void RenderPath3D::RenderVolumetrics(CommandList cmd) const
 		vp.Height = (float)rtVolumetricLights.GetDesc().Height;
 		device->BindViewports(1, &vp, cmd);
 
-		wiRenderer::DrawVolumeLights(wiRenderer::GetCamera(), depthBuffer_Copy, cmd);
+		wiRenderer::DrawVolumeLights(wiRenderer::GetRenderCamera(), depthBuffer_Copy, cmd);
 
 		device->RenderPassEnd(cmd);
 	}
@@ -587,6 +650,9 @@ void RenderPath3D::RenderSceneMIPChain(const Texture& srcSceneRT, CommandList cm
 	auto range = wiProfiler::BeginRangeGPU("Scene MIP Chain", cmd);
 	device->EventBegin("RenderSceneMIPChain", cmd);
 
+	assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_SCENEMIPCHAIN, rg_scenecopy, true));
+	assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_SCENEMIPCHAIN, rg_scenecopy_tmp, true));
+
 	device->RenderPassBegin(&renderpass_downsamplescene, cmd);
 
 	Viewport vp;
@@ -613,6 +679,9 @@ void RenderPath3D::RenderTransparents(const RenderPass& renderpass_transparent,
 {
 	GraphicsDevice* device = wiRenderer::GetDevice();
 
+	assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_TRANSPARENTS, rg_waterripple, true));
+	assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_TRANSPARENTS, rg_particledistortion, true));
+
 	// Water ripple rendering:
 	{
 		// todo: refactor water ripples and avoid clear if there is none!
@@ -643,23 +712,25 @@ void RenderPath3D::RenderTransparents(const RenderPass& renderpass_transparent,
 		auto range = wiProfiler::BeginRangeGPU("Transparent Scene", cmd);
 
 		device->BindResource(PS, getReflectionsEnabled() ? &rtReflection : wiTextureHelper::getTransparent(), TEXSLOT_RENDERPATH_REFLECTION, cmd);
+		assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_TRANSPARENTS, rg_scenecopy, false));
 		device->BindResource(PS, &rtSceneCopy, TEXSLOT_RENDERPATH_REFRACTION, cmd);
 		device->BindResource(PS, &rtWaterRipple, TEXSLOT_RENDERPATH_WATERRIPPLES, cmd);
-		wiRenderer::DrawScene_Transparent(wiRenderer::GetCamera(), rtLinearDepth, renderPass, cmd, true, true);
+		wiRenderer::DrawScene_Transparent(wiRenderer::GetRenderCamera(), rtLinearDepth, renderPass, cmd, true, true);
 
 		wiProfiler::EndRange(range); // Transparent Scene
 	}
 
-	wiRenderer::DrawLightVisualizers(wiRenderer::GetCamera(), cmd);
+	wiRenderer::DrawLightVisualizers(wiRenderer::GetRenderCamera(), cmd);
 
 	{
 		auto range = wiProfiler::BeginRangeGPU("EmittedParticles - Render", cmd);
-		wiRenderer::DrawSoftParticles(wiRenderer::GetCamera(), rtLinearDepth, false, cmd);
+		wiRenderer::DrawSoftParticles(wiRenderer::GetRenderCamera(), rtLinearDepth, false, cmd);
 		wiProfiler::EndRange(range);
 	}
 
 	if (getVolumeLightsEnabled() && wiRenderer::IsRequestedVolumetricLightRendering())
 	{
+		assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_TRANSPARENTS, rg_volumetriclights, false));
 		device->EventBegin("Contribute Volumetric Lights", cmd);
 		wiRenderer::Postprocess_Upsample_Bilateral(rtVolumetricLights, rtLinearDepth, 
 			*renderpass_transparent.desc.attachments[0].texture, cmd, true, 1.5f);
@@ -668,6 +739,7 @@ void RenderPath3D::RenderTransparents(const RenderPass& renderpass_transparent,
 
 	if (getLightShaftsEnabled())
 	{
+		assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_TRANSPARENTS, rg_sun[1], false));
 		device->EventBegin("Contribute LightShafts", cmd);
 		wiImageParams fx;
 		fx.enableFullScreen();
@@ -678,10 +750,10 @@ void RenderPath3D::RenderTransparents(const RenderPass& renderpass_transparent,
 
 	if (getLensFlareEnabled())
 	{
-		wiRenderer::DrawLensFlares(wiRenderer::GetCamera(), depthBuffer_Copy, cmd);
+		wiRenderer::DrawLensFlares(wiRenderer::GetRenderCamera(), depthBuffer_Copy, cmd);
 	}
 
-	wiRenderer::DrawDebugWorld(wiRenderer::GetCamera(), cmd);
+	wiRenderer::DrawDebugWorld(wiRenderer::GetRenderCamera(), cmd);
 
 	device->RenderPassEnd(cmd);
 
@@ -695,12 +767,13 @@ void RenderPath3D::RenderTransparents(const RenderPass& renderpass_transparent,
 		vp.Height = (float)rtParticleDistortion.GetDesc().Height;
 		device->BindViewports(1, &vp, cmd);
 
-		wiRenderer::DrawSoftParticles(wiRenderer::GetCamera(), rtLinearDepth, true, cmd);
+		wiRenderer::DrawSoftParticles(wiRenderer::GetRenderCamera(), rtLinearDepth, true, cmd);
 
 		device->RenderPassEnd(cmd);
 
 		if (getMSAASampleCount() > 1)
 		{
+			assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_TRANSPARENTS, rg_particledistortion_resolved, true));
 			device->MSAAResolve(&rtParticleDistortion_Resolved, &rtParticleDistortion, cmd);
 		}
 		wiProfiler::EndRange(range);
@@ -710,6 +783,11 @@ void RenderPath3D::RenderPostprocessChain(const Texture& srcSceneRT, const Textu
 {
 	GraphicsDevice* device = wiRenderer::GetDevice();
 
+	assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_POSTPROCESS, getMSAASampleCount() > 1 ? rg_particledistortion_resolved : rg_particledistortion, false));
+	assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_POSTPROCESS, rg_postprocess_hdr, true));
+	assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_POSTPROCESS, rg_postprocess_ldr[0], true));
+	assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_POSTPROCESS, rg_postprocess_ldr[1], true));
+
 	const Texture* rt_first = nullptr; // not ping-ponged with read / write
 	const Texture* rt_read = &srcSceneRT;
 	const Texture* rt_write = &rtPostprocess_HDR;
@@ -746,6 +824,8 @@ void RenderPath3D::RenderPostprocessChain(const Texture& srcSceneRT, const Textu
 
 		if (getBloomEnabled())
 		{
+			assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_POSTPROCESS, rg_bloom, true));
+			assert(rendergraph.IsAccessDeclared(RENDERGRAPH_PASS_POSTPROCESS, rg_bloom_tmp, true));
 			wiRenderer::Postprocess_Bloom(rt_first == nullptr ? *rt_read : *rt_first, rtBloom, rtBloom_tmp, *rt_write, cmd, getBloomThreshold());
 			rt_first = nullptr;
 
@@ -3,6 +3,7 @@
 #include "wiRenderer.h"
 #include "wiGraphicsDevice.h"
 #include "wiResourceManager.h"
+#include "wiRenderGraph.h"
 
 #include <memory>
 
@@ -58,6 +59,7 @@ private:
 	std::shared_ptr<wiResource> colorGradingTex;
 
 	uint32_t msaaSampleCount = 1;
+	uint32_t msaaSampleCount_requested = 1; // applied by PreRender()
 
 protected:
 	wiGraphics::Texture rtReflection; // contains the scene rendered for planar reflections
@@ -85,6 +87,33 @@ protected:
 	wiGraphics::Texture rtLinearDepth; // linear depth result + mipchain (max filter)
 	wiGraphics::Texture smallDepth; // downsampled depth buffer
 
+	wiRenderGraph rendergraph; // declares the transient render targets of the frame, to alias those that are never used at the same time
+
+	// Passes of the render graph, in the order that ResizeBuffers() adds them
+	enum RENDERGRAPH_PASS
+	{
+		RENDERGRAPH_PASS_LIGHTSHAFTS,
+		RENDERGRAPH_PASS_VOLUMETRICLIGHTS,
+		RENDERGRAPH_PASS_SCENEMIPCHAIN,
+		RENDERGRAPH_PASS_SSR,
+		RENDERGRAPH_PASS_TRANSPARENTS,
+		RENDERGRAPH_PASS_POSTPROCESS,
+		RENDERGRAPH_PASS_COUNT,
+	};
+	// Render graph resources of the transient render targets, the render functions assert that their pass declared each access
+	wiRenderGraph::ResourceHandle rg_sun[2] = { wiRenderGraph::INVALID_RESOURCE, wiRenderGraph::INVALID_RESOURCE };
+	wiRenderGraph::ResourceHandle rg_sun_resolved = wiRenderGraph::INVALID_RESOURCE;
+	wiRenderGraph::ResourceHandle rg_volumetriclights = wiRenderGraph::INVALID_RESOURCE;
+	wiRenderGraph::ResourceHandle rg_waterripple = wiRenderGraph::INVALID_RESOURCE;
+	wiRenderGraph::ResourceHandle rg_particledistortion = wiRenderGraph::INVALID_RESOURCE;
+	wiRenderGraph::ResourceHandle rg_particledistortion_resolved = wiRenderGraph::INVALID_RESOURCE;
+	wiRenderGraph::ResourceHandle rg_postprocess_hdr = wiRenderGraph::INVALID_RESOURCE;
+	wiRenderGraph::ResourceHandle rg_postprocess_ldr[2] = { wiRenderGraph::INVALID_RESOURCE, wiRenderGraph::INVALID_RESOURCE };
+	wiRenderGraph::ResourceHandle rg_scenecopy = wiRenderGraph::INVALID_RESOURCE;
+	wiRenderGraph::ResourceHandle rg_scenecopy_tmp = wiRenderGraph::INVALID_RESOURCE;
+	wiRenderGraph::ResourceHandle rg_bloom = wiRenderGraph::INVALID_RESOURCE;
+	wiRenderGraph::ResourceHandle rg_bloom_tmp = wiRenderGraph::INVALID_RESOURCE;
+
 	wiGraphics::RenderPass renderpass_occlusionculling;
 	wiGraphics::RenderPass renderpass_reflection;
 	wiGraphics::RenderPass renderpass_downsampledepthbuffer;
@@ -203,9 +232,11 @@ public:
 
 	void setColorGradingTexture(std::shared_ptr<wiResource> resource) { colorGradingTex = resource; }
 
-	virtual void setMSAASampleCount(uint32_t value) { if (msaaSampleCount != value) { msaaSampleCount = value; ResizeBuffers(); } }
+	// The sample count is changed by the next PreRender(), which also recreates the render targets
+	virtual void setMSAASampleCount(uint32_t value) { msaaSampleCount_requested = value; }
 
 	void Update(float dt) override;
+	void PreRender() override;
 	void Render() const override = 0;
 	void Compose(wiGraphics::CommandList cmd) const override;
 };
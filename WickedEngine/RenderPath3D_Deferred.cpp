@@ -147,7 +147,7 @@ void RenderPath3D_Deferred::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 
 		{
 			auto range = wiProfiler::BeginRangeGPU("Opaque Scene", cmd);
@@ -165,7 +165,7 @@ void RenderPath3D_Deferred::Render() const
 			device->BindViewports(1, &vp, cmd);
 
 			device->BindResource(PS, getReflectionsEnabled() ? &rtReflection : wiTextureHelper::getTransparent(), TEXSLOT_RENDERPATH_REFLECTION, cmd);
-			wiRenderer::DrawScene(wiRenderer::GetCamera(), getTessellationEnabled(), cmd, RENDERPASS_DEFERRED, true, true);
+			wiRenderer::DrawScene(wiRenderer::GetRenderCamera(), getTessellationEnabled(), cmd, RENDERPASS_DEFERRED, true, true);
 
 			device->RenderPassEnd(cmd);
 
@@ -199,7 +199,7 @@ void RenderPath3D_Deferred::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 		wiRenderer::BindCommonResources(cmd);
 
 		RenderDecals(cmd);
@@ -215,7 +215,7 @@ void RenderPath3D_Deferred::Render() const
 
 			device->BindResource(PS, getAOEnabled() ? &rtAO : wiTextureHelper::getWhite(), TEXSLOT_RENDERPATH_AO, cmd);
 			device->BindResource(PS, getSSREnabled() ? &rtSSR : wiTextureHelper::getTransparent(), TEXSLOT_RENDERPATH_SSR, cmd);
-			wiRenderer::DrawDeferredLights(wiRenderer::GetCamera(), depthBuffer_Copy, rtGBuffer[0], rtGBuffer[1], rtGBuffer[2], cmd);
+			wiRenderer::DrawDeferredLights(wiRenderer::GetRenderCamera(), depthBuffer_Copy, rtGBuffer[0], rtGBuffer[1], rtGBuffer[2], cmd);
 
 			device->RenderPassEnd(cmd);
 		}
@@ -226,7 +226,7 @@ void RenderPath3D_Deferred::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 		wiRenderer::BindCommonResources(cmd);
 
 		RenderSSS(cmd);
@@ -249,8 +249,6 @@ void RenderPath3D_Deferred::Render() const
 
 	});
 
-	RenderPath2D::Render();
-
 	wiJobSystem::Wait(ctx);
 }
 
@@ -279,7 +277,7 @@ void RenderPath3D_Deferred::RenderDecals(CommandList cmd) const
 	vp.Height = (float)depthBuffer.GetDesc().Height;
 	device->BindViewports(1, &vp, cmd);
 
-	wiRenderer::DrawDeferredDecals(wiRenderer::GetCamera(), depthBuffer_Copy, cmd);
+	wiRenderer::DrawDeferredDecals(wiRenderer::GetRenderCamera(), depthBuffer_Copy, cmd);
 
 	device->RenderPassEnd(cmd);
 }
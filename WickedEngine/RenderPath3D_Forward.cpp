@@ -100,7 +100,7 @@ void RenderPath3D_Forward::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 
 		// depth prepass
 		{
@@ -118,7 +118,7 @@ void RenderPath3D_Forward::Render() const
 			vp.Height = (float)depthBuffer.GetDesc().Height;
 			device->BindViewports(1, &vp, cmd);
 
-			wiRenderer::DrawScene(wiRenderer::GetCamera(), getTessellationEnabled(), cmd, RENDERPASS_DEPTHONLY, true, true);
+			wiRenderer::DrawScene(wiRenderer::GetRenderCamera(), getTessellationEnabled(), cmd, RENDERPASS_DEPTHONLY, true, true);
 
 			device->RenderPassEnd(cmd);
 
@@ -173,7 +173,7 @@ void RenderPath3D_Forward::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 
 		// Opaque Scene:
 		{
@@ -189,7 +189,7 @@ void RenderPath3D_Forward::Render() const
 			device->BindResource(PS, getReflectionsEnabled() ? &rtReflection : wiTextureHelper::getTransparent(), TEXSLOT_RENDERPATH_REFLECTION, cmd);
 			device->BindResource(PS, getAOEnabled() ? &rtAO : wiTextureHelper::getWhite(), TEXSLOT_RENDERPATH_AO, cmd);
 			device->BindResource(PS, getSSREnabled() ? &rtSSR : wiTextureHelper::getTransparent(), TEXSLOT_RENDERPATH_SSR, cmd);
-			wiRenderer::DrawScene(wiRenderer::GetCamera(), getTessellationEnabled(), cmd, RENDERPASS_FORWARD, true, true);
+			wiRenderer::DrawScene(wiRenderer::GetRenderCamera(), getTessellationEnabled(), cmd, RENDERPASS_FORWARD, true, true);
 			wiRenderer::DrawSky(cmd);
 
 			RenderOutline(cmd);
@@ -204,7 +204,7 @@ void RenderPath3D_Forward::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 		wiRenderer::BindCommonResources(cmd);
 
 		if (getMSAASampleCount() > 1)
@@ -235,7 +235,5 @@ void RenderPath3D_Forward::Render() const
 
 	});
 
-	RenderPath2D::Render();
-
 	wiJobSystem::Wait(ctx);
 }
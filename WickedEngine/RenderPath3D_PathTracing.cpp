@@ -69,10 +69,11 @@ void RenderPath3D_PathTracing::Update(float dt)
 {
 	const Scene& scene = wiScene::GetScene();
 
+	// The accumulation is reset by PreRender(), because the previous frame can still be rendered here:
 	if (wiRenderer::GetCamera().IsDirty())
 	{
 		wiRenderer::GetCamera().SetDirty(false);
-		sam = -1;
+		resetAccumulation = true;
 	}
 	else
 	{
@@ -82,12 +83,12 @@ void RenderPath3D_PathTracing::Update(float dt)
 
 			if (transform.IsDirty())
 			{
-				sam = -1;
+				resetAccumulation = true;
 				break;
 			}
 		}
 
-		if (sam >= 0)
+		if (!resetAccumulation)
 		{
 			for (size_t i = 0; i < scene.materials.GetCount(); ++i)
 			{
@@ -95,17 +96,28 @@ void RenderPath3D_PathTracing::Update(float dt)
 
 				if (material.IsDirty())
 				{
-					sam = -1;
+					resetAccumulation = true;
 					break;
 				}
 			}
 		}
 	}
-	sam++;
 
 	RenderPath3D::Update(dt);
 }
 
+void RenderPath3D_PathTracing::PreRender()
+{
+	if (resetAccumulation)
+	{
+		resetAccumulation = false;
+		sam = -1;
+	}
+	sam++;
+
+	RenderPath3D::PreRender();
+}
+
 void RenderPath3D_PathTracing::Render() const
 {
 	GraphicsDevice* device = wiRenderer::GetDevice();
@@ -140,7 +152,7 @@ void RenderPath3D_PathTracing::Render() const
 			vp.Height = (float)traceResult.GetDesc().Height;
 			device->BindViewports(1, &vp, cmd);
 
-			wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+			wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 			wiRenderer::RayTraceSceneBVH(cmd);
 
 			device->RenderPassEnd(cmd);
@@ -149,9 +161,9 @@ void RenderPath3D_PathTracing::Render() const
 		{
 			auto range = wiProfiler::BeginRangeGPU("Traced Scene", cmd);
 
-			wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+			wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 
-			wiRenderer::RayBuffers* rayBuffers = wiRenderer::GenerateScreenRayBuffers(wiRenderer::GetCamera(), cmd);
+			wiRenderer::RayBuffers* rayBuffers = wiRenderer::GenerateScreenRayBuffers(wiRenderer::GetRenderCamera(), cmd);
 			wiRenderer::RayTraceScene(rayBuffers, &traceResult, sam, cmd);
 
 
@@ -181,8 +193,6 @@ void RenderPath3D_PathTracing::Render() const
 		}
 	});
 
-	RenderPath2D::Render();
-
 	wiJobSystem::Wait(ctx);
 }
 
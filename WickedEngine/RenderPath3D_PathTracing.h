@@ -7,6 +7,7 @@ class RenderPath3D_PathTracing :
 {
 private:
 	int sam = -1;
+	bool resetAccumulation = false;
 
 protected:
 	wiGraphics::Texture traceResult;
@@ -19,6 +20,7 @@ public:
 	const wiGraphics::Texture* GetDepthStencil() const override { return nullptr; };
 
 	void Update(float dt) override;
+	void PreRender() override;
 	void Render() const override;
 	void Compose(wiGraphics::CommandList cmd) const override;
 };
@@ -52,7 +52,7 @@ void RenderPath3D_TiledDeferred::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 
 		{
 			auto range = wiProfiler::BeginRangeGPU("Opaque Scene", cmd);
@@ -70,7 +70,7 @@ void RenderPath3D_TiledDeferred::Render() const
 			device->BindViewports(1, &vp, cmd);
 
 			device->BindResource(PS, getReflectionsEnabled() ? &rtReflection : wiTextureHelper::getTransparent(), TEXSLOT_RENDERPATH_REFLECTION, cmd);
-			wiRenderer::DrawScene(wiRenderer::GetCamera(), getTessellationEnabled(), cmd, RENDERPASS_DEFERRED, true, true);
+			wiRenderer::DrawScene(wiRenderer::GetRenderCamera(), getTessellationEnabled(), cmd, RENDERPASS_DEFERRED, true, true);
 
 			device->RenderPassEnd(cmd);
 
@@ -104,7 +104,7 @@ void RenderPath3D_TiledDeferred::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 		wiRenderer::BindCommonResources(cmd);
 
 		RenderDecals(cmd);
@@ -155,7 +155,7 @@ void RenderPath3D_TiledDeferred::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 		wiRenderer::BindCommonResources(cmd);
 
 		RenderSSS(cmd);
@@ -178,7 +178,5 @@ void RenderPath3D_TiledDeferred::Render() const
 
 	});
 
-	RenderPath2D::Render();
-
 	wiJobSystem::Wait(ctx);
 }
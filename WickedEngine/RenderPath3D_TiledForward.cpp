@@ -25,7 +25,7 @@ void RenderPath3D_TiledForward::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 
 		// depth prepass
 		{
@@ -43,7 +43,7 @@ void RenderPath3D_TiledForward::Render() const
 			vp.Height = (float)depthBuffer.GetDesc().Height;
 			device->BindViewports(1, &vp, cmd);
 
-			wiRenderer::DrawScene(wiRenderer::GetCamera(), getTessellationEnabled(), cmd, RENDERPASS_DEPTHONLY, true, true);
+			wiRenderer::DrawScene(wiRenderer::GetRenderCamera(), getTessellationEnabled(), cmd, RENDERPASS_DEPTHONLY, true, true);
 
 			device->RenderPassEnd(cmd);
 
@@ -119,7 +119,7 @@ void RenderPath3D_TiledForward::Render() const
 			device->BindResource(PS, getReflectionsEnabled() ? &rtReflection : wiTextureHelper::getTransparent(), TEXSLOT_RENDERPATH_REFLECTION, cmd);
 			device->BindResource(PS, getAOEnabled() ? &rtAO : wiTextureHelper::getWhite(), TEXSLOT_RENDERPATH_AO, cmd);
 			device->BindResource(PS, getSSREnabled() ? &rtSSR : wiTextureHelper::getTransparent(), TEXSLOT_RENDERPATH_SSR, cmd);
-			wiRenderer::DrawScene(wiRenderer::GetCamera(), getTessellationEnabled(), cmd, RENDERPASS_TILEDFORWARD, true, true);
+			wiRenderer::DrawScene(wiRenderer::GetRenderCamera(), getTessellationEnabled(), cmd, RENDERPASS_TILEDFORWARD, true, true);
 			wiRenderer::DrawSky(cmd);
 
 			RenderOutline(cmd);
@@ -134,7 +134,7 @@ void RenderPath3D_TiledForward::Render() const
 	wiJobSystem::Execute(ctx, [this, cmd](wiJobArgs args) {
 
 		GraphicsDevice* device = wiRenderer::GetDevice();
-		wiRenderer::UpdateCameraCB(wiRenderer::GetCamera(), cmd);
+		wiRenderer::UpdateCameraCB(wiRenderer::GetRenderCamera(), cmd);
 		wiRenderer::BindCommonResources(cmd);
 
 		if (getMSAASampleCount() > 1)
@@ -164,7 +164,5 @@ void RenderPath3D_TiledForward::Render() const
 		RenderPostprocessChain(*GetSceneRT_Read(0), *GetSceneRT_Read(1), cmd);
 	});
 
-	RenderPath2D::Render();
-
 	wiJobSystem::Wait(ctx);
 }
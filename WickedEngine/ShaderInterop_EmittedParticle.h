@@ -93,6 +93,10 @@ static const uint ARGUMENTBUFFER_OFFSET_DRAWPARTICLES = ARGUMENTBUFFER_OFFSET_DI
 #define SPH_USE_ACCELERATION_GRID
 static const uint SPH_PARTITION_BUCKET_COUNT = 128 * 128 * 64;
 
+// Debug collision box of the SPH simulation, centered on the origin in the XZ plane (shared by the GPU and CPU simulation)
+static const float SPH_BOX_COLLISION_EXTENT_X = 40;
+static const float SPH_BOX_COLLISION_EXTENT_Z = 22;
+
 inline uint SPH_GridHash(int3 cellIndex)
 {
 	const uint p1 = 73856093;   // some large primes 
@@ -6,7 +6,14 @@
 CBUFFER(FontCB, CBSLOT_FONT)
 {
 	float4x4	g_xFont_Transform;
-	float4		g_xFont_Color;
+};
+
+CBUFFER(FontUploadCB, CBSLOT_FONT)
+{
+	uint2		g_xFontUpload_Dest;		// top left corner of the region in the atlas page
+	uint2		g_xFontUpload_Size;		// size of the region in texels
+	uint		g_xFontUpload_Offset;	// byte offset of the region in the upload buffer
+	uint3		g_xFontUpload_padding;
 };
 
 
@@ -0,0 +1,19 @@
+#ifndef WI_SHADERINTEROP_GUI_H
+#define WI_SHADERINTEROP_GUI_H
+
+#include "ShaderInterop.h"
+
+// Flags of a GUI batch vertex, they select how the pixel shader shades the quad:
+static const uint GUI_VERTEX_TEXTURED = 1 << 0;			// color is multiplied by the image texture
+static const uint GUI_VERTEX_FONT = 1 << 1;				// color is multiplied by the font atlas (premultiplied)
+static const uint GUI_VERTEX_BACKGROUNDBLUR = 1 << 2;	// transparent areas show the blurred background instead of blending (opaque)
+static const uint GUI_VERTEX_OPAQUE = 1 << 3;			// alpha is ignored
+static const uint GUI_VERTEX_PREMULTIPLIED = 1 << 4;	// color is already premultiplied with alpha
+
+CBUFFER(GUICB, CBSLOT_IMAGE)
+{
+	float4x4	g_xGUI_Transform;
+};
+
+
+#endif // WI_SHADERINTEROP_GUI_H
@@ -8,6 +8,7 @@ static const uint SHADERMATERIAL_OPTION_BIT_SPECULARGLOSSINESS_WORKFLOW = 1 << 1
 static const uint SHADERMATERIAL_OPTION_BIT_OCCLUSION_PRIMARY = 1 << 2;
 static const uint SHADERMATERIAL_OPTION_BIT_OCCLUSION_SECONDARY = 1 << 3;
 static const uint SHADERMATERIAL_OPTION_BIT_USE_WIND = 1 << 4;
+static const uint SHADERMATERIAL_OPTION_BIT_NORMALMAP_TWOCHANNEL = 1 << 5;
 
 struct ShaderMaterial
 {
@@ -45,6 +46,7 @@ struct ShaderMaterial
 	inline bool IsOcclusionEnabled_Primary() { return options & SHADERMATERIAL_OPTION_BIT_OCCLUSION_PRIMARY; }
 	inline bool IsOcclusionEnabled_Secondary() { return options & SHADERMATERIAL_OPTION_BIT_OCCLUSION_SECONDARY; }
 	inline bool IsUsingWind() { return options & SHADERMATERIAL_OPTION_BIT_USE_WIND; }
+	inline bool IsNormalMapTwoChannel() { return options & SHADERMATERIAL_OPTION_BIT_NORMALMAP_TWOCHANNEL; }
 };
 
 struct ShaderEntity
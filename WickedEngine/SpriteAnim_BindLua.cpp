@@ -214,7 +214,7 @@ int SpriteAnim_BindLua::GetRepeatable(lua_State *L)
 }
 int SpriteAnim_BindLua::GetVelocity(lua_State *L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&anim.vel)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat3(&anim.vel));
 	return 1;
 }
 int SpriteAnim_BindLua::GetScaleX(lua_State *L)
@@ -229,12 +229,12 @@ int SpriteAnim_BindLua::GetScaleY(lua_State *L)
 }
 int SpriteAnim_BindLua::GetMovingTexAnim(lua_State *L)
 {
-	Luna<MovingTexAnim_BindLua>::push(L, new MovingTexAnim_BindLua(anim.movingTexAnim));
+	Luna<MovingTexAnim_BindLua>::create(L, anim.movingTexAnim);
 	return 1;
 }
 int SpriteAnim_BindLua::GetDrawRecAnim(lua_State *L)
 {
-	Luna<DrawRectAnim_BindLua>::push(L, new DrawRectAnim_BindLua(anim.drawRectAnim));
+	Luna<DrawRectAnim_BindLua>::create(L, anim.drawRectAnim);
 	return 1;
 }
 
@@ -143,7 +143,7 @@ int Vector_BindLua::Transform(lua_State* L)
 		Matrix_BindLua* mat = Luna<Matrix_BindLua>::lightcheck(L, 2);
 		if (vec && mat)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVector4Transform(vec->vector, mat->matrix)));
+			Luna<Vector_BindLua>::create(L, XMVector4Transform(vec->vector, mat->matrix));
 			return 1;
 		}
 		else
@@ -162,7 +162,7 @@ int Vector_BindLua::TransformNormal(lua_State* L)
 		Matrix_BindLua* mat = Luna<Matrix_BindLua>::lightcheck(L, 2);
 		if (vec && mat)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVector3TransformNormal(vec->vector, mat->matrix)));
+			Luna<Vector_BindLua>::create(L, XMVector3TransformNormal(vec->vector, mat->matrix));
 			return 1;
 		}
 		else
@@ -181,7 +181,7 @@ int Vector_BindLua::TransformCoord(lua_State* L)
 		Matrix_BindLua* mat = Luna<Matrix_BindLua>::lightcheck(L, 2);
 		if (vec && mat)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVector3TransformCoord(vec->vector, mat->matrix)));
+			Luna<Vector_BindLua>::create(L, XMVector3TransformCoord(vec->vector, mat->matrix));
 			return 1;
 		}
 		else
@@ -198,12 +198,12 @@ int Vector_BindLua::Length(lua_State* L)
 }
 int Vector_BindLua::Normalize(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVector3Normalize(vector)));
+	Luna<Vector_BindLua>::create(L, XMVector3Normalize(vector));
 	return 1;
 }
 int Vector_BindLua::QuaternionNormalize(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMQuaternionNormalize(vector)));
+	Luna<Vector_BindLua>::create(L, XMQuaternionNormalize(vector));
 	return 1;
 }
 int Vector_BindLua::Clamp(lua_State* L)
@@ -213,7 +213,7 @@ int Vector_BindLua::Clamp(lua_State* L)
 	{
 		float a = wiLua::SGetFloat(L, 1);
 		float b = wiLua::SGetFloat(L, 2);
-		Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVectorClamp(vector, XMVectorSet(a, a, a, a), XMVectorSet(b, b, b, b))));
+		Luna<Vector_BindLua>::create(L, XMVectorClamp(vector, XMVectorSet(a, a, a, a), XMVectorSet(b, b, b, b)));
 		return 1;
 	}
 	else
@@ -222,7 +222,7 @@ int Vector_BindLua::Clamp(lua_State* L)
 }
 int Vector_BindLua::Saturate(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVectorSaturate(vector)));
+	Luna<Vector_BindLua>::create(L, XMVectorSaturate(vector));
 	return 1;
 }
 
@@ -253,7 +253,7 @@ int Vector_BindLua::Cross(lua_State* L)
 		Vector_BindLua* v2 = Luna<Vector_BindLua>::lightcheck(L, 2);
 		if (v1 && v2)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVector3Cross(v1->vector, v2->vector)));
+			Luna<Vector_BindLua>::create(L, XMVector3Cross(v1->vector, v2->vector));
 			return 1;
 		}
 	}
@@ -269,17 +269,17 @@ int Vector_BindLua::Multiply(lua_State* L)
 		Vector_BindLua* v2 = Luna<Vector_BindLua>::lightcheck(L, 2);
 		if (v1 && v2)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVectorMultiply(v1->vector, v2->vector)));
+			Luna<Vector_BindLua>::create(L, XMVectorMultiply(v1->vector, v2->vector));
 			return 1;
 		}
 		else if (v1)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(v1->vector * wiLua::SGetFloat(L, 2)));
+			Luna<Vector_BindLua>::create(L, v1->vector * wiLua::SGetFloat(L, 2));
 			return 1;
 		}
 		else if (v2)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(wiLua::SGetFloat(L, 1) * v2->vector));
+			Luna<Vector_BindLua>::create(L, wiLua::SGetFloat(L, 1) * v2->vector);
 			return 1;
 		}
 	}
@@ -295,7 +295,7 @@ int Vector_BindLua::Add(lua_State* L)
 		Vector_BindLua* v2 = Luna<Vector_BindLua>::lightcheck(L, 2);
 		if (v1 && v2)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVectorAdd(v1->vector, v2->vector)));
+			Luna<Vector_BindLua>::create(L, XMVectorAdd(v1->vector, v2->vector));
 			return 1;
 		}
 	}
@@ -311,7 +311,7 @@ int Vector_BindLua::Subtract(lua_State* L)
 		Vector_BindLua* v2 = Luna<Vector_BindLua>::lightcheck(L, 2);
 		if (v1 && v2)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVectorSubtract(v1->vector, v2->vector)));
+			Luna<Vector_BindLua>::create(L, XMVectorSubtract(v1->vector, v2->vector));
 			return 1;
 		}
 	}
@@ -328,7 +328,7 @@ int Vector_BindLua::Lerp(lua_State* L)
 		float t = wiLua::SGetFloat(L, 3);
 		if (v1 && v2)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVectorLerp(v1->vector, v2->vector, t)));
+			Luna<Vector_BindLua>::create(L, XMVectorLerp(v1->vector, v2->vector, t));
 			return 1;
 		}
 	}
@@ -346,7 +346,7 @@ int Vector_BindLua::QuaternionMultiply(lua_State* L)
 		Vector_BindLua* v2 = Luna<Vector_BindLua>::lightcheck(L, 2);
 		if (v1 && v2)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMQuaternionMultiply(v1->vector, v2->vector)));
+			Luna<Vector_BindLua>::create(L, XMQuaternionMultiply(v1->vector, v2->vector));
 			return 1;
 		}
 	}
@@ -361,7 +361,7 @@ int Vector_BindLua::QuaternionFromRollPitchYaw(lua_State* L)
 		Vector_BindLua* v1 = Luna<Vector_BindLua>::lightcheck(L, 1);
 		if (v1)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMQuaternionRotationRollPitchYawFromVector(v1->vector)));
+			Luna<Vector_BindLua>::create(L, XMQuaternionRotationRollPitchYawFromVector(v1->vector));
 			return 1;
 		}
 	}
@@ -378,7 +378,7 @@ int Vector_BindLua::Slerp(lua_State* L)
 		float t = wiLua::SGetFloat(L, 3);
 		if (v1 && v2)
 		{
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMQuaternionSlerp(v1->vector, v2->vector, t)));
+			Luna<Vector_BindLua>::create(L, XMQuaternionSlerp(v1->vector, v2->vector, t));
 			return 1;
 		}
 	}
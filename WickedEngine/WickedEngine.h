@@ -35,6 +35,7 @@
 #include "wiRenderer.h"
 #include "wiMath.h"
 #include "wiAudio.h"
+#include "wiAudioMixer.h"
 #include "wiResourceManager.h"
 #include "wiTimer.h"
 #include "wiHelper.h"
@@ -42,6 +43,7 @@
 #include "wiRawInput.h"
 #include "wiXInput.h"
 #include "wiTextureHelper.h"
+#include "wiTextureCooker.h"
 #include "wiRandom.h"
 #include "wiColor.h"
 #include "wiPhysicsEngine.h"
@@ -50,18 +52,25 @@
 #include "wiLua.h"
 #include "wiLuna.h"
 #include "wiGraphicsDevice.h"
+#include "wiGraphicsDevice_Null.h"
+#include "wiShaderCache.h"
 #include "wiGUI.h"
+#include "wiGUIBatch.h"
 #include "wiWidget.h"
 #include "wiArchive.h"
 #include "wiSpinLock.h"
 #include "wiRectPacker.h"
 #include "wiProfiler.h"
 #include "wiOcean.h"
+#include "wiOceanSimulation.h"
+#include "wiRenderGraph.h"
 #include "wiStartupArguments.h"
 #include "wiGPUBVH.h"
 #include "wiGPUSortLib.h"
 #include "wiJobSystem.h"
 #include "wiNetwork.h"
+#include "wiReplication.h"
+#include "wiSceneStreaming.h"
 
 #ifdef _WIN32
 #ifdef PLATFORM_UWP
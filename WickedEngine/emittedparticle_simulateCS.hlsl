@@ -151,7 +151,7 @@ void main(uint3 DTid : SV_DispatchThreadID, uint Gid : SV_GroupIndex)
 
 #ifdef SPH_BOX_COLLISION
 				// box collision:
-				float3 extent = float3(40, 0, 22);
+				float3 extent = float3(SPH_BOX_COLLISION_EXTENT_X, 0, SPH_BOX_COLLISION_EXTENT_Z);
 				if (particle.position.x + particleSize > extent.x)
 				{
 					particle.position.x = extent.x - particleSize;
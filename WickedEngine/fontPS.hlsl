@@ -8,9 +8,10 @@ struct VertextoPixel
 {
 	float4 pos				: SV_POSITION;
 	float2 tex				: TEXCOORD0;
+	float4 col				: COLOR;
 };
 
 float4 main(VertextoPixel PSIn) : SV_TARGET
 {
-	return texture_font.SampleLevel(sampler_font, PSIn.tex, 0).rrrr * g_xFont_Color;
+	return texture_font.SampleLevel(sampler_font, PSIn.tex, 0).rrrr * PSIn.col;
 }
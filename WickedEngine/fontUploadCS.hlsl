@@ -0,0 +1,21 @@
+#include "globals.hlsli"
+#include "ShaderInterop_Font.h"
+
+RAWBUFFER(uploadBuffer, TEXSLOT_ONDEMAND0);
+
+RWTEXTURE2D(output, unorm float, 0);
+
+[numthreads(8, 8, 1)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+	if (DTid.x >= g_xFontUpload_Size.x || DTid.y >= g_xFontUpload_Size.y)
+	{
+		return;
+	}
+
+	// The region is tightly packed with one byte per texel:
+	const uint address = g_xFontUpload_Offset + DTid.y * g_xFontUpload_Size.x + DTid.x;
+	const uint value = (uploadBuffer.Load(address & ~3u) >> ((address & 3u) * 8u)) & 0xFF;
+
+	output[g_xFontUpload_Dest + DTid.xy] = value / 255.0f;
+}
@@ -5,9 +5,10 @@ struct VertextoPixel
 {
 	float4 pos				: SV_POSITION;
 	float2 tex				: TEXCOORD0;
+	float4 col				: COLOR;
 };
 
-VertextoPixel main(float2 inPos : POSITION, float2 inTex : TEXCOORD0)
+VertextoPixel main(float2 inPos : POSITION, float2 inTex : TEXCOORD0, float4 inCol : COLOR)
 {
 	VertextoPixel Out;
 
@@ -15,5 +16,7 @@ VertextoPixel main(float2 inPos : POSITION, float2 inTex : TEXCOORD0)
 	
 	Out.tex = inTex;
 
+	Out.col = inCol;
+
 	return Out;
 }
@@ -0,0 +1,15 @@
+#ifndef WI_GUI_HF
+#define WI_GUI_HF
+#include "globals.hlsli"
+#include "ShaderInterop_GUI.h"
+
+struct VertextoPixel
+{
+	float4 pos						: SV_POSITION;
+	float2 uv						: TEXCOORD0;
+	float4 uv_screen				: TEXCOORD1;
+	float4 col						: COLOR;
+	nointerpolation uint flags		: FLAGS;
+};
+
+#endif // WI_GUI_HF
@@ -0,0 +1,44 @@
+#include "guiHF.hlsli"
+
+TEXTURE2D(texture_base, float4, TEXSLOT_IMAGE_BASE);
+TEXTURE2D(texture_background, float4, TEXSLOT_IMAGE_BACKGROUND);
+TEXTURE2D(texture_font, float, TEXSLOT_FONTATLAS);
+
+SAMPLERSTATE(sampler_image, SSLOT_ONDEMAND0);
+SAMPLERSTATE(sampler_gui, SSLOT_ONDEMAND1);
+
+float4 main(VertextoPixel input) : SV_TARGET
+{
+	float4 color = input.col;
+
+	[branch]
+	if (input.flags & GUI_VERTEX_FONT)
+	{
+		return texture_font.SampleLevel(sampler_gui, input.uv, 0).rrrr * color;
+	}
+
+	[branch]
+	if (input.flags & GUI_VERTEX_TEXTURED)
+	{
+		color *= texture_base.Sample(sampler_image, input.uv);
+	}
+
+	[branch]
+	if (input.flags & GUI_VERTEX_BACKGROUNDBLUR)
+	{
+		float3 background = texture_background.SampleLevel(sampler_gui, (input.uv_screen.xy * float2(0.5f, -0.5f) + 0.5f) / input.uv_screen.w, 0).rgb;
+		return float4(lerp(background, color.rgb, color.a), 1);
+	}
+
+	if (input.flags & GUI_VERTEX_OPAQUE)
+	{
+		return float4(color.rgb, 1);
+	}
+
+	if (input.flags & GUI_VERTEX_PREMULTIPLIED)
+	{
+		return color;
+	}
+
+	return float4(color.rgb * color.a, color.a);
+}
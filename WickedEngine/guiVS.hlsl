@@ -0,0 +1,14 @@
+#include "guiHF.hlsli"
+
+VertextoPixel main(float2 inPos : POSITION, float2 inUV : TEXCOORD0, float4 inCol : COLOR, uint inFlags : FLAGS)
+{
+	VertextoPixel Out;
+
+	Out.pos = mul(g_xGUI_Transform, float4(inPos, 0, 1));
+	Out.uv = inUV;
+	Out.uv_screen = Out.pos;
+	Out.col = inCol;
+	Out.flags = inFlags;
+
+	return Out;
+}
@@ -15,6 +15,7 @@ struct VertextoPixel
 	float2 uv0 : TEXCOORD0;
 	float2 uv1 : TEXCOORD1;
 	float4 uv_screen : TEXCOORD2;
+	float4 color : COLOR;
 };
 
 #endif // WI_IMAGE_HF
@@ -2,7 +2,7 @@
 
 float4 main(VertextoPixel input) : SV_TARGET
 {
-	float4 color = texture_base.Sample(Sampler, input.uv0) * xColor;
+	float4 color = texture_base.Sample(Sampler, input.uv0) * input.color;
 
 	return color;
 }
\ No newline at end of file
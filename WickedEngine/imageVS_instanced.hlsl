@@ -0,0 +1,36 @@
+#include "globals.hlsli"
+#include "imageHF.hlsli"
+
+struct ImageInstance
+{
+	float4 corner0 : CORNER0;
+	float4 corner1 : CORNER1;
+	float4 corner2 : CORNER2;
+	float4 corner3 : CORNER3;
+	float4 texMulAdd : TEXMULADD0;
+	float4 texMulAdd2 : TEXMULADD1;
+	float4 color : COLOR;
+};
+
+VertextoPixel main(uint vI : SV_VERTEXID, ImageInstance instance)
+{
+	VertextoPixel Out;
+
+	// Same trianglestrip as imageVS, but the image parameters come from the instance buffer instead of the constant buffer:
+	//	1--2
+	//	  /
+	//	 /
+	//	3--4
+
+	const float4 corners[4] = { instance.corner0, instance.corner1, instance.corner2, instance.corner3 };
+	Out.pos = corners[vI];
+
+	Out.uv0 = float2(vI % 2, vI % 4 / 2);
+	Out.uv1 = Out.uv0;
+	Out.uv0 = Out.uv0 * instance.texMulAdd.xy + instance.texMulAdd.zw;
+	Out.uv1 = Out.uv1 * instance.texMulAdd2.xy + instance.texMulAdd2.zw;
+	Out.uv_screen = Out.pos;
+	Out.color = instance.color;
+
+	return Out;
+}
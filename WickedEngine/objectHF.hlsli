@@ -147,6 +147,10 @@ inline void NormalMapping(in float2 UV, in float3 V, inout float3 N, in float3x3
 {
 	float3 normalMap = texture_normalmap.Sample(sampler_objectshader, UV).rgb;
 	bumpColor = normalMap.rgb * 2 - 1;
+	if (g_xMaterial.IsNormalMapTwoChannel())
+	{
+		bumpColor.z = sqrt(saturate(1 - dot(bumpColor.xy, bumpColor.xy))); // two channel (BC5) normal maps don't store z
+	}
 	bumpColor.g *= g_xMaterial.normalMapFlip;
 	N = normalize(lerp(N, mul(bumpColor, TBN), g_xMaterial.normalMapStrength));
 	bumpColor *= g_xMaterial.normalMapStrength;
@@ -879,6 +883,10 @@ GBUFFEROutputType_Thin main(PIXELINPUT input)
 			sam_z.xyz = texture_normalmap.Sample(sampler_objectshader, uv_z).rgb;
 			bumpColor = (sam_x.xyz * triplanar.x + sam_y.xyz * triplanar.y + sam_z.xyz * triplanar.z);
 			bumpColor = bumpColor.rgb * 2 - 1;
+			if (g_xMaterial.IsNormalMapTwoChannel())
+			{
+				bumpColor.z = sqrt(saturate(1 - dot(bumpColor.xy, bumpColor.xy)));
+			}
 			bumpColor.g *= g_xMaterial.normalMapFlip;
 			triplanar_normal += normalize(lerp(surface.N, mul(bumpColor, TBN), g_xMaterial.normalMapStrength)) * blend_weights.x;
 		}
@@ -951,6 +959,10 @@ GBUFFEROutputType_Thin main(PIXELINPUT input)
 			sam_z.xyz = texture_blend1_normalmap.Sample(sampler_objectshader, uv_z).rgb;
 			bumpColor = (sam_x.xyz * triplanar.x + sam_y.xyz * triplanar.y + sam_z.xyz * triplanar.z);
 			bumpColor = bumpColor.rgb * 2 - 1;
+			if (g_xMaterial_blend1.IsNormalMapTwoChannel())
+			{
+				bumpColor.z = sqrt(saturate(1 - dot(bumpColor.xy, bumpColor.xy)));
+			}
 			bumpColor.g *= g_xMaterial_blend1.normalMapFlip;
 			triplanar_normal += normalize(lerp(surface.N, mul(bumpColor, TBN), g_xMaterial_blend1.normalMapStrength)) * blend_weights.y;
 		}
@@ -1023,6 +1035,10 @@ GBUFFEROutputType_Thin main(PIXELINPUT input)
 			sam_z.xyz = texture_blend2_normalmap.Sample(sampler_objectshader, uv_z).rgb;
 			bumpColor = (sam_x.xyz * triplanar.x + sam_y.xyz * triplanar.y + sam_z.xyz * triplanar.z);
 			bumpColor = bumpColor.rgb * 2 - 1;
+			if (g_xMaterial_blend2.IsNormalMapTwoChannel())
+			{
+				bumpColor.z = sqrt(saturate(1 - dot(bumpColor.xy, bumpColor.xy)));
+			}
 			bumpColor.g *= g_xMaterial_blend2.normalMapFlip;
 			triplanar_normal += normalize(lerp(surface.N, mul(bumpColor, TBN), g_xMaterial_blend2.normalMapStrength)) * blend_weights.z;
 		}
@@ -1095,6 +1111,10 @@ GBUFFEROutputType_Thin main(PIXELINPUT input)
 			sam_z.xyz = texture_blend3_normalmap.Sample(sampler_objectshader, uv_z).rgb;
 			bumpColor = (sam_x.xyz * triplanar.x + sam_y.xyz * triplanar.y + sam_z.xyz * triplanar.z);
 			bumpColor = bumpColor.rgb * 2 - 1;
+			if (g_xMaterial_blend3.IsNormalMapTwoChannel())
+			{
+				bumpColor.z = sqrt(saturate(1 - dot(bumpColor.xy, bumpColor.xy)));
+			}
 			bumpColor.g *= g_xMaterial_blend3.normalMapFlip;
 			triplanar_normal += normalize(lerp(surface.N, mul(bumpColor, TBN), g_xMaterial_blend3.normalMapStrength)) * blend_weights.w;
 		}
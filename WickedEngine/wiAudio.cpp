@@ -499,27 +499,96 @@ namespace wiAudio
 
 #else
 
+#include "wiAudioMixer.h"
+
 namespace wiAudio
 {
-	void Initialize() {}
+	std::shared_ptr<AudioDevice> device;
+	std::shared_ptr<SoftwareMixer> mixer;
+
+	void SetSoftwareMixerDevice(std::shared_ptr<AudioDevice> value)
+	{
+		device = value;
+	}
+
+	void Initialize()
+	{
+		if (device == nullptr)
+		{
+			device = std::make_shared<AudioDevice_Null>(48000, true);
+		}
+		mixer = std::make_shared<SoftwareMixer>(device);
+		mixer->Start();
+
+		wiBackLog::post("wiAudio Initialized (software mixer)");
+	}
 
-	bool CreateSound(const std::string& filename, Sound* sound) {}
-	bool CreateSound(const std::vector<uint8_t>& data, Sound* sound) {}
-	bool CreateSoundInstance(const Sound* sound, SoundInstance* instance) {}
+	bool CreateSound(const std::string& filename, Sound* sound)
+	{
+		std::vector<uint8_t> filedata;
+		bool success = wiHelper::FileRead(filename, filedata);
+		if (!success)
+		{
+			return false;
+		}
+		return CreateSound(filedata, sound);
+	}
+	bool CreateSound(const std::vector<uint8_t>& data, Sound* sound)
+	{
+		return SoftwareMixer::CreateSound(data, sound);
+	}
+	bool CreateSoundInstance(const Sound* sound, SoundInstance* instance)
+	{
+		return mixer != nullptr && mixer->CreateSoundInstance(sound, instance);
+	}
 
-	void Play(SoundInstance* instance) {}
-	void Pause(SoundInstance* instance) {}
-	void Stop(SoundInstance* instance) {}
-	void SetVolume(float volume, SoundInstance* instance) {}
-	float GetVolume(const SoundInstance* instance) { return 0; }
-	void ExitLoop(SoundInstance* instance) {}
+	void Play(SoundInstance* instance)
+	{
+		if (mixer != nullptr)
+			mixer->Play(instance);
+	}
+	void Pause(SoundInstance* instance)
+	{
+		if (mixer != nullptr)
+			mixer->Pause(instance);
+	}
+	void Stop(SoundInstance* instance)
+	{
+		if (mixer != nullptr)
+			mixer->Stop(instance);
+	}
+	void SetVolume(float volume, SoundInstance* instance)
+	{
+		if (mixer != nullptr)
+			mixer->SetVolume(volume, instance);
+	}
+	float GetVolume(const SoundInstance* instance)
+	{
+		return mixer != nullptr ? mixer->GetVolume(instance) : 0;
+	}
+	void ExitLoop(SoundInstance* instance)
+	{
+		if (mixer != nullptr)
+			mixer->ExitLoop(instance);
+	}
 
-	void SetSubmixVolume(SUBMIX_TYPE type, float volume) {}
-	float GetSubmixVolume(SUBMIX_TYPE type) { return 0; }
+	void SetSubmixVolume(SUBMIX_TYPE type, float volume)
+	{
+		if (mixer != nullptr)
+			mixer->SetSubmixVolume(type, volume);
+	}
+	float GetSubmixVolume(SUBMIX_TYPE type)
+	{
+		return mixer != nullptr ? mixer->GetSubmixVolume(type) : 0;
+	}
 
-	void Update3D(SoundInstance* instance, const SoundInstance3D& instance3D) {}
+	void Update3D(SoundInstance* instance, const SoundInstance3D& instance3D)
+	{
+		if (mixer != nullptr)
+			mixer->Update3D(instance, instance3D);
+	}
 
-	void SetReverb(REVERB_PRESET preset) {}
+	void SetReverb(REVERB_PRESET preset) {} // reverb is not simulated by the software mixer
 }
 
 #endif // _WIN32
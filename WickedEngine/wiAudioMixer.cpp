@@ -0,0 +1,864 @@
+#include "wiAudioMixer.h"
+#include "wiBackLog.h"
+#include "wiHelper.h"
+#include "wiMath.h"
+#include "wiSpinLock.h"
+
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+
+namespace wiAudio
+{
+	static const uint32_t MIX_BLOCK = 256; // frames that are mixed with the same parameters, must be a multiple of 4
+	static const uint32_t SOUND_PADDING = 4; // silent frames after the sound data, so interpolation and SIMD loads can read past the end
+	static const uint32_t COMMAND_QUEUE_SIZE = 4096; // must be a power of two
+	static const float SPEED_OF_SOUND = 343.5f;
+
+	AudioDevice_Null::AudioDevice_Null(uint32_t sampleRate, bool realtime) : sampleRate(sampleRate), realtime(realtime)
+	{
+	}
+	void AudioDevice_Null::Submit(const float* samples, uint32_t frames)
+	{
+		if (frameCount == 0)
+		{
+			start = std::chrono::high_resolution_clock::now();
+		}
+		frameCount += frames;
+
+		for (uint32_t i = 0; i < frames * 2; ++i)
+		{
+			peak = std::max(peak, std::abs(samples[i]));
+		}
+
+		if (realtime)
+		{
+			std::this_thread::sleep_until(start + std::chrono::microseconds(frameCount * 1000000ull / sampleRate));
+		}
+	}
+
+	AudioDevice_File::AudioDevice_File(const std::string& filename, uint32_t sampleRate) : filename(filename), sampleRate(sampleRate)
+	{
+	}
+	AudioDevice_File::~AudioDevice_File()
+	{
+		Flush();
+	}
+	void AudioDevice_File::Submit(const float* data, uint32_t frames)
+	{
+		const size_t offset = samples.size();
+		samples.resize(offset + frames * 2);
+		for (uint32_t i = 0; i < frames * 2; ++i)
+		{
+			samples[offset + i] = (int16_t)(wiMath::Clamp(data[i], -1.0f, 1.0f) * 32767.0f);
+		}
+	}
+	bool AudioDevice_File::Flush()
+	{
+		const uint32_t dataSize = uint32_t(samples.size() * sizeof(int16_t));
+		std::vector<uint8_t> filedata(44 + dataSize);
+		uint8_t* dst = filedata.data();
+		auto write = [&](const void* src, size_t size) {
+			memcpy(dst, src, size);
+			dst += size;
+		};
+		auto write32 = [&](uint32_t value) { write(&value, sizeof(value)); };
+		auto write16 = [&](uint16_t value) { write(&value, sizeof(value)); };
+
+		write("RIFF", 4);
+		write32(36 + dataSize);
+		write("WAVE", 4);
+		write("fmt ", 4);
+		write32(16);
+		write16(1); // PCM
+		write16(2); // stereo
+		write32(sampleRate);
+		write32(sampleRate * 2 * sizeof(int16_t));
+		write16(2 * sizeof(int16_t));
+		write16(16);
+		write("data", 4);
+		write32(dataSize);
+		write(samples.data(), dataSize);
+
+		return wiHelper::FileWrite(filename, filedata.data(), filedata.size());
+	}
+
+
+	struct MixerSound
+	{
+		uint32_t sampleRate = 0;
+		uint32_t channelCount = 0;
+		uint32_t frameCount = 0;
+		std::vector<float> samples; // planar, the channels follow each other with the padding
+
+		const float* GetChannel(uint32_t channel) const
+		{
+			return samples.data() + size_t(channel) * size_t(frameCount + SOUND_PADDING);
+		}
+	};
+
+	// Playback state of a sound instance, it is owned by the mixing thread after it was added
+	struct MixerVoice
+	{
+		std::shared_ptr<MixerSound> sound;
+		SUBMIX_TYPE type = SUBMIX_TYPE_SOUNDEFFECT;
+		uint32_t index = 0; // in the voice list of the mixer
+		bool playing = false;
+		bool looping = true;
+		uint64_t position = 0; // 32.32 fixed point source frame
+		uint64_t loopBegin = 0;
+		uint64_t loopEnd = 0;
+		float volume = 1;
+		float frequencyRatio = 1;
+		float matrix[2][2] = {}; // [source channel][output channel]
+		float gains[2][2] = {}; // volume * matrix at the end of the previous block, the next block ramps from these
+
+		void ComputeTargetGains(float targets[2][2]) const
+		{
+			for (int i = 0; i < 2; ++i)
+			{
+				for (int j = 0; j < 2; ++j)
+				{
+					targets[i][j] = volume * matrix[i][j];
+				}
+			}
+		}
+	};
+
+	struct MixerCommand
+	{
+		enum TYPE
+		{
+			ADD,
+			REMOVE,
+			PLAY,
+			PAUSE,
+			STOP,
+			EXITLOOP,
+			VOLUME,
+			MASTER_VOLUME,
+			SUBMIX_VOLUME,
+			SPATIAL,
+		} type;
+		MixerVoice* voice;
+		uint32_t submix;
+		float values[5];
+	};
+
+	// Bounded multiple producer, single consumer queue, every cell has a sequence number that tells which side it belongs to
+	class MixerCommandQueue
+	{
+	public:
+		MixerCommandQueue()
+		{
+			cells.reset(new Cell[COMMAND_QUEUE_SIZE]);
+			for (uint32_t i = 0; i < COMMAND_QUEUE_SIZE; ++i)
+			{
+				cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		// Returns false if the queue is full
+		bool push(const MixerCommand& command)
+		{
+			uint32_t pos = enqueue.load(std::memory_order_relaxed);
+			Cell* cell;
+			while (true)
+			{
+				cell = &cells[pos & (COMMAND_QUEUE_SIZE - 1)];
+				const int32_t diff = int32_t(cell->sequence.load(std::memory_order_acquire) - pos);
+				if (diff == 0)
+				{
+					if (enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = enqueue.load(std::memory_order_relaxed);
+				}
+			}
+			cell->command = command;
+			cell->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Only one thread can pop at a time, returns false if there are no commands
+		bool pop(MixerCommand& command)
+		{
+			Cell& cell = cells[dequeue & (COMMAND_QUEUE_SIZE - 1)];
+			if (cell.sequence.load(std::memory_order_acquire) != dequeue + 1)
+			{
+				return false;
+			}
+			command = cell.command;
+			cell.sequence.store(dequeue + COMMAND_QUEUE_SIZE, std::memory_order_release);
+			dequeue++;
+			return true;
+		}
+
+	private:
+		struct Cell
+		{
+			std::atomic<uint32_t> sequence;
+			MixerCommand command;
+		};
+		std::unique_ptr<Cell[]> cells;
+		std::atomic<uint32_t> enqueue{ 0 };
+		uint32_t dequeue = 0;
+	};
+
+	struct MixerInternal
+	{
+		std::shared_ptr<AudioDevice> device;
+		uint32_t sampleRate = 48000;
+		MixerCommandQueue commands;
+		wiSpinLock consumerLock; // held while the commands are executed and the voices are mixed
+
+		// The values that were set, for the getters:
+		std::atomic<float> masterVolume{ 1 };
+		std::atomic<float> submixVolumes[SUBMIX_TYPE_COUNT];
+
+		std::thread thread;
+		std::atomic<bool> running{ false };
+
+		// Mixing thread state:
+		std::vector<MixerVoice*> voices;
+		float masterGain = 1;
+		float submixGains[SUBMIX_TYPE_COUNT];
+		float outputGains[SUBMIX_TYPE_COUNT]; // submix * master gain of the previous block
+		std::vector<float> submixBuffers; // [submix][channel][MIX_BLOCK + 4]
+		std::vector<float> output; // interleaved stereo
+		std::atomic<uint32_t> playingCount{ 0 };
+
+		MixerInternal(std::shared_ptr<AudioDevice> device) : device(device)
+		{
+			sampleRate = device->GetSampleRate();
+			for (uint32_t i = 0; i < SUBMIX_TYPE_COUNT; ++i)
+			{
+				submixVolumes[i].store(1);
+				submixGains[i] = 1;
+				outputGains[i] = 1;
+			}
+			submixBuffers.resize(SUBMIX_TYPE_COUNT * 2 * (MIX_BLOCK + 4));
+			output.resize((MIX_BLOCK + 4) * 2);
+		}
+		~MixerInternal()
+		{
+			// The instances were destroyed, so their remaining commands are all in the queue:
+			ExecuteCommands();
+			for (auto& voice : voices)
+			{
+				delete voice;
+			}
+		}
+
+		void Push(const MixerCommand& command)
+		{
+			while (!commands.push(command))
+			{
+				// The queue is full, make room unless the mixing thread is doing it right now:
+				if (consumerLock.try_lock())
+				{
+					ExecuteCommands();
+					consumerLock.unlock();
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		void ExecuteCommands()
+		{
+			MixerCommand command;
+			while (commands.pop(command))
+			{
+				MixerVoice* voice = command.voice;
+				switch (command.type)
+				{
+				case MixerCommand::ADD:
+					voice->index = (uint32_t)voices.size();
+					voices.push_back(voice);
+					break;
+				case MixerCommand::REMOVE:
+					voices.back()->index = voice->index;
+					voices[voice->index] = voices.back();
+					voices.pop_back();
+					delete voice;
+					break;
+				case MixerCommand::PLAY:
+					if (!voice->playing)
+					{
+						voice->playing = true;
+						voice->ComputeTargetGains(voice->gains); // only parameter changes are ramped, not the start
+					}
+					break;
+				case MixerCommand::PAUSE:
+					voice->playing = false;
+					break;
+				case MixerCommand::STOP:
+					voice->playing = false;
+					voice->looping = true;
+					voice->position = 0;
+					break;
+				case MixerCommand::EXITLOOP:
+					voice->looping = false;
+					break;
+				case MixerCommand::VOLUME:
+					voice->volume = command.values[0];
+					break;
+				case MixerCommand::MASTER_VOLUME:
+					masterGain = command.values[0];
+					break;
+				case MixerCommand::SUBMIX_VOLUME:
+					submixGains[command.submix] = command.values[0];
+					break;
+				case MixerCommand::SPATIAL:
+					voice->matrix[0][0] = command.values[0];
+					voice->matrix[0][1] = command.values[1];
+					voice->matrix[1][0] = command.values[2];
+					voice->matrix[1][1] = command.values[3];
+					voice->frequencyRatio = command.values[4];
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+		// Resamples a continuous part of the sound and adds it to the output channels
+		//	offset is the frame in the block where the part starts, the gains are ramped over the whole block
+		static void MixSegment(
+			const MixerSound& sound,
+			uint64_t position,
+			uint64_t step,
+			uint32_t count,
+			uint32_t offset,
+			uint32_t blockSize,
+			const float gains[2][2],
+			const float targets[2][2],
+			float* left,
+			float* right
+		)
+		{
+			const bool stereo = sound.channelCount > 1;
+			const float* src0 = sound.GetChannel(0);
+			const float* src1 = sound.GetChannel(stereo ? 1 : 0);
+			const uint32_t base = uint32_t(position >> 32);
+			const uint32_t lastIndex = sound.frameCount + SOUND_PADDING - 2;
+			const bool aligned = step == (1ull << 32) && (position & 0xFFFFFFFF) == 0;
+
+			const XMVECTOR iota = XMVectorSet(0, 1, 2, 3);
+			const XMVECTOR fraction = XMVectorReplicate(float(position & 0xFFFFFFFF) * (1.0f / 4294967296.0f));
+			const XMVECTOR stepSize = XMVectorReplicate(float(double(step) * (1.0 / 4294967296.0)));
+			const XMVECTOR countV = XMVectorReplicate(float(count));
+			const XMVECTOR rampScale = XMVectorReplicate(1.0f / blockSize);
+			const XMVECTOR g00 = XMVectorReplicate(gains[0][0]);
+			const XMVECTOR g01 = XMVectorReplicate(gains[0][1]);
+			const XMVECTOR g10 = XMVectorReplicate(gains[1][0]);
+			const XMVECTOR g11 = XMVectorReplicate(gains[1][1]);
+			const XMVECTOR d00 = XMVectorReplicate(targets[0][0] - gains[0][0]);
+			const XMVECTOR d01 = XMVectorReplicate(targets[0][1] - gains[0][1]);
+			const XMVECTOR d10 = XMVectorReplicate(targets[1][0] - gains[1][0]);
+			const XMVECTOR d11 = XMVectorReplicate(targets[1][1] - gains[1][1]);
+
+			for (uint32_t i = 0; i < count; i += 4)
+			{
+				const XMVECTOR lane = XMVectorAdd(XMVectorReplicate(float(i)), iota);
+
+				XMVECTOR s0, s1;
+				if (aligned)
+				{
+					s0 = XMLoadFloat4((const XMFLOAT4*)(src0 + base + i));
+					s1 = XMLoadFloat4((const XMFLOAT4*)(src1 + base + i));
+				}
+				else
+				{
+					const XMVECTOR pos = XMVectorMultiplyAdd(lane, stepSize, fraction);
+					const XMVECTOR floor = XMVectorFloor(pos);
+					const XMVECTOR t = XMVectorSubtract(pos, floor);
+					uint32_t indices[4];
+					XMStoreInt4(indices, XMConvertVectorFloatToInt(floor, 0));
+					for (int j = 0; j < 4; ++j)
+					{
+						indices[j] = std::min(base + indices[j], lastIndex);
+					}
+
+					const XMVECTOR a0 = XMVectorSet(src0[indices[0]], src0[indices[1]], src0[indices[2]], src0[indices[3]]);
+					const XMVECTOR b0 = XMVectorSet(src0[indices[0] + 1], src0[indices[1] + 1], src0[indices[2] + 1], src0[indices[3] + 1]);
+					s0 = XMVectorLerpV(a0, b0, t);
+					if (stereo)
+					{
+						const XMVECTOR a1 = XMVectorSet(src1[indices[0]], src1[indices[1]], src1[indices[2]], src1[indices[3]]);
+						const XMVECTOR b1 = XMVectorSet(src1[indices[0] + 1], src1[indices[1] + 1], src1[indices[2] + 1], src1[indices[3] + 1]);
+						s1 = XMVectorLerpV(a1, b1, t);
+					}
+					else
+					{
+						s1 = s0;
+					}
+				}
+
+				// Lanes after the end of the segment are left for the next one:
+				const XMVECTOR mask = XMVectorLess(lane, countV);
+				const XMVECTOR ramp = XMVectorMultiply(XMVectorAdd(lane, XMVectorReplicate(float(offset + 1))), rampScale);
+
+				XMVECTOR l = XMVectorMultiply(s0, XMVectorMultiplyAdd(d00, ramp, g00));
+				XMVECTOR r = XMVectorMultiply(s0, XMVectorMultiplyAdd(d01, ramp, g01));
+				if (stereo)
+				{
+					l = XMVectorMultiplyAdd(s1, XMVectorMultiplyAdd(d10, ramp, g10), l);
+					r = XMVectorMultiplyAdd(s1, XMVectorMultiplyAdd(d11, ramp, g11), r);
+				}
+				l = XMVectorSelect(XMVectorZero(), l, mask);
+				r = XMVectorSelect(XMVectorZero(), r, mask);
+
+				XMStoreFloat4((XMFLOAT4*)(left + i), XMVectorAdd(XMLoadFloat4((const XMFLOAT4*)(left + i)), l));
+				XMStoreFloat4((XMFLOAT4*)(right + i), XMVectorAdd(XMLoadFloat4((const XMFLOAT4*)(right + i)), r));
+			}
+		}
+
+		void MixVoice(MixerVoice& voice, float* left, float* right, uint32_t frames)
+		{
+			const MixerSound& sound = *voice.sound;
+			const uint64_t step = std::max(1ull, (unsigned long long)(double(sound.sampleRate) / double(sampleRate) * double(voice.frequencyRatio) * 4294967296.0 + 0.5));
+
+			float targets[2][2];
+			voice.ComputeTargetGains(targets);
+
+			uint32_t done = 0;
+			while (done < frames)
+			{
+				const uint64_t end = (voice.looping ? voice.loopEnd : uint64_t(sound.frameCount)) << 32;
+				if (voice.position >= end)
+				{
+					if (voice.looping)
+					{
+						voice.position -= (voice.loopEnd - voice.loopBegin) << 32;
+						continue;
+					}
+					voice.playing = false;
+					voice.position = 0;
+					break;
+				}
+
+				const uint32_t count = (uint32_t)std::min(uint64_t(frames - done), (end - voice.position + step - 1) / step);
+				MixSegment(sound, voice.position, step, count, done, frames, voice.gains, targets, left + done, right + done);
+				voice.position += count * step;
+				done += count;
+			}
+
+			memcpy(voice.gains, targets, sizeof(targets));
+		}
+
+		void MixBlock(uint32_t frames)
+		{
+			const size_t stride = MIX_BLOCK + 4;
+			std::fill(submixBuffers.begin(), submixBuffers.end(), 0.0f);
+
+			uint32_t playing = 0;
+			for (auto& voice : voices)
+			{
+				if (voice->playing)
+				{
+					float* left = submixBuffers.data() + (voice->type * 2 + 0) * stride;
+					float* right = submixBuffers.data() + (voice->type * 2 + 1) * stride;
+					MixVoice(*voice, left, right, frames);
+					playing++;
+				}
+			}
+			playingCount.store(playing);
+
+			// Sum the submixes with their ramped volumes, and interleave the channels:
+			const XMVECTOR iota = XMVectorSet(1, 2, 3, 4);
+			const XMVECTOR rampScale = XMVectorReplicate(1.0f / frames);
+			for (uint32_t i = 0; i < frames; i += 4)
+			{
+				const XMVECTOR ramp = XMVectorMultiply(XMVectorAdd(XMVectorReplicate(float(i)), iota), rampScale);
+				XMVECTOR l = XMVectorZero();
+				XMVECTOR r = XMVectorZero();
+				for (uint32_t submix = 0; submix < SUBMIX_TYPE_COUNT; ++submix)
+				{
+					const float target = submixGains[submix] * masterGain;
+					const XMVECTOR gain = XMVectorMultiplyAdd(XMVectorReplicate(target - outputGains[submix]), ramp, XMVectorReplicate(outputGains[submix]));
+					l = XMVectorMultiplyAdd(XMLoadFloat4((const XMFLOAT4*)(submixBuffers.data() + (submix * 2 + 0) * stride + i)), gain, l);
+					r = XMVectorMultiplyAdd(XMLoadFloat4((const XMFLOAT4*)(submixBuffers.data() + (submix * 2 + 1) * stride + i)), gain, r);
+				}
+				XMStoreFloat4((XMFLOAT4*)(output.data() + i * 2 + 0), XMVectorMergeXY(l, r));
+				XMStoreFloat4((XMFLOAT4*)(output.data() + i * 2 + 4), XMVectorMergeZW(l, r));
+			}
+			for (uint32_t submix = 0; submix < SUBMIX_TYPE_COUNT; ++submix)
+			{
+				outputGains[submix] = submixGains[submix] * masterGain;
+			}
+		}
+
+		void Render(uint32_t frames)
+		{
+			while (frames > 0)
+			{
+				const uint32_t count = std::min(frames, MIX_BLOCK);
+				consumerLock.lock();
+				ExecuteCommands();
+				MixBlock(count);
+				consumerLock.unlock();
+				device->Submit(output.data(), count);
+				frames -= count;
+			}
+		}
+	};
+
+	struct MixerInstance
+	{
+		std::shared_ptr<MixerInternal> mixer;
+		MixerVoice* voice = nullptr;
+		float volume = 1;
+
+		~MixerInstance()
+		{
+			MixerCommand command = {};
+			command.type = MixerCommand::REMOVE;
+			command.voice = voice;
+			mixer->Push(command);
+		}
+	};
+
+	static MixerInternal* to_mixer_internal(const std::shared_ptr<void>& param)
+	{
+		return static_cast<MixerInternal*>(param.get());
+	}
+	static MixerInstance* to_mixer_internal(const SoundInstance* param)
+	{
+		return static_cast<MixerInstance*>(param->internal_state.get());
+	}
+
+	SoftwareMixer::SoftwareMixer(std::shared_ptr<AudioDevice> device)
+	{
+		internal_state = std::make_shared<MixerInternal>(device);
+	}
+	SoftwareMixer::~SoftwareMixer()
+	{
+		Stop();
+	}
+
+	void SoftwareMixer::Start()
+	{
+		MixerInternal* mixer = to_mixer_internal(internal_state);
+		if (mixer->running.exchange(true))
+		{
+			return;
+		}
+		mixer->thread = std::thread([mixer] {
+			while (mixer->running.load())
+			{
+				mixer->Render(MIX_BLOCK);
+			}
+		});
+	}
+	void SoftwareMixer::Stop()
+	{
+		MixerInternal* mixer = to_mixer_internal(internal_state);
+		if (mixer->running.exchange(false))
+		{
+			mixer->thread.join();
+		}
+	}
+	void SoftwareMixer::Render(uint32_t frames)
+	{
+		to_mixer_internal(internal_state)->Render(frames);
+	}
+
+	bool SoftwareMixer::CreateSound(const std::vector<uint8_t>& data, Sound* sound)
+	{
+		auto read16 = [&](size_t offset) {
+			uint16_t value;
+			memcpy(&value, data.data() + offset, sizeof(value));
+			return value;
+		};
+		auto read32 = [&](size_t offset) {
+			uint32_t value;
+			memcpy(&value, data.data() + offset, sizeof(value));
+			return value;
+		};
+
+		if (data.size() < 12 || memcmp(data.data(), "RIFF", 4) != 0 || memcmp(data.data() + 8, "WAVE", 4) != 0)
+		{
+			wiBackLog::post("wiAudio error: the sound is not a .wav file");
+			return false;
+		}
+
+		uint16_t format = 0;
+		uint16_t channels = 0;
+		uint32_t sampleRate = 0;
+		uint16_t bitsPerSample = 0;
+		const uint8_t* samples = nullptr;
+		uint32_t sampleDataSize = 0;
+
+		size_t pos = 12;
+		while (pos + 8 <= data.size())
+		{
+			const uint32_t chunkSize = read32(pos + 4);
+			const size_t chunkData = pos + 8;
+			const size_t available = std::min(size_t(chunkSize), data.size() - chunkData);
+			if (memcmp(data.data() + pos, "fmt ", 4) == 0 && available >= 16)
+			{
+				format = read16(chunkData);
+				channels = read16(chunkData + 2);
+				sampleRate = read32(chunkData + 4);
+				bitsPerSample = read16(chunkData + 14);
+				if (format == 0xFFFE && available >= 26)
+				{
+					format = read16(chunkData + 24); // WAVE_FORMAT_EXTENSIBLE, the sub format starts with the format tag
+				}
+			}
+			else if (memcmp(data.data() + pos, "data", 4) == 0)
+			{
+				samples = data.data() + chunkData;
+				sampleDataSize = (uint32_t)available;
+			}
+			pos = chunkData + chunkSize + (chunkSize & 1);
+		}
+
+		const bool pcm = format == 1 && (bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+		const bool ieee = format == 3 && bitsPerSample == 32;
+		if (samples == nullptr || (!pcm && !ieee) || channels < 1 || channels > 2 || sampleRate == 0)
+		{
+			wiBackLog::post("wiAudio error: unsupported .wav format, the software mixer plays mono and stereo PCM or float sounds");
+			return false;
+		}
+
+		std::shared_ptr<MixerSound> soundinternal = std::make_shared<MixerSound>();
+		soundinternal->sampleRate = sampleRate;
+		soundinternal->channelCount = channels;
+
+		const uint32_t bytesPerSample = bitsPerSample / 8;
+		const uint32_t frameCount = sampleDataSize / (bytesPerSample * channels);
+		soundinternal->frameCount = frameCount;
+		soundinternal->samples.resize(size_t(frameCount + SOUND_PADDING) * channels);
+
+		for (uint32_t channel = 0; channel < channels; ++channel)
+		{
+			float* dst = soundinternal->samples.data() + size_t(channel) * size_t(frameCount + SOUND_PADDING);
+			const uint8_t* src = samples + channel * bytesPerSample;
+			const uint32_t stride = bytesPerSample * channels;
+			for (uint32_t i = 0; i < frameCount; ++i, src += stride)
+			{
+				switch (bitsPerSample)
+				{
+				case 8:
+					dst[i] = (float(*src) - 128.0f) * (1.0f / 128.0f);
+					break;
+				case 16:
+				{
+					int16_t value;
+					memcpy(&value, src, sizeof(value));
+					dst[i] = float(value) * (1.0f / 32768.0f);
+				}
+				break;
+				case 24:
+				{
+					const int32_t value = int32_t(uint32_t(src[0]) << 8 | uint32_t(src[1]) << 16 | uint32_t(src[2]) << 24) >> 8;
+					dst[i] = float(value) * (1.0f / 8388608.0f);
+				}
+				break;
+				case 32:
+					if (ieee)
+					{
+						memcpy(&dst[i], src, sizeof(float));
+					}
+					else
+					{
+						int32_t value;
+						memcpy(&value, src, sizeof(value));
+						dst[i] = float(value) * (1.0f / 2147483648.0f);
+					}
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+		sound->internal_state = soundinternal;
+		return true;
+	}
+	bool SoftwareMixer::CreateSoundInstance(const Sound* sound, SoundInstance* instance)
+	{
+		if (sound == nullptr || !sound->IsValid())
+		{
+			return false;
+		}
+		const auto& soundinternal = std::static_pointer_cast<MixerSound>(sound->internal_state);
+		if (soundinternal->frameCount == 0)
+		{
+			return false;
+		}
+
+		std::shared_ptr<MixerInstance> instanceinternal = std::make_shared<MixerInstance>();
+		instanceinternal->mixer = std::static_pointer_cast<MixerInternal>(internal_state);
+
+		MixerVoice* voice = new MixerVoice;
+		voice->sound = soundinternal;
+		voice->type = instance->type;
+		voice->loopBegin = std::min(uint64_t(std::max(0.0f, instance->loop_begin) * soundinternal->sampleRate), uint64_t(soundinternal->frameCount - 1));
+		voice->loopEnd = soundinternal->frameCount;
+		if (instance->loop_length > 0)
+		{
+			voice->loopEnd = std::min(voice->loopBegin + std::max(uint64_t(1), uint64_t(instance->loop_length * soundinternal->sampleRate)), voice->loopEnd);
+		}
+		if (soundinternal->channelCount == 1)
+		{
+			voice->matrix[0][0] = 1;
+			voice->matrix[0][1] = 1;
+		}
+		else
+		{
+			voice->matrix[0][0] = 1;
+			voice->matrix[1][1] = 1;
+		}
+		instanceinternal->voice = voice;
+
+		MixerCommand command = {};
+		command.type = MixerCommand::ADD;
+		command.voice = voice;
+		instanceinternal->mixer->Push(command);
+
+		instance->internal_state = instanceinternal;
+		return true;
+	}
+
+	static void PushInstanceCommand(SoundInstance* instance, MixerCommand::TYPE type, float value = 0)
+	{
+		if (instance != nullptr && instance->IsValid())
+		{
+			auto instanceinternal = to_mixer_internal(instance);
+			MixerCommand command = {};
+			command.type = type;
+			command.voice = instanceinternal->voice;
+			command.values[0] = value;
+			instanceinternal->mixer->Push(command);
+		}
+	}
+	void SoftwareMixer::Play(SoundInstance* instance)
+	{
+		PushInstanceCommand(instance, MixerCommand::PLAY);
+	}
+	void SoftwareMixer::Pause(SoundInstance* instance)
+	{
+		PushInstanceCommand(instance, MixerCommand::PAUSE);
+	}
+	void SoftwareMixer::Stop(SoundInstance* instance)
+	{
+		PushInstanceCommand(instance, MixerCommand::STOP);
+	}
+	void SoftwareMixer::SetVolume(float volume, SoundInstance* instance)
+	{
+		if (instance == nullptr || !instance->IsValid())
+		{
+			MixerInternal* mixer = to_mixer_internal(internal_state);
+			mixer->masterVolume.store(volume);
+			MixerCommand command = {};
+			command.type = MixerCommand::MASTER_VOLUME;
+			command.values[0] = volume;
+			mixer->Push(command);
+		}
+		else
+		{
+			to_mixer_internal(instance)->volume = volume;
+			PushInstanceCommand(instance, MixerCommand::VOLUME, volume);
+		}
+	}
+	float SoftwareMixer::GetVolume(const SoundInstance* instance) const
+	{
+		if (instance == nullptr || !instance->IsValid())
+		{
+			return to_mixer_internal(internal_state)->masterVolume.load();
+		}
+		return to_mixer_internal(instance)->volume;
+	}
+	void SoftwareMixer::ExitLoop(SoundInstance* instance)
+	{
+		PushInstanceCommand(instance, MixerCommand::EXITLOOP);
+	}
+
+	void SoftwareMixer::SetSubmixVolume(SUBMIX_TYPE type, float volume)
+	{
+		MixerInternal* mixer = to_mixer_internal(internal_state);
+		mixer->submixVolumes[type].store(volume);
+		MixerCommand command = {};
+		command.type = MixerCommand::SUBMIX_VOLUME;
+		command.submix = type;
+		command.values[0] = volume;
+		mixer->Push(command);
+	}
+	float SoftwareMixer::GetSubmixVolume(SUBMIX_TYPE type) const
+	{
+		return to_mixer_internal(internal_state)->submixVolumes[type].load();
+	}
+
+	void SoftwareMixer::Update3D(SoundInstance* instance, const SoundInstance3D& instance3D)
+	{
+		if (instance == nullptr || !instance->IsValid())
+		{
+			return;
+		}
+		auto instanceinternal = to_mixer_internal(instance);
+
+		const XMVECTOR listenerPos = XMLoadFloat3(&instance3D.listenerPos);
+		const XMVECTOR front = XMVector3Normalize(XMLoadFloat3(&instance3D.listenerFront));
+		const XMVECTOR up = XMVector3Normalize(XMLoadFloat3(&instance3D.listenerUp));
+		const XMVECTOR side = XMVector3Normalize(XMVector3Cross(up, front));
+
+		const XMVECTOR toEmitter = XMVectorSubtract(XMLoadFloat3(&instance3D.emitterPos), listenerPos);
+		const float distance = XMVectorGetX(XMVector3Length(toEmitter));
+		const XMVECTOR direction = distance > 0.0001f ? XMVectorScale(toEmitter, 1.0f / distance) : front;
+
+		// Equal power panning, the sound surrounds the listener inside the emitter radius:
+		float pan = XMVectorGetX(XMVector3Dot(direction, side));
+		if (instance3D.emitterRadius > 0)
+		{
+			pan *= saturate(distance / instance3D.emitterRadius);
+		}
+		const float angle = (pan + 1) * XM_PIDIV4;
+
+		// Inverse distance attenuation, full volume up to one unit:
+		const float attenuation = 1.0f / std::max(1.0f, distance);
+
+		// Stereo sounds are downmixed before panning:
+		const float downmix = instanceinternal->voice->sound->channelCount > 1 ? 0.5f : 1.0f;
+		const float gainLeft = std::cos(angle) * attenuation * downmix;
+		const float gainRight = std::sin(angle) * attenuation * downmix;
+
+		// Doppler shift from the velocities along the line between them:
+		const float listenerSpeed = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&instance3D.listenerVelocity), direction));
+		const float emitterSpeed = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&instance3D.emitterVelocity), direction));
+		const float doppler = wiMath::Clamp((SPEED_OF_SOUND + listenerSpeed) / std::max(1.0f, SPEED_OF_SOUND + emitterSpeed), 0.5f, 2.0f);
+
+		MixerCommand command = {};
+		command.type = MixerCommand::SPATIAL;
+		command.voice = instanceinternal->voice;
+		command.values[0] = gainLeft;
+		command.values[1] = gainRight;
+		command.values[2] = gainLeft;
+		command.values[3] = gainRight;
+		command.values[4] = doppler;
+		instanceinternal->mixer->Push(command);
+	}
+
+	uint32_t SoftwareMixer::GetSampleRate() const
+	{
+		return to_mixer_internal(internal_state)->sampleRate;
+	}
+	uint32_t SoftwareMixer::GetPlayingCount() const
+	{
+		return to_mixer_internal(internal_state)->playingCount.load();
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiAudio.h"
+
+#include <memory>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace wiAudio
+{
+	// Output of the software mixer, it receives interleaved stereo 32-bit float samples
+	class AudioDevice
+	{
+	public:
+		virtual ~AudioDevice() = default;
+
+		virtual uint32_t GetSampleRate() const = 0;
+		// Consumes the mixed frames, a hardware device blocks here until it has room for them, which paces the mixer thread
+		virtual void Submit(const float* samples, uint32_t frames) = 0;
+	};
+
+	// Discards the output, for measuring mixing throughput and for running without a sound card
+	//	When realtime is true, Submit() sleeps to consume the frames at the pace of a hardware device
+	class AudioDevice_Null : public AudioDevice
+	{
+	public:
+		AudioDevice_Null(uint32_t sampleRate = 48000, bool realtime = false);
+
+		uint32_t GetSampleRate() const override { return sampleRate; }
+		void Submit(const float* samples, uint32_t frames) override;
+
+		uint64_t GetFrameCount() const { return frameCount; }
+		// The largest absolute sample value that was submitted so far
+		float GetPeak() const { return peak; }
+
+	private:
+		uint32_t sampleRate;
+		bool realtime;
+		uint64_t frameCount = 0;
+		float peak = 0;
+		std::chrono::high_resolution_clock::time_point start;
+	};
+
+	// Records the output into a 16-bit stereo .wav file, for listening to offline mixes and comparing them
+	//	The file is written by Flush() and when the device is destroyed
+	class AudioDevice_File : public AudioDevice
+	{
+	public:
+		AudioDevice_File(const std::string& filename, uint32_t sampleRate = 48000);
+		~AudioDevice_File();
+
+		uint32_t GetSampleRate() const override { return sampleRate; }
+		void Submit(const float* samples, uint32_t frames) override;
+
+		bool Flush();
+		const std::vector<int16_t>& GetSamples() const { return samples; }
+
+	private:
+		std::string filename;
+		uint32_t sampleRate;
+		std::vector<int16_t> samples;
+	};
+
+	// Portable mixer that implements the wiAudio interface in software
+	//	On platforms without XAudio2, the wiAudio functions are forwarded to a mixer that Initialize() creates.
+	//	Every function can be called from any thread, they post commands to a lock-free queue that the mixing thread applies at the start of the next block.
+	//	Sounds are resampled with linear interpolation, mono and stereo .wav files are supported (8, 16, 24, 32-bit integer and 32-bit float PCM).
+	//	Reverb is not simulated.
+	class SoftwareMixer
+	{
+	public:
+		SoftwareMixer(std::shared_ptr<AudioDevice> device);
+		~SoftwareMixer();
+
+		// Mixes on a background thread until Stop(), paced by the device
+		void Start();
+		void Stop();
+		// Mixes the given number of frames on the calling thread and submits them to the device, for offline rendering
+		//	It must not be called while the background thread is running
+		void Render(uint32_t frames);
+
+		static bool CreateSound(const std::vector<uint8_t>& data, Sound* sound);
+		bool CreateSoundInstance(const Sound* sound, SoundInstance* instance);
+
+		void Play(SoundInstance* instance);
+		void Pause(SoundInstance* instance);
+		void Stop(SoundInstance* instance);
+		void SetVolume(float volume, SoundInstance* instance = nullptr);
+		float GetVolume(const SoundInstance* instance = nullptr) const;
+		void ExitLoop(SoundInstance* instance);
+
+		void SetSubmixVolume(SUBMIX_TYPE type, float volume);
+		float GetSubmixVolume(SUBMIX_TYPE type) const;
+
+		// Computes the panning, distance attenuation and doppler shift of the instance for stereo output
+		void Update3D(SoundInstance* instance, const SoundInstance3D& instance3D);
+
+		uint32_t GetSampleRate() const;
+		// The number of sound instances that were mixed in the last block
+		uint32_t GetPlayingCount() const;
+
+	private:
+		std::shared_ptr<void> internal_state;
+	};
+
+#ifndef _WIN32
+	// Replaces the output device of the mixer that backs the wiAudio functions, it must be called before Initialize()
+	//	The default is a realtime AudioDevice_Null, because there is no hardware output backend yet
+	void SetSoftwareMixerDevice(std::shared_ptr<AudioDevice> device);
+#endif // _WIN32
+}
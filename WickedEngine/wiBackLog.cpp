@@ -10,10 +10,20 @@
 #include "wiLua.h"
 #include "wiInput.h"
 #include "wiPlatform.h"
+#include "wiTimer.h"
 
 #include <mutex>
 #include <sstream>
 #include <deque>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
 
 using namespace std;
 using namespace wiGraphics;
@@ -43,6 +53,255 @@ namespace wiBackLog
 
 	std::unique_ptr<Texture> backgroundTex;
 
+	// Messages are stored in fixed size records, longer messages continue in the next records of the same ring
+	struct Record
+	{
+		double timestamp;
+		uint32_t thread;
+		uint16_t length;
+		uint8_t level;
+		uint8_t continued;
+		char text[240];
+	};
+	static_assert(sizeof(Record) == 256, "Record size mismatch");
+	static const uint32_t RING_SIZE = 256; // must be power of two
+	static const uint32_t MAX_MESSAGE_RECORDS = 16;
+	static const uint32_t MAX_RINGS = 256;
+
+	// Single producer, single consumer ring of records, every posting thread owns one
+	struct Ring
+	{
+		std::atomic<uint32_t> head{ 0 }; // advanced by the owner thread
+		std::atomic<uint32_t> tail{ 0 }; // advanced by the consumer
+		std::atomic<bool> owned{ true };
+		uint32_t thread = 0;
+		Record records[RING_SIZE];
+	};
+
+	// The logger is never destroyed, because threads can post messages during static destruction
+	struct Logger
+	{
+		std::atomic<Ring*> rings[MAX_RINGS] = {};
+		std::atomic<uint32_t> ringCount{ 0 };
+		std::atomic<uint32_t> threadCount{ 0 };
+
+		std::mutex consumeLock;
+		struct Item
+		{
+			double timestamp;
+			uint32_t ring;
+			uint32_t index;
+		};
+		std::vector<Item> items;
+		std::string message;
+		FILE* file = nullptr;
+		bool stdOutput = false;
+
+		std::mutex wakeLock;
+		std::condition_variable wakeCondition;
+		std::atomic<bool> pending{ false };
+		std::atomic<bool> running{ true };
+		std::thread thread;
+
+		// Moves every published record to the outputs, ordered by time
+		void Consume()
+		{
+			std::lock_guard<std::mutex> lck(consumeLock);
+
+			items.clear();
+			uint32_t heads[MAX_RINGS];
+			const uint32_t count = ringCount.load();
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Ring* ring = rings[i].load();
+				if (ring == nullptr)
+				{
+					heads[i] = 0;
+					continue;
+				}
+				heads[i] = ring->head.load(std::memory_order_acquire);
+				for (uint32_t j = ring->tail.load(std::memory_order_relaxed); j != heads[i]; ++j)
+				{
+					items.push_back({ ring->records[j % RING_SIZE].timestamp, i, j });
+				}
+			}
+			if (items.empty())
+				return;
+
+			// records of a message have the same timestamp and consecutive indices in one ring, so they stay together
+			std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+				return a.timestamp < b.timestamp || (a.timestamp == b.timestamp && (a.ring < b.ring || (a.ring == b.ring && a.index < b.index)));
+			});
+
+			for (const Item& item : items)
+			{
+				const Record& record = rings[item.ring].load()->records[item.index % RING_SIZE];
+				message.append(record.text, record.length);
+				if (record.continued)
+					continue;
+
+				Write(record);
+				message.clear();
+			}
+			message.clear();
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Ring* ring = rings[i].load();
+				if (ring != nullptr)
+				{
+					ring->tail.store(heads[i], std::memory_order_release);
+				}
+			}
+			if (file != nullptr)
+			{
+				fflush(file);
+			}
+		}
+		void Write(const Record& record)
+		{
+			logLock.lock();
+			stream.push_back(message + "\n");
+			if (stream.size() > deletefromline) {
+				stream.pop_front();
+			}
+			logLock.unlock();
+
+			if (file != nullptr || stdOutput)
+			{
+				static const char* levels[] = { "INFO", "WARNING", "ERROR" };
+				char header[64];
+				int length = snprintf(header, sizeof(header), "[%.3f][T%u][%s] ", record.timestamp / 1000.0, record.thread, levels[record.level % arraysize(levels)]);
+				if (file != nullptr)
+				{
+					fwrite(header, 1, (size_t)length, file);
+					fwrite(message.c_str(), 1, message.length(), file);
+					fputc('\n', file);
+				}
+				if (stdOutput)
+				{
+					fwrite(header, 1, (size_t)length, stdout);
+					fwrite(message.c_str(), 1, message.length(), stdout);
+					fputc('\n', stdout);
+				}
+			}
+
+#ifdef _WIN32
+			message += "\n";
+			OutputDebugStringA(message.c_str());
+#endif // _WIN32
+		}
+
+		// Writes a message that doesn't fit into the records of a ring directly, after everything that was posted before it
+		void WriteDirect(const char* text, size_t length, uint32_t thread, LEVEL level)
+		{
+			Consume();
+
+			std::lock_guard<std::mutex> lck(consumeLock);
+			Record record;
+			record.timestamp = wiTimer::TotalTime();
+			record.thread = thread;
+			record.length = 0;
+			record.level = (uint8_t)level;
+			record.continued = 0;
+			message.assign(text, length);
+			Write(record);
+			message.clear();
+		}
+
+		void Wake()
+		{
+			if (!pending.exchange(true))
+			{
+				std::lock_guard<std::mutex> lck(wakeLock);
+				wakeCondition.notify_one();
+			}
+		}
+		void Stop()
+		{
+			if (thread.joinable())
+			{
+				{
+					std::lock_guard<std::mutex> lck(wakeLock);
+					running.store(false);
+				}
+				wakeCondition.notify_one();
+				thread.join();
+			}
+			Consume();
+			if (file != nullptr)
+			{
+				fclose(file);
+				file = nullptr;
+			}
+		}
+
+		Logger()
+		{
+			thread = std::thread([this] {
+				while (running.load())
+				{
+					{
+						std::unique_lock<std::mutex> lck(wakeLock);
+						wakeCondition.wait(lck, [this] { return pending.load() || !running.load(); });
+					}
+					pending.store(false);
+					Consume();
+				}
+			});
+		}
+
+		Ring* AcquireRing()
+		{
+			Ring* ring = nullptr;
+			const uint32_t count = ringCount.load();
+			for (uint32_t i = 0; i < count && ring == nullptr; ++i)
+			{
+				// reuse the ring of a thread that exited
+				Ring* candidate = rings[i].load();
+				bool owned = false;
+				if (candidate != nullptr && candidate->owned.compare_exchange_strong(owned, true))
+				{
+					ring = candidate;
+				}
+			}
+			if (ring == nullptr)
+			{
+				const uint32_t index = ringCount.fetch_add(1);
+				if (index >= MAX_RINGS)
+				{
+					ringCount.fetch_sub(1);
+					return nullptr;
+				}
+				ring = new Ring;
+				rings[index].store(ring);
+			}
+			ring->thread = threadCount.fetch_add(1);
+			return ring;
+		}
+	};
+	Logger& GetLogger()
+	{
+		static Logger* logger = [] {
+			Logger* logger = new Logger;
+			std::atexit([] { GetLogger().Stop(); });
+			return logger;
+		}();
+		return *logger;
+	}
+	struct ThreadRing
+	{
+		Ring* ring = nullptr;
+		~ThreadRing()
+		{
+			if (ring != nullptr)
+			{
+				ring->owned.store(false);
+			}
+		}
+	};
+	thread_local ThreadRing threadRing;
+
 	void Toggle() 
 	{
 		switch (state) 
@@ -137,6 +396,7 @@ namespace wiBackLog
 
 	string getText() 
 	{
+		flush();
 		logLock.lock();
 		stringstream ss("");
 		for (unsigned int i = 0; i < stream.size(); ++i)
@@ -146,25 +406,101 @@ namespace wiBackLog
 	}
 	void clear() 
 	{
+		flush();
 		logLock.lock();
 		stream.clear();
 		logLock.unlock();
 	}
-	void post(const char* input) 
+	void post(const char* input, LEVEL level) 
 	{
-		stringstream ss("");
-		ss << input << endl;
+		Logger& logger = GetLogger();
+		if (threadRing.ring == nullptr)
+		{
+			threadRing.ring = logger.AcquireRing();
+			if (threadRing.ring == nullptr)
+			{
+				return; // too many threads
+			}
+		}
+		Ring& ring = *threadRing.ring;
 
-		logLock.lock();
-		stream.push_back(ss.str().c_str());
-		if (stream.size() > deletefromline) {
-			stream.pop_front();
+		const size_t textSize = arraysize(ring.records[0].text);
+		const size_t length = strlen(input);
+		if (length > MAX_MESSAGE_RECORDS * textSize)
+		{
+			// too long for the ring, this is the slow path that locks
+			logger.WriteDirect(input, length, ring.thread, level);
+			return;
 		}
-		logLock.unlock();
+		const uint32_t count = std::max(1u, uint32_t((length + textSize - 1) / textSize));
 
-#ifdef _WIN32
-		OutputDebugStringA(ss.str().c_str());
-#endif // _WIN32
+		const uint32_t head = ring.head.load(std::memory_order_relaxed);
+		while (head + count - ring.tail.load(std::memory_order_acquire) > RING_SIZE)
+		{
+			// the ring is full, process the messages on this thread
+			logger.Consume();
+		}
+
+		const double timestamp = wiTimer::TotalTime();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			Record& record = ring.records[(head + i) % RING_SIZE];
+			record.timestamp = timestamp;
+			record.thread = ring.thread;
+			record.level = (uint8_t)level;
+			record.continued = i < count - 1 ? 1 : 0;
+			record.length = (uint16_t)std::min(textSize, length - i * textSize);
+			memcpy(record.text, input + i * textSize, record.length);
+		}
+		ring.head.store(head + count, std::memory_order_release);
+
+		logger.Wake();
+	}
+	void postf(LEVEL level, const char* format, ...)
+	{
+		char text[MAX_MESSAGE_RECORDS * arraysize(Record::text)];
+		va_list args;
+		va_start(args, format);
+		va_list args_long;
+		va_copy(args_long, args);
+		const int length = vsnprintf(text, sizeof(text), format, args);
+		va_end(args);
+		if (length >= (int)sizeof(text))
+		{
+			// only long messages need to allocate
+			std::string text_long((size_t)length + 1, '\0');
+			vsnprintf(&text_long[0], text_long.size(), format, args_long);
+			va_end(args_long);
+			post(text_long.c_str(), level);
+			return;
+		}
+		va_end(args_long);
+		post(text, level);
+	}
+	void flush()
+	{
+		GetLogger().Consume();
+	}
+	void setFileOutput(const std::string& filename)
+	{
+		Logger& logger = GetLogger();
+		logger.Consume();
+		std::lock_guard<std::mutex> lck(logger.consumeLock);
+		if (logger.file != nullptr)
+		{
+			fclose(logger.file);
+			logger.file = nullptr;
+		}
+		if (!filename.empty())
+		{
+			logger.file = fopen(filename.c_str(), "w");
+		}
+	}
+	void setStdOutput(bool value)
+	{
+		Logger& logger = GetLogger();
+		std::lock_guard<std::mutex> lck(logger.consumeLock);
+		logger.stdOutput = value;
 	}
 	void input(const char& input) 
 	{
@@ -191,8 +527,11 @@ namespace wiBackLog
 	}
 	void save(ofstream& file) 
 	{
+		flush();
+		logLock.lock();
 		for (deque<string>::iterator iter = stream.begin(); iter != stream.end(); ++iter)
 			file << iter->c_str();
+		logLock.unlock();
 		file.close();
 	}
 
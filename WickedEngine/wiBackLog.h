@@ -5,8 +5,18 @@
 #include <string>
 #include <fstream>
 
+// Message log that is displayed on the screen and can execute Lua commands
+//	Messages can be posted from any thread without locking or allocation: they are copied into fixed size records of a per-thread lock-free ring,
+//	and a background thread moves them to the screen, the debug output, and the optional file and standard output
 namespace wiBackLog
 {
+	enum LEVEL
+	{
+		LEVEL_INFO,
+		LEVEL_WARNING,
+		LEVEL_ERROR,
+	};
+
 	void Toggle();
 	void Scroll(int direction);
 	void Update();
@@ -14,7 +24,16 @@ namespace wiBackLog
 
 	std::string getText();
 	void clear();
-	void post(const char* input);
+	// Post a message, messages longer than about 3.8 KB don't fit into the lock-free ring, they are written immediately under a lock instead
+	void post(const char* input, LEVEL level = LEVEL_INFO);
+	// Post a printf style formatted message
+	void postf(LEVEL level, const char* format, ...);
+	// Wait until every message that was posted before is processed
+	void flush();
+	// Also write the messages to a file with timestamp, thread and level, an empty file name disables it
+	void setFileOutput(const std::string& filename);
+	// Also write the messages to the standard output with timestamp, thread and level
+	void setStdOutput(bool value);
 	void input(const char& input);
 	void acceptInput();
 	void deletefromInput();
@@ -8,6 +8,7 @@
 #include <cassert>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
 
 namespace wiECS
 {
@@ -58,14 +59,33 @@ namespace wiECS
 		}
 
 		// Perform deep copy of all the contents of "other" into this
+		//	The containers are assigned without clearing them first, so repeated copies can reuse the memory of the previous contents
 		inline void Copy(const ComponentManager<Component>& other)
 		{
-			Clear();
 			components = other.components;
 			entities = other.entities;
 			lookup = other.lookup;
 		}
 
+		// Copy the contents of "other" into this, but the components are assigned by a custom function
+		//	copy_component(Component& dst, const Component& src, bool same_entity) : same_entity is true when dst holds the previous copy of the same entity,
+		//	so the function can skip copying data that didn't change since then
+		template<typename CopyFunction>
+		inline void Copy(const ComponentManager<Component>& other, CopyFunction copy_component)
+		{
+			const size_t previous_count = entities.size();
+			components.resize(other.components.size());
+			for (size_t i = 0; i < other.components.size(); ++i)
+			{
+				copy_component(components[i], other.components[i], i < previous_count && entities[i] == other.entities[i]);
+			}
+			if (entities != other.entities)
+			{
+				entities = other.entities;
+				lookup = other.lookup;
+			}
+		}
+
 		// Merge in an other component manager of the same type to this. 
 		//	The other component manager MUST NOT contain any of the same entities!
 		//	The other component manager is not retained after this operation!
@@ -212,6 +232,46 @@ namespace wiECS
 			}
 		}
 
+		// Remove the components of many entities (if they exist) while keeping the current ordering
+		//	The containers are compacted only once, which is much faster than calling Remove_KeepSorted() for each entity
+		inline void Remove_KeepSorted(const Entity* entities_to_remove, size_t count)
+		{
+			// Mark the removed elements, and find the first one, because everything before it stays in place:
+			size_t first = components.size();
+			for (size_t i = 0; i < count; ++i)
+			{
+				auto it = lookup.find(entities_to_remove[i]);
+				if (it != lookup.end())
+				{
+					const size_t index = it->second;
+					entities[index] = INVALID_ENTITY;
+					lookup.erase(it);
+					first = std::min(first, index);
+				}
+			}
+			if (first == components.size())
+			{
+				return;
+			}
+
+			// Move every alive element left over the removed ones and update lut:
+			size_t alive = first;
+			for (size_t i = first + 1; i < components.size(); ++i)
+			{
+				if (entities[i] != INVALID_ENTITY)
+				{
+					components[alive] = std::move(components[i]);
+					entities[alive] = entities[i];
+					lookup[entities[alive]] = alive;
+					alive++;
+				}
+			}
+
+			// Shrink the container:
+			components.erase(components.begin() + alive, components.end());
+			entities.erase(entities.begin() + alive, entities.end());
+		}
+
 		// Place an entity-component to the specified index position while keeping the ordering intact
 		inline void MoveItem(size_t index_from, size_t index_to)
 		{
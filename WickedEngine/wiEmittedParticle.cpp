@@ -11,6 +11,7 @@
 #include "wiGPUSortLib.h"
 #include "wiProfiler.h"
 #include "wiBackLog.h"
+#include "wiJobSystem.h"
 
 #include <algorithm>
 
@@ -53,7 +54,7 @@ void wiEmittedParticle::SetMaxParticleCount(uint32_t value)
 
 void wiEmittedParticle::CreateSelfBuffers()
 {
-	if (buffersUpToDate)
+	if (buffersUpToDate || wiRenderer::GetDevice() == nullptr)
 	{
 		return;
 	}
@@ -215,7 +216,7 @@ void wiEmittedParticle::UpdateCPU(const TransformComponent& transform, float dt)
 	std::swap(aliveList[0], aliveList[1]);
 
 
-	if (IsDebug())
+	if (IsDebug() && !IsCPUSimulationEnabled() && counterBuffer.IsValid())
 	{
 		wiRenderer::GetDevice()->DownloadResource(&counterBuffer, &debugDataReadbackBuffer, &debugData);
 	}
@@ -230,8 +231,792 @@ void wiEmittedParticle::Burst(int num)
 void wiEmittedParticle::Restart()
 {
 	buffersUpToDate = false;
+	cpu.capacity = 0;
 	SetPaused(false);
 }
+void wiEmittedParticle::CopyForRendering(const wiEmittedParticle& other)
+{
+	debugData = other.debugData;
+	debugDataReadbackBuffer = other.debugDataReadbackBuffer;
+	debugDataReadbackIndexBuffer = other.debugDataReadbackIndexBuffer;
+	debugDataReadbackDistanceBuffer = other.debugDataReadbackDistanceBuffer;
+	particleBuffer = other.particleBuffer;
+	aliveList[0] = other.aliveList[0];
+	aliveList[1] = other.aliveList[1];
+	deadList = other.deadList;
+	distanceBuffer = other.distanceBuffer;
+	sphPartitionCellIndices = other.sphPartitionCellIndices;
+	sphPartitionCellOffsets = other.sphPartitionCellOffsets;
+	densityBuffer = other.densityBuffer;
+	counterBuffer = other.counterBuffer;
+	indirectBuffers = other.indirectBuffers;
+	constantBuffer = other.constantBuffer;
+	emit = other.emit;
+	burst = other.burst;
+	buffersUpToDate = other.buffersUpToDate;
+	MAX_PARTICLES = other.MAX_PARTICLES;
+
+	_flags = other._flags;
+	shaderType = other.shaderType;
+	meshID = other.meshID;
+	FIXED_TIMESTEP = other.FIXED_TIMESTEP;
+	size = other.size;
+	random_factor = other.random_factor;
+	normal_factor = other.normal_factor;
+	count = other.count;
+	life = other.life;
+	random_life = other.random_life;
+	scaleX = other.scaleX;
+	scaleY = other.scaleY;
+	rotation = other.rotation;
+	motionBlurAmount = other.motionBlurAmount;
+	mass = other.mass;
+	SPH_h = other.SPH_h;
+	SPH_K = other.SPH_K;
+	SPH_p0 = other.SPH_p0;
+	SPH_e = other.SPH_e;
+	framesX = other.framesX;
+	framesY = other.framesY;
+	frameCount = other.frameCount;
+	frameStart = other.frameStart;
+	frameRate = other.frameRate;
+	center = other.center;
+
+	// The CPU simulation state is not copied, UpdateGPU() only uploads the alive part of the GPU upload data:
+	cpu.capacity = other.cpu.capacity;
+	cpu.aliveCount = other.cpu.aliveCount;
+	cpu.frame = other.cpu.frame;
+	const uint32_t particleCount = std::min(other.cpu.aliveCount, (uint32_t)other.cpu.gpu_particles.size());
+	cpu.gpu_particles.assign(other.cpu.gpu_particles.begin(), other.cpu.gpu_particles.begin() + particleCount);
+	cpu.gpu_aliveList.assign(other.cpu.gpu_aliveList.begin(), other.cpu.gpu_aliveList.begin() + std::min(particleCount, (uint32_t)other.cpu.gpu_aliveList.size()));
+	cpu.gpu_distances.assign(other.cpu.gpu_distances.begin(), other.cpu.gpu_distances.begin() + std::min(particleCount, (uint32_t)other.cpu.gpu_distances.size()));
+}
+
+void wiEmittedParticle::CPUParticleData::Reset(uint32_t maxParticleCount)
+{
+	capacity = maxParticleCount;
+	aliveCount = 0;
+
+	const size_t padded = (maxParticleCount + 3) & ~3u;
+	for (std::vector<float>* stream : {
+		&position_x, &position_y, &position_z,
+		&velocity_x, &velocity_y, &velocity_z,
+		&force_x, &force_y, &force_z,
+		&mass, &rotationalVelocity, &maxLife, &life, &sizeBegin, &sizeEnd })
+	{
+		stream->clear();
+		stream->resize(padded, 0.0f);
+	}
+	color_mirror.clear();
+	color_mirror.resize(padded, 0);
+
+	gpu_particles.resize(maxParticleCount);
+	gpu_distances.resize(maxParticleCount);
+	gpu_aliveList.resize(maxParticleCount);
+	for (uint32_t i = 0; i < maxParticleCount; ++i)
+	{
+		gpu_aliveList[i] = i;
+	}
+}
+void wiEmittedParticle::CPUParticleData::Move(uint32_t index_from, uint32_t index_to)
+{
+	position_x[index_to] = position_x[index_from];
+	position_y[index_to] = position_y[index_from];
+	position_z[index_to] = position_z[index_from];
+	velocity_x[index_to] = velocity_x[index_from];
+	velocity_y[index_to] = velocity_y[index_from];
+	velocity_z[index_to] = velocity_z[index_from];
+	force_x[index_to] = force_x[index_from];
+	force_y[index_to] = force_y[index_from];
+	force_z[index_to] = force_z[index_from];
+	mass[index_to] = mass[index_from];
+	rotationalVelocity[index_to] = rotationalVelocity[index_from];
+	maxLife[index_to] = maxLife[index_from];
+	life[index_to] = life[index_from];
+	sizeBegin[index_to] = sizeBegin[index_from];
+	sizeEnd[index_to] = sizeEnd[index_from];
+	color_mirror[index_to] = color_mirror[index_from];
+}
+Particle wiEmittedParticle::CPUParticleData::GetParticle(uint32_t index) const
+{
+	Particle particle;
+	particle.position = XMFLOAT3(position_x[index], position_y[index], position_z[index]);
+	particle.mass = mass[index];
+	particle.force = XMFLOAT3(force_x[index], force_y[index], force_z[index]);
+	particle.rotationalVelocity = rotationalVelocity[index];
+	particle.velocity = XMFLOAT3(velocity_x[index], velocity_y[index], velocity_z[index]);
+	particle.maxLife = maxLife[index];
+	particle.sizeBeginEnd = XMFLOAT2(sizeBegin[index], sizeEnd[index]);
+	particle.life = life[index];
+	particle.color_mirror = color_mirror[index];
+	return particle;
+}
+
+// Stateless random generator for particle emission, so that jobs don't depend on each other's random state
+struct ParticleRandom
+{
+	uint32_t state;
+	ParticleRandom(uint32_t seed, uint32_t index) : state(seed ^ (index * 0x9E3779B9u)) { next(); }
+	inline uint32_t next()
+	{
+		// PCG hash
+		state = state * 747796405u + 2891336453u;
+		uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+		return (word >> 22u) ^ word;
+	}
+	// returns random float in [0, 1)
+	inline float rand()
+	{
+		return float(next() >> 8) * (1.0f / 16777216.0f);
+	}
+};
+
+void wiEmittedParticle::SimulateCPU(
+	const TransformComponent& transform,
+	const MaterialComponent& material,
+	const MeshComponent* mesh,
+	const wiECS::ComponentManager<ForceFieldComponent>& forces,
+	float dt
+)
+{
+	if (!IsCPUSimulationEnabled() || IsPaused())
+	{
+		return;
+	}
+
+	if (cpu.capacity != MAX_PARTICLES)
+	{
+		cpu.Reset(MAX_PARTICLES);
+	}
+	cpu.frame++;
+
+	// simulation can be either fixed or variable timestep:
+	const float timestep = FIXED_TIMESTEP >= 0 ? FIXED_TIMESTEP : dt;
+
+	wiJobSystem::context ctx;
+	const uint32_t groupSize = 64; // SIMD blocks of 4 particles per job
+
+	// Emit the required amount if there are free slots in the dead list:
+	const uint32_t deadCount = cpu.capacity - cpu.aliveCount;
+	const uint32_t realEmitCount = std::min(deadCount, (uint32_t)emit);
+	if (realEmitCount > 0)
+	{
+		const XMMATRIX W = XMLoadFloat4x4(&transform.world);
+		const bool fromMesh = mesh != nullptr && mesh->indices.size() >= 3 && !mesh->vertex_positions.empty();
+		const bool hasNormals = fromMesh && mesh->vertex_normals.size() == mesh->vertex_positions.size();
+		const uint32_t triangleCount = fromMesh ? (uint32_t)mesh->indices.size() / 3 : 0;
+		const uint32_t seed = cpu.frame * 0x2545F491u + (uint32_t)wiRandom::getRandom(0, 1000);
+		const float particleRotation = rotation * XM_PI * 60;
+		const uint32_t particleColor = wiMath::CompressColor(XMFLOAT4(material.baseColor.x, material.baseColor.y, material.baseColor.z, 1)) & 0x00FFFFFF;
+		const uint32_t emitOffset = cpu.aliveCount;
+
+		wiJobSystem::Dispatch(ctx, realEmitCount, 256, [&](wiJobArgs args) {
+
+			ParticleRandom rng(seed, args.jobIndex);
+
+			XMVECTOR P;
+			XMVECTOR N = XMVectorZero();
+			if (fromMesh)
+			{
+				// random triangle on emitter surface:
+				const uint32_t tri = std::min(triangleCount - 1, (uint32_t)(triangleCount * rng.rand()));
+				const uint32_t i0 = mesh->indices[tri * 3 + 0];
+				const uint32_t i1 = mesh->indices[tri * 3 + 1];
+				const uint32_t i2 = mesh->indices[tri * 3 + 2];
+
+				// random barycentric coords:
+				float f = rng.rand();
+				float g = rng.rand();
+				if (f + g > 1)
+				{
+					f = 1 - f;
+					g = 1 - g;
+				}
+
+				const XMVECTOR P0 = XMLoadFloat3(&mesh->vertex_positions[i0]);
+				const XMVECTOR P1 = XMLoadFloat3(&mesh->vertex_positions[i1]);
+				const XMVECTOR P2 = XMLoadFloat3(&mesh->vertex_positions[i2]);
+				P = P0 + f * (P1 - P0) + g * (P2 - P0);
+				P = XMVector3Transform(P, W);
+
+				if (hasNormals)
+				{
+					const XMVECTOR N0 = XMLoadFloat3(&mesh->vertex_normals[i0]);
+					const XMVECTOR N1 = XMLoadFloat3(&mesh->vertex_normals[i1]);
+					const XMVECTOR N2 = XMLoadFloat3(&mesh->vertex_normals[i2]);
+					N = N0 + f * (N1 - N0) + g * (N2 - N0);
+					N = XMVector3Normalize(XMVector3TransformNormal(N, W));
+				}
+			}
+			else if (IsVolumeEnabled())
+			{
+				// Emit inside volume:
+				P = XMVector3Transform(XMVectorSet(rng.rand() * 2 - 1, rng.rand() * 2 - 1, rng.rand() * 2 - 1, 1), W);
+			}
+			else
+			{
+				// Just emit from center point:
+				P = W.r[3];
+			}
+
+			const float particleStartingSize = size + size * (rng.rand() - 0.5f) * random_factor;
+
+			XMFLOAT3 position;
+			XMStoreFloat3(&position, P);
+			XMFLOAT3 velocity;
+			XMStoreFloat3(&velocity, (N + (XMVectorSet(rng.rand(), rng.rand(), rng.rand(), 0) - XMVectorReplicate(0.5f)) * random_factor) * normal_factor);
+
+			const uint32_t index = emitOffset + args.jobIndex;
+			cpu.position_x[index] = position.x;
+			cpu.position_y[index] = position.y;
+			cpu.position_z[index] = position.z;
+			cpu.velocity_x[index] = velocity.x;
+			cpu.velocity_y[index] = velocity.y;
+			cpu.velocity_z[index] = velocity.z;
+			cpu.force_x[index] = 0;
+			cpu.force_y[index] = 0;
+			cpu.force_z[index] = 0;
+			cpu.mass[index] = mass;
+			cpu.rotationalVelocity[index] = particleRotation + (rng.rand() - 0.5f) * random_factor;
+			cpu.maxLife[index] = life + life * (rng.rand() - 0.5f) * random_life;
+			cpu.life[index] = cpu.maxLife[index];
+			cpu.sizeBegin[index] = particleStartingSize;
+			cpu.sizeEnd[index] = particleStartingSize * scaleX;
+			cpu.color_mirror[index] = particleColor;
+			cpu.color_mirror[index] |= rng.rand() > 0.5f ? 0x10000000 : 0;
+			cpu.color_mirror[index] |= rng.rand() < 0.5f ? 0x20000000 : 0;
+		});
+		wiJobSystem::Wait(ctx);
+
+		cpu.aliveCount += realEmitCount;
+	}
+
+	// Kill particles that ran out of life, the last alive particle is moved into their slot to keep the pool compacted:
+	for (uint32_t i = 0; i < cpu.aliveCount;)
+	{
+		if (cpu.life[i] > 0)
+		{
+			i++;
+		}
+		else
+		{
+			cpu.aliveCount--;
+			cpu.Move(cpu.aliveCount, i);
+		}
+	}
+
+	// Gather force fields affecting the simulation:
+	struct ForceField
+	{
+		bool point;
+		XMFLOAT3 position;
+		float gravity;
+		float range_rcp;
+		XMFLOAT3 normal;
+	};
+	std::vector<ForceField> forcefields(forces.GetCount());
+	for (size_t i = 0; i < forces.GetCount(); ++i)
+	{
+		const ForceFieldComponent& force = forces[i];
+		forcefields[i].point = force.type == ENTITY_TYPE_FORCEFIELD_POINT;
+		forcefields[i].position = force.position;
+		forcefields[i].gravity = force.gravity;
+		forcefields[i].range_rcp = 1.0f / std::max(0.0001f, force.GetRange());
+		forcefields[i].normal = force.direction;
+	}
+
+	const bool sph = IsSPHEnabled();
+	const bool sorted = IsSorted();
+	const bool upload = wiRenderer::GetDevice() != nullptr;
+	const XMFLOAT3 eye = wiRenderer::GetCamera().Eye;
+
+	if (sph)
+	{
+		// SPH forces are accumulated into the particle forces before the integration:
+		SolveSPH_CPU();
+	}
+
+	// Simulate 4 particles at once:
+	const uint32_t blockCount = (cpu.aliveCount + 3) / 4;
+	wiJobSystem::Dispatch(ctx, blockCount, groupSize, [&](wiJobArgs args) {
+
+		const uint32_t i = args.jobIndex * 4;
+		const XMVECTOR DT = XMVectorReplicate(timestep);
+		const XMVECTOR ZERO = XMVectorZero();
+		const XMVECTOR ONE = XMVectorSplatOne();
+
+		XMVECTOR px = XMLoadFloat4((const XMFLOAT4*)&cpu.position_x[i]);
+		XMVECTOR py = XMLoadFloat4((const XMFLOAT4*)&cpu.position_y[i]);
+		XMVECTOR pz = XMLoadFloat4((const XMFLOAT4*)&cpu.position_z[i]);
+		XMVECTOR vx = XMLoadFloat4((const XMFLOAT4*)&cpu.velocity_x[i]);
+		XMVECTOR vy = XMLoadFloat4((const XMFLOAT4*)&cpu.velocity_y[i]);
+		XMVECTOR vz = XMLoadFloat4((const XMFLOAT4*)&cpu.velocity_z[i]);
+		XMVECTOR fx = XMLoadFloat4((const XMFLOAT4*)&cpu.force_x[i]);
+		XMVECTOR fy = XMLoadFloat4((const XMFLOAT4*)&cpu.force_y[i]);
+		XMVECTOR fz = XMLoadFloat4((const XMFLOAT4*)&cpu.force_z[i]);
+		XMVECTOR lf = XMLoadFloat4((const XMFLOAT4*)&cpu.life[i]);
+
+		for (const ForceField& forcefield : forcefields)
+		{
+			XMVECTOR dx = XMVectorReplicate(forcefield.position.x) - px;
+			XMVECTOR dy = XMVectorReplicate(forcefield.position.y) - py;
+			XMVECTOR dz = XMVectorReplicate(forcefield.position.z) - pz;
+			XMVECTOR dist;
+			if (forcefield.point)
+			{
+				dist = XMVectorSqrt(dx * dx + dy * dy + dz * dz);
+			}
+			else
+			{
+				const XMVECTOR nx = XMVectorReplicate(forcefield.normal.x);
+				const XMVECTOR ny = XMVectorReplicate(forcefield.normal.y);
+				const XMVECTOR nz = XMVectorReplicate(forcefield.normal.z);
+				dist = nx * dx + ny * dy + nz * dz;
+				dx = nx;
+				dy = ny;
+				dz = nz;
+			}
+			const XMVECTOR strength = XMVectorReplicate(forcefield.gravity) * (ONE - XMVectorSaturate(dist * XMVectorReplicate(forcefield.range_rcp)));
+			fx += dx * strength;
+			fy += dy * strength;
+			fz += dz * strength;
+		}
+
+		// integrate:
+		vx += fx * DT;
+		vy += fy * DT;
+		vz += fz * DT;
+		px += vx * DT;
+		py += vy * DT;
+		pz += vz * DT;
+
+		if (sph)
+		{
+			// drag:
+			const XMVECTOR drag = XMVectorReplicate(0.98f);
+			vx *= drag;
+			vy *= drag;
+			vz *= drag;
+
+			const XMVECTOR elastic = XMVectorReplicate(-0.6f);
+			const XMVECTOR lifeLerp = ONE - lf / XMLoadFloat4((const XMFLOAT4*)&cpu.maxLife[i]);
+			const XMVECTOR particleSize = XMVectorLerpV(
+				XMLoadFloat4((const XMFLOAT4*)&cpu.sizeBegin[i]),
+				XMLoadFloat4((const XMFLOAT4*)&cpu.sizeEnd[i]),
+				lifeLerp
+			);
+
+			// floor collision:
+			XMVECTOR collision = XMVectorLess(py - particleSize, ZERO);
+			py = XMVectorSelect(py, particleSize, collision);
+			vy = XMVectorSelect(vy, vy * elastic, collision);
+
+			// box collision:
+			const XMVECTOR extent_x = XMVectorReplicate(SPH_BOX_COLLISION_EXTENT_X);
+			const XMVECTOR extent_z = XMVectorReplicate(SPH_BOX_COLLISION_EXTENT_Z);
+			collision = XMVectorGreater(px + particleSize, extent_x);
+			px = XMVectorSelect(px, extent_x - particleSize, collision);
+			vx = XMVectorSelect(vx, vx * elastic, collision);
+			collision = XMVectorLess(px - particleSize, -extent_x);
+			px = XMVectorSelect(px, -extent_x + particleSize, collision);
+			vx = XMVectorSelect(vx, vx * elastic, collision);
+			collision = XMVectorGreater(pz + particleSize, extent_z);
+			pz = XMVectorSelect(pz, extent_z - particleSize, collision);
+			vz = XMVectorSelect(vz, vz * elastic, collision);
+			collision = XMVectorLess(pz - particleSize, -extent_z);
+			pz = XMVectorSelect(pz, -extent_z + particleSize, collision);
+			vz = XMVectorSelect(vz, vz * elastic, collision);
+		}
+
+		lf -= DT;
+
+		XMStoreFloat4((XMFLOAT4*)&cpu.position_x[i], px);
+		XMStoreFloat4((XMFLOAT4*)&cpu.position_y[i], py);
+		XMStoreFloat4((XMFLOAT4*)&cpu.position_z[i], pz);
+		XMStoreFloat4((XMFLOAT4*)&cpu.velocity_x[i], vx);
+		XMStoreFloat4((XMFLOAT4*)&cpu.velocity_y[i], vy);
+		XMStoreFloat4((XMFLOAT4*)&cpu.velocity_z[i], vz);
+		XMStoreFloat4((XMFLOAT4*)&cpu.force_x[i], ZERO); // reset force for next frame
+		XMStoreFloat4((XMFLOAT4*)&cpu.force_y[i], ZERO);
+		XMStoreFloat4((XMFLOAT4*)&cpu.force_z[i], ZERO);
+		XMStoreFloat4((XMFLOAT4*)&cpu.life[i], lf);
+
+		if (upload)
+		{
+			// Convert to the GPU particle layout:
+			const uint32_t end = std::min(i + 4, cpu.aliveCount);
+			for (uint32_t j = i; j < end; ++j)
+			{
+				cpu.gpu_particles[j] = cpu.GetParticle(j);
+			}
+			if (sorted)
+			{
+				// store squared distance to main camera:
+				const XMVECTOR ex = px - XMVectorReplicate(eye.x);
+				const XMVECTOR ey = py - XMVectorReplicate(eye.y);
+				const XMVECTOR ez = pz - XMVectorReplicate(eye.z);
+				XMFLOAT4 distSQ;
+				XMStoreFloat4(&distSQ, -(ex * ex + ey * ey + ez * ez)); // negated to match GPU sorting order
+				const float* dist = &distSQ.x;
+				for (uint32_t j = i; j < end; ++j)
+				{
+					cpu.gpu_distances[j] = dist[j - i];
+				}
+			}
+		}
+	});
+	wiJobSystem::Wait(ctx);
+
+	debugData.aliveCount = cpu.aliveCount;
+	debugData.deadCount = cpu.capacity - cpu.aliveCount;
+	debugData.realEmitCount = realEmitCount;
+	debugData.aliveCount_afterSimulation = cpu.aliveCount;
+}
+
+// Hashes a grid cell of the SPH partitioning into a compact table of [mask + 1] entries
+inline uint32_t SPH_CellHash(int x, int y, int z, uint32_t mask)
+{
+	return ((uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u) & mask;
+}
+// Stable parallel LSD radix sort of keys with the values carried along, the result is in keys and values
+//	temp must be 2 * count sized
+static void SPH_RadixSort(
+	std::vector<uint32_t>& keys,
+	std::vector<uint32_t>& values,
+	std::vector<uint32_t>& temp,
+	std::vector<uint32_t>& histograms,
+	uint32_t count,
+	uint32_t keyBits
+)
+{
+	static const uint32_t DIGIT_BITS = 11;
+	static const uint32_t RADIX = 1u << DIGIT_BITS;
+	static const uint32_t CHUNK_SIZE = 16384;
+
+	const uint32_t chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	histograms.resize(chunkCount * RADIX);
+
+	uint32_t* srcKeys = keys.data();
+	uint32_t* srcValues = values.data();
+	uint32_t* dstKeys = temp.data();
+	uint32_t* dstValues = temp.data() + count;
+
+	wiJobSystem::context ctx;
+	for (uint32_t shift = 0; shift < keyBits; shift += DIGIT_BITS)
+	{
+		// Count digits per chunk:
+		wiJobSystem::Dispatch(ctx, chunkCount, 1, [&](wiJobArgs args) {
+			uint32_t* histogram = &histograms[args.jobIndex * RADIX];
+			std::fill(histogram, histogram + RADIX, 0);
+			const uint32_t begin = args.jobIndex * CHUNK_SIZE;
+			const uint32_t end = std::min(begin + CHUNK_SIZE, count);
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				histogram[(srcKeys[i] >> shift) & (RADIX - 1)]++;
+			}
+		});
+		wiJobSystem::Wait(ctx);
+
+		// Prefix sum, digit major so that chunks keep their relative order (stable):
+		uint32_t offset = 0;
+		for (uint32_t digit = 0; digit < RADIX; ++digit)
+		{
+			for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				uint32_t& bucket = histograms[chunk * RADIX + digit];
+				const uint32_t bucketCount = bucket;
+				bucket = offset;
+				offset += bucketCount;
+			}
+		}
+
+		// Scatter:
+		wiJobSystem::Dispatch(ctx, chunkCount, 1, [&](wiJobArgs args) {
+			uint32_t* histogram = &histograms[args.jobIndex * RADIX];
+			const uint32_t begin = args.jobIndex * CHUNK_SIZE;
+			const uint32_t end = std::min(begin + CHUNK_SIZE, count);
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const uint32_t dst = histogram[(srcKeys[i] >> shift) & (RADIX - 1)]++;
+				dstKeys[dst] = srcKeys[i];
+				dstValues[dst] = srcValues[i];
+			}
+		});
+		wiJobSystem::Wait(ctx);
+
+		std::swap(srcKeys, dstKeys);
+		std::swap(srcValues, dstValues);
+	}
+
+	if (srcKeys != keys.data())
+	{
+		std::copy(srcKeys, srcKeys + count, keys.data());
+		std::copy(srcValues, srcValues + count, values.data());
+	}
+}
+void wiEmittedParticle::SolveSPH_CPU()
+{
+	const uint32_t count = cpu.aliveCount;
+	if (count == 0)
+	{
+		return;
+	}
+
+	// SPH params:
+	const float h = SPH_h;				// smoothing radius
+	const float h_rcp = 1.0f / h;
+	const float h2 = h * h;				// smoothing radius ^ 2
+	const float h3 = h2 * h;			// smoothing radius ^ 3
+	const float h6 = h2 * h2 * h2;
+	const float h9 = h6 * h3;
+	const float poly6_constant = (315.0f / (64.0f * XM_PI * h9));
+	const float spiky_constant = (-45.0f / (XM_PI * h6));
+	const float K = SPH_K;				// pressure constant
+	const float p0 = SPH_p0;			// reference density
+	const float e = SPH_e;				// viscosity constant
+
+	// The hash table has at least twice as many cells as particles, so that there are few collisions:
+	uint32_t keyBits = 10;
+	while ((1u << keyBits) < count * 2)
+	{
+		keyBits++;
+	}
+	const uint32_t tableSize = 1u << keyBits;
+	const uint32_t mask = tableSize - 1;
+
+	const size_t padded = count + 4; // SIMD loops can read past the last particle
+	cpu.sph_cellKeys.resize(count);
+	cpu.sph_sortedIndices.resize(count);
+	cpu.sph_sortTemp.resize(count * 2);
+	cpu.sph_cellStart.resize(tableSize);
+	cpu.sph_cellEnd.resize(tableSize);
+	for (std::vector<float>* stream : {
+		&cpu.sph_position_x, &cpu.sph_position_y, &cpu.sph_position_z,
+		&cpu.sph_velocity_x, &cpu.sph_velocity_y, &cpu.sph_velocity_z,
+		&cpu.sph_mass, &cpu.sph_density })
+	{
+		stream->resize(padded);
+	}
+
+	wiJobSystem::context ctx;
+	const uint32_t groupSize = 256;
+
+	// Partition particles into the hashed grid, grid cell is of size [SPH smoothing radius]:
+	wiJobSystem::Dispatch(ctx, count, groupSize, [&](wiJobArgs args) {
+		const uint32_t i = args.jobIndex;
+		cpu.sph_cellKeys[i] = SPH_CellHash(
+			(int)floorf(cpu.position_x[i] * h_rcp),
+			(int)floorf(cpu.position_y[i] * h_rcp),
+			(int)floorf(cpu.position_z[i] * h_rcp),
+			mask
+		);
+		cpu.sph_sortedIndices[i] = i;
+	});
+	std::fill(cpu.sph_cellStart.begin(), cpu.sph_cellStart.end(), ~0u);
+	wiJobSystem::Wait(ctx);
+
+	SPH_RadixSort(cpu.sph_cellKeys, cpu.sph_sortedIndices, cpu.sph_sortTemp, cpu.sph_histograms, count, keyBits);
+
+	// Gather sorted particle data and find the cell ranges:
+	wiJobSystem::Dispatch(ctx, count, groupSize, [&](wiJobArgs args) {
+		const uint32_t i = args.jobIndex;
+		const uint32_t index = cpu.sph_sortedIndices[i];
+		cpu.sph_position_x[i] = cpu.position_x[index];
+		cpu.sph_position_y[i] = cpu.position_y[index];
+		cpu.sph_position_z[i] = cpu.position_z[index];
+		cpu.sph_velocity_x[i] = cpu.velocity_x[index];
+		cpu.sph_velocity_y[i] = cpu.velocity_y[index];
+		cpu.sph_velocity_z[i] = cpu.velocity_z[index];
+		cpu.sph_mass[i] = cpu.mass[index];
+
+		const uint32_t key = cpu.sph_cellKeys[i];
+		if (i == 0 || cpu.sph_cellKeys[i - 1] != key)
+		{
+			cpu.sph_cellStart[key] = i;
+		}
+		if (i == count - 1 || cpu.sph_cellKeys[i + 1] != key)
+		{
+			cpu.sph_cellEnd[key] = i + 1;
+		}
+	});
+	wiJobSystem::Wait(ctx);
+
+	// Padding shouldn't contain garbage, but it will be masked out anyway:
+	for (size_t i = count; i < padded; ++i)
+	{
+		cpu.sph_position_x[i] = cpu.sph_position_y[i] = cpu.sph_position_z[i] = FLT_MAX;
+		cpu.sph_velocity_x[i] = cpu.sph_velocity_y[i] = cpu.sph_velocity_z[i] = 0;
+		cpu.sph_mass[i] = 0;
+		cpu.sph_density[i] = 1;
+	}
+
+	// Collects the unique hashed cells around a particle. Hash collisions can map multiple neighbor cells to the same table entry,
+	//	those must be only visited once, otherwise particles would contribute multiple times
+	auto gather_cells = [&](float x, float y, float z, uint32_t* cells) {
+		const int cx = (int)floorf(x * h_rcp);
+		const int cy = (int)floorf(y * h_rcp);
+		const int cz = (int)floorf(z * h_rcp);
+		uint32_t cellCount = 0;
+		for (int i = -1; i <= 1; ++i)
+		{
+			for (int j = -1; j <= 1; ++j)
+			{
+				for (int k = -1; k <= 1; ++k)
+				{
+					const uint32_t cell = SPH_CellHash(cx + i, cy + j, cz + k, mask);
+					if (cpu.sph_cellStart[cell] == ~0u)
+						continue;
+					bool unique = true;
+					for (uint32_t c = 0; c < cellCount; ++c)
+					{
+						if (cells[c] == cell)
+						{
+							unique = false;
+							break;
+						}
+					}
+					if (unique)
+					{
+						cells[cellCount++] = cell;
+					}
+				}
+			}
+		}
+		return cellCount;
+	};
+
+	const XMVECTOR LANES = XMVectorSet(0, 1, 2, 3);
+
+	// Compute density field:
+	wiJobSystem::Dispatch(ctx, count, groupSize, [&](wiJobArgs args) {
+		const uint32_t a = args.jobIndex;
+		const XMVECTOR ax = XMVectorReplicate(cpu.sph_position_x[a]);
+		const XMVECTOR ay = XMVectorReplicate(cpu.sph_position_y[a]);
+		const XMVECTOR az = XMVectorReplicate(cpu.sph_position_z[a]);
+		const XMVECTOR H2 = XMVectorReplicate(h2);
+
+		XMVECTOR density = XMVectorZero(); // (p)
+
+		uint32_t cells[27];
+		const uint32_t cellCount = gather_cells(cpu.sph_position_x[a], cpu.sph_position_y[a], cpu.sph_position_z[a], cells);
+		for (uint32_t c = 0; c < cellCount; ++c)
+		{
+			const uint32_t start = cpu.sph_cellStart[cells[c]];
+			const uint32_t end = cpu.sph_cellEnd[cells[c]];
+			const XMVECTOR END = XMVectorReplicate((float)end);
+
+			// 4 neighbors at once:
+			for (uint32_t b = start; b < end; b += 4)
+			{
+				const XMVECTOR dx = ax - XMLoadFloat4((const XMFLOAT4*)&cpu.sph_position_x[b]);
+				const XMVECTOR dy = ay - XMLoadFloat4((const XMFLOAT4*)&cpu.sph_position_y[b]);
+				const XMVECTOR dz = az - XMLoadFloat4((const XMFLOAT4*)&cpu.sph_position_z[b]);
+				const XMVECTOR r2 = dx * dx + dy * dy + dz * dz; // distance squared
+
+				const XMVECTOR valid = XMVectorAndInt(
+					XMVectorLess(XMVectorReplicate((float)b) + LANES, END),
+					XMVectorLess(r2, H2)
+				);
+
+				const XMVECTOR t = H2 - r2;
+				const XMVECTOR W = XMVectorReplicate(poly6_constant) * t * t * t; // poly6 smoothing kernel
+
+				density += XMVectorSelect(XMVectorZero(), XMLoadFloat4((const XMFLOAT4*)&cpu.sph_mass[b]) * W, valid);
+			}
+		}
+
+		// Can't be lower than reference density to avoid negative pressure!
+		cpu.sph_density[a] = std::max(p0, XMVectorGetX(XMVectorSum(density)));
+	});
+	wiJobSystem::Wait(ctx);
+
+	// Compute pressure and viscosity forces:
+	wiJobSystem::Dispatch(ctx, count, groupSize, [&](wiJobArgs args) {
+		const uint32_t a = args.jobIndex;
+		const XMVECTOR ax = XMVectorReplicate(cpu.sph_position_x[a]);
+		const XMVECTOR ay = XMVectorReplicate(cpu.sph_position_y[a]);
+		const XMVECTOR az = XMVectorReplicate(cpu.sph_position_z[a]);
+		const XMVECTOR avx = XMVectorReplicate(cpu.sph_velocity_x[a]);
+		const XMVECTOR avy = XMVectorReplicate(cpu.sph_velocity_y[a]);
+		const XMVECTOR avz = XMVectorReplicate(cpu.sph_velocity_z[a]);
+		const float densityA = cpu.sph_density[a];
+		const XMVECTOR DENSITY_A = XMVectorReplicate(densityA);
+		const XMVECTOR PRESSURE_A = XMVectorReplicate(K * (densityA - p0));
+		const XMVECTOR MASS_A_RCP = XMVectorReplicate(1.0f / cpu.sph_mass[a]);
+		const XMVECTOR ZERO = XMVectorZero();
+		const XMVECTOR H = XMVectorReplicate(h);
+		const XMVECTOR H2_RCP = XMVectorReplicate(1.0f / h2);
+		const XMVECTOR H3_2_RCP = XMVectorReplicate(1.0f / (2 * h3));
+		const XMVECTOR HALF_H = XMVectorReplicate(h * 0.5f);
+		const XMVECTOR K_V = XMVectorReplicate(K);
+		const XMVECTOR P0_V = XMVectorReplicate(p0);
+		const XMVECTOR SPIKY = XMVectorReplicate(spiky_constant);
+
+		XMVECTOR fa_x = ZERO, fa_y = ZERO, fa_z = ZERO;		// pressure force
+		XMVECTOR fav_x = ZERO, fav_y = ZERO, fav_z = ZERO;	// viscosity force
+
+		uint32_t cells[27];
+		const uint32_t cellCount = gather_cells(cpu.sph_position_x[a], cpu.sph_position_y[a], cpu.sph_position_z[a], cells);
+		for (uint32_t c = 0; c < cellCount; ++c)
+		{
+			const uint32_t start = cpu.sph_cellStart[cells[c]];
+			const uint32_t end = cpu.sph_cellEnd[cells[c]];
+			const XMVECTOR END = XMVectorReplicate((float)end);
+
+			// 4 neighbors at once:
+			for (uint32_t b = start; b < end; b += 4)
+			{
+				const XMVECTOR dx = ax - XMLoadFloat4((const XMFLOAT4*)&cpu.sph_position_x[b]);
+				const XMVECTOR dy = ay - XMLoadFloat4((const XMFLOAT4*)&cpu.sph_position_y[b]);
+				const XMVECTOR dz = az - XMLoadFloat4((const XMFLOAT4*)&cpu.sph_position_z[b]);
+				const XMVECTOR r2 = dx * dx + dy * dy + dz * dz; // distance squared
+				const XMVECTOR r = XMVectorSqrt(r2);
+
+				// avoid division by zero (this also skips the particle itself):
+				const XMVECTOR valid = XMVectorAndInt(
+					XMVectorLess(XMVectorReplicate((float)b) + LANES, END),
+					XMVectorAndInt(XMVectorGreater(r, ZERO), XMVectorLess(r, H))
+				);
+				if (XMVector4EqualInt(valid, XMVectorFalseInt()))
+					continue;
+
+				const XMVECTOR r_rcp = XMVectorSelect(ZERO, XMVectorReciprocal(r), valid); // masked, because 0 * inf would be NaN
+				const XMVECTOR nx = dx * r_rcp;
+				const XMVECTOR ny = dy * r_rcp;
+				const XMVECTOR nz = dz * r_rcp;
+
+				const XMVECTOR densityB = XMLoadFloat4((const XMFLOAT4*)&cpu.sph_density[b]);
+				const XMVECTOR pressureB = K_V * (densityB - P0_V);
+				const XMVECTOR mass = XMLoadFloat4((const XMFLOAT4*)&cpu.sph_mass[b]) * MASS_A_RCP;
+
+				const XMVECTOR hr = H - r;
+				XMVECTOR W = SPIKY * hr * hr; // spiky kernel smoothing function
+				const XMVECTOR pressure_term = XMVectorSelect(ZERO, mass * ((PRESSURE_A + pressureB) / (XMVectorReplicate(2) * DENSITY_A * densityB)) * W, valid);
+				fa_x += pressure_term * nx;
+				fa_y += pressure_term * ny;
+				fa_z += pressure_term * nz;
+
+				const XMVECTOR r3 = r2 * r;
+				W = -(r3 * H3_2_RCP) + (r2 * H2_RCP) + (HALF_H * r_rcp) - XMVectorSplatOne(); // laplacian smoothing function
+				const XMVECTOR viscosity_term = XMVectorSelect(ZERO, mass * W / densityB, valid);
+				fav_x += viscosity_term * (XMLoadFloat4((const XMFLOAT4*)&cpu.sph_velocity_x[b]) - avx) * nx;
+				fav_y += viscosity_term * (XMLoadFloat4((const XMFLOAT4*)&cpu.sph_velocity_y[b]) - avy) * ny;
+				fav_z += viscosity_term * (XMLoadFloat4((const XMFLOAT4*)&cpu.sph_velocity_z[b]) - avz) * nz;
+			}
+		}
+
+		// gravity:
+		const XMFLOAT3 G = XMFLOAT3(0, -9.8f * 2, 0);
+
+		// apply all forces:
+		const float densityA_rcp = 1.0f / densityA;
+		const uint32_t index = cpu.sph_sortedIndices[a];
+		cpu.force_x[index] += (-XMVectorGetX(XMVectorSum(fa_x)) + e * XMVectorGetX(XMVectorSum(fav_x))) * densityA_rcp + G.x;
+		cpu.force_y[index] += (-XMVectorGetX(XMVectorSum(fa_y)) + e * XMVectorGetX(XMVectorSum(fav_y))) * densityA_rcp + G.y;
+		cpu.force_z[index] += (-XMVectorGetX(XMVectorSum(fa_z)) + e * XMVectorGetX(XMVectorSum(fav_z))) * densityA_rcp + G.z;
+	});
+	wiJobSystem::Wait(ctx);
+}
 
 //#define DEBUG_SORTING // slow but great for debug!!
 void wiEmittedParticle::UpdateGPU(const TransformComponent& transform, const MaterialComponent& material, const MeshComponent* mesh, CommandList cmd) const
@@ -299,6 +1084,36 @@ void wiEmittedParticle::UpdateGPU(const TransformComponent& transform, const Mat
 		device->UpdateBuffer(&constantBuffer, &cb, cmd);
 		device->BindConstantBuffer(CS, &constantBuffer, CB_GETBINDSLOT(EmittedParticleCB), cmd);
 
+		if (IsCPUSimulationEnabled())
+		{
+			// The simulation was performed on the CPU, only the results are uploaded:
+			device->EventBegin("Upload CPU Simulation", cmd);
+
+			ParticleCounters counters;
+			counters.aliveCount = debugData.aliveCount;
+			counters.deadCount = debugData.deadCount;
+			counters.realEmitCount = debugData.realEmitCount;
+			counters.aliveCount_afterSimulation = debugData.aliveCount_afterSimulation;
+
+			const uint32_t particleCount = std::min(cpu.aliveCount, (uint32_t)cpu.gpu_particles.size());
+			if (particleCount > 0)
+			{
+				device->UpdateBuffer(&particleBuffer, cpu.gpu_particles.data(), cmd, int(sizeof(Particle) * particleCount));
+				device->UpdateBuffer(&aliveList[1], cpu.gpu_aliveList.data(), cmd, int(sizeof(uint32_t) * particleCount)); // NEW alivelist
+				if (IsSorted())
+				{
+					device->UpdateBuffer(&distanceBuffer, cpu.gpu_distances.data(), cmd, int(sizeof(float) * particleCount));
+				}
+			}
+			device->UpdateBuffer(&counterBuffer, &counters, cmd);
+
+			device->EventEnd(cmd);
+			device->EventEnd(cmd); // UpdateEmittedParticles
+
+			FinishUpdateGPU(cmd);
+			return;
+		}
+
 		const GPUResource* uavs[] = {
 			&particleBuffer,
 			&aliveList[0], // CURRENT alivelist
@@ -481,6 +1296,13 @@ void wiEmittedParticle::UpdateGPU(const TransformComponent& transform, const Mat
 
 	}
 
+	FinishUpdateGPU(cmd);
+}
+
+void wiEmittedParticle::FinishUpdateGPU(CommandList cmd) const
+{
+	GraphicsDevice* device = wiRenderer::GetDevice();
+
 	if (IsSorted())
 	{
 #ifdef DEBUG_SORTING
@@ -8,6 +8,7 @@
 #include "wiECS.h"
 
 #include <memory>
+#include <vector>
 
 class wiArchive;
 
@@ -46,6 +47,8 @@ private:
 	wiGraphics::GPUBuffer indirectBuffers; // kickoffUpdate, simulation, draw
 	wiGraphics::GPUBuffer constantBuffer;
 	void CreateSelfBuffers();
+	// Sorts the particles and updates the draw arguments, it is called by UpdateGPU() after the simulation
+	void FinishUpdateGPU(wiGraphics::CommandList cmd) const;
 
 	float emit = 0.0f;
 	int burst = 0;
@@ -53,16 +56,88 @@ private:
 	bool buffersUpToDate = false;
 	uint32_t MAX_PARTICLES = 1000;
 
+public:
+
+	// Particle pool of the CPU simulation backend in structure of arrays layout
+	//	The pool is kept compacted: alive particles always occupy the first aliveCount slots, in alive list order
+	//	The arrays are padded to a multiple of 4, so the simulation can process 4 particles at once with SIMD
+	struct CPUParticleData
+	{
+		uint32_t capacity = 0;
+		uint32_t aliveCount = 0;
+		uint32_t frame = 0;
+
+		std::vector<float> position_x;
+		std::vector<float> position_y;
+		std::vector<float> position_z;
+		std::vector<float> velocity_x;
+		std::vector<float> velocity_y;
+		std::vector<float> velocity_z;
+		std::vector<float> force_x;
+		std::vector<float> force_y;
+		std::vector<float> force_z;
+		std::vector<float> mass;
+		std::vector<float> rotationalVelocity;
+		std::vector<float> maxLife;
+		std::vector<float> life;
+		std::vector<float> sizeBegin;
+		std::vector<float> sizeEnd;
+		std::vector<uint32_t> color_mirror;
+
+		// GPU upload data, matches the GPU particle buffer layout:
+		std::vector<Particle> gpu_particles;
+		std::vector<uint32_t> gpu_aliveList;
+		std::vector<float> gpu_distances;
+
+		// SPH solver data, particles are sorted by their hashed grid cell:
+		std::vector<uint32_t> sph_cellKeys;		// hashed cell per sorted particle
+		std::vector<uint32_t> sph_sortedIndices;	// sorted particle -> pool slot
+		std::vector<uint32_t> sph_sortTemp;		// radix sort ping-pong buffer for keys and indices
+		std::vector<uint32_t> sph_histograms;		// radix sort per-chunk digit counters
+		std::vector<uint32_t> sph_cellStart;		// first sorted particle in hashed cell (or ~0u if empty)
+		std::vector<uint32_t> sph_cellEnd;		// one past the last sorted particle in hashed cell
+		std::vector<float> sph_position_x;		// sorted copies, padded for SIMD neighbor loops
+		std::vector<float> sph_position_y;
+		std::vector<float> sph_position_z;
+		std::vector<float> sph_velocity_x;
+		std::vector<float> sph_velocity_y;
+		std::vector<float> sph_velocity_z;
+		std::vector<float> sph_mass;
+		std::vector<float> sph_density;
+
+		void Reset(uint32_t maxParticleCount);
+		// Copies particle from one slot to an other:
+		void Move(uint32_t index_from, uint32_t index_to);
+		Particle GetParticle(uint32_t index) const;
+	};
+
+private:
+	CPUParticleData cpu;
+
 public:
 	void UpdateCPU(const TransformComponent& transform, float dt);
+	// Performs emission and simulation on the CPU, only if CPU simulation is enabled. The result will be uploaded to the GPU in UpdateGPU()
+	void SimulateCPU(
+		const TransformComponent& transform,
+		const MaterialComponent& material,
+		const MeshComponent* mesh,
+		const wiECS::ComponentManager<ForceFieldComponent>& forces,
+		float dt
+	);
+	// Computes SPH fluid forces for the CPU particle pool, it is called by SimulateCPU() when SPH is enabled
+	void SolveSPH_CPU();
 	void Burst(int num);
 	void Restart();
+	// Copies everything that is needed to render the other emitter, but not the state of the CPU simulation
+	void CopyForRendering(const wiEmittedParticle& other);
 
 	// Must have a transform and material component, but mesh is optional
 	void UpdateGPU(const TransformComponent& transform, const MaterialComponent& material, const MeshComponent* mesh, wiGraphics::CommandList cmd) const;
 	void Draw(const CameraComponent& camera, const MaterialComponent& material, wiGraphics::CommandList cmd) const;
 
 	ParticleCounters GetDebugData() { return debugData; }
+	// Particle state of the CPU simulation (only valid if CPU simulation is enabled)
+	const CPUParticleData& GetCPUParticleData() const { return cpu; }
 
 	enum FLAGS
 	{
@@ -74,6 +149,7 @@ public:
 		SPH_FLUIDSIMULATION = 1 << 4,
 		HAS_VOLUME = 1 << 5,
 		FRAME_BLENDING = 1 << 6,
+		CPU_SIMULATION = 1 << 7,
 	};
 	uint32_t _flags = EMPTY;
 
@@ -121,6 +197,7 @@ public:
 	inline bool IsSPHEnabled() const { return _flags & SPH_FLUIDSIMULATION; }
 	inline bool IsVolumeEnabled() const { return _flags & HAS_VOLUME; }
 	inline bool IsFrameBlendingEnabled() const { return _flags & FRAME_BLENDING; }
+	inline bool IsCPUSimulationEnabled() const { return _flags & CPU_SIMULATION; }
 
 	inline void SetDebug(bool value) { if (value) { _flags |= DEBUG; } else { _flags &= ~DEBUG; } }
 	inline void SetPaused(bool value) { if (value) { _flags |= PAUSED; } else { _flags &= ~PAUSED; } }
@@ -129,6 +206,7 @@ public:
 	inline void SetSPHEnabled(bool value) { if (value) { _flags |= SPH_FLUIDSIMULATION; } else { _flags &= ~SPH_FLUIDSIMULATION; } }
 	inline void SetVolumeEnabled(bool value) { if (value) { _flags |= HAS_VOLUME; } else { _flags &= ~HAS_VOLUME; } }
 	inline void SetFrameBlendingEnabled(bool value) { if (value) { _flags |= FRAME_BLENDING; } else { _flags &= ~FRAME_BLENDING; } }
+	inline void SetCPUSimulationEnabled(bool value) { if (value != IsCPUSimulationEnabled()) { buffersUpToDate = false; cpu.capacity = 0; } if (value) { _flags |= CPU_SIMULATION; } else { _flags &= ~CPU_SIMULATION; } }
 
 	void Serialize(wiArchive& archive, wiECS::Entity seed = wiECS::INVALID_ENTITY);
 
@@ -6,9 +6,11 @@
 #include "ShaderInterop_Font.h"
 #include "wiBackLog.h"
 #include "wiTextureHelper.h"
-#include "wiRectPacker.h"
 #include "wiSpinLock.h"
 #include "wiPlatform.h"
+#include "wiJobSystem.h"
+#include "wiInitializer.h"
+#include "wiGUIBatch.h"
 
 #include "Utility/stb_truetype.h"
 
@@ -19,10 +21,11 @@
 #include <unordered_set>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <climits>
 
 using namespace std;
 using namespace wiGraphics;
-using namespace wiRectPacker;
 
 #define MAX_TEXT 10000
 #define WHITESPACE_SIZE ((float(params.size) + params.spacingX) * params.scaling * 0.25f)
@@ -44,9 +47,135 @@ namespace wiFont_Internal
 	Shader				pixelShader;
 	PipelineState		PSO;
 
+	Shader				uploadShader;
+	GPUBuffer			uploadConstantBuffer;
+
 	atomic_bool initialized { false };
 
-	Texture texture;
+	// Skyline bin packer, places new rectangles without touching the existing ones:
+	struct SkylinePacker
+	{
+		struct Node
+		{
+			int x, y, width;
+		};
+		vector<Node> skyline;
+		int width = 0;
+		int height = 0;
+
+		void Reset(int newWidth, int newHeight)
+		{
+			width = newWidth;
+			height = newHeight;
+			skyline.clear();
+			skyline.push_back({ 0, 0, width });
+		}
+		// Returns the lowest y where rect can be placed starting on skyline node, or -1 if it doesn't fit
+		int Fit(size_t index, int w, int h) const
+		{
+			if (skyline[index].x + w > width)
+			{
+				return -1;
+			}
+			int y = skyline[index].y;
+			int widthLeft = w;
+			while (widthLeft > 0)
+			{
+				y = std::max(y, skyline[index].y);
+				if (y + h > height)
+				{
+					return -1;
+				}
+				widthLeft -= skyline[index].width;
+				index++;
+			}
+			return y;
+		}
+		// Allocates a rectangle with the bottom-left rule. Returns false if it doesn't fit
+		bool Allocate(int w, int h, int& out_x, int& out_y)
+		{
+			int best_bottom = INT_MAX;
+			int best_width = INT_MAX;
+			size_t best_index = ~0ull;
+			for (size_t i = 0; i < skyline.size(); ++i)
+			{
+				const int y = Fit(i, w, h);
+				if (y >= 0 && (y + h < best_bottom || (y + h == best_bottom && skyline[i].width < best_width)))
+				{
+					best_bottom = y + h;
+					best_width = skyline[i].width;
+					best_index = i;
+					out_x = skyline[i].x;
+					out_y = y;
+				}
+			}
+			if (best_index == ~0ull)
+			{
+				return false;
+			}
+
+			// Insert the new skyline segment and shrink the ones that it covers:
+			skyline.insert(skyline.begin() + best_index, { out_x, out_y + h, w });
+			for (size_t i = best_index + 1; i < skyline.size(); ++i)
+			{
+				const Node& prev = skyline[i - 1];
+				Node& node = skyline[i];
+				if (node.x >= prev.x + prev.width)
+				{
+					break;
+				}
+				const int shrink = prev.x + prev.width - node.x;
+				node.x += shrink;
+				node.width -= shrink;
+				if (node.width > 0)
+				{
+					break;
+				}
+				skyline.erase(skyline.begin() + i);
+				--i;
+			}
+
+			// Merge segments at the same level:
+			for (size_t i = 0; i + 1 < skyline.size(); ++i)
+			{
+				if (skyline[i].y == skyline[i + 1].y)
+				{
+					skyline[i].width += skyline[i + 1].width;
+					skyline.erase(skyline.begin() + i + 1);
+					--i;
+				}
+			}
+			return true;
+		}
+	};
+
+	// The atlas consists of fixed size pages, glyphs are only ever added to pages incrementally.
+	//	When all pages are full, the least recently used page is evicted
+	static const int ATLAS_PAGE_SIZE = 2048;
+	static const uint32_t ATLAS_MAX_PAGES = 4;
+	struct AtlasPage
+	{
+		Texture texture;
+		vector<uint8_t> bitmap;
+		SkylinePacker packer;
+		int dirty_left = INT_MAX, dirty_top = INT_MAX, dirty_right = 0, dirty_bottom = 0;
+		std::atomic<uint32_t> lastUsedFrame{ 0 };
+
+		void Reset()
+		{
+			bitmap.clear();
+			bitmap.resize(size_t(ATLAS_PAGE_SIZE) * size_t(ATLAS_PAGE_SIZE), 0);
+			packer.Reset(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+			dirty_left = INT_MAX;
+			dirty_top = INT_MAX;
+			dirty_right = 0;
+			dirty_bottom = 0;
+		}
+		bool IsDirty() const { return dirty_left < dirty_right; }
+	};
+	AtlasPage pages[ATLAS_MAX_PAGES];
+	uint32_t pageCount = 0;
+	std::atomic<uint32_t> atlasFrame{ 1 };
 
 	struct Glyph
 	{
@@ -58,9 +187,9 @@ namespace wiFont_Internal
 		uint16_t tc_right;
 		uint16_t tc_top;
 		uint16_t tc_bottom;
+		uint32_t page;
 	};
 	unordered_map<int32_t, Glyph> glyph_lookup;
-	unordered_map<int32_t, rect_xywh> rect_lookup;
 	// pack glyph identifiers to a 32-bit hash:
 	//	height:	10 bits	(height supported: 0 - 1023)
 	//	style:	6 bits	(number of font styles supported: 0 - 63)
@@ -98,15 +227,12 @@ namespace wiFont_Internal
 	};
 	std::vector<wiFontStyle> fontStyles;
 
-	struct FontVertex
-	{
-		XMFLOAT2 Pos;
-		XMHALF2 Tex;
-	};
+	typedef wiFontVertex FontVertex;
 
 	template<typename T>
-	uint32_t WriteVertices(volatile FontVertex* vertexList, const T* text, wiFontParams params)
+	uint32_t WriteVertices(FontVertex* vertexList, uint8_t* quadPages, const T* text, wiFontParams params, bool& complete)
 	{
+		complete = true;
 		uint32_t quadCount = 0;
 		float line = 0;
 		float pos = 0;
@@ -132,17 +258,20 @@ namespace wiFont_Internal
 
 		int code_prev = 0;
 		size_t i = 0;
+
+		// UpdateAtlas() can evict glyphs from an other thread, so the lookup is locked for the whole text:
+		glyphLock.lock();
 		while(text[i] != 0)
 		{
 			int code = (int)text[i++];
 			const int32_t hash = glyphhash(code, params.style, params.size);
 
-			if (glyph_lookup.count(hash) == 0)
+			auto it = glyph_lookup.find(hash);
+			if (it == glyph_lookup.end())
 			{
 				// glyph not packed yet, so add to pending list:
-				glyphLock.lock();
+				complete = false;
 				pendingGlyphs.insert(hash);
-				glyphLock.unlock();
 				continue;
 			}
 
@@ -169,7 +298,7 @@ namespace wiFont_Internal
 			}
 			else
 			{
-				const Glyph& glyph = glyph_lookup.at(hash);
+				const Glyph& glyph = it->second;
 				const float glyphWidth = glyph.width * params.scaling;
 				const float glyphHeight = glyph.height * params.scaling;
 				const float glyphOffsetX = glyph.x * params.scaling;
@@ -214,6 +343,9 @@ namespace wiFont_Internal
 				vertexList[vertexID + 3].Tex.x = glyph.tc_right;
 				vertexList[vertexID + 3].Tex.y = glyph.tc_bottom;
 
+				quadPages[quadCount] = (uint8_t)glyph.page;
+				pages[glyph.page].lastUsedFrame.store(atlasFrame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
 				pos += glyph.width * params.scaling + params.spacingX;
 				pos_last_letter = pos;
 
@@ -221,12 +353,187 @@ namespace wiFont_Internal
 			}
 
 		}
+		glyphLock.unlock();
 
 		word_wrap();
 
 		return quadCount;
 	}
 
+	// Positioned glyph run of a text, relative to the text origin and without color.
+	//	Layouts stay valid until glyphs are removed from the atlas (eviction or DPI change)
+	struct TextLayout
+	{
+		wstring text;
+		wiFontParams params;
+		vector<FontVertex> vertices;
+		vector<uint8_t> quadPages;
+		uint32_t pageMask = 0;
+		float width = 0;
+		float height = 0;
+		uint32_t lastUsedFrame = 0;
+	};
+	unordered_map<uint64_t, TextLayout> layoutCache;
+	wiSpinLock layoutLock;
+	uint32_t atlasGeneration = 0; // incremented when glyphs are removed from the atlas
+	static const uint32_t LAYOUT_CACHE_LIFETIME = 60; // frames that an unused layout is kept for
+
+	// Must be called when glyphs are removed from the atlas, because layouts reference their texture coordinates
+	void InvalidateLayouts()
+	{
+		layoutLock.lock();
+		atlasGeneration++;
+		layoutCache.clear();
+		layoutLock.unlock();
+	}
+
+	template<typename T>
+	uint64_t layouthash(const T* text, size_t text_length, const wiFontParams& params)
+	{
+		// FNV-1a over the characters and the parameters that affect glyph placement:
+		uint64_t hash = 14695981039346656037ull;
+		auto combine = [&](uint64_t value) {
+			hash ^= value;
+			hash *= 1099511628211ull;
+		};
+		auto combine_float = [&](float value) {
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			combine(bits);
+		};
+		for (size_t i = 0; i < text_length; ++i)
+		{
+			combine(uint64_t(text[i]));
+		}
+		combine(uint64_t(params.style));
+		combine(uint64_t(params.size));
+		combine_float(params.scaling);
+		combine_float(params.h_wrap);
+		combine_float(params.spacingX);
+		combine_float(params.spacingY);
+		return hash;
+	}
+	template<typename T>
+	bool layoutmatch(const TextLayout& layout, const T* text, size_t text_length, const wiFontParams& params)
+	{
+		if (layout.text.length() != text_length ||
+			layout.params.style != params.style ||
+			layout.params.size != params.size ||
+			layout.params.scaling != params.scaling ||
+			layout.params.h_wrap != params.h_wrap ||
+			layout.params.spacingX != params.spacingX ||
+			layout.params.spacingY != params.spacingY)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < text_length; ++i)
+		{
+			if (layout.text[i] != (wchar_t)text[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Glyph quads of consecutive Draw() calls are gathered per command list and drawn together
+	struct FontBatch
+	{
+		vector<FontVertex> vertices;
+		vector<uint8_t> quadPages;
+		int depth = 0;
+	};
+	FontBatch batches[COMMANDLIST_COUNT];
+
+	std::atomic<uint32_t> statDrawCalls{ 0 };
+	std::atomic<uint32_t> statLayoutCacheHits{ 0 };
+	std::atomic<uint32_t> statLayoutCacheMisses{ 0 };
+
+	void AppendQuads(vector<FontVertex>& dstVertices, vector<uint8_t>& dstQuadPages, const FontVertex* vertices, const uint8_t* quadPages, uint32_t quadCount, float posX, float posY, uint32_t color)
+	{
+		const size_t vertexOffset = dstVertices.size();
+		dstVertices.resize(vertexOffset + size_t(quadCount) * 4);
+		FontVertex* dst = dstVertices.data() + vertexOffset;
+		for (uint32_t i = 0; i < quadCount * 4; ++i)
+		{
+			dst[i].Pos.x = vertices[i].Pos.x + posX;
+			dst[i].Pos.y = vertices[i].Pos.y + posY;
+			dst[i].Tex = vertices[i].Tex;
+			dst[i].Color = color;
+		}
+		dstQuadPages.insert(dstQuadPages.end(), quadPages, quadPages + quadCount);
+	}
+
+	void FlushBatch(FontBatch& batch, CommandList cmd)
+	{
+		if (batch.quadPages.empty())
+		{
+			return;
+		}
+
+		GraphicsDevice* device = wiRenderer::GetDevice();
+
+		const uint32_t quadCount = (uint32_t)batch.quadPages.size();
+		GraphicsDevice::GPUAllocation mem = device->AllocateGPU(sizeof(FontVertex) * quadCount * 4, cmd);
+		if (!mem.IsValid())
+		{
+			batch.vertices.clear();
+			batch.quadPages.clear();
+			return;
+		}
+		memcpy(mem.data, batch.vertices.data(), sizeof(FontVertex) * quadCount * 4);
+
+		device->EventBegin("Font", cmd);
+
+		device->BindPipelineState(&PSO, cmd);
+
+		FontCB cb;
+		XMStoreFloat4x4(&cb.g_xFont_Transform, device->GetScreenProjection());
+		device->UpdateBuffer(&constantBuffer, &cb, cmd);
+
+		device->BindConstantBuffer(VS, &constantBuffer, CB_GETBINDSLOT(FontCB), cmd);
+		device->BindSampler(PS, &sampler, SSLOT_ONDEMAND1, cmd);
+
+		const GPUBuffer* vbs[] = {
+			mem.buffer,
+		};
+		const uint32_t strides[] = {
+			sizeof(FontVertex),
+		};
+		const uint32_t offsets[] = {
+			mem.offset,
+		};
+		device->BindVertexBuffers(vbs, 0, arraysize(vbs), strides, offsets, cmd);
+		device->BindIndexBuffer(&indexBuffer, INDEXFORMAT_16BIT, 0, cmd);
+
+		// One draw call for every run of quads using the same atlas page, the draw order is kept.
+		//	A draw can't reference more quads than the index buffer has
+		uint32_t boundPage = ~0u;
+		uint32_t runStart = 0;
+		while (runStart < quadCount)
+		{
+			const uint32_t page = batch.quadPages[runStart];
+			uint32_t runEnd = runStart + 1;
+			while (runEnd < quadCount && runEnd - runStart < MAX_TEXT && batch.quadPages[runEnd] == page)
+			{
+				runEnd++;
+			}
+			if (page != boundPage)
+			{
+				device->BindResource(PS, &pages[page].texture, TEXSLOT_FONTATLAS, cmd);
+				boundPage = page;
+			}
+			device->DrawIndexed((runEnd - runStart) * 6, 0, runStart * 4, cmd);
+			statDrawCalls.fetch_add(1, std::memory_order_relaxed);
+			runStart = runEnd;
+		}
+
+		device->EventEnd(cmd);
+
+		batch.vertices.clear();
+		batch.quadPages.clear();
+	}
+
 }
 using namespace wiFont_Internal;
 
@@ -279,6 +586,9 @@ void Initialize()
 		bd.CPUAccessFlags = CPU_ACCESS_WRITE;
 
 		device->CreateBuffer(&bd, nullptr, &constantBuffer);
+
+		bd.ByteWidth = sizeof(FontUploadCB);
+		device->CreateBuffer(&bd, nullptr, &uploadConstantBuffer);
 	}
 
 
@@ -342,6 +652,7 @@ void LoadShaders()
 	{
 		{ "POSITION", 0, FORMAT_R32G32_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_VERTEX_DATA, 0 },
 		{ "TEXCOORD", 0, FORMAT_R16G16_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, FORMAT_R8G8B8A8_UNORM, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_VERTEX_DATA, 0 },
 	};
 	wiRenderer::LoadShader(VS, vertexShader, "fontVS.cso");
 	wiRenderer::GetDevice()->CreateInputLayout(layout, arraysize(layout), &vertexShader, &inputLayout);
@@ -349,6 +660,8 @@ void LoadShaders()
 
 	wiRenderer::LoadShader(PS, pixelShader, "fontPS.cso");
 
+	wiRenderer::LoadShader(CS, uploadShader, "fontUploadCS.cso");
+
 
 	PipelineStateDesc desc;
 	desc.vs = &vertexShader;
@@ -360,10 +673,9 @@ void LoadShaders()
 	wiRenderer::GetDevice()->CreatePipelineState(&desc, &PSO);
 }
 
+// Places and rasterizes the pending glyphs into the atlas pages, only the new glyphs are processed
 void UpdatePendingGlyphs()
 {
-	glyphLock.lock();
-
 	static int saved_dpi = wiPlatform::GetDPI();
 	int dpi = wiPlatform::GetDPI();
 	if (saved_dpi != dpi)
@@ -375,126 +687,328 @@ void UpdatePendingGlyphs()
 			pendingGlyphs.insert(x.first);
 		}
 		glyph_lookup.clear();
-		rect_lookup.clear();
+		for (uint32_t i = 0; i < pageCount; ++i)
+		{
+			pages[i].Reset();
+		}
+		InvalidateLayouts();
 	}
 
-	// If there are pending glyphs, render them and repack the atlas:
-	if (!pendingGlyphs.empty())
+	if (pendingGlyphs.empty())
 	{
-		// Pad the glyph rects in the atlas to avoid bleeding from nearby texels:
-		const int borderPadding = 1;
-
-		// Font resolution is DPI upscaled:
-		const float dpiscaling = wiPlatform::GetDPIScaling();
+		return;
+	}
 
-		for (int32_t hash : pendingGlyphs)
-		{
-			const int code = codefromhash(hash);
-			const int style = stylefromhash(hash);
-			const float height = (float)heightfromhash(hash) * dpiscaling;
-			wiFontStyle& fontStyle = fontStyles[style];
+	// Pad the glyph rects in the atlas to avoid bleeding from nearby texels:
+	const int borderPadding = 1;
 
-			float fontScaling = stbtt_ScaleForPixelHeight(&fontStyle.fontInfo, height);
-			fontStyle.fontScaling = fontScaling / dpiscaling;
+	// Font resolution is DPI upscaled:
+	const float dpiscaling = wiPlatform::GetDPIScaling();
 
-			// get bounding box for character (may be offset to account for chars that dip above or below the line
-			int left, top, right, bottom;
-			stbtt_GetCodepointBitmapBox(&fontStyle.fontInfo, code, fontScaling, fontScaling, &left, &top, &right, &bottom);
+	struct NewGlyph
+	{
+		int32_t hash;
+		float fontScaling;
+		int x, y, w, h; // placement in page without padding
+		uint32_t page;
+	};
+	vector<NewGlyph> newGlyphs;
+	newGlyphs.reserve(pendingGlyphs.size());
 
-			// Glyph dimensions are calculated without padding:
-			Glyph& glyph = glyph_lookup[hash];
-			glyph.x = float(left);
-			glyph.y = float(top) + float(fontStyle.ascent) * fontScaling;
-			glyph.width = float(right - left);
-			glyph.height = float(bottom - top);
+	for (int32_t hash : pendingGlyphs)
+	{
+		const int code = codefromhash(hash);
+		const int style = stylefromhash(hash);
+		const float height = (float)heightfromhash(hash) * dpiscaling;
+		wiFontStyle& fontStyle = fontStyles[style];
+
+		float fontScaling = stbtt_ScaleForPixelHeight(&fontStyle.fontInfo, height);
+		fontStyle.fontScaling = fontScaling / dpiscaling;
+
+		// get bounding box for character (may be offset to account for chars that dip above or below the line
+		int left, top, right, bottom;
+		stbtt_GetCodepointBitmapBox(&fontStyle.fontInfo, code, fontScaling, fontScaling, &left, &top, &right, &bottom);
+
+		NewGlyph newGlyph;
+		newGlyph.hash = hash;
+		newGlyph.fontScaling = fontScaling;
+		newGlyph.x = left;
+		newGlyph.y = top;
+		newGlyph.w = right - left;
+		newGlyph.h = bottom - top;
+		newGlyphs.push_back(newGlyph);
+	}
+	pendingGlyphs.clear();
 
-			// Remove dpi upscaling:
-			glyph.x = glyph.x / dpiscaling;
-			glyph.y = glyph.y / dpiscaling;
-			glyph.width = glyph.width / dpiscaling;
-			glyph.height = glyph.height / dpiscaling;
+	// Taller glyphs first gives tighter skyline packing:
+	std::sort(newGlyphs.begin(), newGlyphs.end(), [](const NewGlyph& a, const NewGlyph& b) {
+		return a.h > b.h || (a.h == b.h && a.hash < b.hash);
+	});
 
-			// Add padding to the rectangle that will be packed in the atlas:
-			right += borderPadding * 2;
-			bottom += borderPadding * 2;
-			rect_lookup[hash] = rect_ltrb(left, top, right, bottom);
+	const uint32_t currentFrame = atlasFrame.load();
+	size_t placedCount = 0;
+	for (NewGlyph& newGlyph : newGlyphs)
+	{
+		const int w = newGlyph.w + borderPadding * 2;
+		const int h = newGlyph.h + borderPadding * 2;
+		if (w > ATLAS_PAGE_SIZE || h > ATLAS_PAGE_SIZE)
+		{
+			assert(0 && "Glyph is larger than an atlas page!");
+			continue;
 		}
-		pendingGlyphs.clear();
+		int x = 0, y = 0;
+		bool placed = false;
 
-		// This reference array will be used for packing:
-		vector<rect_xywh*> out_rects;
-		out_rects.reserve(rect_lookup.size());
-		for (auto& it : rect_lookup)
+		// Try existing pages first, then create new page, finally evict the least recently used page:
+		for (uint32_t i = 0; i < pageCount && !placed; ++i)
+		{
+			placed = pages[i].packer.Allocate(w, h, x, y);
+			newGlyph.page = i;
+		}
+		if (!placed && pageCount < ATLAS_MAX_PAGES)
 		{
-			out_rects.push_back(&it.second);
+			newGlyph.page = pageCount++;
+			pages[newGlyph.page].Reset();
+			placed = pages[newGlyph.page].packer.Allocate(w, h, x, y);
 		}
+		if (!placed)
+		{
+			uint32_t lru = ~0u;
+			for (uint32_t i = 0; i < pageCount; ++i)
+			{
+				const uint32_t lastUsed = pages[i].lastUsedFrame.load();
+				if (lastUsed < currentFrame && (lru == ~0u || lastUsed < pages[lru].lastUsedFrame.load()))
+				{
+					lru = i;
+				}
+			}
+			if (lru != ~0u)
+			{
+				for (auto it = glyph_lookup.begin(); it != glyph_lookup.end();)
+				{
+					if (it->second.page == lru)
+					{
+						it = glyph_lookup.erase(it);
+					}
+					else
+					{
+						++it;
+					}
+				}
+				pages[lru].Reset();
+				InvalidateLayouts();
+				newGlyph.page = lru;
+				placed = pages[lru].packer.Allocate(w, h, x, y);
 
-		// Perform packing and process the result if successful:
-		std::vector<bin> bins;
-		if (pack(out_rects.data(), (int)out_rects.size(), 4096, bins))
+				wiBackLog::post("wiFont: atlas is full, least recently used page was evicted");
+			}
+		}
+		if (!placed)
 		{
-			assert(bins.size() == 1 && "The regions won't fit into one texture!");
+			// Every page is in use in the current frame, try again later:
+			pendingGlyphs.insert(newGlyph.hash);
+			continue;
+		}
 
-			// Retrieve texture atlas dimensions:
-			const int bitmapWidth = bins[0].size.w;
-			const int bitmapHeight = bins[0].size.h;
-			const float inv_width = 1.0f / bitmapWidth;
-			const float inv_height = 1.0f / bitmapHeight;
+		// The dirty region includes the padding, it is uploaded as transparent:
+		AtlasPage& page = pages[newGlyph.page];
+		page.lastUsedFrame.store(currentFrame); // pages that were written in this update are not evicted
+		page.dirty_left = std::min(page.dirty_left, x);
+		page.dirty_top = std::min(page.dirty_top, y);
+		page.dirty_right = std::max(page.dirty_right, x + w);
+		page.dirty_bottom = std::max(page.dirty_bottom, y + h);
+
+		Glyph& glyph = glyph_lookup[newGlyph.hash];
+		glyph.page = newGlyph.page;
+
+		// Glyph dimensions are calculated without padding:
+		glyph.x = float(newGlyph.x);
+		glyph.y = float(newGlyph.y) + float(fontStyles[stylefromhash(newGlyph.hash)].ascent) * newGlyph.fontScaling;
+		glyph.width = float(newGlyph.w);
+		glyph.height = float(newGlyph.h);
+
+		// Remove dpi upscaling:
+		glyph.x = glyph.x / dpiscaling;
+		glyph.y = glyph.y / dpiscaling;
+		glyph.width = glyph.width / dpiscaling;
+		glyph.height = glyph.height / dpiscaling;
+
+		// Remove border padding from the packed rectangle (we don't want to touch the border, it should stay transparent):
+		//	From now on, x and y are the placement of the glyph in the page
+		newGlyph.x = x + borderPadding;
+		newGlyph.y = y + borderPadding;
+
+		// Compute texture coordinates for the glyph:
+		const float inv_size = 1.0f / ATLAS_PAGE_SIZE;
+		glyph.tc_left = XMConvertFloatToHalf(float(newGlyph.x) * inv_size);
+		glyph.tc_right = XMConvertFloatToHalf(float(newGlyph.x + newGlyph.w) * inv_size);
+		glyph.tc_top = XMConvertFloatToHalf(float(newGlyph.y) * inv_size);
+		glyph.tc_bottom = XMConvertFloatToHalf(float(newGlyph.y + newGlyph.h) * inv_size);
+
+		placedCount++;
+		std::swap(newGlyphs[placedCount - 1], newGlyph);
+	}
+	newGlyphs.resize(placedCount);
+
+	// Render the new glyphs into the CPU-side atlas pages in parallel, they don't overlap:
+	wiJobSystem::context ctx;
+	wiJobSystem::Dispatch(ctx, (uint32_t)newGlyphs.size(), 16, [&](wiJobArgs args) {
+		const NewGlyph& newGlyph = newGlyphs[args.jobIndex];
+		const wiFontStyle& fontStyle = fontStyles[stylefromhash(newGlyph.hash)];
+		AtlasPage& page = pages[newGlyph.page];
+		const size_t byteOffset = size_t(newGlyph.x) + size_t(newGlyph.y) * ATLAS_PAGE_SIZE;
+		stbtt_MakeCodepointBitmap(&fontStyle.fontInfo, page.bitmap.data() + byteOffset, newGlyph.w, newGlyph.h, ATLAS_PAGE_SIZE, newGlyph.fontScaling, newGlyph.fontScaling, codefromhash(newGlyph.hash));
+	});
+	wiJobSystem::Wait(ctx);
+}
+void UpdateAtlas(CommandList cmd)
+{
+	if (!initialized.load())
+	{
+		return;
+	}
 
-			// Create the CPU-side texture atlas and fill with transparency (0):
-			vector<uint8_t> bitmap(size_t(bitmapWidth) * size_t(bitmapHeight));
-			std::fill(bitmap.begin(), bitmap.end(), 0);
+	glyphLock.lock();
 
-			// Iterate all packed glyph rectangles:
-			for (auto it : rect_lookup)
+	UpdatePendingGlyphs();
+
+	GraphicsDevice* device = wiRenderer::GetDevice();
+	for (uint32_t i = 0; i < pageCount; ++i)
+	{
+		AtlasPage& page = pages[i];
+		if (!page.texture.IsValid() || (page.IsDirty() && !wiInitializer::IsInitializeFinished()))
+		{
+			// New page, or the renderer is not ready yet for partial copies (initialization screen), upload whole page:
+			TextureDesc desc;
+			desc.Width = ATLAS_PAGE_SIZE;
+			desc.Height = ATLAS_PAGE_SIZE;
+			desc.Format = FORMAT_R8_UNORM;
+			desc.BindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+			SubresourceData InitData;
+			InitData.pSysMem = page.bitmap.data();
+			InitData.SysMemPitch = ATLAS_PAGE_SIZE;
+			device->CreateTexture(&desc, &InitData, &page.texture);
+			device->SetName(&page.texture, "wiFont::atlas_page");
+		}
+		else if (page.IsDirty())
+		{
+			// Only upload the region that contains new glyphs, it is written into the page from the per-frame GPU memory:
+			const int width = page.dirty_right - page.dirty_left;
+			const int height = page.dirty_bottom - page.dirty_top;
+			GraphicsDevice::GPUAllocation mem = device->AllocateGPU(size_t(width) * size_t(height), cmd);
+			if (mem.IsValid())
 			{
-				const int32_t hash = it.first;
-				const wchar_t code = codefromhash(hash);
-				const int style = stylefromhash(hash);
-				const float height = (float)heightfromhash(hash) * dpiscaling;
-				wiFontStyle& fontStyle = fontStyles[style];
-				rect_xywh& rect = it.second;
-				Glyph& glyph = glyph_lookup[hash];
-
-				// Remove border padding from the packed rectangle (we don't want to touch the border, it should stay transparent):
-				rect.x += borderPadding;
-				rect.y += borderPadding;
-				rect.w -= borderPadding * 2;
-				rect.h -= borderPadding * 2;
-
-				float fontScaling = stbtt_ScaleForPixelHeight(&fontStyle.fontInfo, height);
-
-				// Render the glyph inside the CPU-side atlas:
-				int byteOffset = rect.x + (rect.y * bitmapWidth);
-				stbtt_MakeCodepointBitmap(&fontStyle.fontInfo, bitmap.data() + byteOffset, rect.w, rect.h, bitmapWidth, fontScaling, fontScaling, code);
-
-				// Compute texture coordinates for the glyph:
-				float tc_left = float(rect.x);
-				float tc_right = tc_left + float(rect.w);
-				float tc_top = float(rect.y);
-				float tc_bottom = tc_top + float(rect.h);
-
-				tc_left *= inv_width;
-				tc_right *= inv_width;
-				tc_top *= inv_height;
-				tc_bottom *= inv_height;
-
-				glyph.tc_left = XMConvertFloatToHalf(tc_left);
-				glyph.tc_right = XMConvertFloatToHalf(tc_right);
-				glyph.tc_top = XMConvertFloatToHalf(tc_top);
-				glyph.tc_bottom = XMConvertFloatToHalf(tc_bottom);
+				for (int y = 0; y < height; ++y)
+				{
+					memcpy((uint8_t*)mem.data + size_t(y) * width, page.bitmap.data() + size_t(page.dirty_top + y) * ATLAS_PAGE_SIZE + page.dirty_left, width);
+				}
+
+				device->EventBegin("wiFont::UpdateAtlas", cmd);
+
+				FontUploadCB cb;
+				cb.g_xFontUpload_Dest = XMUINT2(page.dirty_left, page.dirty_top);
+				cb.g_xFontUpload_Size = XMUINT2(width, height);
+				cb.g_xFontUpload_Offset = mem.offset;
+				device->UpdateBuffer(&uploadConstantBuffer, &cb, cmd);
+
+				device->BindComputeShader(&uploadShader, cmd);
+				device->BindConstantBuffer(CS, &uploadConstantBuffer, CB_GETBINDSLOT(FontUploadCB), cmd);
+				device->BindResource(CS, mem.buffer, TEXSLOT_ONDEMAND0, cmd);
+				device->BindUAV(CS, &page.texture, 0, cmd);
+				device->Dispatch((width + 7) / 8, (height + 7) / 8, 1, cmd);
+
+				GPUBarrier barrier = GPUBarrier::Memory();
+				device->Barrier(&barrier, 1, cmd);
+
+				device->UnbindUAVs(0, 1, cmd);
+
+				device->EventEnd(cmd);
 			}
+		}
+		page.dirty_left = INT_MAX;
+		page.dirty_top = INT_MAX;
+		page.dirty_right = 0;
+		page.dirty_bottom = 0;
+	}
 
-			// Upload the CPU-side texture atlas bitmap to the GPU:
-			wiTextureHelper::CreateTexture(texture, bitmap.data(), bitmapWidth, bitmapHeight, FORMAT_R8_UNORM);
+	// Remove layouts that were not drawn recently:
+	const uint32_t currentFrame = atlasFrame.fetch_add(1);
+	layoutLock.lock();
+	for (auto it = layoutCache.begin(); it != layoutCache.end();)
+	{
+		if (it->second.lastUsedFrame + LAYOUT_CACHE_LIFETIME < currentFrame)
+		{
+			it = layoutCache.erase(it);
+		}
+		else
+		{
+			++it;
 		}
 	}
+	layoutLock.unlock();
 
 	glyphLock.unlock();
 }
-const Texture* GetAtlas()
+void BeginBatch(CommandList cmd)
+{
+	batches[cmd].depth++;
+}
+void EndBatch(CommandList cmd)
+{
+	FontBatch& batch = batches[cmd];
+	assert(batch.depth > 0 && "EndBatch() without BeginBatch()!");
+	batch.depth--;
+	if (batch.depth == 0)
+	{
+		FlushBatch(batch, cmd);
+	}
+}
+void Flush(CommandList cmd)
+{
+	FlushBatch(batches[cmd], cmd);
+}
+wiFontStatistics GetStatistics()
+{
+	wiFontStatistics stats;
+	stats.drawCalls = statDrawCalls.load();
+	stats.layoutCacheHits = statLayoutCacheHits.load();
+	stats.layoutCacheMisses = statLayoutCacheMisses.load();
+	layoutLock.lock();
+	stats.layoutCacheSize = (uint32_t)layoutCache.size();
+	layoutLock.unlock();
+	return stats;
+}
+void ResetStatistics()
+{
+	statDrawCalls.store(0);
+	statLayoutCacheHits.store(0);
+	statLayoutCacheMisses.store(0);
+}
+void KeepAtlasPages(uint32_t pageMask)
+{
+	const uint32_t currentFrame = atlasFrame.load(std::memory_order_relaxed);
+	for (uint32_t i = 0; i < ATLAS_MAX_PAGES; ++i)
+	{
+		if (pageMask & (1u << i))
+		{
+			pages[i].lastUsedFrame.store(currentFrame, std::memory_order_relaxed);
+		}
+	}
+}
+uint32_t GetAtlasGeneration()
+{
+	layoutLock.lock();
+	const uint32_t generation = atlasGeneration;
+	layoutLock.unlock();
+	return generation;
+}
+const Texture* GetAtlas(uint32_t page)
+{
+	return page < pageCount ? &pages[page].texture : nullptr;
+}
+uint32_t GetAtlasPageCount()
 {
-	return &texture;
+	return pageCount;
 }
 const std::string& GetFontPath()
 {
@@ -531,12 +1045,14 @@ float textWidth_internal(const T* text, const wiFontParams& params)
 	float maxWidth = 0;
 	float currentLineWidth = 0;
 	size_t i = 0;
+	glyphLock.lock();
 	while (text[i] != 0)
 	{
 		int code = (int)text[i++];
 		const int32_t hash = glyphhash(code, params.style, params.size);
 
-		if (glyph_lookup.count(hash) == 0)
+		auto it = glyph_lookup.find(hash);
+		if (it == glyph_lookup.end())
 		{
 			// glyph not packed yet, we just continue (it will be added if it is actually rendered)
 			continue;
@@ -556,11 +1072,12 @@ float textWidth_internal(const T* text, const wiFontParams& params)
 		}
 		else
 		{
-			const Glyph& glyph = glyph_lookup.at(hash);
+			const Glyph& glyph = it->second;
 			currentLineWidth += glyph.width + float(params.spacingX) * params.scaling;
 		}
 		maxWidth = std::max(maxWidth, currentLineWidth);
 	}
+	glyphLock.unlock();
 
 	return maxWidth;
 }
@@ -587,88 +1104,126 @@ float textHeight_internal(const T* text, const wiFontParams& params)
 	return height;
 }
 
+// Appends the glyph quads of the text to vertices and quadPages, returns false if some glyphs are not in the atlas yet
 template<typename T>
-void Draw_internal(const T* text, size_t text_length, const wiFontParams& params, CommandList cmd)
+bool Tessellate_internal(const T* text, size_t text_length, const wiFontParams& params, vector<FontVertex>& vertices, vector<uint8_t>& quadPages)
 {
-	if (!initialized.load())
-	{
-		return;
-	}
-
-	wiFontParams newProps = params;
-
-	if (params.h_align == WIFALIGN_CENTER)
-		newProps.posX -= textWidth_internal(text, newProps) / 2;
-	else if (params.h_align == WIFALIGN_RIGHT)
-		newProps.posX -= textWidth_internal(text, newProps);
-	if (params.v_align == WIFALIGN_CENTER)
-		newProps.posY -= textHeight_internal(text, newProps) / 2;
-	else if (params.v_align == WIFALIGN_BOTTOM)
-		newProps.posY -= textHeight_internal(text, newProps);
+	const uint32_t currentFrame = atlasFrame.load(std::memory_order_relaxed);
+	const uint64_t hash = layouthash(text, text_length, params);
+
+	auto draw_layout = [&](const TextLayout& layout) {
+		wiFontParams newProps = params;
+
+		if (params.h_align == WIFALIGN_CENTER)
+			newProps.posX -= layout.width / 2;
+		else if (params.h_align == WIFALIGN_RIGHT)
+			newProps.posX -= layout.width;
+		if (params.v_align == WIFALIGN_CENTER)
+			newProps.posY -= layout.height / 2;
+		else if (params.v_align == WIFALIGN_BOTTOM)
+			newProps.posY -= layout.height;
+
+		const uint32_t quadCount = (uint32_t)layout.quadPages.size();
+		if (newProps.shadowColor.getA() > 0)
+		{
+			// font shadow render:
+			AppendQuads(vertices, quadPages, layout.vertices.data(), layout.quadPages.data(), quadCount, newProps.posX + 1, newProps.posY + 1, newProps.shadowColor.rgba);
+		}
+		// font base render:
+		AppendQuads(vertices, quadPages, layout.vertices.data(), layout.quadPages.data(), quadCount, newProps.posX, newProps.posY, newProps.color.rgba);
 
-	GraphicsDevice* device = wiRenderer::GetDevice();
+		// Keep the atlas pages of the text resident:
+		for (uint32_t i = 0; i < ATLAS_MAX_PAGES; ++i)
+		{
+			if (layout.pageMask & (1u << i))
+			{
+				pages[i].lastUsedFrame.store(currentFrame, std::memory_order_relaxed);
+			}
+		}
+	};
 
-	GraphicsDevice::GPUAllocation mem = device->AllocateGPU(sizeof(FontVertex) * text_length * 4, cmd);
-	if (!mem.IsValid())
+	bool cached = false;
+	bool complete = true;
+	layoutLock.lock();
+	const uint32_t generation = atlasGeneration;
+	auto it = layoutCache.find(hash);
+	if (it != layoutCache.end() && layoutmatch(it->second, text, text_length, params))
 	{
-		return;
+		it->second.lastUsedFrame = currentFrame;
+		draw_layout(it->second);
+		cached = true;
 	}
-	volatile FontVertex* textBuffer = (volatile FontVertex*)mem.data;
-	const uint32_t quadCount = WriteVertices(textBuffer, text, newProps);
-
-	device->EventBegin("Font", cmd);
-
-	device->BindPipelineState(&PSO, cmd);
+	layoutLock.unlock();
 
-	device->BindConstantBuffer(VS, &constantBuffer, CB_GETBINDSLOT(FontCB), cmd);
-	device->BindConstantBuffer(PS, &constantBuffer, CB_GETBINDSLOT(FontCB), cmd);
-	device->BindResource(PS, &texture, TEXSLOT_FONTATLAS, cmd);
-	device->BindSampler(PS, &sampler, SSLOT_ONDEMAND1, cmd);
+	if (cached)
+	{
+		statLayoutCacheHits.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		statLayoutCacheMisses.fetch_add(1, std::memory_order_relaxed);
+
+		static thread_local TextLayout layout;
+		layout.vertices.resize(text_length * 4);
+		layout.quadPages.resize(text_length);
+		const uint32_t quadCount = WriteVertices(layout.vertices.data(), layout.quadPages.data(), text, params, complete);
+		layout.vertices.resize(size_t(quadCount) * 4);
+		layout.quadPages.resize(quadCount);
+		layout.pageMask = 0;
+		for (uint8_t page : layout.quadPages)
+		{
+			layout.pageMask |= 1u << page;
+		}
+		layout.width = textWidth_internal(text, params);
+		layout.height = textHeight_internal(text, params);
 
-	const GPUBuffer* vbs[] = {
-		mem.buffer,
-	};
-	const uint32_t strides[] = {
-		sizeof(FontVertex),
-	};
-	const uint32_t offsets[] = {
-		mem.offset,
-	};
-	device->BindVertexBuffers(vbs, 0, arraysize(vbs), strides, offsets, cmd);
+		draw_layout(layout);
 
-	assert(text_length * 4 < 65536 && "The index buffer currently only supports so many characters!");
-	device->BindIndexBuffer(&indexBuffer, INDEXFORMAT_16BIT, 0, cmd);
+		// Only layouts that have all their glyphs in the atlas are reusable:
+		if (complete)
+		{
+			layout.text.resize(text_length);
+			for (size_t i = 0; i < text_length; ++i)
+			{
+				layout.text[i] = (wchar_t)text[i];
+			}
+			layout.params = params;
+			layout.lastUsedFrame = currentFrame;
 
-	FontCB cb;
+			layoutLock.lock();
+			if (generation == atlasGeneration)
+			{
+				layoutCache[hash] = layout;
+			}
+			layoutLock.unlock();
+		}
+	}
 
-	XMMATRIX Projection = device->GetScreenProjection();
+	return complete;
+}
 
-	if (newProps.shadowColor.getA() > 0)
+template<typename T>
+void Draw_internal(const T* text, size_t text_length, const wiFontParams& params, CommandList cmd)
+{
+	if (!initialized.load() || params.style >= (int)fontStyles.size())
 	{
-		// font shadow render:
-		XMStoreFloat4x4(&cb.g_xFont_Transform,
-			XMMatrixTranslation((float)newProps.posX + 1, (float)newProps.posY + 1, 0)
-			* Projection
-		);
-		cb.g_xFont_Color = newProps.shadowColor.toFloat4();
-		device->UpdateBuffer(&constantBuffer, &cb, cmd);
-
-		device->DrawIndexed(quadCount * 6, 0, 0, cmd);
+		return;
 	}
 
-	// font base render:
-	XMStoreFloat4x4(&cb.g_xFont_Transform, 
-		XMMatrixTranslation((float)newProps.posX, (float)newProps.posY, 0)
-		* Projection
-	);
-	cb.g_xFont_Color = newProps.color.toFloat4();
-	device->UpdateBuffer(&constantBuffer, &cb, cmd);
-
-	device->DrawIndexed(quadCount * 6, 0, 0, cmd);
+	wiGUIBatch* guiBatch = wiGUIBatch::GetRecording(cmd);
+	if (guiBatch != nullptr)
+	{
+		guiBatch->RecordText(text, text_length, params);
+		return;
+	}
 
-	device->EventEnd(cmd);
+	FontBatch& batch = batches[cmd];
+	Tessellate_internal(text, text_length, params, batch.vertices, batch.quadPages);
 
-	UpdatePendingGlyphs();
+	if (batch.depth == 0)
+	{
+		FlushBatch(batch, cmd);
+	}
 }
 
 void Draw(const char* text, const wiFontParams& params, CommandList cmd)
@@ -698,6 +1253,14 @@ void Draw(const wstring& text, const wiFontParams& params, CommandList cmd)
 	Draw_internal(text.c_str(), text.length(), params, cmd);
 }
 
+bool Tessellate(const std::wstring& text, const wiFontParams& params, std::vector<wiFontVertex>& vertices, std::vector<uint8_t>& quadPages)
+{
+	if (!initialized.load() || params.style >= (int)fontStyles.size() || text.empty())
+	{
+		return true;
+	}
+	return Tessellate_internal(text.c_str(), text.length(), params, vertices, quadPages);
+}
 float textWidth(const char* text, const wiFontParams& params)
 {
 	return textWidth_internal(text, params);
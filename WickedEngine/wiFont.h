@@ -4,6 +4,7 @@
 #include "wiColor.h"
 
 #include <string>
+#include <vector>
 
 // Do not alter order because it is bound to lua manually
 enum wiFontAlign
@@ -35,12 +36,34 @@ struct wiFontParams
 	{}
 };
 
+// Vertex of a glyph quad, the position is in screen space and the texture coordinate is on the atlas page of the quad
+struct wiFontVertex
+{
+	XMFLOAT2 Pos;
+	XMHALF2 Tex;
+	uint32_t Color;
+};
+
+struct wiFontStatistics
+{
+	uint32_t drawCalls = 0;
+	uint32_t layoutCacheHits = 0;
+	uint32_t layoutCacheMisses = 0;
+	uint32_t layoutCacheSize = 0;
+};
+
 namespace wiFont
 {
 	void Initialize();
 
 	void LoadShaders();
-	const wiGraphics::Texture* GetAtlas();
+
+	// Places the glyphs that were requested by Draw() since the last call into the atlas and uploads the modified regions.
+	//	Must be called outside of render passes, newly requested glyphs will be visible from the following Draw() calls
+	void UpdateAtlas(wiGraphics::CommandList cmd);
+	// Returns an atlas page texture, or nullptr if the page doesn't exist
+	const wiGraphics::Texture* GetAtlas(uint32_t page = 0);
+	uint32_t GetAtlasPageCount();
 
 	// Returns the font directory
 	const std::string& GetFontPath();
@@ -50,6 +73,25 @@ namespace wiFont
 	// Create a font. Returns fontStyleID that is reusable. If font already exists, just return its ID
 	int AddFontStyle(const std::string& fontName);
 
+	// Draw() calls between BeginBatch() and EndBatch() on the same command list are gathered and drawn together in EndBatch().
+	//	Batches can be nested, only the outermost EndBatch() draws. Outside of a batch, Draw() draws immediately
+	void BeginBatch(wiGraphics::CommandList cmd);
+	void EndBatch(wiGraphics::CommandList cmd);
+	// Draws the text that was gathered in the current batch so far, this is needed when something else is drawn inbetween
+	void Flush(wiGraphics::CommandList cmd);
+
+	// Appends the glyph quads of the text (4 vertices each) to vertices and the atlas page of every quad to quadPages, for renderers that batch text with other geometry.
+	//	Returns false if some glyphs are not in the atlas yet, the text is complete when it is tessellated again after the next UpdateAtlas()
+	bool Tessellate(const std::wstring& text, const wiFontParams& params, std::vector<wiFontVertex>& vertices, std::vector<uint8_t>& quadPages);
+	// Keeps the atlas pages of pageMask (a bit for every page) resident, for tessellated text that is drawn again without Tessellate()
+	void KeepAtlasPages(uint32_t pageMask);
+	// Incremented whenever glyphs are removed from the atlas, text that was tessellated with a different generation must be tessellated again
+	uint32_t GetAtlasGeneration();
+
+	// Draw calls and text layout cache usage since the last ResetStatistics()
+	wiFontStatistics GetStatistics();
+	void ResetStatistics();
+
 	void Draw(const char* text, const wiFontParams& params, wiGraphics::CommandList cmd);
 	void Draw(const wchar_t* text, const wiFontParams& params, wiGraphics::CommandList cmd);
 	void Draw(const std::string& text, const wiFontParams& params, wiGraphics::CommandList cmd);
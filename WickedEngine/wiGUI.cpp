@@ -49,6 +49,14 @@ void wiGUIElement::ApplyScissor(const Rect rect, CommandList cmd, bool constrain
 		scissor.top = scissor.bottom;
 	}
 
+	wiGUIBatch* batch = wiGUIBatch::GetRecording(cmd);
+	if (batch != nullptr)
+	{
+		// The batch clips to the scissor on the CPU, or binds it when it's needed:
+		batch->SetScissor(scissor);
+		return;
+	}
+
 	GraphicsDevice* device = wiRenderer::GetDevice();
 	float scale_x = (float)device->GetResolutionWidth() / (float)device->GetScreenWidth();
 	float scale_y = (float)device->GetResolutionHeight() / (float)device->GetScreenHeight();
@@ -134,6 +142,11 @@ void wiGUI::Render(CommandList cmd) const
 	}
 
 	wiRenderer::GetDevice()->EventBegin("GUI", cmd);
+	if (batching)
+	{
+		batch.Begin(cmd);
+	}
+
 	for (auto it = widgets.rbegin(); it != widgets.rend(); ++it)
 	{
 		const wiWidget* widget = (*it);
@@ -141,26 +154,36 @@ void wiGUI::Render(CommandList cmd) const
 		{
 			// the contained child widgets will be rendered by the containers
 			ApplyScissor(scissorRect, cmd);
-			widget->Render(this, cmd);
+			RenderWidget(widget, cmd);
 		}
 	}
 	if (activeWidget != nullptr)
 	{
 		// Active widget is always on top!
 		ApplyScissor(scissorRect, cmd);
-		activeWidget->Render(this, cmd);
+		RenderWidget(activeWidget, cmd);
 	}
 
 	ApplyScissor(scissorRect, cmd);
 
 	for (auto&x : widgets)
 	{
+		batch.BeginWidget(x);
 		x->RenderTooltip(this, cmd);
+		batch.EndWidget();
 	}
 
+	batch.End(cmd);
 	wiRenderer::GetDevice()->EventEnd(cmd);
 }
 
+void wiGUI::RenderWidget(const wiWidget* widget, CommandList cmd) const
+{
+	batch.BeginWidget(widget);
+	widget->Render(this, cmd);
+	batch.EndWidget();
+}
+
 void wiGUI::AddWidget(wiWidget* widget)
 {
 	widget->AttachTo(this);
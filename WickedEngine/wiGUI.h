@@ -2,6 +2,7 @@
 #include "CommonInclude.h"
 #include "wiGraphicsDevice.h"
 #include "wiScene.h"
+#include "wiGUIBatch.h"
 
 #include <list>
 
@@ -29,11 +30,15 @@ private:
 	bool focus = false;
 	bool visible = true;
 	XMFLOAT2 pointerpos = XMFLOAT2(0, 0);
+	bool batching = true;
+	mutable wiGUIBatch batch;
 public:
 	~wiGUI();
 
 	void Update(float dt);
 	void Render(wiGraphics::CommandList cmd) const;
+	// Renders a widget, containers render their children with this so that the children are retained separately in the batch
+	void RenderWidget(const wiWidget* widget, wiGraphics::CommandList cmd) const;
 
 	void AddWidget(wiWidget* widget);
 	void RemoveWidget(wiWidget* widget);
@@ -51,6 +56,12 @@ public:
 	void SetVisible(bool value) { visible = value; }
 	bool IsVisible() { return visible; }
 
+	// With batching, the widgets are drawn with a few draw calls by the retained wiGUIBatch, otherwise every image and text is drawn separately
+	void SetBatchingEnabled(bool value) { batching = value; }
+	bool IsBatchingEnabled() const { return batching; }
+	// The batch of the last Render(), its vertex stream, draw calls and statistics can be inspected
+	const wiGUIBatch& GetBatch() const { return batch; }
+
 	const XMFLOAT2& GetPointerPos() const
 	{
 		return pointerpos;
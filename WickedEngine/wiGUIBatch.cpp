@@ -0,0 +1,815 @@
+#include "wiGUIBatch.h"
+#include "wiRenderer.h"
+#include "wiTextureHelper.h"
+#include "wiBackLog.h"
+#include "SamplerMapping.h"
+#include "ResourceMapping.h"
+#include "ShaderInterop_GUI.h"
+
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cfloat>
+
+using namespace std;
+using namespace wiGraphics;
+
+namespace wiGUIBatch_Internal
+{
+	static const uint32_t MAX_QUADS = 16384; // a draw call can't reference more vertices with 16-bit indices
+
+	GPUBuffer			indexBuffer;
+	GPUBuffer			constantBuffer;
+	BlendState			blendState;
+	RasterizerState		rasterizerState;
+	DepthStencilState	depthStencilState;
+	InputLayout			inputLayout;
+	Shader				vertexShader;
+	Shader				pixelShader;
+	PipelineState		PSO;
+
+	std::atomic_bool initialized{ false };
+
+	wiGUIBatch* recordingBatches[COMMANDLIST_COUNT] = {};
+
+	const Sampler* GetImageSampler(const wiImageParams& params)
+	{
+		switch (params.quality)
+		{
+		case QUALITY_NEAREST:
+			switch (params.sampleFlag)
+			{
+			case SAMPLEMODE_WRAP: return wiRenderer::GetSampler(SSLOT_POINT_WRAP);
+			case SAMPLEMODE_CLAMP: return wiRenderer::GetSampler(SSLOT_POINT_CLAMP);
+			default: return wiRenderer::GetSampler(SSLOT_POINT_MIRROR);
+			}
+		case QUALITY_ANISOTROPIC:
+			switch (params.sampleFlag)
+			{
+			case SAMPLEMODE_WRAP: return wiRenderer::GetSampler(SSLOT_ANISO_WRAP);
+			case SAMPLEMODE_CLAMP: return wiRenderer::GetSampler(SSLOT_ANISO_CLAMP);
+			default: return wiRenderer::GetSampler(SSLOT_ANISO_MIRROR);
+			}
+		default:
+			switch (params.sampleFlag)
+			{
+			case SAMPLEMODE_WRAP: return wiRenderer::GetSampler(SSLOT_LINEAR_WRAP);
+			case SAMPLEMODE_CLAMP: return wiRenderer::GetSampler(SSLOT_LINEAR_CLAMP);
+			default: return wiRenderer::GetSampler(SSLOT_LINEAR_MIRROR);
+			}
+		}
+	}
+
+	uint32_t PackColor(XMFLOAT4 color)
+	{
+		XMStoreFloat4(&color, XMVectorSaturate(XMLoadFloat4(&color)));
+		return wiColor::fromFloat4(color).rgba;
+	}
+
+	// Scales a screen space rectangle to the resolution, the same way as wiGUIElement::ApplyScissor()
+	Rect ScaleScissor(Rect rect)
+	{
+		GraphicsDevice* device = wiRenderer::GetDevice();
+		const float scale_x = (float)device->GetResolutionWidth() / (float)device->GetScreenWidth();
+		const float scale_y = (float)device->GetResolutionHeight() / (float)device->GetScreenHeight();
+		rect.bottom = int32_t((float)rect.bottom * scale_y);
+		rect.top = int32_t((float)rect.top * scale_y);
+		rect.left = int32_t((float)rect.left * scale_x);
+		rect.right = int32_t((float)rect.right * scale_x);
+		return rect;
+	}
+
+	bool RectEqual(const Rect& a, const Rect& b)
+	{
+		return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+	}
+	bool BoundsInside(const XMFLOAT4& bounds, const Rect& rect)
+	{
+		return bounds.x >= (float)rect.left && bounds.y >= (float)rect.top && bounds.z <= (float)rect.right && bounds.w <= (float)rect.bottom;
+	}
+
+	template<typename T>
+	bool Equal(const T& a, const T& b)
+	{
+		return memcmp(&a, &b, sizeof(T)) == 0;
+	}
+	// Compares the parameters that affect the tessellation of a supported image
+	bool ImageParamsEqual(const wiImageParams& a, const wiImageParams& b)
+	{
+		return
+			a._flags == b._flags &&
+			Equal(a.pos, b.pos) &&
+			Equal(a.siz, b.siz) &&
+			Equal(a.scale, b.scale) &&
+			Equal(a.color, b.color) &&
+			Equal(a.drawRect, b.drawRect) &&
+			Equal(a.texOffset, b.texOffset) &&
+			Equal(a.pivot, b.pivot) &&
+			Equal(a.corners, b.corners) &&
+			a.rotation == b.rotation &&
+			a.fade == b.fade &&
+			a.opacity == b.opacity &&
+			a.blendFlag == b.blendFlag &&
+			a.sampleFlag == b.sampleFlag &&
+			a.quality == b.quality;
+	}
+	bool FontParamsEqual(const wiFontParams& a, const wiFontParams& b)
+	{
+		return
+			a.posX == b.posX &&
+			a.posY == b.posY &&
+			a.size == b.size &&
+			a.scaling == b.scaling &&
+			a.spacingX == b.spacingX &&
+			a.spacingY == b.spacingY &&
+			a.h_align == b.h_align &&
+			a.v_align == b.v_align &&
+			a.color.rgba == b.color.rgba &&
+			a.shadowColor.rgba == b.shadowColor.rgba &&
+			a.h_wrap == b.h_wrap &&
+			a.style == b.style;
+	}
+}
+using namespace wiGUIBatch_Internal;
+
+
+bool wiGUIBatch::Command::operator==(const Command& other) const
+{
+	if (type != other.type || !RectEqual(scissor, other.scissor))
+	{
+		return false;
+	}
+	switch (type)
+	{
+	case IMAGE:
+		return texture == other.texture && width == other.width && height == other.height && ImageParamsEqual(image, other.image);
+	case TEXT:
+		return text == other.text && FontParamsEqual(font, other.font);
+	case TRIANGLE:
+		return Equal(triangle, other.triangle) && Equal(color, other.color);
+	}
+	return false;
+}
+
+void wiGUIBatch::Begin(CommandList cmd)
+{
+	if (!initialized.load())
+	{
+		return;
+	}
+	assert(!recording && "wiGUIBatch::Begin() was called twice!");
+	assert(recordingBatches[cmd] == nullptr && "Another GUI batch is already recording on this command list!");
+
+	recording = true;
+	commandlist = cmd;
+	recordingBatches[cmd] = this;
+	frame++;
+	atlasGeneration = wiFont::GetAtlasGeneration();
+
+	vertices.clear();
+	drawcalls.clear();
+	stats = Statistics();
+	chunkCounters.clear();
+	widgetStack.clear();
+	current.clear();
+	pending.clear();
+
+	GraphicsDevice* device = wiRenderer::GetDevice();
+	scissor.left = 0;
+	scissor.top = 0;
+	scissor.right = (int32_t)device->GetScreenWidth();
+	scissor.bottom = (int32_t)device->GetScreenHeight();
+}
+void wiGUIBatch::End(CommandList cmd)
+{
+	if (!recording)
+	{
+		return;
+	}
+	assert(cmd == commandlist);
+
+	Flush(cmd);
+
+	recordingBatches[cmd] = nullptr;
+	recording = false;
+
+	// The chunks of widgets that weren't rendered in this frame are not needed any more:
+	for (auto it = chunks.begin(); it != chunks.end();)
+	{
+		if (it->second.frame != frame)
+		{
+			it = chunks.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+void wiGUIBatch::Flush(CommandList cmd)
+{
+	if (!recording)
+	{
+		return;
+	}
+	assert(cmd == commandlist);
+
+	FinishChunk();
+
+	GraphicsDevice* device = wiRenderer::GetDevice();
+
+	if (!pending.empty())
+	{
+		// Gather the quads of the pending chunks into the vertex stream:
+		const uint32_t firstQuad = uint32_t(vertices.size() / 4);
+		quadStates.clear();
+		for (const Chunk* chunk : pending)
+		{
+			vertices.insert(vertices.end(), chunk->vertices.begin(), chunk->vertices.end());
+			quadStates.insert(quadStates.end(), chunk->quads.begin(), chunk->quads.end());
+		}
+		pending.clear();
+
+		// A draw call is started only when a quad needs a different texture, atlas page or scissor than the quads before it:
+		const size_t firstDrawCall = drawcalls.size();
+		DrawCall drawcall;
+		XMFLOAT4 drawcallBounds = XMFLOAT4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (uint32_t i = 0; i < (uint32_t)quadStates.size(); ++i)
+		{
+			const QuadState& quad = quadStates[i];
+
+			bool compatible = drawcall.quadCount > 0 && drawcall.quadCount < MAX_QUADS;
+			if (compatible && quad.texture != nullptr && drawcall.texture != nullptr)
+			{
+				compatible = quad.texture == drawcall.texture && quad.sampler == drawcall.sampler;
+			}
+			if (compatible && quad.atlasPage >= 0 && drawcall.atlasPage >= 0)
+			{
+				compatible = quad.atlasPage == drawcall.atlasPage;
+			}
+			if (compatible)
+			{
+				if (quad.scissor)
+				{
+					compatible = drawcall.scissor ? RectEqual(quad.scissorRect, drawcall.scissorRect) : BoundsInside(drawcallBounds, quad.scissorRect);
+				}
+				else if (drawcall.scissor)
+				{
+					compatible = BoundsInside(quad.bounds, drawcall.scissorRect);
+				}
+			}
+
+			if (!compatible)
+			{
+				if (drawcall.quadCount > 0)
+				{
+					drawcalls.push_back(drawcall);
+				}
+				drawcall = DrawCall();
+				drawcall.quadOffset = firstQuad + i;
+				drawcallBounds = XMFLOAT4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+			}
+
+			drawcall.quadCount++;
+			if (quad.texture != nullptr)
+			{
+				drawcall.texture = quad.texture;
+				drawcall.sampler = quad.sampler;
+			}
+			if (quad.atlasPage >= 0)
+			{
+				drawcall.atlasPage = quad.atlasPage;
+			}
+			if (quad.scissor)
+			{
+				drawcall.scissor = true;
+				drawcall.scissorRect = quad.scissorRect;
+			}
+			drawcallBounds.x = std::min(drawcallBounds.x, quad.bounds.x);
+			drawcallBounds.y = std::min(drawcallBounds.y, quad.bounds.y);
+			drawcallBounds.z = std::max(drawcallBounds.z, quad.bounds.z);
+			drawcallBounds.w = std::max(drawcallBounds.w, quad.bounds.w);
+		}
+		if (drawcall.quadCount > 0)
+		{
+			drawcalls.push_back(drawcall);
+		}
+
+		const uint32_t quadCount = (uint32_t)quadStates.size();
+		stats.quads += quadCount;
+		stats.flushes++;
+
+		GraphicsDevice::GPUAllocation mem = device->AllocateGPU(sizeof(Vertex) * quadCount * 4, cmd);
+		if (quadCount > 0 && mem.IsValid())
+		{
+			memcpy(mem.data, vertices.data() + size_t(firstQuad) * 4, sizeof(Vertex) * quadCount * 4);
+
+			device->EventBegin("GUI Batch", cmd);
+
+			device->BindPipelineState(&PSO, cmd);
+
+			GUICB cb;
+			XMStoreFloat4x4(&cb.g_xGUI_Transform, device->GetScreenProjection());
+			device->UpdateBuffer(&constantBuffer, &cb, cmd);
+			device->BindConstantBuffer(VS, &constantBuffer, CB_GETBINDSLOT(GUICB), cmd);
+
+			device->BindSampler(PS, wiRenderer::GetSampler(SSLOT_LINEAR_CLAMP), SSLOT_ONDEMAND1, cmd);
+
+			const GPUBuffer* vbs[] = {
+				mem.buffer,
+			};
+			const uint32_t strides[] = {
+				sizeof(Vertex),
+			};
+			const uint32_t offsets[] = {
+				mem.offset,
+			};
+			device->BindVertexBuffers(vbs, 0, arraysize(vbs), strides, offsets, cmd);
+			device->BindIndexBuffer(&indexBuffer, INDEXFORMAT_16BIT, 0, cmd);
+
+			Rect fullscreen;
+			fullscreen.right = (int32_t)device->GetScreenWidth();
+			fullscreen.bottom = (int32_t)device->GetScreenHeight();
+
+			const Texture* boundTexture = nullptr;
+			const Sampler* boundSampler = nullptr;
+			int boundPage = -1;
+			for (size_t i = firstDrawCall; i < drawcalls.size(); ++i)
+			{
+				const DrawCall& drawcall = drawcalls[i];
+				if (drawcall.texture != nullptr && drawcall.texture != boundTexture)
+				{
+					device->BindResource(PS, drawcall.texture, TEXSLOT_IMAGE_BASE, cmd);
+					boundTexture = drawcall.texture;
+				}
+				if (drawcall.sampler != nullptr && drawcall.sampler != boundSampler)
+				{
+					device->BindSampler(PS, drawcall.sampler, SSLOT_ONDEMAND0, cmd);
+					boundSampler = drawcall.sampler;
+				}
+				if (drawcall.atlasPage >= 0 && drawcall.atlasPage != boundPage)
+				{
+					device->BindResource(PS, wiFont::GetAtlas((uint32_t)drawcall.atlasPage), TEXSLOT_FONTATLAS, cmd);
+					boundPage = drawcall.atlasPage;
+				}
+				const Rect rect = ScaleScissor(drawcall.scissor ? drawcall.scissorRect : fullscreen);
+				device->BindScissorRects(1, &rect, cmd);
+
+				device->DrawIndexed(drawcall.quadCount * 6, 0, (drawcall.quadOffset - firstQuad) * 4, cmd);
+				stats.drawCalls++;
+			}
+
+			device->EventEnd(cmd);
+		}
+	}
+
+	// Whatever is drawn directly after this uses the current scissor:
+	const Rect rect = ScaleScissor(scissor);
+	device->BindScissorRects(1, &rect, cmd);
+}
+
+void wiGUIBatch::BeginWidget(const void* widget)
+{
+	if (!recording)
+	{
+		return;
+	}
+	FinishChunk();
+	widgetStack.push_back(widget);
+}
+void wiGUIBatch::EndWidget()
+{
+	if (!recording)
+	{
+		return;
+	}
+	assert(!widgetStack.empty() && "EndWidget() without BeginWidget()!");
+	FinishChunk();
+	widgetStack.pop_back();
+}
+
+void wiGUIBatch::SetScissor(const Rect& rect)
+{
+	scissor = rect;
+}
+
+bool wiGUIBatch::RecordImage(const Texture* texture, const wiImageParams& params)
+{
+	if (!recording ||
+		texture == nullptr ||
+		params.typeFlag != SCREEN ||
+		params.isFullScreenEnabled() ||
+		params.isExtractNormalMapEnabled() ||
+		params.maskMap != nullptr ||
+		params.stencilComp != STENCILMODE_DISABLED ||
+		(params.blendFlag != BLENDMODE_ALPHA && params.blendFlag != BLENDMODE_PREMULTIPLIED && params.blendFlag != BLENDMODE_OPAQUE))
+	{
+		return false;
+	}
+
+	current.emplace_back();
+	Command& command = current.back();
+	command.type = Command::IMAGE;
+	command.scissor = scissor;
+	command.texture = texture;
+	command.width = texture->GetDesc().Width;
+	command.height = texture->GetDesc().Height;
+	command.image = params;
+	return true;
+}
+void wiGUIBatch::RecordText(const char* text, size_t length, const wiFontParams& params)
+{
+	if (!recording || length == 0)
+	{
+		return;
+	}
+	current.emplace_back();
+	Command& command = current.back();
+	command.type = Command::TEXT;
+	command.scissor = scissor;
+	command.text.resize(length);
+	for (size_t i = 0; i < length; ++i)
+	{
+		command.text[i] = (wchar_t)text[i];
+	}
+	command.font = params;
+}
+void wiGUIBatch::RecordText(const wchar_t* text, size_t length, const wiFontParams& params)
+{
+	if (!recording || length == 0)
+	{
+		return;
+	}
+	current.emplace_back();
+	Command& command = current.back();
+	command.type = Command::TEXT;
+	command.scissor = scissor;
+	command.text.assign(text, length);
+	command.font = params;
+}
+void wiGUIBatch::RecordTriangle(const XMFLOAT2& a, const XMFLOAT2& b, const XMFLOAT2& c, const XMFLOAT4& color)
+{
+	if (!recording)
+	{
+		return;
+	}
+	current.emplace_back();
+	Command& command = current.back();
+	command.type = Command::TRIANGLE;
+	command.scissor = scissor;
+	command.triangle[0] = a;
+	command.triangle[1] = b;
+	command.triangle[2] = c;
+	command.color = color;
+}
+
+void wiGUIBatch::Clear()
+{
+	assert(!recording);
+	chunks.clear();
+}
+
+void wiGUIBatch::FinishChunk()
+{
+	if (current.empty())
+	{
+		return;
+	}
+
+	const void* widget = widgetStack.empty() ? nullptr : widgetStack.back();
+	ChunkKey key;
+	key.widget = widget;
+	key.index = chunkCounters[widget]++;
+
+	Chunk& chunk = chunks[key];
+	if (chunk.frame > 0 && chunk.complete && chunk.atlasGeneration == atlasGeneration && chunk.commands == current)
+	{
+		// Nothing changed since the chunk was tessellated:
+		wiFont::KeepAtlasPages(chunk.atlasPageMask);
+		stats.chunksReused++;
+	}
+	else
+	{
+		chunk.commands.swap(current);
+		chunk.atlasGeneration = atlasGeneration;
+		Tessellate(chunk);
+		stats.chunksTessellated++;
+	}
+	chunk.frame = frame;
+	stats.chunks++;
+	stats.commands += (uint32_t)chunk.commands.size();
+	stats.quadsClipped += chunk.quadsClipped;
+	stats.quadsCulled += chunk.quadsCulled;
+	pending.push_back(&chunk);
+	current.clear();
+}
+
+void wiGUIBatch::Tessellate(Chunk& chunk) const
+{
+	chunk.vertices.clear();
+	chunk.quads.clear();
+	chunk.atlasPageMask = 0;
+	chunk.complete = true;
+	chunk.quadsClipped = 0;
+	chunk.quadsCulled = 0;
+
+	// Adds a quad with vertices in the order: top left, top right, bottom left, bottom right
+	auto add_quad = [&](XMFLOAT2 pos[4], XMFLOAT2 uv[4], uint32_t color, uint32_t flags, const Texture* texture, const Sampler* sampler, int atlasPage, const Rect& rect, bool clippable) {
+		QuadState quad;
+		quad.texture = texture;
+		quad.sampler = sampler;
+		quad.atlasPage = atlasPage;
+		quad.scissor = false;
+		quad.scissorRect = rect;
+		quad.bounds.x = std::min(std::min(pos[0].x, pos[1].x), std::min(pos[2].x, pos[3].x));
+		quad.bounds.y = std::min(std::min(pos[0].y, pos[1].y), std::min(pos[2].y, pos[3].y));
+		quad.bounds.z = std::max(std::max(pos[0].x, pos[1].x), std::max(pos[2].x, pos[3].x));
+		quad.bounds.w = std::max(std::max(pos[0].y, pos[1].y), std::max(pos[2].y, pos[3].y));
+
+		if (quad.bounds.x >= (float)rect.right || quad.bounds.z <= (float)rect.left ||
+			quad.bounds.y >= (float)rect.bottom || quad.bounds.w <= (float)rect.top)
+		{
+			chunk.quadsCulled++;
+			return;
+		}
+
+		if (!BoundsInside(quad.bounds, rect))
+		{
+			const bool axis_aligned =
+				pos[0].y == pos[1].y && pos[2].y == pos[3].y &&
+				pos[0].x == pos[2].x && pos[1].x == pos[3].x &&
+				pos[0].x != pos[1].x && pos[0].y != pos[2].y;
+
+			if (clippable && axis_aligned)
+			{
+				// Cut the quad to the scissor rectangle, the texture coordinates are interpolated to the new corners:
+				const float x0 = pos[0].x;
+				const float x1 = pos[1].x;
+				const float y0 = pos[0].y;
+				const float y1 = pos[2].y;
+				const float left = (float)rect.left;
+				const float right = (float)rect.right;
+				const float top = (float)rect.top;
+				const float bottom = (float)rect.bottom;
+				const float xa = x0 < x1 ? std::max(x0, left) : std::min(x0, right);
+				const float xb = x0 < x1 ? std::min(x1, right) : std::max(x1, left);
+				const float ya = y0 < y1 ? std::max(y0, top) : std::min(y0, bottom);
+				const float yb = y0 < y1 ? std::min(y1, bottom) : std::max(y1, top);
+				const float s[2] = { (xa - x0) / (x1 - x0), (xb - x0) / (x1 - x0) };
+				const float t[2] = { (ya - y0) / (y1 - y0), (yb - y0) / (y1 - y0) };
+
+				XMFLOAT2 uv_clipped[4];
+				for (int i = 0; i < 4; ++i)
+				{
+					const float si = s[i % 2];
+					const float ti = t[i / 2];
+					const float top_u = uv[0].x + (uv[1].x - uv[0].x) * si;
+					const float top_v = uv[0].y + (uv[1].y - uv[0].y) * si;
+					const float bottom_u = uv[2].x + (uv[3].x - uv[2].x) * si;
+					const float bottom_v = uv[2].y + (uv[3].y - uv[2].y) * si;
+					uv_clipped[i] = XMFLOAT2(top_u + (bottom_u - top_u) * ti, top_v + (bottom_v - top_v) * ti);
+				}
+				pos[0] = XMFLOAT2(xa, ya);
+				pos[1] = XMFLOAT2(xb, ya);
+				pos[2] = XMFLOAT2(xa, yb);
+				pos[3] = XMFLOAT2(xb, yb);
+				for (int i = 0; i < 4; ++i)
+				{
+					uv[i] = uv_clipped[i];
+				}
+				quad.bounds = XMFLOAT4(std::min(xa, xb), std::min(ya, yb), std::max(xa, xb), std::max(ya, yb));
+				chunk.quadsClipped++;
+			}
+			else
+			{
+				quad.scissor = true;
+			}
+		}
+
+		for (int i = 0; i < 4; ++i)
+		{
+			Vertex vertex;
+			vertex.pos = pos[i];
+			vertex.uv = uv[i];
+			vertex.color = color;
+			vertex.flags = flags;
+			chunk.vertices.push_back(vertex);
+		}
+		chunk.quads.push_back(quad);
+	};
+
+	vector<wiFontVertex> fontVertices;
+	vector<uint8_t> quadPages;
+
+	for (const Command& command : chunk.commands)
+	{
+		switch (command.type)
+		{
+		case Command::IMAGE:
+		{
+			const wiImageParams& params = command.image;
+
+			XMFLOAT4 color = params.color;
+			const float darken = 1 - params.fade;
+			color.x *= darken;
+			color.y *= darken;
+			color.z *= darken;
+			color.w *= params.opacity;
+
+			// The white texture doesn't need to be sampled, so these quads don't break the batch:
+			const bool textured = command.texture != wiTextureHelper::getWhite();
+			uint32_t flags = textured ? GUI_VERTEX_TEXTURED : 0;
+			if (params.isBackgroundBlurEnabled())
+			{
+				flags |= GUI_VERTEX_BACKGROUNDBLUR;
+			}
+			else if (params.blendFlag == BLENDMODE_OPAQUE)
+			{
+				flags |= GUI_VERTEX_OPAQUE;
+			}
+			else if (params.blendFlag == BLENDMODE_PREMULTIPLIED)
+			{
+				flags |= GUI_VERTEX_PREMULTIPLIED;
+			}
+
+			// Same placement as wiImage::Draw() without the projection:
+			const XMMATRIX M =
+				XMMatrixScaling(params.scale.x * params.siz.x, params.scale.y * params.siz.y, 1)
+				* XMMatrixRotationZ(params.rotation)
+				* XMMatrixTranslation(params.pos.x, params.pos.y, 0);
+			XMFLOAT2 pos[4];
+			for (int i = 0; i < 4; ++i)
+			{
+				XMVECTOR V = XMVectorSet(params.corners[i].x - params.pivot.x, params.corners[i].y - params.pivot.y, 0, 1);
+				XMStoreFloat2(&pos[i], XMVector2Transform(V, M));
+			}
+			if (params.isMirrorEnabled())
+			{
+				std::swap(pos[0], pos[1]);
+				std::swap(pos[2], pos[3]);
+			}
+
+			const float inv_width = 1.0f / float(std::max(1u, command.width));
+			const float inv_height = 1.0f / float(std::max(1u, command.height));
+			XMFLOAT4 texMulAdd = XMFLOAT4(1, 1, 0, 0);
+			if (params.isDrawRectEnabled())
+			{
+				texMulAdd.x = params.drawRect.z * inv_width;
+				texMulAdd.y = params.drawRect.w * inv_height;
+				texMulAdd.z = params.drawRect.x * inv_width;
+				texMulAdd.w = params.drawRect.y * inv_height;
+			}
+			texMulAdd.z += params.texOffset.x * inv_width;
+			texMulAdd.w += params.texOffset.y * inv_height;
+			XMFLOAT2 uv[4];
+			for (int i = 0; i < 4; ++i)
+			{
+				uv[i].x = float(i % 2) * texMulAdd.x + texMulAdd.z;
+				uv[i].y = float(i / 2) * texMulAdd.y + texMulAdd.w;
+			}
+
+			add_quad(pos, uv, PackColor(color), flags, textured ? command.texture : nullptr, textured ? GetImageSampler(params) : nullptr, -1, command.scissor, true);
+		}
+		break;
+
+		case Command::TEXT:
+		{
+			fontVertices.clear();
+			quadPages.clear();
+			if (!wiFont::Tessellate(command.text, command.font, fontVertices, quadPages))
+			{
+				chunk.complete = false;
+			}
+			for (size_t i = 0; i < quadPages.size(); ++i)
+			{
+				XMFLOAT2 pos[4];
+				XMFLOAT2 uv[4];
+				for (int j = 0; j < 4; ++j)
+				{
+					const wiFontVertex& vertex = fontVertices[i * 4 + j];
+					pos[j] = vertex.Pos;
+					uv[j] = XMFLOAT2(XMConvertHalfToFloat(vertex.Tex.x), XMConvertHalfToFloat(vertex.Tex.y));
+				}
+				const int page = (int)quadPages[i];
+				chunk.atlasPageMask |= 1u << page;
+				add_quad(pos, uv, fontVertices[i * 4].Color, GUI_VERTEX_FONT, nullptr, nullptr, page, command.scissor, true);
+			}
+		}
+		break;
+
+		case Command::TRIANGLE:
+		{
+			// The triangle is a quad with the last two vertices in the same place:
+			XMFLOAT2 pos[4] = { command.triangle[0], command.triangle[1], command.triangle[2], command.triangle[2] };
+			XMFLOAT2 uv[4] = {};
+			add_quad(pos, uv, PackColor(command.color), 0, nullptr, nullptr, -1, command.scissor, false);
+		}
+		break;
+		}
+	}
+}
+
+wiGUIBatch* wiGUIBatch::GetRecording(CommandList cmd)
+{
+	return recordingBatches[cmd];
+}
+
+void wiGUIBatch::Initialize()
+{
+	if (initialized)
+	{
+		return;
+	}
+
+	GraphicsDevice* device = wiRenderer::GetDevice();
+
+	{
+		std::vector<uint16_t> indices(MAX_QUADS * 6);
+		for (uint32_t i = 0; i < MAX_QUADS; ++i)
+		{
+			indices[i * 6 + 0] = uint16_t(i * 4 + 0);
+			indices[i * 6 + 1] = uint16_t(i * 4 + 2);
+			indices[i * 6 + 2] = uint16_t(i * 4 + 1);
+			indices[i * 6 + 3] = uint16_t(i * 4 + 1);
+			indices[i * 6 + 4] = uint16_t(i * 4 + 2);
+			indices[i * 6 + 5] = uint16_t(i * 4 + 3);
+		}
+
+		GPUBufferDesc bd;
+		bd.Usage = USAGE_IMMUTABLE;
+		bd.ByteWidth = uint32_t(sizeof(uint16_t) * indices.size());
+		bd.BindFlags = BIND_INDEX_BUFFER;
+		bd.CPUAccessFlags = 0;
+		SubresourceData InitData;
+		InitData.pSysMem = indices.data();
+		device->CreateBuffer(&bd, &InitData, &indexBuffer);
+	}
+
+	{
+		GPUBufferDesc bd;
+		bd.Usage = USAGE_DYNAMIC;
+		bd.ByteWidth = sizeof(GUICB);
+		bd.BindFlags = BIND_CONSTANT_BUFFER;
+		bd.CPUAccessFlags = CPU_ACCESS_WRITE;
+		device->CreateBuffer(&bd, nullptr, &constantBuffer);
+	}
+
+	RasterizerStateDesc rs;
+	rs.FillMode = FILL_SOLID;
+	rs.CullMode = CULL_NONE;
+	rs.FrontCounterClockwise = false;
+	rs.DepthBias = 0;
+	rs.DepthBiasClamp = 0;
+	rs.SlopeScaledDepthBias = 0;
+	rs.DepthClipEnable = false;
+	rs.MultisampleEnable = false;
+	rs.AntialiasedLineEnable = false;
+	device->CreateRasterizerState(&rs, &rasterizerState);
+
+	// Every quad is shaded to premultiplied alpha, so the blend modes of the supported images and text are the same blend state:
+	BlendStateDesc bd;
+	bd.RenderTarget[0].BlendEnable = true;
+	bd.RenderTarget[0].SrcBlend = BLEND_ONE;
+	bd.RenderTarget[0].DestBlend = BLEND_INV_SRC_ALPHA;
+	bd.RenderTarget[0].BlendOp = BLEND_OP_ADD;
+	bd.RenderTarget[0].SrcBlendAlpha = BLEND_ONE;
+	bd.RenderTarget[0].DestBlendAlpha = BLEND_INV_SRC_ALPHA;
+	bd.RenderTarget[0].BlendOpAlpha = BLEND_OP_ADD;
+	bd.RenderTarget[0].RenderTargetWriteMask = COLOR_WRITE_ENABLE_ALL;
+	bd.IndependentBlendEnable = false;
+	device->CreateBlendState(&bd, &blendState);
+
+	DepthStencilStateDesc dsd;
+	dsd.DepthEnable = false;
+	dsd.StencilEnable = false;
+	device->CreateDepthStencilState(&dsd, &depthStencilState);
+
+	LoadShaders();
+
+	wiBackLog::post("wiGUIBatch Initialized");
+	initialized.store(true);
+}
+
+void wiGUIBatch::LoadShaders()
+{
+	InputLayoutDesc layout[] =
+	{
+		{ "POSITION", 0, FORMAT_R32G32_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, FORMAT_R32G32_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, FORMAT_R8G8B8A8_UNORM, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_VERTEX_DATA, 0 },
+		{ "FLAGS", 0, FORMAT_R32_UINT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_VERTEX_DATA, 0 },
+	};
+	wiRenderer::LoadShader(VS, vertexShader, "guiVS.cso");
+	wiRenderer::GetDevice()->CreateInputLayout(layout, arraysize(layout), &vertexShader, &inputLayout);
+
+	wiRenderer::LoadShader(PS, pixelShader, "guiPS.cso");
+
+	PipelineStateDesc desc;
+	desc.vs = &vertexShader;
+	desc.ps = &pixelShader;
+	desc.il = &inputLayout;
+	desc.bs = &blendState;
+	desc.dss = &depthStencilState;
+	desc.rs = &rasterizerState;
+	wiRenderer::GetDevice()->CreatePipelineState(&desc, &PSO);
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiGraphicsDevice.h"
+#include "wiImage.h"
+#include "wiFont.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Retained batch renderer of the GUI
+//	While a batch is recording on a command list, the wiImage::Draw() and wiFont::Draw() calls that it supports are recorded instead of drawn.
+//	The recorded draws are grouped into chunks per widget. A chunk with the same draws as in the previous frame reuses its tessellated quads,
+//	so only the widgets that changed are tessellated again. Axis aligned quads are clipped to the scissor rectangle on the CPU,
+//	so the whole GUI is drawn from one dynamic vertex stream, with a draw call for every run of quads that can share the bound textures and scissor.
+//	Unsupported draws flush the recorded quads, then they are drawn immediately as usual.
+class wiGUIBatch
+{
+public:
+	struct Vertex
+	{
+		XMFLOAT2 pos;		// screen space
+		XMFLOAT2 uv;
+		uint32_t color;		// RGBA8
+		uint32_t flags;		// GUI_VERTEX_ flags
+	};
+	// Draws quadCount quads of the vertex stream, starting from vertex quadOffset * 4
+	struct DrawCall
+	{
+		uint32_t quadOffset = 0;
+		uint32_t quadCount = 0;
+		const wiGraphics::Texture* texture = nullptr;	// image texture, nullptr if no quad samples one
+		const wiGraphics::Sampler* sampler = nullptr;	// image sampler, nullptr if no quad samples an image texture
+		int atlasPage = -1;								// font atlas page, -1 if no quad has text
+		bool scissor = false;							// the quads that aren't clipped on the CPU need the scissor rectangle
+		wiGraphics::Rect scissorRect;					// screen space, not scaled to the resolution
+	};
+	struct Statistics
+	{
+		uint32_t commands = 0;				// recorded draws, every one of these would be a draw call without batching
+		uint32_t chunks = 0;
+		uint32_t chunksTessellated = 0;
+		uint32_t chunksReused = 0;
+		uint32_t quads = 0;
+		uint32_t quadsClipped = 0;			// quads that were cut to the scissor rectangle
+		uint32_t quadsCulled = 0;			// quads that were outside of the scissor rectangle
+		uint32_t drawCalls = 0;
+		uint32_t flushes = 0;				// submissions of the vertex stream, more than one if an unsupported draw interrupted the batch
+	};
+
+	// Starts recording the supported draws of the command list. The scissor rectangle starts as the full screen
+	void Begin(wiGraphics::CommandList cmd);
+	// Draws the remaining recorded quads and stops recording, then removes the chunks of widgets that weren't rendered
+	void End(wiGraphics::CommandList cmd);
+	// Draws the recorded quads so far, it must be called before anything is drawn directly with the device
+	void Flush(wiGraphics::CommandList cmd);
+
+	// The draws between BeginWidget() and EndWidget() are retained for the widget. Widgets can be nested, the draws of the parent
+	//	before and after the child are retained separately
+	void BeginWidget(const void* widget);
+	void EndWidget();
+
+	// Scissor rectangle of the following draws in screen space (not scaled to the resolution)
+	void SetScissor(const wiGraphics::Rect& rect);
+
+	// Returns false if the draw is not supported by the batch (it must be drawn immediately after Flush())
+	bool RecordImage(const wiGraphics::Texture* texture, const wiImageParams& params);
+	void RecordText(const char* text, size_t length, const wiFontParams& params);
+	void RecordText(const wchar_t* text, size_t length, const wiFontParams& params);
+	// Solid colored triangle in screen space
+	void RecordTriangle(const XMFLOAT2& a, const XMFLOAT2& b, const XMFLOAT2& c, const XMFLOAT4& color);
+
+	bool IsRecording() const { return recording; }
+
+	// The vertex stream and draw calls of the last frame, they are kept until the next Begin()
+	const std::vector<Vertex>& GetVertices() const { return vertices; }
+	const std::vector<DrawCall>& GetDrawCalls() const { return drawcalls; }
+	const Statistics& GetStatistics() const { return stats; }
+	// Number of retained chunks
+	size_t GetChunkCount() const { return chunks.size(); }
+	// Removes every retained chunk, everything will be tessellated again
+	void Clear();
+
+	// Returns the batch that is recording on the command list, or nullptr
+	static wiGUIBatch* GetRecording(wiGraphics::CommandList cmd);
+
+	static void Initialize();
+	static void LoadShaders();
+
+private:
+	struct Command
+	{
+		enum TYPE
+		{
+			IMAGE,
+			TEXT,
+			TRIANGLE,
+		} type = IMAGE;
+		wiGraphics::Rect scissor;
+		// IMAGE:
+		const wiGraphics::Texture* texture = nullptr;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		wiImageParams image;
+		// TEXT:
+		std::wstring text;
+		wiFontParams font;
+		// TRIANGLE:
+		XMFLOAT2 triangle[3];
+		XMFLOAT4 color;
+
+		bool operator==(const Command& other) const;
+	};
+	// Requirements of a tessellated quad to the draw call that draws it
+	struct QuadState
+	{
+		const wiGraphics::Texture* texture;
+		const wiGraphics::Sampler* sampler;
+		int atlasPage;
+		bool scissor;
+		wiGraphics::Rect scissorRect;
+		XMFLOAT4 bounds; // left, top, right, bottom
+	};
+	struct Chunk
+	{
+		std::vector<Command> commands;
+		std::vector<Vertex> vertices;
+		std::vector<QuadState> quads;
+		uint32_t atlasGeneration = 0;
+		uint32_t atlasPageMask = 0;
+		bool complete = true;			// false if a text wasn't completely in the atlas
+		uint32_t quadsClipped = 0;
+		uint32_t quadsCulled = 0;
+		uint64_t frame = 0;				// last frame that the chunk was drawn in
+	};
+	struct ChunkKey
+	{
+		const void* widget;
+		uint32_t index;
+		bool operator==(const ChunkKey& other) const { return widget == other.widget && index == other.index; }
+	};
+	struct ChunkKeyHash
+	{
+		size_t operator()(const ChunkKey& key) const { return std::hash<const void*>()(key.widget) * 31 ^ std::hash<uint32_t>()(key.index); }
+	};
+
+	void FinishChunk();
+	void Tessellate(Chunk& chunk) const;
+
+	std::unordered_map<ChunkKey, Chunk, ChunkKeyHash> chunks;
+	std::unordered_map<const void*, uint32_t> chunkCounters;
+	std::vector<const void*> widgetStack;
+	std::vector<Command> current;			// recorded draws of the current chunk
+	std::vector<const Chunk*> pending;		// finished chunks that are not drawn yet
+	std::vector<QuadState> quadStates;
+	wiGraphics::Rect scissor;
+	wiGraphics::CommandList commandlist = wiGraphics::COMMANDLIST_COUNT;
+	bool recording = false;
+	uint64_t frame = 0;
+	uint32_t atlasGeneration = 0;
+
+	std::vector<Vertex> vertices;
+	std::vector<DrawCall> drawcalls;
+	Statistics stats;
+};
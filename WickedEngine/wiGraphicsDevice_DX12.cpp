@@ -6,6 +6,7 @@
 #include "wiHelper.h"
 #include "ResourceMapping.h"
 #include "wiBackLog.h"
+#include "wiShaderCache.h"
 
 #include "Utility/d3dx12.h"
 #include "Utility/D3D12MemAlloc.h"
@@ -2567,6 +2568,8 @@ using namespace DX12_Internal;
 		wiHelper::hash_combine(pso->hash, pDesc->pt);
 		wiHelper::hash_combine(pso->hash, pDesc->sampleMask);
 
+		wiShaderCache::RegisterPipelineState(pso);
+
 		return S_OK;
 	}
 	bool GraphicsDevice_DX12::CreateRenderPass(const RenderPassDesc* pDesc, RenderPass* renderpass)
@@ -4067,6 +4070,7 @@ using namespace DX12_Internal;
 				assert(SUCCEEDED(hr));
 
 				pipelines_worker[cmd].push_back(std::make_pair(pipeline_hash, newpso));
+				wiShaderCache::RecordPipelinePermutation(pso, active_renderpass[cmd]);
 				pipeline = newpso.Get();
 			}
 		}
@@ -0,0 +1,839 @@
+#include "wiGraphicsDevice_Null.h"
+#include "wiBackLog.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wiGraphics
+{
+namespace Null_Internal
+{
+	static const size_t ALLOCATION_PAGE_SIZE = 4 * 1024 * 1024;
+	static const size_t ALLOCATION_ALIGNMENT = 256;
+	static const size_t MAX_STORED_VALIDATION_ERRORS = 256;
+
+	// Internal state of buffers and textures
+	struct Resource_Null
+	{
+		std::vector<uint8_t> data;					// CPU shadow storage
+		int subresources[DSV + 1] = {};				// subresource counters per SUBRESOURCE_TYPE
+		std::shared_ptr<std::atomic<uint64_t>> memory_usage;
+
+		~Resource_Null()
+		{
+			if (memory_usage != nullptr)
+			{
+				memory_usage->fetch_sub(data.size());
+			}
+		}
+	};
+	Resource_Null* to_internal(const GPUResource* param)
+	{
+		return static_cast<Resource_Null*>(param->internal_state.get());
+	}
+
+	// Memory layout of one subresource. Block compressed formats are stored in rows of 4x4 blocks
+	struct SubresourceLayout
+	{
+		size_t rowPitch = 0;
+		uint32_t rowCount = 0;
+		uint32_t depth = 0;
+		size_t size() const { return rowPitch * rowCount * depth; }
+	};
+	SubresourceLayout GetSubresourceLayout(const GraphicsDevice* device, const TextureDesc& desc, uint32_t mip)
+	{
+		const uint32_t width = std::max(1u, desc.Width >> mip);
+		const uint32_t height = std::max(1u, desc.Height >> mip);
+		SubresourceLayout layout;
+		if (device->IsFormatBlockCompressed(desc.Format))
+		{
+			uint32_t blockSize = 16;
+			switch (desc.Format)
+			{
+			case FORMAT_BC1_UNORM:
+			case FORMAT_BC1_UNORM_SRGB:
+			case FORMAT_BC4_UNORM:
+			case FORMAT_BC4_SNORM:
+				blockSize = 8;
+				break;
+			default:
+				break;
+			}
+			layout.rowPitch = size_t((width + 3) / 4) * blockSize;
+			layout.rowCount = (height + 3) / 4;
+		}
+		else
+		{
+			layout.rowPitch = size_t(width) * device->GetFormatStride(desc.Format) * std::max(1u, desc.SampleCount);
+			layout.rowCount = height;
+		}
+		layout.depth = desc.type == TextureDesc::TEXTURE_3D ? std::max(1u, desc.Depth >> mip) : 1;
+		return layout;
+	}
+
+	uint32_t GetFullMipCount(const TextureDesc& desc)
+	{
+		uint32_t size = std::max(desc.Width, desc.Height);
+		if (desc.type == TextureDesc::TEXTURE_3D)
+		{
+			size = std::max(size, desc.Depth);
+		}
+		uint32_t mips = 1;
+		while (size > 1)
+		{
+			size >>= 1;
+			mips++;
+		}
+		return mips;
+	}
+}
+using namespace Null_Internal;
+
+	GraphicsDevice_Null::Statistics& GraphicsDevice_Null::Statistics::operator+=(const Statistics& other)
+	{
+		commandLists += other.commandLists;
+		commands += other.commands;
+		drawCalls += other.drawCalls;
+		dispatches += other.dispatches;
+		renderPasses += other.renderPasses;
+		pipelineStateChanges += other.pipelineStateChanges;
+		resourceBindings += other.resourceBindings;
+		copies += other.copies;
+		barriers += other.barriers;
+		uploadBytes += other.uploadBytes;
+		return *this;
+	}
+
+	GraphicsDevice_Null::GraphicsDevice_Null(int width, int height, bool textureStorage) : textureStorage(textureStorage)
+	{
+		RESOLUTIONWIDTH = width;
+		RESOLUTIONHEIGHT = height;
+		memory_usage = std::make_shared<std::atomic<uint64_t>>(0);
+		placeholder = std::make_shared<int>(0);
+
+		wiBackLog::post("Created GraphicsDevice_Null");
+	}
+
+	GraphicsDevice_Null::Command& GraphicsDevice_Null::record(COMMAND_TYPE type, CommandList cmd)
+	{
+		CommandListState& state = commandlists[cmd];
+		state.stats.commands++;
+		if (!recording)
+		{
+			// The command is overwritten by the next one, only the statistics are kept:
+			if (state.commands.empty())
+			{
+				state.commands.emplace_back();
+			}
+			state.commands.back() = Command();
+			state.commands.back().type = type;
+			return state.commands.back();
+		}
+		state.commands.emplace_back();
+		state.commands.back().type = type;
+		return state.commands.back();
+	}
+	bool GraphicsDevice_Null::validate(bool condition, const char* message)
+	{
+		if (!condition)
+		{
+			validation_error_count.fetch_add(1);
+			std::lock_guard<std::mutex> lock(validation_lock);
+			if (validation_errors.size() < MAX_STORED_VALIDATION_ERRORS)
+			{
+				validation_errors.push_back(message);
+				wiBackLog::post((std::string("[GraphicsDevice_Null] validation error: ") + message).c_str());
+			}
+		}
+		return condition;
+	}
+	void GraphicsDevice_Null::validate_binding(const GPUResource* resource, uint32_t bindflag, const char* message)
+	{
+		if (resource == nullptr || !resource->IsValid())
+		{
+			return;
+		}
+		if (resource->IsTexture())
+		{
+			validate((static_cast<const Texture*>(resource)->desc.BindFlags & bindflag) != 0, message);
+		}
+		else if (resource->IsBuffer())
+		{
+			validate((static_cast<const GPUBuffer*>(resource)->desc.BindFlags & bindflag) != 0, message);
+		}
+	}
+	bool GraphicsDevice_Null::create_storage(GPUResource* resource, size_t size, const SubresourceData* pInitialData, size_t initialDataSize)
+	{
+		auto internal_state = std::make_shared<Resource_Null>();
+		internal_state->data.resize(size);
+		if (pInitialData != nullptr && pInitialData->pSysMem != nullptr && initialDataSize > 0)
+		{
+			memcpy(internal_state->data.data(), pInitialData->pSysMem, std::min(size, initialDataSize));
+		}
+		internal_state->memory_usage = memory_usage;
+		memory_usage->fetch_add(size);
+		resource->internal_state = internal_state;
+		return true;
+	}
+	size_t GraphicsDevice_Null::get_texture_size(const TextureDesc& desc) const
+	{
+		size_t size = 0;
+		for (uint32_t mip = 0; mip < desc.MipLevels; ++mip)
+		{
+			size += GetSubresourceLayout(this, desc, mip).size();
+		}
+		return size * desc.ArraySize;
+	}
+
+	bool GraphicsDevice_Null::CreateBuffer(const GPUBufferDesc *pDesc, const SubresourceData* pInitialData, GPUBuffer *pBuffer)
+	{
+		pBuffer->internal_state = nullptr;
+		pBuffer->type = GPUResource::GPU_RESOURCE_TYPE::BUFFER;
+		pBuffer->desc = *pDesc;
+
+		bool valid = true;
+		valid &= validate(pDesc->ByteWidth > 0, "CreateBuffer: ByteWidth is zero");
+		if (pDesc->BindFlags & BIND_CONSTANT_BUFFER)
+		{
+			valid &= validate(pDesc->BindFlags == BIND_CONSTANT_BUFFER, "CreateBuffer: a constant buffer can't have other bind flags");
+			valid &= validate(pDesc->ByteWidth % 16 == 0, "CreateBuffer: constant buffer size is not a multiple of 16 bytes");
+		}
+		if (pDesc->MiscFlags & RESOURCE_MISC_BUFFER_STRUCTURED)
+		{
+			valid &= validate(pDesc->StructureByteStride > 0, "CreateBuffer: structured buffer without StructureByteStride");
+		}
+		if (pDesc->Usage == USAGE_IMMUTABLE)
+		{
+			valid &= validate(pInitialData != nullptr && pInitialData->pSysMem != nullptr, "CreateBuffer: immutable buffer without initial data");
+		}
+		if (!valid)
+		{
+			return false;
+		}
+
+		return create_storage(pBuffer, pDesc->ByteWidth, pInitialData, pDesc->ByteWidth);
+	}
+	bool GraphicsDevice_Null::CreateTexture(const TextureDesc* pDesc, const SubresourceData *pInitialData, Texture *pTexture)
+	{
+		pTexture->internal_state = nullptr;
+		pTexture->type = GPUResource::GPU_RESOURCE_TYPE::TEXTURE;
+		pTexture->desc = *pDesc;
+
+		bool valid = true;
+		valid &= validate(pDesc->Width > 0, "CreateTexture: Width is zero");
+		valid &= validate(pDesc->type == TextureDesc::TEXTURE_1D || pDesc->Height > 0, "CreateTexture: Height is zero");
+		valid &= validate(pDesc->type != TextureDesc::TEXTURE_3D || pDesc->Depth > 0, "CreateTexture: Depth of 3D texture is zero");
+		valid &= validate(pDesc->ArraySize > 0, "CreateTexture: ArraySize is zero");
+		valid &= validate(pDesc->Format != FORMAT_UNKNOWN, "CreateTexture: Format is unknown");
+		valid &= validate(pDesc->SampleCount > 0 && (pDesc->SampleCount & (pDesc->SampleCount - 1)) == 0, "CreateTexture: SampleCount is not a power of two");
+		valid &= validate(pDesc->SampleCount == 1 || pDesc->MipLevels == 1, "CreateTexture: multisampled texture with mipmaps");
+		valid &= validate((pDesc->BindFlags & (BIND_RENDER_TARGET | BIND_DEPTH_STENCIL)) != (BIND_RENDER_TARGET | BIND_DEPTH_STENCIL), "CreateTexture: texture can't be both render target and depth stencil");
+		if (pDesc->MiscFlags & RESOURCE_MISC_TEXTURECUBE)
+		{
+			valid &= validate(pDesc->ArraySize % 6 == 0, "CreateTexture: cube texture ArraySize is not a multiple of 6");
+		}
+		if (pDesc->Usage == USAGE_IMMUTABLE)
+		{
+			valid &= validate(pInitialData != nullptr, "CreateTexture: immutable texture without initial data");
+		}
+		if (!valid)
+		{
+			return false;
+		}
+
+		if (pTexture->desc.MipLevels == 0)
+		{
+			pTexture->desc.MipLevels = GetFullMipCount(pTexture->desc);
+		}
+		valid &= validate(pTexture->desc.MipLevels <= GetFullMipCount(pTexture->desc), "CreateTexture: MipLevels is more than the full mip chain");
+		if (!valid)
+		{
+			return false;
+		}
+
+		const TextureDesc& desc = pTexture->desc;
+		if (!textureStorage)
+		{
+			pTexture->internal_state = std::make_shared<Resource_Null>();
+			return true;
+		}
+		create_storage(pTexture, get_texture_size(desc), nullptr, 0);
+
+		if (pInitialData != nullptr)
+		{
+			// One SubresourceData for every mip of every array slice, rows are copied with their pitch:
+			uint8_t* dst = to_internal(pTexture)->data.data();
+			for (uint32_t slice = 0; slice < desc.ArraySize; ++slice)
+			{
+				for (uint32_t mip = 0; mip < desc.MipLevels; ++mip)
+				{
+					const SubresourceData& data = pInitialData[slice * desc.MipLevels + mip];
+					const SubresourceLayout layout = GetSubresourceLayout(this, desc, mip);
+					if (data.pSysMem != nullptr)
+					{
+						const size_t srcRowPitch = data.SysMemPitch > 0 ? data.SysMemPitch : layout.rowPitch;
+						const size_t srcSlicePitch = data.SysMemSlicePitch > 0 ? data.SysMemSlicePitch : srcRowPitch * layout.rowCount;
+						const size_t rowSize = std::min(srcRowPitch, layout.rowPitch);
+						for (uint32_t z = 0; z < layout.depth; ++z)
+						{
+							for (uint32_t y = 0; y < layout.rowCount; ++y)
+							{
+								memcpy(
+									dst + (size_t(z) * layout.rowCount + y) * layout.rowPitch,
+									(const uint8_t*)data.pSysMem + z * srcSlicePitch + y * srcRowPitch,
+									rowSize
+								);
+							}
+						}
+					}
+					dst += layout.size();
+				}
+			}
+		}
+		return true;
+	}
+	bool GraphicsDevice_Null::CreateInputLayout(const InputLayoutDesc *pInputElementDescs, uint32_t NumElements, const Shader* /*shader*/, InputLayout *pInputLayout)
+	{
+		pInputLayout->internal_state = nullptr;
+		if (!validate(pInputElementDescs != nullptr && NumElements > 0, "CreateInputLayout: no input elements"))
+		{
+			return false;
+		}
+		pInputLayout->internal_state = placeholder;
+		pInputLayout->desc.assign(pInputElementDescs, pInputElementDescs + NumElements);
+		return true;
+	}
+	bool GraphicsDevice_Null::CreateShader(SHADERSTAGE stage, const void* /*pShaderBytecode*/, size_t /*BytecodeLength*/, Shader *pShader)
+	{
+		// The bytecode is not validated, so the device also works where the compiled shaders are not deployed:
+		pShader->internal_state = placeholder;
+		pShader->stage = stage;
+		return true;
+	}
+	bool GraphicsDevice_Null::CreateBlendState(const BlendStateDesc *pBlendStateDesc, BlendState *pBlendState)
+	{
+		pBlendState->internal_state = placeholder;
+		pBlendState->desc = *pBlendStateDesc;
+		return true;
+	}
+	bool GraphicsDevice_Null::CreateDepthStencilState(const DepthStencilStateDesc *pDepthStencilStateDesc, DepthStencilState *pDepthStencilState)
+	{
+		pDepthStencilState->internal_state = placeholder;
+		pDepthStencilState->desc = *pDepthStencilStateDesc;
+		return true;
+	}
+	bool GraphicsDevice_Null::CreateRasterizerState(const RasterizerStateDesc *pRasterizerStateDesc, RasterizerState *pRasterizerState)
+	{
+		pRasterizerState->internal_state = placeholder;
+		pRasterizerState->desc = *pRasterizerStateDesc;
+		return true;
+	}
+	bool GraphicsDevice_Null::CreateSampler(const SamplerDesc *pSamplerDesc, Sampler *pSamplerState)
+	{
+		pSamplerState->internal_state = placeholder;
+		pSamplerState->desc = *pSamplerDesc;
+		return true;
+	}
+	bool GraphicsDevice_Null::CreateQuery(const GPUQueryDesc *pDesc, GPUQuery *pQuery)
+	{
+		pQuery->internal_state = nullptr;
+		if (!validate(pDesc->Type != GPU_QUERY_TYPE_INVALID, "CreateQuery: query type is invalid"))
+		{
+			return false;
+		}
+		pQuery->internal_state = placeholder;
+		pQuery->desc = *pDesc;
+		return true;
+	}
+	bool GraphicsDevice_Null::CreatePipelineState(const PipelineStateDesc* pDesc, PipelineState* pso)
+	{
+		pso->internal_state = placeholder;
+		pso->desc = *pDesc;
+		return true;
+	}
+	bool GraphicsDevice_Null::CreateRenderPass(const RenderPassDesc* pDesc, RenderPass* renderpass)
+	{
+		renderpass->internal_state = nullptr;
+
+		bool valid = true;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		for (uint32_t i = 0; i < pDesc->numAttachments; ++i)
+		{
+			const RenderPassAttachment& attachment = pDesc->attachments[i];
+			if (!validate(attachment.texture != nullptr, "CreateRenderPass: attachment without texture"))
+			{
+				valid = false;
+				continue;
+			}
+			const TextureDesc& desc = attachment.texture->desc;
+			if (attachment.type == RenderPassAttachment::RENDERTARGET)
+			{
+				valid &= validate((desc.BindFlags & BIND_RENDER_TARGET) != 0, "CreateRenderPass: render target attachment without BIND_RENDER_TARGET");
+			}
+			else
+			{
+				valid &= validate((desc.BindFlags & BIND_DEPTH_STENCIL) != 0, "CreateRenderPass: depth stencil attachment without BIND_DEPTH_STENCIL");
+			}
+			if (width == 0)
+			{
+				width = desc.Width;
+				height = desc.Height;
+			}
+			valid &= validate(desc.Width == width && desc.Height == height, "CreateRenderPass: attachments have different sizes");
+		}
+		if (!valid)
+		{
+			return false;
+		}
+
+		renderpass->internal_state = placeholder;
+		renderpass->desc = *pDesc;
+		return true;
+	}
+
+	int GraphicsDevice_Null::CreateSubresource(Texture* texture, SUBRESOURCE_TYPE type, uint32_t firstSlice, uint32_t sliceCount, uint32_t firstMip, uint32_t mipCount)
+	{
+		if (!texture->IsValid())
+		{
+			return -1;
+		}
+		validate(firstSlice + sliceCount <= texture->desc.ArraySize || texture->desc.type == TextureDesc::TEXTURE_3D, "CreateSubresource: slices are out of range");
+		validate(firstMip + mipCount <= texture->desc.MipLevels, "CreateSubresource: mips are out of range");
+		// Subresources are indexed in the order of creation, separately for every type:
+		return to_internal(texture)->subresources[type]++;
+	}
+
+	bool GraphicsDevice_Null::DownloadResource(const GPUResource* resourceToDownload, const GPUResource* /*resourceDest*/, void* dataDest)
+	{
+		const uint8_t* data = GetShadowData(resourceToDownload);
+		if (data == nullptr || dataDest == nullptr)
+		{
+			return false;
+		}
+		memcpy(dataDest, data, GetShadowSize(resourceToDownload));
+		return true;
+	}
+
+	void GraphicsDevice_Null::PresentBegin(CommandList cmd)
+	{
+		record(COMMAND_EVENT_BEGIN, cmd).name = "Present";
+	}
+	void GraphicsDevice_Null::PresentEnd(CommandList cmd)
+	{
+		record(COMMAND_EVENT_END, cmd);
+
+		// Every command list that was begun in this frame is submitted:
+		frame_stats = Statistics();
+		const uint32_t count = std::min(commandlist_count.load(), (uint32_t)COMMANDLIST_COUNT);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			frame_stats += commandlists[i].stats;
+		}
+		commandlist_count.store(0);
+
+		RESOLUTIONCHANGED = false;
+		FRAMECOUNT++;
+	}
+
+	CommandList GraphicsDevice_Null::BeginCommandList()
+	{
+		const uint32_t index = commandlist_count.fetch_add(1);
+		validate(index < COMMANDLIST_COUNT, "BeginCommandList: too many command lists in a frame");
+		CommandList cmd = (CommandList)(index % COMMANDLIST_COUNT);
+
+		CommandListState& state = commandlists[cmd];
+		state.commands.clear();
+		state.stats = Statistics();
+		state.stats.commandLists = 1;
+		state.pso = nullptr;
+		state.renderpass = nullptr;
+		for (auto& page : state.pages)
+		{
+			page.offset = 0;
+		}
+		state.page = 0;
+
+		return cmd;
+	}
+
+	void GraphicsDevice_Null::SetResolution(int width, int height)
+	{
+		if (width != RESOLUTIONWIDTH || height != RESOLUTIONHEIGHT)
+		{
+			RESOLUTIONWIDTH = width;
+			RESOLUTIONHEIGHT = height;
+			RESOLUTIONCHANGED = true;
+		}
+	}
+
+	Texture GraphicsDevice_Null::GetBackBuffer()
+	{
+		Texture texture;
+		texture.internal_state = std::make_shared<Resource_Null>();
+		texture.type = GPUResource::GPU_RESOURCE_TYPE::TEXTURE;
+		texture.desc.Width = (uint32_t)RESOLUTIONWIDTH;
+		texture.desc.Height = (uint32_t)RESOLUTIONHEIGHT;
+		texture.desc.Format = BACKBUFFER_FORMAT;
+		texture.desc.BindFlags = BIND_RENDER_TARGET;
+		return texture;
+	}
+
+	void GraphicsDevice_Null::RenderPassBegin(const RenderPass* renderpass, CommandList cmd)
+	{
+		CommandListState& state = commandlists[cmd];
+		validate(state.renderpass == nullptr, "RenderPassBegin: a render pass is already active");
+		validate(renderpass != nullptr && renderpass->IsValid(), "RenderPassBegin: render pass is invalid");
+		state.renderpass = renderpass;
+		state.stats.renderPasses++;
+		record(COMMAND_RENDERPASS_BEGIN, cmd).object = renderpass;
+	}
+	void GraphicsDevice_Null::RenderPassEnd(CommandList cmd)
+	{
+		CommandListState& state = commandlists[cmd];
+		validate(state.renderpass != nullptr, "RenderPassEnd: no render pass is active");
+		state.renderpass = nullptr;
+		record(COMMAND_RENDERPASS_END, cmd);
+	}
+	void GraphicsDevice_Null::BindScissorRects(uint32_t numRects, const Rect* /*rects*/, CommandList cmd)
+	{
+		record(COMMAND_BIND_SCISSORRECTS, cmd).count = numRects;
+	}
+	void GraphicsDevice_Null::BindViewports(uint32_t NumViewports, const Viewport* /*pViewports*/, CommandList cmd)
+	{
+		record(COMMAND_BIND_VIEWPORTS, cmd).count = NumViewports;
+	}
+	void GraphicsDevice_Null::BindResource(SHADERSTAGE stage, const GPUResource* resource, uint32_t slot, CommandList cmd, int subresource)
+	{
+		validate_binding(resource, BIND_SHADER_RESOURCE, "BindResource: resource without BIND_SHADER_RESOURCE");
+		commandlists[cmd].stats.resourceBindings++;
+		Command& command = record(COMMAND_BIND_RESOURCE, cmd);
+		command.stage = stage;
+		command.slot = slot;
+		command.count = 1;
+		command.object = resource;
+		command.subresource = subresource;
+	}
+	void GraphicsDevice_Null::BindResources(SHADERSTAGE stage, const GPUResource *const* resources, uint32_t slot, uint32_t count, CommandList cmd)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			BindResource(stage, resources[i], slot + i, cmd);
+		}
+	}
+	void GraphicsDevice_Null::BindUAV(SHADERSTAGE stage, const GPUResource* resource, uint32_t slot, CommandList cmd, int subresource)
+	{
+		validate_binding(resource, BIND_UNORDERED_ACCESS, "BindUAV: resource without BIND_UNORDERED_ACCESS");
+		commandlists[cmd].stats.resourceBindings++;
+		Command& command = record(COMMAND_BIND_UAV, cmd);
+		command.stage = stage;
+		command.slot = slot;
+		command.count = 1;
+		command.object = resource;
+		command.subresource = subresource;
+	}
+	void GraphicsDevice_Null::BindUAVs(SHADERSTAGE stage, const GPUResource *const* resources, uint32_t slot, uint32_t count, CommandList cmd)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			BindUAV(stage, resources[i], slot + i, cmd);
+		}
+	}
+	void GraphicsDevice_Null::UnbindResources(uint32_t slot, uint32_t num, CommandList cmd)
+	{
+		Command& command = record(COMMAND_UNBIND_RESOURCES, cmd);
+		command.slot = slot;
+		command.count = num;
+	}
+	void GraphicsDevice_Null::UnbindUAVs(uint32_t slot, uint32_t num, CommandList cmd)
+	{
+		Command& command = record(COMMAND_UNBIND_UAVS, cmd);
+		command.slot = slot;
+		command.count = num;
+	}
+	void GraphicsDevice_Null::BindSampler(SHADERSTAGE stage, const Sampler* sampler, uint32_t slot, CommandList cmd)
+	{
+		commandlists[cmd].stats.resourceBindings++;
+		Command& command = record(COMMAND_BIND_SAMPLER, cmd);
+		command.stage = stage;
+		command.slot = slot;
+		command.count = 1;
+		command.object = sampler;
+	}
+	void GraphicsDevice_Null::BindConstantBuffer(SHADERSTAGE stage, const GPUBuffer* buffer, uint32_t slot, CommandList cmd)
+	{
+		validate_binding(buffer, BIND_CONSTANT_BUFFER, "BindConstantBuffer: buffer without BIND_CONSTANT_BUFFER");
+		commandlists[cmd].stats.resourceBindings++;
+		Command& command = record(COMMAND_BIND_CONSTANTBUFFER, cmd);
+		command.stage = stage;
+		command.slot = slot;
+		command.count = 1;
+		command.object = buffer;
+	}
+	void GraphicsDevice_Null::BindVertexBuffers(const GPUBuffer *const* vertexBuffers, uint32_t slot, uint32_t count, const uint32_t* strides, const uint32_t* offsets, CommandList cmd)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			validate_binding(vertexBuffers[i], BIND_VERTEX_BUFFER, "BindVertexBuffers: buffer without BIND_VERTEX_BUFFER");
+			commandlists[cmd].stats.resourceBindings++;
+			Command& command = record(COMMAND_BIND_VERTEXBUFFER, cmd);
+			command.slot = slot + i;
+			command.count = 1;
+			command.object = vertexBuffers[i];
+			command.args[0] = strides != nullptr ? strides[i] : 0;
+			command.args[1] = offsets != nullptr ? offsets[i] : 0;
+		}
+	}
+	void GraphicsDevice_Null::BindIndexBuffer(const GPUBuffer* indexBuffer, const INDEXBUFFER_FORMAT format, uint32_t offset, CommandList cmd)
+	{
+		validate_binding(indexBuffer, BIND_INDEX_BUFFER, "BindIndexBuffer: buffer without BIND_INDEX_BUFFER");
+		commandlists[cmd].stats.resourceBindings++;
+		Command& command = record(COMMAND_BIND_INDEXBUFFER, cmd);
+		command.object = indexBuffer;
+		command.args[0] = (uint32_t)format;
+		command.args[1] = offset;
+	}
+	void GraphicsDevice_Null::BindStencilRef(uint32_t value, CommandList cmd)
+	{
+		record(COMMAND_BIND_STENCILREF, cmd).args[0] = value;
+	}
+	void GraphicsDevice_Null::BindBlendFactor(float /*r*/, float /*g*/, float /*b*/, float /*a*/, CommandList cmd)
+	{
+		record(COMMAND_BIND_BLENDFACTOR, cmd);
+	}
+	void GraphicsDevice_Null::BindPipelineState(const PipelineState* pso, CommandList cmd)
+	{
+		CommandListState& state = commandlists[cmd];
+		if (state.pso != pso)
+		{
+			state.pso = pso;
+			state.stats.pipelineStateChanges++;
+		}
+		record(COMMAND_BIND_PIPELINESTATE, cmd).object = pso;
+	}
+	void GraphicsDevice_Null::BindComputeShader(const Shader* cs, CommandList cmd)
+	{
+		record(COMMAND_BIND_COMPUTESHADER, cmd).object = cs;
+	}
+	void GraphicsDevice_Null::Draw(uint32_t vertexCount, uint32_t startVertexLocation, CommandList cmd)
+	{
+		commandlists[cmd].stats.drawCalls++;
+		Command& command = record(COMMAND_DRAW, cmd);
+		command.args[0] = vertexCount;
+		command.args[1] = startVertexLocation;
+	}
+	void GraphicsDevice_Null::DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, uint32_t baseVertexLocation, CommandList cmd)
+	{
+		commandlists[cmd].stats.drawCalls++;
+		Command& command = record(COMMAND_DRAW_INDEXED, cmd);
+		command.args[0] = indexCount;
+		command.args[1] = startIndexLocation;
+		command.args[2] = baseVertexLocation;
+	}
+	void GraphicsDevice_Null::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation, CommandList cmd)
+	{
+		commandlists[cmd].stats.drawCalls++;
+		Command& command = record(COMMAND_DRAW_INSTANCED, cmd);
+		command.args[0] = vertexCount;
+		command.args[1] = instanceCount;
+		command.args[2] = startVertexLocation;
+		command.args[3] = startInstanceLocation;
+	}
+	void GraphicsDevice_Null::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, uint32_t baseVertexLocation, uint32_t startInstanceLocation, CommandList cmd)
+	{
+		commandlists[cmd].stats.drawCalls++;
+		Command& command = record(COMMAND_DRAW_INDEXED_INSTANCED, cmd);
+		command.args[0] = indexCount;
+		command.args[1] = instanceCount;
+		command.args[2] = startIndexLocation;
+		command.args[3] = baseVertexLocation;
+		command.args[4] = startInstanceLocation;
+	}
+	void GraphicsDevice_Null::DrawInstancedIndirect(const GPUBuffer* args, uint32_t args_offset, CommandList cmd)
+	{
+		commandlists[cmd].stats.drawCalls++;
+		Command& command = record(COMMAND_DRAW_INSTANCED_INDIRECT, cmd);
+		command.object = args;
+		command.args[0] = args_offset;
+	}
+	void GraphicsDevice_Null::DrawIndexedInstancedIndirect(const GPUBuffer* args, uint32_t args_offset, CommandList cmd)
+	{
+		commandlists[cmd].stats.drawCalls++;
+		Command& command = record(COMMAND_DRAW_INDEXED_INSTANCED_INDIRECT, cmd);
+		command.object = args;
+		command.args[0] = args_offset;
+	}
+	void GraphicsDevice_Null::Dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ, CommandList cmd)
+	{
+		commandlists[cmd].stats.dispatches++;
+		Command& command = record(COMMAND_DISPATCH, cmd);
+		command.args[0] = threadGroupCountX;
+		command.args[1] = threadGroupCountY;
+		command.args[2] = threadGroupCountZ;
+	}
+	void GraphicsDevice_Null::DispatchIndirect(const GPUBuffer* args, uint32_t args_offset, CommandList cmd)
+	{
+		commandlists[cmd].stats.dispatches++;
+		Command& command = record(COMMAND_DISPATCH_INDIRECT, cmd);
+		command.object = args;
+		command.args[0] = args_offset;
+	}
+	void GraphicsDevice_Null::CopyResource(const GPUResource* pDst, const GPUResource* pSrc, CommandList cmd)
+	{
+		commandlists[cmd].stats.copies++;
+		Command& command = record(COMMAND_COPY_RESOURCE, cmd);
+		command.object = pDst;
+		command.source = pSrc;
+
+		if (pDst != nullptr && pSrc != nullptr && pDst->IsValid() && pSrc->IsValid())
+		{
+			Resource_Null* dst = to_internal(pDst);
+			const Resource_Null* src = to_internal(pSrc);
+			if (validate(dst->data.size() == src->data.size(), "CopyResource: resources have different sizes"))
+			{
+				dst->data = src->data;
+			}
+		}
+	}
+	void GraphicsDevice_Null::CopyTexture2D_Region(const Texture* pDst, uint32_t dstMip, uint32_t dstX, uint32_t dstY, const Texture* pSrc, uint32_t srcMip, CommandList cmd)
+	{
+		commandlists[cmd].stats.copies++;
+		Command& command = record(COMMAND_COPY_TEXTURE_REGION, cmd);
+		command.object = pDst;
+		command.source = pSrc;
+		command.args[0] = dstMip;
+		command.args[1] = dstX;
+		command.args[2] = dstY;
+		command.args[3] = srcMip;
+	}
+	void GraphicsDevice_Null::MSAAResolve(const Texture* pDst, const Texture* pSrc, CommandList cmd)
+	{
+		validate(pSrc != nullptr && pSrc->desc.SampleCount > 1, "MSAAResolve: source is not multisampled");
+		commandlists[cmd].stats.copies++;
+		Command& command = record(COMMAND_MSAA_RESOLVE, cmd);
+		command.object = pDst;
+		command.source = pSrc;
+	}
+	void GraphicsDevice_Null::UpdateBuffer(const GPUBuffer* buffer, const void* data, CommandList cmd, int dataSize)
+	{
+		if (buffer == nullptr || !buffer->IsValid() || data == nullptr)
+		{
+			return;
+		}
+		const size_t size = dataSize < 0 ? buffer->desc.ByteWidth : (size_t)dataSize;
+		if (!validate(size <= buffer->desc.ByteWidth, "UpdateBuffer: data is larger than the buffer"))
+		{
+			return;
+		}
+		validate(buffer->desc.Usage != USAGE_IMMUTABLE, "UpdateBuffer: buffer is immutable");
+
+		Resource_Null* internal_state = to_internal(buffer);
+		memcpy(internal_state->data.data(), data, size);
+
+		commandlists[cmd].stats.uploadBytes += size;
+		Command& command = record(COMMAND_UPDATE_BUFFER, cmd);
+		command.object = buffer;
+		command.size = (uint32_t)size;
+	}
+	void GraphicsDevice_Null::QueryBegin(const GPUQuery *query, CommandList cmd)
+	{
+		record(COMMAND_QUERY_BEGIN, cmd).object = query;
+	}
+	void GraphicsDevice_Null::QueryEnd(const GPUQuery *query, CommandList cmd)
+	{
+		record(COMMAND_QUERY_END, cmd).object = query;
+	}
+	bool GraphicsDevice_Null::QueryRead(const GPUQuery* /*query*/, GPUQueryResult* result)
+	{
+		*result = GPUQueryResult();
+		return true;
+	}
+	void GraphicsDevice_Null::Barrier(const GPUBarrier* /*barriers*/, uint32_t numBarriers, CommandList cmd)
+	{
+		commandlists[cmd].stats.barriers += numBarriers;
+		record(COMMAND_BARRIER, cmd).count = numBarriers;
+	}
+
+	GraphicsDevice::GPUAllocation GraphicsDevice_Null::AllocateGPU(size_t dataSize, CommandList cmd)
+	{
+		GPUAllocation allocation;
+		if (dataSize == 0)
+		{
+			return allocation;
+		}
+
+		// Allocations are linear within the command list, so every allocation of the frame can be inspected through the recorded bindings:
+		CommandListState& state = commandlists[cmd];
+		const size_t alignedSize = (dataSize + ALLOCATION_ALIGNMENT - 1) / ALLOCATION_ALIGNMENT * ALLOCATION_ALIGNMENT;
+		while (state.page < state.pages.size() && state.pages[state.page].offset + alignedSize > state.pages[state.page].buffer.desc.ByteWidth)
+		{
+			state.page++;
+		}
+		if (state.page == state.pages.size())
+		{
+			state.pages.emplace_back();
+			GPUBufferDesc desc;
+			desc.ByteWidth = (uint32_t)std::max(ALLOCATION_PAGE_SIZE, alignedSize);
+			desc.Usage = USAGE_DYNAMIC;
+			desc.BindFlags = BIND_VERTEX_BUFFER | BIND_INDEX_BUFFER | BIND_SHADER_RESOURCE;
+			desc.CPUAccessFlags = CPU_ACCESS_WRITE;
+			desc.MiscFlags = RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+			CreateBuffer(&desc, nullptr, &state.pages.back().buffer);
+		}
+
+		CommandListState::AllocationPage& page = state.pages[state.page];
+		allocation.data = to_internal(&page.buffer)->data.data() + page.offset;
+		allocation.buffer = &page.buffer;
+		allocation.offset = (uint32_t)page.offset;
+		page.offset += alignedSize;
+
+		state.stats.uploadBytes += dataSize;
+		return allocation;
+	}
+
+	void GraphicsDevice_Null::EventBegin(const char* name, CommandList cmd)
+	{
+		Command& command = record(COMMAND_EVENT_BEGIN, cmd);
+		if (recording)
+		{
+			command.name = name;
+		}
+	}
+	void GraphicsDevice_Null::EventEnd(CommandList cmd)
+	{
+		record(COMMAND_EVENT_END, cmd);
+	}
+	void GraphicsDevice_Null::SetMarker(const char* name, CommandList cmd)
+	{
+		Command& command = record(COMMAND_MARKER, cmd);
+		if (recording)
+		{
+			command.name = name;
+		}
+	}
+
+	const uint8_t* GraphicsDevice_Null::GetShadowData(const GPUResource* resource) const
+	{
+		if (resource == nullptr || !resource->IsValid() || (!resource->IsBuffer() && !resource->IsTexture()))
+		{
+			return nullptr;
+		}
+		const Resource_Null* internal_state = to_internal(resource);
+		return internal_state->data.empty() ? nullptr : internal_state->data.data();
+	}
+	size_t GraphicsDevice_Null::GetShadowSize(const GPUResource* resource) const
+	{
+		if (GetShadowData(resource) == nullptr)
+		{
+			return 0;
+		}
+		return to_internal(resource)->data.size();
+	}
+
+	std::vector<std::string> GraphicsDevice_Null::GetValidationErrors() const
+	{
+		std::lock_guard<std::mutex> lock(validation_lock);
+		return validation_errors;
+	}
+
+}
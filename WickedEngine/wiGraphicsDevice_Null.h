@@ -0,0 +1,222 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiGraphicsDevice.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace wiGraphics
+{
+	// Graphics device without a GPU, for headless runs (dedicated servers, load tests, regression tests)
+	//	Buffers and textures get CPU shadow storage that is filled with the initial data, UpdateBuffer() and CopyResource(), and can be read back with DownloadResource().
+	//	Nothing is rendered: draws, dispatches and copies of texture regions don't modify the shadow storage.
+	//	Resource descriptions are validated on creation and bindings are validated against the bind flags, the errors are collected and posted to the backlog.
+	//	Every command is recorded into an inspectable stream per command list, and counted in the statistics.
+	class GraphicsDevice_Null : public GraphicsDevice
+	{
+	public:
+		enum COMMAND_TYPE
+		{
+			COMMAND_RENDERPASS_BEGIN,
+			COMMAND_RENDERPASS_END,
+			COMMAND_BIND_SCISSORRECTS,
+			COMMAND_BIND_VIEWPORTS,
+			COMMAND_BIND_RESOURCE,
+			COMMAND_BIND_UAV,
+			COMMAND_UNBIND_RESOURCES,
+			COMMAND_UNBIND_UAVS,
+			COMMAND_BIND_SAMPLER,
+			COMMAND_BIND_CONSTANTBUFFER,
+			COMMAND_BIND_VERTEXBUFFER,
+			COMMAND_BIND_INDEXBUFFER,
+			COMMAND_BIND_STENCILREF,
+			COMMAND_BIND_BLENDFACTOR,
+			COMMAND_BIND_PIPELINESTATE,
+			COMMAND_BIND_COMPUTESHADER,
+			COMMAND_DRAW,
+			COMMAND_DRAW_INDEXED,
+			COMMAND_DRAW_INSTANCED,
+			COMMAND_DRAW_INDEXED_INSTANCED,
+			COMMAND_DRAW_INSTANCED_INDIRECT,
+			COMMAND_DRAW_INDEXED_INSTANCED_INDIRECT,
+			COMMAND_DISPATCH,
+			COMMAND_DISPATCH_INDIRECT,
+			COMMAND_COPY_RESOURCE,
+			COMMAND_COPY_TEXTURE_REGION,
+			COMMAND_MSAA_RESOLVE,
+			COMMAND_UPDATE_BUFFER,
+			COMMAND_QUERY_BEGIN,
+			COMMAND_QUERY_END,
+			COMMAND_BARRIER,
+			COMMAND_EVENT_BEGIN,
+			COMMAND_EVENT_END,
+			COMMAND_MARKER,
+			COMMAND_TYPE_COUNT
+		};
+		struct Command
+		{
+			COMMAND_TYPE type = COMMAND_TYPE_COUNT;
+			SHADERSTAGE stage = SHADERSTAGE_COUNT;
+			uint32_t slot = 0;
+			uint32_t count = 0;				// number of resources, viewports, scissor rects or barriers
+			const void* object = nullptr;	// the resource, sampler, pipeline state, render pass, shader or query that the command uses. nullptr when unbinding
+			const void* source = nullptr;	// the source of copies and resolves
+			int subresource = -1;
+			uint32_t args[5] = {};			// arguments of draws and dispatches in declaration order, offset of vertex and index buffers or the value of BindStencilRef()
+			uint32_t size = 0;				// bytes written by UpdateBuffer()
+			std::string name;				// events and markers
+		};
+		struct Statistics
+		{
+			uint32_t commandLists = 0;
+			uint32_t commands = 0;
+			uint32_t drawCalls = 0;
+			uint32_t dispatches = 0;
+			uint32_t renderPasses = 0;
+			uint32_t pipelineStateChanges = 0;	// BindPipelineState() calls that bound a different pipeline state than the one before
+			uint32_t resourceBindings = 0;		// resources, UAVs, samplers, constant buffers, vertex and index buffers
+			uint32_t copies = 0;				// CopyResource(), CopyTexture2D_Region() and MSAAResolve()
+			uint32_t barriers = 0;
+			uint64_t uploadBytes = 0;			// UpdateBuffer() and AllocateGPU() bytes
+
+			Statistics& operator+=(const Statistics& other);
+		};
+
+		GraphicsDevice_Null(int width = 1920, int height = 1080, bool textureStorage = true);
+
+		bool CreateBuffer(const GPUBufferDesc *pDesc, const SubresourceData* pInitialData, GPUBuffer *pBuffer) override;
+		bool CreateTexture(const TextureDesc* pDesc, const SubresourceData *pInitialData, Texture *pTexture) override;
+		bool CreateInputLayout(const InputLayoutDesc *pInputElementDescs, uint32_t NumElements, const Shader* shader, InputLayout *pInputLayout) override;
+		bool CreateShader(SHADERSTAGE stage, const void *pShaderBytecode, size_t BytecodeLength, Shader *pShader) override;
+		bool CreateBlendState(const BlendStateDesc *pBlendStateDesc, BlendState *pBlendState) override;
+		bool CreateDepthStencilState(const DepthStencilStateDesc *pDepthStencilStateDesc, DepthStencilState *pDepthStencilState) override;
+		bool CreateRasterizerState(const RasterizerStateDesc *pRasterizerStateDesc, RasterizerState *pRasterizerState) override;
+		bool CreateSampler(const SamplerDesc *pSamplerDesc, Sampler *pSamplerState) override;
+		bool CreateQuery(const GPUQueryDesc *pDesc, GPUQuery *pQuery) override;
+		bool CreatePipelineState(const PipelineStateDesc* pDesc, PipelineState* pso) override;
+		bool CreateRenderPass(const RenderPassDesc* pDesc, RenderPass* renderpass) override;
+
+		int CreateSubresource(Texture* texture, SUBRESOURCE_TYPE type, uint32_t firstSlice, uint32_t sliceCount, uint32_t firstMip, uint32_t mipCount) override;
+
+		bool DownloadResource(const GPUResource* resourceToDownload, const GPUResource* resourceDest, void* dataDest) override;
+
+		void SetName(GPUResource* /*pResource*/, const char* /*name*/) override {}
+
+		void PresentBegin(CommandList cmd) override;
+		void PresentEnd(CommandList cmd) override;
+
+		CommandList BeginCommandList() override;
+
+		void WaitForGPU() override {}
+
+		void SetResolution(int width, int height) override;
+
+		Texture GetBackBuffer() override;
+
+		///////////////Thread-sensitive////////////////////////
+
+		void RenderPassBegin(const RenderPass* renderpass, CommandList cmd) override;
+		void RenderPassEnd(CommandList cmd) override;
+		void BindScissorRects(uint32_t numRects, const Rect* rects, CommandList cmd) override;
+		void BindViewports(uint32_t NumViewports, const Viewport* pViewports, CommandList cmd) override;
+		void BindResource(SHADERSTAGE stage, const GPUResource* resource, uint32_t slot, CommandList cmd, int subresource = -1) override;
+		void BindResources(SHADERSTAGE stage, const GPUResource *const* resources, uint32_t slot, uint32_t count, CommandList cmd) override;
+		void BindUAV(SHADERSTAGE stage, const GPUResource* resource, uint32_t slot, CommandList cmd, int subresource = -1) override;
+		void BindUAVs(SHADERSTAGE stage, const GPUResource *const* resources, uint32_t slot, uint32_t count, CommandList cmd) override;
+		void UnbindResources(uint32_t slot, uint32_t num, CommandList cmd) override;
+		void UnbindUAVs(uint32_t slot, uint32_t num, CommandList cmd) override;
+		void BindSampler(SHADERSTAGE stage, const Sampler* sampler, uint32_t slot, CommandList cmd) override;
+		void BindConstantBuffer(SHADERSTAGE stage, const GPUBuffer* buffer, uint32_t slot, CommandList cmd) override;
+		void BindVertexBuffers(const GPUBuffer *const* vertexBuffers, uint32_t slot, uint32_t count, const uint32_t* strides, const uint32_t* offsets, CommandList cmd) override;
+		void BindIndexBuffer(const GPUBuffer* indexBuffer, const INDEXBUFFER_FORMAT format, uint32_t offset, CommandList cmd) override;
+		void BindStencilRef(uint32_t value, CommandList cmd) override;
+		void BindBlendFactor(float r, float g, float b, float a, CommandList cmd) override;
+		void BindPipelineState(const PipelineState* pso, CommandList cmd) override;
+		void BindComputeShader(const Shader* cs, CommandList cmd) override;
+		void Draw(uint32_t vertexCount, uint32_t startVertexLocation, CommandList cmd) override;
+		void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, uint32_t baseVertexLocation, CommandList cmd) override;
+		void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation, CommandList cmd) override;
+		void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, uint32_t baseVertexLocation, uint32_t startInstanceLocation, CommandList cmd) override;
+		void DrawInstancedIndirect(const GPUBuffer* args, uint32_t args_offset, CommandList cmd) override;
+		void DrawIndexedInstancedIndirect(const GPUBuffer* args, uint32_t args_offset, CommandList cmd) override;
+		void Dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ, CommandList cmd) override;
+		void DispatchIndirect(const GPUBuffer* args, uint32_t args_offset, CommandList cmd) override;
+		void CopyResource(const GPUResource* pDst, const GPUResource* pSrc, CommandList cmd) override;
+		void CopyTexture2D_Region(const Texture* pDst, uint32_t dstMip, uint32_t dstX, uint32_t dstY, const Texture* pSrc, uint32_t srcMip, CommandList cmd) override;
+		void MSAAResolve(const Texture* pDst, const Texture* pSrc, CommandList cmd) override;
+		void UpdateBuffer(const GPUBuffer* buffer, const void* data, CommandList cmd, int dataSize = -1) override;
+		void QueryBegin(const GPUQuery *query, CommandList cmd) override;
+		void QueryEnd(const GPUQuery *query, CommandList cmd) override;
+		bool QueryRead(const GPUQuery *query, GPUQueryResult* result) override;
+		void Barrier(const GPUBarrier* barriers, uint32_t numBarriers, CommandList cmd) override;
+
+		GPUAllocation AllocateGPU(size_t dataSize, CommandList cmd) override;
+
+		void EventBegin(const char* name, CommandList cmd) override;
+		void EventEnd(CommandList cmd) override;
+		void SetMarker(const char* name, CommandList cmd) override;
+
+		// Commands are recorded by default. Without recording, they are only counted in the statistics (less overhead for load tests)
+		void SetCommandRecording(bool value) { recording = value; }
+		bool IsCommandRecording() const { return recording; }
+
+		// Commands of the command list since it was begun. They are kept after PresentEnd(), until the command list is begun in the next frame
+		const std::vector<Command>& GetCommands(CommandList cmd) const { return commandlists[cmd].commands; }
+		// Statistics of the command list since it was begun
+		const Statistics& GetStatistics(CommandList cmd) const { return commandlists[cmd].stats; }
+		// Statistics of every command list of the last presented frame
+		const Statistics& GetFrameStatistics() const { return frame_stats; }
+
+		// CPU shadow storage of a buffer or texture, or nullptr. Texture subresources are stored mip by mip for every array slice
+		const uint8_t* GetShadowData(const GPUResource* resource) const;
+		size_t GetShadowSize(const GPUResource* resource) const;
+		// Shadow storage of the alive buffers and textures in bytes
+		uint64_t GetMemoryUsage() const { return memory_usage->load(); }
+
+		// Number of validation errors since the device was created, and the first ones of them
+		uint32_t GetValidationErrorCount() const { return validation_error_count.load(); }
+		std::vector<std::string> GetValidationErrors() const;
+
+	private:
+		bool textureStorage = true;
+		bool recording = true;
+
+		struct CommandListState
+		{
+			std::vector<Command> commands;
+			Statistics stats;
+			const PipelineState* pso = nullptr;
+			const RenderPass* renderpass = nullptr;
+
+			struct AllocationPage
+			{
+				GPUBuffer buffer;
+				size_t offset = 0;
+			};
+			std::deque<AllocationPage> pages;
+			size_t page = 0;
+		};
+		CommandListState commandlists[COMMANDLIST_COUNT];
+		std::atomic<uint32_t> commandlist_count{ 0 };
+		Statistics frame_stats;
+
+		std::shared_ptr<std::atomic<uint64_t>> memory_usage;
+		std::shared_ptr<void> placeholder;
+
+		std::atomic<uint32_t> validation_error_count{ 0 };
+		mutable std::mutex validation_lock;
+		std::vector<std::string> validation_errors;
+
+		Command& record(COMMAND_TYPE type, CommandList cmd);
+		// Returns the condition, and reports the message if it is false
+		bool validate(bool condition, const char* message);
+		void validate_binding(const GPUResource* resource, uint32_t bindflag, const char* message);
+		bool create_storage(GPUResource* resource, size_t size, const SubresourceData* pInitialData, size_t initialDataSize);
+		size_t get_texture_size(const TextureDesc& desc) const;
+	};
+
+}
@@ -7,6 +7,7 @@
 #include "wiHelper.h"
 #include "ShaderInterop_Vulkan.h"
 #include "wiBackLog.h"
+#include "wiShaderCache.h"
 #include "wiVersion.h"
 
 #define VMA_IMPLEMENTATION
@@ -3248,6 +3249,8 @@ using namespace Vulkan_Internal;
 		wiHelper::hash_combine(pso->hash, pDesc->pt);
 		wiHelper::hash_combine(pso->hash, pDesc->sampleMask);
 
+		wiShaderCache::RegisterPipelineState(pso);
+
 		return true;
 	}
 	bool GraphicsDevice_Vulkan::CreateRenderPass(const RenderPassDesc* pDesc, RenderPass* renderpass)
@@ -4548,6 +4551,7 @@ using namespace Vulkan_Internal;
 				assert(res == VK_SUCCESS);
 
 				pipelines_worker[cmd].push_back(std::make_pair(pipeline_hash, pipeline));
+				wiShaderCache::RecordPipelinePermutation(pso, active_renderpass[cmd]);
 			}
 		}
 		else
@@ -141,6 +141,37 @@ void wiHairParticle::UpdateCPU(const TransformComponent& transform, const MeshCo
 	}
 
 }
+void wiHairParticle::CopyForRendering(const wiHairParticle& other, bool same_entity)
+{
+	cb = other.cb;
+	particleBuffer = other.particleBuffer;
+	simulationBuffer = other.simulationBuffer;
+	indexBuffer = other.indexBuffer;
+	vertexBuffer_length = other.vertexBuffer_length;
+
+	_flags = other._flags;
+	meshID = other.meshID;
+	strandCount = other.strandCount;
+	segmentCount = other.segmentCount;
+	randomSeed = other.randomSeed;
+	length = other.length;
+	stiffness = other.stiffness;
+	randomness = other.randomness;
+	viewDistance = other.viewDistance;
+	framesX = other.framesX;
+	framesY = other.framesY;
+	frameCount = other.frameCount;
+	frameStart = other.frameStart;
+	world = other.world;
+	worldPrev = other.worldPrev;
+	aabb = other.aabb;
+
+	// vertex_lengths is already baked into vertexBuffer_length, and indices only changes in the frame when the buffers are rebuilt:
+	if (!same_entity || (other._flags & REGENERATE_FRAME))
+	{
+		indices = other.indices;
+	}
+}
 void wiHairParticle::UpdateGPU(const MeshComponent& mesh, const MaterialComponent& material, CommandList cmd) const
 {
 	if (strandCount == 0 || !particleBuffer.IsValid())
@@ -25,6 +25,9 @@ private:
 public:
 
 	void UpdateCPU(const TransformComponent& transform, const MeshComponent& mesh, float dt);
+	// Copies everything that is needed to render the other hair particle system (vertex_lengths is not copied)
+	//	same_entity: this holds the previous copy of the same hair particle system
+	void CopyForRendering(const wiHairParticle& other, bool same_entity);
 	void UpdateGPU(const MeshComponent& mesh, const MaterialComponent& material, wiGraphics::CommandList cmd) const;
 	void Draw(const CameraComponent& camera, const MaterialComponent& material, RENDERPASS renderPass, bool transparent, wiGraphics::CommandList cmd) const;
 
@@ -12,6 +12,7 @@
 #include <fstream>
 #include <sstream>
 #include <codecvt> // string conversion
+#include <filesystem>
 
 #ifdef _WIN32
 #ifdef PLATFORM_UWP
@@ -21,6 +22,9 @@
 #include <Commdlg.h> // openfile
 #include <WinBase.h>
 #endif // PLATFORM_UWP
+#else
+#include <sys/stat.h>
+#include <cerrno>
 #endif // _WIN32
 
 using namespace std;
@@ -508,6 +512,57 @@ namespace wiHelper
 #endif
 	}
 
+	bool FileStatus(const std::string& fileName, uint64_t& size, uint64_t& modifiedTime)
+	{
+#ifdef _WIN32
+		wstring wstr;
+		StringConvert(ExpandPath(fileName), wstr);
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		if (!GetFileAttributesExW(wstr.c_str(), GetFileExInfoStandard, &data))
+		{
+			return false;
+		}
+		size = (uint64_t(data.nFileSizeHigh) << 32) | uint64_t(data.nFileSizeLow);
+		modifiedTime = (uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | uint64_t(data.ftLastWriteTime.dwLowDateTime);
+		return true;
+#else
+		struct stat info;
+		if (stat(fileName.c_str(), &info) != 0)
+		{
+			return false;
+		}
+		size = (uint64_t)info.st_size;
+		modifiedTime = (uint64_t)info.st_mtim.tv_sec * 1000000000ull + (uint64_t)info.st_mtim.tv_nsec;
+		return true;
+#endif // _WIN32
+	}
+
+	bool DirectoryCreate(const std::string& path)
+	{
+#ifdef _WIN32
+		wstring wstr;
+		StringConvert(ExpandPath(path), wstr);
+#ifdef PLATFORM_UWP
+		if (CreateDirectoryFromAppW(wstr.c_str(), nullptr))
+#else
+		if (CreateDirectoryW(wstr.c_str(), nullptr))
+#endif // PLATFORM_UWP
+		{
+			return true;
+		}
+		return GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+		return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif // _WIN32
+	}
+
+	bool DirectoryDelete(const std::string& path)
+	{
+		std::error_code ec;
+		std::filesystem::remove_all(path, ec);
+		return !ec;
+	}
+
 	void FileDialog(const FileDialogParams& params, std::function<void(std::string fileName)> onSuccess)
 	{
 #ifdef _WIN32
@@ -71,6 +71,15 @@ namespace wiHelper
 
 	bool FileExists(const std::string& fileName);
 
+	// Returns the size and the last modification time of the file, or false if it can't be found
+	bool FileStatus(const std::string& fileName, uint64_t& size, uint64_t& modifiedTime);
+
+	// Creates a directory if it doesn't exist yet, the parent directory must exist
+	bool DirectoryCreate(const std::string& path);
+
+	// Deletes a directory together with everything in it, returns true if it doesn't exist afterwards
+	bool DirectoryDelete(const std::string& path);
+
 	struct FileDialogParams
 	{
 		enum TYPE
@@ -7,6 +7,7 @@
 #include "wiScene.h"
 #include "ShaderInterop_Image.h"
 #include "wiBackLog.h"
+#include "wiGUIBatch.h"
 
 #include <atomic>
 
@@ -35,56 +36,190 @@ namespace wiImage
 	RasterizerState			rasterizerState;
 	DepthStencilState		depthStencilStates[STENCILMODE_COUNT][STENCILREFMODE_COUNT];
 	PipelineState			imagePSO[IMAGE_SHADER_COUNT][BLENDMODE_COUNT][STENCILMODE_COUNT][STENCILREFMODE_COUNT];
+	Shader					instancedVS;
+	InputLayout				instancedInputLayout;
+	PipelineState			imagePSO_instanced[IMAGE_SHADER_COUNT][BLENDMODE_COUNT][STENCILMODE_COUNT][STENCILREFMODE_COUNT]; // the FULLSCREEN shader is never instanced
 
 	std::atomic_bool initialized{ false };
 
-
-	void Draw(const Texture* texture, const wiImageParams& params, CommandList cmd)
+	// Per instance data of imageVS_instanced, the same as the corners, texture transforms and color of ImageCB
+	struct ImageInstance
 	{
-		if (!initialized.load())
+		XMFLOAT4 corners[4];
+		XMFLOAT4 texMulAdd;
+		XMFLOAT4 texMulAdd2;
+		XMFLOAT4 color;
+	};
+	// Images of consecutive Draw() calls are gathered per command list, a run of images with the same state is one instanced draw
+	struct ImageBatch
+	{
+		struct Run
 		{
-			return;
-		}
-
-		GraphicsDevice* device = wiRenderer::GetDevice();
-		device->EventBegin("Image", cmd);
+			const Texture* texture;
+			const Texture* mask;
+			const Sampler* sampler;
+			const PipelineState* pso;
+			uint32_t stencilRef;
+			uint32_t instanceOffset;
+			uint32_t instanceCount;
+		};
+		vector<ImageInstance> instances;
+		vector<Run> runs;
+		int depth = 0;
+	};
+	ImageBatch batches[COMMANDLIST_COUNT];
 
-		device->BindResource(PS, texture, TEXSLOT_IMAGE_BASE, cmd);
-
-		uint32_t stencilRef = params.stencilRef;
-		if (params.stencilRefMode == STENCILREFMODE_USER)
-		{
-			stencilRef = wiRenderer::CombineStencilrefs(STENCILREF_EMPTY, (uint8_t)stencilRef);
-		}
-		device->BindStencilRef(stencilRef, cmd);
+	std::atomic<uint32_t> statDrawCalls{ 0 };
+	std::atomic<uint32_t> statImages{ 0 };
+	std::atomic<uint32_t> statImagesCulled{ 0 };
 
+	const Sampler* GetSampler(const wiImageParams& params)
+	{
 		if (params.quality == QUALITY_NEAREST)
 		{
 			if (params.sampleFlag == SAMPLEMODE_MIRROR)
-				device->BindSampler(PS, wiRenderer::GetSampler(SSLOT_POINT_MIRROR), SSLOT_ONDEMAND0, cmd);
+				return wiRenderer::GetSampler(SSLOT_POINT_MIRROR);
 			else if (params.sampleFlag == SAMPLEMODE_WRAP)
-				device->BindSampler(PS, wiRenderer::GetSampler(SSLOT_POINT_WRAP), SSLOT_ONDEMAND0, cmd);
+				return wiRenderer::GetSampler(SSLOT_POINT_WRAP);
 			else if (params.sampleFlag == SAMPLEMODE_CLAMP)
-				device->BindSampler(PS, wiRenderer::GetSampler(SSLOT_POINT_CLAMP), SSLOT_ONDEMAND0, cmd);
+				return wiRenderer::GetSampler(SSLOT_POINT_CLAMP);
 		}
 		else if (params.quality == QUALITY_LINEAR)
 		{
 			if (params.sampleFlag == SAMPLEMODE_MIRROR)
-				device->BindSampler(PS, wiRenderer::GetSampler(SSLOT_LINEAR_MIRROR), SSLOT_ONDEMAND0, cmd);
+				return wiRenderer::GetSampler(SSLOT_LINEAR_MIRROR);
 			else if (params.sampleFlag == SAMPLEMODE_WRAP)
-				device->BindSampler(PS, wiRenderer::GetSampler(SSLOT_LINEAR_WRAP), SSLOT_ONDEMAND0, cmd);
+				return wiRenderer::GetSampler(SSLOT_LINEAR_WRAP);
 			else if (params.sampleFlag == SAMPLEMODE_CLAMP)
-				device->BindSampler(PS, wiRenderer::GetSampler(SSLOT_LINEAR_CLAMP), SSLOT_ONDEMAND0, cmd);
+				return wiRenderer::GetSampler(SSLOT_LINEAR_CLAMP);
 		}
 		else if (params.quality == QUALITY_ANISOTROPIC)
 		{
 			if (params.sampleFlag == SAMPLEMODE_MIRROR)
-				device->BindSampler(PS, wiRenderer::GetSampler(SSLOT_ANISO_MIRROR), SSLOT_ONDEMAND0, cmd);
+				return wiRenderer::GetSampler(SSLOT_ANISO_MIRROR);
 			else if (params.sampleFlag == SAMPLEMODE_WRAP)
-				device->BindSampler(PS, wiRenderer::GetSampler(SSLOT_ANISO_WRAP), SSLOT_ONDEMAND0, cmd);
+				return wiRenderer::GetSampler(SSLOT_ANISO_WRAP);
 			else if (params.sampleFlag == SAMPLEMODE_CLAMP)
-				device->BindSampler(PS, wiRenderer::GetSampler(SSLOT_ANISO_CLAMP), SSLOT_ONDEMAND0, cmd);
+				return wiRenderer::GetSampler(SSLOT_ANISO_CLAMP);
 		}
+		return nullptr;
+	}
+
+	// Returns true if the corners (in clip space) are all on the outer side of one of the canvas edges.
+	//	Corners behind the camera are not projected, so such images are never culled
+	bool IsOutsideCanvas(const XMFLOAT4 corners[4])
+	{
+		bool left = true, right = true, top = true, bottom = true;
+		for (int i = 0; i < 4; ++i)
+		{
+			const XMFLOAT4& c = corners[i];
+			if (c.w <= 0)
+			{
+				return false;
+			}
+			left &= c.x < -c.w;
+			right &= c.x > c.w;
+			bottom &= c.y < -c.w;
+			top &= c.y > c.w;
+		}
+		return left || right || top || bottom;
+	}
+
+	void FlushBatch(ImageBatch& batch, CommandList cmd)
+	{
+		if (batch.runs.empty())
+		{
+			return;
+		}
+
+		GraphicsDevice* device = wiRenderer::GetDevice();
+
+		GraphicsDevice::GPUAllocation mem = device->AllocateGPU(sizeof(ImageInstance) * batch.instances.size(), cmd);
+		if (!mem.IsValid())
+		{
+			batch.instances.clear();
+			batch.runs.clear();
+			return;
+		}
+		memcpy(mem.data, batch.instances.data(), sizeof(ImageInstance) * batch.instances.size());
+
+		device->EventBegin("Image Batch", cmd);
+
+		const ImageBatch::Run* prev = nullptr;
+		for (const ImageBatch::Run& run : batch.runs)
+		{
+			if (prev == nullptr || run.pso != prev->pso)
+			{
+				device->BindPipelineState(run.pso, cmd);
+			}
+			if (prev == nullptr || run.texture != prev->texture)
+			{
+				device->BindResource(PS, run.texture, TEXSLOT_IMAGE_BASE, cmd);
+			}
+			if (prev == nullptr || run.mask != prev->mask)
+			{
+				device->BindResource(PS, run.mask, TEXSLOT_IMAGE_MASK, cmd);
+			}
+			if (prev == nullptr || run.sampler != prev->sampler)
+			{
+				device->BindSampler(PS, run.sampler, SSLOT_ONDEMAND0, cmd);
+			}
+			if (prev == nullptr || run.stencilRef != prev->stencilRef)
+			{
+				device->BindStencilRef(run.stencilRef, cmd);
+			}
+
+			const GPUBuffer* vbs[] = {
+				mem.buffer,
+			};
+			const uint32_t strides[] = {
+				sizeof(ImageInstance),
+			};
+			const uint32_t offsets[] = {
+				mem.offset + run.instanceOffset * (uint32_t)sizeof(ImageInstance),
+			};
+			device->BindVertexBuffers(vbs, 0, arraysize(vbs), strides, offsets, cmd);
+
+			device->DrawInstanced(4, run.instanceCount, 0, 0, cmd);
+			statDrawCalls.fetch_add(1, std::memory_order_relaxed);
+
+			prev = &run;
+		}
+
+		device->EventEnd(cmd);
+
+		batch.instances.clear();
+		batch.runs.clear();
+	}
+
+
+	void Draw(const Texture* texture, const wiImageParams& params, CommandList cmd)
+	{
+		if (!initialized.load())
+		{
+			return;
+		}
+
+		wiGUIBatch* guiBatch = wiGUIBatch::GetRecording(cmd);
+		if (guiBatch != nullptr)
+		{
+			if (guiBatch->RecordImage(texture, params))
+			{
+				return;
+			}
+			// The GUI batch doesn't support this image, the quads that were recorded before it must be drawn first:
+			guiBatch->Flush(cmd);
+		}
+
+		GraphicsDevice* device = wiRenderer::GetDevice();
+		ImageBatch& batch = batches[cmd];
+
+		uint32_t stencilRef = params.stencilRef;
+		if (params.stencilRefMode == STENCILREFMODE_USER)
+		{
+			stencilRef = wiRenderer::CombineStencilrefs(STENCILREF_EMPTY, (uint8_t)stencilRef);
+		}
+		const Sampler* sampler = GetSampler(params);
 
 		ImageCB cb;
 		cb.xColor = params.color;
@@ -96,11 +231,20 @@ namespace wiImage
 
 		if (params.isFullScreenEnabled())
 		{
+			// Full screen images are not instanced, the images that were gathered before it must be drawn first:
+			FlushBatch(batch, cmd);
+
+			device->EventBegin("Image", cmd);
+			device->BindResource(PS, texture, TEXSLOT_IMAGE_BASE, cmd);
+			device->BindStencilRef(stencilRef, cmd);
+			device->BindSampler(PS, sampler, SSLOT_ONDEMAND0, cmd);
 			device->BindPipelineState(&imagePSO[IMAGE_SHADER_FULLSCREEN][params.blendFlag][params.stencilComp][params.stencilRefMode], cmd);
 			device->UpdateBuffer(&constantBuffer, &cb, cmd);
 			device->BindConstantBuffer(PS, &constantBuffer, CB_GETBINDSLOT(ImageCB), cmd);
 			device->Draw(3, 0, cmd);
 			device->EventEnd(cmd);
+			statDrawCalls.fetch_add(1, std::memory_order_relaxed);
+			statImages.fetch_add(1, std::memory_order_relaxed);
 			return;
 		}
 
@@ -130,11 +274,11 @@ namespace wiImage
 			}
 			else
 			{
-				faceRot = XMLoadFloat3x3(&wiRenderer::GetCamera().rotationMatrix);
+				faceRot = XMLoadFloat3x3(&wiRenderer::GetRenderCamera().rotationMatrix);
 			}
 
-			XMMATRIX view = wiRenderer::GetCamera().GetView();
-			XMMATRIX projection = wiRenderer::GetCamera().GetProjection();
+			XMMATRIX view = wiRenderer::GetRenderCamera().GetView();
+			XMMATRIX projection = wiRenderer::GetRenderCamera().GetProjection();
 			// Remove possible jittering from temporal camera:
 			projection.r[2] = XMVectorSetX(projection.r[2], 0);
 			projection.r[2] = XMVectorSetY(projection.r[2], 0);
@@ -193,7 +337,13 @@ namespace wiImage
 		cb.xTexMulAdd2.z += params.texOffset2.x * inv_width;	// texOffset.x: add
 		cb.xTexMulAdd2.w += params.texOffset2.y * inv_height;	// texOffset.y: add
 
-		device->UpdateBuffer(&constantBuffer, &cb, cmd);
+		// Culling against the canvas:
+		if (IsOutsideCanvas(cb.xCorners))
+		{
+			statImagesCulled.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		statImages.fetch_add(1, std::memory_order_relaxed);
 
 		// Determine relevant image rendering pixel shader:
 		IMAGE_SHADER targetShader;
@@ -230,6 +380,49 @@ namespace wiImage
 			}
 		}
 
+		if (batch.depth > 0)
+		{
+			ImageInstance instance;
+			for (int i = 0; i < 4; ++i)
+			{
+				instance.corners[i] = cb.xCorners[i];
+			}
+			instance.texMulAdd = cb.xTexMulAdd;
+			instance.texMulAdd2 = cb.xTexMulAdd2;
+			instance.color = cb.xColor;
+
+			ImageBatch::Run run;
+			run.texture = texture;
+			run.mask = params.maskMap;
+			run.sampler = sampler;
+			run.pso = &imagePSO_instanced[targetShader][params.blendFlag][params.stencilComp][params.stencilRefMode];
+			run.stencilRef = stencilRef;
+			run.instanceOffset = (uint32_t)batch.instances.size();
+			run.instanceCount = 1;
+
+			batch.instances.push_back(instance);
+
+			if (!batch.runs.empty())
+			{
+				ImageBatch::Run& last = batch.runs.back();
+				if (last.texture == run.texture && last.mask == run.mask && last.sampler == run.sampler && last.pso == run.pso && last.stencilRef == run.stencilRef)
+				{
+					last.instanceCount++;
+					return;
+				}
+			}
+			batch.runs.push_back(run);
+			return;
+		}
+
+		device->EventBegin("Image", cmd);
+
+		device->BindResource(PS, texture, TEXSLOT_IMAGE_BASE, cmd);
+		device->BindStencilRef(stencilRef, cmd);
+		device->BindSampler(PS, sampler, SSLOT_ONDEMAND0, cmd);
+
+		device->UpdateBuffer(&constantBuffer, &cb, cmd);
+
 		device->BindPipelineState(&imagePSO[targetShader][params.blendFlag][params.stencilComp][params.stencilRefMode], cmd);
 
 		device->BindConstantBuffer(VS, &constantBuffer, CB_GETBINDSLOT(ImageCB), cmd);
@@ -238,11 +431,13 @@ namespace wiImage
 		device->BindResource(PS, params.maskMap, TEXSLOT_IMAGE_MASK, cmd);
 
 		device->Draw(4, 0, cmd);
+		statDrawCalls.fetch_add(1, std::memory_order_relaxed);
 
 		device->EventEnd(cmd);
 	}
 
 
+
 	void LoadShaders()
 	{
 		std::string path = wiRenderer::GetShaderPath();
@@ -250,6 +445,21 @@ namespace wiImage
 		wiRenderer::LoadShader(VS, vertexShader, "imageVS.cso");
 		wiRenderer::LoadShader(VS, screenVS, "screenVS.cso");
 
+		{
+			InputLayoutDesc layout[] =
+			{
+				{ "CORNER", 0, FORMAT_R32G32B32A32_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_INSTANCE_DATA, 1 },
+				{ "CORNER", 1, FORMAT_R32G32B32A32_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_INSTANCE_DATA, 1 },
+				{ "CORNER", 2, FORMAT_R32G32B32A32_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_INSTANCE_DATA, 1 },
+				{ "CORNER", 3, FORMAT_R32G32B32A32_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_INSTANCE_DATA, 1 },
+				{ "TEXMULADD", 0, FORMAT_R32G32B32A32_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_INSTANCE_DATA, 1 },
+				{ "TEXMULADD", 1, FORMAT_R32G32B32A32_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_INSTANCE_DATA, 1 },
+				{ "COLOR", 0, FORMAT_R32G32B32A32_FLOAT, 0, InputLayoutDesc::APPEND_ALIGNED_ELEMENT, INPUT_PER_INSTANCE_DATA, 1 },
+			};
+			wiRenderer::LoadShader(VS, instancedVS, "imageVS_instanced.cso");
+			wiRenderer::GetDevice()->CreateInputLayout(layout, arraysize(layout), &instancedVS, &instancedInputLayout);
+		}
+
 		wiRenderer::LoadShader(PS, imagePS[IMAGE_SHADER_STANDARD], "imagePS.cso");
 		wiRenderer::LoadShader(PS, imagePS[IMAGE_SHADER_SEPARATENORMALMAP], "imagePS_separatenormalmap.cso");
 		wiRenderer::LoadShader(PS, imagePS[IMAGE_SHADER_MASKED], "imagePS_masked.cso");
@@ -284,6 +494,13 @@ namespace wiImage
 
 						device->CreatePipelineState(&desc, &imagePSO[i][j][k][m]);
 
+						if (i != IMAGE_SHADER_FULLSCREEN)
+						{
+							PipelineStateDesc instanced_desc = desc;
+							instanced_desc.vs = &instancedVS;
+							instanced_desc.il = &instancedInputLayout;
+							device->CreatePipelineState(&instanced_desc, &imagePSO_instanced[i][j][k][m]);
+						}
 					}
 				}
 			}
@@ -423,4 +640,38 @@ namespace wiImage
 		initialized.store(true);
 	}
 
+	void BeginBatch(CommandList cmd)
+	{
+		batches[cmd].depth++;
+	}
+	void EndBatch(CommandList cmd)
+	{
+		ImageBatch& batch = batches[cmd];
+		assert(batch.depth > 0 && "EndBatch() without BeginBatch()!");
+		batch.depth--;
+		if (batch.depth == 0)
+		{
+			FlushBatch(batch, cmd);
+		}
+	}
+	void Flush(CommandList cmd)
+	{
+		FlushBatch(batches[cmd], cmd);
+	}
+
+	wiImageStatistics GetStatistics()
+	{
+		wiImageStatistics stats;
+		stats.drawCalls = statDrawCalls.load();
+		stats.images = statImages.load();
+		stats.imagesCulled = statImagesCulled.load();
+		return stats;
+	}
+	void ResetStatistics()
+	{
+		statDrawCalls.store(0);
+		statImages.store(0);
+		statImagesCulled.store(0);
+	}
+
 }
@@ -6,10 +6,30 @@
 
 struct wiImageParams;
 
+struct wiImageStatistics
+{
+	uint32_t drawCalls = 0;
+	uint32_t images = 0;		// images that were drawn, instanced or not
+	uint32_t imagesCulled = 0;	// images that were completely outside of the canvas
+};
+
 namespace wiImage
 {
+	// Images that are completely outside of the canvas are culled on the CPU
 	void Draw(const wiGraphics::Texture* texture, const wiImageParams& params, wiGraphics::CommandList cmd);
 
+	// Draw() calls between BeginBatch() and EndBatch() on the same command list are gathered and drawn in EndBatch().
+	//	Consecutive images with the same textures, sampler, blend and stencil state are drawn with one instanced draw call, the draw order is kept.
+	//	Batches can be nested, only the outermost EndBatch() draws. Outside of a batch, Draw() draws immediately
+	void BeginBatch(wiGraphics::CommandList cmd);
+	void EndBatch(wiGraphics::CommandList cmd);
+	// Draws the images that were gathered in the current batch so far, this is needed when something else is drawn inbetween
+	void Flush(wiGraphics::CommandList cmd);
+
+	// Draw calls and culling since the last ResetStatistics()
+	wiImageStatistics GetStatistics();
+	void ResetStatistics();
+
 	void LoadShaders();
 	void Initialize();
 };
@@ -55,22 +55,22 @@ wiImageParams_BindLua::wiImageParams_BindLua(const wiImageParams& params) :param
 
 int wiImageParams_BindLua::GetPos(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&params.pos)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat3(&params.pos));
 	return 1;
 }
 int wiImageParams_BindLua::GetSize(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat2(&params.siz)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat2(&params.siz));
 	return 1;
 }
 int wiImageParams_BindLua::GetPivot(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat2(&params.pivot)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat2(&params.pivot));
 	return 1;
 }
 int wiImageParams_BindLua::GetColor(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat4(&params.color)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat4(&params.color));
 	return 1;
 }
 int wiImageParams_BindLua::GetOpacity(lua_State* L)
@@ -90,22 +90,22 @@ int wiImageParams_BindLua::GetRotation(lua_State* L)
 }
 int wiImageParams_BindLua::GetTexOffset(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat2(&params.texOffset)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat2(&params.texOffset));
 	return 1;
 }
 int wiImageParams_BindLua::GetTexOffset2(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat2(&params.texOffset2)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat2(&params.texOffset2));
 	return 1;
 }
 int wiImageParams_BindLua::GetDrawRect(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat4(&params.drawRect)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat4(&params.drawRect));
 	return 1;
 }
 int wiImageParams_BindLua::GetDrawRect2(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat4(&params.drawRect2)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat4(&params.drawRect2));
 	return 1;
 }
 int wiImageParams_BindLua::IsDrawRectEnabled(lua_State* L)
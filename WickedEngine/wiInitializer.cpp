@@ -2,11 +2,15 @@
 #include "WickedEngine.h"
 
 #include <sstream>
+#include <atomic>
 
 namespace wiInitializer
 {
 	bool initializationStarted = false;
 	wiJobSystem::context ctx;
+	wiTimer timer;
+	std::atomic<uint32_t> systemsRemaining{ 0 };
+	Timings timings;
 
 	void InitializeComponentsImmediate()
 	{
@@ -24,19 +28,48 @@ namespace wiInitializer
 
 		wiJobSystem::Initialize();
 
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiFont::Initialize(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiImage::Initialize(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiInput::Initialize(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiRenderer::Initialize(); wiWidget::LoadShaders(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiAudio::Initialize(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiNetwork::Initialize(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiTextureHelper::Initialize(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiScene::wiHairParticle::Initialize(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiScene::wiEmittedParticle::Initialize(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiOcean::Initialize(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiGPUSortLib::LoadShaders(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiGPUBVH::LoadShaders(); });
-		wiJobSystem::Execute(ctx, [](wiJobArgs args) { wiPhysicsEngine::Initialize(); });
+		// The shaders of the archive are created before the systems, so they don't have to load them one by one:
+		timer.record();
+		wiShaderCache::LoadArchive();
+		timings.shaderArchive = timer.elapsed();
+
+		static void(*const systems[])() = {
+			[] { wiFont::Initialize(); },
+			[] { wiImage::Initialize(); },
+			[] { wiGUIBatch::Initialize(); },
+			[] { wiInput::Initialize(); },
+			[] { wiRenderer::Initialize(); wiWidget::LoadShaders(); },
+			[] { wiAudio::Initialize(); },
+			[] { wiNetwork::Initialize(); },
+			[] { wiTextureHelper::Initialize(); },
+			[] { wiScene::wiHairParticle::Initialize(); },
+			[] { wiScene::wiEmittedParticle::Initialize(); },
+			[] { wiOcean::Initialize(); },
+			[] { wiGPUSortLib::LoadShaders(); },
+			[] { wiGPUBVH::LoadShaders(); },
+			[] { wiPhysicsEngine::Initialize(); },
+		};
+
+		timer.record();
+		systemsRemaining.store(arraysize(systems));
+		for (auto system : systems)
+		{
+			wiJobSystem::Execute(ctx, [system](wiJobArgs args) {
+				system();
+				if (systemsRemaining.fetch_sub(1) == 1)
+				{
+					// The last system finished, the shaders that were loaded from files are packed for the next startup:
+					wiShaderCache::SaveArchive();
+					timings.systems = timer.elapsed();
+
+					const wiShaderCache::Statistics& stats = wiShaderCache::GetStatistics();
+					std::stringstream ss;
+					ss << "[wiInitializer] Systems initialized in " << timings.systems << " ms, " << stats.archiveShaders << " shaders from the archive in " << timings.shaderArchive << " ms";
+					ss << ", " << stats.fileShaders << " shaders from files (" << stats.staleShaders << " changed since archived)" << std::endl;
+					wiBackLog::post(ss.str().c_str());
+				}
+			});
+		}
 
 	}
 
@@ -44,4 +77,24 @@ namespace wiInitializer
 	{
 		return initializationStarted && !wiJobSystem::IsBusy(ctx);
 	}
-}
\ No newline at end of file
+
+	void WarmUpPipelineStates()
+	{
+		timer.record();
+		wiShaderCache::WarmUpPipelineStates();
+		timings.pipelineWarmUp = timer.elapsed();
+
+		const uint32_t count = wiShaderCache::GetStatistics().warmedUpPermutations;
+		if (count > 0)
+		{
+			std::stringstream ss;
+			ss << "[wiInitializer] " << count << " pipeline states of the previous session compiled in " << timings.pipelineWarmUp << " ms" << std::endl;
+			wiBackLog::post(ss.str().c_str());
+		}
+	}
+
+	const Timings& GetTimings()
+	{
+		return timings;
+	}
+}
@@ -9,6 +9,18 @@ namespace wiInitializer
 	void InitializeComponentsAsync();
 	// Check if systems have been initialized or not
 	bool IsInitializeFinished();
-}
 
+	// Compiles the pipeline states that were used in the previous session (see wiShaderCache). Call it once after IsInitializeFinished(),
+	//	before the first frame, on the thread that presents the frame
+	void WarmUpPipelineStates();
+
+	// Durations of the initialization in milliseconds
+	struct Timings
+	{
+		double shaderArchive = 0;	// reading the shader archive and creating its shaders
+		double systems = 0;			// initializing the systems, in parallel (includes writing the shader archive when it changed)
+		double pipelineWarmUp = 0;	// WarmUpPipelineStates()
+	};
+	const Timings& GetTimings();
+}
 
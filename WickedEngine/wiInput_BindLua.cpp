@@ -87,7 +87,7 @@ int wiInput_BindLua::Hold(lua_State* L)
 int wiInput_BindLua::GetPointer(lua_State* L)
 {
 	XMFLOAT4 P = wiInput::GetPointer();
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat4(&P)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat4(&P));
 	return 1;
 }
 int wiInput_BindLua::SetPointer(lua_State* L)
@@ -111,7 +111,7 @@ int wiInput_BindLua::SetPointer(lua_State* L)
 }
 int wiInput_BindLua::GetPointerDelta(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat2(&wiInput::GetMouseState().delta_position)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat2(&wiInput::GetMouseState().delta_position));
 	return 1;
 }
 int wiInput_BindLua::HidePointer(lua_State* L)
@@ -143,7 +143,7 @@ int wiInput_BindLua::GetAnalog(lua_State* L)
 	else
 		wiLua::SError(L, "GetAnalog(int type, opt int playerindex = 0) not enough arguments!");
 
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat4(&result)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat4(&result));
 	return 1;
 }
 int wiInput_BindLua::GetTouches(lua_State* L)
@@ -151,7 +151,7 @@ int wiInput_BindLua::GetTouches(lua_State* L)
 	auto& touches = wiInput::GetTouches();
 	for (auto& touch : touches)
 	{
-		Luna<Touch_BindLua>::push(L, new Touch_BindLua(touch));
+		Luna<Touch_BindLua>::create(L, touch);
 	}
 	return (int)touches.size();
 }
@@ -281,7 +281,7 @@ int Touch_BindLua::GetState(lua_State* L)
 }
 int Touch_BindLua::GetPos(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat2(&touch.pos)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat2(&touch.pos));
 	return 1;
 }
 
@@ -84,12 +84,12 @@ namespace wiIntersect_BindLua
 	}
 	int Ray_BindLua::GetOrigin(lua_State* L)
 	{
-		Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&ray.origin)));
+		Luna<Vector_BindLua>::create(L, XMLoadFloat3(&ray.origin));
 		return 1;
 	}
 	int Ray_BindLua::GetDirection(lua_State* L)
 	{
-		Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&ray.direction)));
+		Luna<Vector_BindLua>::create(L, XMLoadFloat3(&ray.direction));
 		return 1;
 	}
 
@@ -200,25 +200,25 @@ namespace wiIntersect_BindLua
 	int AABB_BindLua::GetMin(lua_State* L)
 	{
 		XMFLOAT3 M = aabb.getMin();
-		Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&M)));
+		Luna<Vector_BindLua>::create(L, XMLoadFloat3(&M));
 		return 1;
 	}
 	int AABB_BindLua::GetMax(lua_State* L)
 	{
 		XMFLOAT3 M = aabb.getMax();
-		Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&M)));
+		Luna<Vector_BindLua>::create(L, XMLoadFloat3(&M));
 		return 1;
 	}
 	int AABB_BindLua::GetCenter(lua_State* L)
 	{
 		XMFLOAT3 C = aabb.getCenter();
-		Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&C)));
+		Luna<Vector_BindLua>::create(L, XMLoadFloat3(&C));
 		return 1;
 	}
 	int AABB_BindLua::GetHalfExtents(lua_State* L)
 	{
 		XMFLOAT3 H = aabb.getHalfWidth();
-		Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&H)));
+		Luna<Vector_BindLua>::create(L, XMLoadFloat3(&H));
 		return 1;
 	}
 	int AABB_BindLua::Transform(lua_State* L)
@@ -229,7 +229,7 @@ namespace wiIntersect_BindLua
 			Matrix_BindLua* _matrix = Luna<Matrix_BindLua>::lightcheck(L, 1);
 			if (_matrix)
 			{
-				Luna<AABB_BindLua>::push(L, new AABB_BindLua(aabb.transform(_matrix->matrix)));
+				Luna<AABB_BindLua>::create(L, aabb.transform(_matrix->matrix));
 				return 1;
 			}
 			else
@@ -242,7 +242,7 @@ namespace wiIntersect_BindLua
 	}
 	int AABB_BindLua::GetAsBoxMatrix(lua_State* L)
 	{
-		Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(aabb.getAsBoxMatrix()));
+		Luna<Matrix_BindLua>::create(L, aabb.getAsBoxMatrix());
 		return 1;
 	}
 
@@ -323,7 +323,7 @@ namespace wiIntersect_BindLua
 	}
 	int Sphere_BindLua::GetCenter(lua_State* L)
 	{
-		Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&sphere.center)));
+		Luna<Vector_BindLua>::create(L, XMLoadFloat3(&sphere.center));
 		return 1;
 	}
 	int Sphere_BindLua::GetRadius(lua_State* L)
@@ -427,8 +427,8 @@ namespace wiIntersect_BindLua
 				float depth = 0;
 				bool intersects = capsule.intersects(_capsule->capsule, position, normal, depth);
 				wiLua::SSetBool(L, intersects);
-				Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&position)));
-				Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&normal)));
+				Luna<Vector_BindLua>::create(L, XMLoadFloat3(&position));
+				Luna<Vector_BindLua>::create(L, XMLoadFloat3(&normal));
 				wiLua::SSetFloat(L, depth);
 				return 4;
 			}
@@ -438,17 +438,17 @@ namespace wiIntersect_BindLua
 	}
 	int Capsule_BindLua::GetAABB(lua_State* L)
 	{
-		Luna<AABB_BindLua>::push(L, new AABB_BindLua(capsule.getAABB()));
+		Luna<AABB_BindLua>::create(L, capsule.getAABB());
 		return 1;
 	}
 	int Capsule_BindLua::GetBase(lua_State* L)
 	{
-		Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&capsule.base)));
+		Luna<Vector_BindLua>::create(L, XMLoadFloat3(&capsule.base));
 		return 1;
 	}
 	int Capsule_BindLua::GetTip(lua_State* L)
 	{
-		Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&capsule.tip)));
+		Luna<Vector_BindLua>::create(L, XMLoadFloat3(&capsule.tip));
 		return 1;
 	}
 	int Capsule_BindLua::GetRadius(lua_State* L)
@@ -3,6 +3,7 @@
 #include "wiBackLog.h"
 #include "wiContainers.h"
 #include "wiPlatform.h"
+#include "wiProfiler.h"
 
 #include <thread>
 #include <condition_variable>
@@ -19,9 +20,11 @@ namespace wiJobSystem
 		uint32_t groupJobOffset;
 		uint32_t groupJobEnd;
 		uint32_t sharedmemory_size;
+		const char* profilerName;
 	};
 
 	uint32_t numThreads = 0;
+	std::atomic<uint32_t> numActiveThreads{ 0 };
 	wiContainers::ThreadSafeRingBuffer<Job, 256> jobQueue;
 	std::condition_variable wakeCondition;
 	std::mutex wakeMutex;
@@ -43,6 +46,8 @@ namespace wiJobSystem
 				args.sharedmemory = nullptr;
 			}
 
+			wiProfiler::range_id range = job.profilerName == nullptr ? 0 : wiProfiler::BeginRangeCPU(job.profilerName);
+
 			for (uint32_t i = job.groupJobOffset; i < job.groupJobEnd; ++i)
 			{
 				args.jobIndex = i;
@@ -52,12 +57,24 @@ namespace wiJobSystem
 				job.task(args);
 			}
 
+			wiProfiler::EndRange(range);
+
 			job.ctx->counter.fetch_sub(1);
 			return true;
 		}
 		return false;
 	}
 
+	// Called while the queue is full: the worker threads will drain it, unless every one of them was deactivated by SetActiveThreadCount(0)
+	//	In that case the calling thread is the only one left, so it makes room by executing a job itself
+	inline void help()
+	{
+		if (numActiveThreads.load() == 0)
+		{
+			work();
+		}
+	}
+
 	void Initialize()
 	{
 		// Retrieve the number of hardware threads in this system:
@@ -65,14 +82,17 @@ namespace wiJobSystem
 
 		// Calculate the actual number of worker threads we want (-1 main thread):
 		numThreads = std::max(1u, numCores - 1);
+		numActiveThreads.store(numThreads);
 
 		for (uint32_t threadID = 0; threadID < numThreads; ++threadID)
 		{
-			std::thread worker([] {
+			std::thread worker([threadID] {
+
+				wiProfiler::SetThreadName(("wiJobSystem_" + std::to_string(threadID)).c_str());
 
 				while (true)
 				{
-					if (!work())
+					if (threadID >= numActiveThreads.load() || !work())
 					{
 						// no job, put thread to sleep
 						std::unique_lock<std::mutex> lock(wakeMutex);
@@ -115,6 +135,17 @@ namespace wiJobSystem
 		return numThreads;
 	}
 
+	void SetActiveThreadCount(uint32_t value)
+	{
+		numActiveThreads.store(std::min(value, numThreads));
+		wakeCondition.notify_all();
+	}
+
+	uint32_t GetActiveThreadCount()
+	{
+		return numActiveThreads.load();
+	}
+
 	void Execute(context& ctx, const std::function<void(wiJobArgs)>& task)
 	{
 		// Context state is updated:
@@ -127,9 +158,10 @@ namespace wiJobSystem
 		job.groupJobOffset = 0;
 		job.groupJobEnd = 1;
 		job.sharedmemory_size = 0;
+		job.profilerName = wiProfiler::GetJobRangeName();
 
 		// Try to push a new job until it is pushed successfully:
-		while (!jobQueue.push_back(job)) { wakeCondition.notify_all(); }
+		while (!jobQueue.push_back(job)) { wakeCondition.notify_all(); help(); }
 
 		// Wake any one thread that might be sleeping:
 		wakeCondition.notify_one();
@@ -151,6 +183,7 @@ namespace wiJobSystem
 		job.ctx = &ctx;
 		job.task = task;
 		job.sharedmemory_size = (uint32_t)sharedmemory_size;
+		job.profilerName = wiProfiler::GetJobRangeName();
 
 		for (uint32_t groupID = 0; groupID < groupCount; ++groupID)
 		{
@@ -160,7 +193,7 @@ namespace wiJobSystem
 			job.groupJobEnd = std::min(job.groupJobOffset + groupSize, jobCount);
 
 			// Try to push a new job until it is pushed successfully:
-			while (!jobQueue.push_back(job)) { wakeCondition.notify_all(); }
+			while (!jobQueue.push_back(job)) { wakeCondition.notify_all(); help(); }
 		}
 
 		// Wake any threads that might be sleeping:
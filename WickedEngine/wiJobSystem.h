@@ -19,6 +19,11 @@ namespace wiJobSystem
 
 	uint32_t GetThreadCount();
 
+	// Limits how many worker threads can pick up jobs, clamped to GetThreadCount(). The thread that calls Wait() will still help out.
+	//	This is useful to measure how well a system scales with thread count
+	void SetActiveThreadCount(uint32_t value);
+	uint32_t GetActiveThreadCount();
+
 	// Defines a state of execution, can be waited on
 	struct context
 	{
@@ -25,15 +25,200 @@
 #include "wiBackLog_BindLua.h"
 #include "wiNetwork_BindLua.h"
 #include "wiIntersect_BindLua.h"
+#include "wiProfiler.h"
+#include "wiTimer.h"
+#include "wiSpinLock.h"
 
 #include <sstream>
 #include <memory>
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <iomanip>
 
 using namespace std;
 
 #define WILUA_ERROR_PREFIX "[Lua Error] "
 
+struct wiLua::Profiler
+{
+	bool enabled = false;
+	bool countCalls = false;
+	uint32_t sampleInterval = 1000;
+	uint32_t instructionBudget = 0;
+	bool yieldOverBudget = false;
+
+	struct FunctionStats
+	{
+		std::string name;
+		uint64_t selfSamples = 0;	// samples where the function was running
+		uint64_t totalSamples = 0;	// samples where the function was on the call stack
+		uint64_t calls = 0;
+	};
+	std::vector<FunctionStats> functions;
+	std::unordered_map<std::string, uint32_t> functionLookup;
+	std::unordered_map<uint64_t, uint64_t> callGraph; // (caller << 32 | callee) -> samples
+	uint64_t sampleCount = 0;
+
+	struct CoroutineStats
+	{
+		std::string name;
+		std::string rangeName;
+		uint64_t resumes = 0;
+		double time = 0;		// milliseconds, excluding the coroutines that it resumed
+		double maxTime = 0;
+		uint64_t instructions = 0;
+		uint64_t maxInstructions = 0;
+		uint64_t overBudget = 0;
+	};
+	std::vector<CoroutineStats> coroutines; // the first one is the main thread
+	std::unordered_map<std::string, uint32_t> coroutineLookup;
+
+	// Coroutines that are being resumed, the last one is running
+	struct Frame
+	{
+		uint32_t coroutine = 0;
+		lua_State* thread = nullptr;
+		uint64_t instructions = 0;
+		double childTime = 0;
+		bool yielded = false;
+		wiTimer timer;
+	};
+	std::vector<Frame> frames;
+
+	// The hooks can be called while the report is being created from an other thread
+	wiSpinLock locker;
+
+	bool IsActive() const { return enabled || instructionBudget > 0; }
+	int GetHookMask() const { return LUA_MASKCOUNT | (enabled && countCalls ? LUA_MASKCALL : 0); }
+	int GetHookCount() const
+	{
+		uint32_t count = enabled ? sampleInterval : 1000;
+		if (instructionBudget > 0)
+		{
+			count = std::min(count, instructionBudget);
+		}
+		return (int)std::max(count, 1u);
+	}
+
+	uint32_t GetFunction(lua_State* L, lua_Debug& ar)
+	{
+		lua_getinfo(L, "Sn", &ar);
+		std::string key;
+		if (ar.what != nullptr && strcmp(ar.what, "C") == 0)
+		{
+			key = std::string("[C] ") + (ar.name != nullptr ? ar.name : "?");
+		}
+		else
+		{
+			key = std::string(ar.short_src) + ":" + std::to_string(ar.linedefined);
+		}
+		auto it = functionLookup.find(key);
+		if (it != functionLookup.end())
+		{
+			return it->second;
+		}
+		uint32_t index = (uint32_t)functions.size();
+		functions.emplace_back();
+		functions.back().name = ar.name != nullptr && ar.what != nullptr && strcmp(ar.what, "C") != 0 ? (std::string(ar.name) + " (" + key + ")") : key;
+		functionLookup[key] = index;
+		return index;
+	}
+
+	uint32_t GetCoroutine(const std::string& name)
+	{
+		auto it = coroutineLookup.find(name);
+		if (it != coroutineLookup.end())
+		{
+			return it->second;
+		}
+		uint32_t index = (uint32_t)coroutines.size();
+		coroutines.emplace_back();
+		coroutines.back().name = name;
+		coroutines.back().rangeName = "Lua: " + name;
+		coroutineLookup[name] = index;
+		return index;
+	}
+
+	// Coroutines are identified by the function that they were started with
+	static std::string GetCoroutineName(lua_State* co)
+	{
+		lua_Debug ar;
+		if (lua_status(co) == LUA_OK && lua_gettop(co) > 0 && !lua_getstack(co, 0, &ar))
+		{
+			// not started yet, the function is at the bottom of its stack
+			lua_pushvalue(co, 1);
+			lua_getinfo(co, ">S", &ar);
+		}
+		else
+		{
+			int level = 0;
+			while (lua_getstack(co, level + 1, &ar))
+			{
+				level++;
+			}
+			if (!lua_getstack(co, level, &ar))
+			{
+				return "coroutine";
+			}
+			lua_getinfo(co, "S", &ar);
+		}
+		return std::string(ar.short_src) + ":" + std::to_string(ar.linedefined);
+	}
+
+	void Sample(lua_State* L)
+	{
+		static const int maxDepth = 32;
+		uint32_t stack[maxDepth];
+		int depth = 0;
+		lua_Debug ar;
+		while (depth < maxDepth && lua_getstack(L, depth, &ar))
+		{
+			stack[depth++] = GetFunction(L, ar);
+		}
+		if (depth == 0)
+			return;
+
+		sampleCount++;
+		functions[stack[0]].selfSamples++;
+		for (int i = 0; i < depth; ++i)
+		{
+			// recursive functions are only counted once per sample
+			bool counted = false;
+			for (int j = 0; j < i && !counted; ++j)
+			{
+				counted = stack[j] == stack[i];
+			}
+			if (!counted)
+			{
+				functions[stack[i]].totalSamples++;
+			}
+		}
+		if (depth > 1)
+		{
+			callGraph[(uint64_t(stack[1]) << 32ull) | uint64_t(stack[0])]++;
+		}
+	}
+
+	void Reset()
+	{
+		functions.clear();
+		functionLookup.clear();
+		callGraph.clear();
+		sampleCount = 0;
+		for (auto& x : coroutines)
+		{
+			std::string name = std::move(x.name);
+			std::string rangeName = std::move(x.rangeName);
+			x = CoroutineStats();
+			x.name = std::move(name);
+			x.rangeName = std::move(rangeName);
+		}
+	}
+};
+// Coroutine names are cached by coroutine in a weak table, so that they are released with the coroutines
+static const char profilerCoroutineKey = 0;
+
 int Internal_DoFile(lua_State* L)
 {
 	int argc = wiLua::SGetArgCount(L);
@@ -44,8 +229,8 @@ int Internal_DoFile(lua_State* L)
 		std::vector<uint8_t> filedata;
 		if (wiHelper::FileRead(filename, filedata))
 		{
-			std::string command = string(filedata.begin(), filedata.end());
-			int status = luaL_loadstring(L, command.c_str());
+			// the file name is used as chunk name, so errors and the profiler can refer to the script
+			int status = luaL_loadbuffer(L, (const char*)filedata.data(), filedata.size(), ("@" + filename).c_str());
 			if (status == 0)
 			{
 				status = lua_pcall(L, 0, LUA_MULTRET, 0);
@@ -60,7 +245,7 @@ int Internal_DoFile(lua_State* L)
 
 				stringstream ss("");
 				ss << WILUA_ERROR_PREFIX << str;
-				wiBackLog::post(ss.str().c_str());
+				wiBackLog::post(ss.str().c_str(), wiBackLog::LEVEL_ERROR);
 				lua_pop(L, 1); // remove error message
 			}
 		}
@@ -73,12 +258,76 @@ int Internal_DoFile(lua_State* L)
 	return 0;
 }
 
+int Internal_SetLuaProfilerEnabled(lua_State* L)
+{
+	int argc = wiLua::SGetArgCount(L);
+	if (argc > 0)
+	{
+		uint32_t sampleInterval = argc > 1 ? (uint32_t)wiLua::SGetInt(L, 2) : 1000;
+		bool countCalls = argc > 2 ? wiLua::SGetBool(L, 3) : false;
+		wiLua::GetGlobal()->SetProfilerEnabled(wiLua::SGetBool(L, 1), sampleInterval, countCalls);
+	}
+	else
+	{
+		wiLua::SError(L, "SetLuaProfilerEnabled(bool enabled, opt int sampleInterval, opt bool countCalls) not enough arguments!");
+	}
+	return 0;
+}
+int Internal_ResetLuaProfiler(lua_State* L)
+{
+	wiLua::GetGlobal()->ResetProfiler();
+	return 0;
+}
+int Internal_GetLuaProfilerReport(lua_State* L)
+{
+	wiLua::SSetString(L, wiLua::GetGlobal()->GetProfilerReport());
+	return 1;
+}
+int Internal_SetLuaInstructionBudget(lua_State* L)
+{
+	int argc = wiLua::SGetArgCount(L);
+	if (argc > 0)
+	{
+		wiLua::GetGlobal()->SetInstructionBudget((uint32_t)wiLua::SGetInt(L, 1), argc > 1 ? wiLua::SGetBool(L, 2) : false);
+	}
+	else
+	{
+		wiLua::SError(L, "SetLuaInstructionBudget(int instructions, opt bool yield) not enough arguments!");
+	}
+	return 0;
+}
+
 wiLua::wiLua()
 {
 	m_luaState = NULL;
 	m_luaState = luaL_newstate();
 	luaL_openlibs(m_luaState);
+
+	// Every coroutine inherits the extra space of the main thread, the profiler hooks use it to find the wiLua instance
+	*static_cast<wiLua**>(lua_getextraspace(m_luaState)) = this;
+	profiler = std::make_unique<Profiler>();
+	profiler->coroutines.reserve(64);
+	profiler->GetCoroutine("main");
+
+	lua_newtable(m_luaState);
+	lua_newtable(m_luaState);
+	lua_pushstring(m_luaState, "k");
+	lua_setfield(m_luaState, -2, "__mode");
+	lua_setmetatable(m_luaState, -2);
+	lua_rawsetp(m_luaState, LUA_REGISTRYINDEX, &profilerCoroutineKey);
+
+	// coroutine.resume is wrapped to measure coroutines, it only forwards the call when the profiler is not active
+	lua_getglobal(m_luaState, "coroutine");
+	lua_getfield(m_luaState, -1, "resume");
+	lua_pushcclosure(m_luaState, ProfilerResume, 1);
+	lua_setfield(m_luaState, -2, "resume");
+	lua_pop(m_luaState, 1);
+
 	RegisterFunc("dofile", Internal_DoFile);
+	RegisterFunc("SetLuaProfilerEnabled", Internal_SetLuaProfilerEnabled);
+	RegisterFunc("ResetLuaProfiler", Internal_ResetLuaProfiler);
+	RegisterFunc("GetLuaProfilerReport", Internal_GetLuaProfilerReport);
+	RegisterFunc("SetLuaInstructionBudget", Internal_SetLuaInstructionBudget);
 	RunText(wiLua_Globals);
 }
 
@@ -159,7 +408,7 @@ void wiLua::PostErrorMsg()
 			return;
 		stringstream ss("");
 		ss << WILUA_ERROR_PREFIX << str;
-		wiBackLog::post(ss.str().c_str());
+		wiBackLog::post(ss.str().c_str(), wiBackLog::LEVEL_ERROR);
 		lock.lock();
 		lua_pop(m_luaState, 1); // remove error message
 		lock.unlock();
@@ -170,7 +419,15 @@ bool wiLua::RunFile(const std::string& filename)
 	std::vector<uint8_t> filedata;
 	if (wiHelper::FileRead(filename, filedata))
 	{
-		return RunText(string(filedata.begin(), filedata.end()));
+		lock.lock();
+		m_status = luaL_loadbuffer(m_luaState, (const char*)filedata.data(), filedata.size(), ("@" + filename).c_str());
+		lock.unlock();
+		if (Success())
+		{
+			return RunScript();
+		}
+
+		PostErrorMsg();
 	}
 	return false;
 
@@ -324,6 +581,247 @@ void wiLua::KillProcesses()
 	RunText("killProcesses();");
 }
 
+void wiLua::SetProfilerEnabled(bool value, uint32_t sampleInterval, bool countCalls)
+{
+	profiler->locker.lock();
+	profiler->enabled = value;
+	profiler->sampleInterval = std::max(sampleInterval, 1u);
+	profiler->countCalls = countCalls;
+	profiler->locker.unlock();
+
+	// lua_sethook can be called asynchronously. Coroutines receive the hook when they are resumed, and remove it when the profiler is not active
+	if (profiler->IsActive())
+	{
+		lua_sethook(m_luaState, ProfilerHook, profiler->GetHookMask(), profiler->GetHookCount());
+	}
+	else
+	{
+		lua_sethook(m_luaState, nullptr, 0, 0);
+	}
+}
+bool wiLua::IsProfilerEnabled() const
+{
+	return profiler->enabled;
+}
+void wiLua::ResetProfiler()
+{
+	profiler->locker.lock();
+	profiler->Reset();
+	profiler->locker.unlock();
+}
+std::string wiLua::GetProfilerReport()
+{
+	profiler->locker.lock();
+	const Profiler& p = *profiler;
+
+	stringstream ss("");
+	ss << fixed << setprecision(1);
+	ss << "Lua profiler: " << p.sampleCount << " samples, one every " << p.sampleInterval << " instructions" << endl;
+
+	std::vector<uint32_t> order(p.functions.size());
+	for (uint32_t i = 0; i < (uint32_t)order.size(); ++i)
+	{
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return p.functions[a].selfSamples > p.functions[b].selfSamples ||
+			(p.functions[a].selfSamples == p.functions[b].selfSamples && p.functions[a].totalSamples > p.functions[b].totalSamples);
+	});
+	const double percent = p.sampleCount > 0 ? 100.0 / double(p.sampleCount) : 0;
+	ss << endl << "Functions [self %, total %" << (p.countCalls ? ", calls" : "") << "]:" << endl;
+	for (uint32_t i : order)
+	{
+		const Profiler::FunctionStats& function = p.functions[i];
+		ss << "  " << setw(5) << function.selfSamples * percent << "%  " << setw(5) << function.totalSamples * percent << "%  ";
+		if (p.countCalls)
+		{
+			ss << setw(8) << function.calls << "  ";
+		}
+		ss << function.name << endl;
+	}
+
+	ss << endl << "Coroutines [resumes, time ms, max time ms, instructions, max instructions, over budget]:" << endl;
+	for (const Profiler::CoroutineStats& coroutine : p.coroutines)
+	{
+		ss << "  " << setw(6) << coroutine.resumes << "  " << setprecision(3) << setw(8) << coroutine.time << "  " << setw(7) << coroutine.maxTime << "  " <<
+			setw(10) << coroutine.instructions << "  " << setw(8) << coroutine.maxInstructions << "  " << setw(4) << coroutine.overBudget << "  " << coroutine.name << endl;
+	}
+	ss << setprecision(1);
+
+	std::vector<std::pair<uint64_t, uint64_t>> edges(p.callGraph.begin(), p.callGraph.end());
+	std::sort(edges.begin(), edges.end(), [](const std::pair<uint64_t, uint64_t>& a, const std::pair<uint64_t, uint64_t>& b) {
+		return a.second > b.second;
+	});
+	ss << endl << "Call graph [samples, caller -> callee]:" << endl;
+	for (auto& edge : edges)
+	{
+		ss << "  " << setw(6) << edge.second << "  " << p.functions[edge.first >> 32ull].name << " -> " << p.functions[edge.first & 0xFFFFFFFF].name << endl;
+	}
+
+	profiler->locker.unlock();
+	return ss.str();
+}
+void wiLua::SetInstructionBudget(uint32_t instructions, bool yield)
+{
+	profiler->locker.lock();
+	profiler->instructionBudget = instructions;
+	profiler->yieldOverBudget = yield;
+	profiler->locker.unlock();
+
+	if (profiler->IsActive())
+	{
+		lua_sethook(m_luaState, ProfilerHook, profiler->GetHookMask(), profiler->GetHookCount());
+	}
+	else
+	{
+		lua_sethook(m_luaState, nullptr, 0, 0);
+	}
+}
+void wiLua::ProfilerHook(lua_State* L, lua_Debug* ar)
+{
+	Profiler& p = *(*static_cast<wiLua**>(lua_getextraspace(L)))->profiler;
+	if (!p.IsActive())
+	{
+		lua_sethook(L, nullptr, 0, 0);
+		return;
+	}
+
+	p.locker.lock();
+	if (ar->event == LUA_HOOKCALL || ar->event == LUA_HOOKTAILCALL)
+	{
+		if (p.enabled && p.countCalls)
+		{
+			lua_Debug info;
+			if (lua_getstack(L, 0, &info))
+			{
+				p.functions[p.GetFunction(L, info)].calls++;
+			}
+		}
+		p.locker.unlock();
+		return;
+	}
+
+	const uint32_t count = (uint32_t)lua_gethookcount(L);
+	Profiler::Frame* frame = p.frames.empty() ? nullptr : &p.frames.back();
+	Profiler::CoroutineStats& coroutine = p.coroutines[frame == nullptr ? 0 : frame->coroutine];
+	coroutine.instructions += count;
+
+	if (p.enabled)
+	{
+		p.Sample(L);
+	}
+
+	bool yield = false;
+	if (frame != nullptr && p.instructionBudget > 0)
+	{
+		const bool wasOverBudget = frame->instructions > p.instructionBudget;
+		frame->instructions += count;
+		if (frame->instructions > p.instructionBudget)
+		{
+			if (p.yieldOverBudget && L == frame->thread && lua_isyieldable(L))
+			{
+				coroutine.overBudget++;
+				frame->yielded = true;
+				yield = true;
+			}
+			else if (!wasOverBudget)
+			{
+				coroutine.overBudget++;
+				stringstream ss("");
+				ss << "[Lua Warning] coroutine " << coroutine.name << " exceeded the instruction budget (" << p.instructionBudget << ")";
+				wiBackLog::post(ss.str().c_str(), wiBackLog::LEVEL_WARNING);
+			}
+		}
+	}
+	p.locker.unlock();
+
+	if (yield)
+	{
+		// only count hooks can yield, execution continues from here when the coroutine is resumed
+		lua_yield(L, 0);
+	}
+}
+int wiLua::ProfilerResume(lua_State* L)
+{
+	lua_State* co = lua_tothread(L, 1);
+	luaL_argcheck(L, co != nullptr, 1, "coroutine expected");
+	Profiler& p = *(*static_cast<wiLua**>(lua_getextraspace(L)))->profiler;
+
+	if (!p.IsActive())
+	{
+		lua_pushvalue(L, lua_upvalueindex(1));
+		lua_insert(L, 1);
+		lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);
+		return lua_gettop(L);
+	}
+
+	// find the coroutine statistics:
+	lua_rawgetp(L, LUA_REGISTRYINDEX, &profilerCoroutineKey);
+	lua_pushvalue(L, 1);
+	lua_rawget(L, -2);
+	uint32_t index;
+	p.locker.lock();
+	if (lua_isinteger(L, -1))
+	{
+		index = (uint32_t)lua_tointeger(L, -1);
+		lua_pop(L, 2);
+	}
+	else
+	{
+		index = p.GetCoroutine(Profiler::GetCoroutineName(co));
+		lua_pop(L, 1);
+		lua_pushvalue(L, 1);
+		lua_pushinteger(L, (lua_Integer)index);
+		lua_rawset(L, -3);
+		lua_pop(L, 1);
+	}
+	p.frames.emplace_back();
+	p.frames.back().coroutine = index;
+	p.frames.back().thread = co;
+	p.frames.back().timer.record();
+	const char* rangeName = p.coroutines[index].rangeName.c_str();
+	p.locker.unlock();
+
+	auto range = wiProfiler::BeginRangeCPU(rangeName);
+	lua_sethook(co, ProfilerHook, p.GetHookMask(), p.GetHookCount());
+
+	// stack: coroutine, resume, coroutine, arguments...
+	lua_pushvalue(L, 1);
+	lua_insert(L, 1);
+	lua_pushvalue(L, lua_upvalueindex(1));
+	lua_insert(L, 2);
+	lua_call(L, lua_gettop(L) - 2, LUA_MULTRET);
+
+	wiProfiler::EndRange(range);
+
+	p.locker.lock();
+	Profiler::Frame frame = p.frames.back();
+	p.frames.pop_back();
+	const double time = frame.timer.elapsed();
+	Profiler::CoroutineStats& coroutine = p.coroutines[frame.coroutine];
+	coroutine.resumes++;
+	coroutine.time += time - frame.childTime;
+	coroutine.maxTime = std::max(coroutine.maxTime, time - frame.childTime);
+	coroutine.maxInstructions = std::max(coroutine.maxInstructions, frame.instructions);
+	if (!p.frames.empty())
+	{
+		p.frames.back().childTime += time;
+	}
+	p.locker.unlock();
+
+	if (frame.yielded && lua_status(co) == LUA_YIELD)
+	{
+		// the coroutine was suspended by the instruction budget, it continues on the next update tick
+		lua_getglobal(L, "resumeOnSignal");
+		lua_pushvalue(L, 1);
+		lua_pushstring(L, "wickedengine_update_tick");
+		lua_call(L, 2, 0);
+	}
+
+	lua_remove(L, 1);
+	return lua_gettop(L);
+}
+
 string wiLua::SGetString(lua_State* L, int stackpos)
 {
 	const char* str = lua_tostring(L, stackpos);
@@ -453,7 +951,7 @@ void wiLua::SError(lua_State* L, const std::string& error)
 	{
 		ss << error;
 	}
-	wiBackLog::post(ss.str().c_str());
+	wiBackLog::post(ss.str().c_str(), wiBackLog::LEVEL_ERROR);
 }
 
 void wiLua::SAddMetatable(lua_State* L, const std::string& name)
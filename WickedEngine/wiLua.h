@@ -9,6 +9,8 @@ extern "C"
 }
 
 #include <mutex>
+#include <memory>
+#include <string>
 
 typedef int(*lua_CFunction) (lua_State *L);
 
@@ -20,6 +22,11 @@ private:
 
 	std::mutex lock;
 
+	struct Profiler;
+	std::unique_ptr<Profiler> profiler;
+	static void ProfilerHook(lua_State* L, lua_Debug* ar);
+	static int ProfilerResume(lua_State* L);
+
 	//run the previously loaded script
 	bool RunScript();
 public:
@@ -75,6 +82,19 @@ public:
 	//kill every running background task (coroutine)
 	void KillProcesses();
 
+	//enable/disable the profiler, which samples the running functions every sampleInterval instructions with a count hook
+	//	the time of every coroutine resume is measured and also reported to wiProfiler. countCalls uses a call hook to count every function call, which is slower
+	//	when the profiler and the instruction budget are disabled, no hooks are running
+	void SetProfilerEnabled(bool value, uint32_t sampleInterval = 1000, bool countCalls = false);
+	bool IsProfilerEnabled() const;
+	//clear the collected profiling data
+	void ResetProfiler();
+	//get the collected profiling data as text: flat function profile, coroutine statistics and call graph
+	std::string GetProfilerReport();
+	//limit the number of instructions that a coroutine can execute in one resume, 0 = unlimited
+	//	if yield is true, coroutines that exceed it are suspended until the next update tick, otherwise a warning is posted to the backlog
+	void SetInstructionBudget(uint32_t instructions, bool yield = false);
+
 	//Static function wrappers from here on
 
 	//get string from lua on stack position
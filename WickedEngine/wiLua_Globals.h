@@ -111,7 +111,7 @@ function waitSignal(signalName)
     local co = coroutine.running()
     assert(co ~= nil, "The main thread cannot wait!")
 
-    if WAITING_ON_SIGNAL[signalStr] == nil then
+    if WAITING_ON_SIGNAL[signalName] == nil then
         -- If there wasn't already a list for this signal, start a new one.
         WAITING_ON_SIGNAL[signalName] = { co }
     else
@@ -135,6 +135,15 @@ function signal(signalName)
     end
 end
 
+-- Resume a suspended coroutine when a signal is sent
+function resumeOnSignal(co, signalName)
+    if WAITING_ON_SIGNAL[signalName] == nil then
+        WAITING_ON_SIGNAL[signalName] = { co }
+    else
+        table.insert(WAITING_ON_SIGNAL[signalName], co)
+    end
+end
+
 -- Kill all processes
 function killProcesses()
 	WAITING_ON_SIGNAL = {}
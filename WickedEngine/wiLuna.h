@@ -2,10 +2,20 @@
 
 //Luna : Official C++ to Lua binder project, 5th version
 //modified to fit with Wicked Engine, removed warnings
+//objects created with Luna<T>::create() are stored inside the userdata instead of being allocated separately
 
+#include "wiSpinLock.h"
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #define lunamethod(class, name) {#name, &class::name}
 
+// Objects up to this size are stored inside the Lua userdata, larger objects are allocated from a pool
+#define LUNA_INLINE_SIZE 256
+
 template < class T > class Luna {
 public:
 
@@ -32,10 +42,12 @@ public:
 	*/
 	static T* check(lua_State * L, int narg)
 	{
-		T** obj = static_cast <T **>(luaL_checkudata(L, narg, T::className));
-		if (!obj)
-			return nullptr; // lightcheck returns nullptr if not found.
-		return *obj;		// pointer to T object
+		if (!is_instance(L, narg))
+		{
+			luaL_checkudata(L, narg, T::className); // raises the type error
+			return nullptr;
+		}
+		return *static_cast<T**>(lua_touserdata(L, narg)); // pointer to T object
 	}
 
 	/*
@@ -50,10 +62,9 @@ public:
 	multiple types of arguments passed to the func
 	*/
 	static T* lightcheck(lua_State * L, int narg) {
-		T** obj = static_cast <T **>(luaL_testudata(L, narg, T::className));
-		if (!obj)
+		if (!is_instance(L, narg))
 			return nullptr; // lightcheck returns nullptr if not found.
-		return *obj;		// pointer to T object
+		return *static_cast<T**>(lua_touserdata(L, narg)); // pointer to T object
 	}
 
 	/*
@@ -86,40 +97,16 @@ public:
 			lua_setglobal(L, T::className);
 		}
 
+		// Objects that don't need to be destroyed use a metatable without __gc, so the garbage collector doesn't need to finalize them
 		luaL_newmetatable(L, T::className);
-		int             metatable = lua_gettop(L);
-
-		lua_pushstring(L, "__gc");
-		lua_pushcfunction(L, &Luna < T >::gc_obj);
-		lua_settable(L, metatable);
-
-		lua_pushstring(L, "__tostring");
-		lua_pushcfunction(L, &Luna < T >::to_string);
-		lua_settable(L, metatable);
-
-		lua_pushstring(L, "__eq");		// To be able to compare two Luna objects (not natively possible with full userdata)
-		lua_pushcfunction(L, &Luna < T >::equals);
-		lua_settable(L, metatable);
-
-		lua_pushstring(L, "__index");
-		lua_pushcfunction(L, &Luna < T >::property_getter);
-		lua_settable(L, metatable);
-
-		lua_pushstring(L, "__newindex");
-		lua_pushcfunction(L, &Luna < T >::property_setter);
-		lua_settable(L, metatable);
-
-		for (int i = 0; T::properties[i].name; i++) { 				// Register some properties in it
-			lua_pushstring(L, T::properties[i].name);				// Having some string associated with them
-			lua_pushnumber(L, i); 									// And a number indexing which property it is
-			lua_settable(L, metatable);
-		}
-
-		for (int i = 0; T::methods[i].name; i++) {
-			lua_pushstring(L, T::methods[i].name); 					// Register some functions in it
-			lua_pushnumber(L, i | (1 << 8));						// Add a number indexing which func it is
-			lua_settable(L, metatable);								//
-		}
+		setup_metatable(L, lua_gettop(L), true);
+		lua_rawsetp(L, LUA_REGISTRYINDEX, metatable_key(false));
+
+		lua_newtable(L);
+		lua_pushstring(L, T::className);
+		lua_setfield(L, -2, "__name");
+		setup_metatable(L, lua_gettop(L), false);
+		lua_rawsetp(L, LUA_REGISTRYINDEX, metatable_key(true));
 	}
 
 	/*
@@ -129,12 +116,7 @@ public:
 	*/
 	static int constructor(lua_State * L)
 	{
-		T*  ap = new T(L);
-		T** a = static_cast<T**>(lua_newuserdata(L, sizeof(T *))); // Push value = userdata
-		*a = ap;
-
-		luaL_getmetatable(L, T::className); 		// Fetch global metatable T::classname
-		lua_setmetatable(L, -2);
+		construct(L, std::integral_constant<bool, is_value_type()>());
 		return 1;
 	}
 
@@ -146,17 +128,54 @@ public:
 
 	Description:
 	Loads an instance of the class into the Lua stack, and provides you a pointer so you can modify it.
+	The instance must be allocated with new, it will be deleted by the garbage collector.
 	*/
 	static void push(lua_State * L, T* instance)
 	{
 		T **a = (T **)lua_newuserdata(L, sizeof(T *)); // Create userdata
 		*a = instance;
 
-		luaL_getmetatable(L, T::className);
+		lua_rawgetp(L, LUA_REGISTRYINDEX, metatable_key(false));
 
 		lua_setmetatable(L, -2);
 	}
 
+	/*
+	@ create
+	Arguments:
+	* L - Lua State
+	* args - Constructor arguments of T
+
+	Description:
+	Constructs an instance of the class into the Lua stack without a separate heap allocation and returns a pointer to it.
+	Small objects are stored inside the userdata, large objects are allocated from a pool that is reused after garbage collection.
+	*/
+	template<typename... ARG>
+	static T* create(lua_State * L, ARG&&... args)
+	{
+		Storage* storage;
+		void* memory;
+		if (is_pooled())
+		{
+			storage = static_cast<Storage*>(lua_newuserdata(L, sizeof(Storage)));
+			storage->storage = STORAGE_POOLED;
+			memory = pool_allocate();
+		}
+		else
+		{
+			storage = static_cast<Storage*>(lua_newuserdata(L, sizeof(Storage) + sizeof(T) + alignof(T) - 1));
+			storage->storage = STORAGE_INLINE;
+			uintptr_t address = reinterpret_cast<uintptr_t>(storage + 1);
+			address = (address + alignof(T) - 1) & ~uintptr_t(alignof(T) - 1); // userdata is not aligned for SIMD types
+			memory = reinterpret_cast<void*>(address);
+		}
+		storage->object = ::new (memory) T(std::forward<ARG>(args)...);
+
+		lua_rawgetp(L, LUA_REGISTRYINDEX, metatable_key(!is_pooled() && std::is_trivially_destructible<T>::value));
+		lua_setmetatable(L, -2);
+		return storage->object;
+	}
+
 	/*
 	@ property_getter (internal)
 	Arguments:
@@ -257,10 +276,27 @@ public:
 	*/
 	static int gc_obj(lua_State * L)
 	{
-		T** obj = static_cast < T ** >(lua_touserdata(L, -1));
+		if (lua_rawlen(L, -1) == sizeof(T*))
+		{
+			// Object was pushed with push()
+			T** obj = static_cast < T ** >(lua_touserdata(L, -1));
 
-		if (obj)
-			delete(*obj);
+			if (obj)
+				delete(*obj);
+
+			return 0;
+		}
+
+		Storage* storage = static_cast<Storage*>(lua_touserdata(L, -1));
+		if (storage && storage->object)
+		{
+			storage->object->~T();
+			if (storage->storage == STORAGE_POOLED)
+			{
+				pool_free(storage->object);
+			}
+			storage->object = nullptr;
+		}
 
 		return 0;
 	}
@@ -290,4 +326,137 @@ public:
 
 		return 1;
 	}
+
+private:
+
+	enum STORAGE
+	{
+		STORAGE_INLINE,
+		STORAGE_POOLED,
+	};
+	// Userdata layout of created objects, the object pointer is first so that it can be accessed the same way as pushed objects
+	struct Storage
+	{
+		T* object;
+		int storage;
+	};
+
+	static constexpr bool is_pooled() { return sizeof(T) > LUNA_INLINE_SIZE; }
+	// Value types can be constructed on the stack and copied into the userdata
+	static constexpr bool is_value_type() { return !is_pooled() && std::is_trivially_destructible<T>::value && std::is_copy_constructible<T>::value; }
+
+	static void construct(lua_State* L, std::true_type)
+	{
+		// The constructor reads the arguments from the Lua stack, so the userdata can only be pushed after it
+		T value(L);
+		create(L, value);
+	}
+	static void construct(lua_State* L, std::false_type)
+	{
+		push(L, new T(L));
+	}
+
+	// Registry keys of the metatables
+	static const void* metatable_key(bool value)
+	{
+		static const char keys[2] = {};
+		return &keys[value ? 1 : 0];
+	}
+
+	static bool is_instance(lua_State* L, int narg)
+	{
+		if (lua_touserdata(L, narg) == nullptr || !lua_getmetatable(L, narg))
+			return false;
+		lua_rawgetp(L, LUA_REGISTRYINDEX, metatable_key(false));
+		bool result = lua_rawequal(L, -1, -2) != 0;
+		if (!result)
+		{
+			lua_pop(L, 1);
+			lua_rawgetp(L, LUA_REGISTRYINDEX, metatable_key(true));
+			result = lua_rawequal(L, -1, -2) != 0;
+		}
+		lua_pop(L, 2);
+		return result;
+	}
+
+	static void setup_metatable(lua_State* L, int metatable, bool gc)
+	{
+		if (gc)
+		{
+			lua_pushstring(L, "__gc");
+			lua_pushcfunction(L, &Luna < T >::gc_obj);
+			lua_settable(L, metatable);
+		}
+
+		lua_pushstring(L, "__tostring");
+		lua_pushcfunction(L, &Luna < T >::to_string);
+		lua_settable(L, metatable);
+
+		lua_pushstring(L, "__eq");		// To be able to compare two Luna objects (not natively possible with full userdata)
+		lua_pushcfunction(L, &Luna < T >::equals);
+		lua_settable(L, metatable);
+
+		lua_pushstring(L, "__index");
+		lua_pushcfunction(L, &Luna < T >::property_getter);
+		lua_settable(L, metatable);
+
+		lua_pushstring(L, "__newindex");
+		lua_pushcfunction(L, &Luna < T >::property_setter);
+		lua_settable(L, metatable);
+
+		for (int i = 0; T::properties[i].name; i++) { 				// Register some properties in it
+			lua_pushstring(L, T::properties[i].name);				// Having some string associated with them
+			lua_pushnumber(L, i); 									// And a number indexing which property it is
+			lua_settable(L, metatable);
+		}
+
+		for (int i = 0; T::methods[i].name; i++) {
+			lua_pushstring(L, T::methods[i].name); 					// Register some functions in it
+			lua_pushnumber(L, i | (1 << 8));						// Add a number indexing which func it is
+			lua_settable(L, metatable);								//
+		}
+	}
+
+	// Memory of large objects is reused instead of freed
+	struct Pool
+	{
+		wiSpinLock lock;
+		std::vector<void*> blocks;
+		~Pool()
+		{
+			for (void* block : blocks)
+			{
+				_mm_free(block);
+			}
+		}
+	};
+	static Pool& pool()
+	{
+		static Pool pool;
+		return pool;
+	}
+	static void* pool_allocate()
+	{
+		Pool& p = pool();
+		p.lock.lock();
+		void* block = nullptr;
+		if (!p.blocks.empty())
+		{
+			block = p.blocks.back();
+			p.blocks.pop_back();
+		}
+		p.lock.unlock();
+		if (block == nullptr)
+		{
+			block = _mm_malloc(sizeof(T), alignof(T) < sizeof(void*) ? sizeof(void*) : alignof(T));
+		}
+		return block;
+	}
+	static void pool_free(void* block)
+	{
+		Pool& p = pool();
+		p.lock.lock();
+		p.blocks.push_back(block);
+		p.lock.unlock();
+	}
 };
@@ -19,6 +19,26 @@ namespace wiNetwork
 		uint16_t port = DEFAULT_PORT;
 	};
 
+	// The largest packet that fits into an ethernet frame without IP fragmentation
+	static const size_t MAX_PACKET_SIZE = 1472;
+
+	// A packet that will be sent by SendBatch()
+	struct Message
+	{
+		Connection connection;
+		const void* data = nullptr;
+		size_t dataSize = 0;
+	};
+
+	// A packet that was received by ReceiveBatch(). The data is in a buffer owned by the socket's packet pool
+	struct Packet
+	{
+		Connection connection;
+		const uint8_t* data = nullptr;
+		size_t dataSize = 0;
+		uint32_t bufferIndex = 0;
+	};
+
 	void Initialize();
 
 	// Creates a socket that can be used to send or receive data
@@ -51,4 +71,29 @@ namespace wiNetwork
 	//	data		:	buffer to hold received data, must be already allocated to a sufficient size
 	//	dataSize	:	expected data size in bytes
 	bool Receive(const Socket* sock, Connection* connection, void* data, size_t dataSize);
+
+	// Sends multiple data packets with as few system calls as possible
+	//	sock		:	socket that sends the packets
+	//	messages	:	array of packets, each one with its own destination
+	//	count		:	number of packets in the array
+	//	returns the number of packets that were sent
+	uint32_t SendBatch(const Socket* sock, const Message* messages, uint32_t count);
+
+	// Makes multiple sockets listen on the same port. Incoming packets are distributed between the sockets by the operating system,
+	//	so that each socket can be serviced by a different job without locking
+	//	socks		:	array of sockets that receive packets
+	//	count		:	number of sockets in the array
+	//	port		:	port number to open
+	bool ListenPortShared(const Socket* socks, uint32_t count, uint16_t port = DEFAULT_PORT);
+
+	// Receives the packets that are already queued on the socket, returns immediately
+	//	The data is not copied to caller memory, instead each packet points into a buffer of the socket's packet pool
+	//	sock		:	socket that receives packets
+	//	packets		:	array of packets that will be filled
+	//	maxCount	:	size of the packets array
+	//	returns the number of packets received, their buffers must be given back with ReleasePackets()
+	uint32_t ReceiveBatch(const Socket* sock, Packet* packets, uint32_t maxCount);
+
+	// Gives back packet buffers to the socket's packet pool. It can be called from any thread
+	void ReleasePackets(const Socket* sock, const Packet* packets, uint32_t count);
 }
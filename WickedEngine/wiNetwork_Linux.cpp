@@ -3,43 +3,451 @@
 #ifdef PLATFORM_LINUX
 #include "wiNetwork.h"
 #include "wiBackLog.h"
+#include "wiSpinLock.h"
+
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
 
 namespace wiNetwork
 {
+	// Maximum number of packets that are sent or received by one system call:
+	static const uint32_t BATCH_SIZE = 64;
+	// Number of receive buffers that a socket can hand out with ReceiveBatch():
+	static const uint32_t PACKET_POOL_SIZE = 1024;
+	// Kernel side socket buffer sizes, so that bursts are not dropped between two ReceiveBatch() calls:
+	static const int SOCKET_BUFFER_SIZE = 4 * 1024 * 1024;
+
+	struct PacketPool
+	{
+		std::vector<uint8_t> memory;
+		std::vector<uint32_t> freelist;
+		wiSpinLock locker;
+
+		// Returns the number of buffers that could be allocated
+		uint32_t Allocate(uint32_t* indices, uint32_t count)
+		{
+			locker.lock();
+			if (memory.empty())
+			{
+				memory.resize(PACKET_POOL_SIZE * MAX_PACKET_SIZE);
+				freelist.resize(PACKET_POOL_SIZE);
+				for (uint32_t i = 0; i < PACKET_POOL_SIZE; ++i)
+				{
+					freelist[i] = PACKET_POOL_SIZE - 1 - i;
+				}
+			}
+			count = std::min(count, (uint32_t)freelist.size());
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				indices[i] = freelist.back();
+				freelist.pop_back();
+			}
+			locker.unlock();
+			return count;
+		}
+		void Free(const uint32_t* indices, uint32_t count)
+		{
+			locker.lock();
+			freelist.insert(freelist.end(), indices, indices + count);
+			locker.unlock();
+		}
+		uint8_t* GetBuffer(uint32_t index)
+		{
+			return memory.data() + index * MAX_PACKET_SIZE;
+		}
+	};
+
+	struct SocketInternal
+	{
+		int handle = -1;
+		int epoll = -1;
+		PacketPool pool;
+
+		~SocketInternal()
+		{
+			if (epoll >= 0)
+			{
+				close(epoll);
+			}
+			if (handle >= 0)
+			{
+				int result = close(handle);
+				assert(result == 0);
+			}
+		}
+	};
+	SocketInternal* to_internal(const Socket* param)
+	{
+		return static_cast<SocketInternal*>(param->internal_state.get());
+	}
+
+	void PostError(const char* function)
+	{
+		std::stringstream ss;
+		ss << "wiNetwork error in " << function << ": " << strerror(errno);
+		wiBackLog::post(ss.str().c_str());
+	}
+
+	sockaddr_in ToAddress(const Connection& connection)
+	{
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(connection.port); // reverse byte order from host to network
+		memcpy(&address.sin_addr.s_addr, connection.ipaddress.data(), sizeof(address.sin_addr.s_addr)); // ipaddress is already in network order
+		return address;
+	}
+	void FromAddress(const sockaddr_in& address, Connection& connection)
+	{
+		connection.port = ntohs(address.sin_port); // reverse byte order from network to host
+		memcpy(connection.ipaddress.data(), &address.sin_addr.s_addr, sizeof(address.sin_addr.s_addr));
+	}
+
+	// The sockets are non-blocking, the blocking functions of the interface wait with these:
+	bool WaitReadable(SocketInternal* socketinternal, int timeout_milliseconds)
+	{
+		epoll_event event;
+		int result = epoll_wait(socketinternal->epoll, &event, 1, timeout_milliseconds);
+		if (result < 0 && errno != EINTR)
+		{
+			PostError("epoll_wait");
+		}
+		return result > 0;
+	}
+	bool WaitWritable(SocketInternal* socketinternal)
+	{
+		pollfd fd = {};
+		fd.fd = socketinternal->handle;
+		fd.events = POLLOUT;
+		int result = poll(&fd, 1, -1);
+		if (result < 0 && errno != EINTR)
+		{
+			PostError("poll");
+			return false;
+		}
+		return true;
+	}
+
 	void Initialize()
 	{
-		wiBackLog::post("TODO wiNetwork_Linux");
+		wiBackLog::post("wiNetwork Initialized");
 	}
 
 	bool CreateSocket(Socket* sock)
 	{
-		return false;
+		std::shared_ptr<SocketInternal> socketinternal = std::make_shared<SocketInternal>();
+		sock->internal_state = socketinternal;
+
+		socketinternal->handle = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+		if (socketinternal->handle < 0)
+		{
+			PostError("CreateSocket");
+			return false;
+		}
+
+		// These can be clamped by the system limits, which is not an error:
+		setsockopt(socketinternal->handle, SOL_SOCKET, SO_RCVBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+		setsockopt(socketinternal->handle, SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+
+		socketinternal->epoll = epoll_create1(EPOLL_CLOEXEC);
+		if (socketinternal->epoll < 0)
+		{
+			PostError("CreateSocket");
+			return false;
+		}
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.fd = socketinternal->handle;
+		if (epoll_ctl(socketinternal->epoll, EPOLL_CTL_ADD, socketinternal->handle, &event) < 0)
+		{
+			PostError("CreateSocket");
+			return false;
+		}
+
+		return true;
 	}
 	bool Destroy(Socket* sock)
 	{
+		if (sock != nullptr && sock->IsValid())
+		{
+			sock->internal_state.reset();
+			return true;
+		}
 		return false;
 	}
 
 	bool Send(const Socket* sock, const Connection* connection, const void* data, size_t dataSize)
 	{
+		if (sock != nullptr && sock->IsValid())
+		{
+			auto socketinternal = to_internal(sock);
+			sockaddr_in target = ToAddress(*connection);
+
+			while (true)
+			{
+				ssize_t result = sendto(socketinternal->handle, data, dataSize, 0, (const sockaddr*)&target, sizeof(target));
+				if (result >= 0)
+				{
+					return true;
+				}
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+				{
+					if (!WaitWritable(socketinternal))
+					{
+						return false;
+					}
+				}
+				else if (errno != EINTR)
+				{
+					PostError("Send");
+					return false;
+				}
+			}
+		}
 		return false;
 	}
 
 	bool ListenPort(const Socket* sock, uint16_t port)
 	{
+		if (sock != nullptr && sock->IsValid())
+		{
+			sockaddr_in target = {};
+			target.sin_family = AF_INET;
+			target.sin_port = htons(port);
+			target.sin_addr.s_addr = htonl(INADDR_ANY);
+
+			auto socketinternal = to_internal(sock);
+
+			int result = bind(socketinternal->handle, (const sockaddr*)&target, sizeof(target));
+			if (result < 0)
+			{
+				PostError("ListenPort");
+				return false;
+			}
+
+			return true;
+		}
 		return false;
 	}
 
 	bool CanReceive(const Socket* sock, long timeout_microseconds)
 	{
+		if (sock != nullptr && sock->IsValid())
+		{
+			// epoll has millisecond resolution, shorter timeouts only check the socket without waiting:
+			return WaitReadable(to_internal(sock), int(timeout_microseconds / 1000));
+		}
 		return false;
 	}
 
 	bool Receive(const Socket* sock, Connection* connection, void* data, size_t dataSize)
 	{
+		if (sock != nullptr && sock->IsValid())
+		{
+			auto socketinternal = to_internal(sock);
+
+			while (true)
+			{
+				sockaddr_in sender;
+				socklen_t targetsize = sizeof(sender);
+				ssize_t result = recvfrom(socketinternal->handle, data, dataSize, 0, (sockaddr*)&sender, &targetsize);
+				if (result >= 0)
+				{
+					FromAddress(sender, *connection);
+					return true;
+				}
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+				{
+					WaitReadable(socketinternal, -1);
+				}
+				else if (errno != EINTR)
+				{
+					PostError("Receive");
+					return false;
+				}
+			}
+		}
 		return false;
 	}
 
+	uint32_t SendBatch(const Socket* sock, const Message* messages, uint32_t count)
+	{
+		if (sock == nullptr || !sock->IsValid())
+		{
+			return 0;
+		}
+		auto socketinternal = to_internal(sock);
+
+		mmsghdr headers[BATCH_SIZE];
+		iovec buffers[BATCH_SIZE];
+		sockaddr_in targets[BATCH_SIZE];
+
+		uint32_t sent = 0;
+		while (sent < count)
+		{
+			const uint32_t batch = std::min(count - sent, BATCH_SIZE);
+			for (uint32_t i = 0; i < batch; ++i)
+			{
+				const Message& message = messages[sent + i];
+				targets[i] = ToAddress(message.connection);
+				buffers[i].iov_base = const_cast<void*>(message.data);
+				buffers[i].iov_len = message.dataSize;
+				headers[i] = {};
+				headers[i].msg_hdr.msg_name = &targets[i];
+				headers[i].msg_hdr.msg_namelen = sizeof(targets[i]);
+				headers[i].msg_hdr.msg_iov = &buffers[i];
+				headers[i].msg_hdr.msg_iovlen = 1;
+			}
+
+			int result = sendmmsg(socketinternal->handle, headers, batch, 0);
+			if (result > 0)
+			{
+				sent += (uint32_t)result;
+			}
+			else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			{
+				// The send buffer is full, wait until the kernel drains it:
+				if (!WaitWritable(socketinternal))
+				{
+					break;
+				}
+			}
+			else if (result < 0 && errno != EINTR)
+			{
+				PostError("SendBatch");
+				break;
+			}
+		}
+		return sent;
+	}
+
+	bool ListenPortShared(const Socket* socks, uint32_t count, uint16_t port)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (!socks[i].IsValid())
+			{
+				return false;
+			}
+			// All sockets must enable port reuse before any of them is bound:
+			int enable = 1;
+			if (setsockopt(to_internal(&socks[i])->handle, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0)
+			{
+				PostError("ListenPortShared");
+				return false;
+			}
+		}
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (!ListenPort(&socks[i], port))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint32_t ReceiveBatch(const Socket* sock, Packet* packets, uint32_t maxCount)
+	{
+		if (sock == nullptr || !sock->IsValid())
+		{
+			return 0;
+		}
+		auto socketinternal = to_internal(sock);
+		PacketPool& pool = socketinternal->pool;
+
+		mmsghdr headers[BATCH_SIZE];
+		iovec buffers[BATCH_SIZE];
+		sockaddr_in senders[BATCH_SIZE];
+		uint32_t indices[BATCH_SIZE];
+
+		uint32_t received = 0;
+		while (received < maxCount)
+		{
+			// If the pool is exhausted, the remaining packets stay queued in the socket until buffers are released:
+			const uint32_t batch = pool.Allocate(indices, std::min(maxCount - received, BATCH_SIZE));
+			if (batch == 0)
+			{
+				break;
+			}
+			for (uint32_t i = 0; i < batch; ++i)
+			{
+				buffers[i].iov_base = pool.GetBuffer(indices[i]);
+				buffers[i].iov_len = MAX_PACKET_SIZE;
+				headers[i] = {};
+				headers[i].msg_hdr.msg_name = &senders[i];
+				headers[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+				headers[i].msg_hdr.msg_iov = &buffers[i];
+				headers[i].msg_hdr.msg_iovlen = 1;
+			}
+
+			int result = recvmmsg(socketinternal->handle, headers, batch, MSG_DONTWAIT, nullptr);
+			if (result < 0)
+			{
+				pool.Free(indices, batch);
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				if (errno != EAGAIN && errno != EWOULDBLOCK)
+				{
+					PostError("ReceiveBatch");
+				}
+				break;
+			}
+
+			for (int i = 0; i < result; ++i)
+			{
+				if (headers[i].msg_hdr.msg_flags & MSG_TRUNC)
+				{
+					// Packets larger than MAX_PACKET_SIZE are dropped instead of handing out partial data:
+					pool.Free(&indices[i], 1);
+					continue;
+				}
+				Packet& packet = packets[received++];
+				FromAddress(senders[i], packet.connection);
+				packet.data = pool.GetBuffer(indices[i]);
+				packet.dataSize = headers[i].msg_len;
+				packet.bufferIndex = indices[i];
+			}
+			pool.Free(indices + result, batch - (uint32_t)result);
+
+			if ((uint32_t)result < batch)
+			{
+				break; // the socket's queue is empty
+			}
+		}
+		return received;
+	}
+
+	void ReleasePackets(const Socket* sock, const Packet* packets, uint32_t count)
+	{
+		if (sock == nullptr || !sock->IsValid())
+		{
+			return;
+		}
+		auto socketinternal = to_internal(sock);
+
+		uint32_t indices[BATCH_SIZE];
+		for (uint32_t i = 0; i < count; i += BATCH_SIZE)
+		{
+			const uint32_t batch = std::min(count - i, BATCH_SIZE);
+			for (uint32_t j = 0; j < batch; ++j)
+			{
+				indices[j] = packets[i + j].bufferIndex;
+			}
+			socketinternal->pool.Free(indices, batch);
+		}
+	}
+
 }
 
 #endif // LINUX
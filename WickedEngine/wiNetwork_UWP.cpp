@@ -40,6 +40,25 @@ namespace wiNetwork
 		return false;
 	}
 
+	uint32_t SendBatch(const Socket* sock, const Message* messages, uint32_t count)
+	{
+		return 0;
+	}
+
+	bool ListenPortShared(const Socket* socks, uint32_t count, uint16_t port)
+	{
+		return false;
+	}
+
+	uint32_t ReceiveBatch(const Socket* sock, Packet* packets, uint32_t maxCount)
+	{
+		return 0;
+	}
+
+	void ReleasePackets(const Socket* sock, const Packet* packets, uint32_t count)
+	{
+	}
+
 }
 
 #endif // _WIN32 && PLATFORM_UWP
@@ -3,8 +3,11 @@
 #if defined(_WIN32) && !defined(PLATFORM_UWP)
 #include "wiNetwork.h"
 #include "wiBackLog.h"
+#include "wiSpinLock.h"
 
 #include <sstream>
+#include <vector>
+#include <algorithm>
 
 #include <winsock.h>
 #pragma comment(lib,"ws2_32.lib")
@@ -22,10 +25,53 @@ namespace wiNetwork
 	};
 	std::shared_ptr<wiNetworkInternal> networkinternal;
 
+	// Number of receive buffers that a socket can hand out with ReceiveBatch():
+	static const uint32_t PACKET_POOL_SIZE = 1024;
+
+	struct PacketPool
+	{
+		std::vector<uint8_t> memory;
+		std::vector<uint32_t> freelist;
+		wiSpinLock locker;
+
+		bool Allocate(uint32_t& index)
+		{
+			locker.lock();
+			if (memory.empty())
+			{
+				memory.resize(PACKET_POOL_SIZE * MAX_PACKET_SIZE);
+				freelist.resize(PACKET_POOL_SIZE);
+				for (uint32_t i = 0; i < PACKET_POOL_SIZE; ++i)
+				{
+					freelist[i] = PACKET_POOL_SIZE - 1 - i;
+				}
+			}
+			bool success = !freelist.empty();
+			if (success)
+			{
+				index = freelist.back();
+				freelist.pop_back();
+			}
+			locker.unlock();
+			return success;
+		}
+		void Free(uint32_t index)
+		{
+			locker.lock();
+			freelist.push_back(index);
+			locker.unlock();
+		}
+		uint8_t* GetBuffer(uint32_t index)
+		{
+			return memory.data() + index * MAX_PACKET_SIZE;
+		}
+	};
+
 	struct SocketInternal
 	{
 		std::shared_ptr<wiNetworkInternal> networkinternal;
 		SOCKET handle = NULL;
+		PacketPool pool;
 
 		~SocketInternal()
 		{
@@ -191,6 +237,86 @@ namespace wiNetwork
 		return false;
 	}
 
+
+	// Windows doesn't have batched socket calls, these are implemented with the single packet functions:
+
+	uint32_t SendBatch(const Socket* sock, const Message* messages, uint32_t count)
+	{
+		uint32_t sent = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (Send(sock, &messages[i].connection, messages[i].data, messages[i].dataSize))
+			{
+				sent++;
+			}
+		}
+		return sent;
+	}
+
+	bool ListenPortShared(const Socket* socks, uint32_t count, uint16_t port)
+	{
+		if (count == 1)
+		{
+			return ListenPort(socks, port);
+		}
+		// SO_REUSEADDR doesn't distribute packets between sockets on Windows
+		wiBackLog::post("wiNetwork error in ListenPortShared: only one socket per port is supported on Windows");
+		return false;
+	}
+
+	uint32_t ReceiveBatch(const Socket* sock, Packet* packets, uint32_t maxCount)
+	{
+		uint32_t received = 0;
+		if (sock != nullptr && sock->IsValid())
+		{
+			auto socketinternal = to_internal(sock);
+
+			uint32_t index;
+			while (received < maxCount && CanReceive(sock, 0) && socketinternal->pool.Allocate(index))
+			{
+				sockaddr_in sender;
+				int targetsize = sizeof(sender);
+				int result = recvfrom(socketinternal->handle, (char*)socketinternal->pool.GetBuffer(index), (int)MAX_PACKET_SIZE, 0, (sockaddr*)& sender, &targetsize);
+				if (result == SOCKET_ERROR)
+				{
+					socketinternal->pool.Free(index);
+					int error = WSAGetLastError();
+					if (error == WSAEMSGSIZE)
+					{
+						continue; // packets larger than MAX_PACKET_SIZE are dropped
+					}
+					std::stringstream ss;
+					ss << "wiNetwork error in ReceiveBatch: " << error;
+					wiBackLog::post(ss.str().c_str());
+					break;
+				}
+
+				Packet& packet = packets[received++];
+				packet.connection.port = htons(sender.sin_port); // reverse byte order from network to host
+				packet.connection.ipaddress[0] = sender.sin_addr.S_un.S_un_b.s_b1;
+				packet.connection.ipaddress[1] = sender.sin_addr.S_un.S_un_b.s_b2;
+				packet.connection.ipaddress[2] = sender.sin_addr.S_un.S_un_b.s_b3;
+				packet.connection.ipaddress[3] = sender.sin_addr.S_un.S_un_b.s_b4;
+				packet.data = socketinternal->pool.GetBuffer(index);
+				packet.dataSize = (size_t)result;
+				packet.bufferIndex = index;
+			}
+		}
+		return received;
+	}
+
+	void ReleasePackets(const Socket* sock, const Packet* packets, uint32_t count)
+	{
+		if (sock != nullptr && sock->IsValid())
+		{
+			auto socketinternal = to_internal(sock);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				socketinternal->pool.Free(packets[i].bufferIndex);
+			}
+		}
+	}
+
 }
 
 #endif // _WIN32 && !PLATFORM_UWP
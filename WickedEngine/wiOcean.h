@@ -2,6 +2,7 @@
 #include "CommonInclude.h"
 #include "wiGraphicsDevice.h"
 #include "wiFFTGenerator.h"
+#include "wiOceanSimulation.h"
 #include "wiScene_Decl.h"
 
 #include <vector>
@@ -17,6 +18,10 @@ public:
 	const wiGraphics::Texture* getDisplacementMap() const;
 	const wiGraphics::Texture* getGradientMap() const;
 
+	// The CPU simulation that shares the spectrum with the GPU simulation, it must be given a resolution before it is updated
+	wiOceanSimulation& getSimulation() { return simulation; }
+	const wiOceanSimulation& getSimulation() const { return simulation; }
+
 	static void Initialize();
 	static void LoadShaders();
 
@@ -24,8 +29,7 @@ protected:
 	wiGraphics::Texture displacementMap;		// (RGBA32F)
 	wiGraphics::Texture gradientMap;			// (RGBA16F)
 
-
-	void initHeightMap(const wiScene::WeatherComponent& weather, XMFLOAT2* out_h0, float* out_omega);
+	wiOceanSimulation simulation;
 
 
 	// Initial height field H(0) generated by Phillips spectrum & Gauss distribution.
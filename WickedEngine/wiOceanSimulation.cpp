@@ -0,0 +1,483 @@
+#include "wiOceanSimulation.h"
+#include "wiScene.h"
+#include "wiJobSystem.h"
+
+#include <algorithm>
+
+using namespace wiScene;
+
+#define HALF_SQRT_2	0.7071068f
+#define GRAV_ACCEL	981.0f	// The acceleration of gravity, cm/s^2
+
+// Columns that are transformed by one FFT job, four SIMD vectors per row:
+#define FFT_COLUMN_BLOCK 16
+
+// Generating gaussian random number with mean 0 and standard deviation 1.
+static float Gauss()
+{
+	float u1 = rand() / (float)RAND_MAX;
+	float u2 = rand() / (float)RAND_MAX;
+	if (u1 < 1e-6f)
+		u1 = 1e-6f;
+	return sqrtf(-2 * logf(u1)) * cosf(2 * XM_PI * u2);
+}
+
+// Phillips Spectrum
+// K: normalized wave vector, W: wind direction, v: wind velocity, a: amplitude constant
+static float Phillips(XMFLOAT2 K, XMFLOAT2 W, float v, float a, float dir_depend)
+{
+	// largest possible wave from constant wind of velocity v
+	float l = v * v / GRAV_ACCEL;
+	// damp out waves with very small length w << l
+	float w = l / 1000;
+
+	float Ksqr = K.x * K.x + K.y * K.y;
+	float Kcos = K.x * W.x + K.y * W.y;
+	float phillips = a * expf(-1 / (l * l * Ksqr)) / (Ksqr * Ksqr * Ksqr) * (Kcos * Kcos);
+
+	// filter out waves moving opposite to wind
+	if (Kcos < 0)
+		phillips *= dir_depend;
+
+	// damp out waves with very small length w << l
+	return phillips * expf(-Ksqr * w * w);
+}
+
+// In-place radix-2 forward FFT along the columns of a complex plane, for FFT_COLUMN_BLOCK adjacent columns starting at column
+//	The transform is not normalized, the same as the 512x512 FFT of wiFFTGenerator
+static void FFT_Columns(float* re, float* im, uint32_t n, uint32_t column, const XMFLOAT2* twiddles, const uint32_t* bitreverse)
+{
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		const uint32_t j = bitreverse[i];
+		if (i < j)
+		{
+			for (uint32_t v = 0; v < FFT_COLUMN_BLOCK; v += 4)
+			{
+				XMFLOAT4* a_re = (XMFLOAT4*)(re + i * n + column + v);
+				XMFLOAT4* a_im = (XMFLOAT4*)(im + i * n + column + v);
+				XMFLOAT4* b_re = (XMFLOAT4*)(re + j * n + column + v);
+				XMFLOAT4* b_im = (XMFLOAT4*)(im + j * n + column + v);
+				std::swap(*a_re, *b_re);
+				std::swap(*a_im, *b_im);
+			}
+		}
+	}
+
+	for (uint32_t len = 2; len <= n; len <<= 1)
+	{
+		const uint32_t half = len >> 1;
+		const uint32_t step = n / len;
+		for (uint32_t k = 0; k < half; ++k)
+		{
+			const XMVECTOR w_re = XMVectorReplicate(twiddles[k * step].x);
+			const XMVECTOR w_im = XMVectorReplicate(twiddles[k * step].y);
+			for (uint32_t i = k; i < n; i += len)
+			{
+				float* a_re = re + i * n + column;
+				float* a_im = im + i * n + column;
+				float* b_re = re + (i + half) * n + column;
+				float* b_im = im + (i + half) * n + column;
+				for (uint32_t v = 0; v < FFT_COLUMN_BLOCK; v += 4)
+				{
+					const XMVECTOR ar = XMLoadFloat4((const XMFLOAT4*)(a_re + v));
+					const XMVECTOR ai = XMLoadFloat4((const XMFLOAT4*)(a_im + v));
+					const XMVECTOR br = XMLoadFloat4((const XMFLOAT4*)(b_re + v));
+					const XMVECTOR bi = XMLoadFloat4((const XMFLOAT4*)(b_im + v));
+
+					// t = b * w
+					const XMVECTOR tr = XMVectorNegativeMultiplySubtract(bi, w_im, XMVectorMultiply(br, w_re));
+					const XMVECTOR ti = XMVectorMultiplyAdd(bi, w_re, XMVectorMultiply(br, w_im));
+
+					XMStoreFloat4((XMFLOAT4*)(b_re + v), XMVectorSubtract(ar, tr));
+					XMStoreFloat4((XMFLOAT4*)(b_im + v), XMVectorSubtract(ai, ti));
+					XMStoreFloat4((XMFLOAT4*)(a_re + v), XMVectorAdd(ar, tr));
+					XMStoreFloat4((XMFLOAT4*)(a_im + v), XMVectorAdd(ai, ti));
+				}
+			}
+		}
+	}
+}
+
+
+void wiOceanSimulation::Create(const WeatherComponent& weather, uint32_t resolution)
+{
+	auto& params = weather.oceanParameters;
+
+	dmap_dim = (uint32_t)params.dmap_dim;
+	patch_length = params.patch_length;
+	choppy_scale = params.choppy_scale;
+	water_height = params.waterHeight;
+
+	// Initialize the vector field, the same layout as the GPU simulation uses:
+	int height_map_dim = params.dmap_dim;
+	int input_width = height_map_dim + 4;
+	h0_data.clear();
+	h0_data.resize(input_width * (height_map_dim + 1), XMFLOAT2(0, 0));
+	omega_data.clear();
+	omega_data.resize(input_width * (height_map_dim + 1), 0.0f);
+
+	XMFLOAT2 K;
+
+	XMFLOAT2 wind_dir;
+	XMStoreFloat2(&wind_dir, XMVector2Normalize(XMLoadFloat2(&params.wind_dir)));
+	float a = params.wave_amplitude * 1e-7f;	// It is too small. We must scale it for editing.
+	float v = params.wind_speed;
+	float dir_depend = params.wind_dependency;
+
+	for (int i = 0; i <= height_map_dim; i++)
+	{
+		// K is wave-vector, range [-|DX/W, |DX/W], [-|DY/H, |DY/H]
+		K.y = (-height_map_dim / 2.0f + i) * (2 * XM_PI / patch_length);
+
+		for (int j = 0; j <= height_map_dim; j++)
+		{
+			K.x = (-height_map_dim / 2.0f + j) * (2 * XM_PI / patch_length);
+
+			float phil = (K.x == 0 && K.y == 0) ? 0 : sqrtf(Phillips(K, wind_dir, v, a, dir_depend));
+
+			h0_data[i * input_width + j].x = float(phil * Gauss() * HALF_SQRT_2);
+			h0_data[i * input_width + j].y = float(phil * Gauss() * HALF_SQRT_2);
+
+			// The angular frequency is following the dispersion relation:
+			//            out_omega^2 = g*k
+			// The equation of Gerstner wave:
+			//            x = x0 - K/k * A * sin(dot(K, x0) - sqrt(g * k) * t), x is a 2D vector.
+			//            z = A * cos(dot(K, x0) - sqrt(g * k) * t)
+			// Gerstner wave shows that a point on a simple sinusoid wave is doing a uniform circular
+			// motion with the center (x0, y0, z0), radius A, and the circular plane is parallel to
+			// vector K.
+			omega_data[i * input_width + j] = sqrtf(GRAV_ACCEL * sqrtf(K.x * K.x + K.y * K.y));
+		}
+	}
+
+	this->resolution = 0;
+	simulated = false;
+	if (resolution > 0)
+	{
+		SetResolution(resolution);
+	}
+}
+
+void wiOceanSimulation::SetResolution(uint32_t value)
+{
+	assert(dmap_dim >= FFT_COLUMN_BLOCK); // Create() must be called before
+	value = std::max((uint32_t)FFT_COLUMN_BLOCK, std::min(value, dmap_dim));
+	while ((value & (value - 1)) != 0)
+	{
+		value &= value - 1; // round down to power of two
+	}
+	if (value == resolution)
+	{
+		return;
+	}
+	resolution = value;
+	simulated = false;
+
+	// The simulation grid uses the center of the spectrum, which are the largest waves:
+	const uint32_t count = resolution * resolution;
+	const uint32_t offset = (dmap_dim - resolution) / 2;
+	const uint32_t input_width = dmap_dim + 4;
+
+	h0k_re.resize(count);
+	h0k_im.resize(count);
+	h0mk_re.resize(count);
+	h0mk_im.resize(count);
+	omega.resize(count);
+	kx.resize(count);
+	ky.resize(count);
+	for (uint32_t y = 0; y < resolution; ++y)
+	{
+		for (uint32_t x = 0; x < resolution; ++x)
+		{
+			const uint32_t i = y * resolution + x;
+			const uint32_t gx = x + offset;
+			const uint32_t gy = y + offset;
+			const uint32_t in_index = gy * input_width + gx;
+			const uint32_t in_mindex = (dmap_dim - gy) * input_width + (dmap_dim - gx);
+
+			h0k_re[i] = h0_data[in_index].x;
+			h0k_im[i] = h0_data[in_index].y;
+			h0mk_re[i] = h0_data[in_mindex].x;
+			h0mk_im[i] = h0_data[in_mindex].y;
+			omega[i] = omega_data[in_index];
+
+			float k_x = gx - dmap_dim * 0.5f;
+			float k_y = gy - dmap_dim * 0.5f;
+			float sqr_k = k_x * k_x + k_y * k_y;
+			float rsqr_k = 0;
+			if (sqr_k > 1e-12f)
+				rsqr_k = 1 / sqrtf(sqr_k);
+			kx[i] = k_x * rsqr_k;
+			ky[i] = k_y * rsqr_k;
+		}
+	}
+
+	for (auto& x : planes)
+	{
+		x.resize(count);
+	}
+	for (auto& x : planes_transposed)
+	{
+		x.resize(count);
+	}
+
+	twiddles.resize(resolution / 2);
+	for (uint32_t k = 0; k < resolution / 2; ++k)
+	{
+		const double phase = -6.283185307179586476925286766559 * (double)k / (double)resolution;
+		twiddles[k] = XMFLOAT2((float)cos(phase), (float)sin(phase));
+	}
+
+	bitreverse.resize(resolution);
+	uint32_t bits = 0;
+	while ((1u << bits) < resolution)
+	{
+		bits++;
+	}
+	for (uint32_t i = 0; i < resolution; ++i)
+	{
+		uint32_t r = 0;
+		for (uint32_t b = 0; b < bits; ++b)
+		{
+			r |= ((i >> b) & 1) << (bits - 1 - b);
+		}
+		bitreverse[i] = r;
+	}
+
+	displacement.clear();
+	displacement.resize(count, XMFLOAT3(0, 0, 0));
+	displacement_previous.clear();
+	displacement_previous.resize(count, XMFLOAT3(0, 0, 0));
+}
+
+void wiOceanSimulation::Update(const WeatherComponent& weather, float time)
+{
+	if (resolution == 0)
+	{
+		return;
+	}
+
+	auto& params = weather.oceanParameters;
+	patch_length = params.patch_length;
+	choppy_scale = params.choppy_scale;
+	water_height = params.waterHeight;
+
+	const uint32_t n = resolution;
+	const float simulation_time = time * params.time_scale;
+	wiJobSystem::context ctx;
+
+	// H(0) -> H(t), Dx(t), Dy(t), four elements at a time:
+	wiJobSystem::Dispatch(ctx, n, 16, [&](wiJobArgs args) {
+		const XMVECTOR T = XMVectorReplicate(simulation_time);
+		for (uint32_t i = args.jobIndex * n; i < (args.jobIndex + 1) * n; i += 4)
+		{
+			XMVECTOR sin_v, cos_v;
+			XMVectorSinCos(&sin_v, &cos_v, XMVectorMultiply(XMLoadFloat4((const XMFLOAT4*)&omega[i]), T));
+
+			const XMVECTOR h0k_x = XMLoadFloat4((const XMFLOAT4*)&h0k_re[i]);
+			const XMVECTOR h0k_y = XMLoadFloat4((const XMFLOAT4*)&h0k_im[i]);
+			const XMVECTOR h0mk_x = XMLoadFloat4((const XMFLOAT4*)&h0mk_re[i]);
+			const XMVECTOR h0mk_y = XMLoadFloat4((const XMFLOAT4*)&h0mk_im[i]);
+
+			const XMVECTOR ht_x = XMVectorNegativeMultiplySubtract(XMVectorAdd(h0k_y, h0mk_y), sin_v, XMVectorMultiply(XMVectorAdd(h0k_x, h0mk_x), cos_v));
+			const XMVECTOR ht_y = XMVectorMultiplyAdd(XMVectorSubtract(h0k_y, h0mk_y), cos_v, XMVectorMultiply(XMVectorSubtract(h0k_x, h0mk_x), sin_v));
+
+			const XMVECTOR k_x = XMLoadFloat4((const XMFLOAT4*)&kx[i]);
+			const XMVECTOR k_y = XMLoadFloat4((const XMFLOAT4*)&ky[i]);
+
+			XMStoreFloat4((XMFLOAT4*)&planes[0][i], ht_x);
+			XMStoreFloat4((XMFLOAT4*)&planes[1][i], ht_y);
+			XMStoreFloat4((XMFLOAT4*)&planes[2][i], XMVectorMultiply(ht_y, k_x));
+			XMStoreFloat4((XMFLOAT4*)&planes[3][i], XMVectorNegate(XMVectorMultiply(ht_x, k_x)));
+			XMStoreFloat4((XMFLOAT4*)&planes[4][i], XMVectorMultiply(ht_y, k_y));
+			XMStoreFloat4((XMFLOAT4*)&planes[5][i], XMVectorNegate(XMVectorMultiply(ht_x, k_y)));
+		}
+	});
+	wiJobSystem::Wait(ctx);
+
+	// The 2D FFT is a 1D FFT along the columns, a transpose, then a 1D FFT along the columns again:
+	const uint32_t blocks = n / FFT_COLUMN_BLOCK;
+	wiJobSystem::Dispatch(ctx, 3 * blocks, 1, [&](wiJobArgs args) {
+		const uint32_t field = args.jobIndex / blocks;
+		const uint32_t column = (args.jobIndex % blocks) * FFT_COLUMN_BLOCK;
+		FFT_Columns(planes[field * 2].data(), planes[field * 2 + 1].data(), n, column, twiddles.data(), bitreverse.data());
+	});
+	wiJobSystem::Wait(ctx);
+
+	wiJobSystem::Dispatch(ctx, arraysize(planes) * (n / 4), 1, [&](wiJobArgs args) {
+		const uint32_t plane = args.jobIndex / (n / 4);
+		const uint32_t y = (args.jobIndex % (n / 4)) * 4;
+		const float* src = planes[plane].data();
+		float* dst = planes_transposed[plane].data();
+		for (uint32_t x = 0; x < n; x += 4)
+		{
+			XMMATRIX M = XMMATRIX(
+				XMLoadFloat4((const XMFLOAT4*)&src[(y + 0) * n + x]),
+				XMLoadFloat4((const XMFLOAT4*)&src[(y + 1) * n + x]),
+				XMLoadFloat4((const XMFLOAT4*)&src[(y + 2) * n + x]),
+				XMLoadFloat4((const XMFLOAT4*)&src[(y + 3) * n + x])
+			);
+			M = XMMatrixTranspose(M);
+			XMStoreFloat4((XMFLOAT4*)&dst[(x + 0) * n + y], M.r[0]);
+			XMStoreFloat4((XMFLOAT4*)&dst[(x + 1) * n + y], M.r[1]);
+			XMStoreFloat4((XMFLOAT4*)&dst[(x + 2) * n + y], M.r[2]);
+			XMStoreFloat4((XMFLOAT4*)&dst[(x + 3) * n + y], M.r[3]);
+		}
+	});
+	wiJobSystem::Wait(ctx);
+
+	wiJobSystem::Dispatch(ctx, 3 * blocks, 1, [&](wiJobArgs args) {
+		const uint32_t field = args.jobIndex / blocks;
+		const uint32_t column = (args.jobIndex % blocks) * FFT_COLUMN_BLOCK;
+		FFT_Columns(planes_transposed[field * 2].data(), planes_transposed[field * 2 + 1].data(), n, column, twiddles.data(), bitreverse.data());
+	});
+	wiJobSystem::Wait(ctx);
+
+	// Displacement map, the results are transposed (x major):
+	displacement.swap(displacement_previous);
+	wiJobSystem::Dispatch(ctx, n, 16, [&](wiJobArgs args) {
+		const uint32_t y = args.jobIndex;
+		for (uint32_t x = 0; x < n; ++x)
+		{
+			const uint32_t addr = x * n + y;
+
+			// cos(pi * (m1 + m2))
+			const float sign_correction = ((x + y) & 1) ? -1.0f : 1.0f;
+
+			// The GPU displacement map stores (dx, dy, dz), the surface rendering applies it as (dx, dz, dy):
+			XMFLOAT3& d = displacement[y * n + x];
+			d.x = planes_transposed[2][addr] * sign_correction * choppy_scale;
+			d.y = planes_transposed[0][addr] * sign_correction;
+			d.z = planes_transposed[4][addr] * sign_correction * choppy_scale;
+		}
+	});
+	wiJobSystem::Wait(ctx);
+
+	if (simulated)
+	{
+		time_previous = time_current;
+	}
+	else
+	{
+		displacement_previous = displacement;
+		time_previous = time;
+	}
+	time_current = time;
+	simulated = true;
+}
+
+XMFLOAT3 wiOceanSimulation::Sample(const std::vector<XMFLOAT3>& grid, float x, float z) const
+{
+	if (!IsValid())
+	{
+		return XMFLOAT3(0, 0, 0);
+	}
+
+	// Bilinear filtering with wrapping, the same as the displacement map sampling of the surface rendering:
+	const float texel_x = x / patch_length * resolution;
+	const float texel_z = z / patch_length * resolution;
+	const float floor_x = floorf(texel_x);
+	const float floor_z = floorf(texel_z);
+	const XMVECTOR lerp_x = XMVectorReplicate(texel_x - floor_x);
+	const XMVECTOR lerp_z = XMVectorReplicate(texel_z - floor_z);
+
+	const uint32_t mask = resolution - 1;
+	const uint32_t x0 = uint32_t((int64_t)floor_x) & mask;
+	const uint32_t z0 = uint32_t((int64_t)floor_z) & mask;
+	const uint32_t x1 = (x0 + 1) & mask;
+	const uint32_t z1 = (z0 + 1) & mask;
+
+	const XMVECTOR a = XMVectorLerpV(XMLoadFloat3(&grid[z0 * resolution + x0]), XMLoadFloat3(&grid[z0 * resolution + x1]), lerp_x);
+	const XMVECTOR b = XMVectorLerpV(XMLoadFloat3(&grid[z1 * resolution + x0]), XMLoadFloat3(&grid[z1 * resolution + x1]), lerp_x);
+
+	XMFLOAT3 result;
+	XMStoreFloat3(&result, XMVectorLerpV(a, b, lerp_z));
+	return result;
+}
+
+XMFLOAT2 wiOceanSimulation::FindSurfacePoint(const XMFLOAT3& position) const
+{
+	// Choppy waves move the surface horizontally, so find the point of the water plane that is displaced to the position
+	//	This solves point + displacement(point) = position with Newton iterations, the Jacobian is from central differences
+	const float texel = patch_length / std::max(1u, resolution);
+	const float h = texel * 0.5f;
+	const float tolerance = texel * 0.001f;
+	XMFLOAT2 point = XMFLOAT2(position.x, position.z);
+	for (int i = 0; i < 6; ++i)
+	{
+		const XMFLOAT3 d = Sample(displacement, point.x, point.y);
+		const float rx = point.x + d.x - position.x;
+		const float rz = point.y + d.z - position.z;
+		if (rx * rx + rz * rz < tolerance * tolerance)
+		{
+			break;
+		}
+
+		const XMFLOAT3 right = Sample(displacement, point.x + h, point.y);
+		const XMFLOAT3 left = Sample(displacement, point.x - h, point.y);
+		const XMFLOAT3 front = Sample(displacement, point.x, point.y + h);
+		const XMFLOAT3 back = Sample(displacement, point.x, point.y - h);
+		const float j00 = 1 + (right.x - left.x) / (2 * h);
+		const float j01 = (front.x - back.x) / (2 * h);
+		const float j10 = (right.z - left.z) / (2 * h);
+		const float j11 = 1 + (front.z - back.z) / (2 * h);
+		const float det = j00 * j11 - j01 * j10;
+		if (det > 0.1f)
+		{
+			point.x -= (j11 * rx - j01 * rz) / det;
+			point.y -= (j00 * rz - j10 * rx) / det;
+		}
+		else
+		{
+			// The surface is folded here, step without the Jacobian:
+			point.x -= rx;
+			point.y -= rz;
+		}
+	}
+	return point;
+}
+
+XMFLOAT3 wiOceanSimulation::GetDisplacement(const XMFLOAT3& position) const
+{
+	return Sample(displacement, position.x, position.z);
+}
+
+float wiOceanSimulation::GetHeight(const XMFLOAT3& position) const
+{
+	const XMFLOAT2 point = FindSurfacePoint(position);
+	return water_height + Sample(displacement, point.x, point.y).y;
+}
+
+XMFLOAT3 wiOceanSimulation::GetNormal(const XMFLOAT3& position) const
+{
+	const XMFLOAT2 point = FindSurfacePoint(position);
+
+	// The same as the gradient map of the GPU simulation:
+	const float texel = patch_length / std::max(1u, resolution);
+	const float left = Sample(displacement, point.x - texel, point.y).y;
+	const float right = Sample(displacement, point.x + texel, point.y).y;
+	const float back = Sample(displacement, point.x, point.y - texel).y;
+	const float front = Sample(displacement, point.x, point.y + texel).y;
+
+	XMFLOAT3 normal;
+	XMStoreFloat3(&normal, XMVector3Normalize(XMVectorSet(-(right - left), texel * 2, -(front - back), 0)));
+	return normal;
+}
+
+XMFLOAT3 wiOceanSimulation::GetVelocity(const XMFLOAT3& position) const
+{
+	const float dt = time_current - time_previous;
+	if (dt <= 0)
+	{
+		return XMFLOAT3(0, 0, 0);
+	}
+
+	const XMFLOAT2 point = FindSurfacePoint(position);
+	const XMFLOAT3 current = Sample(displacement, point.x, point.y);
+	const XMFLOAT3 previous = Sample(displacement_previous, point.x, point.y);
+
+	XMFLOAT3 velocity;
+	XMStoreFloat3(&velocity, XMVectorScale(XMVectorSubtract(XMLoadFloat3(&current), XMLoadFloat3(&previous)), 1.0f / dt));
+	return velocity;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiScene_Decl.h"
+
+#include <vector>
+
+// CPU simulation of the ocean surface, for gameplay queries (boats, buoyancy, server side logic) without reading back the GPU displacement map
+//	It evaluates the same spectrum with the same FFT as the GPU simulation of wiOcean, so the queried surface matches the rendered one within tolerance.
+//	A resolution that is lower than the displacement map only leaves out the smallest waves.
+class wiOceanSimulation
+{
+public:
+	// Generates the initial spectrum from the ocean parameters of the weather, and allocates the simulation grid (resolution = 0 generates the spectrum only)
+	//	The spectrum is randomized with rand(), so it must be seeded the same way on every machine that should see the same waves
+	void Create(const wiScene::WeatherComponent& weather, uint32_t resolution = 128);
+	// Changes the size of the simulation grid, it must be a power of two between 16 and the displacement map dimension (oceanParameters.dmap_dim)
+	void SetResolution(uint32_t value);
+	// Simulates the surface at the given time on the job system, the time should be the same one that wiOcean::UpdateDisplacementMap() receives
+	//	The queries must not be used while this is running
+	void Update(const wiScene::WeatherComponent& weather, float time);
+
+	bool IsValid() const { return resolution > 0 && simulated; }
+	uint32_t GetResolution() const { return resolution; }
+
+	// The displacement of the water plane at the world space position (x, z), the same one that the ocean surface rendering applies near the camera
+	XMFLOAT3 GetDisplacement(const XMFLOAT3& position) const;
+	// The height of the water surface at the world space position (x, z), the horizontal displacement of choppy waves is taken into account
+	float GetHeight(const XMFLOAT3& position) const;
+	// The surface normal at the world space position (x, z)
+	XMFLOAT3 GetNormal(const XMFLOAT3& position) const;
+	// The velocity of the water surface at the world space position (x, z), from the difference of the last two updates
+	XMFLOAT3 GetVelocity(const XMFLOAT3& position) const;
+
+	// The initial spectrum H(0) and the angular frequencies of the full displacement map dimension, the GPU simulation is created from these
+	const std::vector<XMFLOAT2>& GetSpectrum() const { return h0_data; }
+	const std::vector<float>& GetOmega() const { return omega_data; }
+
+private:
+	std::vector<XMFLOAT2> h0_data;
+	std::vector<float> omega_data;
+	uint32_t dmap_dim = 0;
+
+	uint32_t resolution = 0;
+	bool simulated = false;
+	float patch_length = 1;
+	float choppy_scale = 1;
+	float water_height = 0;
+	float time_current = 0;
+	float time_previous = 0;
+
+	// Spectrum of the simulation grid, structure of arrays so that H(t) can be evaluated four elements at a time:
+	std::vector<float> h0k_re, h0k_im, h0mk_re, h0mk_im, omega, kx, ky;
+	// Real and imaginary parts of H(t), Dx(t) and Dy(t), the second set is the transposed intermediate result of the 2D FFT:
+	std::vector<float> planes[6];
+	std::vector<float> planes_transposed[6];
+	std::vector<XMFLOAT2> twiddles;
+	std::vector<uint32_t> bitreverse;
+
+	// World space displacement (x, height, z) of the grid points at the last two updates:
+	std::vector<XMFLOAT3> displacement;
+	std::vector<XMFLOAT3> displacement_previous;
+
+	XMFLOAT3 Sample(const std::vector<XMFLOAT3>& grid, float x, float z) const;
+	XMFLOAT2 FindSurfacePoint(const XMFLOAT3& position) const;
+};
@@ -10,6 +10,26 @@ namespace wiPhysicsEngine
 	bool IsEnabled();
 	void SetEnabled(bool value);
 
+	// Set the fixed frequency of the simulation in steps per second (default = 60)
+	//	The simulation is decoupled from the rendering framerate, it accumulates the incoming delta time and steps with this fixed timestep
+	void SetFrameRate(float value);
+	float GetFrameRate();
+
+	// Set the maximum number of simulation steps that can be performed in one update (default = 4)
+	//	If the accumulated time would require more steps, the remaining time is dropped, so frame hitches don't cause a simulation spiral
+	void SetMaxSubSteps(uint32_t value);
+	uint32_t GetMaxSubSteps();
+
+	// Rendered transforms of rigid bodies will be interpolated between the last two simulation states (default = true)
+	bool IsInterpolationEnabled();
+	void SetInterpolationEnabled(bool value);
+
+	// Deterministic mode: the same sequence of updates will produce bitwise identical results (default = false)
+	//	The solver iterates in a fixed order and bodies are registered in component order instead of in parallel
+	//	When the last body is removed from the simulation, the internal simulation state is reset so that a new simulation can be replayed
+	bool IsDeterministic();
+	void SetDeterministic(bool value);
+
 	void RunPhysicsUpdateSystem(
 		wiJobSystem::context& ctx,
 		wiScene::Scene& scene,
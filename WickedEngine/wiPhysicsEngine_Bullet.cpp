@@ -12,6 +12,8 @@
 
 #include <mutex>
 #include <memory>
+#include <algorithm>
+#include <cmath>
 
 using namespace std;
 using namespace wiECS;
@@ -21,6 +23,12 @@ using namespace wiScene;
 namespace wiPhysicsEngine
 {
 	bool ENABLED = true;
+	bool INTERPOLATION = true;
+	bool DETERMINISTIC = false;
+	float FRAMERATE = 60;
+	uint32_t MAX_SUBSTEPS = 4;
+	float accumulator = 0;
+	uint64_t simulationStep = 0;
 	std::mutex physicsLock;
 
 	btVector3 gravity(0, -10, 0);
@@ -31,6 +39,68 @@ namespace wiPhysicsEngine
 	std::unique_ptr<btSequentialImpulseConstraintSolver> solver;
 	std::unique_ptr<btDynamicsWorld> dynamicsWorld;
 
+	// Keeps the last two simulation states of a rigid body, so that rendering can interpolate between them
+	ATTRIBUTE_ALIGNED16(struct) MotionState : public btMotionState
+	{
+		BT_DECLARE_ALIGNED_ALLOCATOR();
+
+		btTransform previous;
+		btTransform current;
+		uint64_t step = 0; // the simulation step in which current was last written
+
+		MotionState(const btTransform& transform) : previous(transform), current(transform) {}
+
+		void getWorldTransform(btTransform& worldTrans) const override
+		{
+			worldTrans = current;
+		}
+		void setWorldTransform(const btTransform& worldTrans) override
+		{
+			if (step != simulationStep)
+			{
+				previous = current;
+				step = simulationStep;
+			}
+			current = worldTrans;
+		}
+
+		// alpha : [0, 1] position between the previous and current simulation step
+		btTransform GetInterpolatedTransform(btScalar alpha) const
+		{
+			if (step != simulationStep)
+			{
+				// body didn't move in the last step (sleeping), previous state is out of date:
+				return current;
+			}
+			btTransform result;
+			result.setOrigin(previous.getOrigin().lerp(current.getOrigin(), alpha));
+			result.setRotation(previous.getRotation().slerp(current.getRotation(), alpha));
+			return result;
+		}
+	};
+
+	void ApplySolverMode()
+	{
+		if (DETERMINISTIC)
+		{
+			dynamicsWorld->getSolverInfo().m_solverMode &= ~SOLVER_RANDMIZE_ORDER;
+		}
+		else
+		{
+			dynamicsWorld->getSolverInfo().m_solverMode |= SOLVER_RANDMIZE_ORDER;
+		}
+	}
+
+	// Resets internal simulation state when the world is empty, so that a new simulation starts from the same state
+	void ResetSimulationState()
+	{
+		assert(dynamicsWorld->getNumCollisionObjects() == 0);
+		overlappingPairCache->resetPool(dispatcher.get());
+		solver->reset();
+		accumulator = 0;
+		simulationStep = 0;
+	}
+
 
 	void Initialize()
 	{
@@ -48,7 +118,7 @@ namespace wiPhysicsEngine
 
 		dynamicsWorld = std::make_unique<btSoftRigidDynamicsWorld>(dispatcher.get(), overlappingPairCache.get(), solver.get(), collisionConfiguration.get());
 
-		dynamicsWorld->getSolverInfo().m_solverMode |= SOLVER_RANDMIZE_ORDER;
+		ApplySolverMode();
 		dynamicsWorld->getDispatchInfo().m_enableSatConvex = true;
 		dynamicsWorld->getSolverInfo().m_splitImpulse = true;
 
@@ -69,6 +139,25 @@ namespace wiPhysicsEngine
 	bool IsEnabled() { return ENABLED; }
 	void SetEnabled(bool value) { ENABLED = value; }
 
+	void SetFrameRate(float value) { FRAMERATE = std::max(1.0f, value); }
+	float GetFrameRate() { return FRAMERATE; }
+
+	void SetMaxSubSteps(uint32_t value) { MAX_SUBSTEPS = std::max(1u, value); }
+	uint32_t GetMaxSubSteps() { return MAX_SUBSTEPS; }
+
+	bool IsInterpolationEnabled() { return INTERPOLATION; }
+	void SetInterpolationEnabled(bool value) { INTERPOLATION = value; }
+
+	bool IsDeterministic() { return DETERMINISTIC; }
+	void SetDeterministic(bool value)
+	{
+		DETERMINISTIC = value;
+		if (dynamicsWorld != nullptr)
+		{
+			ApplySolverMode();
+		}
+	}
+
 	void AddRigidBody(Entity entity, wiScene::RigidBodyPhysicsComponent& physicscomponent, const wiScene::MeshComponent& mesh, const wiScene::TransformComponent& transform)
 	{
 		btVector3 S(transform.scale_local.x, transform.scale_local.y, transform.scale_local.z);
@@ -162,7 +251,7 @@ namespace wiPhysicsEngine
 			shapeTransform.setIdentity();
 			shapeTransform.setOrigin(btVector3(transform.translation_local.x, transform.translation_local.y, transform.translation_local.z));
 			shapeTransform.setRotation(btQuaternion(transform.rotation_local.x, transform.rotation_local.y, transform.rotation_local.z, transform.rotation_local.w));
-			btDefaultMotionState* myMotionState = new btDefaultMotionState(shapeTransform);
+			MotionState* myMotionState = new MotionState(shapeTransform);
 
 			btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, shape, localInertia);
 			//rbInfo.m_friction = physicscomponent.friction;
@@ -299,7 +388,7 @@ namespace wiPhysicsEngine
 		btVector3 wind = btVector3(scene.weather.windDirection.x, scene.weather.windDirection.y, scene.weather.windDirection.z);
 
 		// System will register rigidbodies to objects, and update physics engine state for kinematics:
-		wiJobSystem::Dispatch(ctx, (uint32_t)scene.rigidbodies.GetCount(), 256, [&](wiJobArgs args) {
+		auto rigidbody_prepare = [&](wiJobArgs args) {
 
 			RigidBodyPhysicsComponent& physicscomponent = scene.rigidbodies[args.jobIndex];
 			Entity entity = scene.rigidbodies.GetEntity(args.jobIndex);
@@ -346,10 +435,10 @@ namespace wiPhysicsEngine
 					motionState->setWorldTransform(physicsTransform);
 				}
 			}
-		});
+		};
 
 		// System will register softbodies to meshes and update physics engine state:
-		wiJobSystem::Dispatch(ctx, (uint32_t)scene.softbodies.GetCount(), 1, [&](wiJobArgs args) {
+		auto softbody_prepare = [&](wiJobArgs args) {
 
 			SoftBodyPhysicsComponent& physicscomponent = scene.softbodies[args.jobIndex];
 			Entity entity = scene.softbodies.GetEntity(args.jobIndex);
@@ -399,17 +488,64 @@ namespace wiPhysicsEngine
 					}
 				}
 			}
-		});
+		};
 
-		wiJobSystem::Wait(ctx);
+		if (DETERMINISTIC)
+		{
+			// Bodies are registered in component order, so the simulation order is stable:
+			wiJobArgs args = {};
+			for (uint32_t i = 0; i < (uint32_t)scene.rigidbodies.GetCount(); ++i)
+			{
+				args.jobIndex = i;
+				rigidbody_prepare(args);
+			}
+			for (uint32_t i = 0; i < (uint32_t)scene.softbodies.GetCount(); ++i)
+			{
+				args.jobIndex = i;
+				softbody_prepare(args);
+			}
+		}
+		else
+		{
+			wiJobSystem::Dispatch(ctx, (uint32_t)scene.rigidbodies.GetCount(), 256, rigidbody_prepare);
+			wiJobSystem::Dispatch(ctx, (uint32_t)scene.softbodies.GetCount(), 1, softbody_prepare);
+			wiJobSystem::Wait(ctx);
+		}
 
-		// Perform internal simulation step:
-		dynamicsWorld->stepSimulation(dt, 10);
+		// Perform internal simulation steps with fixed timestep:
+		const float timestep = 1.0f / FRAMERATE;
+		if (dynamicsWorld->getNumCollisionObjects() == 0)
+		{
+			// Nothing to simulate, the simulation clock restarts when bodies are added:
+			ResetSimulationState();
+		}
+		else
+		{
+			accumulator += dt;
+			uint32_t steps = 0;
+			while (accumulator >= timestep && steps < MAX_SUBSTEPS)
+			{
+				simulationStep++;
+				dynamicsWorld->stepSimulation(timestep, 0);
+				accumulator -= timestep;
+				steps++;
+			}
+			if (accumulator >= timestep)
+			{
+				// Over budget, drop the remaining whole steps:
+				accumulator = std::fmod(accumulator, timestep);
+			}
+		}
+		const btScalar alpha = INTERPOLATION ? btScalar(accumulator / timestep) : btScalar(1);
 
 		// Feedback physics engine state to system:
-		for (int i = 0; i < dynamicsWorld->getCollisionObjectArray().size(); ++i)
-		{
-			btCollisionObject* collisionobject = dynamicsWorld->getCollisionObjectArray()[i];
+		//	Collision objects are processed in parallel, each of them writes only to its own components
+		//	Objects whose components were removed can't be removed from the world while iterating, so they are collected and removed afterwards
+		btCollisionObjectArray& collisionobjects = dynamicsWorld->getCollisionObjectArray();
+		std::vector<int> orphans;
+		wiJobSystem::Dispatch(ctx, (uint32_t)collisionobjects.size(), 64, [&](wiJobArgs args) {
+
+			btCollisionObject* collisionobject = collisionobjects[args.jobIndex];
 			Entity entity = (Entity)collisionobject->getUserIndex();
 
 			btRigidBody* rigidbody = btRigidBody::upcast(collisionobject);
@@ -418,9 +554,10 @@ namespace wiPhysicsEngine
 				RigidBodyPhysicsComponent* physicscomponent = scene.rigidbodies.GetComponent(entity);
 				if (physicscomponent == nullptr)
 				{
-					dynamicsWorld->removeRigidBody(rigidbody);
-					i--;
-					continue;
+					physicsLock.lock();
+					orphans.push_back((int)args.jobIndex);
+					physicsLock.unlock();
+					return;
 				}
 
 				// Feedback non-kinematic objects to system:
@@ -428,10 +565,9 @@ namespace wiPhysicsEngine
 				{
 					TransformComponent& transform = *scene.transforms.GetComponent(entity);
 
-					btMotionState* motionState = rigidbody->getMotionState();
-					btTransform physicsTransform;
+					const MotionState* motionState = (const MotionState*)rigidbody->getMotionState();
+					btTransform physicsTransform = motionState->GetInterpolatedTransform(alpha);
 
-					motionState->getWorldTransform(physicsTransform);
 					btVector3 T = physicsTransform.getOrigin();
 					btQuaternion R = physicsTransform.getRotation();
 
@@ -449,13 +585,12 @@ namespace wiPhysicsEngine
 					SoftBodyPhysicsComponent* physicscomponent = scene.softbodies.GetComponent(entity);
 					if (physicscomponent == nullptr)
 					{
-						((btSoftRigidDynamicsWorld*)dynamicsWorld.get())->removeSoftBody(softbody);
-						i--;
-						continue;
+						physicsLock.lock();
+						orphans.push_back((int)args.jobIndex);
+						physicsLock.unlock();
+						return;
 					}
 
-					MeshComponent& mesh = *scene.meshes.GetComponent(entity);
-
 					// System mesh aabb will be queried from physics engine soft body:
 					btVector3 aabb_min;
 					btVector3 aabb_max;
@@ -463,14 +598,14 @@ namespace wiPhysicsEngine
 					physicscomponent->aabb = AABB(XMFLOAT3(aabb_min.x(), aabb_min.y(), aabb_min.z()), XMFLOAT3(aabb_max.x(), aabb_max.y(), aabb_max.z()));
 
 					// Soft body simulation nodes will update graphics mesh:
-					for (size_t ind = 0; ind < physicscomponent->vertex_positions_simulation.size(); ++ind)
+					const uint32_t* graphicsToPhysics = physicscomponent->graphicsToPhysicsVertexMapping.data();
+					MeshComponent::Vertex_POS* vertices = physicscomponent->vertex_positions_simulation.data();
+					const size_t vertexCount = physicscomponent->vertex_positions_simulation.size();
+					for (size_t ind = 0; ind < vertexCount; ++ind)
 					{
-						uint32_t physicsInd = physicscomponent->graphicsToPhysicsVertexMapping[ind];
-						float weight = physicscomponent->weights[physicsInd];
+						const btSoftBody::Node& node = softbody->m_nodes[graphicsToPhysics[ind]];
 
-						btSoftBody::Node& node = softbody->m_nodes[physicsInd];
-
-						MeshComponent::Vertex_POS& vertex = physicscomponent->vertex_positions_simulation[ind];
+						MeshComponent::Vertex_POS& vertex = vertices[ind];
 						vertex.pos.x = node.m_x.getX();
 						vertex.pos.y = node.m_x.getY();
 						vertex.pos.z = node.m_x.getZ();
@@ -483,6 +618,36 @@ namespace wiPhysicsEngine
 					}
 				}
 			}
+		});
+
+		wiJobSystem::Wait(ctx);
+
+		// Removal reorders the collision object array, so orphans are removed in a stable order:
+		std::sort(orphans.begin(), orphans.end());
+		std::vector<btCollisionObject*> orphan_objects(orphans.size());
+		for (size_t i = 0; i < orphans.size(); ++i)
+		{
+			orphan_objects[i] = collisionobjects[orphans[i]];
+		}
+		for (btCollisionObject* collisionobject : orphan_objects)
+		{
+			btRigidBody* rigidbody = btRigidBody::upcast(collisionobject);
+			if (rigidbody != nullptr)
+			{
+				dynamicsWorld->removeRigidBody(rigidbody);
+			}
+			else
+			{
+				btSoftBody* softbody = btSoftBody::upcast(collisionobject);
+				if (softbody != nullptr)
+				{
+					((btSoftRigidDynamicsWorld*)dynamicsWorld.get())->removeSoftBody(softbody);
+				}
+			}
+		}
+		if (!orphan_objects.empty() && dynamicsWorld->getNumCollisionObjects() == 0)
+		{
+			ResetSimulationState();
 		}
 
 		wiProfiler::EndRange(range); // Physics
@@ -6,11 +6,16 @@
 #include "wiTimer.h"
 #include "wiTextureHelper.h"
 #include "wiHelper.h"
+#include "wiBackLog.h"
 
 #include <sstream>
 #include <unordered_map>
-#include <stack>
+#include <unordered_set>
+#include <vector>
+#include <algorithm>
+#include <atomic>
 #include <mutex>
+#include <cstdio>
 
 using namespace std;
 using namespace wiGraphics;
@@ -23,6 +28,10 @@ namespace wiProfiler
 	range_id cpu_frame;
 	range_id gpu_frame;
 
+	// CPU range ids are even, GPU range ids are odd. The lowest bit of recorded CPU events marks the end of a range
+	inline range_id GetCPURangeID(const char* name) { return wiHelper::string_hash(name) & ~range_id(1); }
+	inline range_id GetGPURangeID(const char* name) { return wiHelper::string_hash(name) | range_id(1); }
+
 	struct Range
 	{
 		std::string name;
@@ -31,15 +40,236 @@ namespace wiProfiler
 		float time = 0;
 		CommandList cmd = COMMANDLIST_COUNT;
 
-		wiTimer cpuBegin, cpuEnd;
-
 		wiRenderer::GPUQueryRing<4> gpuBegin;
 		wiRenderer::GPUQueryRing<4> gpuEnd;
-
-		bool IsCPURange() const { return cmd == COMMANDLIST_COUNT; }
 	};
-	std::unordered_map<size_t, Range> ranges;
+	std::unordered_map<size_t, Range> ranges; // GPU ranges
 	wiRenderer::GPUQueryRing<4> disjoint;
+	double cpuFrameBegin[4] = {}; // CPU time of the frames in flight, GPU ranges are aligned to these
+
+	// Names of CPU ranges, never removed so that the name pointers stay valid
+	std::unordered_map<range_id, std::string> names;
+	std::atomic<uint32_t> epoch{ 0 };
+
+	struct Event
+	{
+		double time;
+		range_id id;
+	};
+	static const uint32_t EVENT_COUNT = 8192; // per thread and frame, must be power of two
+	static const uint32_t MAX_THREADS = 256;
+	static const uint32_t GPU_THREAD = MAX_THREADS;
+
+	// Every thread that records CPU ranges writes its events into its own single producer, single consumer ring, which is read in EndFrame()
+	struct ThreadData
+	{
+		Event events[EVENT_COUNT];
+		std::atomic<uint32_t> head{ 0 }; // written by the owner thread
+		std::atomic<uint32_t> tail{ 0 }; // written by EndFrame()
+		std::atomic<uint32_t> dropped{ 0 };
+		std::atomic<bool> exited{ false };	// the owner thread exited, the remaining events are still read
+		std::atomic<bool> available{ false };	// can be taken over by a new thread
+		uint32_t index = 0;
+		std::string name; // guarded by lock
+
+		// Owner thread only:
+		uint32_t epoch = 0;
+		std::unordered_set<range_id> registered;
+		std::unordered_map<range_id, const char*> jobNames;
+		range_id open[64];
+		uint32_t openCount = 0;
+
+		// EndFrame() only:
+		struct OpenRange
+		{
+			range_id id;
+			double time;
+		};
+		std::vector<OpenRange> stack;
+	};
+	std::atomic<ThreadData*> threads[MAX_THREADS];
+	std::atomic<uint32_t> threadCount{ 0 };
+	thread_local std::string threadName;
+
+	// Marks the ThreadData of a thread when it exits, so that it can be reused
+	struct ThreadDataOwner
+	{
+		ThreadData* data = nullptr;
+		~ThreadDataOwner()
+		{
+			if (data != nullptr)
+			{
+				data->exited.store(true);
+			}
+		}
+	};
+	thread_local ThreadDataOwner threadData;
+
+	ThreadData* GetThreadData()
+	{
+		ThreadData* data = threadData.data;
+		if (data == nullptr)
+		{
+			const uint32_t count = std::min(threadCount.load(), MAX_THREADS);
+			for (uint32_t i = 0; i < count && data == nullptr; ++i)
+			{
+				ThreadData* candidate = threads[i].load();
+				bool expected = true;
+				if (candidate != nullptr && candidate->available.compare_exchange_strong(expected, false))
+				{
+					candidate->exited.store(false);
+					data = candidate;
+				}
+			}
+			if (data == nullptr)
+			{
+				const uint32_t index = threadCount.fetch_add(1);
+				if (index >= MAX_THREADS)
+				{
+					threadCount.fetch_sub(1);
+					return nullptr;
+				}
+				data = new ThreadData;
+				data->index = index;
+				threads[index].store(data);
+			}
+			data->epoch = epoch.load();
+			data->openCount = 0;
+			data->registered.clear();
+			data->jobNames.clear();
+			lock.lock();
+			data->name = threadName.empty() ? ("Thread " + std::to_string(data->index)) : threadName;
+			lock.unlock();
+			threadData.data = data;
+		}
+		if (data->epoch != epoch.load(std::memory_order_relaxed))
+		{
+			// profiling was restarted, ranges that were open before don't matter
+			data->epoch = epoch.load();
+			data->openCount = 0;
+		}
+		return data;
+	}
+	inline void RecordEvent(ThreadData& data, double time, range_id id)
+	{
+		const uint32_t head = data.head.load(std::memory_order_relaxed);
+		if (head - data.tail.load(std::memory_order_acquire) >= EVENT_COUNT)
+		{
+			data.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		data.events[head % EVENT_COUNT] = { time, id };
+		data.head.store(head + 1, std::memory_order_release);
+	}
+
+	// Statistics of a CPU range, summed over every thread in a frame
+	struct CPUStats
+	{
+		float times[20] = {};
+		int avg_counter = 0;
+		float time = 0;
+		double frameTime = 0;
+		uint32_t frameCount = 0;
+		uint32_t count = 0;		// how many times the range was recorded in the last frame that contained it
+		uint32_t depth = ~0u;
+		double firstBegin = 0;
+	};
+	std::unordered_map<range_id, CPUStats> cpuStats;
+	uint32_t droppedEvents = 0;
+
+	struct Scope
+	{
+		range_id id;
+		uint32_t thread;
+		double begin;
+		double end;
+		std::string gpuName;
+	};
+	struct CaptureState
+	{
+		uint32_t remaining = 0;
+		std::string filename;
+		std::vector<Scope> scopes;
+	} capture;
+
+	void WriteCapture()
+	{
+		std::string json;
+		json.reserve(capture.scopes.size() * 100 + 1024);
+		json += "{\"traceEvents\":[\n";
+
+		auto append_escaped = [&](const std::string& text) {
+			for (char c : text)
+			{
+				if (c == '"' || c == '\\')
+				{
+					json += '\\';
+				}
+				json += c;
+			}
+		};
+
+		char buffer[256];
+		bool first = true;
+		auto separator = [&] {
+			if (!first)
+			{
+				json += ",\n";
+			}
+			first = false;
+		};
+
+		lock.lock();
+		const uint32_t count = std::min(threadCount.load(), MAX_THREADS);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			ThreadData* data = threads[i].load();
+			if (data == nullptr)
+				continue;
+			separator();
+			snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"", data->index);
+			json += buffer;
+			append_escaped(data->name);
+			json += "\"}}";
+		}
+		separator();
+		snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}", GPU_THREAD);
+		json += buffer;
+
+		for (const Scope& scope : capture.scopes)
+		{
+			separator();
+			json += "{\"name\":\"";
+			if (scope.thread == GPU_THREAD)
+			{
+				append_escaped(scope.gpuName);
+			}
+			else
+			{
+				append_escaped(names[scope.id]);
+			}
+			snprintf(buffer, sizeof(buffer), "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				scope.thread == GPU_THREAD ? "gpu" : "cpu", scope.thread, scope.begin * 1000.0, (scope.end - scope.begin) * 1000.0);
+			json += buffer;
+		}
+		lock.unlock();
+
+		json += "\n]}\n";
+
+		stringstream ss("");
+		if (wiHelper::FileWrite(capture.filename, (const uint8_t*)json.data(), json.size()))
+		{
+			ss << "[wiProfiler] Capture saved: " << capture.filename << " (" << capture.scopes.size() << " ranges)";
+			wiBackLog::post(ss.str().c_str());
+		}
+		else
+		{
+			ss << "[wiProfiler] Failed to save capture: " << capture.filename;
+			wiBackLog::post(ss.str().c_str(), wiBackLog::LEVEL_ERROR);
+		}
+		capture.scopes.clear();
+		capture.scopes.shrink_to_fit();
+	}
 
 	void BeginFrame()
 	{
@@ -55,9 +285,15 @@ namespace wiProfiler
 			GPUQueryDesc desc;
 			desc.Type = GPU_QUERY_TYPE_TIMESTAMP_DISJOINT;
 			disjoint.Create(wiRenderer::GetDevice(), &desc);
+
+			if (threadName.empty())
+			{
+				SetThreadName("Main Thread");
+			}
 		}
 
 		CommandList cmd = wiRenderer::GetDevice()->BeginCommandList(); // it would be a good idea to not start a new command list just for these couple of queries!
+		cpuFrameBegin[disjoint.id] = wiTimer::TotalTime();
 		wiRenderer::GetDevice()->QueryBegin(disjoint.Get_GPU(), cmd);
 		wiRenderer::GetDevice()->QueryEnd(disjoint.Get_GPU(), cmd); // this should be at the end of frame, but the problem is that there will be other command lists submitted in between and it doesn't work that way in DX11
 
@@ -74,44 +310,161 @@ namespace wiProfiler
 
 		EndRange(cpu_frame);
 
+		lock.lock();
+		const bool capturing = capture.remaining > 0;
+		lock.unlock();
+
+		// GPU ranges:
 		GPUQueryResult disjoint_result;
 		GPUQuery* disjoint_query = disjoint.Get_CPU();
+		const double frameBegin = cpuFrameBegin[disjoint.id];
 		if (disjoint_query != nullptr)
 		{
 			while (!wiRenderer::GetDevice()->QueryRead(disjoint_query, &disjoint_result));
 		}
 
+		auto read_range = [&](Range& range, uint64_t& begin, uint64_t& end) {
+			GPUQuery* begin_query = range.gpuBegin.Get_CPU();
+			GPUQuery* end_query = range.gpuEnd.Get_CPU();
+			if (disjoint_query == nullptr || begin_query == nullptr || end_query == nullptr || disjoint_result.result_timestamp_frequency == 0)
+			{
+				return false;
+			}
+			GPUQueryResult begin_result, end_result;
+			while (!wiRenderer::GetDevice()->QueryRead(begin_query, &begin_result));
+			while (!wiRenderer::GetDevice()->QueryRead(end_query, &end_result));
+			begin = begin_result.result_timestamp;
+			end = end_result.result_timestamp;
+			return true;
+		};
+		auto add_sample = [](auto& range) {
+			range.times[range.avg_counter++ % arraysize(range.times)] = range.time;
+
+			if (range.avg_counter > arraysize(range.times))
+			{
+				float avg_time = 0;
+				for (int i = 0; i < arraysize(range.times); ++i)
+				{
+					avg_time += range.times[i];
+				}
+				range.time = avg_time / arraysize(range.times);
+			}
+		};
+
+		// The GPU frame is read first, other GPU ranges are placed on the CPU timeline relative to it
+		uint64_t frameBeginTimestamp = 0;
+		uint64_t frameEndTimestamp = 0;
+		const bool frameValid = read_range(ranges[gpu_frame], frameBeginTimestamp, frameEndTimestamp);
+		const double frequency = frameValid ? (double)disjoint_result.result_timestamp_frequency / 1000.0 : 1; // ticks per millisecond
 		for (auto& x : ranges)
 		{
 			auto& range = x.second;
+			uint64_t begin = frameBeginTimestamp;
+			uint64_t end = frameEndTimestamp;
+			const bool valid = x.first == gpu_frame ? frameValid : read_range(range, begin, end);
 
 			range.time = 0;
-			if (range.IsCPURange())
+			if (valid)
 			{
-				range.time = (float)abs(range.cpuEnd.elapsed() - range.cpuBegin.elapsed());
-			}
-			else
-			{
-				GPUQuery* begin_query = range.gpuBegin.Get_CPU();
-				GPUQuery* end_query = range.gpuEnd.Get_CPU();
-				GPUQueryResult begin_result, end_result;
-				if (begin_query != nullptr && end_query != nullptr)
+				range.time = abs((float)((double)(int64_t)(end - begin) / frequency));
+				if (capturing)
 				{
-					while (!wiRenderer::GetDevice()->QueryRead(begin_query, &begin_result));
-					while (!wiRenderer::GetDevice()->QueryRead(end_query, &end_result));
+					Scope scope;
+					scope.id = x.first;
+					scope.thread = GPU_THREAD;
+					scope.begin = frameBegin + (double)(int64_t)(begin - frameBeginTimestamp) / frequency;
+					scope.end = frameBegin + (double)(int64_t)(end - frameBeginTimestamp) / frequency;
+					scope.gpuName = range.name;
+					capture.scopes.push_back(std::move(scope));
 				}
-				range.time = abs((float)(end_result.result_timestamp - begin_result.result_timestamp) / disjoint_result.result_timestamp_frequency * 1000.0f);
 			}
-			range.times[range.avg_counter++ % arraysize(range.times)] = range.time;
+			add_sample(range);
+		}
 
-			if (range.avg_counter > arraysize(range.times))
+		// CPU ranges:
+		for (auto& x : cpuStats)
+		{
+			x.second.frameTime = 0;
+			x.second.frameCount = 0;
+		}
+		droppedEvents = 0;
+		const uint32_t count = std::min(threadCount.load(), MAX_THREADS);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			ThreadData* data = threads[i].load();
+			if (data == nullptr)
+				continue;
+
+			droppedEvents += data->dropped.exchange(0);
+			const uint32_t head = data->head.load(std::memory_order_acquire);
+			for (uint32_t j = data->tail.load(std::memory_order_relaxed); j != head; ++j)
 			{
-				float avg_time = 0;
-				for (int i = 0; i < arraysize(range.times); ++i)
+				const Event& event = data->events[j % EVENT_COUNT];
+				if ((event.id & 1) == 0)
 				{
-					avg_time += range.times[i];
+					data->stack.push_back({ event.id, event.time });
+					continue;
+				}
+
+				// Find the matching begin, ranges that are left open inside it are discarded:
+				const range_id id = event.id & ~range_id(1);
+				for (size_t k = data->stack.size(); k > 0; --k)
+				{
+					if (data->stack[k - 1].id == id)
+					{
+						const double begin = data->stack[k - 1].time;
+						const uint32_t depth = (uint32_t)(k - 1);
+						data->stack.resize(k - 1);
+
+						CPUStats& stats = cpuStats[id];
+						if (stats.frameCount == 0 || begin < stats.firstBegin)
+						{
+							stats.firstBegin = begin;
+						}
+						stats.frameTime += event.time - begin;
+						stats.frameCount++;
+						stats.depth = stats.frameCount == 1 ? depth : std::min(stats.depth, depth);
+
+						if (capturing)
+						{
+							Scope scope;
+							scope.id = id;
+							scope.thread = data->index;
+							scope.begin = begin;
+							scope.end = event.time;
+							capture.scopes.push_back(std::move(scope));
+						}
+						break;
+					}
 				}
-				range.time = avg_time / arraysize(range.times);
+			}
+			data->tail.store(head, std::memory_order_release);
+
+			if (data->exited.load() && data->head.load() == head && !data->available.load())
+			{
+				data->stack.clear();
+				data->available.store(true);
+			}
+		}
+		for (auto& x : cpuStats)
+		{
+			CPUStats& stats = x.second;
+			if (stats.frameCount > 0)
+			{
+				stats.time = (float)stats.frameTime;
+				stats.count = stats.frameCount;
+				add_sample(stats);
+			}
+		}
+
+		if (capturing)
+		{
+			lock.lock();
+			const bool finished = --capture.remaining == 0;
+			lock.unlock();
+			if (finished)
+			{
+				WriteCapture();
 			}
 		}
 	}
@@ -121,24 +474,25 @@ namespace wiProfiler
 		if (!ENABLED || !initialized)
 			return 0;
 
-		range_id id = wiHelper::string_hash(name);
+		ThreadData* data = GetThreadData();
+		if (data == nullptr)
+			return 0;
 
-		lock.lock();
-		if (ranges.find(id) == ranges.end())
+		range_id id = GetCPURangeID(name);
+		if (data->registered.insert(id).second)
 		{
-			Range range;
-			range.name = name;
-			range.time = 0;
-
-			range.cpuBegin.Start();
-			range.cpuEnd.Start();
-
-			ranges.insert(make_pair(id, range));
+			lock.lock();
+			names.emplace(id, name);
+			lock.unlock();
 		}
 
-		ranges[id].cpuBegin.record();
+		if (data->openCount < arraysize(data->open))
+		{
+			data->open[data->openCount] = id;
+		}
+		data->openCount++;
 
-		lock.unlock();
+		RecordEvent(*data, wiTimer::TotalTime(), id);
 
 		return id;
 	}
@@ -147,7 +501,7 @@ namespace wiProfiler
 		if (!ENABLED || !initialized)
 			return 0;
 
-		range_id id = wiHelper::string_hash(name);
+		range_id id = GetGPURangeID(name);
 
 		lock.lock();
 		if (ranges.find(id) == ranges.end())
@@ -173,22 +527,28 @@ namespace wiProfiler
 	}
 	void EndRange(range_id id)
 	{
-		if (!ENABLED || !initialized)
+		if (!ENABLED || !initialized || id == 0)
+			return;
+
+		if ((id & 1) == 0)
+		{
+			ThreadData* data = GetThreadData();
+			if (data == nullptr)
+				return;
+			if (data->openCount > 0)
+			{
+				data->openCount--;
+			}
+			RecordEvent(*data, wiTimer::TotalTime(), id | 1);
 			return;
+		}
 
 		lock.lock();
 
 		auto it = ranges.find(id);
 		if (it != ranges.end())
 		{
-			if (it->second.IsCPURange())
-			{
-				it->second.cpuEnd.record();
-			}
-			else
-			{
-				wiRenderer::GetDevice()->QueryEnd(it->second.gpuEnd.Get_GPU(), it->second.cmd);
-			}
+			wiRenderer::GetDevice()->QueryEnd(it->second.gpuEnd.Get_GPU(), it->second.cmd);
 		}
 		else
 		{
@@ -198,6 +558,59 @@ namespace wiProfiler
 		lock.unlock();
 	}
 
+	const char* GetJobRangeName()
+	{
+		if (!ENABLED || !initialized)
+			return nullptr;
+
+		ThreadData* data = GetThreadData();
+		if (data == nullptr)
+			return nullptr;
+
+		const range_id parent = data->openCount > 0 && data->openCount <= arraysize(data->open) ? data->open[data->openCount - 1] : 0;
+		auto it = data->jobNames.find(parent);
+		if (it != data->jobNames.end())
+		{
+			return it->second;
+		}
+
+		lock.lock();
+		std::string name = parent == 0 ? "wiJobSystem" : (names[parent] + " (job)");
+		const range_id id = GetCPURangeID(name.c_str());
+		const char* result = names.emplace(id, name).first->second.c_str();
+		lock.unlock();
+
+		data->jobNames[parent] = result;
+		return result;
+	}
+
+	void SetThreadName(const char* name)
+	{
+		threadName = name;
+		if (threadData.data != nullptr)
+		{
+			lock.lock();
+			threadData.data->name = name;
+			lock.unlock();
+		}
+	}
+
+	void Capture(uint32_t frameCount, const std::string& filename)
+	{
+		lock.lock();
+		capture.remaining = frameCount;
+		capture.filename = filename;
+		lock.unlock();
+	}
+
+	bool IsCapturing()
+	{
+		lock.lock();
+		bool result = capture.remaining > 0;
+		lock.unlock();
+		return result;
+	}
+
 	void DrawData(float x, float y, CommandList cmd)
 	{
 		if (!ENABLED || !initialized)
@@ -207,23 +620,42 @@ namespace wiProfiler
 		ss.precision(2);
 		ss << "Frame Profiler Ranges:" << endl << "----------------------------" << endl;
 
-		// Print CPU ranges:
-		for (auto& x : ranges)
+		// Print CPU ranges in the order they started, nested ranges are indented:
+		std::vector<std::pair<range_id, const CPUStats*>> sorted;
+		sorted.reserve(cpuStats.size());
+		for (auto& x : cpuStats)
+		{
+			sorted.push_back(make_pair(x.first, &x.second));
+		}
+		std::sort(sorted.begin(), sorted.end(), [](const std::pair<range_id, const CPUStats*>& a, const std::pair<range_id, const CPUStats*>& b) {
+			return a.second->firstBegin < b.second->firstBegin;
+		});
+		lock.lock();
+		for (auto& x : sorted)
 		{
-			if (x.second.IsCPURange())
+			const CPUStats& stats = *x.second;
+			for (uint32_t i = 0; i < std::min(stats.depth, 8u); ++i)
 			{
-				ss << x.second.name << ": " << fixed << x.second.time << " ms" << endl;
+				ss << "  ";
 			}
+			ss << names[x.first] << ": " << fixed << stats.time << " ms";
+			if (stats.count > 1)
+			{
+				ss << " (" << stats.count << "x)";
+			}
+			ss << endl;
+		}
+		lock.unlock();
+		if (droppedEvents > 0)
+		{
+			ss << "Dropped events: " << droppedEvents << endl;
 		}
 		ss << endl;
 
 		// Print GPU ranges:
 		for (auto& x : ranges)
 		{
-			if (!x.second.IsCPURange())
-			{
-				ss << x.second.name << ": " << fixed << x.second.time << " ms" << endl;
-			}
+			ss << x.second.name << ": " << fixed << x.second.time << " ms" << endl;
 		}
 
 		wiFontParams params = wiFontParams(x, y, WIFONTSIZE_DEFAULT - 4, WIFALIGN_LEFT, WIFALIGN_TOP, wiColor(255, 255, 255, 255), wiColor(0, 0, 0, 255));
@@ -245,7 +677,21 @@ namespace wiProfiler
 		{
 			initialized = false;
 			ranges.clear();
+			cpuStats.clear();
 			ENABLED = value;
+
+			// Events that were recorded before are discarded:
+			epoch.fetch_add(1);
+			const uint32_t count = std::min(threadCount.load(), MAX_THREADS);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				ThreadData* data = threads[i].load();
+				if (data != nullptr)
+				{
+					data->tail.store(data->head.load());
+					data->stack.clear();
+				}
+			}
 		}
 	}
 
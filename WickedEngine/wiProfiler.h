@@ -3,6 +3,10 @@
 
 #include <string>
 
+// Frame profiler for CPU and GPU ranges
+//	CPU ranges are recorded into lock-free event buffers of the calling threads, so ranges can be nested and used from any thread.
+//	Jobs of wiJobSystem are recorded automatically, named after the range that was open on the thread that issued them.
+//	A capture of multiple frames can be exported in the Chrome trace format, where GPU ranges are shown on the CPU timeline, aligned to the start of their frame
 namespace wiProfiler
 {
 	typedef size_t range_id;
@@ -13,7 +17,7 @@ namespace wiProfiler
 	// Finalize collecting profiling data for the current frame
 	void EndFrame(wiGraphics::CommandList cmd);
 
-	// Start a CPU profiling range
+	// Start a CPU profiling range. It must be ended on the same thread
 	range_id BeginRangeCPU(const char* name);
 
 	// Start a GPU profiling range
@@ -22,6 +26,26 @@ namespace wiProfiler
 	// End a profiling range
 	void EndRange(range_id id);
 
+	// Begins a CPU range in the constructor and ends it in the destructor
+	class ScopedRangeCPU
+	{
+		range_id id;
+	public:
+		ScopedRangeCPU(const char* name) : id(BeginRangeCPU(name)) {}
+		~ScopedRangeCPU() { EndRange(id); }
+	};
+
+	// Returns the range name for jobs that are issued from the calling thread: the name of the innermost open CPU range, or nullptr if profiling is disabled
+	const char* GetJobRangeName();
+
+	// Name of the calling thread in the captures
+	void SetThreadName(const char* name);
+
+	// Record every range of the next frameCount frames, then write them to a Chrome trace JSON file (open it with chrome://tracing or ui.perfetto.dev)
+	void Capture(uint32_t frameCount, const std::string& filename);
+
+	bool IsCapturing();
+
 	// Renders a basic text of the Profiling results to the (x,y) screen coordinate
 	void DrawData(float x, float y, wiGraphics::CommandList cmd);
 
@@ -30,4 +54,3 @@ namespace wiProfiler
 
 	bool IsEnabled();
 };
-
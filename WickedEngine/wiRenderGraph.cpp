@@ -0,0 +1,500 @@
+#include "wiRenderGraph.h"
+#include "wiRenderer.h"
+#include "wiBackLog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+using namespace wiGraphics;
+
+namespace wiRenderGraph_Internal
+{
+	// Transient textures can share a physical texture if they only differ in their bind flags
+	bool IsCompatible(const TextureDesc& a, const TextureDesc& b)
+	{
+		return
+			a.type == b.type &&
+			a.Width == b.Width &&
+			a.Height == b.Height &&
+			a.Depth == b.Depth &&
+			a.ArraySize == b.ArraySize &&
+			a.MipLevels == b.MipLevels &&
+			a.Format == b.Format &&
+			a.SampleCount == b.SampleCount &&
+			a.Usage == b.Usage &&
+			a.CPUAccessFlags == b.CPUAccessFlags &&
+			a.MiscFlags == b.MiscFlags &&
+			a.layout == b.layout &&
+			std::memcmp(&a.clear, &b.clear, sizeof(ClearValue)) == 0;
+	}
+	bool IsEqual(const TextureDesc& a, const TextureDesc& b)
+	{
+		return IsCompatible(a, b) && a.BindFlags == b.BindFlags;
+	}
+	size_t GetTextureMemory(const GraphicsDevice* device, const TextureDesc& desc)
+	{
+		size_t size = 0;
+		uint32_t width = desc.Width;
+		uint32_t height = std::max(1u, desc.Height);
+		uint32_t depth = std::max(1u, desc.Depth);
+		for (uint32_t mip = 0; mip < std::max(1u, desc.MipLevels); ++mip)
+		{
+			size += (size_t)width * height * depth;
+			width = std::max(1u, width / 2);
+			height = std::max(1u, height / 2);
+			depth = std::max(1u, depth / 2);
+		}
+		return size * desc.ArraySize * desc.SampleCount * device->GetFormatStride(desc.Format);
+	}
+	const char* GetLayoutName(IMAGE_LAYOUT layout)
+	{
+		switch (layout)
+		{
+		case IMAGE_LAYOUT_UNDEFINED: return "UNDEFINED";
+		case IMAGE_LAYOUT_GENERAL: return "GENERAL";
+		case IMAGE_LAYOUT_RENDERTARGET: return "RENDERTARGET";
+		case IMAGE_LAYOUT_DEPTHSTENCIL: return "DEPTHSTENCIL";
+		case IMAGE_LAYOUT_DEPTHSTENCIL_READONLY: return "DEPTHSTENCIL_READONLY";
+		case IMAGE_LAYOUT_SHADER_RESOURCE: return "SHADER_RESOURCE";
+		case IMAGE_LAYOUT_UNORDERED_ACCESS: return "UNORDERED_ACCESS";
+		case IMAGE_LAYOUT_COPY_SRC: return "COPY_SRC";
+		case IMAGE_LAYOUT_COPY_DST: return "COPY_DST";
+		}
+		return "";
+	}
+}
+using namespace wiRenderGraph_Internal;
+
+wiRenderGraph::PassBuilder& wiRenderGraph::PassBuilder::Read(ResourceHandle resource, IMAGE_LAYOUT layout)
+{
+	graph->passes[pass].accesses.push_back({ resource, layout, false });
+	return *this;
+}
+wiRenderGraph::PassBuilder& wiRenderGraph::PassBuilder::Write(ResourceHandle resource, IMAGE_LAYOUT layout)
+{
+	graph->passes[pass].accesses.push_back({ resource, layout, true });
+	return *this;
+}
+wiRenderGraph::PassBuilder& wiRenderGraph::PassBuilder::SideEffect()
+{
+	graph->passes[pass].side_effect = true;
+	return *this;
+}
+
+void wiRenderGraph::Reset()
+{
+	passes.clear();
+	resources.clear();
+	final_barriers.clear();
+}
+
+wiRenderGraph::ResourceHandle wiRenderGraph::CreateTexture(const std::string& name, const TextureDesc& desc)
+{
+	Resource resource;
+	resource.name = name;
+	resource.desc = desc;
+	resources.push_back(resource);
+	return (ResourceHandle)resources.size() - 1;
+}
+wiRenderGraph::ResourceHandle wiRenderGraph::ImportTexture(const std::string& name, const Texture* texture, IMAGE_LAYOUT layout_before, IMAGE_LAYOUT layout_after)
+{
+	Resource resource;
+	resource.name = name;
+	resource.desc = texture->GetDesc();
+	resource.imported = texture;
+	resource.layout_before = layout_before;
+	resource.layout_after = layout_after;
+	resources.push_back(resource);
+	return (ResourceHandle)resources.size() - 1;
+}
+void wiRenderGraph::ExportTexture(ResourceHandle resource)
+{
+	resources[resource].exported = true;
+}
+
+wiRenderGraph::PassBuilder wiRenderGraph::AddPass(const std::string& name, ExecuteFunc execute)
+{
+	Pass pass;
+	pass.name = name;
+	pass.execute = execute;
+	passes.push_back(pass);
+	return PassBuilder(this, (uint32_t)passes.size() - 1);
+}
+
+bool wiRenderGraph::Compile()
+{
+	final_barriers.clear();
+	for (auto& resource : resources)
+	{
+		resource.first_use = ~0u;
+		resource.last_use = 0;
+		resource.physical = INVALID_RESOURCE;
+	}
+
+	// Validate and merge the accesses of the same resource within a pass:
+	for (auto& pass : passes)
+	{
+		pass.culled = false;
+		pass.barriers.clear();
+
+		std::vector<Access> merged;
+		for (auto& access : pass.accesses)
+		{
+			if (access.resource >= resources.size())
+			{
+				wiBackLog::post(("wiRenderGraph: invalid resource in pass " + pass.name).c_str());
+				return false;
+			}
+			auto it = std::find_if(merged.begin(), merged.end(), [&](const Access& x) { return x.resource == access.resource; });
+			if (it == merged.end())
+			{
+				merged.push_back(access);
+			}
+			else if (it->layout != access.layout)
+			{
+				wiBackLog::post(("wiRenderGraph: " + resources[access.resource].name + " is used in different layouts in pass " + pass.name).c_str());
+				return false;
+			}
+			else
+			{
+				it->write |= access.write;
+			}
+		}
+		pass.accesses = merged;
+	}
+
+	// Cull the passes whose results are not needed, walking backwards from the outputs:
+	std::vector<bool> needed(resources.size(), false);
+	for (size_t i = 0; i < resources.size(); ++i)
+	{
+		needed[i] = resources[i].imported != nullptr || resources[i].exported;
+	}
+	for (size_t i = passes.size(); i > 0; --i)
+	{
+		Pass& pass = passes[i - 1];
+		bool alive = pass.side_effect || pass.accesses.empty();
+		for (auto& access : pass.accesses)
+		{
+			alive |= access.write && needed[access.resource];
+		}
+		pass.culled = !alive;
+		if (alive)
+		{
+			for (auto& access : pass.accesses)
+			{
+				if (!access.write)
+				{
+					needed[access.resource] = true;
+				}
+			}
+		}
+	}
+
+	// Lifetimes:
+	for (uint32_t i = 0; i < (uint32_t)passes.size(); ++i)
+	{
+		if (passes[i].culled)
+			continue;
+		for (auto& access : passes[i].accesses)
+		{
+			Resource& resource = resources[access.resource];
+			if (resource.first_use == ~0u)
+			{
+				if (!access.write && resource.imported == nullptr)
+				{
+					wiBackLog::post(("wiRenderGraph: " + resource.name + " is read before it is written in pass " + passes[i].name).c_str());
+					return false;
+				}
+				resource.first_use = i;
+			}
+			resource.last_use = i;
+		}
+	}
+	for (auto& resource : resources)
+	{
+		if (resource.exported && resource.first_use != ~0u)
+		{
+			resource.last_use = (uint32_t)passes.size();
+		}
+	}
+
+	// Aliasing: transient textures are assigned in the order of their first use to the first compatible physical texture that is free by then
+	std::vector<ResourceHandle> order;
+	for (ResourceHandle i = 0; i < (ResourceHandle)resources.size(); ++i)
+	{
+		if (resources[i].imported == nullptr && resources[i].first_use != ~0u)
+		{
+			order.push_back(i);
+		}
+	}
+	std::stable_sort(order.begin(), order.end(), [&](ResourceHandle a, ResourceHandle b) {
+		return resources[a].first_use < resources[b].first_use;
+	});
+
+	std::vector<Physical> previous = std::move(physicals);
+	physicals.clear();
+	for (ResourceHandle handle : order)
+	{
+		Resource& resource = resources[handle];
+		for (uint32_t i = 0; i < (uint32_t)physicals.size(); ++i)
+		{
+			Physical& physical = physicals[i];
+			if (physical.last_use < resource.first_use && IsCompatible(physical.texture.desc, resource.desc))
+			{
+				resource.physical = i;
+				physical.texture.desc.BindFlags |= resource.desc.BindFlags;
+				physical.name += " | " + resource.name;
+				physical.last_use = resource.last_use;
+				break;
+			}
+		}
+		if (resource.physical == INVALID_RESOURCE)
+		{
+			resource.physical = (uint32_t)physicals.size();
+			Physical physical;
+			physical.texture.desc = resource.desc;
+			physical.name = resource.name;
+			physical.last_use = resource.last_use;
+			physicals.push_back(physical);
+		}
+	}
+
+	// Keep the textures of the previous compile that can be used as they are:
+	for (auto& physical : physicals)
+	{
+		for (auto& x : previous)
+		{
+			if (x.texture.IsValid() && IsEqual(x.created_desc, physical.texture.desc))
+			{
+				physical.texture = x.texture;
+				physical.created_desc = x.created_desc;
+				x.texture.internal_state.reset();
+				break;
+			}
+		}
+	}
+
+	// Barriers: the current layout is tracked per texture, so the first use of an aliased resource transitions from the layout of the previous owner
+	struct State
+	{
+		const Texture* texture;
+		IMAGE_LAYOUT layout;
+		IMAGE_LAYOUT resting;
+		bool written;
+	};
+	std::vector<State> states;
+	auto get_state = [&](ResourceHandle handle) -> State& {
+		const Resource& resource = resources[handle];
+		const Texture* texture = &GetTexture(handle);
+		for (auto& state : states)
+		{
+			if (state.texture == texture)
+				return state;
+		}
+		State state;
+		state.texture = texture;
+		state.layout = resource.imported != nullptr ? resource.layout_before : resource.desc.layout;
+		state.resting = resource.imported != nullptr ? resource.layout_after : resource.desc.layout;
+		state.written = false;
+		states.push_back(state);
+		return states.back();
+	};
+	for (auto& pass : passes)
+	{
+		if (pass.culled)
+			continue;
+		for (auto& access : pass.accesses)
+		{
+			State& state = get_state(access.resource);
+			if (state.layout != access.layout)
+			{
+				pass.barriers.push_back(GPUBarrier::Image(state.texture, state.layout, access.layout));
+				state.layout = access.layout;
+			}
+			else if (access.layout == IMAGE_LAYOUT_UNORDERED_ACCESS && (state.written || access.write))
+			{
+				// Unordered access after unordered access, without a layout change
+				pass.barriers.push_back(GPUBarrier::Memory(state.texture));
+			}
+			state.written = access.write;
+		}
+	}
+	for (auto& state : states)
+	{
+		if (state.layout != state.resting)
+		{
+			final_barriers.push_back(GPUBarrier::Image(state.texture, state.layout, state.resting));
+		}
+	}
+
+	return true;
+}
+
+void wiRenderGraph::Allocate(GraphicsDevice* device)
+{
+	for (auto& physical : physicals)
+	{
+		if (!physical.texture.IsValid())
+		{
+			TextureDesc desc = physical.texture.desc;
+			device->CreateTexture(&desc, nullptr, &physical.texture);
+			physical.created_desc = desc;
+
+			// Mip chains are processed one mip at a time, so the subresource index of a mip is the mip level
+			if (desc.MipLevels > 1)
+			{
+				for (uint32_t i = 0; i < desc.MipLevels; ++i)
+				{
+					int subresource_index;
+					if (desc.BindFlags & BIND_SHADER_RESOURCE)
+					{
+						subresource_index = device->CreateSubresource(&physical.texture, SRV, 0, 1, i, 1);
+						assert(subresource_index == i);
+					}
+					if (desc.BindFlags & BIND_UNORDERED_ACCESS)
+					{
+						subresource_index = device->CreateSubresource(&physical.texture, UAV, 0, 1, i, 1);
+						assert(subresource_index == i);
+					}
+				}
+			}
+		}
+		device->SetName(&physical.texture, physical.name.c_str());
+	}
+}
+
+void wiRenderGraph::Execute(CommandList cmd) const
+{
+	GraphicsDevice* device = wiRenderer::GetDevice();
+
+	for (auto& pass : passes)
+	{
+		if (pass.culled)
+			continue;
+
+		if (!pass.barriers.empty())
+		{
+			device->Barrier(pass.barriers.data(), (uint32_t)pass.barriers.size(), cmd);
+		}
+
+		if (pass.execute != nullptr)
+		{
+			device->EventBegin(pass.name.c_str(), cmd);
+			pass.execute(*this, cmd);
+			device->EventEnd(cmd);
+		}
+	}
+
+	if (!final_barriers.empty())
+	{
+		device->Barrier(final_barriers.data(), (uint32_t)final_barriers.size(), cmd);
+	}
+}
+
+const Texture& wiRenderGraph::GetTexture(ResourceHandle resource) const
+{
+	static const Texture empty;
+	if (resource >= resources.size())
+	{
+		return empty;
+	}
+	const Resource& x = resources[resource];
+	if (x.imported != nullptr)
+	{
+		return *x.imported;
+	}
+	if (x.physical >= physicals.size())
+	{
+		return empty;
+	}
+	return physicals[x.physical].texture;
+}
+uint32_t wiRenderGraph::GetPhysicalIndex(ResourceHandle resource) const
+{
+	return resource < resources.size() ? resources[resource].physical : INVALID_RESOURCE;
+}
+bool wiRenderGraph::IsAccessDeclared(uint32_t pass, ResourceHandle resource, bool write) const
+{
+	if (pass >= passes.size() || passes[pass].culled)
+	{
+		return false;
+	}
+	for (auto& access : passes[pass].accesses)
+	{
+		if (access.resource == resource && (access.write || !write))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t wiRenderGraph::GetTransientMemory(const GraphicsDevice* device, bool aliased) const
+{
+	size_t size = 0;
+	if (aliased)
+	{
+		for (auto& physical : physicals)
+		{
+			size += GetTextureMemory(device, physical.texture.desc);
+		}
+	}
+	else
+	{
+		for (auto& resource : resources)
+		{
+			if (resource.imported == nullptr && resource.physical != INVALID_RESOURCE)
+			{
+				size += GetTextureMemory(device, resource.desc);
+			}
+		}
+	}
+	return size;
+}
+
+std::string wiRenderGraph::GetStatistics() const
+{
+	std::stringstream ss;
+	ss << "Passes:" << std::endl;
+	for (uint32_t i = 0; i < (uint32_t)passes.size(); ++i)
+	{
+		const Pass& pass = passes[i];
+		ss << "  " << i << ": " << pass.name << (pass.culled ? " (culled)" : "") << std::endl;
+		for (auto& barrier : pass.barriers)
+		{
+			if (barrier.type == GPUBarrier::IMAGE_BARRIER)
+			{
+				ss << "      barrier: " << GetLayoutName(barrier.image.layout_before) << " -> " << GetLayoutName(barrier.image.layout_after) << std::endl;
+			}
+			else
+			{
+				ss << "      barrier: UNORDERED_ACCESS" << std::endl;
+			}
+		}
+	}
+	ss << "Resources:" << std::endl;
+	for (auto& resource : resources)
+	{
+		ss << "  " << resource.name;
+		if (resource.imported != nullptr)
+		{
+			ss << " (imported)";
+		}
+		else if (resource.physical == INVALID_RESOURCE)
+		{
+			ss << " (unused)";
+		}
+		else
+		{
+			ss << ": passes " << resource.first_use << " - " << resource.last_use << ", physical " << resource.physical;
+		}
+		ss << std::endl;
+	}
+	ss << "Physical textures:" << std::endl;
+	for (uint32_t i = 0; i < (uint32_t)physicals.size(); ++i)
+	{
+		ss << "  " << i << ": " << physicals[i].name << std::endl;
+	}
+	return ss.str();
+}
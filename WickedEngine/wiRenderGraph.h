@@ -0,0 +1,118 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiGraphicsDevice.h"
+
+#include <string>
+#include <vector>
+#include <functional>
+
+// Frame graph of render passes that declare which textures they read and write
+//	Compile() is CPU only: it culls the passes that don't contribute to the outputs, computes the lifetime of every transient texture,
+//	aliases transient textures with compatible descriptions and non-overlapping lifetimes onto the same physical texture,
+//	and derives the layout transition barriers between the passes.
+//	Allocate() creates the physical textures with the graphics device, they are kept while the compiled descriptions don't change.
+class wiRenderGraph
+{
+public:
+	typedef uint32_t ResourceHandle;
+	static const ResourceHandle INVALID_RESOURCE = ~0u;
+
+	typedef std::function<void(const wiRenderGraph& graph, wiGraphics::CommandList cmd)> ExecuteFunc;
+
+	// Declares the resource usage of a pass, returned by AddPass()
+	class PassBuilder
+	{
+		friend class wiRenderGraph;
+		wiRenderGraph* graph;
+		uint32_t pass;
+		PassBuilder(wiRenderGraph* graph, uint32_t pass) : graph(graph), pass(pass) {}
+	public:
+		PassBuilder& Read(ResourceHandle resource, wiGraphics::IMAGE_LAYOUT layout = wiGraphics::IMAGE_LAYOUT_SHADER_RESOURCE);
+		PassBuilder& Write(ResourceHandle resource, wiGraphics::IMAGE_LAYOUT layout = wiGraphics::IMAGE_LAYOUT_RENDERTARGET);
+		// The pass is never culled, even if nothing reads its results
+		PassBuilder& SideEffect();
+	};
+
+	// Removes every pass and resource declaration. The physical textures are kept for reuse
+	void Reset();
+
+	// Declares a texture that only lives within the frame. Its contents are undefined before the first write
+	ResourceHandle CreateTexture(const std::string& name, const wiGraphics::TextureDesc& desc);
+	// Declares a texture that is owned outside of the graph. It is expected in layout_before and left in layout_after
+	ResourceHandle ImportTexture(const std::string& name, const wiGraphics::Texture* texture, wiGraphics::IMAGE_LAYOUT layout_before, wiGraphics::IMAGE_LAYOUT layout_after);
+	// The transient texture is read after the graph (for example by the composition), so it lives until the end of the frame
+	void ExportTexture(ResourceHandle resource);
+
+	// Adds a pass, passes are executed in the order they were added
+	PassBuilder AddPass(const std::string& name, ExecuteFunc execute = nullptr);
+
+	// Computes culling, lifetimes, aliasing and barriers. Returns false if the declarations are invalid (the reason is posted to the backlog)
+	bool Compile();
+	// Creates the physical textures of the last compile that are not yet created
+	//	Textures with a mip chain also get a SRV and UAV subresource for every mip (subresource index == mip level)
+	void Allocate(wiGraphics::GraphicsDevice* device);
+	// Executes the compiled passes with the derived barriers
+	void Execute(wiGraphics::CommandList cmd) const;
+
+	// Texture that a resource refers to. For transient resources, this is the physical texture that it is aliased to
+	const wiGraphics::Texture& GetTexture(ResourceHandle resource) const;
+	// Index of the physical texture of a transient resource, or INVALID_RESOURCE if it was culled or is imported
+	uint32_t GetPhysicalIndex(ResourceHandle resource) const;
+	uint32_t GetPhysicalCount() const { return (uint32_t)physicals.size(); }
+
+	uint32_t GetPassCount() const { return (uint32_t)passes.size(); }
+	bool IsPassCulled(uint32_t pass) const { return passes[pass].culled; }
+	// Debug check for passes that are recorded by the caller instead of Execute(): true if the pass is not culled and declares the access
+	//	A transient texture must not be accessed outside of its declared passes, because an other resource can be aliased to it at that time
+	bool IsAccessDeclared(uint32_t pass, ResourceHandle resource, bool write) const;
+	// Barriers that are issued before the pass
+	const std::vector<wiGraphics::GPUBarrier>& GetBarriers(uint32_t pass) const { return passes[pass].barriers; }
+	// Barriers that are issued after the last pass, they return every texture to its resting layout
+	const std::vector<wiGraphics::GPUBarrier>& GetFinalBarriers() const { return final_barriers; }
+
+	// Memory of the transient textures in bytes, with and without aliasing
+	size_t GetTransientMemory(const wiGraphics::GraphicsDevice* device, bool aliased = true) const;
+
+	// Lists the passes, resource lifetimes and physical textures of the last compile
+	std::string GetStatistics() const;
+
+private:
+	struct Access
+	{
+		ResourceHandle resource;
+		wiGraphics::IMAGE_LAYOUT layout;
+		bool write;
+	};
+	struct Pass
+	{
+		std::string name;
+		ExecuteFunc execute;
+		std::vector<Access> accesses;
+		bool side_effect = false;
+		bool culled = false;
+		std::vector<wiGraphics::GPUBarrier> barriers;
+	};
+	struct Resource
+	{
+		std::string name;
+		wiGraphics::TextureDesc desc;
+		const wiGraphics::Texture* imported = nullptr;
+		wiGraphics::IMAGE_LAYOUT layout_before = wiGraphics::IMAGE_LAYOUT_GENERAL;
+		wiGraphics::IMAGE_LAYOUT layout_after = wiGraphics::IMAGE_LAYOUT_GENERAL;
+		bool exported = false;
+		uint32_t first_use = ~0u;
+		uint32_t last_use = 0;
+		uint32_t physical = INVALID_RESOURCE;
+	};
+	struct Physical
+	{
+		wiGraphics::Texture texture;
+		wiGraphics::TextureDesc created_desc; // description that the texture was created with
+		std::string name;
+		uint32_t last_use = 0;
+	};
+	std::vector<Pass> passes;
+	std::vector<Resource> resources;
+	std::vector<Physical> physicals;
+	std::vector<wiGraphics::GPUBarrier> final_barriers;
+};
@@ -22,11 +22,13 @@
 #include "ShaderInterop_Utility.h"
 #include "ShaderInterop_Paint.h"
 #include "wiWidget.h"
+#include "wiGUIBatch.h"
 #include "wiGPUSortLib.h"
 #include "wiAllocators.h"
 #include "wiGPUBVH.h"
 #include "wiJobSystem.h"
 #include "wiSpinLock.h"
+#include "wiShaderCache.h"
 
 #include <algorithm>
 #include <unordered_set>
@@ -147,6 +149,8 @@ struct VoxelizedSceneData
 } voxelSceneData;
 
 std::unique_ptr<wiOcean> ocean;
+bool oceanRegenerateRequested = false; // OceanRegenerate() was called, the ocean is recreated by the next PrepareFrameData(), because the previous frame can still be rendering with it
+uint32_t oceanSimulationResolutionCPU = 0;
 
 Texture shadowMapArray_2D;
 Texture shadowMapArray_Cube;
@@ -167,6 +171,61 @@ std::vector<RenderableTriangle> renderableTriangles_solid;
 std::vector<RenderableTriangle> renderableTriangles_wireframe;
 std::vector<PaintRadius> paintrads;
 
+// Pipelined rendering: the frame is rendered from these copies, while the main scene and camera are updated
+bool pipelinedRendering = false;
+Scene renderScene;
+CameraComponent renderCamera;
+float updateDeltaTime = 0; // the last UpdateScene() timestep that will be applied to the render time by PrepareFrameData()
+
+// Debug draws and water ripples that were requested while a frame can be rendered, these are appended to the render lists by PrepareFrameData():
+wiSpinLock queuedDrawsLock;
+std::vector<pair<XMFLOAT4X4, XMFLOAT4>> queuedBoxes;
+std::vector<pair<SPHERE, XMFLOAT4>> queuedSpheres;
+std::vector<pair<CAPSULE, XMFLOAT4>> queuedCapsules;
+std::vector<RenderableLine> queuedLines;
+std::vector<RenderableLine2D> queuedLines2D;
+std::vector<RenderablePoint> queuedPoints;
+std::vector<RenderableTriangle> queuedTriangles_solid;
+std::vector<RenderableTriangle> queuedTriangles_wireframe;
+std::vector<PaintRadius> queuedPaintrads;
+std::vector<wiSprite*> queuedWaterRipples;
+template<typename T>
+inline void QueueDraw(std::vector<T>& renderList, std::vector<T>& queue, const T& item)
+{
+	if (pipelinedRendering)
+	{
+		queuedDrawsLock.lock();
+		queue.push_back(item);
+		queuedDrawsLock.unlock();
+	}
+	else
+	{
+		renderList.push_back(item);
+	}
+}
+template<typename T>
+inline void FlushQueuedDraws(std::vector<T>& renderList, std::vector<T>& queue)
+{
+	renderList.insert(renderList.end(), queue.begin(), queue.end());
+	queue.clear();
+}
+void FlushQueuedDraws()
+{
+	queuedDrawsLock.lock();
+	FlushQueuedDraws(renderableBoxes, queuedBoxes);
+	FlushQueuedDraws(renderableSpheres, queuedSpheres);
+	FlushQueuedDraws(renderableCapsules, queuedCapsules);
+	FlushQueuedDraws(renderableLines, queuedLines);
+	FlushQueuedDraws(renderableLines2D, queuedLines2D);
+	FlushQueuedDraws(renderablePoints, queuedPoints);
+	FlushQueuedDraws(renderableTriangles_solid, queuedTriangles_solid);
+	FlushQueuedDraws(renderableTriangles_wireframe, queuedTriangles_wireframe);
+	FlushQueuedDraws(paintrads, queuedPaintrads);
+	waterRipples.insert(waterRipples.end(), queuedWaterRipples.begin(), queuedWaterRipples.end());
+	queuedWaterRipples.clear();
+	queuedDrawsLock.unlock();
+}
+
 XMFLOAT4 waterPlane = XMFLOAT4(0, 1, 0, 0);
 
 wiSpinLock deferredMIPGenLock;
@@ -1047,10 +1106,20 @@ Shader tiledLightingCS[TILEDLIGHTING_TYPE_COUNT][TILEDLIGHTING_CULLING_COUNT][TI
 
 bool LoadShader(SHADERSTAGE stage, wiGraphics::Shader& shader, const std::string& filename)
 {
+	if (wiShaderCache::GetShader(filename, stage, shader))
+	{
+		return true;
+	}
+
 	vector<uint8_t> buffer;
 	if (wiHelper::FileRead(SHADERPATH + filename, buffer)) 
 	{
-		return GetDevice()->CreateShader(stage, buffer.data(), buffer.size(), &shader);
+		if (GetDevice()->CreateShader(stage, buffer.data(), buffer.size(), &shader))
+		{
+			wiShaderCache::RegisterShader(filename, stage, shader, std::move(buffer));
+			return true;
+		}
+		return false;
 	}
 	wiHelper::messageBox("Shader not found: " + SHADERPATH + filename);
 	return false;
@@ -2791,6 +2860,7 @@ void SetShaderPath(const std::string& path)
 void ReloadShaders()
 {
 	GetDevice()->ClearPipelineStateCache();
+	wiShaderCache::Clear();
 
 	LoadShaders();
 	wiHairParticle::LoadShaders();
@@ -2800,8 +2870,11 @@ void ReloadShaders()
 	wiOcean::LoadShaders();
 	wiFFTGenerator::LoadShaders();
 	wiWidget::LoadShaders();
+	wiGUIBatch::LoadShaders();
 	wiGPUSortLib::LoadShaders();
 	wiGPUBVH::LoadShaders();
+
+	wiShaderCache::SaveArchive();
 }
 
 CameraComponent& GetCamera()
@@ -2824,11 +2897,45 @@ void AttachCamera(wiECS::Entity entity)
 	cameraTransform = entity;
 }
 
+void SetPipelinedRenderingEnabled(bool value)
+{
+	if (pipelinedRendering == value)
+	{
+		return;
+	}
+
+	// The main camera culling is keyed by the render camera:
+	frameCullings.erase(&GetRenderCamera());
+	pipelinedRendering = value;
+	frameCullings[&GetRenderCamera()].Clear();
+
+	renderCamera = GetCamera();
+	if (!pipelinedRendering)
+	{
+		renderScene.Clear();
+	}
+
+	// Queued draws are rendered right away from now on:
+	FlushQueuedDraws();
+}
+bool GetPipelinedRenderingEnabled()
+{
+	return pipelinedRendering;
+}
+Scene& GetRenderScene()
+{
+	return pipelinedRendering ? renderScene : GetScene();
+}
+CameraComponent& GetRenderCamera()
+{
+	return pipelinedRendering ? renderCamera : GetCamera();
+}
+
 void Initialize()
 {
 	GetCamera().CreatePerspective((float)GetInternalResolution().x, (float)GetInternalResolution().y, 0.1f, 800);
 
-	frameCullings[&GetCamera()].Clear();
+	frameCullings[&GetRenderCamera()].Clear();
 	frameCullings[&GetRefCamera()].Clear();
 
 	SetUpStates();
@@ -2840,7 +2947,8 @@ void Initialize()
 
 	wiBackLog::post("wiRenderer Initialized");
 }
-void ClearWorld()
+bool renderWorldCleared = false; // ClearWorld() was called with pipelined rendering, the render state is cleared by the next PrepareFrameData()
+void ClearRenderWorld()
 {
 	for (wiSprite* x : waterRipples)
 	{
@@ -2848,7 +2956,7 @@ void ClearWorld()
 	}
 	waterRipples.clear();
 
-	GetScene().Clear();
+	renderScene.Clear();
 
 	sceneBVH.Clear();
 	scene_bvh_invalid = true;
@@ -2870,6 +2978,28 @@ void ClearWorld()
 	pendingMaterialUpdates.clear();
 	pendingBottomLevelBuilds.clear();
 }
+void ClearWorld()
+{
+	GetScene().Clear();
+
+	if (pipelinedRendering)
+	{
+		queuedDrawsLock.lock();
+		for (wiSprite* x : queuedWaterRipples)
+		{
+			delete x;
+		}
+		queuedWaterRipples.clear();
+		queuedDrawsLock.unlock();
+
+		// the frame that is being rendered still uses the render state:
+		renderWorldCleared = true;
+	}
+	else
+	{
+		ClearRenderWorld();
+	}
+}
 
 static const uint32_t CASCADE_COUNT = 3;
 // Don't store this structure on heap!
@@ -3004,7 +3134,7 @@ ForwardEntityMaskCB ForwardEntityCullingCPU(const FrameCulling& culling, const A
 	// Performs CPU light culling for a renderable batch:
 	//	Similar to GPU-based tiled light culling, but this is only for simple forward passes (drawcall-granularity)
 
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	ForwardEntityMaskCB cb;
 	cb.xForwardLightMask.x = 0;
@@ -3085,9 +3215,9 @@ void BindEnvironmentTextures(SHADERSTAGE stage, CommandList cmd)
 	device->BindResource(stage, &textures[TEXTYPE_CUBEARRAY_ENVMAPARRAY], TEXSLOT_ENVMAPARRAY, cmd);
 	device->BindResource(stage, GetVoxelRadianceSecondaryBounceEnabled() ? &textures[TEXTYPE_3D_VOXELRADIANCE_HELPER] : &textures[TEXTYPE_3D_VOXELRADIANCE], TEXSLOT_VOXELRADIANCE, cmd);
 
-	if (GetScene().weather.skyMap != nullptr)
+	if (GetRenderScene().weather.skyMap != nullptr)
 	{
-		device->BindResource(stage, GetScene().weather.skyMap->texture, TEXSLOT_GLOBALENVMAP, cmd);
+		device->BindResource(stage, GetRenderScene().weather.skyMap->texture, TEXSLOT_GLOBALENVMAP, cmd);
 	}
 }
 
@@ -3098,7 +3228,7 @@ void RenderMeshes(const RenderQueue& renderQueue, RENDERPASS renderPass, uint32_
 	if (!renderQueue.empty())
 	{
 		GraphicsDevice* device = GetDevice();
-		const Scene& scene = GetScene();
+		const Scene& scene = GetRenderScene();
 
 		device->EventBegin("RenderMeshes", cmd);
 
@@ -3274,7 +3404,7 @@ void RenderMeshes(const RenderQueue& renderQueue, RENDERPASS renderPass, uint32_
 
 			if (forwardLightmaskRequest)
 			{
-				const CameraComponent* camera = renderQueue.camera == nullptr ? &GetCamera() : renderQueue.camera;
+				const CameraComponent* camera = renderQueue.camera == nullptr ? &GetRenderCamera() : renderQueue.camera;
 				const FrameCulling& culling = frameCullings.at(camera);
 				ForwardEntityMaskCB cb = ForwardEntityCullingCPU(culling, instancedBatch.aabb, renderPass);
 				device->UpdateBuffer(&constantBuffers[CBTYPE_FORWARDENTITYMASK], &cb, cmd);
@@ -3592,7 +3722,7 @@ void RenderMeshes(const RenderQueue& renderQueue, RENDERPASS renderPass, uint32_
 
 void RenderImpostors(const CameraComponent& camera, RENDERPASS renderPass, CommandList cmd)
 {
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 	const PipelineState* impostorRequest = GetImpostorPSO(renderPass);
 
 	if (scene.impostors.GetCount() > 0 && impostorRequest != nullptr)
@@ -3667,8 +3797,15 @@ void RenderImpostors(const CameraComponent& camera, RENDERPASS renderPass, Comma
 }
 
 
-void UpdatePerFrameData(float dt, uint32_t layerMask)
+void UpdateScene(float dt)
+{
+	updateDeltaTime = dt;
+
+	GetScene().Update(dt * GetGameSpeed());
+}
+void PrepareFrameData(uint32_t layerMask)
 {
+	const float dt = updateDeltaTime;
 	renderTime_Prev = renderTime;
 	deltaTime = dt * GetGameSpeed();
 	renderTime += deltaTime;
@@ -3676,7 +3813,11 @@ void UpdatePerFrameData(float dt, uint32_t layerMask)
 	GraphicsDevice* device = GetDevice();
 	Scene& scene = GetScene();
 
-	scene.Update(deltaTime);
+	if (renderWorldCleared)
+	{
+		renderWorldCleared = false;
+		ClearRenderWorld();
+	}
 
 	wiJobSystem::context ctx;
 
@@ -3708,6 +3849,10 @@ void UpdatePerFrameData(float dt, uint32_t layerMask)
 	}
 
 	GetCamera().UpdateCamera();
+	if (pipelinedRendering)
+	{
+		renderCamera = GetCamera();
+	}
 	GetRefCamera() = GetCamera();
 	GetRefCamera().Reflect(waterPlane);
 
@@ -3834,7 +3979,8 @@ void UpdatePerFrameData(float dt, uint32_t layerMask)
 		wiJobSystem::Execute(ctx, [&](wiJobArgs args) {
 			// We don't update it if the scene is empty, this even makes it easier to debug
 			const float f = 0.05f / voxelSceneData.voxelsize;
-			XMFLOAT3 center = XMFLOAT3(floorf(GetCamera().Eye.x * f) / f, floorf(GetCamera().Eye.y * f) / f, floorf(GetCamera().Eye.z * f) / f);
+			const CameraComponent& camera = GetRenderCamera();
+			XMFLOAT3 center = XMFLOAT3(floorf(camera.Eye.x * f) / f, floorf(camera.Eye.y * f) / f, floorf(camera.Eye.z * f) / f);
 			if (wiMath::DistanceSquared(center, voxelSceneData.center) > 0)
 			{
 				voxelSceneData.centerChangedThisFrame = true;
@@ -3900,7 +4046,7 @@ void UpdatePerFrameData(float dt, uint32_t layerMask)
 					group_list[group_count++] = args.jobIndex;
 
 					// Main camera can request reflection rendering:
-					if (camera == &GetCamera())
+					if (camera == &GetRenderCamera())
 					{
 						const ObjectComponent& object = scene.objects[args.jobIndex];
 						if (object.IsRequestPlanarReflection())
@@ -3937,7 +4083,7 @@ void UpdatePerFrameData(float dt, uint32_t layerMask)
 			}, sharedmemory_size);
 
 			// the following cullings will be only for the main camera:
-			if (camera == &GetCamera())
+			if (camera == &GetRenderCamera())
 			{
 				culling.culledDecals.resize(scene.aabb_decals.GetCount());
 				wiJobSystem::Dispatch(ctx, (uint32_t)scene.aabb_decals.GetCount(), groupSize, [&](wiJobArgs args) {
@@ -4165,15 +4311,25 @@ void UpdatePerFrameData(float dt, uint32_t layerMask)
 		XMVECTOR _refPlane = XMPlaneFromPointNormal(XMVectorSet(0, scene.weather.oceanParameters.waterHeight, 0, 0), XMVectorSet(0, 1, 0, 0));
 		XMStoreFloat4(&waterPlane, _refPlane);
 
-		if (ocean == nullptr)
+		if (ocean == nullptr || oceanRegenerateRequested)
 		{
 			ocean = std::make_unique<wiOcean>(scene.weather);
 		}
+
+		if (oceanSimulationResolutionCPU > 0)
+		{
+			wiJobSystem::Execute(ctx, [&](wiJobArgs args) {
+				wiOceanSimulation& simulation = ocean->getSimulation();
+				simulation.SetResolution(oceanSimulationResolutionCPU);
+				simulation.Update(scene.weather, renderTime);
+			});
+		}
 	}
 	else if (ocean != nullptr)
 	{
 		ocean.reset();
 	}
+	oceanRegenerateRequested = false;
 
 	wiJobSystem::Execute(ctx, [&](wiJobArgs args) {
 		ManageDecalAtlas();
@@ -4196,11 +4352,48 @@ void UpdatePerFrameData(float dt, uint32_t layerMask)
 	});
 
 	wiJobSystem::Wait(ctx);
+
+	if (pipelinedRendering)
+	{
+		auto range_copy = wiProfiler::BeginRangeCPU("Render Scene Copy");
+
+		// Occlusion culling results were written to the render scene, keep them for the new copy:
+		for (size_t i = 0; i < renderScene.objects.GetCount(); ++i)
+		{
+			const ObjectComponent& src = renderScene.objects[i];
+			const Entity entity = renderScene.objects.GetEntity(i);
+			ObjectComponent* dst = nullptr;
+			if (i < scene.objects.GetCount() && scene.objects.GetEntity(i) == entity)
+			{
+				dst = &scene.objects[i];
+			}
+			else
+			{
+				dst = scene.objects.GetComponent(entity);
+			}
+			if (dst != nullptr)
+			{
+				dst->occlusionHistory = src.occlusionHistory;
+				dst->occlusionQueryID = src.occlusionQueryID;
+			}
+		}
+
+		renderScene.CopyForRendering(scene);
+
+		FlushQueuedDraws();
+
+		wiProfiler::EndRange(range_copy); // Render Scene Copy
+	}
+}
+void UpdatePerFrameData(float dt, uint32_t layerMask)
+{
+	UpdateScene(dt);
+	PrepareFrameData(layerMask);
 }
 void UpdateRenderData(CommandList cmd)
 {
 	GraphicsDevice* device = GetDevice();
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	BindCommonResources(cmd);
 
@@ -4228,7 +4421,7 @@ void UpdateRenderData(CommandList cmd)
 	pendingMaterialUpdates.clear();
 
 
-	const FrameCulling& mainCameraCulling = frameCullings.at(&GetCamera());
+	const FrameCulling& mainCameraCulling = frameCullings.at(&GetRenderCamera());
 
 	// Fill Entity Array with decals + envprobes + lights in the frustum:
 	{
@@ -4236,7 +4429,7 @@ void UpdateRenderData(CommandList cmd)
 		ShaderEntity* entityArray = (ShaderEntity*)GetRenderFrameAllocator(cmd).allocate(sizeof(ShaderEntity)*SHADER_ENTITY_COUNT);
 		XMMATRIX* matrixArray = (XMMATRIX*)GetRenderFrameAllocator(cmd).allocate(sizeof(XMMATRIX)*MATRIXARRAY_COUNT);
 
-		const XMMATRIX viewMatrix = GetCamera().GetView();
+		const XMMATRIX viewMatrix = GetRenderCamera().GetView();
 
 		uint32_t entityCounter = 0;
 		uint32_t matrixCounter = 0;
@@ -4361,7 +4554,7 @@ void UpdateRenderData(CommandList cmd)
 				if (shadow)
 				{
 					std::array<SHCAM, CASCADE_COUNT> shcams;
-					CreateDirLightShadowCams(light, GetCamera(), shcams);
+					CreateDirLightShadowCams(light, GetRenderCamera(), shcams);
 					matrixArray[matrixCounter++] = shcams[0].VP;
 					matrixArray[matrixCounter++] = shcams[1].VP;
 					matrixArray[matrixCounter++] = shcams[2].VP;
@@ -4466,7 +4659,7 @@ void UpdateRenderData(CommandList cmd)
 
 	UpdateFrameCB(cmd);
 
-	GetPrevCamera() = GetCamera();
+	GetPrevCamera() = GetRenderCamera();
 
 	auto range = wiProfiler::BeginRangeGPU("Skinning", cmd);
 	device->EventBegin("Skinning", cmd);
@@ -4624,7 +4817,7 @@ void UpdateRenderData(CommandList cmd)
 void UpdateRaytracingAccelerationStructures(CommandList cmd)
 {
 	GraphicsDevice* device = GetDevice();
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 	if (!device->CheckCapability(GraphicsDevice::GRAPHICSDEVICE_CAPABILITY_RAYTRACING) || !scene.TLAS.IsValid())
 	{
 		return;
@@ -4712,7 +4905,7 @@ void OcclusionCulling_Render(CommandList cmd)
 	}
 
 	GraphicsDevice* device = GetDevice();
-	const FrameCulling& culling = frameCullings.at(&GetCamera());
+	const FrameCulling& culling = frameCullings.at(&GetRenderCamera());
 
 	auto range = wiProfiler::BeginRangeGPU("Occlusion Culling Render", cmd);
 
@@ -4725,7 +4918,7 @@ void OcclusionCulling_Render(CommandList cmd)
 		device->BindPipelineState(&PSO_occlusionquery, cmd);
 
 		// TODO: This is not const, so not thread safe!
-		Scene& scene = GetScene();
+		Scene& scene = GetRenderScene();
 
 		int queryID = 0;
 
@@ -4754,7 +4947,7 @@ void OcclusionCulling_Render(CommandList cmd)
 
 			const AABB& aabb = scene.aabb_objects[instanceIndex];
 
-			if (aabb.intersects(GetCamera().Eye))
+			if (aabb.intersects(GetRenderCamera().Eye))
 			{
 				// camera is inside the instance, mark it as visible in this frame:
 				object.occlusionHistory |= 1;
@@ -4792,11 +4985,11 @@ void OcclusionCulling_Read()
 	auto range = wiProfiler::BeginRangeCPU("Occlusion Culling Read");
 
 	GraphicsDevice* device = GetDevice();
-	const FrameCulling& culling = frameCullings.at(&GetCamera());
+	const FrameCulling& culling = frameCullings.at(&GetRenderCamera());
 
 	if (!culling.culledObjects.empty())
 	{
-		Scene& scene = GetScene();
+		Scene& scene = GetRenderScene();
 
 		for (uint32_t instanceIndex : culling.culledObjects)
 		{
@@ -4847,6 +5040,8 @@ void EndFrame()
 	{
 		renderFrameAllocators[i].reset();
 	}
+
+	wiShaderCache::Update();
 }
 
 void PutWaterRipple(const std::string& image, const XMFLOAT3& pos)
@@ -4863,7 +5058,16 @@ void PutWaterRipple(const std::string& image, const XMFLOAT3& pos)
 	img->params.pivot = XMFLOAT2(0.5f, 0.5f);
 	img->params.lookAt = waterPlane;
 	img->params.lookAt.w = 1;
-	waterRipples.push_back(img);
+	if (pipelinedRendering)
+	{
+		queuedDrawsLock.lock();
+		queuedWaterRipples.push_back(img);
+		queuedDrawsLock.unlock();
+	}
+	else
+	{
+		waterRipples.push_back(img);
+	}
 }
 void ManageWaterRipples(){
 	while (
@@ -4893,7 +5097,7 @@ void DrawSoftParticles(
 	CommandList cmd
 )
 {
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 	const FrameCulling& culling = frameCullings.at(&camera);
 	size_t emitterCount = culling.culledEmitters.size();
 	if (emitterCount == 0)
@@ -4949,7 +5153,7 @@ void DrawDeferredLights(
 	GraphicsDevice* device = GetDevice();
 	const FrameCulling& culling = frameCullings.at(&camera);
 
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	device->EventBegin("DrawDeferredLights", cmd);
 	auto range = wiProfiler::BeginRangeGPU("Deferred Light Render", cmd);
@@ -5046,7 +5250,7 @@ void DrawLightVisualizers(
 	if (!culling.culledLights.empty())
 	{
 		GraphicsDevice* device = GetDevice();
-		const Scene& scene = GetScene();
+		const Scene& scene = GetRenderScene();
 
 		device->EventBegin("Light Visualizer Render", cmd);
 
@@ -5176,7 +5380,7 @@ void DrawVolumeLights(
 
 		device->BindResource(PS, &depthbuffer, TEXSLOT_DEPTH, cmd);
 
-		const Scene& scene = GetScene();
+		const Scene& scene = GetRenderScene();
 
 		for (int type = 0; type < LightComponent::LIGHTTYPE_COUNT; ++type)
 		{
@@ -5270,7 +5474,7 @@ void DrawLensFlares(
 
 	const FrameCulling& culling = frameCullings.at(&camera);
 
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	GetDevice()->BindResource(GS, &depthbuffer, TEXSLOT_DEPTH, cmd);
 
@@ -5451,7 +5655,7 @@ void DrawShadowmaps(const CameraComponent& camera, CommandList cmd, uint32_t lay
 		return;
 
 	GraphicsDevice* device = GetDevice();
-	const FrameCulling& culling = frameCullings.at(&GetCamera());
+	const FrameCulling& culling = frameCullings.at(&GetRenderCamera());
 
 	if (!culling.culledLights.empty())
 	{
@@ -5462,7 +5666,7 @@ void DrawShadowmaps(const CameraComponent& camera, CommandList cmd, uint32_t lay
 		BindConstantBuffers(VS, cmd);
 		BindConstantBuffers(PS, cmd);
 
-		const Scene& scene = GetScene();
+		const Scene& scene = GetRenderScene();
 
 		device->UnbindResources(TEXSLOT_SHADOWARRAY_2D, 2, cmd);
 
@@ -5701,7 +5905,7 @@ void DrawShadowmaps(const CameraComponent& camera, CommandList cmd, uint32_t lay
 void DrawScene(const CameraComponent& camera, bool tessellation, CommandList cmd, RENDERPASS renderPass, bool grass, bool occlusionCulling)
 {
 	GraphicsDevice* device = GetDevice();
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 	const FrameCulling& culling = frameCullings.at(&camera);
 
 	device->EventBegin("DrawScene", cmd);
@@ -5787,7 +5991,7 @@ void DrawScene(const CameraComponent& camera, bool tessellation, CommandList cmd
 void DrawScene_Transparent(const CameraComponent& camera, const Texture& lineardepth, RENDERPASS renderPass, CommandList cmd, bool grass, bool occlusionCulling)
 {
 	GraphicsDevice* device = GetDevice();
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 	const FrameCulling& culling = frameCullings.at(&camera);
 
 	device->EventBegin("DrawScene_Transparent", cmd);
@@ -5867,7 +6071,7 @@ void DrawScene_Transparent(const CameraComponent& camera, const Texture& lineard
 void DrawDebugWorld(const CameraComponent& camera, CommandList cmd)
 {
 	GraphicsDevice* device = GetDevice();
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	static GPUBuffer wirecubeVB;
 	static GPUBuffer wirecubeIB;
@@ -6927,7 +7131,7 @@ void DrawDebugWorld(const CameraComponent& camera, CommandList cmd)
 void DrawSky(CommandList cmd)
 {
 	GraphicsDevice* device = GetDevice();
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	device->EventBegin("DrawSky", cmd);
 	
@@ -6978,7 +7182,7 @@ void DrawDeferredDecals(
 
 		device->EventBegin("DrawDeferredDecals", cmd);
 
-		const Scene& scene = GetScene();
+		const Scene& scene = GetRenderScene();
 
 		device->BindConstantBuffer(PS, &constantBuffers[CBTYPE_DECAL], CB_GETBINDSLOT(DecalCB),cmd);
 
@@ -7157,7 +7361,7 @@ void RefreshEnvProbes(CommandList cmd)
 		return;
 	}
 
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	GraphicsDevice* device = GetDevice();
 	device->EventBegin("EnvironmentProbe Refresh", cmd);
@@ -7169,8 +7373,8 @@ void RefreshEnvProbes(CommandList cmd)
 	vp.Width = envmapRes;
 	device->BindViewports(1, &vp, cmd);
 
-	const float zNearP = GetCamera().zNearP;
-	const float zFarP = GetCamera().zFarP;
+	const float zNearP = GetRenderCamera().zNearP;
+	const float zFarP = GetRenderCamera().zFarP;
 
 	for (uint32_t probeIndex : probesToRefresh)
 	{
@@ -7385,7 +7589,7 @@ void RefreshImpostors(CommandList cmd)
 		return;
 	}
 
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	GraphicsDevice* device = GetDevice();
 	device->EventBegin("Impostor Refresh", cmd);
@@ -7517,7 +7721,7 @@ void RefreshImpostors(CommandList cmd)
 
 	}
 
-	UpdateCameraCB(GetCamera(), cmd);
+	UpdateCameraCB(GetRenderCamera(), cmd);
 
 	device->EventEnd(cmd);
 }
@@ -7534,7 +7738,7 @@ void VoxelRadiance(CommandList cmd)
 	device->EventBegin("Voxel Radiance", cmd);
 	auto range = wiProfiler::BeginRangeGPU("Voxel Radiance", cmd);
 
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	static RenderPass renderpass_voxelize;
 
@@ -7766,9 +7970,9 @@ void ComputeTiledLightCulling(
 	// calculate the per-tile frustums once:
 	static bool frustumsComplete = false;
 	static XMFLOAT4X4 _savedProjection;
-	if (memcmp(&_savedProjection, &GetCamera().Projection, sizeof(XMFLOAT4X4)) != 0)
+	if (memcmp(&_savedProjection, &GetRenderCamera().Projection, sizeof(XMFLOAT4X4)) != 0)
 	{
-		_savedProjection = GetCamera().Projection;
+		_savedProjection = GetRenderCamera().Projection;
 		frustumsComplete = false;
 	}
 	if(!frustumsComplete || _resolutionChanged)
@@ -7833,7 +8037,7 @@ void ComputeTiledLightCulling(
 			device->BindUAV(CS, &textures[TEXTYPE_2D_DEBUGUAV], 3, cmd);
 		}
 
-		const FrameCulling& frameCulling = frameCullings.at(&GetCamera());
+		const FrameCulling& frameCulling = frameCullings.at(&GetRenderCamera());
 
 
 		DispatchParamsCB dispatchParams;
@@ -8264,7 +8468,7 @@ void CopyTexture2D(const Texture& dst, uint32_t DstMIP, uint32_t DstX, uint32_t
 
 void BuildSceneBVH(CommandList cmd)
 {
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	sceneBVH.Build(scene, cmd);
 }
@@ -8377,7 +8581,7 @@ void RayTraceScene(
 )
 {
 	GraphicsDevice* device = GetDevice();
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	device->EventBegin("RayTraceScene", cmd);
 
@@ -8709,7 +8913,7 @@ void RefreshDecalAtlas(CommandList cmd)
 
 	using namespace wiRectPacker;
 
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	if (repackAtlas_Decal)
 	{
@@ -8896,7 +9100,7 @@ void ManageLightmapAtlas()
 void RenderObjectLightMap(const ObjectComponent& object, CommandList cmd)
 {
 	GraphicsDevice* device = GetDevice();
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	device->EventBegin("RenderObjectLightMap", cmd);
 
@@ -8973,7 +9177,7 @@ void RenderObjectLightMap(const ObjectComponent& object, CommandList cmd)
 }
 void RefreshLightmapAtlas(CommandList cmd)
 {
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 	GraphicsDevice* device = GetDevice();
 
 	if (!lightmapsToRefresh.empty())
@@ -9074,7 +9278,7 @@ void BindCommonResources(CommandList cmd)
 
 void UpdateFrameCB(CommandList cmd)
 {
-	const Scene& scene = GetScene();
+	const Scene& scene = GetRenderScene();
 
 	FrameCB cb;
 
@@ -9754,7 +9958,7 @@ void Postprocess_HBAO(
 	cb.xPPParams0.y = 0;
 	cb.hbao_power = power;
 
-	const CameraComponent& camera = GetCamera();
+	const CameraComponent& camera = GetRenderCamera();
 	// Load first element of projection matrix which is the cotangent of the horizontal FOV divided by 2.
 	const float TanHalfFovH = 1.0f / camera.Projection.m[0][0];
 	const float FocalLenX = 1.0f / TanHalfFovH * ((float)cb.xPPResolution.y / (float)cb.xPPResolution.x);
@@ -10022,7 +10226,7 @@ void Postprocess_MSAO(
 
 		MSAOCB cb;
 
-		const CameraComponent& camera = GetCamera();
+		const CameraComponent& camera = GetRenderCamera();
 
 		// Load first element of projection matrix which is the cotangent of the horizontal FOV divided by 2.
 		const float TanHalfFovH = 1.0f / camera.Projection.m[0][0];
@@ -10268,7 +10472,7 @@ void Postprocess_RTAO(
 	float power
 )
 {
-	const Scene& scene = wiScene::GetScene();
+	const Scene& scene = GetRenderScene();
 	if (scene.objects.GetCount() <= 0)
 	{
 		return;
@@ -11940,42 +12144,42 @@ RAY GetPickRay(long cursorX, long cursorY)
 
 void DrawBox(const XMFLOAT4X4& boxMatrix, const XMFLOAT4& color)
 {
-	renderableBoxes.push_back(std::make_pair(boxMatrix,color));
+	QueueDraw(renderableBoxes, queuedBoxes, std::make_pair(boxMatrix, color));
 }
 void DrawSphere(const SPHERE& sphere, const XMFLOAT4& color)
 {
-	renderableSpheres.push_back(std::make_pair(sphere, color));
+	QueueDraw(renderableSpheres, queuedSpheres, std::make_pair(sphere, color));
 }
 void DrawCapsule(const CAPSULE& capsule, const XMFLOAT4& color)
 {
-	renderableCapsules.push_back(std::make_pair(capsule, color));
+	QueueDraw(renderableCapsules, queuedCapsules, std::make_pair(capsule, color));
 }
 void DrawLine(const RenderableLine& line)
 {
-	renderableLines.push_back(line);
+	QueueDraw(renderableLines, queuedLines, line);
 }
 void DrawLine(const RenderableLine2D& line)
 {
-	renderableLines2D.push_back(line);
+	QueueDraw(renderableLines2D, queuedLines2D, line);
 }
 void DrawPoint(const RenderablePoint& point)
 {
-	renderablePoints.push_back(point);
+	QueueDraw(renderablePoints, queuedPoints, point);
 }
 void DrawTriangle(const RenderableTriangle& triangle, bool wireframe)
 {
 	if (wireframe)
 	{
-		renderableTriangles_wireframe.push_back(triangle);
+		QueueDraw(renderableTriangles_wireframe, queuedTriangles_wireframe, triangle);
 	}
 	else
 	{
-		renderableTriangles_solid.push_back(triangle);
+		QueueDraw(renderableTriangles_solid, queuedTriangles_solid, triangle);
 	}
 }
 void DrawPaintRadius(const PaintRadius& paintrad)
 {
-	paintrads.push_back(paintrad);
+	QueueDraw(paintrads, queuedPaintrads, paintrad);
 }
 
 void AddDeferredMIPGen(std::shared_ptr<wiResource> resource, bool preserve_coverage)
@@ -12083,7 +12287,17 @@ bool IsRequestedReflectionRendering() { return requestReflectionRendering; }
 bool IsRequestedVolumetricLightRendering() { return requestVolumetricLightRendering; }
 void SetGameSpeed(float value) { GameSpeed = std::max(0.0f, value); }
 float GetGameSpeed() { return GameSpeed; }
-void OceanRegenerate() { if (ocean != nullptr) ocean = std::make_unique<wiOcean>(GetScene().weather); }
+void OceanRegenerate() { if (ocean != nullptr) oceanRegenerateRequested = true; }
+void SetOceanSimulationResolutionCPU(uint32_t value) { oceanSimulationResolutionCPU = value; }
+uint32_t GetOceanSimulationResolutionCPU() { return oceanSimulationResolutionCPU; }
+const wiOceanSimulation* GetOceanSimulation()
+{
+	if (ocean == nullptr || oceanSimulationResolutionCPU == 0 || !ocean->getSimulation().IsValid())
+	{
+		return nullptr;
+	}
+	return &ocean->getSimulation();
+}
 void InvalidateBVH() { scene_bvh_invalid = true; }
 void SetRaytraceBounceCount(uint32_t bounces)
 {
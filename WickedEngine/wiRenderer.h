@@ -9,6 +9,7 @@
 #include <memory>
 
 struct RAY;
+class wiOceanSimulation;
 struct wiResource;
 
 namespace wiRenderer
@@ -52,6 +53,7 @@ namespace wiRenderer
 	// Reload shaders
 	void ReloadShaders();
 
+	// Loads the shader from the shader directory, or takes it from the shader archive if it was packed there (see wiShaderCache)
 	bool LoadShader(wiGraphics::SHADERSTAGE stage, wiGraphics::Shader& shader, const std::string& filename);
 
 	// Returns the main camera that is currently being used in rendering (and also for post processing)
@@ -63,7 +65,22 @@ namespace wiRenderer
 	// Attach camera to entity for the current frame
 	void AttachCamera(wiECS::Entity entity);
 
-	// Updates the main scene, performs frustum culling for main camera and other tasks that are only done once per frame. Specify layerMask to only include specific entities in the render frame.
+	// Pipelined rendering: the frame is rendered from a copy of the scene and main camera, so that the main scene can be updated while the previous frame is rendered
+	//	When enabled, the rendering functions use GetRenderScene() and GetRenderCamera(), which are only refreshed by PrepareFrameData()
+	//	Debug draws (DrawBox(), DrawLine(), etc.) and water ripples are queued and they are rendered from the next PrepareFrameData() call
+	void SetPipelinedRenderingEnabled(bool value);
+	bool GetPipelinedRenderingEnabled();
+	// Returns the scene that is being rendered. This is the global scene, or the copy of it that was made by the last PrepareFrameData() with pipelined rendering
+	wiScene::Scene& GetRenderScene();
+	// Returns the main camera that is being rendered. This is GetCamera(), or the copy of it that was made by the last PrepareFrameData() with pipelined rendering
+	wiScene::CameraComponent& GetRenderCamera();
+
+	// Updates the main scene (animation, physics, transforms, etc.). With pipelined rendering, this can run while the previous frame is rendered
+	void UpdateScene(float dt);
+	// Performs frustum culling for main camera and other tasks that are only done once per frame, after UpdateScene(). Specify layerMask to only include specific entities in the render frame.
+	//	With pipelined rendering, this also copies the scene for rendering, so it must not be called while a frame is rendered
+	void PrepareFrameData(uint32_t layerMask = ~0);
+	// Calls UpdateScene() and PrepareFrameData()
 	void UpdatePerFrameData(float dt, uint32_t layerMask = ~0);
 	// Updates the GPU state according to the previously called UpdatePerFrameData()
 	void UpdateRenderData(wiGraphics::CommandList cmd);
@@ -482,7 +499,12 @@ namespace wiRenderer
 	const XMFLOAT4& GetWaterPlane();
 	void SetGameSpeed(float value);
 	float GetGameSpeed();
-	void OceanRegenerate(); // regeenrates ocean if it is already created
+	void OceanRegenerate(); // regeenrates ocean if it is already created, the ocean is recreated by the next PrepareFrameData()
+	// The ocean is also simulated on the CPU at this resolution when it is not zero, so that the water surface can be queried by GetOceanSimulation()
+	void SetOceanSimulationResolutionCPU(uint32_t value);
+	uint32_t GetOceanSimulationResolutionCPU();
+	// Returns the CPU simulation of the ocean after it was updated by the frame, or nullptr if the ocean is disabled or it is not simulated on the CPU
+	const wiOceanSimulation* GetOceanSimulation();
 	void InvalidateBVH(); // invalidates scene bvh so if something wants to use it, it will recompute and validate it
 	void SetRaytraceBounceCount(uint32_t bounces);
 	uint32_t GetRaytraceBounceCount();
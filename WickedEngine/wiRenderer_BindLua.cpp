@@ -77,7 +77,7 @@ namespace wiRenderer_BindLua
 
 	int GetCamera(lua_State* L)
 	{
-		Luna<CameraComponent_BindLua>::push(L, new CameraComponent_BindLua(&wiRenderer::GetCamera()));
+		Luna<CameraComponent_BindLua>::create(L, &wiRenderer::GetCamera());
 		return 1;
 	}
 	int AttachCamera(lua_State* L)
@@ -0,0 +1,950 @@
+#include "wiReplication.h"
+#include "wiJobSystem.h"
+#include "wiTimer.h"
+#include "wiMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+using namespace wiECS;
+using namespace wiScene;
+
+namespace wiReplication
+{
+	enum PACKET_TYPE
+	{
+		PACKET_SNAPSHOT = 1,
+		PACKET_ACKNOWLEDGEMENT = 2,
+	};
+	enum SNAPSHOT_FLAGS
+	{
+		SNAPSHOT_HAS_BASELINE = 1 << 0,
+	};
+	enum RECORD
+	{
+		RECORD_UPDATE = 0,	// fields changed compared to the baseline
+		RECORD_CREATE = 1,	// not in the baseline, every field is compared to the default state
+		RECORD_REMOVE = 2,	// removed or left the interest of the client
+	};
+	enum FIELD
+	{
+		FIELD_POSITION = 1 << 0,
+		FIELD_ROTATION = 1 << 1,
+		FIELD_SCALE = 1 << 2,
+		FIELD_LAYER = 1 << 3,
+		FIELD_NAME = 1 << 4,
+		FIELD_BITS = 5,
+	};
+
+	// Every snapshot packet starts with this, followed by the bit packed entity records
+	struct SnapshotHeader
+	{
+		uint8_t type;
+		uint8_t flags;
+		uint16_t sequence;
+		uint16_t baseline;
+		uint16_t fragment;
+		uint16_t fragmentCount;
+		uint16_t recordCount;
+	};
+	static_assert(sizeof(SnapshotHeader) == 12, "SnapshotHeader must be tightly packed");
+
+	// The client sends this after every update
+	struct AcknowledgementPacket
+	{
+		uint8_t type;
+		uint8_t hasSequence;
+		uint16_t sequence;		// newest complete snapshot
+		uint32_t previousBits;	// bit i is set if snapshot (sequence - 1 - i) is complete
+		XMFLOAT3 interestPosition;
+		float interestRadius;
+		uint32_t interestLayerMask;
+	};
+	static_assert(sizeof(AcknowledgementPacket) == 28, "AcknowledgementPacket must be tightly packed");
+
+	static const uint32_t RECORD_CAPACITY_BITS = uint32_t(wiNetwork::MAX_PACKET_SIZE - sizeof(SnapshotHeader)) * 8;
+	// Records are written past the capacity before it is detected that they don't fit, this must be larger than any record:
+	static const uint32_t RECORD_OVERFLOW_BYTES = 512;
+	static const uint32_t MAX_NAME_LENGTH = 255;
+	static const float SQRT2 = 1.41421356f;
+
+	// Sequence numbers wrap around, a is newer than b if it is ahead by less than half the range
+	inline bool SequenceGreater(uint16_t a, uint16_t b)
+	{
+		return ((a > b) && (a - b <= 32768)) || ((a < b) && (b - a > 32768));
+	}
+
+	struct BitWriter
+	{
+		uint8_t* data = nullptr;
+		uint32_t position = 0;
+
+		void Write(uint32_t value, uint32_t count)
+		{
+			while (count > 0)
+			{
+				const uint32_t offset = position & 7;
+				const uint32_t bits = std::min(8 - offset, count);
+				uint8_t& byte = data[position >> 3];
+				if (offset == 0)
+				{
+					byte = 0;
+				}
+				byte |= uint8_t((value & ((1u << bits) - 1)) << offset);
+				value >>= bits;
+				count -= bits;
+				position += bits;
+			}
+		}
+		void Write64(uint64_t value)
+		{
+			Write(uint32_t(value), 32);
+			Write(uint32_t(value >> 32), 32);
+		}
+		// Moves back to an earlier position, discarding everything written after it
+		void Rewind(uint32_t value)
+		{
+			position = value;
+			data[position >> 3] &= uint8_t((1u << (position & 7)) - 1);
+		}
+		// Small values are written with fewer bits:
+		void WriteVarUint(uint32_t value)
+		{
+			if (value < (1u << 4))
+			{
+				Write(0, 2);
+				Write(value, 4);
+			}
+			else if (value < (1u << 8))
+			{
+				Write(1, 2);
+				Write(value, 8);
+			}
+			else if (value < (1u << 16))
+			{
+				Write(2, 2);
+				Write(value, 16);
+			}
+			else
+			{
+				Write(3, 2);
+				Write(value, 32);
+			}
+		}
+		void WriteVarInt(int32_t value)
+		{
+			WriteVarUint((uint32_t(value) << 1) ^ uint32_t(value >> 31)); // zigzag encoding keeps small negative values small
+		}
+	};
+
+	struct BitReader
+	{
+		const uint8_t* data = nullptr;
+		uint32_t size = 0;
+		uint32_t position = 0;
+		bool overflow = false;
+
+		uint32_t Read(uint32_t count)
+		{
+			if (position + count > size)
+			{
+				overflow = true;
+				return 0;
+			}
+			uint32_t value = 0;
+			uint32_t shift = 0;
+			while (count > 0)
+			{
+				const uint32_t offset = position & 7;
+				const uint32_t bits = std::min(8 - offset, count);
+				value |= uint32_t((data[position >> 3] >> offset) & ((1u << bits) - 1)) << shift;
+				shift += bits;
+				count -= bits;
+				position += bits;
+			}
+			return value;
+		}
+		uint64_t Read64()
+		{
+			const uint64_t low = Read(32);
+			const uint64_t high = Read(32);
+			return low | (high << 32);
+		}
+		uint32_t ReadVarUint()
+		{
+			static const uint32_t bits[] = { 4, 8, 16, 32 };
+			return Read(bits[Read(2)]);
+		}
+		int32_t ReadVarInt()
+		{
+			const uint32_t value = ReadVarUint();
+			return int32_t((value >> 1) ^ (~(value & 1) + 1));
+		}
+	};
+
+	inline int32_t QuantizeFixed(float value, float precision)
+	{
+		return (int32_t)std::round(wiMath::Clamp(value / precision, -2.0e9f, 2.0e9f));
+	}
+
+	// The largest component is left out and reconstructed from the other three, which are in [-1/sqrt(2), 1/sqrt(2)] range:
+	//	2 bits of largest index + 3 * 10 bits
+	uint32_t PackQuaternion(const XMFLOAT4& value)
+	{
+		XMFLOAT4 normalized;
+		XMStoreFloat4(&normalized, XMQuaternionNormalize(XMLoadFloat4(&value)));
+		float components[4] = { normalized.x, normalized.y, normalized.z, normalized.w };
+
+		uint32_t largest = 0;
+		for (uint32_t i = 1; i < 4; ++i)
+		{
+			if (std::abs(components[i]) > std::abs(components[largest]))
+			{
+				largest = i;
+			}
+		}
+		// q and -q are the same rotation, so the largest component can always be positive:
+		const float sign = components[largest] < 0 ? -1.0f : 1.0f;
+
+		uint32_t result = largest;
+		uint32_t shift = 2;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+			{
+				continue;
+			}
+			const float unorm = wiMath::Clamp(components[i] * sign * SQRT2 * 0.5f + 0.5f, 0.0f, 1.0f);
+			result |= uint32_t(unorm * 1023.0f + 0.5f) << shift;
+			shift += 10;
+		}
+		return result;
+	}
+	XMFLOAT4 UnpackQuaternion(uint32_t value)
+	{
+		const uint32_t largest = value & 3;
+		float components[4];
+		float sum = 0;
+		uint32_t shift = 2;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+			{
+				continue;
+			}
+			components[i] = (float((value >> shift) & 1023) / 1023.0f * 2.0f - 1.0f) / SQRT2;
+			sum += components[i] * components[i];
+			shift += 10;
+		}
+		components[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+		return XMFLOAT4(components[0], components[1], components[2], components[3]);
+	}
+
+	uint32_t HashName(const std::string& name)
+	{
+		if (name.empty())
+		{
+			return 0;
+		}
+		uint32_t hash = 2166136261u;
+		for (char c : name)
+		{
+			hash = (hash ^ uint8_t(c)) * 16777619u;
+		}
+		return hash == 0 ? 1 : hash;
+	}
+
+	// The state that new entities are compared to:
+	EntityState GetDefaultState(const Settings& settings)
+	{
+		EntityState state;
+		state.rotation = PackQuaternion(XMFLOAT4(0, 0, 0, 1));
+		const int32_t one = QuantizeFixed(1, settings.scalePrecision);
+		state.scale[0] = one;
+		state.scale[1] = one;
+		state.scale[2] = one;
+		return state;
+	}
+
+	uint32_t ComputeChangedFields(const Settings& settings, const EntityState& prev, const EntityState& state)
+	{
+		uint32_t fields = 0;
+		if (settings.components & COMPONENT_TRANSFORM)
+		{
+			if (prev.position[0] != state.position[0] || prev.position[1] != state.position[1] || prev.position[2] != state.position[2])
+			{
+				fields |= FIELD_POSITION;
+			}
+			if (prev.rotation != state.rotation)
+			{
+				fields |= FIELD_ROTATION;
+			}
+			if (prev.scale[0] != state.scale[0] || prev.scale[1] != state.scale[1] || prev.scale[2] != state.scale[2])
+			{
+				fields |= FIELD_SCALE;
+			}
+		}
+		if ((settings.components & COMPONENT_LAYER) && prev.layerMask != state.layerMask)
+		{
+			fields |= FIELD_LAYER;
+		}
+		if ((settings.components & COMPONENT_NAME) && prev.nameHash != state.nameHash)
+		{
+			fields |= FIELD_NAME;
+		}
+		return fields;
+	}
+
+	void WriteFields(BitWriter& writer, const Scene& scene, const EntityState& prev, const EntityState& state, uint32_t fields)
+	{
+		writer.Write(fields, FIELD_BITS);
+		if (fields & FIELD_POSITION)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				writer.WriteVarInt(int32_t(uint32_t(state.position[i]) - uint32_t(prev.position[i])));
+			}
+		}
+		if (fields & FIELD_ROTATION)
+		{
+			writer.Write(state.rotation, 32);
+		}
+		if (fields & FIELD_SCALE)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				writer.WriteVarInt(int32_t(uint32_t(state.scale[i]) - uint32_t(prev.scale[i])));
+			}
+		}
+		if (fields & FIELD_LAYER)
+		{
+			writer.Write(state.layerMask, 32);
+		}
+		if (fields & FIELD_NAME)
+		{
+			const NameComponent* name = scene.names.GetComponent(state.entity);
+			const uint32_t length = name == nullptr ? 0 : std::min((uint32_t)name->name.length(), MAX_NAME_LENGTH);
+			writer.Write(length, 8);
+			for (uint32_t i = 0; i < length; ++i)
+			{
+				writer.Write(uint8_t(name->name[i]), 8);
+			}
+		}
+	}
+
+	// Reads the fields that were written by WriteFields() into state, which must hold the previous state. Returns the field mask
+	uint32_t ReadFields(BitReader& reader, EntityState& state, std::string& name)
+	{
+		const uint32_t fields = reader.Read(FIELD_BITS);
+		if (fields & FIELD_POSITION)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				state.position[i] = int32_t(uint32_t(state.position[i]) + uint32_t(reader.ReadVarInt()));
+			}
+		}
+		if (fields & FIELD_ROTATION)
+		{
+			state.rotation = reader.Read(32);
+		}
+		if (fields & FIELD_SCALE)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				state.scale[i] = int32_t(uint32_t(state.scale[i]) + uint32_t(reader.ReadVarInt()));
+			}
+		}
+		if (fields & FIELD_LAYER)
+		{
+			state.layerMask = reader.Read(32);
+		}
+		if (fields & FIELD_NAME)
+		{
+			const uint32_t length = reader.Read(8);
+			name.resize(length);
+			for (uint32_t i = 0; i < length; ++i)
+			{
+				name[i] = (char)reader.Read(8);
+			}
+			state.nameHash = HashName(name);
+		}
+		return fields;
+	}
+
+	void ApplyState(Scene& scene, const Settings& settings, const EntityState& state, uint32_t fields, const std::string& name)
+	{
+		TransformComponent* transform = scene.transforms.GetComponent(state.entity);
+		if (transform == nullptr)
+		{
+			transform = &scene.transforms.Create(state.entity);
+		}
+		if (fields & (FIELD_POSITION | FIELD_ROTATION | FIELD_SCALE))
+		{
+			transform->translation_local = XMFLOAT3(
+				state.position[0] * settings.positionPrecision,
+				state.position[1] * settings.positionPrecision,
+				state.position[2] * settings.positionPrecision
+			);
+			transform->rotation_local = UnpackQuaternion(state.rotation);
+			transform->scale_local = XMFLOAT3(
+				state.scale[0] * settings.scalePrecision,
+				state.scale[1] * settings.scalePrecision,
+				state.scale[2] * settings.scalePrecision
+			);
+			transform->SetDirty();
+		}
+		if (fields & FIELD_LAYER)
+		{
+			LayerComponent* layer = scene.layers.GetComponent(state.entity);
+			if (layer == nullptr)
+			{
+				layer = &scene.layers.Create(state.entity);
+			}
+			layer->layerMask = state.layerMask;
+		}
+		if (fields & FIELD_NAME)
+		{
+			NameComponent* component = scene.names.GetComponent(state.entity);
+			if (component == nullptr)
+			{
+				component = &scene.names.Create(state.entity);
+			}
+			component->name = name;
+		}
+	}
+
+
+	void Server::Update(const Scene& scene, const wiNetwork::Socket* sock)
+	{
+		wiTimer timer;
+
+		ProcessAcknowledgements(sock);
+
+		// Take the snapshot:
+		timer.record();
+		Snapshot& snapshot = history[sequence % SNAPSHOT_HISTORY];
+		snapshot.sequence = sequence;
+		snapshot.valid = true;
+		snapshot.states.resize(scene.transforms.GetCount());
+
+		wiJobSystem::context ctx;
+		wiJobSystem::Dispatch(ctx, (uint32_t)scene.transforms.GetCount(), 256, [&](wiJobArgs args) {
+			const TransformComponent& transform = scene.transforms[args.jobIndex];
+			EntityState& state = snapshot.states[args.jobIndex];
+			state.entity = scene.transforms.GetEntity(args.jobIndex);
+			state.position[0] = QuantizeFixed(transform.translation_local.x, settings.positionPrecision);
+			state.position[1] = QuantizeFixed(transform.translation_local.y, settings.positionPrecision);
+			state.position[2] = QuantizeFixed(transform.translation_local.z, settings.positionPrecision);
+			state.rotation = PackQuaternion(transform.rotation_local);
+			state.scale[0] = QuantizeFixed(transform.scale_local.x, settings.scalePrecision);
+			state.scale[1] = QuantizeFixed(transform.scale_local.y, settings.scalePrecision);
+			state.scale[2] = QuantizeFixed(transform.scale_local.z, settings.scalePrecision);
+			const LayerComponent* layer = scene.layers.GetComponent(state.entity);
+			state.layerMask = layer == nullptr ? ~0u : layer->GetLayerMask();
+			const NameComponent* name = scene.names.GetComponent(state.entity);
+			state.nameHash = name == nullptr ? 0 : HashName(name->name);
+			state.worldPosition = transform.GetPosition();
+		});
+		wiJobSystem::Wait(ctx);
+
+		// Deltas are computed by walking the snapshots in entity order:
+		std::sort(snapshot.states.begin(), snapshot.states.end(), [](const EntityState& a, const EntityState& b) {
+			return a.entity < b.entity;
+		});
+		statistics.entityCount = (uint32_t)snapshot.states.size();
+		statistics.snapshotTime = timer.elapsed();
+
+		// Encode the deltas for every client:
+		timer.record();
+		wiJobSystem::Dispatch(ctx, (uint32_t)clients.size(), 1, [&](wiJobArgs args) {
+			EncodeDelta(scene, snapshot, clients[args.jobIndex]);
+		});
+		wiJobSystem::Wait(ctx);
+
+		statistics.recordCount = 0;
+		statistics.packetCount = 0;
+		statistics.byteCount = 0;
+		std::vector<wiNetwork::Message> messages;
+		for (auto& client : clients)
+		{
+			for (auto& packet : client.packets)
+			{
+				wiNetwork::Message message;
+				message.connection = client.connection;
+				message.data = packet.data();
+				message.dataSize = packet.size();
+				messages.push_back(message);
+				statistics.byteCount += packet.size();
+			}
+			statistics.recordCount += client.recordCount;
+		}
+		statistics.packetCount = wiNetwork::SendBatch(sock, messages.data(), (uint32_t)messages.size());
+		statistics.encodeTime = timer.elapsed();
+
+		sequence++;
+	}
+
+	void Server::ProcessAcknowledgements(const wiNetwork::Socket* sock)
+	{
+		for (auto& client : clients)
+		{
+			client.idleUpdates++;
+		}
+
+		received.resize(256);
+		while (true)
+		{
+			const uint32_t count = wiNetwork::ReceiveBatch(sock, received.data(), (uint32_t)received.size());
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const wiNetwork::Packet& packet = received[i];
+				if (packet.dataSize != sizeof(AcknowledgementPacket) || packet.data[0] != PACKET_ACKNOWLEDGEMENT)
+				{
+					continue;
+				}
+				AcknowledgementPacket acknowledgement;
+				memcpy(&acknowledgement, packet.data, sizeof(acknowledgement));
+
+				auto it = std::find_if(clients.begin(), clients.end(), [&](const ClientState& client) {
+					return client.connection.ipaddress == packet.connection.ipaddress && client.connection.port == packet.connection.port;
+				});
+				if (it == clients.end())
+				{
+					clients.emplace_back();
+					clients.back().connection = packet.connection;
+					it = clients.end() - 1;
+				}
+				ClientState& client = *it;
+				client.idleUpdates = 0;
+				client.interest.position = acknowledgement.interestPosition;
+				client.interest.radius = acknowledgement.interestRadius;
+				client.interest.layerMask = acknowledgement.interestLayerMask;
+
+				if (acknowledgement.hasSequence)
+				{
+					for (uint32_t j = 0; j <= 32; ++j)
+					{
+						if (j > 0 && (acknowledgement.previousBits & (1u << (j - 1))) == 0)
+						{
+							continue;
+						}
+						const uint16_t acknowledged = uint16_t(acknowledgement.sequence - j);
+						ClientSnapshot& sent = client.history[acknowledged % SNAPSHOT_HISTORY];
+						if (sent.valid && sent.sequence == acknowledged)
+						{
+							sent.acknowledged = true;
+						}
+					}
+				}
+			}
+			wiNetwork::ReleasePackets(sock, received.data(), count);
+			if (count < received.size())
+			{
+				break;
+			}
+		}
+
+		clients.erase(std::remove_if(clients.begin(), clients.end(), [&](const ClientState& client) {
+			return client.idleUpdates > clientTimeout;
+		}), clients.end());
+	}
+
+	void Server::EncodeDelta(const Scene& scene, const Snapshot& snapshot, ClientState& client)
+	{
+		// Select the entities that the client is interested in:
+		ClientSnapshot& sent = client.history[snapshot.sequence % SNAPSHOT_HISTORY];
+		sent.sequence = snapshot.sequence;
+		sent.valid = true;
+		sent.acknowledged = false;
+		sent.indices.clear();
+		const XMVECTOR interestPosition = XMLoadFloat3(&client.interest.position);
+		const float interestRadiusSq = client.interest.radius * client.interest.radius;
+		for (uint32_t i = 0; i < (uint32_t)snapshot.states.size(); ++i)
+		{
+			const EntityState& state = snapshot.states[i];
+			if ((state.layerMask & client.interest.layerMask) == 0)
+			{
+				continue;
+			}
+			const float distanceSq = XMVectorGetX(XMVector3LengthSq(XMLoadFloat3(&state.worldPosition) - interestPosition));
+			if (distanceSq <= interestRadiusSq)
+			{
+				sent.indices.push_back(i);
+			}
+		}
+
+		// The baseline is the newest acknowledged snapshot that is still in the history:
+		const ClientSnapshot* baseline = nullptr;
+		const Snapshot* baselineSnapshot = nullptr;
+		for (uint32_t i = 1; i < SNAPSHOT_HISTORY; ++i)
+		{
+			const uint16_t candidate = uint16_t(snapshot.sequence - i);
+			const ClientSnapshot& candidateSent = client.history[candidate % SNAPSHOT_HISTORY];
+			const Snapshot& candidateSnapshot = history[candidate % SNAPSHOT_HISTORY];
+			if (candidateSent.valid && candidateSent.acknowledged && candidateSent.sequence == candidate &&
+				candidateSnapshot.valid && candidateSnapshot.sequence == candidate)
+			{
+				baseline = &candidateSent;
+				baselineSnapshot = &candidateSnapshot;
+				break;
+			}
+		}
+
+		// Records are packed into packets that can be decoded independently:
+		client.packets.clear();
+		client.recordCount = 0;
+		BitWriter writer;
+		uint32_t packetRecordCount = 0;
+		int64_t previousIndex = -1; // baseline indices are delta coded within a packet
+		auto finish_packet = [&] {
+			std::vector<uint8_t>& packet = client.packets.back();
+			SnapshotHeader header = {};
+			header.type = PACKET_SNAPSHOT;
+			header.flags = baseline != nullptr ? SNAPSHOT_HAS_BASELINE : 0;
+			header.sequence = snapshot.sequence;
+			header.baseline = baseline != nullptr ? baseline->sequence : 0;
+			header.fragment = uint16_t(client.packets.size() - 1);
+			header.recordCount = (uint16_t)packetRecordCount;
+			memcpy(packet.data(), &header, sizeof(header));
+			packet.resize(sizeof(header) + (writer.position + 7) / 8);
+		};
+		auto begin_packet = [&] {
+			client.packets.emplace_back(wiNetwork::MAX_PACKET_SIZE + RECORD_OVERFLOW_BYTES);
+			writer = {};
+			writer.data = client.packets.back().data() + sizeof(SnapshotHeader);
+			packetRecordCount = 0;
+			previousIndex = -1;
+		};
+		auto write_record = [&](auto write) {
+			const uint32_t start = writer.position;
+			write();
+			if (writer.position > RECORD_CAPACITY_BITS && packetRecordCount > 0)
+			{
+				writer.Rewind(start);
+				finish_packet();
+				begin_packet();
+				write();
+			}
+			packetRecordCount++;
+			client.recordCount++;
+		};
+		auto write_index = [&](uint32_t index) {
+			writer.WriteVarUint(uint32_t(index - (previousIndex + 1)));
+			previousIndex = index;
+		};
+
+		begin_packet();
+		const EntityState defaultState = GetDefaultState(settings);
+		const uint32_t baselineCount = baseline != nullptr ? (uint32_t)baseline->indices.size() : 0;
+		uint32_t baselineIndex = 0;
+		for (uint32_t index : sent.indices)
+		{
+			const EntityState& state = snapshot.states[index];
+
+			// Entities of the baseline that are not in the current snapshot are removed:
+			while (baselineIndex < baselineCount && baselineSnapshot->states[baseline->indices[baselineIndex]].entity < state.entity)
+			{
+				write_record([&] {
+					writer.Write(RECORD_REMOVE, 2);
+					write_index(baselineIndex);
+				});
+				baselineIndex++;
+			}
+
+			if (baselineIndex < baselineCount && baselineSnapshot->states[baseline->indices[baselineIndex]].entity == state.entity)
+			{
+				const EntityState& prev = baselineSnapshot->states[baseline->indices[baselineIndex]];
+				const uint32_t fields = ComputeChangedFields(settings, prev, state);
+				if (fields != 0)
+				{
+					write_record([&] {
+						writer.Write(RECORD_UPDATE, 2);
+						write_index(baselineIndex);
+						WriteFields(writer, scene, prev, state, fields);
+					});
+				}
+				baselineIndex++;
+			}
+			else
+			{
+				const uint32_t fields = ComputeChangedFields(settings, defaultState, state);
+				write_record([&] {
+					writer.Write(RECORD_CREATE, 2);
+					writer.Write64(state.entity);
+					WriteFields(writer, scene, defaultState, state, fields);
+				});
+			}
+		}
+		while (baselineIndex < baselineCount)
+		{
+			write_record([&] {
+				writer.Write(RECORD_REMOVE, 2);
+				write_index(baselineIndex);
+			});
+			baselineIndex++;
+		}
+		finish_packet();
+
+		// Every packet must know how many belong to the snapshot, even if there are no changes:
+		const uint16_t fragmentCount = (uint16_t)client.packets.size();
+		for (auto& packet : client.packets)
+		{
+			memcpy(packet.data() + offsetof(SnapshotHeader, fragmentCount), &fragmentCount, sizeof(fragmentCount));
+		}
+	}
+
+
+	void Client::Update(Scene& scene, const wiNetwork::Socket* sock, const wiNetwork::Connection& server)
+	{
+		wiTimer timer;
+		timer.record();
+
+		statistics.recordCount = 0;
+		statistics.packetCount = 0;
+		statistics.byteCount = 0;
+		statistics.snapshotTime = 0;
+
+		received.resize(256);
+		while (true)
+		{
+			const uint32_t count = wiNetwork::ReceiveBatch(sock, received.data(), (uint32_t)received.size());
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				statistics.packetCount++;
+				statistics.byteCount += received[i].dataSize;
+				ProcessSnapshotPacket(scene, received[i]);
+			}
+			wiNetwork::ReleasePackets(sock, received.data(), count);
+			if (count < received.size())
+			{
+				break;
+			}
+		}
+		statistics.encodeTime = timer.elapsed() - statistics.snapshotTime;
+
+		// Acknowledge the complete snapshots:
+		AcknowledgementPacket acknowledgement = {};
+		acknowledgement.type = PACKET_ACKNOWLEDGEMENT;
+		acknowledgement.hasSequence = anyCompleted ? 1 : 0;
+		acknowledgement.sequence = newestCompleted;
+		for (uint32_t i = 0; i < 32 && anyCompleted; ++i)
+		{
+			const uint16_t previous = uint16_t(newestCompleted - 1 - i);
+			const Snapshot& snapshot = history[previous % SNAPSHOT_HISTORY];
+			if (snapshot.valid && snapshot.sequence == previous)
+			{
+				acknowledgement.previousBits |= 1u << i;
+			}
+		}
+		acknowledgement.interestPosition = interest.position;
+		acknowledgement.interestRadius = interest.radius;
+		acknowledgement.interestLayerMask = interest.layerMask;
+		wiNetwork::Send(sock, &server, &acknowledgement, sizeof(acknowledgement));
+	}
+
+	void Client::ProcessSnapshotPacket(Scene& scene, const wiNetwork::Packet& packet)
+	{
+		if (packet.dataSize < sizeof(SnapshotHeader) || packet.data[0] != PACKET_SNAPSHOT)
+		{
+			return;
+		}
+		SnapshotHeader header;
+		memcpy(&header, packet.data, sizeof(header));
+		if (header.fragment >= header.fragmentCount)
+		{
+			return;
+		}
+		if (anyCompleted && !SequenceGreater(header.sequence, newestCompleted))
+		{
+			return; // a newer snapshot is already complete
+		}
+
+		const Snapshot* baseline = nullptr;
+		if (header.flags & SNAPSHOT_HAS_BASELINE)
+		{
+			baseline = &history[header.baseline % SNAPSHOT_HISTORY];
+			if (!baseline->valid || baseline->sequence != header.baseline)
+			{
+				return; // the baseline is too old, the server will stop using it when newer acknowledgements arrive
+			}
+		}
+
+		// Find or start the assembly of the snapshot:
+		Assembly* assembly = nullptr;
+		for (auto& candidate : assemblies)
+		{
+			if (candidate.active && candidate.sequence == header.sequence)
+			{
+				assembly = &candidate;
+				break;
+			}
+		}
+		if (assembly == nullptr)
+		{
+			for (auto& candidate : assemblies)
+			{
+				if (!candidate.active)
+				{
+					assembly = &candidate;
+					break;
+				}
+				if (assembly == nullptr || SequenceGreater(assembly->sequence, candidate.sequence))
+				{
+					assembly = &candidate; // replace the oldest one
+				}
+			}
+			assembly->sequence = header.sequence;
+			assembly->active = true;
+			assembly->fragmentCount = header.fragmentCount;
+			assembly->receivedCount = 0;
+			assembly->receivedFragments.assign(header.fragmentCount, false);
+			if (baseline != nullptr)
+			{
+				assembly->states = baseline->states;
+			}
+			else
+			{
+				assembly->states.clear();
+			}
+			assembly->removed.assign(assembly->states.size(), false);
+			assembly->added.clear();
+		}
+		if (assembly->fragmentCount != header.fragmentCount || assembly->receivedFragments[header.fragment])
+		{
+			return;
+		}
+
+		// Older packets that arrive late are only used to complete their snapshot, they don't overwrite newer state in the scene:
+		const bool apply = !anyApplied || !SequenceGreater(newestApplied, header.sequence);
+
+		BitReader reader;
+		reader.data = packet.data + sizeof(SnapshotHeader);
+		reader.size = uint32_t(packet.dataSize - sizeof(SnapshotHeader)) * 8;
+		const EntityState defaultState = GetDefaultState(settings);
+		std::string name;
+		int64_t previousIndex = -1;
+		for (uint32_t i = 0; i < header.recordCount && !reader.overflow; ++i)
+		{
+			const uint32_t record = reader.Read(2);
+			if (record == RECORD_CREATE)
+			{
+				EntityState state = defaultState;
+				state.entity = reader.Read64();
+				const uint32_t fields = ReadFields(reader, state, name);
+				if (reader.overflow || state.entity == INVALID_ENTITY)
+				{
+					break;
+				}
+				assembly->added.push_back(state);
+				if (apply)
+				{
+					// Fields that match the default state were not sent, but the transform is still written:
+					ApplyState(scene, settings, state, fields | FIELD_POSITION, name);
+					replicated.insert(state.entity);
+				}
+				statistics.recordCount++;
+				continue;
+			}
+
+			const uint64_t index = uint64_t(previousIndex + 1) + reader.ReadVarUint();
+			if (reader.overflow || index >= assembly->states.size())
+			{
+				reader.overflow = true;
+				break;
+			}
+			previousIndex = (int64_t)index;
+			EntityState& state = assembly->states[index];
+			if (record == RECORD_REMOVE)
+			{
+				assembly->removed[index] = true;
+				if (apply)
+				{
+					scene.Entity_Remove(state.entity);
+					replicated.erase(state.entity);
+				}
+			}
+			else
+			{
+				const uint32_t fields = ReadFields(reader, state, name);
+				if (!reader.overflow && apply)
+				{
+					ApplyState(scene, settings, state, fields, name);
+					replicated.insert(state.entity);
+				}
+			}
+			statistics.recordCount++;
+		}
+		if (reader.overflow)
+		{
+			// Malformed packet, the snapshot can't be completed:
+			assembly->active = false;
+			return;
+		}
+
+		if (apply)
+		{
+			anyApplied = true;
+			newestApplied = header.sequence;
+		}
+
+		assembly->receivedFragments[header.fragment] = true;
+		assembly->receivedCount++;
+		if (assembly->receivedCount < assembly->fragmentCount)
+		{
+			return;
+		}
+
+		// The snapshot is complete, it can be used as baseline from now on:
+		wiTimer timer;
+		timer.record();
+		Snapshot& snapshot = history[header.sequence % SNAPSHOT_HISTORY];
+		snapshot.sequence = header.sequence;
+		snapshot.valid = true;
+		snapshot.states.clear();
+		for (size_t i = 0; i < assembly->states.size(); ++i)
+		{
+			if (!assembly->removed[i])
+			{
+				snapshot.states.push_back(assembly->states[i]);
+			}
+		}
+		snapshot.states.insert(snapshot.states.end(), assembly->added.begin(), assembly->added.end());
+		std::sort(snapshot.states.begin(), snapshot.states.end(), [](const EntityState& a, const EntityState& b) {
+			return a.entity < b.entity;
+		});
+		assembly->active = false;
+
+		// Removals can't be expressed without a baseline, so the replicated entities are reconciled with the newest complete snapshot:
+		if (newestApplied == header.sequence)
+		{
+			for (auto it = replicated.begin(); it != replicated.end();)
+			{
+				const Entity entity = *it;
+				auto found = std::lower_bound(snapshot.states.begin(), snapshot.states.end(), entity, [](const EntityState& state, Entity value) {
+					return state.entity < value;
+				});
+				if (found != snapshot.states.end() && found->entity == entity)
+				{
+					++it;
+				}
+				else
+				{
+					scene.Entity_Remove(entity);
+					it = replicated.erase(it);
+				}
+			}
+		}
+
+		anyCompleted = true;
+		newestCompleted = header.sequence;
+		for (auto& other : assemblies)
+		{
+			if (other.active && !SequenceGreater(other.sequence, newestCompleted))
+			{
+				other.active = false;
+			}
+		}
+		statistics.snapshotTime += timer.elapsed();
+	}
+}
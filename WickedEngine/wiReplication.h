@@ -0,0 +1,155 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiNetwork.h"
+#include "wiScene.h"
+
+#include <vector>
+#include <unordered_set>
+
+// Scene state replication from a server scene to client scenes over wiNetwork
+//	The server sends snapshots of entity state as deltas against the last snapshot that was acknowledged by each client.
+//	Entities keep the same ID on the clients as in the server scene.
+//	A snapshot that is split into many packets can only become a baseline if all of them arrive, so use interest management to keep snapshots small on lossy connections.
+namespace wiReplication
+{
+	// Components that can be replicated
+	enum COMPONENT
+	{
+		COMPONENT_TRANSFORM = 1 << 0,	// local translation, rotation and scale
+		COMPONENT_LAYER = 1 << 1,
+		COMPONENT_NAME = 1 << 2,
+	};
+
+	// The server and client must use the same settings
+	struct Settings
+	{
+		uint32_t components = COMPONENT_TRANSFORM | COMPONENT_LAYER | COMPONENT_NAME;
+		float positionPrecision = 1.0f / 1024.0f;	// positions are sent as fixed point values with this step size
+		float scalePrecision = 1.0f / 1024.0f;		// scales are sent as fixed point values with this step size
+	};
+
+	// Describes which entities a client is interested in. It is sent to the server with every acknowledgement
+	struct Interest
+	{
+		XMFLOAT3 position = XMFLOAT3(0, 0, 0);
+		float radius = FLT_MAX;		// only entities within this distance from the position are replicated
+		uint32_t layerMask = ~0u;	// only entities with matching layer are replicated
+	};
+
+	// Quantized replicated state of an entity
+	struct EntityState
+	{
+		wiECS::Entity entity = wiECS::INVALID_ENTITY;
+		int32_t position[3] = {};
+		uint32_t rotation = 0;			// smallest three quaternion components
+		int32_t scale[3] = {};
+		uint32_t layerMask = ~0u;
+		uint32_t nameHash = 0;
+		XMFLOAT3 worldPosition = XMFLOAT3(0, 0, 0); // only used for interest management, not replicated
+	};
+
+	struct Statistics
+	{
+		uint32_t entityCount = 0;	// entities in the last snapshot
+		uint32_t recordCount = 0;	// entity records sent or received in the last update
+		uint32_t packetCount = 0;	// packets sent or received in the last update
+		size_t byteCount = 0;		// bytes sent or received in the last update
+		double snapshotTime = 0;	// milliseconds spent creating or applying the snapshot
+		double encodeTime = 0;		// milliseconds spent encoding or decoding the packets
+	};
+
+	static const uint32_t SNAPSHOT_HISTORY = 32;
+
+	class Server
+	{
+	public:
+		Settings settings;
+		// Clients are dropped after this many updates without acknowledgement
+		uint32_t clientTimeout = 600;
+
+		// Takes a snapshot of the scene and sends its delta to every client. Acknowledgements received since the last call are processed first.
+		//	A client is added when its first acknowledgement arrives. The scene's world transforms must be up to date for interest management.
+		void Update(const wiScene::Scene& scene, const wiNetwork::Socket* sock);
+
+		size_t GetClientCount() const { return clients.size(); }
+		const Statistics& GetStatistics() const { return statistics; }
+
+	private:
+		struct Snapshot
+		{
+			uint16_t sequence = 0;
+			bool valid = false;
+			std::vector<EntityState> states; // sorted by entity
+		};
+		struct ClientSnapshot
+		{
+			uint16_t sequence = 0;
+			bool valid = false;
+			bool acknowledged = false;
+			std::vector<uint32_t> indices; // the interesting entities of the server snapshot, sorted
+		};
+		struct ClientState
+		{
+			wiNetwork::Connection connection;
+			Interest interest;
+			uint32_t idleUpdates = 0;
+			ClientSnapshot history[SNAPSHOT_HISTORY];
+			std::vector<std::vector<uint8_t>> packets;
+			uint32_t recordCount = 0;
+		};
+
+		uint16_t sequence = 0;
+		Snapshot history[SNAPSHOT_HISTORY];
+		std::vector<ClientState> clients;
+		std::vector<wiNetwork::Packet> received;
+		Statistics statistics;
+
+		void ProcessAcknowledgements(const wiNetwork::Socket* sock);
+		void EncodeDelta(const wiScene::Scene& scene, const Snapshot& snapshot, ClientState& client);
+	};
+
+	class Client
+	{
+	public:
+		Settings settings;
+		Interest interest;
+
+		// Applies the received snapshots to the scene, then acknowledges them to the server.
+		//	The first call connects to the server. Entities that leave the interest of the client are removed from the scene.
+		void Update(wiScene::Scene& scene, const wiNetwork::Socket* sock, const wiNetwork::Connection& server);
+
+		const Statistics& GetStatistics() const { return statistics; }
+
+	private:
+		struct Snapshot
+		{
+			uint16_t sequence = 0;
+			bool valid = false;
+			std::vector<EntityState> states; // sorted by entity
+		};
+		// A snapshot can be split to multiple packets, it can be used as a delta baseline once all of them arrived
+		struct Assembly
+		{
+			uint16_t sequence = 0;
+			bool active = false;
+			uint32_t fragmentCount = 0;
+			uint32_t receivedCount = 0;
+			std::vector<bool> receivedFragments;
+			std::vector<EntityState> states;	// starts as a copy of the baseline, indexed by baseline index
+			std::vector<bool> removed;
+			std::vector<EntityState> added;
+		};
+
+		bool anyCompleted = false;
+		uint16_t newestCompleted = 0;
+		bool anyApplied = false;
+		uint16_t newestApplied = 0;
+		Snapshot history[SNAPSHOT_HISTORY];
+		Assembly assemblies[4];
+		std::unordered_set<wiECS::Entity> replicated; // entities that were created in the scene by replication
+		std::vector<wiNetwork::Packet> received;
+		Statistics statistics;
+
+		void ProcessSnapshotPacket(wiScene::Scene& scene, const wiNetwork::Packet& packet);
+	};
+}
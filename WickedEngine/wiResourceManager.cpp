@@ -2,11 +2,14 @@
 #include "wiRenderer.h"
 #include "wiHelper.h"
 #include "wiTextureHelper.h"
+#include "wiTextureCooker.h"
+#include "wiJobSystem.h"
 
 #include "Utility/stb_image.h"
 #include "Utility/tinyddsloader.h"
 
 #include <algorithm>
+#include <unordered_set>
 
 using namespace wiGraphics;
 
@@ -39,7 +42,175 @@ namespace wiResourceManager
 		std::make_pair("WAV", wiResource::SOUND)
 	};
 
-	std::shared_ptr<wiResource> Load(const std::string& name)
+	// Creates a texture from the contents of a dds file, returns nullptr if it fails
+	Texture* CreateTextureDDS(std::vector<uint8_t>&& filedata, const std::string& name)
+	{
+		tinyddsloader::DDSFile dds;
+		auto result = dds.Load(std::move(filedata));
+
+		if (result == tinyddsloader::Result::Success)
+		{
+			TextureDesc desc;
+			desc.ArraySize = 1;
+			desc.BindFlags = BIND_SHADER_RESOURCE;
+			desc.CPUAccessFlags = 0;
+			desc.Width = dds.GetWidth();
+			desc.Height = dds.GetHeight();
+			desc.Depth = dds.GetDepth();
+			desc.MipLevels = dds.GetMipCount();
+			desc.ArraySize = dds.GetArraySize();
+			desc.MiscFlags = 0;
+			desc.Usage = USAGE_IMMUTABLE;
+			desc.Format = FORMAT_R8G8B8A8_UNORM;
+
+			if (dds.IsCubemap())
+			{
+				desc.MiscFlags |= RESOURCE_MISC_TEXTURECUBE;
+			}
+
+			auto ddsFormat = dds.GetFormat();
+
+			switch (ddsFormat)
+			{
+			case tinyddsloader::DDSFile::DXGIFormat::R32G32B32A32_Float: desc.Format = FORMAT_R32G32B32A32_FLOAT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32G32B32A32_UInt: desc.Format = FORMAT_R32G32B32A32_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32G32B32A32_SInt: desc.Format = FORMAT_R32G32B32A32_SINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32G32B32_Float: desc.Format = FORMAT_R32G32B32_FLOAT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32G32B32_UInt: desc.Format = FORMAT_R32G32B32_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32G32B32_SInt: desc.Format = FORMAT_R32G32B32_SINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16G16B16A16_Float: desc.Format = FORMAT_R16G16B16A16_FLOAT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16G16B16A16_UNorm: desc.Format = FORMAT_R16G16B16A16_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16G16B16A16_UInt: desc.Format = FORMAT_R16G16B16A16_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16G16B16A16_SNorm: desc.Format = FORMAT_R16G16B16A16_SNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16G16B16A16_SInt: desc.Format = FORMAT_R16G16B16A16_SINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32G32_Float: desc.Format = FORMAT_R32G32_FLOAT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32G32_UInt: desc.Format = FORMAT_R32G32_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32G32_SInt: desc.Format = FORMAT_R32G32_SINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R10G10B10A2_UNorm: desc.Format = FORMAT_R10G10B10A2_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R10G10B10A2_UInt: desc.Format = FORMAT_R10G10B10A2_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R11G11B10_Float: desc.Format = FORMAT_R11G11B10_FLOAT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::B8G8R8A8_UNorm: desc.Format = FORMAT_B8G8R8A8_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::B8G8R8A8_UNorm_SRGB: desc.Format = FORMAT_B8G8R8A8_UNORM_SRGB; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8G8B8A8_UNorm: desc.Format = FORMAT_R8G8B8A8_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8G8B8A8_UNorm_SRGB: desc.Format = FORMAT_R8G8B8A8_UNORM_SRGB; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8G8B8A8_UInt: desc.Format = FORMAT_R8G8B8A8_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8G8B8A8_SNorm: desc.Format = FORMAT_R8G8B8A8_SNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8G8B8A8_SInt: desc.Format = FORMAT_R8G8B8A8_SINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16G16_Float: desc.Format = FORMAT_R16G16_FLOAT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16G16_UNorm: desc.Format = FORMAT_R16G16_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16G16_UInt: desc.Format = FORMAT_R16G16_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16G16_SNorm: desc.Format = FORMAT_R16G16_SNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16G16_SInt: desc.Format = FORMAT_R16G16_SINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::D32_Float: desc.Format = FORMAT_D32_FLOAT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32_Float: desc.Format = FORMAT_R32_FLOAT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32_UInt: desc.Format = FORMAT_R32_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R32_SInt: desc.Format = FORMAT_R32_SINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8G8_UNorm: desc.Format = FORMAT_R8G8_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8G8_UInt: desc.Format = FORMAT_R8G8_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8G8_SNorm: desc.Format = FORMAT_R8G8_SNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8G8_SInt: desc.Format = FORMAT_R8G8_SINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16_Float: desc.Format = FORMAT_R16_FLOAT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::D16_UNorm: desc.Format = FORMAT_D16_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16_UNorm: desc.Format = FORMAT_R16_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16_UInt: desc.Format = FORMAT_R16_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16_SNorm: desc.Format = FORMAT_R16_SNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R16_SInt: desc.Format = FORMAT_R16_SINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8_UNorm: desc.Format = FORMAT_R8_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8_UInt: desc.Format = FORMAT_R8_UINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8_SNorm: desc.Format = FORMAT_R8_SNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::R8_SInt: desc.Format = FORMAT_R8_SINT; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC1_UNorm: desc.Format = FORMAT_BC1_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC1_UNorm_SRGB: desc.Format = FORMAT_BC1_UNORM_SRGB; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC2_UNorm: desc.Format = FORMAT_BC2_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC2_UNorm_SRGB: desc.Format = FORMAT_BC2_UNORM_SRGB; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC3_UNorm: desc.Format = FORMAT_BC3_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC3_UNorm_SRGB: desc.Format = FORMAT_BC3_UNORM_SRGB; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC4_UNorm: desc.Format = FORMAT_BC4_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC4_SNorm: desc.Format = FORMAT_BC4_SNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC5_UNorm: desc.Format = FORMAT_BC5_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC5_SNorm: desc.Format = FORMAT_BC5_SNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC7_UNorm: desc.Format = FORMAT_BC7_UNORM; break;
+			case tinyddsloader::DDSFile::DXGIFormat::BC7_UNorm_SRGB: desc.Format = FORMAT_BC7_UNORM_SRGB; break;
+			default:
+				assert(0); // incoming format is not supported 
+				break;
+			}
+
+			std::vector<SubresourceData> InitData;
+			for (uint32_t arrayIndex = 0; arrayIndex < desc.ArraySize; ++arrayIndex)
+			{
+				for (uint32_t mip = 0; mip < desc.MipLevels; ++mip)
+				{
+					auto imageData = dds.GetImageData(mip, arrayIndex);
+					SubresourceData subresourceData;
+					subresourceData.pSysMem = imageData->m_mem;
+					subresourceData.SysMemPitch = imageData->m_memPitch;
+					subresourceData.SysMemSlicePitch = imageData->m_memSlicePitch;
+					InitData.push_back(subresourceData);
+				}
+			}
+
+			auto dim = dds.GetTextureDimension();
+			switch (dim)
+			{
+			case tinyddsloader::DDSFile::TextureDimension::Texture1D:
+			{
+				desc.type = TextureDesc::TEXTURE_1D;
+			}
+			break;
+			case tinyddsloader::DDSFile::TextureDimension::Texture2D:
+			{
+				desc.type = TextureDesc::TEXTURE_2D;
+			}
+			break;
+			case tinyddsloader::DDSFile::TextureDimension::Texture3D:
+			{
+				desc.type = TextureDesc::TEXTURE_3D;
+			}
+			break;
+			default:
+				assert(0);
+				break;
+			}
+
+			Texture* image = new Texture;
+			wiRenderer::GetDevice()->CreateTexture(&desc, InitData.data(), image);
+			wiRenderer::GetDevice()->SetName(image, name.c_str());
+			return image;
+		}
+
+		return nullptr;
+	}
+
+	wiJobSystem::context cookingContext;
+	std::unordered_set<std::string> cookingFiles; // cooks that are in progress, protected by locker
+
+	// Cooks a copy of the image on the job system and writes the result to the cache
+	void CookInBackground(const std::string& cookedFileName, const uint8_t* rgba, uint32_t width, uint32_t height, const wiTextureCooker::CookParams& params)
+	{
+		locker.lock();
+		const bool started = cookingFiles.insert(cookedFileName).second;
+		locker.unlock();
+		if (!started)
+		{
+			return;
+		}
+
+		auto image = std::make_shared<std::vector<uint8_t>>(rgba, rgba + size_t(width) * size_t(height) * 4);
+		wiJobSystem::Execute(cookingContext, [=](wiJobArgs args) {
+			std::vector<uint8_t> cooked;
+			if (wiTextureCooker::Cook(image->data(), width, height, params, cooked))
+			{
+				wiHelper::DirectoryCreate(wiTextureCooker::GetCacheDirectory());
+				wiHelper::FileWrite(cookedFileName, cooked.data(), cooked.size());
+			}
+			locker.lock();
+			cookingFiles.erase(cookedFileName);
+			locker.unlock();
+		});
+	}
+
+	std::shared_ptr<wiResource> Load(const std::string& name, uint32_t flags)
 	{
 		locker.lock();
 		std::weak_ptr<wiResource>& weak_resource = resources[name];
@@ -88,153 +259,37 @@ namespace wiResourceManager
 		{
 			if (!ext.compare(std::string("DDS")))
 			{
-				// Load dds
-
-				tinyddsloader::DDSFile dds;
-				auto result = dds.Load(std::move(filedata));
+				success = CreateTextureDDS(std::move(filedata), name);
+				assert(success != nullptr); // failed to load DDS
+			}
+			else
+			{
+				// png, tga, jpg, etc. loader:
 
-				if (result == tinyddsloader::Result::Success)
+				// Prefer the block compressed texture from the cooked file cache:
+				const bool cooking = (flags & ALLOW_COOKING) && wiTextureCooker::IsEnabled();
+				const wiTextureCooker::CookParams cookParams = wiTextureCooker::GuessParams(name);
+				const std::string cookedFileName = cooking ? wiTextureCooker::GetCachedFileName(filedata, cookParams) : "";
+				if (cooking && wiHelper::FileExists(cookedFileName))
 				{
-					TextureDesc desc;
-					desc.ArraySize = 1;
-					desc.BindFlags = BIND_SHADER_RESOURCE;
-					desc.CPUAccessFlags = 0;
-					desc.Height = dds.GetWidth();
-					desc.Width = dds.GetHeight();
-					desc.Depth = dds.GetDepth();
-					desc.MipLevels = dds.GetMipCount();
-					desc.ArraySize = dds.GetArraySize();
-					desc.MiscFlags = 0;
-					desc.Usage = USAGE_IMMUTABLE;
-					desc.Format = FORMAT_R8G8B8A8_UNORM;
-
-					if (dds.IsCubemap())
-					{
-						desc.MiscFlags |= RESOURCE_MISC_TEXTURECUBE;
-					}
-
-					auto ddsFormat = dds.GetFormat();
-
-					switch (ddsFormat)
-					{
-					case tinyddsloader::DDSFile::DXGIFormat::R32G32B32A32_Float: desc.Format = FORMAT_R32G32B32A32_FLOAT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32G32B32A32_UInt: desc.Format = FORMAT_R32G32B32A32_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32G32B32A32_SInt: desc.Format = FORMAT_R32G32B32A32_SINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32G32B32_Float: desc.Format = FORMAT_R32G32B32_FLOAT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32G32B32_UInt: desc.Format = FORMAT_R32G32B32_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32G32B32_SInt: desc.Format = FORMAT_R32G32B32_SINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16G16B16A16_Float: desc.Format = FORMAT_R16G16B16A16_FLOAT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16G16B16A16_UNorm: desc.Format = FORMAT_R16G16B16A16_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16G16B16A16_UInt: desc.Format = FORMAT_R16G16B16A16_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16G16B16A16_SNorm: desc.Format = FORMAT_R16G16B16A16_SNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16G16B16A16_SInt: desc.Format = FORMAT_R16G16B16A16_SINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32G32_Float: desc.Format = FORMAT_R32G32_FLOAT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32G32_UInt: desc.Format = FORMAT_R32G32_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32G32_SInt: desc.Format = FORMAT_R32G32_SINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R10G10B10A2_UNorm: desc.Format = FORMAT_R10G10B10A2_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R10G10B10A2_UInt: desc.Format = FORMAT_R10G10B10A2_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R11G11B10_Float: desc.Format = FORMAT_R11G11B10_FLOAT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::B8G8R8A8_UNorm: desc.Format = FORMAT_B8G8R8A8_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::B8G8R8A8_UNorm_SRGB: desc.Format = FORMAT_B8G8R8A8_UNORM_SRGB; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8G8B8A8_UNorm: desc.Format = FORMAT_R8G8B8A8_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8G8B8A8_UNorm_SRGB: desc.Format = FORMAT_R8G8B8A8_UNORM_SRGB; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8G8B8A8_UInt: desc.Format = FORMAT_R8G8B8A8_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8G8B8A8_SNorm: desc.Format = FORMAT_R8G8B8A8_SNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8G8B8A8_SInt: desc.Format = FORMAT_R8G8B8A8_SINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16G16_Float: desc.Format = FORMAT_R16G16_FLOAT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16G16_UNorm: desc.Format = FORMAT_R16G16_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16G16_UInt: desc.Format = FORMAT_R16G16_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16G16_SNorm: desc.Format = FORMAT_R16G16_SNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16G16_SInt: desc.Format = FORMAT_R16G16_SINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::D32_Float: desc.Format = FORMAT_D32_FLOAT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32_Float: desc.Format = FORMAT_R32_FLOAT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32_UInt: desc.Format = FORMAT_R32_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R32_SInt: desc.Format = FORMAT_R32_SINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8G8_UNorm: desc.Format = FORMAT_R8G8_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8G8_UInt: desc.Format = FORMAT_R8G8_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8G8_SNorm: desc.Format = FORMAT_R8G8_SNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8G8_SInt: desc.Format = FORMAT_R8G8_SINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16_Float: desc.Format = FORMAT_R16_FLOAT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::D16_UNorm: desc.Format = FORMAT_D16_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16_UNorm: desc.Format = FORMAT_R16_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16_UInt: desc.Format = FORMAT_R16_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16_SNorm: desc.Format = FORMAT_R16_SNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R16_SInt: desc.Format = FORMAT_R16_SINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8_UNorm: desc.Format = FORMAT_R8_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8_UInt: desc.Format = FORMAT_R8_UINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8_SNorm: desc.Format = FORMAT_R8_SNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::R8_SInt: desc.Format = FORMAT_R8_SINT; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC1_UNorm: desc.Format = FORMAT_BC1_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC1_UNorm_SRGB: desc.Format = FORMAT_BC1_UNORM_SRGB; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC2_UNorm: desc.Format = FORMAT_BC2_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC2_UNorm_SRGB: desc.Format = FORMAT_BC2_UNORM_SRGB; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC3_UNorm: desc.Format = FORMAT_BC3_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC3_UNorm_SRGB: desc.Format = FORMAT_BC3_UNORM_SRGB; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC4_UNorm: desc.Format = FORMAT_BC4_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC4_SNorm: desc.Format = FORMAT_BC4_SNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC5_UNorm: desc.Format = FORMAT_BC5_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC5_SNorm: desc.Format = FORMAT_BC5_SNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC7_UNorm: desc.Format = FORMAT_BC7_UNORM; break;
-					case tinyddsloader::DDSFile::DXGIFormat::BC7_UNorm_SRGB: desc.Format = FORMAT_BC7_UNORM_SRGB; break;
-					default:
-						assert(0); // incoming format is not supported 
-						break;
-					}
-
-					std::vector<SubresourceData> InitData;
-					for (uint32_t arrayIndex = 0; arrayIndex < desc.ArraySize; ++arrayIndex)
+					std::vector<uint8_t> cooked;
+					if (wiHelper::FileRead(cookedFileName, cooked))
 					{
-						for (uint32_t mip = 0; mip < desc.MipLevels; ++mip)
-						{
-							auto imageData = dds.GetImageData(mip, arrayIndex);
-							SubresourceData subresourceData;
-							subresourceData.pSysMem = imageData->m_mem;
-							subresourceData.SysMemPitch = imageData->m_memPitch;
-							subresourceData.SysMemSlicePitch = imageData->m_memSlicePitch;
-							InitData.push_back(subresourceData);
-						}
+						success = CreateTextureDDS(std::move(cooked), name);
 					}
-
-					auto dim = dds.GetTextureDimension();
-					switch (dim)
-					{
-					case tinyddsloader::DDSFile::TextureDimension::Texture1D:
-					{
-						desc.type = TextureDesc::TEXTURE_1D;
-					}
-					break;
-					case tinyddsloader::DDSFile::TextureDimension::Texture2D:
-					{
-						desc.type = TextureDesc::TEXTURE_2D;
-					}
-					break;
-					case tinyddsloader::DDSFile::TextureDimension::Texture3D:
-					{
-						desc.type = TextureDesc::TEXTURE_3D;
-					}
-					break;
-					default:
-						assert(0);
-						break;
-					}
-
-					Texture* image = new Texture;
-					wiRenderer::GetDevice()->CreateTexture(&desc, InitData.data(), image);
-					wiRenderer::GetDevice()->SetName(image, name.c_str());
-					success = image;
 				}
-				else assert(0); // failed to load DDS
-
-			}
-			else
-			{
-				// png, tga, jpg, etc. loader:
 
 				const int channelCount = 4;
-				int width, height, bpp;
-				unsigned char* rgb = stbi_load_from_memory(filedata.data(), (int)filedata.size(), &width, &height, &bpp, channelCount);
+				int width = 0, height = 0, bpp = 0;
+				unsigned char* rgb = success != nullptr ? nullptr : stbi_load_from_memory(filedata.data(), (int)filedata.size(), &width, &height, &bpp, channelCount);
+
+				if (rgb != nullptr && cooking)
+				{
+					// Not cooked yet, this load uses the uncompressed image and the cooked file will be used the next time:
+					CookInBackground(cookedFileName, rgb, (uint32_t)width, (uint32_t)height, cookParams);
+				}
 
-				if (rgb != nullptr)
+				if (rgb != nullptr && success == nullptr)
 				{
 					GraphicsDevice* device = wiRenderer::GetDevice();
 
@@ -28,8 +28,14 @@ struct wiResource
 
 namespace wiResourceManager
 {
+	enum FLAGS
+	{
+		EMPTY = 0,
+		ALLOW_COOKING = 1 << 0, // the image can be replaced by a block compressed texture from wiTextureCooker, if cooking is enabled
+	};
+
 	// Load a resource
-	std::shared_ptr<wiResource> Load(const std::string& name);
+	std::shared_ptr<wiResource> Load(const std::string& name, uint32_t flags = EMPTY);
 	// Check if a resource is currently loaded
 	bool Contains(const std::string& name);
 	// Register a pre-created resource
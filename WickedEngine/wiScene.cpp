@@ -7,9 +7,11 @@
 #include "wiRenderer.h"
 #include "wiJobSystem.h"
 #include "wiSpinLock.h"
+#include "wiProfiler.h"
 
 #include <functional>
 #include <unordered_map>
+#include <atomic>
 
 using namespace wiECS;
 using namespace wiGraphics;
@@ -304,6 +306,15 @@ namespace wiScene
 		{
 			retVal.options |= SHADERMATERIAL_OPTION_BIT_USE_WIND;
 		}
+		if (normalMap != nullptr && normalMap->texture != nullptr)
+		{
+			// Block compressed normal maps from wiTextureCooker only store x and y:
+			const FORMAT format = normalMap->texture->GetDesc().Format;
+			if (format == FORMAT_BC5_UNORM || format == FORMAT_BC5_SNORM)
+			{
+				retVal.options |= SHADERMATERIAL_OPTION_BIT_NORMALMAP_TWOCHANNEL;
+			}
+		}
 
 		retVal.baseColorAtlasMulAdd = XMFLOAT4(0, 0, 0, 0);
 		retVal.surfaceMapAtlasMulAdd = XMFLOAT4(0, 0, 0, 0);
@@ -313,10 +324,13 @@ namespace wiScene
 		return retVal;
 	}
 
+	static std::atomic<uint64_t> next_renderdata_revision{ 1 };
 	void MeshComponent::CreateRenderData()
 	{
 		GraphicsDevice* device = wiRenderer::GetDevice();
 
+		renderdata_revision = next_renderdata_revision.fetch_add(1);
+
 		// Create index buffer GPU data:
 		{
 			uint32_t counter = 0;
@@ -1166,8 +1180,12 @@ namespace wiScene
 
 	void Scene::Update(float dt)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("Scene::Update");
+
 		wiJobSystem::context ctx;
 
+		time += dt;
+
 		RunPreviousFrameTransformUpdateSystem(ctx);
 
 		RunAnimationUpdateSystem(ctx, dt);
@@ -1210,6 +1228,10 @@ namespace wiScene
 
 		wiJobSystem::Wait(ctx); // dependecies
 
+		RunParticleSimulationSystem(ctx, dt); // depends on force update system and particle update system
+
+		wiJobSystem::Wait(ctx);
+
 		// Merge parallel bounds computation (depends on object update system):
 		bounds = AABB();
 		for (auto& group_bound : parallel_bounds)
@@ -1269,6 +1291,8 @@ namespace wiScene
 		springs.Clear();
 
 		TLAS = RaytracingAccelerationStructure();
+		spring_groups = SpringSolverGroups();
+		time = 0;
 	}
 	void Scene::Merge(Scene& other)
 	{
@@ -1304,6 +1328,92 @@ namespace wiScene
 
 		bounds = AABB::Merge(bounds, other.bounds);
 	}
+	void Scene::CopyForRendering(const Scene& other)
+	{
+		// The mesh, material and particle copies are the most expensive, those are separate jobs:
+		wiJobSystem::context ctx;
+		wiJobSystem::Execute(ctx, [&](wiJobArgs args) {
+			meshes.Copy(other.meshes, [](MeshComponent& dst, const MeshComponent& src, bool same_entity) {
+				if (!same_entity || dst.renderdata_revision != src.renderdata_revision)
+				{
+					dst = src;
+					return;
+				}
+				// The vertex and index arrays didn't change since the previous copy, because those are only uploaded by CreateRenderData()
+				dst._flags = src._flags;
+				dst.subsets = src.subsets;
+				dst.tessellationFactor = src.tessellationFactor;
+				dst.armatureID = src.armatureID;
+				dst.terrain_material1 = src.terrain_material1;
+				dst.terrain_material2 = src.terrain_material2;
+				dst.terrain_material3 = src.terrain_material3;
+				dst.aabb = src.aabb;
+				dst.indexBuffer = src.indexBuffer;
+				dst.vertexBuffer_POS = src.vertexBuffer_POS;
+				dst.vertexBuffer_UV0 = src.vertexBuffer_UV0;
+				dst.vertexBuffer_UV1 = src.vertexBuffer_UV1;
+				dst.vertexBuffer_BON = src.vertexBuffer_BON;
+				dst.vertexBuffer_COL = src.vertexBuffer_COL;
+				dst.vertexBuffer_ATL = src.vertexBuffer_ATL;
+				dst.vertexBuffer_PRE = src.vertexBuffer_PRE;
+				dst.streamoutBuffer_POS = src.streamoutBuffer_POS;
+				dst.vertexBuffer_SUB = src.vertexBuffer_SUB;
+				dst.BLAS = src.BLAS;
+				dst.BLAS_build_pending = src.BLAS_build_pending;
+			});
+		});
+		wiJobSystem::Execute(ctx, [&](wiJobArgs args) {
+			materials.Copy(other.materials);
+			impostors.Copy(other.impostors);
+		});
+		wiJobSystem::Execute(ctx, [&](wiJobArgs args) {
+			emitters.Copy(other.emitters, [](wiEmittedParticle& dst, const wiEmittedParticle& src, bool same_entity) {
+				dst.CopyForRendering(src);
+			});
+			hairs.Copy(other.hairs, [](wiHairParticle& dst, const wiHairParticle& src, bool same_entity) {
+				dst.CopyForRendering(src, same_entity);
+			});
+		});
+		wiJobSystem::Execute(ctx, [&](wiJobArgs args) {
+			softbodies.Copy(other.softbodies, [](SoftBodyPhysicsComponent& dst, const SoftBodyPhysicsComponent& src, bool same_entity) {
+				// The vertex mappings and weights are only used by the physics engine, rendering needs the simulation result:
+				dst._flags = src._flags;
+				dst.mass = src.mass;
+				dst.friction = src.friction;
+				dst.physicsobject = src.physicsobject;
+				dst.worldMatrix = src.worldMatrix;
+				dst.vertex_positions_simulation = src.vertex_positions_simulation;
+				dst.aabb = src.aabb;
+			});
+			armatures.Copy(other.armatures);
+		});
+		wiJobSystem::Execute(ctx, [&](wiJobArgs args) {
+			layers.Copy(other.layers);
+			transforms.Copy(other.transforms);
+			prev_transforms.Copy(other.prev_transforms);
+			hierarchy.Copy(other.hierarchy);
+			objects.Copy(other.objects);
+			aabb_objects.Copy(other.aabb_objects);
+		});
+		wiJobSystem::Execute(ctx, [&](wiJobArgs args) {
+			lights.Copy(other.lights);
+			aabb_lights.Copy(other.aabb_lights);
+			cameras.Copy(other.cameras);
+			probes.Copy(other.probes);
+			aabb_probes.Copy(other.aabb_probes);
+			forces.Copy(other.forces);
+			decals.Copy(other.decals);
+			aabb_decals.Copy(other.aabb_decals);
+			weathers.Copy(other.weathers);
+		});
+
+		bounds = other.bounds;
+		weather = other.weather;
+		TLAS = other.TLAS;
+		time = other.time;
+
+		wiJobSystem::Wait(ctx);
+	}
 
 	void Scene::Entity_Remove(Entity entity)
 	{
@@ -1338,6 +1448,15 @@ namespace wiScene
 		inverse_kinematics.Remove(entity);
 		springs.Remove(entity);
 	}
+	void Scene::Entity_Remove(const Entity* entities, size_t count)
+	{
+		Component_Detach(entities, count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			Entity_Remove(entities[i]); // already detached, so this won't touch the hierarchy
+		}
+	}
 	Entity Scene::Entity_FindByName(const std::string& name)
 	{
 		for (size_t i = 0; i < names.GetCount(); ++i)
@@ -1658,24 +1777,32 @@ namespace wiScene
 	}
 	void Scene::Component_Detach(Entity entity)
 	{
-		const HierarchyComponent* parent = hierarchy.GetComponent(entity);
-
-		if (parent != nullptr)
+		Component_Detach(&entity, 1);
+	}
+	void Scene::Component_Detach(const Entity* entities, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
 		{
-			TransformComponent* transform = transforms.GetComponent(entity);
-			if (transform != nullptr)
-			{
-				transform->ApplyTransform();
-			}
+			const Entity entity = entities[i];
+			const HierarchyComponent* parent = hierarchy.GetComponent(entity);
 
-			LayerComponent* layer = layers.GetComponent(entity);
-			if (layer != nullptr)
+			if (parent != nullptr)
 			{
-				layer->layerMask = parent->layerMask_bind;
-			}
+				TransformComponent* transform = transforms.GetComponent(entity);
+				if (transform != nullptr)
+				{
+					transform->ApplyTransform();
+				}
 
-			hierarchy.Remove_KeepSorted(entity);
+				LayerComponent* layer = layers.GetComponent(entity);
+				if (layer != nullptr)
+				{
+					layer->layerMask = parent->layerMask_bind;
+				}
+			}
 		}
+
+		hierarchy.Remove_KeepSorted(entities, count);
 	}
 	void Scene::Component_DetachChildren(Entity parent)
 	{
@@ -1698,6 +1825,8 @@ namespace wiScene
 
 	void Scene::RunPreviousFrameTransformUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunPreviousFrameTransformUpdateSystem");
+
 		wiJobSystem::Dispatch(ctx, (uint32_t)prev_transforms.GetCount(), small_subtask_groupsize, [&](wiJobArgs args) {
 
 			PreviousFrameTransformComponent& prev_transform = prev_transforms[args.jobIndex];
@@ -1709,6 +1838,8 @@ namespace wiScene
 	}
 	void Scene::RunAnimationUpdateSystem(wiJobSystem::context& ctx, float dt)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunAnimationUpdateSystem");
+
 		for (size_t i = 0; i < animations.GetCount(); ++i)
 		{
 			AnimationComponent& animation = animations[i];
@@ -1862,6 +1993,8 @@ namespace wiScene
 	}
 	void Scene::RunTransformUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunTransformUpdateSystem");
+
 		wiJobSystem::Dispatch(ctx, (uint32_t)transforms.GetCount(), small_subtask_groupsize, [&](wiJobArgs args) {
 
 			TransformComponent& transform = transforms[args.jobIndex];
@@ -1870,6 +2003,8 @@ namespace wiScene
 	}
 	void Scene::RunHierarchyUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunHierarchyUpdateSystem");
+
 		// This needs serialized execution because there are dependencies enforced by component order!
 
 		for (size_t i = 0; i < hierarchy.GetCount(); ++i)
@@ -1896,171 +2031,339 @@ namespace wiScene
 	}
 	void Scene::RunSpringUpdateSystem(wiJobSystem::context& ctx, float dt)
 	{
-		static float time = 0;
-		time += dt;
-		const XMVECTOR windDir = XMLoadFloat3(&weather.windDirection);
-		const XMVECTOR gravity = XMVectorSet(0, -9.8f, 0, 0);
+		wiProfiler::ScopedRangeCPU profilerRange("RunSpringUpdateSystem");
+
+		SpringSolverGroups& groups = spring_groups;
 
-		for (size_t i = 0; i < springs.GetCount(); ++i)
+		// Check whether the cached spring groups are still valid (only array lookups, no hashing):
+		bool valid = !groups.offsets.empty() && groups.spring_count == springs.GetCount() && groups.hierarchy_count == hierarchy.GetCount();
+		for (size_t i = 0; valid && i < groups.springs.size(); ++i)
 		{
-			SpringComponent& spring = springs[i];
-			if (spring.IsDisabled())
-			{
-				continue;
-			}
-			Entity entity = springs.GetEntity(i);
-			TransformComponent* transform = transforms.GetComponent(entity);
-			if (transform == nullptr)
+			const Entity entity = springs.GetEntity(groups.springs[i]);
+			valid &= groups.transforms[i] < transforms.GetCount() && transforms.GetEntity(groups.transforms[i]) == entity;
+			if (valid && groups.hierarchies[i] != ~0u)
 			{
-				assert(0);
-				continue;
+				valid &= groups.hierarchies[i] < hierarchy.GetCount() && hierarchy.GetEntity(groups.hierarchies[i]) == entity;
+				if (valid)
+				{
+					const Entity parent = hierarchy[groups.hierarchies[i]].parentID;
+					valid &= groups.parent_transforms[i] == ~0u ?
+						!transforms.Contains(parent) :
+						groups.parent_transforms[i] < transforms.GetCount() && transforms.GetEntity(groups.parent_transforms[i]) == parent;
+				}
 			}
+		}
 
-			if (spring.IsResetting())
+		if (!valid)
+		{
+			// Group springs by the first ancestor that is not a spring, because a spring modifies its parent too:
+			std::unordered_map<Entity, uint32_t> group_lookup;
+			std::vector<std::vector<uint32_t>> group_springs;
+			for (size_t i = 0; i < springs.GetCount(); ++i)
 			{
-				spring.Reset(false);
-				spring.center_of_mass = transform->GetPosition();
-				spring.velocity = XMFLOAT3(0, 0, 0);
+				Entity anchor = springs.GetEntity(i);
+				for (int depth = 0; depth < 256; ++depth) // depth limit protects against broken hierarchy
+				{
+					const HierarchyComponent* hier = hierarchy.GetComponent(anchor);
+					if (hier == nullptr)
+					{
+						break;
+					}
+					anchor = hier->parentID;
+					if (!springs.Contains(anchor))
+					{
+						break;
+					}
+				}
+
+				auto it = group_lookup.find(anchor);
+				if (it == group_lookup.end())
+				{
+					it = group_lookup.insert(std::make_pair(anchor, (uint32_t)group_springs.size())).first;
+					group_springs.emplace_back();
+				}
+				group_springs[it->second].push_back((uint32_t)i);
 			}
 
-			const HierarchyComponent* hier = hierarchy.GetComponent(entity);
-			TransformComponent* parent_transform = hier == nullptr ? nullptr : transforms.GetComponent(hier->parentID);
-			if (parent_transform != nullptr)
+			groups.spring_count = springs.GetCount();
+			groups.hierarchy_count = hierarchy.GetCount();
+			groups.springs.clear();
+			groups.transforms.clear();
+			groups.hierarchies.clear();
+			groups.parent_transforms.clear();
+			groups.offsets.clear();
+			for (auto& group : group_springs)
 			{
-				// Spring hierarchy resolve depends on spring component order!
-				//	It works best when parent spring is located before child spring!
-				//	It will work the other way, but results will be less convincing
-				transform->UpdateTransform_Parented(*parent_transform);
+				groups.offsets.push_back((uint32_t)groups.springs.size());
+				for (uint32_t i : group)
+				{
+					const Entity entity = springs.GetEntity(i);
+					const size_t hier = hierarchy.GetIndex(entity);
+					groups.springs.push_back(i);
+					groups.transforms.push_back((uint32_t)transforms.GetIndex(entity));
+					groups.hierarchies.push_back((uint32_t)hier);
+					groups.parent_transforms.push_back(hier == (size_t)~0 ? ~0u : (uint32_t)transforms.GetIndex(hierarchy[hier].parentID));
+				}
 			}
+			groups.offsets.push_back((uint32_t)groups.springs.size());
+		}
 
-			const XMVECTOR position_current = transform->GetPositionV();
-			XMVECTOR position_prev = XMLoadFloat3(&spring.center_of_mass);
-			XMVECTOR force = (position_current - position_prev) * spring.stiffness;
+		const XMVECTOR windDir = XMLoadFloat3(&weather.windDirection);
+		const XMVECTOR gravity = XMVectorSet(0, -9.8f, 0, 0);
 
-			if (spring.wind_affection > 0)
-			{
-				force += std::sin(time * weather.windSpeed + XMVectorGetX(XMVector3Dot(position_current, windDir))) * windDir * spring.wind_affection;
-			}
-			if (spring.IsGravityEnabled())
+		// Groups don't share any transforms, so they can be solved in parallel
+		//	The spring state stays in the components instead of separate SoA arrays: each spring is read and written once per frame
+		//	together with two indexed transforms, so SoA copies would only add a gather and scatter (the editor can change parameters any time)
+		const uint32_t groupCount = (uint32_t)groups.offsets.size() - 1;
+		wiJobSystem::Dispatch(ctx, groupCount, small_subtask_groupsize, [&](wiJobArgs args) {
+
+			for (uint32_t i = groups.offsets[args.jobIndex]; i < groups.offsets[args.jobIndex + 1]; ++i)
 			{
-				force += gravity;
-			}
+				SpringComponent& spring = springs[groups.springs[i]];
+				if (spring.IsDisabled())
+				{
+					continue;
+				}
+				if (groups.transforms[i] == ~0u)
+				{
+					assert(0);
+					continue;
+				}
+				TransformComponent* transform = &transforms[groups.transforms[i]];
 
-			XMVECTOR velocity = XMLoadFloat3(&spring.velocity);
-			velocity += force * dt;
-			XMVECTOR position_target = position_prev + velocity * dt;
+				if (spring.IsResetting())
+				{
+					spring.Reset(false);
+					spring.center_of_mass = transform->GetPosition();
+					spring.velocity = XMFLOAT3(0, 0, 0);
+				}
 
-			if (parent_transform != nullptr)
-			{
-				const XMVECTOR position_parent = parent_transform->GetPositionV();
-				const XMVECTOR parent_to_child = position_current - position_parent;
-				const XMVECTOR parent_to_target = position_target - position_parent;
+				TransformComponent* parent_transform = groups.parent_transforms[i] == ~0u ? nullptr : &transforms[groups.parent_transforms[i]];
+				if (parent_transform != nullptr)
+				{
+					// Spring hierarchy resolve depends on spring component order!
+					//	It works best when parent spring is located before child spring!
+					//	It will work the other way, but results will be less convincing
+					transform->UpdateTransform_Parented(*parent_transform);
+				}
 
-				if (!spring.IsStretchEnabled())
+				const XMVECTOR position_current = transform->GetPositionV();
+				XMVECTOR position_prev = XMLoadFloat3(&spring.center_of_mass);
+				XMVECTOR force = (position_current - position_prev) * spring.stiffness;
+
+				if (spring.wind_affection > 0)
 				{
-					// Limit offset to keep distance from parent:
-					const XMVECTOR len = XMVector3Length(parent_to_child);
-					position_target = position_parent + XMVector3Normalize(parent_to_target) * len;
+					force += std::sin(time * weather.windSpeed + XMVectorGetX(XMVector3Dot(position_current, windDir))) * windDir * spring.wind_affection;
+				}
+				if (spring.IsGravityEnabled())
+				{
+					force += gravity;
+				}
+
+				XMVECTOR velocity = XMLoadFloat3(&spring.velocity);
+				velocity += force * dt;
+				XMVECTOR position_target = position_prev + velocity * dt;
+
+				if (parent_transform != nullptr)
+				{
+					const XMVECTOR position_parent = parent_transform->GetPositionV();
+					const XMVECTOR parent_to_child = position_current - position_parent;
+					const XMVECTOR parent_to_target = position_target - position_parent;
+
+					if (!spring.IsStretchEnabled())
+					{
+						// Limit offset to keep distance from parent:
+						const XMVECTOR len = XMVector3Length(parent_to_child);
+						position_target = position_parent + XMVector3Normalize(parent_to_target) * len;
+					}
+
+					// Parent rotation to point to new child position:
+					const XMVECTOR dir_parent_to_child = XMVector3Normalize(parent_to_child);
+					const XMVECTOR dir_parent_to_target = XMVector3Normalize(parent_to_target);
+					const XMVECTOR axis = XMVector3Normalize(XMVector3Cross(dir_parent_to_child, dir_parent_to_target));
+					const float angle = XMScalarACos(XMVectorGetX(XMVector3Dot(dir_parent_to_child, dir_parent_to_target))); // don't use std::acos!
+					const XMVECTOR Q = XMQuaternionNormalize(XMQuaternionRotationNormal(axis, angle));
+					TransformComponent saved_parent = *parent_transform;
+					saved_parent.ApplyTransform();
+					saved_parent.Rotate(Q);
+					saved_parent.UpdateTransform();
+					std::swap(saved_parent.world, parent_transform->world); // only store temporary result, not modifying actual local space!
 				}
 
-				// Parent rotation to point to new child position:
-				const XMVECTOR dir_parent_to_child = XMVector3Normalize(parent_to_child);
-				const XMVECTOR dir_parent_to_target = XMVector3Normalize(parent_to_target);
-				const XMVECTOR axis = XMVector3Normalize(XMVector3Cross(dir_parent_to_child, dir_parent_to_target));
-				const float angle = XMScalarACos(XMVectorGetX(XMVector3Dot(dir_parent_to_child, dir_parent_to_target))); // don't use std::acos!
-				const XMVECTOR Q = XMQuaternionNormalize(XMQuaternionRotationNormal(axis, angle));
-				TransformComponent saved_parent = *parent_transform;
-				saved_parent.ApplyTransform();
-				saved_parent.Rotate(Q);
-				saved_parent.UpdateTransform();
-				std::swap(saved_parent.world, parent_transform->world); // only store temporary result, not modifying actual local space!
+				XMStoreFloat3(&spring.center_of_mass, position_target);
+				velocity *= spring.damping;
+				XMStoreFloat3(&spring.velocity, velocity);
+				*((XMFLOAT3*)&transform->world._41) = spring.center_of_mass;
 			}
+		});
 
-			XMStoreFloat3(&spring.center_of_mass, position_target);
-			velocity *= spring.damping;
-			XMStoreFloat3(&spring.velocity, velocity);
-			*((XMFLOAT3*)&transform->world._41) = spring.center_of_mass;
-		}
+		wiJobSystem::Wait(ctx); // inverse kinematics and armatures depend on this
 	}
 	void Scene::RunInverseKinematicsUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunInverseKinematicsUpdateSystem");
+
+		// IK chains that don't share any transforms are solved in parallel, otherwise they are grouped and solved serially
+		//	Groups are found by union-find over the entities that an IK chain reads or writes
+		const size_t ikCount = inverse_kinematics.GetCount();
+		if (ikCount == 0)
+		{
+			return;
+		}
+		std::vector<uint32_t> group_parent(ikCount);
+		auto find_group = [&](uint32_t i) {
+			while (group_parent[i] != i)
+			{
+				group_parent[i] = group_parent[group_parent[i]];
+				i = group_parent[i];
+			}
+			return i;
+		};
+		std::unordered_map<Entity, uint32_t> entity_owner;
+		auto claim = [&](Entity entity, uint32_t i) {
+			auto it = entity_owner.find(entity);
+			if (it == entity_owner.end())
+			{
+				entity_owner[entity] = i;
+			}
+			else
+			{
+				const uint32_t a = find_group(it->second);
+				const uint32_t b = find_group(i);
+				group_parent[std::max(a, b)] = std::min(a, b); // lower index is the representative, to keep component order
+			}
+		};
+
 		bool recompute_hierarchy = false;
-		for (size_t i = 0; i < inverse_kinematics.GetCount(); ++i)
+		for (uint32_t i = 0; i < (uint32_t)ikCount; ++i)
 		{
+			group_parent[i] = i;
+
 			const InverseKinematicsComponent& ik = inverse_kinematics[i];
 			if (ik.IsDisabled())
 			{
 				continue;
 			}
 			Entity entity = inverse_kinematics.GetEntity(i);
-			TransformComponent* transform = transforms.GetComponent(entity);
-			TransformComponent* target = transforms.GetComponent(ik.target);
 			const HierarchyComponent* hier = hierarchy.GetComponent(entity);
-			if (transform == nullptr || target == nullptr || hier == nullptr)
+			if (!transforms.Contains(entity) || !transforms.Contains(ik.target) || hier == nullptr)
 			{
 				continue;
 			}
 
-			const XMVECTOR target_pos = target->GetPositionV();
-			for (uint32_t iteration = 0; iteration < ik.iteration_count; ++iteration)
+			if (ik.iteration_count > 0 && ik.chain_length > 0)
 			{
-				TransformComponent* stack[32] = {};
-				Entity parent_entity = hier->parentID;
-				TransformComponent* child_transform = transform;
-				for (uint32_t chain = 0; chain < std::min(ik.chain_length, (uint32_t)arraysize(stack)); ++chain)
+				recompute_hierarchy = true; // any IK will trigger a full transform hierarchy recompute step at the end(**)
+			}
+
+			claim(entity, i);
+			claim(ik.target, i);
+			Entity parent_entity = hier->parentID;
+			for (uint32_t chain = 0; chain < std::min(ik.chain_length, 32u); ++chain)
+			{
+				claim(parent_entity, i);
+				const HierarchyComponent* hier_parent = hierarchy.GetComponent(parent_entity);
+				if (hier_parent == nullptr)
 				{
-					recompute_hierarchy = true; // any IK will trigger a full transform hierarchy recompute step at the end(**)
-
-					// stack stores all traversed chain links so far:
-					stack[chain] = child_transform;
-
-					// Compute required parent rotation that moves ik transform closer to target transform:
-					TransformComponent* parent_transform = transforms.GetComponent(parent_entity);
-					const XMVECTOR parent_pos = parent_transform->GetPositionV();
-					const XMVECTOR dir_parent_to_ik = XMVector3Normalize(transform->GetPositionV() - parent_pos);
-					const XMVECTOR dir_parent_to_target = XMVector3Normalize(target_pos - parent_pos);
-					const XMVECTOR axis = XMVector3Normalize(XMVector3Cross(dir_parent_to_ik, dir_parent_to_target));
-					const float angle = XMScalarACos(XMVectorGetX(XMVector3Dot(dir_parent_to_ik, dir_parent_to_target)));
-					const XMVECTOR Q = XMQuaternionNormalize(XMQuaternionRotationNormal(axis, angle));
+					break;
+				}
+				parent_entity = hier_parent->parentID;
+			}
+			claim(parent_entity, i); // parent of the chain is read
+		}
 
-					// parent to world space:
-					parent_transform->ApplyTransform();
-					// rotate parent:
-					parent_transform->Rotate(Q);
-					parent_transform->UpdateTransform();
-					// parent back to local space (if parent has parent):
-					const HierarchyComponent* hier_parent = hierarchy.GetComponent(parent_entity);
-					if (hier_parent != nullptr)
-					{
-						Entity parent_of_parent_entity = hier_parent->parentID;
-						const TransformComponent* transform_parent_of_parent = transforms.GetComponent(parent_of_parent_entity);
-						XMMATRIX parent_of_parent_inverse = XMMatrixInverse(nullptr, XMLoadFloat4x4(&transform_parent_of_parent->world));
-						parent_transform->MatrixTransform(parent_of_parent_inverse);
-						// Do not call UpdateTransform() here, to keep parent world matrix in world space!
-					}
+		std::vector<std::vector<uint32_t>> groups;
+		std::vector<uint32_t> group_index(ikCount, ~0u);
+		for (uint32_t i = 0; i < (uint32_t)ikCount; ++i)
+		{
+			const uint32_t root = find_group(i);
+			if (group_index[root] == ~0u)
+			{
+				group_index[root] = (uint32_t)groups.size();
+				groups.emplace_back();
+			}
+			groups[group_index[root]].push_back(i);
+		}
 
-					// update chain from parent to children:
-					const TransformComponent* recurse_parent = parent_transform;
-					for (int recurse_chain = (int)chain; recurse_chain >= 0; --recurse_chain)
-					{
-						stack[recurse_chain]->UpdateTransform_Parented(*recurse_parent);
-						recurse_parent = stack[recurse_chain];
-					}
+		wiJobSystem::Dispatch(ctx, (uint32_t)groups.size(), 1, [&](wiJobArgs args) {
+
+			for (uint32_t i : groups[args.jobIndex])
+			{
+				const InverseKinematicsComponent& ik = inverse_kinematics[i];
+				if (ik.IsDisabled())
+				{
+					continue;
+				}
+				Entity entity = inverse_kinematics.GetEntity(i);
+				TransformComponent* transform = transforms.GetComponent(entity);
+				TransformComponent* target = transforms.GetComponent(ik.target);
+				const HierarchyComponent* hier = hierarchy.GetComponent(entity);
+				if (transform == nullptr || target == nullptr || hier == nullptr)
+				{
+					continue;
+				}
 
-					if (hier_parent == nullptr)
+				const XMVECTOR target_pos = target->GetPositionV();
+				for (uint32_t iteration = 0; iteration < ik.iteration_count; ++iteration)
+				{
+					TransformComponent* stack[32] = {};
+					Entity parent_entity = hier->parentID;
+					TransformComponent* child_transform = transform;
+					for (uint32_t chain = 0; chain < std::min(ik.chain_length, (uint32_t)arraysize(stack)); ++chain)
 					{
-						// chain root reached, exit
-						break;
-					}
+						// stack stores all traversed chain links so far:
+						stack[chain] = child_transform;
+
+						// Compute required parent rotation that moves ik transform closer to target transform:
+						TransformComponent* parent_transform = transforms.GetComponent(parent_entity);
+						const XMVECTOR parent_pos = parent_transform->GetPositionV();
+						const XMVECTOR dir_parent_to_ik = XMVector3Normalize(transform->GetPositionV() - parent_pos);
+						const XMVECTOR dir_parent_to_target = XMVector3Normalize(target_pos - parent_pos);
+						const XMVECTOR axis = XMVector3Normalize(XMVector3Cross(dir_parent_to_ik, dir_parent_to_target));
+						const float angle = XMScalarACos(XMVectorGetX(XMVector3Dot(dir_parent_to_ik, dir_parent_to_target)));
+						const XMVECTOR Q = XMQuaternionNormalize(XMQuaternionRotationNormal(axis, angle));
+
+						// parent to world space:
+						parent_transform->ApplyTransform();
+						// rotate parent:
+						parent_transform->Rotate(Q);
+						parent_transform->UpdateTransform();
+						// parent back to local space (if parent has parent):
+						const HierarchyComponent* hier_parent = hierarchy.GetComponent(parent_entity);
+						if (hier_parent != nullptr)
+						{
+							Entity parent_of_parent_entity = hier_parent->parentID;
+							const TransformComponent* transform_parent_of_parent = transforms.GetComponent(parent_of_parent_entity);
+							XMMATRIX parent_of_parent_inverse = XMMatrixInverse(nullptr, XMLoadFloat4x4(&transform_parent_of_parent->world));
+							parent_transform->MatrixTransform(parent_of_parent_inverse);
+							// Do not call UpdateTransform() here, to keep parent world matrix in world space!
+						}
 
-					// move up in the chain by one:
-					child_transform = parent_transform;
-					parent_entity = hier_parent->parentID;
-					assert(chain < (uint32_t)arraysize(stack) - 1); // if this is encountered, just extend stack array size
+						// update chain from parent to children:
+						const TransformComponent* recurse_parent = parent_transform;
+						for (int recurse_chain = (int)chain; recurse_chain >= 0; --recurse_chain)
+						{
+							stack[recurse_chain]->UpdateTransform_Parented(*recurse_parent);
+							recurse_parent = stack[recurse_chain];
+						}
+
+						if (hier_parent == nullptr)
+						{
+							// chain root reached, exit
+							break;
+						}
+
+						// move up in the chain by one:
+						child_transform = parent_transform;
+						parent_entity = hier_parent->parentID;
+						assert(chain < (uint32_t)arraysize(stack) - 1); // if this is encountered, just extend stack array size
 
+					}
 				}
 			}
-		}
+		});
+
+		wiJobSystem::Wait(ctx);
 
 		if (recompute_hierarchy)
 		{
@@ -2083,6 +2386,8 @@ namespace wiScene
 	}
 	void Scene::RunArmatureUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunArmatureUpdateSystem");
+
 		wiJobSystem::Dispatch(ctx, (uint32_t)armatures.GetCount(), 1, [&](wiJobArgs args) {
 
 			ArmatureComponent& armature = armatures[args.jobIndex];
@@ -2134,6 +2439,8 @@ namespace wiScene
 	}
 	void Scene::RunMaterialUpdateSystem(wiJobSystem::context& ctx, float dt)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunMaterialUpdateSystem");
+
 		wiJobSystem::Dispatch(ctx, (uint32_t)materials.GetCount(), small_subtask_groupsize, [&](wiJobArgs args) {
 
 			MaterialComponent& material = materials[args.jobIndex];
@@ -2157,6 +2464,8 @@ namespace wiScene
 	}
 	void Scene::RunImpostorUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunImpostorUpdateSystem");
+
 		wiJobSystem::Dispatch(ctx, (uint32_t)impostors.GetCount(), 1, [&](wiJobArgs args) {
 
 			ImpostorComponent& impostor = impostors[args.jobIndex];
@@ -2166,6 +2475,8 @@ namespace wiScene
 	}
 	void Scene::RunObjectUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunObjectUpdateSystem");
+
 		assert(objects.GetCount() == aabb_objects.GetCount());
 
 		parallel_bounds.clear();
@@ -2318,6 +2629,8 @@ namespace wiScene
 	}
 	void Scene::RunCameraUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunCameraUpdateSystem");
+
 		wiJobSystem::Dispatch(ctx, (uint32_t)cameras.GetCount(), small_subtask_groupsize, [&](wiJobArgs args) {
 
 			CameraComponent& camera = cameras[args.jobIndex];
@@ -2332,6 +2645,8 @@ namespace wiScene
 	}
 	void Scene::RunDecalUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunDecalUpdateSystem");
+
 		assert(decals.GetCount() == aabb_decals.GetCount());
 
 		wiJobSystem::Dispatch(ctx, (uint32_t)decals.GetCount(), small_subtask_groupsize, [&](wiJobArgs args) {
@@ -2366,6 +2681,8 @@ namespace wiScene
 	}
 	void Scene::RunProbeUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunProbeUpdateSystem");
+
 		assert(probes.GetCount() == aabb_probes.GetCount());
 
 		wiJobSystem::Dispatch(ctx, (uint32_t)probes.GetCount(), small_subtask_groupsize, [&](wiJobArgs args) {
@@ -2392,6 +2709,8 @@ namespace wiScene
 	}
 	void Scene::RunForceUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunForceUpdateSystem");
+
 		wiJobSystem::Dispatch(ctx, (uint32_t)forces.GetCount(), small_subtask_groupsize, [&](wiJobArgs args) {
 
 			ForceFieldComponent& force = forces[args.jobIndex];
@@ -2410,6 +2729,8 @@ namespace wiScene
 	}
 	void Scene::RunLightUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunLightUpdateSystem");
+
 		assert(lights.GetCount() == aabb_lights.GetCount());
 
 		wiJobSystem::Dispatch(ctx, (uint32_t)lights.GetCount(), small_subtask_groupsize, [&](wiJobArgs args) {
@@ -2465,6 +2786,8 @@ namespace wiScene
 	}
 	void Scene::RunParticleUpdateSystem(wiJobSystem::context& ctx, float dt)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunParticleUpdateSystem");
+
 		wiJobSystem::Dispatch(ctx, (uint32_t)emitters.GetCount(), small_subtask_groupsize, [&](wiJobArgs args) {
 
 			wiEmittedParticle& emitter = emitters[args.jobIndex];
@@ -2492,8 +2815,32 @@ namespace wiScene
 
 		});
 	}
+	void Scene::RunParticleSimulationSystem(wiJobSystem::context& ctx, float dt)
+	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunParticleSimulationSystem");
+
+		// Emitters that are simulated on the CPU, the emitters will also distribute their work internally:
+		wiJobSystem::Dispatch(ctx, (uint32_t)emitters.GetCount(), 1, [&](wiJobArgs args) {
+
+			wiEmittedParticle& emitter = emitters[args.jobIndex];
+			if (!emitter.IsCPUSimulationEnabled())
+				return;
+
+			Entity entity = emitters.GetEntity(args.jobIndex);
+			const TransformComponent* transform = transforms.GetComponent(entity);
+			const MaterialComponent* material = materials.GetComponent(entity);
+
+			if (transform != nullptr && material != nullptr)
+			{
+				const MeshComponent* mesh = meshes.GetComponent(emitter.meshID);
+				emitter.SimulateCPU(*transform, *material, mesh, forces, dt);
+			}
+		});
+	}
 	void Scene::RunWeatherUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunWeatherUpdateSystem");
+
 		if (weathers.GetCount() > 0)
 		{
 			weather = weathers[0];
@@ -2502,6 +2849,8 @@ namespace wiScene
 	}
 	void Scene::RunSoundUpdateSystem(wiJobSystem::context& ctx)
 	{
+		wiProfiler::ScopedRangeCPU profilerRange("RunSoundUpdateSystem");
+
 		const CameraComponent& camera = wiRenderer::GetCamera();
 		wiAudio::SoundInstance3D instance3D;
 		instance3D.listenerPos = camera.Eye;
@@ -303,6 +303,7 @@ namespace wiScene
 
 		wiGraphics::RaytracingAccelerationStructure BLAS;
 		bool BLAS_build_pending = true;
+		uint64_t renderdata_revision = 0; // unique for each CreateRenderData() call, the render scene copy only copies the vertex and index arrays when it changes
 
 		inline void SetRenderable(bool value) { if (value) { _flags |= RENDERABLE; } else { _flags &= ~RENDERABLE; } }
 		inline void SetDoubleSided(bool value) { if (value) { _flags |= DOUBLE_SIDED; } else { _flags &= ~DOUBLE_SIDED; } }
@@ -1135,6 +1136,20 @@ namespace wiScene
 		std::vector<AABB> parallel_bounds;
 		WeatherComponent weather;
 		wiGraphics::RaytracingAccelerationStructure TLAS;
+		float time = 0; // accumulated Update() time in seconds, for time dependent effects like wind
+
+		// Springs are solved in independent groups in parallel. A group contains the springs that share the same non-spring ancestor
+		//	These are rebuilt only when the spring or hierarchy layout changes
+		struct SpringSolverGroups
+		{
+			size_t spring_count = 0;
+			size_t hierarchy_count = 0;
+			std::vector<uint32_t> springs;				// spring component indices, grouped, keeping component order within groups
+			std::vector<uint32_t> transforms;			// transform component index of each spring
+			std::vector<uint32_t> hierarchies;			// hierarchy component index of each spring (or ~0u)
+			std::vector<uint32_t> parent_transforms;	// transform component index of each spring's parent (or ~0u)
+			std::vector<uint32_t> offsets;				// group i contains springs in range [offsets[i], offsets[i + 1])
+		} spring_groups;
 
 		// Update all components by a given timestep (in seconds):
 		void Update(float dt);
@@ -1142,9 +1157,15 @@ namespace wiScene
 		void Clear();
 		// Merge with an other scene.
 		void Merge(Scene& other);
+		// Copy the components that are needed to render the other scene, so that the other scene can be updated while this is rendered.
+		//	Names, physics, animation, sound, inverse kinematics and spring components are not copied
+		//	Mesh vertex and index arrays are only copied after MeshComponent::CreateRenderData() was called, the CPU particle simulation state is not copied
+		void CopyForRendering(const Scene& other);
 
 		// Removes a specific entity from the scene (if it exists):
 		void Entity_Remove(wiECS::Entity entity);
+		// Removes many entities from the scene (if they exist). The hierarchy is compacted only once for the whole batch:
+		void Entity_Remove(const wiECS::Entity* entities, size_t count);
 		// Finds the first entity by the name (if it exists, otherwise returns INVALID_ENTITY):
 		wiECS::Entity Entity_FindByName(const std::string& name);
 		// Duplicates all of an entity's components and creates a new entity with them:
@@ -1208,6 +1229,8 @@ namespace wiScene
 		void Component_Attach(wiECS::Entity entity, wiECS::Entity parent, bool child_already_in_local_space = false);
 		// Detaches the entity from its parent (if it is attached):
 		void Component_Detach(wiECS::Entity entity);
+		// Detaches many entities from their parents (if they are attached). The hierarchy is compacted only once for the whole batch:
+		void Component_Detach(const wiECS::Entity* entities, size_t count);
 		// Detaches all children from an entity (if there are any):
 		void Component_DetachChildren(wiECS::Entity parent);
 
@@ -1229,6 +1252,7 @@ namespace wiScene
 		void RunForceUpdateSystem(wiJobSystem::context& ctx);
 		void RunLightUpdateSystem(wiJobSystem::context& ctx);
 		void RunParticleUpdateSystem(wiJobSystem::context& ctx, float dt);
+		void RunParticleSimulationSystem(wiJobSystem::context& ctx, float dt);
 		void RunWeatherUpdateSystem(wiJobSystem::context& ctx);
 		void RunSoundUpdateSystem(wiJobSystem::context& ctx);
 	};
@@ -0,0 +1,813 @@
+#include "wiSceneStreaming.h"
+#include "wiArchive.h"
+#include "wiHelper.h"
+#include "wiTimer.h"
+#include "wiProfiler.h"
+#include "wiBackLog.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <cmath>
+#include <cfloat>
+
+using namespace wiECS;
+using namespace wiScene;
+
+namespace wiSceneStreaming
+{
+	static const char* INDEX_FILENAME = "cells.wicells";
+	static const char* GLOBAL_FILENAME = "global.wiscene";
+
+	std::string GetDirectory(const std::string& directory)
+	{
+		if (!directory.empty() && directory.back() != '/' && directory.back() != '\\')
+		{
+			return directory + "/";
+		}
+		return directory;
+	}
+
+	// Lists the entities that the components of an entity reference
+	void GatherReferences(const Scene& scene, Entity entity, std::vector<Entity>& references)
+	{
+		const ObjectComponent* object = scene.objects.GetComponent(entity);
+		if (object != nullptr)
+		{
+			references.push_back(object->meshID);
+		}
+		const MeshComponent* mesh = scene.meshes.GetComponent(entity);
+		if (mesh != nullptr)
+		{
+			for (auto& subset : mesh->subsets)
+			{
+				references.push_back(subset.materialID);
+			}
+			references.push_back(mesh->armatureID);
+		}
+		const ArmatureComponent* armature = scene.armatures.GetComponent(entity);
+		if (armature != nullptr)
+		{
+			references.insert(references.end(), armature->boneCollection.begin(), armature->boneCollection.end());
+		}
+		const wiEmittedParticle* emitter = scene.emitters.GetComponent(entity);
+		if (emitter != nullptr)
+		{
+			references.push_back(emitter->meshID);
+		}
+		const wiHairParticle* hair = scene.hairs.GetComponent(entity);
+		if (hair != nullptr)
+		{
+			references.push_back(hair->meshID);
+		}
+		const InverseKinematicsComponent* ik = scene.inverse_kinematics.GetComponent(entity);
+		if (ik != nullptr)
+		{
+			references.push_back(ik->target);
+		}
+		const AnimationComponent* animation = scene.animations.GetComponent(entity);
+		if (animation != nullptr)
+		{
+			for (auto& channel : animation->channels)
+			{
+				references.push_back(channel.target);
+			}
+			for (auto& sampler : animation->samplers)
+			{
+				references.push_back(sampler.data);
+			}
+		}
+	}
+
+	template<typename T>
+	void GatherEntities(const ComponentManager<T>& manager, std::vector<Entity>& entities, std::unordered_set<Entity>& visited)
+	{
+		for (size_t i = 0; i < manager.GetCount(); ++i)
+		{
+			const Entity entity = manager.GetEntity(i);
+			if (visited.insert(entity).second)
+			{
+				entities.push_back(entity);
+			}
+		}
+	}
+	// Lists every entity of the scene once. The entities that reference others come before the referenced ones,
+	//	so that the scene stays valid while the list is removed from it in multiple steps
+	void GatherEntities(const Scene& scene, std::vector<Entity>& entities)
+	{
+		std::unordered_set<Entity> visited;
+		GatherEntities(scene.objects, entities, visited);
+		GatherEntities(scene.emitters, entities, visited);
+		GatherEntities(scene.hairs, entities, visited);
+		GatherEntities(scene.softbodies, entities, visited);
+		GatherEntities(scene.armatures, entities, visited);
+		GatherEntities(scene.inverse_kinematics, entities, visited);
+		GatherEntities(scene.springs, entities, visited);
+		GatherEntities(scene.animations, entities, visited);
+		GatherEntities(scene.rigidbodies, entities, visited);
+		GatherEntities(scene.lights, entities, visited);
+		GatherEntities(scene.cameras, entities, visited);
+		GatherEntities(scene.probes, entities, visited);
+		GatherEntities(scene.forces, entities, visited);
+		GatherEntities(scene.decals, entities, visited);
+		GatherEntities(scene.weathers, entities, visited);
+		GatherEntities(scene.sounds, entities, visited);
+		GatherEntities(scene.hierarchy, entities, visited);
+		GatherEntities(scene.transforms, entities, visited);
+		GatherEntities(scene.prev_transforms, entities, visited);
+		GatherEntities(scene.layers, entities, visited);
+		GatherEntities(scene.aabb_objects, entities, visited);
+		GatherEntities(scene.aabb_lights, entities, visited);
+		GatherEntities(scene.aabb_probes, entities, visited);
+		GatherEntities(scene.aabb_decals, entities, visited);
+		GatherEntities(scene.meshes, entities, visited);
+		GatherEntities(scene.impostors, entities, visited);
+		GatherEntities(scene.materials, entities, visited);
+		GatherEntities(scene.animation_datas, entities, visited);
+		GatherEntities(scene.names, entities, visited);
+	}
+
+	// Copies the components of the entities while keeping their order in the source (the hierarchy relies on it)
+	template<typename T>
+	void CopyComponents(ComponentManager<T>& dst, const ComponentManager<T>& src, const std::vector<Entity>& entities, std::vector<size_t>& indices)
+	{
+		indices.clear();
+		for (Entity entity : entities)
+		{
+			const size_t index = src.GetIndex(entity);
+			if (index != (size_t)~0)
+			{
+				indices.push_back(index);
+			}
+		}
+		std::sort(indices.begin(), indices.end());
+		for (size_t index : indices)
+		{
+			dst.Create(src.GetEntity(index)) = src[index];
+		}
+	}
+	void CopyEntities(Scene& dst, const Scene& src, const std::vector<Entity>& entities)
+	{
+		std::vector<size_t> indices;
+		CopyComponents(dst.names, src.names, entities, indices);
+		CopyComponents(dst.layers, src.layers, entities, indices);
+		CopyComponents(dst.transforms, src.transforms, entities, indices);
+		CopyComponents(dst.prev_transforms, src.prev_transforms, entities, indices);
+		CopyComponents(dst.hierarchy, src.hierarchy, entities, indices);
+		CopyComponents(dst.materials, src.materials, entities, indices);
+		CopyComponents(dst.meshes, src.meshes, entities, indices);
+		CopyComponents(dst.impostors, src.impostors, entities, indices);
+		CopyComponents(dst.objects, src.objects, entities, indices);
+		CopyComponents(dst.aabb_objects, src.aabb_objects, entities, indices);
+		CopyComponents(dst.rigidbodies, src.rigidbodies, entities, indices);
+		CopyComponents(dst.softbodies, src.softbodies, entities, indices);
+		CopyComponents(dst.armatures, src.armatures, entities, indices);
+		CopyComponents(dst.lights, src.lights, entities, indices);
+		CopyComponents(dst.aabb_lights, src.aabb_lights, entities, indices);
+		CopyComponents(dst.cameras, src.cameras, entities, indices);
+		CopyComponents(dst.probes, src.probes, entities, indices);
+		CopyComponents(dst.aabb_probes, src.aabb_probes, entities, indices);
+		CopyComponents(dst.forces, src.forces, entities, indices);
+		CopyComponents(dst.decals, src.decals, entities, indices);
+		CopyComponents(dst.aabb_decals, src.aabb_decals, entities, indices);
+		CopyComponents(dst.animations, src.animations, entities, indices);
+		CopyComponents(dst.animation_datas, src.animation_datas, entities, indices);
+		CopyComponents(dst.emitters, src.emitters, entities, indices);
+		CopyComponents(dst.hairs, src.hairs, entities, indices);
+		CopyComponents(dst.weathers, src.weathers, entities, indices);
+		CopyComponents(dst.sounds, src.sounds, entities, indices);
+		CopyComponents(dst.inverse_kinematics, src.inverse_kinematics, entities, indices);
+		CopyComponents(dst.springs, src.springs, entities, indices);
+	}
+
+	// The world space bounds of an entity, or its position if it has no bounds
+	AABB GetWorldBounds(const Scene& scene, Entity entity)
+	{
+		const AABB* aabb = scene.aabb_objects.GetComponent(entity);
+		if (aabb == nullptr)
+		{
+			aabb = scene.aabb_lights.GetComponent(entity);
+		}
+		if (aabb == nullptr)
+		{
+			aabb = scene.aabb_probes.GetComponent(entity);
+		}
+		if (aabb == nullptr)
+		{
+			aabb = scene.aabb_decals.GetComponent(entity);
+		}
+		if (aabb != nullptr)
+		{
+			return *aabb;
+		}
+		const TransformComponent* transform = scene.transforms.GetComponent(entity);
+		if (transform != nullptr)
+		{
+			const XMFLOAT3 position = transform->GetPosition();
+			return AABB(position, position);
+		}
+		return AABB();
+	}
+
+	bool WriteArchive(const Scene& scene, const std::vector<Entity>& entities, const std::string& fileName)
+	{
+		Scene cellScene;
+		CopyEntities(cellScene, scene, entities);
+
+		wiArchive archive;
+		cellScene.Serialize(archive);
+		return archive.SaveFile(fileName);
+	}
+
+	uint32_t Partition(const Scene& scene, const std::string& directory, float cellSize)
+	{
+		assert(cellSize > 0);
+		const std::string dir = GetDirectory(directory);
+		if (!dir.empty())
+		{
+			wiHelper::DirectoryCreate(dir);
+		}
+
+		// Every entity with a transform starts in the group of its hierarchy root:
+		std::unordered_map<Entity, uint32_t> spatialGroups;
+		std::unordered_map<Entity, uint32_t> rootGroups;
+		std::vector<uint32_t> groupParents;
+		for (size_t i = 0; i < scene.transforms.GetCount(); ++i)
+		{
+			const Entity entity = scene.transforms.GetEntity(i);
+			Entity root = entity;
+			const HierarchyComponent* hier = scene.hierarchy.GetComponent(root);
+			while (hier != nullptr && hier->parentID != INVALID_ENTITY)
+			{
+				root = hier->parentID;
+				hier = scene.hierarchy.GetComponent(root);
+			}
+			auto it = rootGroups.find(root);
+			if (it == rootGroups.end())
+			{
+				it = rootGroups.insert(std::make_pair(root, (uint32_t)groupParents.size())).first;
+				groupParents.push_back(it->second);
+			}
+			spatialGroups[entity] = it->second;
+		}
+
+		auto find = [&](uint32_t group) {
+			while (groupParents[group] != group)
+			{
+				groupParents[group] = groupParents[groupParents[group]];
+				group = groupParents[group];
+			}
+			return group;
+		};
+		auto unite = [&](uint32_t a, uint32_t b) {
+			a = find(a);
+			b = find(b);
+			if (a != b)
+			{
+				groupParents[std::max(a, b)] = std::min(a, b);
+			}
+		};
+
+		// The non-spatial entities (meshes, materials, animation data...) that a group references are copied into it.
+		//	Spatial entities that are referenced across groups join the groups together:
+		std::vector<std::unordered_set<Entity>> groupDependencies(groupParents.size());
+		std::vector<Entity> references;
+		std::vector<Entity> stack;
+		auto visit = [&](uint32_t group, Entity entity) {
+			stack.push_back(entity);
+			while (!stack.empty())
+			{
+				const Entity current = stack.back();
+				stack.pop_back();
+				references.clear();
+				GatherReferences(scene, current, references);
+				for (Entity reference : references)
+				{
+					if (reference == INVALID_ENTITY)
+					{
+						continue;
+					}
+					auto it = spatialGroups.find(reference);
+					if (it != spatialGroups.end())
+					{
+						unite(group, it->second);
+					}
+					else if (groupDependencies[group].insert(reference).second)
+					{
+						stack.push_back(reference);
+					}
+				}
+			}
+		};
+		for (auto& x : spatialGroups)
+		{
+			visit(x.second, x.first);
+		}
+
+		// Animations are not referenced by anything, they are placed together with their targets:
+		std::unordered_set<Entity> globalEntities;
+		for (size_t i = 0; i < scene.animations.GetCount(); ++i)
+		{
+			const Entity entity = scene.animations.GetEntity(i);
+			if (spatialGroups.count(entity) > 0)
+			{
+				continue;
+			}
+			uint32_t group = ~0u;
+			for (auto& channel : scene.animations[i].channels)
+			{
+				auto it = spatialGroups.find(channel.target);
+				if (it != spatialGroups.end())
+				{
+					if (group == ~0u)
+					{
+						group = it->second;
+					}
+					unite(group, it->second);
+				}
+			}
+			if (group != ~0u)
+			{
+				groupDependencies[group].insert(entity);
+				visit(group, entity);
+			}
+		}
+
+		// Place the joined groups into cells by the center of their bounds:
+		std::vector<AABB> groupBounds(groupParents.size());
+		for (auto& x : spatialGroups)
+		{
+			const uint32_t group = find(x.second);
+			groupBounds[group] = AABB::Merge(groupBounds[group], GetWorldBounds(scene, x.first));
+		}
+		struct CellData
+		{
+			int x, z;
+			AABB bounds;
+			std::unordered_set<Entity> entities;
+		};
+		std::map<std::pair<int, int>, CellData> cellData;
+		std::vector<CellData*> groupCells(groupParents.size(), nullptr);
+		for (uint32_t group = 0; group < (uint32_t)groupParents.size(); ++group)
+		{
+			if (find(group) != group)
+			{
+				continue;
+			}
+			const AABB& bounds = groupBounds[group];
+			XMFLOAT3 center = bounds.getCenter();
+			if (bounds._min.x > bounds._max.x)
+			{
+				center = XMFLOAT3(0, 0, 0); // nothing to place it by
+			}
+			const int x = (int)std::floor(center.x / cellSize);
+			const int z = (int)std::floor(center.z / cellSize);
+			CellData& cell = cellData[std::make_pair(x, z)];
+			cell.x = x;
+			cell.z = z;
+			if (bounds._min.x <= bounds._max.x)
+			{
+				cell.bounds = AABB::Merge(cell.bounds, bounds);
+			}
+			else
+			{
+				cell.bounds = AABB::Merge(cell.bounds, AABB(center, center));
+			}
+			groupCells[group] = &cell;
+		}
+		for (auto& x : spatialGroups)
+		{
+			groupCells[find(x.second)]->entities.insert(x.first);
+		}
+		for (uint32_t group = 0; group < (uint32_t)groupParents.size(); ++group)
+		{
+			CellData* cell = groupCells[find(group)];
+			cell->entities.insert(groupDependencies[group].begin(), groupDependencies[group].end());
+		}
+
+		// Everything else goes to the global archive, with the non-spatial entities that it references:
+		std::vector<Entity> allEntities;
+		GatherEntities(scene, allEntities);
+		std::unordered_set<Entity> placed;
+		for (auto& x : cellData)
+		{
+			placed.insert(x.second.entities.begin(), x.second.entities.end());
+		}
+		for (Entity entity : allEntities)
+		{
+			if (placed.count(entity) > 0 || !globalEntities.insert(entity).second)
+			{
+				continue;
+			}
+			stack.push_back(entity);
+			while (!stack.empty())
+			{
+				const Entity current = stack.back();
+				stack.pop_back();
+				references.clear();
+				GatherReferences(scene, current, references);
+				for (Entity reference : references)
+				{
+					if (reference != INVALID_ENTITY && spatialGroups.count(reference) == 0 && globalEntities.insert(reference).second)
+					{
+						stack.push_back(reference);
+					}
+				}
+			}
+		}
+
+		// Write the archives, then the index:
+		wiArchive index;
+		uint32_t reserved = 0;
+		index << reserved;
+		index << cellSize;
+		index << (uint32_t)cellData.size();
+
+		uint32_t archiveCount = 0;
+		std::vector<Entity> entities;
+		for (auto& x : cellData)
+		{
+			const CellData& cell = x.second;
+			const std::string fileName = "cell_" + std::to_string(cell.x) + "_" + std::to_string(cell.z) + ".wiscene";
+			entities.assign(cell.entities.begin(), cell.entities.end());
+			if (!WriteArchive(scene, entities, dir + fileName))
+			{
+				wiBackLog::post(("[wiSceneStreaming] Failed to write cell: " + dir + fileName).c_str());
+				return 0;
+			}
+			archiveCount++;
+
+			index << cell.x;
+			index << cell.z;
+			index << cell.bounds._min;
+			index << cell.bounds._max;
+			index << fileName;
+		}
+
+		std::string globalFileName;
+		if (!globalEntities.empty())
+		{
+			globalFileName = GLOBAL_FILENAME;
+			entities.assign(globalEntities.begin(), globalEntities.end());
+			if (!WriteArchive(scene, entities, dir + globalFileName))
+			{
+				wiBackLog::post(("[wiSceneStreaming] Failed to write global archive: " + dir + globalFileName).c_str());
+				return 0;
+			}
+			archiveCount++;
+		}
+		index << globalFileName;
+
+		if (!index.SaveFile(dir + INDEX_FILENAME))
+		{
+			wiBackLog::post(("[wiSceneStreaming] Failed to write index: " + dir + INDEX_FILENAME).c_str());
+			return 0;
+		}
+		return archiveCount;
+	}
+
+
+
+	bool World::Open(const std::string& dir)
+	{
+		assert(!IsOpen());
+		directory = GetDirectory(dir);
+
+		wiArchive index(directory + INDEX_FILENAME, true);
+		if (!index.IsOpen())
+		{
+			return false;
+		}
+
+		uint32_t reserved;
+		index >> reserved;
+		index >> cellSize;
+		uint32_t cellCount;
+		index >> cellCount;
+		cells.resize(cellCount);
+		for (Cell& cell : cells)
+		{
+			index >> cell.x;
+			index >> cell.z;
+			index >> cell.bounds._min;
+			index >> cell.bounds._max;
+			index >> cell.fileName;
+		}
+		std::string globalFileName;
+		index >> globalFileName;
+		if (!globalFileName.empty())
+		{
+			cells.emplace_back();
+			cells.back().fileName = globalFileName;
+			cells.back().global = true;
+		}
+
+		statistics = Statistics();
+		statistics.cellCount = (uint32_t)cells.size();
+		mergeCostPerEntity = 0;
+
+		StartStreamingThread();
+		return IsOpen();
+	}
+
+	void World::StartStreamingThread()
+	{
+		if (streamingThreadRunning)
+		{
+			return;
+		}
+		streamingThreadRunning = true;
+		streamingThread = std::thread([this] {
+			wiProfiler::SetThreadName("Streaming Thread");
+
+			std::unique_lock<std::mutex> lck(streamingLock);
+			while (true)
+			{
+				streamingCondition.wait(lck, [this] { return !loadQueue.empty() || !streamingThreadRunning; });
+				if (!streamingThreadRunning)
+				{
+					break;
+				}
+				const uint32_t index = loadQueue.front();
+				loadQueue.pop_front();
+				Cell& cell = cells[index];
+				lck.unlock();
+
+				wiTimer timer;
+				cell.scene = std::make_unique<Scene>();
+				wiArchive archive(directory + cell.fileName, true);
+				if (archive.IsOpen())
+				{
+					cell.scene->Serialize(archive);
+				}
+				else
+				{
+					wiBackLog::post(("[wiSceneStreaming] Failed to load cell: " + directory + cell.fileName).c_str());
+				}
+				cell.entities.clear();
+				GatherEntities(*cell.scene, cell.entities);
+				const double time = timer.elapsed();
+
+				lck.lock();
+				loadedCells.push_back(index);
+				lastLoadTime = time;
+			}
+		});
+	}
+
+	void World::StopStreamingThread()
+	{
+		if (!streamingThread.joinable())
+		{
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lck(streamingLock);
+			streamingThreadRunning = false;
+			loadQueue.clear();
+		}
+		streamingCondition.notify_all();
+		streamingThread.join();
+		loadedCells.clear();
+	}
+
+	void World::Update(Scene& scene)
+	{
+		Update(scene, settings.mergeBudget, settings.removeBudget);
+	}
+
+	void World::Update(Scene& scene, double mergeBudget, double removeBudget)
+	{
+		if (!IsOpen())
+		{
+			return;
+		}
+		assert(settings.unloadDistance >= settings.loadDistance);
+
+		wiProfiler::ScopedRangeCPU profilerRange("Scene Streaming");
+
+		// Take over the cells that the streaming thread finished:
+		{
+			std::lock_guard<std::mutex> lck(streamingLock);
+			for (uint32_t index : loadedCells)
+			{
+				cells[index].state = STATE_LOADED;
+			}
+			loadedCells.clear();
+			statistics.loadTime = lastLoadTime;
+		}
+
+		// Decide what to load and unload by the distance to the nearest observer. Cells between the load and unload distance keep their state:
+		candidates.clear();
+		for (uint32_t i = 0; i < (uint32_t)cells.size(); ++i)
+		{
+			Cell& cell = cells[i];
+			cell.distance = cell.global ? 0 : FLT_MAX;
+			if (!cell.global)
+			{
+				const XMVECTOR _min = XMLoadFloat3(&cell.bounds._min);
+				const XMVECTOR _max = XMLoadFloat3(&cell.bounds._max);
+				for (const XMFLOAT3& observer : observers)
+				{
+					const XMVECTOR P = XMLoadFloat3(&observer);
+					const float distance = XMVectorGetX(XMVector3Length(P - XMVectorClamp(P, _min, _max)));
+					cell.distance = std::min(cell.distance, distance);
+				}
+			}
+			const bool wanted = cell.distance <= settings.loadDistance;
+			const bool unwanted = cell.distance > settings.unloadDistance;
+
+			switch (cell.state)
+			{
+			case STATE_UNLOADED:
+				if (wanted)
+				{
+					candidates.push_back(i);
+				}
+				break;
+			case STATE_LOADING:
+				if (unwanted)
+				{
+					// Only the cells that are still in the queue can be cancelled, the one that is being loaded will be discarded later:
+					std::lock_guard<std::mutex> lck(streamingLock);
+					auto it = std::find(loadQueue.begin(), loadQueue.end(), i);
+					if (it != loadQueue.end())
+					{
+						loadQueue.erase(it);
+						cell.state = STATE_UNLOADED;
+					}
+				}
+				break;
+			case STATE_LOADED:
+				if (unwanted)
+				{
+					cell.scene.reset();
+					cell.entities.clear();
+					cell.state = STATE_UNLOADED;
+				}
+				break;
+			case STATE_RESIDENT:
+				if (unwanted)
+				{
+					cell.removed = 0;
+					cell.detached = false;
+					cell.state = STATE_UNLOADING;
+					unloadQueue.push_back(i);
+				}
+				break;
+			case STATE_UNLOADING:
+				break; // the removal must finish before the cell can be loaded again
+			}
+		}
+
+		// Queue the nearest cells for loading, the queue is kept short so that it follows the observers:
+		std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) {
+			return cells[a].distance < cells[b].distance;
+		});
+		statistics.waitingCount = 0;
+		{
+			std::lock_guard<std::mutex> lck(streamingLock);
+			std::sort(loadQueue.begin(), loadQueue.end(), [&](uint32_t a, uint32_t b) {
+				return cells[a].distance < cells[b].distance;
+			});
+			for (uint32_t index : candidates)
+			{
+				if (loadQueue.size() >= settings.maxQueuedLoads)
+				{
+					statistics.waitingCount++;
+					continue;
+				}
+				loadQueue.push_back(index);
+				cells[index].state = STATE_LOADING;
+			}
+		}
+		streamingCondition.notify_all();
+
+		// Merge the loaded cells, nearest first, as long as the estimated cost fits in the budget. At least one cell is merged per Update() to always make progress:
+		candidates.clear();
+		for (uint32_t i = 0; i < (uint32_t)cells.size(); ++i)
+		{
+			if (cells[i].state == STATE_LOADED)
+			{
+				candidates.push_back(i);
+			}
+		}
+		std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) {
+			return cells[a].distance < cells[b].distance;
+		});
+		statistics.mergedCellCount = 0;
+		wiTimer timer;
+		for (uint32_t index : candidates)
+		{
+			Cell& cell = cells[index];
+			const double estimate = mergeCostPerEntity * (double)cell.entities.size();
+			if (statistics.mergedCellCount > 0 && timer.elapsed() + estimate > mergeBudget)
+			{
+				break;
+			}
+			wiTimer mergeTimer;
+			scene.Merge(*cell.scene);
+			const double mergeTime = mergeTimer.elapsed();
+			if (!cell.entities.empty())
+			{
+				const double cost = mergeTime / (double)cell.entities.size();
+				mergeCostPerEntity = mergeCostPerEntity == 0 ? cost : (mergeCostPerEntity * 0.75 + cost * 0.25);
+			}
+			cell.scene.reset();
+			cell.state = STATE_RESIDENT;
+			statistics.mergedCellCount++;
+		}
+		statistics.mergeTime = timer.elapsed();
+
+		// Remove the unloaded cells in batches. The whole cell is detached from the hierarchy at once first,
+		//	then the entities are removed in an order that keeps the references valid between two Update() calls:
+		statistics.removedEntityCount = 0;
+		timer.record();
+		while (!unloadQueue.empty() && timer.elapsed() < removeBudget)
+		{
+			Cell& cell = cells[unloadQueue.front()];
+			if (!cell.detached)
+			{
+				scene.Component_Detach(cell.entities.data(), cell.entities.size());
+				cell.detached = true;
+			}
+			while (cell.removed < cell.entities.size() && timer.elapsed() < removeBudget)
+			{
+				const size_t count = std::min((size_t)settings.removeBatchSize, cell.entities.size() - cell.removed);
+				scene.Entity_Remove(cell.entities.data() + cell.removed, count);
+				cell.removed += count;
+				statistics.removedEntityCount += (uint32_t)count;
+			}
+			if (cell.removed < cell.entities.size())
+			{
+				break;
+			}
+			cell.entities.clear();
+			cell.state = STATE_UNLOADED;
+			unloadQueue.pop_front();
+		}
+		statistics.removeTime = timer.elapsed();
+
+		statistics.residentCount = 0;
+		statistics.loadingCount = 0;
+		statistics.pendingMergeCount = 0;
+		statistics.unloadingCount = 0;
+		for (const Cell& cell : cells)
+		{
+			switch (cell.state)
+			{
+			case STATE_LOADING:
+				statistics.loadingCount++;
+				break;
+			case STATE_LOADED:
+				statistics.pendingMergeCount++;
+				break;
+			case STATE_RESIDENT:
+				statistics.residentCount++;
+				break;
+			case STATE_UNLOADING:
+				statistics.unloadingCount++;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	void World::Flush(Scene& scene)
+	{
+		while (IsOpen())
+		{
+			Update(scene, DBL_MAX, DBL_MAX);
+			if (statistics.loadingCount == 0 && statistics.pendingMergeCount == 0 && statistics.unloadingCount == 0 && statistics.waitingCount == 0)
+			{
+				break;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	void World::Close(Scene& scene)
+	{
+		StopStreamingThread();
+
+		std::vector<Entity> entities;
+		for (Cell& cell : cells)
+		{
+			if (cell.state == STATE_RESIDENT)
+			{
+				entities.insert(entities.end(), cell.entities.begin(), cell.entities.end());
+			}
+			else if (cell.state == STATE_UNLOADING)
+			{
+				entities.insert(entities.end(), cell.entities.begin() + cell.removed, cell.entities.end());
+			}
+		}
+		scene.Entity_Remove(entities.data(), entities.size());
+
+		cells.clear();
+		unloadQueue.clear();
+		statistics = Statistics();
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiScene.h"
+#include "wiIntersect.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Streaming of large worlds that are partitioned to spatial cells
+//	Every cell is an independent scene archive. The cells around the observers are loaded on a background thread,
+//	then merged into the scene on the main thread within a time budget. The cells that are far from every observer
+//	are removed from the scene in batches, also within a time budget.
+namespace wiSceneStreaming
+{
+	// Splits the scene to a grid of cells on the XZ plane, and writes every cell to the directory as a separate scene archive, with an index file
+	//	The world space bounds are used to place the entities, so the scene must be updated before this.
+	//	Every hierarchy is placed into one cell together, and hierarchies that reference each other (armature bones, inverse kinematics and animation targets) are kept together as well.
+	//	Meshes and materials are written to every cell that uses them. Entities that are not in any cell (for example the weather) are written to a global archive that is always loaded.
+	//	The texture paths are stored relative to the directory, so it should be next to the files of the source scene
+	//	Returns the number of archives that were written, or 0 on failure
+	uint32_t Partition(const wiScene::Scene& scene, const std::string& directory, float cellSize = 64);
+
+	struct Settings
+	{
+		float loadDistance = 128;		// cells that are closer than this to any observer are loaded
+		float unloadDistance = 192;		// cells that are farther than this from every observer are unloaded, must not be less than loadDistance
+		double mergeBudget = 2;			// milliseconds that can be spent merging loaded cells into the scene in one Update()
+		double removeBudget = 1;		// milliseconds that can be spent removing the entities of unloaded cells in one Update()
+		uint32_t maxQueuedLoads = 4;	// how many cells can wait for the streaming thread at once, the nearest cells are queued first
+		uint32_t removeBatchSize = 256;	// entities that are removed between two checks of the remove budget
+	};
+
+	struct Statistics
+	{
+		uint32_t cellCount = 0;
+		uint32_t residentCount = 0;			// cells that are merged into the scene
+		uint32_t loadingCount = 0;			// cells that are queued or being loaded by the streaming thread
+		uint32_t pendingMergeCount = 0;		// loaded cells that are waiting to be merged
+		uint32_t unloadingCount = 0;		// cells whose entities are being removed
+		uint32_t waitingCount = 0;			// cells that should be loaded but the queue is full
+		uint32_t mergedCellCount = 0;		// cells that were merged in the last Update()
+		uint32_t removedEntityCount = 0;	// entities that were removed in the last Update()
+		double mergeTime = 0;				// milliseconds spent merging in the last Update()
+		double removeTime = 0;				// milliseconds spent removing in the last Update()
+		double loadTime = 0;				// milliseconds the streaming thread spent loading the last cell
+	};
+
+	class World
+	{
+	public:
+		Settings settings;
+		// The cells are streamed around these positions, for example the camera and the players
+		std::vector<XMFLOAT3> observers;
+
+		~World() { StopStreamingThread(); }
+
+		// Opens a directory that was written by Partition() and starts the streaming thread. Nothing is loaded until Update()
+		bool Open(const std::string& directory);
+		// Streams the cells around the observers. Call this once per frame on the main thread, before the scene is updated
+		void Update(wiScene::Scene& scene);
+		// Finishes every load and removal that the observers require right now, without time budgets (for example behind a loading screen)
+		void Flush(wiScene::Scene& scene);
+		// Removes every streamed entity from the scene and stops the streaming thread
+		void Close(wiScene::Scene& scene);
+
+		bool IsOpen() const { return !cells.empty(); }
+		float GetCellSize() const { return cellSize; }
+		const Statistics& GetStatistics() const { return statistics; }
+
+	private:
+		enum STATE
+		{
+			STATE_UNLOADED,
+			STATE_LOADING,		// queued or being loaded by the streaming thread
+			STATE_LOADED,		// the staging scene is waiting to be merged
+			STATE_RESIDENT,		// merged into the scene
+			STATE_UNLOADING,	// the entities are being removed from the scene
+		};
+		struct Cell
+		{
+			int x = 0;
+			int z = 0;
+			AABB bounds;
+			std::string fileName;
+			bool global = false;	// loaded regardless of the observers
+
+			STATE state = STATE_UNLOADED;
+			float distance = 0;		// to the nearest observer
+			std::unique_ptr<wiScene::Scene> scene;	// staging scene, only the streaming thread uses it while loading
+			std::vector<wiECS::Entity> entities;	// in removal order: the ones that reference others come first
+			size_t removed = 0;
+			bool detached = false;
+		};
+
+		std::string directory;
+		float cellSize = 0;
+		std::vector<Cell> cells;
+		std::deque<uint32_t> unloadQueue;
+		std::vector<uint32_t> candidates;
+		double mergeCostPerEntity = 0;	// milliseconds, running average used to keep merges within the budget
+		Statistics statistics;
+
+		// The streaming thread loads the queued cells into their staging scenes
+		std::thread streamingThread;
+		std::mutex streamingLock;
+		std::condition_variable streamingCondition;
+		bool streamingThreadRunning = false;
+		std::deque<uint32_t> loadQueue;		// guarded by streamingLock
+		std::vector<uint32_t> loadedCells;	// guarded by streamingLock
+		double lastLoadTime = 0;			// guarded by streamingLock
+
+		void StartStreamingThread();
+		void StopStreamingThread();
+		void Update(wiScene::Scene& scene, double mergeBudget, double removeBudget);
+	};
+}
@@ -23,7 +23,7 @@ int CreateEntity_BindLua(lua_State* L)
 
 int GetScene(lua_State* L)
 {
-	Luna<Scene_BindLua>::push(L, new Scene_BindLua(&wiScene::GetScene()));
+	Luna<Scene_BindLua>::create(L, &wiScene::GetScene());
 	return 1;
 }
 int LoadModel(lua_State* L)
@@ -124,8 +124,8 @@ int Pick(lua_State* L)
 			}
 			auto pick = wiScene::Pick(ray->ray, renderTypeMask, layerMask, *scene);
 			wiLua::SSetLongLong(L, pick.entity);
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&pick.position)));
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&pick.normal)));
+			Luna<Vector_BindLua>::create(L, XMLoadFloat3(&pick.position));
+			Luna<Vector_BindLua>::create(L, XMLoadFloat3(&pick.normal));
 			wiLua::SSetFloat(L, pick.distance);
 			return 4;
 		}
@@ -174,8 +174,8 @@ int SceneIntersectSphere(lua_State* L)
 			}
 			auto pick = wiScene::SceneIntersectSphere(sphere->sphere, renderTypeMask, layerMask, *scene);
 			wiLua::SSetLongLong(L, pick.entity);
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&pick.position)));
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&pick.normal)));
+			Luna<Vector_BindLua>::create(L, XMLoadFloat3(&pick.position));
+			Luna<Vector_BindLua>::create(L, XMLoadFloat3(&pick.normal));
 			wiLua::SSetFloat(L, pick.depth);
 			return 4;
 		}
@@ -224,8 +224,8 @@ int SceneIntersectCapsule(lua_State* L)
 			}
 			auto pick = wiScene::SceneIntersectCapsule(capsule->capsule, renderTypeMask, layerMask, *scene);
 			wiLua::SSetLongLong(L, pick.entity);
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&pick.position)));
-			Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat3(&pick.normal)));
+			Luna<Vector_BindLua>::create(L, XMLoadFloat3(&pick.position));
+			Luna<Vector_BindLua>::create(L, XMLoadFloat3(&pick.normal));
 			wiLua::SSetFloat(L, pick.depth);
 			return 4;
 		}
@@ -465,7 +465,7 @@ int Scene_BindLua::Component_CreateName(lua_State* L)
 		Entity entity = (Entity)wiLua::SGetLongLong(L, 1);
 
 		NameComponent& component = scene->names.Create(entity);
-		Luna<NameComponent_BindLua>::push(L, new NameComponent_BindLua(&component));
+		Luna<NameComponent_BindLua>::create(L, &component);
 		return 1;
 	}
 	else
@@ -482,7 +482,7 @@ int Scene_BindLua::Component_CreateLayer(lua_State* L)
 		Entity entity = (Entity)wiLua::SGetLongLong(L, 1);
 
 		LayerComponent& component = scene->layers.Create(entity);
-		Luna<LayerComponent_BindLua>::push(L, new LayerComponent_BindLua(&component));
+		Luna<LayerComponent_BindLua>::create(L, &component);
 		return 1;
 	}
 	else
@@ -499,7 +499,7 @@ int Scene_BindLua::Component_CreateTransform(lua_State* L)
 		Entity entity = (Entity)wiLua::SGetLongLong(L, 1);
 
 		TransformComponent& component = scene->transforms.Create(entity);
-		Luna<TransformComponent_BindLua>::push(L, new TransformComponent_BindLua(&component));
+		Luna<TransformComponent_BindLua>::create(L, &component);
 		return 1;
 	}
 	else
@@ -518,7 +518,7 @@ int Scene_BindLua::Component_CreateLight(lua_State* L)
 		scene->aabb_lights.Create(entity);
 
 		LightComponent& component = scene->lights.Create(entity);
-		Luna<LightComponent_BindLua>::push(L, new LightComponent_BindLua(&component));
+		Luna<LightComponent_BindLua>::create(L, &component);
 		return 1;
 	}
 	else
@@ -537,7 +537,7 @@ int Scene_BindLua::Component_CreateObject(lua_State* L)
 		scene->aabb_objects.Create(entity);
 
 		ObjectComponent& component = scene->objects.Create(entity);
-		Luna<ObjectComponent_BindLua>::push(L, new ObjectComponent_BindLua(&component));
+		Luna<ObjectComponent_BindLua>::create(L, &component);
 		return 1;
 	}
 	else
@@ -554,7 +554,7 @@ int Scene_BindLua::Component_CreateInverseKinematics(lua_State* L)
 		Entity entity = (Entity)wiLua::SGetLongLong(L, 1);
 
 		InverseKinematicsComponent& component = scene->inverse_kinematics.Create(entity);
-		Luna<InverseKinematicsComponent_BindLua>::push(L, new InverseKinematicsComponent_BindLua(&component));
+		Luna<InverseKinematicsComponent_BindLua>::create(L, &component);
 		return 1;
 	}
 	else
@@ -571,7 +571,7 @@ int Scene_BindLua::Component_CreateSpring(lua_State* L)
 		Entity entity = (Entity)wiLua::SGetLongLong(L, 1);
 
 		SpringComponent& component = scene->springs.Create(entity);
-		Luna<SpringComponent_BindLua>::push(L, new SpringComponent_BindLua(&component));
+		Luna<SpringComponent_BindLua>::create(L, &component);
 		return 1;
 	}
 	else
@@ -594,7 +594,7 @@ int Scene_BindLua::Component_GetName(lua_State* L)
 			return 0;
 		}
 
-		Luna<NameComponent_BindLua>::push(L, new NameComponent_BindLua(component));
+		Luna<NameComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -616,7 +616,7 @@ int Scene_BindLua::Component_GetLayer(lua_State* L)
 			return 0;
 		}
 
-		Luna<LayerComponent_BindLua>::push(L, new LayerComponent_BindLua(component));
+		Luna<LayerComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -638,7 +638,7 @@ int Scene_BindLua::Component_GetTransform(lua_State* L)
 			return 0;
 		}
 
-		Luna<TransformComponent_BindLua>::push(L, new TransformComponent_BindLua(component));
+		Luna<TransformComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -660,7 +660,7 @@ int Scene_BindLua::Component_GetCamera(lua_State* L)
 			return 0;
 		}
 
-		Luna<CameraComponent_BindLua>::push(L, new CameraComponent_BindLua(component));
+		Luna<CameraComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -682,7 +682,7 @@ int Scene_BindLua::Component_GetAnimation(lua_State* L)
 			return 0;
 		}
 
-		Luna<AnimationComponent_BindLua>::push(L, new AnimationComponent_BindLua(component));
+		Luna<AnimationComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -704,7 +704,7 @@ int Scene_BindLua::Component_GetMaterial(lua_State* L)
 			return 0;
 		}
 
-		Luna<MaterialComponent_BindLua>::push(L, new MaterialComponent_BindLua(component));
+		Luna<MaterialComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -726,7 +726,7 @@ int Scene_BindLua::Component_GetEmitter(lua_State* L)
 			return 0;
 		}
 
-		Luna<EmitterComponent_BindLua>::push(L, new EmitterComponent_BindLua(component));
+		Luna<EmitterComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -748,7 +748,7 @@ int Scene_BindLua::Component_GetLight(lua_State* L)
 			return 0;
 		}
 
-		Luna<LightComponent_BindLua>::push(L, new LightComponent_BindLua(component));
+		Luna<LightComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -770,7 +770,7 @@ int Scene_BindLua::Component_GetObject(lua_State* L)
 			return 0;
 		}
 
-		Luna<ObjectComponent_BindLua>::push(L, new ObjectComponent_BindLua(component));
+		Luna<ObjectComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -792,7 +792,7 @@ int Scene_BindLua::Component_GetInverseKinematics(lua_State* L)
 			return 0;
 		}
 
-		Luna<InverseKinematicsComponent_BindLua>::push(L, new InverseKinematicsComponent_BindLua(component));
+		Luna<InverseKinematicsComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -814,7 +814,7 @@ int Scene_BindLua::Component_GetSpring(lua_State* L)
 			return 0;
 		}
 
-		Luna<SpringComponent_BindLua>::push(L, new SpringComponent_BindLua(component));
+		Luna<SpringComponent_BindLua>::create(L, component);
 		return 1;
 	}
 	else
@@ -830,7 +830,7 @@ int Scene_BindLua::Component_GetNameArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->names.GetCount(); ++i)
 	{
-		Luna<NameComponent_BindLua>::push(L, new NameComponent_BindLua(&scene->names[i]));
+		Luna<NameComponent_BindLua>::create(L, &scene->names[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -841,7 +841,7 @@ int Scene_BindLua::Component_GetLayerArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->layers.GetCount(); ++i)
 	{
-		Luna<LayerComponent_BindLua>::push(L, new LayerComponent_BindLua(&scene->layers[i]));
+		Luna<LayerComponent_BindLua>::create(L, &scene->layers[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -852,7 +852,7 @@ int Scene_BindLua::Component_GetTransformArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->transforms.GetCount(); ++i)
 	{
-		Luna<TransformComponent_BindLua>::push(L, new TransformComponent_BindLua(&scene->transforms[i]));
+		Luna<TransformComponent_BindLua>::create(L, &scene->transforms[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -863,7 +863,7 @@ int Scene_BindLua::Component_GetCameraArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->cameras.GetCount(); ++i)
 	{
-		Luna<CameraComponent_BindLua>::push(L, new CameraComponent_BindLua(&scene->cameras[i]));
+		Luna<CameraComponent_BindLua>::create(L, &scene->cameras[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -874,7 +874,7 @@ int Scene_BindLua::Component_GetAnimationArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->animations.GetCount(); ++i)
 	{
-		Luna<AnimationComponent_BindLua>::push(L, new AnimationComponent_BindLua(&scene->animations[i]));
+		Luna<AnimationComponent_BindLua>::create(L, &scene->animations[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -885,7 +885,7 @@ int Scene_BindLua::Component_GetMaterialArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->materials.GetCount(); ++i)
 	{
-		Luna<MaterialComponent_BindLua>::push(L, new MaterialComponent_BindLua(&scene->materials[i]));
+		Luna<MaterialComponent_BindLua>::create(L, &scene->materials[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -896,7 +896,7 @@ int Scene_BindLua::Component_GetEmitterArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->emitters.GetCount(); ++i)
 	{
-		Luna<EmitterComponent_BindLua>::push(L, new EmitterComponent_BindLua(&scene->emitters[i]));
+		Luna<EmitterComponent_BindLua>::create(L, &scene->emitters[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -907,7 +907,7 @@ int Scene_BindLua::Component_GetLightArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->lights.GetCount(); ++i)
 	{
-		Luna<LightComponent_BindLua>::push(L, new LightComponent_BindLua(&scene->lights[i]));
+		Luna<LightComponent_BindLua>::create(L, &scene->lights[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -918,7 +918,7 @@ int Scene_BindLua::Component_GetObjectArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->objects.GetCount(); ++i)
 	{
-		Luna<ObjectComponent_BindLua>::push(L, new ObjectComponent_BindLua(&scene->objects[i]));
+		Luna<ObjectComponent_BindLua>::create(L, &scene->objects[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -929,7 +929,7 @@ int Scene_BindLua::Component_GetInverseKinematicsArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->inverse_kinematics.GetCount(); ++i)
 	{
-		Luna<InverseKinematicsComponent_BindLua>::push(L, new InverseKinematicsComponent_BindLua(&scene->inverse_kinematics[i]));
+		Luna<InverseKinematicsComponent_BindLua>::create(L, &scene->inverse_kinematics[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -940,7 +940,7 @@ int Scene_BindLua::Component_GetSpringArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->springs.GetCount(); ++i)
 	{
-		Luna<SpringComponent_BindLua>::push(L, new SpringComponent_BindLua(&scene->springs[i]));
+		Luna<SpringComponent_BindLua>::create(L, &scene->springs[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -1429,7 +1429,7 @@ int TransformComponent_BindLua::MatrixTransform(lua_State* L)
 int TransformComponent_BindLua::GetMatrix(lua_State* L)
 {
 	XMMATRIX M = XMLoadFloat4x4(&component->world);
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(M));
+	Luna<Matrix_BindLua>::create(L, M);
 	return 1;
 }
 int TransformComponent_BindLua::ClearTransform(lua_State* L)
@@ -1445,19 +1445,19 @@ int TransformComponent_BindLua::UpdateTransform(lua_State* L)
 int TransformComponent_BindLua::GetPosition(lua_State* L)
 {
 	XMVECTOR V = component->GetPositionV();
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(V));
+	Luna<Vector_BindLua>::create(L, V);
 	return 1;
 }
 int TransformComponent_BindLua::GetRotation(lua_State* L)
 {
 	XMVECTOR V = component->GetRotationV();
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(V));
+	Luna<Vector_BindLua>::create(L, V);
 	return 1;
 }
 int TransformComponent_BindLua::GetScale(lua_State* L)
 {
 	XMVECTOR V = component->GetScaleV();
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(V));
+	Luna<Vector_BindLua>::create(L, V);
 	return 1;
 }
 
@@ -1589,32 +1589,32 @@ int CameraComponent_BindLua::SetFarPlane(lua_State* L)
 }
 int CameraComponent_BindLua::GetView(lua_State* L)
 {
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(component->GetView()));
+	Luna<Matrix_BindLua>::create(L, component->GetView());
 	return 1;
 }
 int CameraComponent_BindLua::GetProjection(lua_State* L)
 {
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(component->GetProjection()));
+	Luna<Matrix_BindLua>::create(L, component->GetProjection());
 	return 1;
 }
 int CameraComponent_BindLua::GetViewProjection(lua_State* L)
 {
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(component->GetViewProjection()));
+	Luna<Matrix_BindLua>::create(L, component->GetViewProjection());
 	return 1;
 }
 int CameraComponent_BindLua::GetInvView(lua_State* L)
 {
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(component->GetInvView()));
+	Luna<Matrix_BindLua>::create(L, component->GetInvView());
 	return 1;
 }
 int CameraComponent_BindLua::GetInvProjection(lua_State* L)
 {
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(component->GetInvProjection()));
+	Luna<Matrix_BindLua>::create(L, component->GetInvProjection());
 	return 1;
 }
 int CameraComponent_BindLua::GetInvViewProjection(lua_State* L)
 {
-	Luna<Matrix_BindLua>::push(L, new Matrix_BindLua(component->GetInvViewProjection()));
+	Luna<Matrix_BindLua>::create(L, component->GetInvViewProjection());
 	return 1;
 }
 
@@ -2223,7 +2223,7 @@ int ObjectComponent_BindLua::GetMeshID(lua_State* L)
 }
 int ObjectComponent_BindLua::GetColor(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat4(&component->color)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat4(&component->color));
 	return 1;
 }
 int ObjectComponent_BindLua::GetUserStencilRef(lua_State* L)
@@ -138,27 +138,27 @@ namespace wiScene
 
 			if (!baseColorMapName.empty())
 			{
-				baseColorMap = wiResourceManager::Load(dir + baseColorMapName);
+				baseColorMap = wiResourceManager::Load(dir + baseColorMapName, wiResourceManager::ALLOW_COOKING);
 			}
 			if (!surfaceMapName.empty())
 			{
-				surfaceMap = wiResourceManager::Load(dir + surfaceMapName);
+				surfaceMap = wiResourceManager::Load(dir + surfaceMapName, wiResourceManager::ALLOW_COOKING);
 			}
 			if (!normalMapName.empty())
 			{
-				normalMap = wiResourceManager::Load(dir + normalMapName);
+				normalMap = wiResourceManager::Load(dir + normalMapName, wiResourceManager::ALLOW_COOKING);
 			}
 			if (!displacementMapName.empty())
 			{
-				displacementMap = wiResourceManager::Load(dir + displacementMapName);
+				displacementMap = wiResourceManager::Load(dir + displacementMapName, wiResourceManager::ALLOW_COOKING);
 			}
 			if (!emissiveMapName.empty())
 			{
-				emissiveMap = wiResourceManager::Load(dir + emissiveMapName);
+				emissiveMap = wiResourceManager::Load(dir + emissiveMapName, wiResourceManager::ALLOW_COOKING);
 			}
 			if (!occlusionMapName.empty())
 			{
-				occlusionMap = wiResourceManager::Load(dir + occlusionMapName);
+				occlusionMap = wiResourceManager::Load(dir + occlusionMapName, wiResourceManager::ALLOW_COOKING);
 			}
 
 		}
@@ -830,7 +830,10 @@ namespace wiScene
 			if (!filename.empty())
 			{
 				soundResource = wiResourceManager::Load(dir + filename);
-				wiAudio::CreateSoundInstance(soundResource->sound, &soundinstance);
+				if (soundResource != nullptr)
+				{
+					wiAudio::CreateSoundInstance(soundResource->sound, &soundinstance);
+				}
 			}
 
 		}
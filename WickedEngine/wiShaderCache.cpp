@@ -0,0 +1,664 @@
+#include "wiShaderCache.h"
+#include "wiRenderer.h"
+#include "wiHelper.h"
+#include "wiJobSystem.h"
+#include "wiTimer.h"
+#include "wiVersion.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace wiGraphics;
+
+namespace wiShaderCache
+{
+	static const char* ARCHIVE_FILENAME = "shaders.wishaderarchive";
+	static const char* PIPELINES_FILENAME = "pipelines.wipipelinecache";
+	static const uint32_t ARCHIVE_MAGIC = 0x41485357; // WSHA
+	static const uint32_t PIPELINES_MAGIC = 0x4F535057; // WPSO
+	static const uint32_t FILE_VERSION = 2;
+	static const double PIPELINES_SAVE_INTERVAL = 5000; // milliseconds
+	static const uint32_t MAX_WARMUP_COMMANDLISTS = 8;
+
+	// Both files start with this, the data of an other engine version is discarded:
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t fileVersion;
+		uint64_t engineVersion;
+		uint32_t count;
+		uint32_t reserved;
+	};
+	// The archive index follows the header, then the names and the shader bytecodes. Offsets are from the start of the file
+	struct ArchiveEntry
+	{
+		uint32_t stage;
+		uint32_t nameLength;
+		uint64_t nameOffset;
+		uint64_t dataOffset;
+		uint64_t dataSize;
+		uint64_t fileSize;			// the shader file that the bytecode was read from
+		uint64_t fileTime;
+	};
+	// The pipeline cache is an array of these after the header
+	struct Permutation
+	{
+		uint64_t pipeline;			// stable key of the pipeline state, see ComputePipelineKey()
+		uint32_t numAttachments;
+		uint32_t reserved;
+		struct Attachment
+		{
+			uint32_t type;
+			uint32_t format;
+			uint32_t sampleCount;
+		} attachments[sizeof(RenderPassDesc::attachments) / sizeof(RenderPassAttachment)];
+	};
+
+	struct ShaderEntry
+	{
+		SHADERSTAGE stage = SHADERSTAGE_COUNT;
+		std::vector<uint8_t> bytecode;
+		uint64_t fileSize = 0;
+		uint64_t fileTime = 0;
+		Shader shader;
+	};
+
+	bool enabled = true;
+	std::mutex locker;
+	std::unordered_map<std::string, ShaderEntry> shaders;
+	std::unordered_map<const Shader*, uint64_t> shaderNames; // name hash of every shader that was loaded by name, to identify the pipeline states
+	bool archiveDirty = false;
+
+	std::unordered_map<uint64_t, PipelineState> pipelineStates;
+	std::vector<Permutation> permutations;
+	std::unordered_set<uint64_t> permutationKeys;
+	bool permutationsLoaded = false;
+	std::atomic<bool> permutationsDirty{ false };
+	wiTimer permutationsSaveTimer;
+
+	// The render targets of the warm-up are kept alive until the next warm-up, because the GPU uses them after the frame is submitted:
+	std::vector<Texture> warmupTextures;
+	std::vector<RenderPass> warmupRenderPasses;
+
+	Statistics statistics;
+
+	std::string GetArchivePath()
+	{
+		return wiRenderer::GetShaderPath() + ARCHIVE_FILENAME;
+	}
+	std::string GetPipelinesPath()
+	{
+		return wiRenderer::GetShaderPath() + PIPELINES_FILENAME;
+	}
+	uint64_t GetEngineVersion()
+	{
+		return (uint64_t)wiHelper::string_hash(wiVersion::GetVersionString().c_str());
+	}
+	bool ReadHeader(const std::vector<uint8_t>& data, uint32_t magic, size_t elementSize, FileHeader& header)
+	{
+		if (data.size() < sizeof(FileHeader))
+		{
+			return false;
+		}
+		memcpy(&header, data.data(), sizeof(FileHeader));
+		return
+			header.magic == magic &&
+			header.fileVersion == FILE_VERSION &&
+			header.engineVersion == GetEngineVersion() &&
+			data.size() >= sizeof(FileHeader) + (uint64_t)header.count * elementSize;
+	}
+
+	// Identifies the pipeline state between sessions by the names of its shaders and the contents of its states. Returns 0 if one of its shaders
+	//	wasn't loaded by name. The locker must be held
+	uint64_t ComputePipelineKey(const PipelineStateDesc& desc)
+	{
+		size_t key = 0;
+		const Shader* stages[] = { desc.vs, desc.ps, desc.hs, desc.ds, desc.gs };
+		for (const Shader* shader : stages)
+		{
+			uint64_t name = 0;
+			if (shader != nullptr)
+			{
+				auto it = shaderNames.find(shader);
+				if (it == shaderNames.end())
+				{
+					return 0;
+				}
+				name = it->second;
+			}
+			wiHelper::hash_combine(key, name);
+		}
+		if (desc.il != nullptr)
+		{
+			for (const InputLayoutDesc& element : desc.il->desc)
+			{
+				wiHelper::hash_combine(key, wiHelper::string_hash(element.SemanticName.c_str()));
+				wiHelper::hash_combine(key, element.SemanticIndex);
+				wiHelper::hash_combine(key, element.Format);
+				wiHelper::hash_combine(key, element.InputSlot);
+				wiHelper::hash_combine(key, element.AlignedByteOffset);
+				wiHelper::hash_combine(key, element.InputSlotClass);
+				wiHelper::hash_combine(key, element.InstanceDataStepRate);
+			}
+		}
+		wiHelper::hash_combine(key, desc.il != nullptr);
+		if (desc.rs != nullptr)
+		{
+			const RasterizerStateDesc& rs = desc.rs->desc;
+			wiHelper::hash_combine(key, rs.FillMode);
+			wiHelper::hash_combine(key, rs.CullMode);
+			wiHelper::hash_combine(key, rs.FrontCounterClockwise);
+			wiHelper::hash_combine(key, rs.DepthBias);
+			wiHelper::hash_combine(key, rs.DepthBiasClamp);
+			wiHelper::hash_combine(key, rs.SlopeScaledDepthBias);
+			wiHelper::hash_combine(key, rs.DepthClipEnable);
+			wiHelper::hash_combine(key, rs.MultisampleEnable);
+			wiHelper::hash_combine(key, rs.AntialiasedLineEnable);
+			wiHelper::hash_combine(key, rs.ConservativeRasterizationEnable);
+			wiHelper::hash_combine(key, rs.ForcedSampleCount);
+		}
+		wiHelper::hash_combine(key, desc.rs != nullptr);
+		if (desc.bs != nullptr)
+		{
+			const BlendStateDesc& bs = desc.bs->desc;
+			wiHelper::hash_combine(key, bs.AlphaToCoverageEnable);
+			wiHelper::hash_combine(key, bs.IndependentBlendEnable);
+			for (const RenderTargetBlendStateDesc& rt : bs.RenderTarget)
+			{
+				wiHelper::hash_combine(key, rt.BlendEnable);
+				wiHelper::hash_combine(key, rt.SrcBlend);
+				wiHelper::hash_combine(key, rt.DestBlend);
+				wiHelper::hash_combine(key, rt.BlendOp);
+				wiHelper::hash_combine(key, rt.SrcBlendAlpha);
+				wiHelper::hash_combine(key, rt.DestBlendAlpha);
+				wiHelper::hash_combine(key, rt.BlendOpAlpha);
+				wiHelper::hash_combine(key, rt.RenderTargetWriteMask);
+			}
+		}
+		wiHelper::hash_combine(key, desc.bs != nullptr);
+		if (desc.dss != nullptr)
+		{
+			const DepthStencilStateDesc& dss = desc.dss->desc;
+			wiHelper::hash_combine(key, dss.DepthEnable);
+			wiHelper::hash_combine(key, dss.DepthWriteMask);
+			wiHelper::hash_combine(key, dss.DepthFunc);
+			wiHelper::hash_combine(key, dss.StencilEnable);
+			wiHelper::hash_combine(key, dss.StencilReadMask);
+			wiHelper::hash_combine(key, dss.StencilWriteMask);
+			const DepthStencilOpDesc* faces[] = { &dss.FrontFace, &dss.BackFace };
+			for (const DepthStencilOpDesc* face : faces)
+			{
+				wiHelper::hash_combine(key, face->StencilFailOp);
+				wiHelper::hash_combine(key, face->StencilDepthFailOp);
+				wiHelper::hash_combine(key, face->StencilPassOp);
+				wiHelper::hash_combine(key, face->StencilFunc);
+			}
+		}
+		wiHelper::hash_combine(key, desc.dss != nullptr);
+		wiHelper::hash_combine(key, desc.pt);
+		wiHelper::hash_combine(key, desc.sampleMask);
+		return key == 0 ? 1 : (uint64_t)key;
+	}
+	size_t ComputeLayoutKey(const Permutation& permutation)
+	{
+		size_t key = 0;
+		wiHelper::hash_combine(key, permutation.numAttachments);
+		for (uint32_t i = 0; i < permutation.numAttachments; ++i)
+		{
+			wiHelper::hash_combine(key, permutation.attachments[i].type);
+			wiHelper::hash_combine(key, permutation.attachments[i].format);
+			wiHelper::hash_combine(key, permutation.attachments[i].sampleCount);
+		}
+		return key;
+	}
+	uint64_t ComputePermutationKey(const Permutation& permutation)
+	{
+		size_t key = ComputeLayoutKey(permutation);
+		wiHelper::hash_combine(key, permutation.pipeline);
+		return (uint64_t)key;
+	}
+
+	// The locker must be held
+	void AddPermutation(const Permutation& permutation, bool dirty)
+	{
+		if (permutationKeys.insert(ComputePermutationKey(permutation)).second)
+		{
+			permutations.push_back(permutation);
+			if (dirty)
+			{
+				permutationsDirty.store(true);
+			}
+			statistics.pipelinePermutations = (uint32_t)permutations.size();
+		}
+	}
+	// The locker must be held
+	void LoadPermutations()
+	{
+		if (permutationsLoaded)
+		{
+			return;
+		}
+		permutationsLoaded = true;
+
+		std::vector<uint8_t> data;
+		FileHeader header;
+		if (!wiHelper::FileRead(GetPipelinesPath(), data) || !ReadHeader(data, PIPELINES_MAGIC, sizeof(Permutation), header))
+		{
+			return;
+		}
+		for (uint32_t i = 0; i < header.count; ++i)
+		{
+			Permutation permutation;
+			memcpy(&permutation, data.data() + sizeof(FileHeader) + i * sizeof(Permutation), sizeof(Permutation));
+			if (permutation.numAttachments <= arraysize(permutation.attachments))
+			{
+				AddPermutation(permutation, false);
+			}
+		}
+	}
+	// The locker must be held
+	bool SavePermutations()
+	{
+		permutationsDirty.store(false);
+
+		FileHeader header = {};
+		header.magic = PIPELINES_MAGIC;
+		header.fileVersion = FILE_VERSION;
+		header.engineVersion = GetEngineVersion();
+		header.count = (uint32_t)permutations.size();
+
+		std::vector<uint8_t> data(sizeof(FileHeader) + permutations.size() * sizeof(Permutation));
+		memcpy(data.data(), &header, sizeof(header));
+		if (!permutations.empty())
+		{
+			memcpy(data.data() + sizeof(FileHeader), permutations.data(), permutations.size() * sizeof(Permutation));
+		}
+		return wiHelper::FileWrite(GetPipelinesPath(), data.data(), data.size());
+	}
+
+
+	bool LoadArchive()
+	{
+		Clear();
+		if (!enabled)
+		{
+			return false;
+		}
+
+		wiTimer timer;
+		std::vector<uint8_t> data;
+		if (!wiHelper::FileRead(GetArchivePath(), data))
+		{
+			return false;
+		}
+		statistics.archiveReadTime = timer.elapsed();
+		statistics.archiveSize = data.size();
+
+		FileHeader header;
+		if (!ReadHeader(data, ARCHIVE_MAGIC, sizeof(ArchiveEntry), header))
+		{
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(locker);
+
+		std::vector<ShaderEntry*> entries;
+		std::vector<const std::string*> names;
+		entries.reserve(header.count);
+		names.reserve(header.count);
+		for (uint32_t i = 0; i < header.count; ++i)
+		{
+			ArchiveEntry entry;
+			memcpy(&entry, data.data() + sizeof(FileHeader) + i * sizeof(ArchiveEntry), sizeof(ArchiveEntry));
+			if (entry.stage >= SHADERSTAGE_COUNT ||
+				entry.nameOffset + entry.nameLength > data.size() ||
+				entry.dataOffset + entry.dataSize > data.size())
+			{
+				shaders.clear();
+				return false;
+			}
+			auto it = shaders.insert(std::make_pair(std::string((const char*)data.data() + entry.nameOffset, entry.nameLength), ShaderEntry())).first;
+			ShaderEntry& shader = it->second;
+			shader.stage = (SHADERSTAGE)entry.stage;
+			shader.bytecode.assign(data.data() + entry.dataOffset, data.data() + entry.dataOffset + entry.dataSize);
+			shader.fileSize = entry.fileSize;
+			shader.fileTime = entry.fileTime;
+			entries.push_back(&shader);
+			names.push_back(&it->first);
+		}
+
+		// Every shader is a separate job. Shaders whose file was changed are not created, so they will be loaded from the file:
+		timer.record();
+		GraphicsDevice* device = wiRenderer::GetDevice();
+		const std::string& shaderPath = wiRenderer::GetShaderPath();
+		std::atomic<uint32_t> created{ 0 };
+		std::atomic<uint32_t> stale{ 0 };
+		wiJobSystem::context ctx;
+		wiJobSystem::Dispatch(ctx, (uint32_t)entries.size(), 1, [&](wiJobArgs args) {
+			ShaderEntry& entry = *entries[args.jobIndex];
+			uint64_t fileSize, fileTime;
+			if (wiHelper::FileStatus(shaderPath + *names[args.jobIndex], fileSize, fileTime) && (fileSize != entry.fileSize || fileTime != entry.fileTime))
+			{
+				stale.fetch_add(1);
+			}
+			else if (device->CreateShader(entry.stage, entry.bytecode.data(), entry.bytecode.size(), &entry.shader))
+			{
+				created.fetch_add(1);
+			}
+			else
+			{
+				entry.shader = Shader();
+			}
+		});
+		wiJobSystem::Wait(ctx);
+		statistics.archiveCreateTime = timer.elapsed();
+		statistics.archiveShaders = created.load();
+		statistics.staleShaders = stale.load();
+
+		return true;
+	}
+
+	bool SaveArchive()
+	{
+		std::lock_guard<std::mutex> lock(locker);
+		if (!enabled || !archiveDirty || shaders.empty())
+		{
+			return false;
+		}
+		archiveDirty = false;
+
+		// Sorted by name, so the same shaders always give the same archive:
+		std::vector<const std::pair<const std::string, ShaderEntry>*> sorted;
+		sorted.reserve(shaders.size());
+		size_t nameSize = 0;
+		size_t dataSize = 0;
+		for (auto& x : shaders)
+		{
+			sorted.push_back(&x);
+			nameSize += x.first.length();
+			dataSize += x.second.bytecode.size();
+		}
+		std::sort(sorted.begin(), sorted.end(), [](const std::pair<const std::string, ShaderEntry>* a, const std::pair<const std::string, ShaderEntry>* b) {
+			return a->first < b->first;
+		});
+
+		FileHeader header = {};
+		header.magic = ARCHIVE_MAGIC;
+		header.fileVersion = FILE_VERSION;
+		header.engineVersion = GetEngineVersion();
+		header.count = (uint32_t)sorted.size();
+
+		const size_t indexOffset = sizeof(FileHeader);
+		size_t nameOffset = indexOffset + sorted.size() * sizeof(ArchiveEntry);
+		size_t dataOffset = nameOffset + nameSize;
+		std::vector<uint8_t> data(dataOffset + dataSize);
+		memcpy(data.data(), &header, sizeof(header));
+		for (size_t i = 0; i < sorted.size(); ++i)
+		{
+			const std::string& name = sorted[i]->first;
+			const ShaderEntry& shader = sorted[i]->second;
+
+			ArchiveEntry entry = {};
+			entry.stage = (uint32_t)shader.stage;
+			entry.nameLength = (uint32_t)name.length();
+			entry.nameOffset = nameOffset;
+			entry.dataOffset = dataOffset;
+			entry.dataSize = shader.bytecode.size();
+			entry.fileSize = shader.fileSize;
+			entry.fileTime = shader.fileTime;
+			memcpy(data.data() + indexOffset + i * sizeof(ArchiveEntry), &entry, sizeof(entry));
+
+			memcpy(data.data() + nameOffset, name.data(), name.length());
+			nameOffset += name.length();
+			if (!shader.bytecode.empty())
+			{
+				memcpy(data.data() + dataOffset, shader.bytecode.data(), shader.bytecode.size());
+				dataOffset += shader.bytecode.size();
+			}
+		}
+
+		return wiHelper::FileWrite(GetArchivePath(), data.data(), data.size());
+	}
+
+	bool GetShader(const std::string& filename, SHADERSTAGE stage, Shader& shader)
+	{
+		if (!enabled)
+		{
+			return false;
+		}
+		std::lock_guard<std::mutex> lock(locker);
+		auto it = shaders.find(filename);
+		if (it == shaders.end() || it->second.stage != stage || !it->second.shader.IsValid())
+		{
+			return false;
+		}
+		shader = it->second.shader;
+		shaderNames[&shader] = wiHelper::string_hash(filename.c_str());
+		return true;
+	}
+
+	void RegisterShader(const std::string& filename, SHADERSTAGE stage, const Shader& shader, std::vector<uint8_t>&& bytecode)
+	{
+		if (!enabled)
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> lock(locker);
+		shaderNames[&shader] = wiHelper::string_hash(filename.c_str());
+
+		ShaderEntry& entry = shaders[filename];
+		entry.stage = stage;
+		entry.bytecode = std::move(bytecode);
+		if (!wiHelper::FileStatus(wiRenderer::GetShaderPath() + filename, entry.fileSize, entry.fileTime))
+		{
+			entry.fileSize = 0;
+			entry.fileTime = 0;
+		}
+		entry.shader = shader;
+		archiveDirty = true;
+		statistics.fileShaders++;
+	}
+
+	void Clear()
+	{
+		std::lock_guard<std::mutex> lock(locker);
+		shaders.clear();
+		archiveDirty = false;
+		statistics.archiveShaders = 0;
+		statistics.fileShaders = 0;
+		statistics.staleShaders = 0;
+	}
+
+
+	void RegisterPipelineState(const PipelineState* pso)
+	{
+		if (!enabled)
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> lock(locker);
+		const uint64_t key = ComputePipelineKey(pso->desc);
+		if (key != 0)
+		{
+			// A copy is kept, which shares the device object of the pipeline state. The device identifies it by its hash:
+			pipelineStates[key] = *pso;
+			statistics.pipelineStates = (uint32_t)pipelineStates.size();
+		}
+	}
+
+	void RecordPipelinePermutation(const PipelineState* pso, const RenderPass* renderpass)
+	{
+		if (!enabled || pso == nullptr || renderpass == nullptr)
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> lock(locker);
+
+		Permutation permutation = {};
+		permutation.pipeline = ComputePipelineKey(pso->desc);
+		if (permutation.pipeline == 0)
+		{
+			return;
+		}
+		const RenderPassDesc& desc = renderpass->desc;
+		permutation.numAttachments = std::min(desc.numAttachments, (uint32_t)arraysize(permutation.attachments));
+		for (uint32_t i = 0; i < permutation.numAttachments; ++i)
+		{
+			if (desc.attachments[i].texture == nullptr)
+			{
+				return;
+			}
+			permutation.attachments[i].type = (uint32_t)desc.attachments[i].type;
+			permutation.attachments[i].format = (uint32_t)desc.attachments[i].texture->desc.Format;
+			permutation.attachments[i].sampleCount = desc.attachments[i].texture->desc.SampleCount;
+		}
+		LoadPermutations();
+		AddPermutation(permutation, true);
+	}
+
+	void WarmUpPipelineStates()
+	{
+		if (!enabled)
+		{
+			return;
+		}
+		wiTimer timer;
+		GraphicsDevice* device = wiRenderer::GetDevice();
+
+		struct WarmUp
+		{
+			const PipelineState* pso;
+			size_t layout;
+		};
+		std::vector<WarmUp> warmups;
+		{
+			std::lock_guard<std::mutex> lock(locker);
+			LoadPermutations();
+
+			// Render passes with every attachment layout of the permutations, the permutations are sorted by them:
+			warmupRenderPasses.clear();
+			warmupTextures.clear();
+			std::unordered_map<size_t, size_t> layouts;
+			for (const Permutation& permutation : permutations)
+			{
+				auto it = pipelineStates.find(permutation.pipeline);
+				if (it == pipelineStates.end())
+				{
+					continue; // not created in this session
+				}
+				const size_t layoutKey = ComputeLayoutKey(permutation);
+				auto layout = layouts.find(layoutKey);
+				if (layout == layouts.end())
+				{
+					layout = layouts.insert(std::make_pair(layoutKey, warmupRenderPasses.size())).first;
+					warmupRenderPasses.emplace_back();
+					warmupRenderPasses.back().desc.numAttachments = permutation.numAttachments;
+					for (uint32_t i = 0; i < permutation.numAttachments; ++i)
+					{
+						// The texture is set after every texture is created:
+						RenderPassAttachment& attachment = warmupRenderPasses.back().desc.attachments[i];
+						attachment.type = (RenderPassAttachment::TYPE)permutation.attachments[i].type;
+						attachment.loadop = RenderPassAttachment::LOADOP_DONTCARE;
+						attachment.storeop = RenderPassAttachment::STOREOP_DONTCARE;
+						attachment.initial_layout = attachment.type == RenderPassAttachment::RENDERTARGET ? IMAGE_LAYOUT_RENDERTARGET : IMAGE_LAYOUT_DEPTHSTENCIL;
+						attachment.final_layout = attachment.initial_layout;
+
+						TextureDesc desc;
+						desc.Width = 1;
+						desc.Height = 1;
+						desc.Format = (FORMAT)permutation.attachments[i].format;
+						desc.SampleCount = permutation.attachments[i].sampleCount;
+						desc.BindFlags = attachment.type == RenderPassAttachment::RENDERTARGET ? BIND_RENDER_TARGET : BIND_DEPTH_STENCIL;
+						desc.layout = attachment.initial_layout;
+						warmupTextures.emplace_back();
+						device->CreateTexture(&desc, nullptr, &warmupTextures.back());
+					}
+				}
+				warmups.push_back({ &it->second, layout->second });
+			}
+		}
+
+		size_t texture = 0;
+		for (RenderPass& renderpass : warmupRenderPasses)
+		{
+			for (uint32_t i = 0; i < renderpass.desc.numAttachments; ++i)
+			{
+				renderpass.desc.attachments[i].texture = &warmupTextures[texture++];
+			}
+			RenderPassDesc desc = renderpass.desc;
+			device->CreateRenderPass(&desc, &renderpass);
+		}
+
+		std::sort(warmups.begin(), warmups.end(), [](const WarmUp& a, const WarmUp& b) {
+			return a.layout < b.layout;
+		});
+
+		// The permutations are split between command lists that are recorded in parallel. Binding the pipeline state inside a render pass
+		//	compiles it, nothing is drawn:
+		const uint32_t commandlistCount = std::max(1u, std::min((uint32_t)warmups.size(), std::min(wiJobSystem::GetThreadCount(), MAX_WARMUP_COMMANDLISTS)));
+		const uint32_t perCommandlist = ((uint32_t)warmups.size() + commandlistCount - 1) / commandlistCount;
+		CommandList commandlists[MAX_WARMUP_COMMANDLISTS];
+		for (uint32_t i = 0; i < commandlistCount; ++i)
+		{
+			commandlists[i] = device->BeginCommandList();
+		}
+		wiJobSystem::context ctx;
+		wiJobSystem::Dispatch(ctx, commandlistCount, 1, [&](wiJobArgs args) {
+			const CommandList cmd = commandlists[args.jobIndex];
+			const size_t first = args.jobIndex * perCommandlist;
+			const size_t last = std::min(warmups.size(), first + perCommandlist);
+			const size_t none = ~size_t(0);
+			size_t layout = none;
+			for (size_t i = first; i < last; ++i)
+			{
+				if (warmups[i].layout != layout)
+				{
+					if (layout != none)
+					{
+						device->RenderPassEnd(cmd);
+					}
+					layout = warmups[i].layout;
+					device->RenderPassBegin(&warmupRenderPasses[layout], cmd);
+				}
+				device->BindPipelineState(warmups[i].pso, cmd);
+			}
+			if (layout != none)
+			{
+				device->RenderPassEnd(cmd);
+			}
+		});
+		wiJobSystem::Wait(ctx);
+
+		statistics.warmUpTime = timer.elapsed();
+		statistics.warmedUpPermutations = (uint32_t)warmups.size();
+	}
+
+	void Update()
+	{
+		if (!enabled || !permutationsDirty.load() || permutationsSaveTimer.elapsed() < PIPELINES_SAVE_INTERVAL)
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> lock(locker);
+		SavePermutations();
+		permutationsSaveTimer.record();
+	}
+
+	void SetEnabled(bool value)
+	{
+		enabled = value;
+	}
+	bool IsEnabled()
+	{
+		return enabled;
+	}
+
+	const Statistics& GetStatistics()
+	{
+		return statistics;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiGraphicsDevice.h"
+
+#include <string>
+#include <vector>
+
+// Shader archive and pipeline state warm-up to shorten the startup
+//	Shader archive: the compiled shaders of the shader path are packed into one indexed file. It is read with one file read, then every shader
+//	in it is created in parallel before the engine systems load their shaders, so wiRenderer::LoadShader() only has to look them up.
+//	Shaders that are not in the archive are loaded from their own files as before, and the archive is written again with them.
+//	Every archived shader stores the size and modification time of its file. If the file exists and is different (it was recompiled), the
+//	shader is loaded from the file instead, and the archive is written again with it. The archive is also rebuilt when the engine version changes.
+//	Pipeline state warm-up: graphics devices that compile the pipeline state for every render pass layout on first use (DX12, Vulkan) report
+//	these permutations here. They are saved next to the archive, and the next session compiles them before the first frame.
+//	Only the pipeline states that use shaders loaded by wiRenderer::LoadShader() can be identified between sessions.
+namespace wiShaderCache
+{
+	struct Statistics
+	{
+		double archiveReadTime = 0;			// milliseconds
+		double archiveCreateTime = 0;		// creating the shaders of the archive in parallel, milliseconds
+		double warmUpTime = 0;				// milliseconds
+		uint64_t archiveSize = 0;			// bytes
+		uint32_t archiveShaders = 0;		// shaders created from the archive
+		uint32_t fileShaders = 0;			// shaders that were loaded from their own files
+		uint32_t staleShaders = 0;			// archived shaders that were skipped because their file changed
+		uint32_t pipelineStates = 0;		// pipeline states that can be warmed up
+		uint32_t pipelinePermutations = 0;	// pipeline state permutations that were recorded (in this and in the previous session)
+		uint32_t warmedUpPermutations = 0;	// pipeline state permutations that were compiled by the warm-up
+	};
+
+	// Reads the archive of the current shader path and creates its shaders in parallel. Returns false if there is no valid archive
+	bool LoadArchive();
+	// Writes the archive of the current shader path if shaders were loaded from files since it was read
+	bool SaveArchive();
+	// Returns the shader from the archive, or false if it is not in the archive
+	bool GetShader(const std::string& filename, wiGraphics::SHADERSTAGE stage, wiGraphics::Shader& shader);
+	// Stores the shader that was loaded from its file, so it will be in the archive
+	void RegisterShader(const std::string& filename, wiGraphics::SHADERSTAGE stage, const wiGraphics::Shader& shader, std::vector<uint8_t>&& bytecode);
+	// Drops every archived shader, the following shaders will be loaded from their files
+	void Clear();
+
+	// The graphics device created a pipeline state
+	void RegisterPipelineState(const wiGraphics::PipelineState* pso);
+	// The graphics device compiled the pipeline state for the layout of the render pass
+	void RecordPipelinePermutation(const wiGraphics::PipelineState* pso, const wiGraphics::RenderPass* renderpass);
+	// Compiles the pipeline state permutations of the previous session. It records command lists, so it must be called on the thread
+	//	that presents the frame, after the pipeline states are created
+	void WarmUpPipelineStates();
+	// Writes the recorded pipeline state permutations if there are new ones, at most every few seconds
+	void Update();
+
+	void SetEnabled(bool value);
+	bool IsEnabled();
+
+	const Statistics& GetStatistics();
+}
@@ -187,12 +187,12 @@ int wiSpriteFont_BindLua::GetSize(lua_State* L)
 }
 int wiSpriteFont_BindLua::GetPos(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVectorSet((float)font.params.posX, (float)font.params.posY, 0, 0)));
+	Luna<Vector_BindLua>::create(L, XMVectorSet((float)font.params.posX, (float)font.params.posY, 0, 0));
 	return 1;
 }
 int wiSpriteFont_BindLua::GetSpacing(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMVectorSet((float)font.params.spacingX, (float)font.params.spacingY, 0, 0)));
+	Luna<Vector_BindLua>::create(L, XMVectorSet((float)font.params.spacingX, (float)font.params.spacingY, 0, 0));
 	return 1;
 }
 int wiSpriteFont_BindLua::GetAlign(lua_State* L)
@@ -204,13 +204,13 @@ int wiSpriteFont_BindLua::GetAlign(lua_State* L)
 int wiSpriteFont_BindLua::GetColor(lua_State* L)
 {
 	XMFLOAT4 C = font.params.color.toFloat4();
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat4(&C)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat4(&C));
 	return 1;
 }
 int wiSpriteFont_BindLua::GetShadowColor(lua_State* L)
 {
 	XMFLOAT4 C = font.params.color.toFloat4();
-	Luna<Vector_BindLua>::push(L, new Vector_BindLua(XMLoadFloat4(&C)));
+	Luna<Vector_BindLua>::create(L, XMLoadFloat4(&C));
 	return 1;
 }
 
@@ -56,7 +56,7 @@ int wiSprite_BindLua::SetParams(lua_State *L)
 }
 int wiSprite_BindLua::GetParams(lua_State *L)
 {
-	Luna<wiImageParams_BindLua>::push(L, new wiImageParams_BindLua(sprite.params));
+	Luna<wiImageParams_BindLua>::create(L, sprite.params);
 	return 1;
 }
 int wiSprite_BindLua::SetAnim(lua_State *L)
@@ -78,7 +78,7 @@ int wiSprite_BindLua::SetAnim(lua_State *L)
 }
 int wiSprite_BindLua::GetAnim(lua_State *L)
 {
-	Luna<SpriteAnim_BindLua>::push(L, new SpriteAnim_BindLua(sprite.anim));
+	Luna<SpriteAnim_BindLua>::create(L, sprite.anim);
 	return 1;
 }
 
@@ -0,0 +1,1255 @@
+#include "wiTextureCooker.h"
+#include "wiJobSystem.h"
+#include "wiHelper.h"
+#include "wiMath.h"
+
+#include "Utility/tinyddsloader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+using namespace wiGraphics;
+
+namespace wiTextureCooker
+{
+	std::string cacheDirectory = wiHelper::GetOriginalWorkingDirectory() + "cooked/";
+	std::atomic_bool enabled{ false };
+
+	// Increment this when the output of the cooker changes, so that the cache is invalidated:
+	static const uint32_t COOKER_VERSION = 1;
+
+	// Reads a 4x4 pixel block, pixels outside the image are clamped to the edge
+	inline void LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t block[64])
+	{
+		for (uint32_t y = 0; y < 4; ++y)
+		{
+			const uint32_t py = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; ++x)
+			{
+				const uint32_t px = std::min(blockX * 4 + x, width - 1);
+				memcpy(block + (y * 4 + x) * 4, rgba + (size_t(py) * width + px) * 4, 4);
+			}
+		}
+	}
+	inline void StoreBlock(uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, const uint8_t block[64])
+	{
+		for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; ++y)
+		{
+			for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; ++x)
+			{
+				memcpy(rgba + (size_t(blockY * 4 + y) * width + blockX * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+			}
+		}
+	}
+
+	// Principal axis of the block colors, endpoints are the extents of the colors along the axis.
+	//	channelMask selects the channels (xyzw) that participate
+	void FitEndpointsPCA(const XMVECTOR pixels[16], XMVECTOR channelMask, XMVECTOR& endpoint0, XMVECTOR& endpoint1)
+	{
+		XMVECTOR mean = XMVectorZero();
+		XMVECTOR minColor = XMVectorReplicate(255);
+		XMVECTOR maxColor = XMVectorZero();
+		for (int i = 0; i < 16; ++i)
+		{
+			mean += pixels[i];
+			minColor = XMVectorMin(minColor, pixels[i]);
+			maxColor = XMVectorMax(maxColor, pixels[i]);
+		}
+		mean = mean * (1.0f / 16.0f) * channelMask;
+
+		// Covariance matrix rows, then power iteration starting from the bounding box diagonal:
+		XMMATRIX covariance = XMMatrixSet(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+		for (int i = 0; i < 16; ++i)
+		{
+			const XMVECTOR d = (pixels[i] * channelMask) - mean;
+			covariance.r[0] += d * XMVectorSplatX(d);
+			covariance.r[1] += d * XMVectorSplatY(d);
+			covariance.r[2] += d * XMVectorSplatZ(d);
+			covariance.r[3] += d * XMVectorSplatW(d);
+		}
+		XMVECTOR axis = (maxColor - minColor) * channelMask;
+		for (int iteration = 0; iteration < 8; ++iteration)
+		{
+			axis =
+				covariance.r[0] * XMVectorSplatX(axis) +
+				covariance.r[1] * XMVectorSplatY(axis) +
+				covariance.r[2] * XMVectorSplatZ(axis) +
+				covariance.r[3] * XMVectorSplatW(axis);
+			const float lengthSq = XMVectorGetX(XMVector4LengthSq(axis));
+			if (lengthSq < 1e-12f)
+			{
+				break;
+			}
+			axis *= 1.0f / std::sqrt(lengthSq);
+		}
+		if (XMVectorGetX(XMVector4LengthSq(axis)) < 1e-12f)
+		{
+			endpoint0 = mean;
+			endpoint1 = mean;
+			return;
+		}
+
+		float minT = FLT_MAX;
+		float maxT = -FLT_MAX;
+		for (int i = 0; i < 16; ++i)
+		{
+			const float t = XMVectorGetX(XMVector4Dot((pixels[i] * channelMask) - mean, axis));
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+		endpoint0 = XMVectorClamp(mean + axis * minT, XMVectorZero(), XMVectorReplicate(255));
+		endpoint1 = XMVectorClamp(mean + axis * maxT, XMVectorZero(), XMVectorReplicate(255));
+	}
+
+	// Least squares endpoints for the given interpolation weights (0: endpoint0, 1: endpoint1)
+	bool RefineEndpoints(const XMVECTOR pixels[16], const float weights[16], XMVECTOR& endpoint0, XMVECTOR& endpoint1)
+	{
+		float a = 0, b = 0, c = 0;
+		XMVECTOR X = XMVectorZero();
+		XMVECTOR Y = XMVectorZero();
+		for (int i = 0; i < 16; ++i)
+		{
+			const float w = weights[i];
+			a += (1 - w) * (1 - w);
+			b += (1 - w) * w;
+			c += w * w;
+			X += pixels[i] * (1 - w);
+			Y += pixels[i] * w;
+		}
+		const float det = a * c - b * b;
+		if (std::abs(det) < 1e-6f)
+		{
+			return false;
+		}
+		endpoint0 = XMVectorClamp((X * c - Y * b) * (1.0f / det), XMVectorZero(), XMVectorReplicate(255));
+		endpoint1 = XMVectorClamp((Y * a - X * b) * (1.0f / det), XMVectorZero(), XMVectorReplicate(255));
+		return true;
+	}
+
+	// Chooses the nearest palette entry for every pixel, returns the sum of squared errors
+	template<int count>
+	float SelectIndices(const XMVECTOR pixels[16], const XMVECTOR palette[count], XMVECTOR channelMask, uint8_t indices[16])
+	{
+		float totalError = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			float bestError = FLT_MAX;
+			for (int j = 0; j < count; ++j)
+			{
+				const float error = XMVectorGetX(XMVector4LengthSq((pixels[i] - palette[j]) * channelMask));
+				if (error < bestError)
+				{
+					bestError = error;
+					indices[i] = (uint8_t)j;
+				}
+			}
+			totalError += bestError;
+		}
+		return totalError;
+	}
+
+
+	// BC1:
+
+	inline uint16_t PackRGB565(XMVECTOR color)
+	{
+		XMFLOAT4 c;
+		XMStoreFloat4(&c, color);
+		const uint32_t r = std::min(31u, uint32_t(c.x * 31.0f / 255.0f + 0.5f));
+		const uint32_t g = std::min(63u, uint32_t(c.y * 63.0f / 255.0f + 0.5f));
+		const uint32_t b = std::min(31u, uint32_t(c.z * 31.0f / 255.0f + 0.5f));
+		return uint16_t((r << 11) | (g << 5) | b);
+	}
+	inline XMVECTOR UnpackRGB565(uint16_t value)
+	{
+		const uint32_t r = (value >> 11) & 31;
+		const uint32_t g = (value >> 5) & 63;
+		const uint32_t b = value & 31;
+		return XMVectorSet(float((r << 3) | (r >> 2)), float((g << 2) | (g >> 4)), float((b << 3) | (b >> 2)), 255);
+	}
+	// Palette in the order of the 2-bit codes
+	inline void PaletteBC1(uint16_t color0, uint16_t color1, XMVECTOR palette[4])
+	{
+		palette[0] = UnpackRGB565(color0);
+		palette[1] = UnpackRGB565(color1);
+		if (color0 > color1)
+		{
+			palette[2] = (palette[0] * 2 + palette[1]) * (1.0f / 3.0f);
+			palette[3] = (palette[0] + palette[1] * 2) * (1.0f / 3.0f);
+		}
+		else
+		{
+			palette[2] = (palette[0] + palette[1]) * 0.5f;
+			palette[3] = XMVectorZero();
+		}
+	}
+
+	void EncodeBC1(const uint8_t block[64], uint8_t* dst, bool allowTransparency)
+	{
+		XMVECTOR pixels[16];
+		bool transparent[16];
+		bool anyTransparent = false;
+		for (int i = 0; i < 16; ++i)
+		{
+			pixels[i] = XMVectorSet(block[i * 4 + 0], block[i * 4 + 1], block[i * 4 + 2], 255);
+			transparent[i] = allowTransparency && block[i * 4 + 3] < 128;
+			anyTransparent |= transparent[i];
+		}
+		const XMVECTOR channelMask = XMVectorSet(1, 1, 1, 0);
+
+		// Candidate endpoint pairs: principal axis fit, then least squares refinement of it
+		XMVECTOR endpoint0, endpoint1;
+		FitEndpointsPCA(pixels, channelMask, endpoint0, endpoint1);
+
+		uint16_t bestColor0 = 0, bestColor1 = 0;
+		uint8_t bestIndices[16] = {};
+		float bestError = FLT_MAX;
+		for (int attempt = 0; attempt < 2; ++attempt)
+		{
+			uint16_t color0 = PackRGB565(endpoint1);
+			uint16_t color1 = PackRGB565(endpoint0);
+
+			// 4 color mode needs color0 > color1, 3 color mode with transparency needs color0 <= color1:
+			if ((color0 < color1) != anyTransparent && color0 != color1)
+			{
+				std::swap(color0, color1);
+			}
+
+			XMVECTOR palette[4];
+			PaletteBC1(color0, color1, palette);
+			uint8_t indices[16];
+			float error = 0;
+			if (anyTransparent)
+			{
+				// index 3 is transparent black in 3 color mode, it is only used by transparent pixels
+				error = SelectIndices<3>(pixels, palette, channelMask, indices);
+				for (int i = 0; i < 16; ++i)
+				{
+					if (transparent[i])
+					{
+						indices[i] = 3;
+					}
+				}
+			}
+			else if (color0 == color1)
+			{
+				// Both endpoints are equal, which would decode in 3 color mode, only the first entry is usable:
+				error = SelectIndices<1>(pixels, palette, channelMask, indices);
+			}
+			else
+			{
+				error = SelectIndices<4>(pixels, palette, channelMask, indices);
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				bestColor0 = color0;
+				bestColor1 = color1;
+				std::copy(indices, indices + 16, bestIndices);
+			}
+
+			if (attempt == 0 && !anyTransparent && color0 != color1)
+			{
+				static const float code_weights[4] = { 0, 1, 1.0f / 3.0f, 2.0f / 3.0f };
+				float weights[16];
+				for (int i = 0; i < 16; ++i)
+				{
+					weights[i] = code_weights[indices[i]];
+				}
+				XMVECTOR refined0 = palette[0];
+				XMVECTOR refined1 = palette[1];
+				if (!RefineEndpoints(pixels, weights, refined0, refined1))
+				{
+					break;
+				}
+				// The refined endpoints keep code 0 at color0 and code 1 at color1:
+				endpoint1 = refined0;
+				endpoint0 = refined1;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		uint32_t indexBits = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			indexBits |= uint32_t(bestIndices[i]) << (i * 2);
+		}
+		memcpy(dst + 0, &bestColor0, 2);
+		memcpy(dst + 2, &bestColor1, 2);
+		memcpy(dst + 4, &indexBits, 4);
+	}
+	void DecodeBC1(const uint8_t* src, uint8_t block[64], bool alwaysFourColors)
+	{
+		uint16_t color0, color1;
+		uint32_t indexBits;
+		memcpy(&color0, src + 0, 2);
+		memcpy(&color1, src + 2, 2);
+		memcpy(&indexBits, src + 4, 4);
+		XMVECTOR palette[4];
+		if (alwaysFourColors)
+		{
+			palette[0] = UnpackRGB565(color0);
+			palette[1] = UnpackRGB565(color1);
+			palette[2] = (palette[0] * 2 + palette[1]) * (1.0f / 3.0f);
+			palette[3] = (palette[0] + palette[1] * 2) * (1.0f / 3.0f);
+		}
+		else
+		{
+			PaletteBC1(color0, color1, palette);
+		}
+		for (int i = 0; i < 16; ++i)
+		{
+			XMFLOAT4 c;
+			XMStoreFloat4(&c, palette[(indexBits >> (i * 2)) & 3]);
+			block[i * 4 + 0] = uint8_t(c.x + 0.5f);
+			block[i * 4 + 1] = uint8_t(c.y + 0.5f);
+			block[i * 4 + 2] = uint8_t(c.z + 0.5f);
+			block[i * 4 + 3] = uint8_t(c.w + 0.5f);
+		}
+	}
+
+
+	// BC4:
+
+	inline void PaletteBC4(uint8_t value0, uint8_t value1, int palette[8])
+	{
+		palette[0] = value0;
+		palette[1] = value1;
+		if (value0 > value1)
+		{
+			for (int i = 2; i < 8; ++i)
+			{
+				palette[i] = ((8 - i) * value0 + (i - 1) * value1 + 3) / 7;
+			}
+		}
+		else
+		{
+			for (int i = 2; i < 6; ++i)
+			{
+				palette[i] = ((6 - i) * value0 + (i - 1) * value1 + 2) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+	// Encodes one channel of the block
+	void EncodeBC4(const uint8_t block[64], int channel, uint8_t* dst)
+	{
+		int minValue = 255;
+		int maxValue = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			const int value = block[i * 4 + channel];
+			minValue = std::min(minValue, value);
+			maxValue = std::max(maxValue, value);
+		}
+
+		// 8 interpolated values between the extents, or 6 values plus exact 0 and 255 when the block contains those:
+		uint64_t bestBits = 0;
+		int bestError = INT_MAX;
+		for (int mode = 0; mode < 2; ++mode)
+		{
+			uint8_t value0, value1;
+			if (mode == 0)
+			{
+				value0 = (uint8_t)maxValue;
+				value1 = (uint8_t)minValue;
+			}
+			else
+			{
+				int innerMin = 255;
+				int innerMax = 0;
+				for (int i = 0; i < 16; ++i)
+				{
+					const int value = block[i * 4 + channel];
+					if (value != 0 && value != 255)
+					{
+						innerMin = std::min(innerMin, value);
+						innerMax = std::max(innerMax, value);
+					}
+				}
+				if (innerMin > innerMax)
+				{
+					innerMin = innerMax = minValue;
+				}
+				value0 = (uint8_t)innerMin;
+				value1 = (uint8_t)innerMax;
+			}
+
+			int palette[8];
+			PaletteBC4(value0, value1, palette);
+			uint64_t bits = uint64_t(value0) | (uint64_t(value1) << 8);
+			int error = 0;
+			for (int i = 0; i < 16; ++i)
+			{
+				const int value = block[i * 4 + channel];
+				int bestIndex = 0;
+				int bestDiff = INT_MAX;
+				for (int j = 0; j < 8; ++j)
+				{
+					const int diff = std::abs(palette[j] - value);
+					if (diff < bestDiff)
+					{
+						bestDiff = diff;
+						bestIndex = j;
+					}
+				}
+				error += bestDiff * bestDiff;
+				bits |= uint64_t(bestIndex) << (16 + i * 3);
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				bestBits = bits;
+			}
+		}
+		memcpy(dst, &bestBits, 8);
+	}
+	void DecodeBC4(const uint8_t* src, int channel, uint8_t block[64])
+	{
+		uint64_t bits;
+		memcpy(&bits, src, 8);
+		int palette[8];
+		PaletteBC4(uint8_t(bits & 0xFF), uint8_t((bits >> 8) & 0xFF), palette);
+		for (int i = 0; i < 16; ++i)
+		{
+			block[i * 4 + channel] = (uint8_t)palette[(bits >> (16 + i * 3)) & 7];
+		}
+	}
+
+
+	// BC7, only single subset modes are used:
+	//	mode 6: 7.7.7.7 endpoints with unique p-bits, 4-bit indices, for blocks where alpha correlates with color
+	//	mode 5: 7.7.7 color and 8-bit alpha endpoints, separate 2-bit color and alpha indices
+
+	static const int bc7_weights2[4] = { 0, 21, 43, 64 };
+	static const int bc7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct BitWriter
+	{
+		uint8_t* data;
+		uint32_t position = 0;
+		void Write(uint32_t value, uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; ++i, ++position)
+			{
+				data[position >> 3] |= uint8_t(((value >> i) & 1) << (position & 7));
+			}
+		}
+	};
+	struct BitReader
+	{
+		const uint8_t* data;
+		uint32_t position = 0;
+		uint32_t Read(uint32_t count)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < count; ++i, ++position)
+			{
+				value |= uint32_t((data[position >> 3] >> (position & 7)) & 1) << i;
+			}
+			return value;
+		}
+	};
+
+	// Quantizes an RGBA endpoint to 7 bits per channel plus a shared p-bit, choosing the p-bit with less error
+	inline void QuantizeEndpointBC7(XMVECTOR endpoint, uint8_t quantized[4], uint8_t& pbit)
+	{
+		XMFLOAT4 e;
+		XMStoreFloat4(&e, endpoint);
+		const float values[4] = { e.x, e.y, e.z, e.w };
+		float bestError = FLT_MAX;
+		for (uint8_t p = 0; p < 2; ++p)
+		{
+			uint8_t q[4];
+			float error = 0;
+			for (int c = 0; c < 4; ++c)
+			{
+				const int value = std::min(127, std::max(0, int((values[c] - p) * 0.5f + 0.5f)));
+				q[c] = (uint8_t)value;
+				const float diff = float((value << 1) | p) - values[c];
+				error += diff * diff;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				pbit = p;
+				std::copy(q, q + 4, quantized);
+			}
+		}
+	}
+	inline void PaletteBC7(const uint8_t q0[4], uint8_t p0, const uint8_t q1[4], uint8_t p1, XMVECTOR palette[16])
+	{
+		int e0[4], e1[4];
+		for (int c = 0; c < 4; ++c)
+		{
+			e0[c] = (q0[c] << 1) | p0;
+			e1[c] = (q1[c] << 1) | p1;
+		}
+		for (int i = 0; i < 16; ++i)
+		{
+			const int w = bc7_weights4[i];
+			palette[i] = XMVectorSet(
+				float(((64 - w) * e0[0] + w * e1[0] + 32) >> 6),
+				float(((64 - w) * e0[1] + w * e1[1] + 32) >> 6),
+				float(((64 - w) * e0[2] + w * e1[2] + 32) >> 6),
+				float(((64 - w) * e0[3] + w * e1[3] + 32) >> 6)
+			);
+		}
+	}
+
+	float EncodeBC7Mode6(const uint8_t block[64], uint8_t* dst)
+	{
+		XMVECTOR pixels[16];
+		for (int i = 0; i < 16; ++i)
+		{
+			pixels[i] = XMVectorSet(block[i * 4 + 0], block[i * 4 + 1], block[i * 4 + 2], block[i * 4 + 3]);
+		}
+		const XMVECTOR channelMask = XMVectorSplatOne();
+
+		XMVECTOR endpoint0, endpoint1;
+		FitEndpointsPCA(pixels, channelMask, endpoint0, endpoint1);
+
+		uint8_t bestQ0[4] = {}, bestQ1[4] = {}, bestP0 = 0, bestP1 = 0;
+		uint8_t bestIndices[16] = {};
+		float bestError = FLT_MAX;
+		for (int attempt = 0; attempt < 2; ++attempt)
+		{
+			uint8_t q0[4], q1[4], p0, p1;
+			QuantizeEndpointBC7(endpoint0, q0, p0);
+			QuantizeEndpointBC7(endpoint1, q1, p1);
+			XMVECTOR palette[16];
+			PaletteBC7(q0, p0, q1, p1, palette);
+			uint8_t indices[16];
+			const float error = SelectIndices<16>(pixels, palette, channelMask, indices);
+			if (error < bestError)
+			{
+				bestError = error;
+				std::copy(q0, q0 + 4, bestQ0);
+				std::copy(q1, q1 + 4, bestQ1);
+				bestP0 = p0;
+				bestP1 = p1;
+				std::copy(indices, indices + 16, bestIndices);
+			}
+			if (attempt == 0)
+			{
+				float weights[16];
+				for (int i = 0; i < 16; ++i)
+				{
+					weights[i] = bc7_weights4[indices[i]] / 64.0f;
+				}
+				if (!RefineEndpoints(pixels, weights, endpoint0, endpoint1))
+				{
+					break;
+				}
+			}
+		}
+
+		// The most significant index bit of the first pixel is implicit zero, swap endpoints if needed:
+		if (bestIndices[0] & 8)
+		{
+			std::swap(bestQ0, bestQ1);
+			std::swap(bestP0, bestP1);
+			for (int i = 0; i < 16; ++i)
+			{
+				bestIndices[i] = 15 - bestIndices[i];
+			}
+		}
+
+		memset(dst, 0, 16);
+		BitWriter writer = { dst };
+		writer.Write(1 << 6, 7);
+		for (int c = 0; c < 4; ++c)
+		{
+			writer.Write(bestQ0[c], 7);
+			writer.Write(bestQ1[c], 7);
+		}
+		writer.Write(bestP0, 1);
+		writer.Write(bestP1, 1);
+		writer.Write(bestIndices[0], 3);
+		for (int i = 1; i < 16; ++i)
+		{
+			writer.Write(bestIndices[i], 4);
+		}
+		return bestError;
+	}
+	inline int ExpandBC7Mode5Color(int value)
+	{
+		return (value << 1) | (value >> 6);
+	}
+	float EncodeBC7Mode5(const uint8_t block[64], uint8_t* dst)
+	{
+		XMVECTOR pixels[16];
+		int minAlpha = 255;
+		int maxAlpha = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			pixels[i] = XMVectorSet(block[i * 4 + 0], block[i * 4 + 1], block[i * 4 + 2], 0);
+			minAlpha = std::min(minAlpha, int(block[i * 4 + 3]));
+			maxAlpha = std::max(maxAlpha, int(block[i * 4 + 3]));
+		}
+		const XMVECTOR channelMask = XMVectorSet(1, 1, 1, 0);
+
+		// Color:
+		XMVECTOR endpoint0, endpoint1;
+		FitEndpointsPCA(pixels, channelMask, endpoint0, endpoint1);
+
+		uint8_t bestQ0[3] = {}, bestQ1[3] = {};
+		uint8_t bestColorIndices[16] = {};
+		float bestColorError = FLT_MAX;
+		for (int attempt = 0; attempt < 2; ++attempt)
+		{
+			XMFLOAT4 e0, e1;
+			XMStoreFloat4(&e0, endpoint0);
+			XMStoreFloat4(&e1, endpoint1);
+			const float values0[3] = { e0.x, e0.y, e0.z };
+			const float values1[3] = { e1.x, e1.y, e1.z };
+			uint8_t q0[3], q1[3];
+			int c0[3], c1[3];
+			for (int c = 0; c < 3; ++c)
+			{
+				q0[c] = (uint8_t)std::min(127, int(values0[c] * 127.0f / 255.0f + 0.5f));
+				q1[c] = (uint8_t)std::min(127, int(values1[c] * 127.0f / 255.0f + 0.5f));
+				c0[c] = ExpandBC7Mode5Color(q0[c]);
+				c1[c] = ExpandBC7Mode5Color(q1[c]);
+			}
+			XMVECTOR palette[4];
+			for (int i = 0; i < 4; ++i)
+			{
+				const int w = bc7_weights2[i];
+				palette[i] = XMVectorSet(
+					float(((64 - w) * c0[0] + w * c1[0] + 32) >> 6),
+					float(((64 - w) * c0[1] + w * c1[1] + 32) >> 6),
+					float(((64 - w) * c0[2] + w * c1[2] + 32) >> 6),
+					0
+				);
+			}
+			uint8_t indices[16];
+			const float error = SelectIndices<4>(pixels, palette, channelMask, indices);
+			if (error < bestColorError)
+			{
+				bestColorError = error;
+				std::copy(q0, q0 + 3, bestQ0);
+				std::copy(q1, q1 + 3, bestQ1);
+				std::copy(indices, indices + 16, bestColorIndices);
+			}
+			if (attempt == 0)
+			{
+				float weights[16];
+				for (int i = 0; i < 16; ++i)
+				{
+					weights[i] = bc7_weights2[indices[i]] / 64.0f;
+				}
+				if (!RefineEndpoints(pixels, weights, endpoint0, endpoint1))
+				{
+					break;
+				}
+			}
+		}
+
+		// Alpha:
+		int alpha0 = maxAlpha;
+		int alpha1 = minAlpha;
+		uint8_t alphaIndices[16];
+		float alphaError = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			int bestDiff = INT_MAX;
+			for (int j = 0; j < 4; ++j)
+			{
+				const int w = bc7_weights2[j];
+				const int diff = std::abs(((64 - w) * alpha0 + w * alpha1 + 32) / 64 - int(block[i * 4 + 3]));
+				if (diff < bestDiff)
+				{
+					bestDiff = diff;
+					alphaIndices[i] = (uint8_t)j;
+				}
+			}
+			alphaError += float(bestDiff * bestDiff);
+		}
+
+		// The most significant index bits of the first pixel are implicit zero:
+		if (bestColorIndices[0] & 2)
+		{
+			std::swap(bestQ0, bestQ1);
+			for (int i = 0; i < 16; ++i)
+			{
+				bestColorIndices[i] = 3 - bestColorIndices[i];
+			}
+		}
+		if (alphaIndices[0] & 2)
+		{
+			std::swap(alpha0, alpha1);
+			for (int i = 0; i < 16; ++i)
+			{
+				alphaIndices[i] = 3 - alphaIndices[i];
+			}
+		}
+
+		memset(dst, 0, 16);
+		BitWriter writer = { dst };
+		writer.Write(1 << 5, 6);
+		writer.Write(0, 2); // no channel rotation
+		for (int c = 0; c < 3; ++c)
+		{
+			writer.Write(bestQ0[c], 7);
+			writer.Write(bestQ1[c], 7);
+		}
+		writer.Write(alpha0, 8);
+		writer.Write(alpha1, 8);
+		writer.Write(bestColorIndices[0], 1);
+		for (int i = 1; i < 16; ++i)
+		{
+			writer.Write(bestColorIndices[i], 2);
+		}
+		writer.Write(alphaIndices[0], 1);
+		for (int i = 1; i < 16; ++i)
+		{
+			writer.Write(alphaIndices[i], 2);
+		}
+		return bestColorError + alphaError;
+	}
+	void EncodeBC7(const uint8_t block[64], uint8_t* dst)
+	{
+		float error = EncodeBC7Mode6(block, dst);
+
+		// Separate alpha indices are only useful when alpha varies:
+		bool opaque = true;
+		for (int i = 0; i < 16 && opaque; ++i)
+		{
+			opaque = block[i * 4 + 3] == 255;
+		}
+		if (!opaque && error > 0)
+		{
+			uint8_t candidate[16];
+			if (EncodeBC7Mode5(block, candidate) < error)
+			{
+				memcpy(dst, candidate, 16);
+			}
+		}
+	}
+	void DecodeBC7(const uint8_t* src, uint8_t block[64])
+	{
+		BitReader reader = { src };
+		if (reader.Read(6) == (1 << 5))
+		{
+			reader.Read(2); // rotation is not written by the encoder
+			int c0[3], c1[3];
+			for (int c = 0; c < 3; ++c)
+			{
+				c0[c] = ExpandBC7Mode5Color(reader.Read(7));
+				c1[c] = ExpandBC7Mode5Color(reader.Read(7));
+			}
+			const int alpha0 = (int)reader.Read(8);
+			const int alpha1 = (int)reader.Read(8);
+			for (int i = 0; i < 16; ++i)
+			{
+				const int w = bc7_weights2[reader.Read(i == 0 ? 1 : 2)];
+				for (int c = 0; c < 3; ++c)
+				{
+					block[i * 4 + c] = uint8_t(((64 - w) * c0[c] + w * c1[c] + 32) >> 6);
+				}
+			}
+			for (int i = 0; i < 16; ++i)
+			{
+				const int w = bc7_weights2[reader.Read(i == 0 ? 1 : 2)];
+				block[i * 4 + 3] = uint8_t(((64 - w) * alpha0 + w * alpha1 + 32) >> 6);
+			}
+			return;
+		}
+		reader.position = 0;
+		if (reader.Read(7) != (1 << 6))
+		{
+			// Only modes 5 and 6 are written by the encoder, other modes decode as magenta:
+			for (int i = 0; i < 16; ++i)
+			{
+				block[i * 4 + 0] = 255;
+				block[i * 4 + 1] = 0;
+				block[i * 4 + 2] = 255;
+				block[i * 4 + 3] = 255;
+			}
+			return;
+		}
+		uint8_t q0[4], q1[4];
+		for (int c = 0; c < 4; ++c)
+		{
+			q0[c] = (uint8_t)reader.Read(7);
+			q1[c] = (uint8_t)reader.Read(7);
+		}
+		const uint8_t p0 = (uint8_t)reader.Read(1);
+		const uint8_t p1 = (uint8_t)reader.Read(1);
+		XMVECTOR palette[16];
+		PaletteBC7(q0, p0, q1, p1, palette);
+		for (int i = 0; i < 16; ++i)
+		{
+			const uint32_t index = reader.Read(i == 0 ? 3 : 4);
+			XMFLOAT4 c;
+			XMStoreFloat4(&c, palette[index]);
+			block[i * 4 + 0] = uint8_t(c.x);
+			block[i * 4 + 1] = uint8_t(c.y);
+			block[i * 4 + 2] = uint8_t(c.z);
+			block[i * 4 + 3] = uint8_t(c.w);
+		}
+	}
+
+
+	FORMAT GetFormat(COMPRESSION compression)
+	{
+		switch (compression)
+		{
+		case COMPRESSION_BC1:
+			return FORMAT_BC1_UNORM;
+		case COMPRESSION_BC3:
+			return FORMAT_BC3_UNORM;
+		case COMPRESSION_BC4:
+			return FORMAT_BC4_UNORM;
+		case COMPRESSION_BC5:
+			return FORMAT_BC5_UNORM;
+		case COMPRESSION_BC7:
+		default:
+			return FORMAT_BC7_UNORM;
+		}
+	}
+	uint32_t GetBlockSize(COMPRESSION compression)
+	{
+		switch (compression)
+		{
+		case COMPRESSION_BC1:
+		case COMPRESSION_BC4:
+			return 8;
+		default:
+			return 16;
+		}
+	}
+
+	void Compress(const uint8_t* rgba, uint32_t width, uint32_t height, COMPRESSION compression, uint8_t* dst)
+	{
+		const uint32_t blockCountX = (width + 3) / 4;
+		const uint32_t blockCountY = (height + 3) / 4;
+		const uint32_t blockSize = GetBlockSize(compression);
+
+		// Every job compresses one row of blocks:
+		wiJobSystem::context ctx;
+		wiJobSystem::Dispatch(ctx, blockCountY, 1, [&](wiJobArgs args) {
+			const uint32_t blockY = args.jobIndex;
+			uint8_t* dstRow = dst + size_t(blockY) * blockCountX * blockSize;
+			uint8_t block[64];
+			for (uint32_t blockX = 0; blockX < blockCountX; ++blockX)
+			{
+				LoadBlock(rgba, width, height, blockX, blockY, block);
+				uint8_t* dstBlock = dstRow + blockX * blockSize;
+				switch (compression)
+				{
+				case COMPRESSION_BC1:
+					EncodeBC1(block, dstBlock, true);
+					break;
+				case COMPRESSION_BC3:
+					EncodeBC4(block, 3, dstBlock);
+					EncodeBC1(block, dstBlock + 8, false);
+					break;
+				case COMPRESSION_BC4:
+					EncodeBC4(block, 0, dstBlock);
+					break;
+				case COMPRESSION_BC5:
+					EncodeBC4(block, 0, dstBlock);
+					EncodeBC4(block, 1, dstBlock + 8);
+					break;
+				case COMPRESSION_BC7:
+					EncodeBC7(block, dstBlock);
+					break;
+				}
+			}
+		});
+		wiJobSystem::Wait(ctx);
+	}
+	void Decompress(const uint8_t* src, uint32_t width, uint32_t height, COMPRESSION compression, uint8_t* rgba)
+	{
+		const uint32_t blockCountX = (width + 3) / 4;
+		const uint32_t blockCountY = (height + 3) / 4;
+		const uint32_t blockSize = GetBlockSize(compression);
+
+		wiJobSystem::context ctx;
+		wiJobSystem::Dispatch(ctx, blockCountY, 1, [&](wiJobArgs args) {
+			const uint32_t blockY = args.jobIndex;
+			uint8_t block[64];
+			for (uint32_t blockX = 0; blockX < blockCountX; ++blockX)
+			{
+				const uint8_t* srcBlock = src + (size_t(blockY) * blockCountX + blockX) * blockSize;
+				for (int i = 0; i < 16; ++i)
+				{
+					block[i * 4 + 0] = 0;
+					block[i * 4 + 1] = 0;
+					block[i * 4 + 2] = 0;
+					block[i * 4 + 3] = 255;
+				}
+				switch (compression)
+				{
+				case COMPRESSION_BC1:
+					DecodeBC1(srcBlock, block, false);
+					break;
+				case COMPRESSION_BC3:
+					DecodeBC1(srcBlock + 8, block, true);
+					DecodeBC4(srcBlock, 3, block);
+					break;
+				case COMPRESSION_BC4:
+					DecodeBC4(srcBlock, 0, block);
+					break;
+				case COMPRESSION_BC5:
+					DecodeBC4(srcBlock, 0, block);
+					DecodeBC4(srcBlock + 8, 1, block);
+					break;
+				case COMPRESSION_BC7:
+					DecodeBC7(srcBlock, block);
+					break;
+				}
+				StoreBlock(rgba, width, height, blockX, blockY, block);
+			}
+		});
+		wiJobSystem::Wait(ctx);
+	}
+	float ComputePSNR(const uint8_t* original, const uint8_t* decompressed, uint32_t width, uint32_t height, COMPRESSION compression)
+	{
+		int channelCount = 4;
+		switch (compression)
+		{
+		case COMPRESSION_BC1:
+			channelCount = 3;
+			break;
+		case COMPRESSION_BC4:
+			channelCount = 1;
+			break;
+		case COMPRESSION_BC5:
+			channelCount = 2;
+			break;
+		default:
+			break;
+		}
+
+		double squaredError = 0;
+		size_t sampleCount = 0;
+		const size_t pixelCount = size_t(width) * size_t(height);
+		for (size_t i = 0; i < pixelCount; ++i)
+		{
+			if (compression == COMPRESSION_BC1 && original[i * 4 + 3] < 128)
+			{
+				// the color of punch-through transparent pixels is discarded by design
+				continue;
+			}
+			sampleCount += channelCount;
+			for (int c = 0; c < channelCount; ++c)
+			{
+				const double diff = double(original[i * 4 + c]) - double(decompressed[i * 4 + c]);
+				squaredError += diff * diff;
+			}
+		}
+		const double mse = squaredError / double(std::max(sampleCount, size_t(1)));
+		if (mse <= 0)
+		{
+			return 99.0f;
+		}
+		return float(10.0 * std::log10(255.0 * 255.0 / mse));
+	}
+
+
+	// Mip generation:
+
+	inline float SRGBToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+	inline float LinearToSRGB(float value)
+	{
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+
+	// Fraction of pixels that pass the alpha test after scaling alpha
+	float AlphaCoverage(const std::vector<XMFLOAT4>& image, float alphaReference, float scale)
+	{
+		size_t count = 0;
+		for (const XMFLOAT4& pixel : image)
+		{
+			if (pixel.w * scale > alphaReference)
+			{
+				count++;
+			}
+		}
+		return float(count) / float(std::max(size_t(1), image.size()));
+	}
+
+	void GenerateMips(const uint8_t* rgba, uint32_t width, uint32_t height, const CookParams& params, std::vector<std::vector<uint8_t>>& mips)
+	{
+		mips.clear();
+		mips.emplace_back(rgba, rgba + size_t(width) * size_t(height) * 4);
+
+		// Filtering is done in linear space with floating point precision:
+		float srgb_to_linear[256];
+		for (int i = 0; i < 256; ++i)
+		{
+			srgb_to_linear[i] = params.usage == USAGE_COLOR ? SRGBToLinear(i / 255.0f) : i / 255.0f;
+		}
+		std::vector<XMFLOAT4> current(size_t(width) * size_t(height));
+		bool hasAlpha = false;
+		for (size_t i = 0; i < current.size(); ++i)
+		{
+			current[i] = XMFLOAT4(srgb_to_linear[rgba[i * 4 + 0]], srgb_to_linear[rgba[i * 4 + 1]], srgb_to_linear[rgba[i * 4 + 2]], rgba[i * 4 + 3] / 255.0f);
+			hasAlpha |= rgba[i * 4 + 3] < 255;
+		}
+		const bool preserveCoverage = params.preserveAlphaCoverage && hasAlpha;
+		const float targetCoverage = preserveCoverage ? AlphaCoverage(current, params.alphaReference, 1) : 0;
+
+		uint32_t mipWidth = width;
+		uint32_t mipHeight = height;
+		std::vector<XMFLOAT4> next;
+		while (mipWidth > 1 || mipHeight > 1)
+		{
+			const uint32_t nextWidth = std::max(1u, mipWidth / 2);
+			const uint32_t nextHeight = std::max(1u, mipHeight / 2);
+			next.resize(size_t(nextWidth) * size_t(nextHeight));
+
+			// Separable [1 3 3 1] tent filter around every 2x2 source quad, clamped at the edges:
+			static const float kernel[4] = { 1.0f / 8.0f, 3.0f / 8.0f, 3.0f / 8.0f, 1.0f / 8.0f };
+			const std::vector<XMFLOAT4>& src = current;
+			const uint32_t srcWidth = mipWidth;
+			const uint32_t srcHeight = mipHeight;
+			const USAGE usage = params.usage;
+			wiJobSystem::context ctx;
+			wiJobSystem::Dispatch(ctx, nextHeight, 16, [&](wiJobArgs args) {
+				const uint32_t y = args.jobIndex;
+				for (uint32_t x = 0; x < nextWidth; ++x)
+				{
+					XMVECTOR sum = XMVectorZero();
+					for (int ky = 0; ky < 4; ++ky)
+					{
+						const int sy = std::min(int(srcHeight) - 1, std::max(0, int(y * 2) - 1 + ky));
+						for (int kx = 0; kx < 4; ++kx)
+						{
+							const int sx = std::min(int(srcWidth) - 1, std::max(0, int(x * 2) - 1 + kx));
+							sum += XMLoadFloat4(&src[size_t(sy) * srcWidth + sx]) * (kernel[kx] * kernel[ky]);
+						}
+					}
+					if (usage == USAGE_NORMALMAP)
+					{
+						// Renormalize the filtered normal:
+						XMVECTOR N = sum * 2 - XMVectorSplatOne();
+						N = XMVector3Normalize(N);
+						sum = XMVectorSelect(sum, N * 0.5f + XMVectorReplicate(0.5f), XMVectorSelectControl(1, 1, 1, 0));
+					}
+					XMStoreFloat4(&next[size_t(y) * nextWidth + x], sum);
+				}
+			});
+			wiJobSystem::Wait(ctx);
+
+			if (preserveCoverage)
+			{
+				// Binary search for the alpha scale that keeps the same ratio of alpha tested pixels:
+				float minScale = 0;
+				float maxScale = 4;
+				float scale = 1;
+				for (int iteration = 0; iteration < 16; ++iteration)
+				{
+					scale = (minScale + maxScale) * 0.5f;
+					const float coverage = AlphaCoverage(next, params.alphaReference, scale);
+					if (coverage < targetCoverage)
+					{
+						minScale = scale;
+					}
+					else
+					{
+						maxScale = scale;
+					}
+				}
+				for (XMFLOAT4& pixel : next)
+				{
+					pixel.w = std::min(1.0f, pixel.w * scale);
+				}
+			}
+
+			std::swap(current, next);
+			mipWidth = nextWidth;
+			mipHeight = nextHeight;
+
+			mips.emplace_back(size_t(mipWidth) * size_t(mipHeight) * 4);
+			std::vector<uint8_t>& mip = mips.back();
+			for (size_t i = 0; i < current.size(); ++i)
+			{
+				const XMFLOAT4& pixel = current[i];
+				if (params.usage == USAGE_COLOR)
+				{
+					mip[i * 4 + 0] = uint8_t(saturate(LinearToSRGB(pixel.x)) * 255.0f + 0.5f);
+					mip[i * 4 + 1] = uint8_t(saturate(LinearToSRGB(pixel.y)) * 255.0f + 0.5f);
+					mip[i * 4 + 2] = uint8_t(saturate(LinearToSRGB(pixel.z)) * 255.0f + 0.5f);
+				}
+				else
+				{
+					mip[i * 4 + 0] = uint8_t(saturate(pixel.x) * 255.0f + 0.5f);
+					mip[i * 4 + 1] = uint8_t(saturate(pixel.y) * 255.0f + 0.5f);
+					mip[i * 4 + 2] = uint8_t(saturate(pixel.z) * 255.0f + 0.5f);
+				}
+				mip[i * 4 + 3] = uint8_t(saturate(pixel.w) * 255.0f + 0.5f);
+			}
+		}
+	}
+
+
+	bool Cook(const uint8_t* rgba, uint32_t width, uint32_t height, const CookParams& params, std::vector<uint8_t>& dds)
+	{
+		// Block compressed textures must have dimensions that are multiples of the block size:
+		if (width == 0 || height == 0 || (width % 4) != 0 || (height % 4) != 0)
+		{
+			return false;
+		}
+
+		std::vector<std::vector<uint8_t>> mips;
+		if (params.generateMips)
+		{
+			GenerateMips(rgba, width, height, params, mips);
+		}
+		else
+		{
+			mips.emplace_back(rgba, rgba + size_t(width) * size_t(height) * 4);
+		}
+
+		using tinyddsloader::DDSFile;
+		const uint32_t blockSize = GetBlockSize(params.compression);
+		auto mip_size = [&](uint32_t mip) {
+			const uint32_t mipWidth = std::max(1u, width >> mip);
+			const uint32_t mipHeight = std::max(1u, height >> mip);
+			return size_t((mipWidth + 3) / 4) * size_t((mipHeight + 3) / 4) * blockSize;
+		};
+
+		size_t dataSize = 0;
+		for (uint32_t mip = 0; mip < (uint32_t)mips.size(); ++mip)
+		{
+			dataSize += mip_size(mip);
+		}
+		const size_t headerSize = sizeof(uint32_t) + sizeof(DDSFile::Header) + sizeof(DDSFile::HeaderDXT10);
+		dds.clear();
+		dds.resize(headerSize + dataSize);
+
+		DDSFile::Header header = {};
+		header.m_size = sizeof(DDSFile::Header);
+		header.m_flags = uint32_t(DDSFile::HeaderFlagBits::Texture) | uint32_t(DDSFile::HeaderFlagBits::LinearSize) | uint32_t(DDSFile::HeaderFlagBits::Mipmap);
+		header.m_height = height;
+		header.m_width = width;
+		header.m_pitchOrLinerSize = (uint32_t)mip_size(0);
+		header.m_depth = 1;
+		header.m_mipMapCount = (uint32_t)mips.size();
+		header.m_pixelFormat.m_size = sizeof(DDSFile::PixelFormat);
+		header.m_pixelFormat.m_flags = uint32_t(DDSFile::PixelFormatFlagBits::FourCC);
+		header.m_pixelFormat.m_fourCC = DDSFile::MakeFourCC('D', 'X', '1', '0');
+		header.m_caps = 0x00001000 | (mips.size() > 1 ? (0x00400000 | 0x00000008) : 0); // texture | mipmap | complex
+
+		DDSFile::HeaderDXT10 header10 = {};
+		switch (params.compression)
+		{
+		case COMPRESSION_BC1:
+			header10.m_format = DDSFile::DXGIFormat::BC1_UNorm;
+			break;
+		case COMPRESSION_BC3:
+			header10.m_format = DDSFile::DXGIFormat::BC3_UNorm;
+			break;
+		case COMPRESSION_BC4:
+			header10.m_format = DDSFile::DXGIFormat::BC4_UNorm;
+			break;
+		case COMPRESSION_BC5:
+			header10.m_format = DDSFile::DXGIFormat::BC5_UNorm;
+			break;
+		case COMPRESSION_BC7:
+			header10.m_format = DDSFile::DXGIFormat::BC7_UNorm;
+			break;
+		}
+		header10.m_resourceDimension = DDSFile::TextureDimension::Texture2D;
+		header10.m_arraySize = 1;
+
+		uint8_t* dst = dds.data();
+		memcpy(dst, DDSFile::Magic, sizeof(uint32_t));
+		dst += sizeof(uint32_t);
+		memcpy(dst, &header, sizeof(header));
+		dst += sizeof(header);
+		memcpy(dst, &header10, sizeof(header10));
+		dst += sizeof(header10);
+
+		for (uint32_t mip = 0; mip < (uint32_t)mips.size(); ++mip)
+		{
+			Compress(mips[mip].data(), std::max(1u, width >> mip), std::max(1u, height >> mip), params.compression, dst);
+			dst += mip_size(mip);
+		}
+
+		return true;
+	}
+
+	CookParams GuessParams(const std::string& fileName)
+	{
+		CookParams params;
+
+		const std::string name = wiHelper::toUpper(wiHelper::GetFileNameFromPath(fileName));
+		if (name.find("NORMAL") != std::string::npos || name.find("_NRM") != std::string::npos)
+		{
+			params.compression = COMPRESSION_BC5;
+			params.usage = USAGE_NORMALMAP;
+			params.preserveAlphaCoverage = false;
+		}
+		else if (
+			name.find("ROUGH") != std::string::npos ||
+			name.find("METAL") != std::string::npos ||
+			name.find("OCCLUSION") != std::string::npos ||
+			name.find("DISPLACEMENT") != std::string::npos ||
+			name.find("HEIGHT") != std::string::npos)
+		{
+			params.usage = USAGE_DATA;
+		}
+
+		return params;
+	}
+
+	void SetCacheDirectory(const std::string& path)
+	{
+		cacheDirectory = path;
+	}
+	const std::string& GetCacheDirectory()
+	{
+		return cacheDirectory;
+	}
+	std::string GetCachedFileName(const std::vector<uint8_t>& sourceFileData, const CookParams& params)
+	{
+		// FNV-1a hash of the source file contents and the cooking parameters:
+		uint64_t hash = 14695981039346656037ull;
+		auto combine = [&](const void* data, size_t size) {
+			const uint8_t* bytes = (const uint8_t*)data;
+			for (size_t i = 0; i < size; ++i)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+		};
+		combine(sourceFileData.data(), sourceFileData.size());
+		combine(&COOKER_VERSION, sizeof(COOKER_VERSION));
+		combine(&params.compression, sizeof(params.compression));
+		combine(&params.usage, sizeof(params.usage));
+		combine(&params.generateMips, sizeof(params.generateMips));
+		combine(&params.preserveAlphaCoverage, sizeof(params.preserveAlphaCoverage));
+		combine(&params.alphaReference, sizeof(params.alphaReference));
+
+		std::stringstream ss("");
+		ss << cacheDirectory << std::hex << std::setw(16) << std::setfill('0') << hash << ".dds";
+		return ss.str();
+	}
+
+	void SetEnabled(bool value)
+	{
+		enabled.store(value);
+	}
+	bool IsEnabled()
+	{
+		return enabled.load();
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiGraphicsDevice.h"
+
+#include <vector>
+#include <string>
+
+// Converts RGBA8 images to block compressed textures with a full mip chain, stored as .dds files
+namespace wiTextureCooker
+{
+	enum COMPRESSION
+	{
+		COMPRESSION_BC1,	// rgb, 1-bit alpha
+		COMPRESSION_BC3,	// rgba
+		COMPRESSION_BC4,	// r
+		COMPRESSION_BC5,	// rg (normal maps, z is reconstructed in shaders)
+		COMPRESSION_BC7,	// rgba, highest quality
+	};
+
+	enum USAGE
+	{
+		USAGE_COLOR,		// rgb is gamma encoded, mips are filtered in linear space
+		USAGE_DATA,			// every channel is linear
+		USAGE_NORMALMAP,	// rgb is a tangent space normal, mips are renormalized
+	};
+
+	struct CookParams
+	{
+		COMPRESSION compression = COMPRESSION_BC7;
+		USAGE usage = USAGE_COLOR;
+		bool generateMips = true;
+		bool preserveAlphaCoverage = true; // keep the ratio of alpha tested pixels in mips
+		float alphaReference = 0.5f;
+	};
+
+	// Returns the block compressed format that the compression results in
+	wiGraphics::FORMAT GetFormat(COMPRESSION compression);
+	// Returns the size of a compressed 4x4 block in bytes
+	uint32_t GetBlockSize(COMPRESSION compression);
+
+	// Compresses a width * height RGBA8 image into blocks, multithreaded. Width and height don't need to be multiples of 4, the edges are clamped
+	//	dst must hold ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(compression) bytes
+	void Compress(const uint8_t* rgba, uint32_t width, uint32_t height, COMPRESSION compression, uint8_t* dst);
+	// Decompresses the blocks that Compress() produces into RGBA8 (BC7 decoding only supports the modes that Compress() writes)
+	void Decompress(const uint8_t* src, uint32_t width, uint32_t height, COMPRESSION compression, uint8_t* rgba);
+	// Peak signal to noise ratio of the channels that the compression stores, in decibels (BC1 ignores transparent pixels)
+	float ComputePSNR(const uint8_t* original, const uint8_t* decompressed, uint32_t width, uint32_t height, COMPRESSION compression);
+
+	// Generates the mip chain of an RGBA8 image on the CPU. Mip 0 is the source image
+	void GenerateMips(const uint8_t* rgba, uint32_t width, uint32_t height, const CookParams& params, std::vector<std::vector<uint8_t>>& mips);
+
+	// Cooks an RGBA8 image into the contents of a .dds file
+	//	returns false if the image can't be block compressed (dimensions must be multiples of 4)
+	bool Cook(const uint8_t* rgba, uint32_t width, uint32_t height, const CookParams& params, std::vector<uint8_t>& dds);
+
+	// Chooses cooking parameters from the file name, so that the cached file can be found without decoding the image:
+	//	names containing "normal" or "_nrm" are normal maps (BC5), everything else is BC7
+	CookParams GuessParams(const std::string& fileName);
+
+	// Cooked files are stored in the cache directory, named after the hash of the source file and the cooking parameters
+	void SetCacheDirectory(const std::string& path);
+	const std::string& GetCacheDirectory();
+	std::string GetCachedFileName(const std::vector<uint8_t>& sourceFileData, const CookParams& params);
+
+	// Enable or disable cooking when wiResourceManager loads a png/jpg/tga image with wiResourceManager::ALLOW_COOKING (disabled by default)
+	//	The first load uses the uncompressed image and cooks it in the background, the later loads use the cached file
+	//	Cooked textures are not writable by the GPU, so they can't be painted or have their mips generated on the GPU
+	void SetEnabled(bool value);
+	bool IsEnabled();
+};
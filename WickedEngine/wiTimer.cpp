@@ -2,6 +2,10 @@
 #include "wiHelper.h"
 #include "wiPlatform.h"
 
+#ifndef _WIN32
+#include <chrono>
+#endif // _WIN32
+
 static double PCFreq = 0;
 static int64_t CounterStart = 0;
 
@@ -28,6 +32,8 @@ void wiTimer::Start()
 
     QueryPerformanceCounter(&li);
     CounterStart = li.QuadPart;
+#else
+	CounterStart = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 #endif // _WIN32
 }
 double wiTimer::TotalTime()
@@ -37,7 +43,8 @@ double wiTimer::TotalTime()
     QueryPerformanceCounter(&li);
     return double(li.QuadPart-CounterStart)/PCFreq;
 #else
-    return 0;
+	const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	return double(now - CounterStart) / 1000000.0;
 #endif // _WIN32
 }
 
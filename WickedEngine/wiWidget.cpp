@@ -17,6 +17,26 @@ using namespace wiScene;
 
 static wiGraphics::PipelineState PSO_colored;
 
+// Records the equilateral triangle of arrow icons, transformed to the screen by M, into the GUI batch
+//	Returns false if there is no GUI batch recording, then the triangle must be drawn with PSO_colored
+static bool RecordTriangle(const XMMATRIX& M, const XMFLOAT4& color, CommandList cmd)
+{
+	wiGUIBatch* batch = wiGUIBatch::GetRecording(cmd);
+	if (batch == nullptr)
+	{
+		return false;
+	}
+	XMFLOAT4 vertices[3];
+	wiMath::ConstructTriangleEquilateral(1, vertices[0], vertices[1], vertices[2]);
+	XMFLOAT2 positions[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		XMStoreFloat2(&positions[i], XMVector4Transform(XMLoadFloat4(&vertices[i]), M));
+	}
+	batch->RecordTriangle(positions[0], positions[1], positions[2], color);
+	return true;
+}
+
 wiWidget::wiWidget()
 {
 	sprites[IDLE].params.color = wiColor::Booger();
@@ -1219,16 +1239,16 @@ void wiComboBox::Render(const wiGUI* gui, CommandList cmd) const
 	wiImage::Draw(wiTextureHelper::getWhite(), fx, cmd);
 
 	// control-arrow-triangle
+	const XMMATRIX arrowTransform = XMMatrixScaling(scale.y * 0.25f, scale.y * 0.25f, 1) *
+		XMMatrixRotationZ(XM_PIDIV2) *
+		XMMatrixTranslation(translation.x + scale.x + 1 + scale.y * 0.5f, translation.y + scale.y * 0.5f, 0);
+	if (!RecordTriangle(arrowTransform, sprites[ACTIVE].params.color, cmd))
 	{
 		device->BindPipelineState(&PSO_colored, cmd);
 
 		MiscCB cb;
 		cb.g_xColor = sprites[ACTIVE].params.color;
-		XMStoreFloat4x4(&cb.g_xTransform, XMMatrixScaling(scale.y * 0.25f, scale.y * 0.25f, 1) *
-			XMMatrixRotationZ(XM_PIDIV2) *
-			XMMatrixTranslation(translation.x + scale.x + 1 + scale.y * 0.5f, translation.y + scale.y * 0.5f, 0) *
-			Projection
-		);
+		XMStoreFloat4x4(&cb.g_xTransform, arrowTransform * Projection);
 		device->UpdateBuffer(wiRenderer::GetConstantBuffer(CBTYPE_MISC), &cb, cmd);
 		device->BindConstantBuffer(VS, wiRenderer::GetConstantBuffer(CBTYPE_MISC), CBSLOT_RENDERER_MISC, cmd);
 		const GPUBuffer* vbs[] = {
@@ -1679,7 +1699,7 @@ void wiWindow::Render(const wiGUI* gui, CommandList cmd) const
 		{
 			// the gui will render the active on on top of everything!
 			ApplyScissor(scissorRect, cmd);
-			x->Render(gui, cmd);
+			gui->RenderWidget(x, cmd);
 		}
 	}
 
@@ -2302,11 +2322,18 @@ void wiColorPicker::Render(const wiGUI* gui, CommandList cmd) const
 
 	const XMMATRIX Projection = wiRenderer::GetDevice()->GetScreenProjection();
 
+	ApplyScissor(scissorRect, cmd);
+
+	// The color wheel is drawn directly, so the GUI batch must draw what was recorded before it:
+	wiGUIBatch* guiBatch = wiGUIBatch::GetRecording(cmd);
+	if (guiBatch != nullptr)
+	{
+		guiBatch->Flush(cmd);
+	}
+
 	wiRenderer::GetDevice()->BindConstantBuffer(VS, wiRenderer::GetConstantBuffer(CBTYPE_MISC), CBSLOT_RENDERER_MISC, cmd);
 	wiRenderer::GetDevice()->BindPipelineState(&PSO_colored, cmd);
 
-	ApplyScissor(scissorRect, cmd);
-
 	MiscCB cb;
 
 	// render saturation triangle
@@ -2828,16 +2855,17 @@ void wiTreeList::Render(const wiGUI* gui, CommandList cmd) const
 		}
 		
 		// opened flag triangle:
+		const XMFLOAT4 openerColor = opener_highlight == i ? wiColor::White().toFloat4() : sprites[FOCUS].params.color;
+		const XMMATRIX openerTransform = XMMatrixScaling(item_height() * 0.3f, item_height() * 0.3f, 1) *
+			XMMatrixRotationZ(item.open ? XM_PIDIV2 : 0) *
+			XMMatrixTranslation(open_box.pos.x + open_box.siz.x * 0.5f, open_box.pos.y + open_box.siz.y * 0.25f, 0);
+		if (!RecordTriangle(openerTransform, openerColor, cmd))
 		{
 			device->BindPipelineState(&PSO_colored, cmd);
 
 			MiscCB cb;
-			cb.g_xColor = opener_highlight == i ? wiColor::White().toFloat4() : sprites[FOCUS].params.color;
-			XMStoreFloat4x4(&cb.g_xTransform, XMMatrixScaling(item_height() * 0.3f, item_height() * 0.3f, 1) * 
-				XMMatrixRotationZ(item.open ? XM_PIDIV2 : 0) * 
-				XMMatrixTranslation(open_box.pos.x + open_box.siz.x * 0.5f, open_box.pos.y + open_box.siz.y * 0.25f, 0) *
-				Projection
-			);
+			cb.g_xColor = openerColor;
+			XMStoreFloat4x4(&cb.g_xTransform, openerTransform * Projection);
 			device->UpdateBuffer(wiRenderer::GetConstantBuffer(CBTYPE_MISC), &cb, cmd);
 			device->BindConstantBuffer(VS, wiRenderer::GetConstantBuffer(CBTYPE_MISC), CBSLOT_RENDERER_MISC, cmd);
 			const GPUBuffer* vbs[] = {